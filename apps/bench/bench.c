@@ -0,0 +1,696 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            bench.c
+// Created:         October 2026
+// Author(s):       Philip Smart
+// Description:     Standalone App for the zOS/ZPU test application.
+//                  This program implements a loadable appliation which can be loaded from SD card by
+//                  the zOS/ZPUTA application. The idea is that commands or programs can be stored on the
+//                  SD card and executed by zOS/ZPUTA just like an OS such as Linux. The primary purpose
+//                  is to be able to minimise the size of zOS/ZPUTA for applications where minimal ram is
+//                  available.
+//
+//                  Benchmark runner. CoreMark, Dhrystone, memory bandwidth by the mperf method and FatFS
+//                  sequential, random and directory operations are run in turn and each result emitted as
+//                  a single fixed format CSV or JSON line, see bench.h, so runs can be collected and
+//                  compared by a script rather than read off the console.
+//
+//                  The same source builds as a native Linux program with the FatFS volume held in a disk
+//                  image file, giving a baseline on the build machine to track regressions in the shared
+//                  code. CoreMark can run several contexts in parallel there, one thread each.
+//                  Build (from the repository root):
+//                    gcc -O2 -D__LINUX__ -DCOREMARK_QUIET -DDHRY_QUIET -Iinclude -Icommon/FatFS -Icommon/CoreMark
+//                        -Icommon/Dhrystone -pthread -o bench apps/bench/bench.c common/FatFS/ff.c
+//                        common/FatFS/ffunicode.c common/CoreMark/core_list_join.c common/CoreMark/core_main_embedded.c
+//                        common/CoreMark/core_matrix.c common/CoreMark/core_state.c common/CoreMark/core_util.c
+//                        common/CoreMark/core_portme.c common/Dhrystone/dhry_1.c common/Dhrystone/dhry_2.c
+//                  Usage: bench [-t <tests>] [-j] [-i <image>] [-c <iterations>] [-p <contexts>] [-d <runs>]
+//                               [-m <MB>] [-f <KB>]
+//
+// Credits:         
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         Oct 2026     - Initial version, benchmark runner for CoreMark, Dhrystone, memory and FatFS I/O
+//                                 with one machine readable result line per test, native Linux build.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+#if defined(__K64F__)
+  #include <stdio.h>
+  #include <stdint.h>
+  #include <string.h>
+  #include "k64f_soc.h"
+  #include <../../libraries/include/stdmisc.h>
+#elif defined(__ZPU__)
+  #include <stdint.h>
+  #include <stdio.h>	    
+  #include "zpu_soc.h"
+  #include <stdlib.h>
+  #include <string.h>
+  #include <stdmisc.h>
+#elif defined(__LINUX__)
+  #include <stdint.h>
+  #include <stdio.h>
+  #include <stdlib.h>
+  #include <string.h>
+  #include <time.h>
+  #include <unistd.h>
+  #include <fcntl.h>
+  #include <sys/stat.h>
+#else
+  #error "Target CPU not defined, use __ZPU__, __K64F__ or __LINUX__"
+#endif
+#include "ff.h"            /* Declarations of FatFs API */
+#if defined(__LINUX__)
+  #include "diskio.h"
+#else
+  #include "interrupts.h"
+  #include "utils.h"
+  //
+  #if defined __ZPUTA__
+    #include "zputa_app.h"
+  #elif defined __ZOS__
+    #include "zOS_app.h"
+  #else
+    #error OS not defined, use __ZPUTA__ or __ZOS__      
+  #endif
+  //
+  #include "app.h"
+#endif
+#include "coremark.h"
+#include "bench.h"
+
+#if !defined(__LINUX__)
+// Utility functions.
+#include "tools.c"
+#endif
+
+// Version info.
+#define VERSION      "v1.0"
+#define VERSION_DATE "16/10/2026"
+#define APP_NAME     "BENCH"
+
+#if defined __ZPU__
+  #define BENCH_TARGET "ZPU"
+#elif defined __K64F__
+  #define BENCH_TARGET "K64F"
+#else
+  #define BENCH_TARGET "LINUX"
+#endif
+
+// Memory test operations, the base loop is the write loop without the store, its time is taken off the others.
+enum BENCHMEMOP {
+    BENCH_MEM_WRITE,
+    BENCH_MEM_READ,
+    BENCH_MEM_BASE
+};
+
+// CoreMark and Dhrystone parameters and results, see common/CoreMark/core_portme.c and common/Dhrystone/dhry_1.c.
+extern volatile ee_s32 seed4_volatile;
+extern int             Number_Of_Runs;
+extern long            User_Time;
+int                    main_dhry(void);
+
+// Buffer for the FatFS tests, word aligned as the sector reads go straight into it.
+static uint32_t        benchBuf[BENCH_FS_BLOCK / sizeof(uint32_t)];
+
+// State of the pseudo random generator for the random I/O offsets.
+static uint32_t        benchSeed = 0x12345678;
+
+// Sink for the memory test reads so the loads cannot be discarded.
+volatile uint32_t      benchSink;
+
+// Method to return a free running millisecond count.
+//
+static unsigned long benchMillis(void)
+{
+  #if defined __ZPU__
+    return((unsigned long)TIMER_MILLISECONDS_UP);
+  #elif defined __K64F__
+    return((unsigned long)milliseconds());
+  #else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return((unsigned long)((ts.tv_sec * 1000) + (ts.tv_nsec / 1000000)));
+  #endif
+}
+
+// Method to return the next value of a xorshift pseudo random sequence, the sequence is fixed so runs are comparable.
+//
+static uint32_t benchRandom(void)
+{
+    benchSeed ^= benchSeed << 13;
+    benchSeed ^= benchSeed >> 17;
+    benchSeed ^= benchSeed << 5;
+    return(benchSeed);
+}
+
+// Method to express a count over an interval in milliseconds as a rate per second scaled by 1000, ie. with 3 decimal places.
+// The division is split so the intermediate values stay within 32 bits on the ZPU and K64F.
+//
+static unsigned long benchRate(unsigned long count, unsigned long ms)
+{
+    // Locals.
+    unsigned long  rem;
+
+    if(ms == 0)
+        return(0);
+    rem = count % ms;
+    return(((count / ms) * 1000000UL) + (((rem * 1000UL) / ms) * 1000UL) + ((((rem * 1000UL) % ms) * 1000UL) / ms));
+}
+
+// Method to emit one result line in the selected format. The value is scaled by 1000.
+//
+static void benchEmit(t_benchCtrl *ctrl, const char *test, const char *variant, unsigned long value, const char *unit, unsigned long ms, const char *status)
+{
+    if(ctrl->format == BENCH_FMT_JSON)
+    {
+        printf("{\"bench\":\"%s\",\"target\":\"%s\",\"test\":\"%s\",\"variant\":\"%s\",\"value\":%lu.%03lu,\"unit\":\"%s\",\"ms\":%lu,\"status\":\"%s\"}\n",
+               VERSION, BENCH_TARGET, test, variant, value / 1000, value % 1000, unit, ms, status);
+    } else
+    {
+        printf("BENCH,%s,%s,%s,%lu.%03lu,%s,%lu,%s\n", BENCH_TARGET, test, variant, value / 1000, value % 1000, unit, ms, status);
+    }
+    return;
+}
+
+// Method to emit a rate, the status is short if the interval was too small to measure.
+//
+static void benchEmitRate(t_benchCtrl *ctrl, const char *test, const char *variant, unsigned long count, const char *unit, unsigned long ms, uint8_t ok)
+{
+    benchEmit(ctrl, test, variant, benchRate(count, ms), unit, ms, !ok ? "fail" : ms == 0 ? "short" : "ok");
+    return;
+}
+
+// CoreMark, iterations per second over all contexts. The result is only verified for the standard seeds.
+//
+static void benchCoreMark(t_benchCtrl *ctrl)
+{
+    // Locals.
+    char        variant[16];
+
+    if(ctrl->cmIterations > 0)
+        seed4_volatile = (ee_s32)ctrl->cmIterations;
+  #if (MULTITHREAD>1)
+    default_num_contexts = ctrl->cmContexts > MULTITHREAD ? MULTITHREAD : ctrl->cmContexts == 0 ? 1 : ctrl->cmContexts;
+  #endif
+    CoreMarkTest();
+
+    sprintf(variant, "ctx%lu", (unsigned long)coremark_summary.contexts);
+    benchEmitRate(ctrl, "coremark", variant, (unsigned long)coremark_summary.iterations * coremark_summary.contexts, "iter/s",
+                  (unsigned long)coremark_summary.ticks, coremark_summary.errors == 0);
+    return;
+}
+
+// Dhrystone, Dhrystones per second and the DMIPS rating, ie. per the 1757 of the VAX 11/780.
+//
+static void benchDhrystone(t_benchCtrl *ctrl)
+{
+    // Locals.
+    unsigned long  rate;
+
+    if(ctrl->dhryRuns > 0)
+        Number_Of_Runs = (int)ctrl->dhryRuns;
+    main_dhry();
+
+    rate = benchRate((unsigned long)Number_Of_Runs, (unsigned long)User_Time);
+    benchEmitRate(ctrl, "dhrystone", "dps", (unsigned long)Number_Of_Runs, "dhry/s", (unsigned long)User_Time, 1);
+    benchEmit(ctrl, "dhrystone", "dmips", rate / 1757, "DMIPS", (unsigned long)User_Time, User_Time == 0 ? "short" : "ok");
+    return;
+}
+
+// Method to time one memory test loop, the mperf method of an access per step wrapping within the test area. The pointer is a plain
+// variable so it can be kept in a register, only the accessed location is volatile.
+//
+static unsigned long benchMemLoop(enum BENCHMEMOP op, uint8_t width, uint8_t *startAddr, uint8_t *endAddr, unsigned long xferCount)
+{
+    // Locals.
+    unsigned long  startTime;
+    uint8_t        *memAddr = startAddr;
+
+    startTime = benchMillis();
+    switch((op * 8) + width)
+    {
+        case (BENCH_MEM_WRITE * 8) + 1:
+            while(xferCount > 0) { *(volatile uint8_t *)(memAddr) = 0xAA;        memAddr += 1; xferCount -= 1; if(memAddr > endAddr) { memAddr = startAddr; } }
+            break;
+        case (BENCH_MEM_WRITE * 8) + 2:
+            while(xferCount > 0) { *(volatile uint16_t *)(memAddr) = 0xAA55;     memAddr += 2; xferCount -= 2; if(memAddr > endAddr) { memAddr = startAddr; } }
+            break;
+        case (BENCH_MEM_WRITE * 8) + 4:
+            while(xferCount > 0) { *(volatile uint32_t *)(memAddr) = 0xAA55AA55; memAddr += 4; xferCount -= 4; if(memAddr > endAddr) { memAddr = startAddr; } }
+            break;
+        case (BENCH_MEM_READ * 8) + 1:
+            while(xferCount > 0) { benchSink = *(volatile uint8_t *)(memAddr);   memAddr += 1; xferCount -= 1; if(memAddr > endAddr) { memAddr = startAddr; } }
+            break;
+        case (BENCH_MEM_READ * 8) + 2:
+            while(xferCount > 0) { benchSink = *(volatile uint16_t *)(memAddr);  memAddr += 2; xferCount -= 2; if(memAddr > endAddr) { memAddr = startAddr; } }
+            break;
+        case (BENCH_MEM_READ * 8) + 4:
+            while(xferCount > 0) { benchSink = *(volatile uint32_t *)(memAddr);  memAddr += 4; xferCount -= 4; if(memAddr > endAddr) { memAddr = startAddr; } }
+            break;
+        case (BENCH_MEM_BASE * 8) + 1:
+            while(xferCount > 0) {                                               memAddr += 1; xferCount -= 1; if(memAddr > endAddr) { memAddr = startAddr; } }
+            break;
+        case (BENCH_MEM_BASE * 8) + 2:
+            while(xferCount > 0) {                                               memAddr += 2; xferCount -= 2; if(memAddr > endAddr) { memAddr = startAddr; } }
+            break;
+        case (BENCH_MEM_BASE * 8) + 4:
+            while(xferCount > 0) {                                               memAddr += 4; xferCount -= 4; if(memAddr > endAddr) { memAddr = startAddr; } }
+            break;
+        default:
+            break;
+    }
+
+    // The final address is kept so the base loop cannot be discarded.
+    benchSink = (uint32_t)(uintptr_t)memAddr;
+    return(benchMillis() - startTime);
+}
+
+// Method to emit a memory rate less the loop overhead. If the overhead is not below the loop time the access time cannot be separated
+// from it, the rate over the raw loop time is given and marked raw.
+//
+static void benchEmitMemRate(t_benchCtrl *ctrl, const char *variant, unsigned long xferCount, unsigned long loopTime, unsigned long baseTime)
+{
+    if(loopTime > baseTime)
+        benchEmitRate(ctrl, "memory", variant, xferCount / 1024, "KB/s", loopTime - baseTime, 1);
+    else
+        benchEmit(ctrl, "memory", variant, benchRate(xferCount / 1024, loopTime), "KB/s", loopTime, "raw");
+    return;
+}
+
+// Memory bandwidth in KB/s for 8, 16 and 32 bit writes and reads, each less the loop overhead. The volume is doubled until the base
+// loop runs for BENCH_MEM_MIN_MS so the overhead, and the difference from it, is well above the millisecond clock resolution.
+//
+static void benchMemory(t_benchCtrl *ctrl)
+{
+    // Locals.
+    unsigned long  xferCount;
+    uint8_t        *startAddr = (uint8_t *)(uintptr_t)ctrl->memStart;
+    uint8_t        *endAddr;
+    unsigned long  writeTime;
+    unsigned long  readTime;
+    unsigned long  baseTime;
+    char           variant[16];
+    uint8_t        width;
+
+    if(ctrl->memStart == 0 || ctrl->memEnd <= ctrl->memStart)
+    {
+        benchEmit(ctrl, "memory", "all", 0, "KB/s", 0, "skip");
+        return;
+    }
+
+    for(width=1; width <= 4; width *= 2)
+    {
+        // Last address at which a full width access stays within the area.
+        endAddr   = (uint8_t *)(uintptr_t)(ctrl->memEnd - width + 1);
+        xferCount = ctrl->memMB * 1024UL * 1024UL;
+        baseTime  = benchMemLoop(BENCH_MEM_BASE, width, startAddr, endAddr, xferCount);
+        while(baseTime < BENCH_MEM_MIN_MS && xferCount <= BENCH_MEM_MAX_XFER / 2)
+        {
+            xferCount *= 2;
+            baseTime   = benchMemLoop(BENCH_MEM_BASE, width, startAddr, endAddr, xferCount);
+        }
+        writeTime = benchMemLoop(BENCH_MEM_WRITE, width, startAddr, endAddr, xferCount);
+        readTime  = benchMemLoop(BENCH_MEM_READ,  width, startAddr, endAddr, xferCount);
+
+        sprintf(variant, "write%u", width * 8);
+        benchEmitMemRate(ctrl, variant, xferCount, writeTime, baseTime);
+        sprintf(variant, "read%u", width * 8);
+        benchEmitMemRate(ctrl, variant, xferCount, readTime, baseTime);
+    }
+    return;
+}
+
+// Method to fill the buffer with a pattern identifying the block, so a read can be checked against its offset.
+//
+static void benchFill(uint32_t block)
+{
+    // Locals.
+    uint32_t  idx;
+
+    for(idx=0; idx < BENCH_FS_BLOCK / sizeof(uint32_t); idx++)
+        benchBuf[idx] = (block * (BENCH_FS_BLOCK / sizeof(uint32_t))) + idx;
+    return;
+}
+
+// Method to check the buffer holds the pattern for the given file offset.
+//
+static uint8_t benchCheck(uint32_t offset, uint32_t bytes)
+{
+    // Locals.
+    uint32_t  idx;
+
+    for(idx=0; idx < bytes / sizeof(uint32_t); idx++)
+    {
+        if(benchBuf[idx] != (offset / sizeof(uint32_t)) + idx)
+            return(0);
+    }
+    return(1);
+}
+
+// FatFS tests on a scratch file, sequential write then read in KB/s, random sector reads then writes in operations/s,
+// and the creation then repeated scan of a directory in entries/s. The scratch file and directory are removed afterwards.
+//
+static void benchFatFS(t_benchCtrl *ctrl)
+{
+    // Locals.
+    FIL            fp;
+    DIR            dirFp;
+    FILINFO        fno;
+    FRESULT        result;
+    UINT           count;
+    uint32_t       blocks = (ctrl->fsKB * 1024) / BENCH_FS_BLOCK;
+    uint32_t       block;
+    uint32_t       offset;
+    uint32_t       idx;
+    uint32_t       entries;
+    unsigned long  startTime;
+    uint8_t        ok;
+    char           fileName[32];
+
+    // Sequential write, the time includes the sync so all data has reached the disk.
+    ok        = 1;
+    startTime = benchMillis();
+    result    = f_open(&fp, BENCH_FS_FILE, FA_CREATE_ALWAYS | FA_WRITE | FA_READ);
+    for(block=0; result == FR_OK && block < blocks; block++)
+    {
+        benchFill(block);
+        result = f_write(&fp, benchBuf, BENCH_FS_BLOCK, &count);
+        if(result == FR_OK && count != BENCH_FS_BLOCK)
+            result = FR_DISK_ERR;
+    }
+    if(result == FR_OK)
+        result = f_sync(&fp);
+    benchEmitRate(ctrl, "fatfs", "seq_write", blocks * (BENCH_FS_BLOCK / 1024), "KB/s", benchMillis() - startTime, result == FR_OK);
+
+    // Sequential read, each block verified.
+    if(result == FR_OK)
+    {
+        startTime = benchMillis();
+        result    = f_lseek(&fp, 0);
+        for(block=0; result == FR_OK && block < blocks; block++)
+        {
+            result = f_read(&fp, benchBuf, BENCH_FS_BLOCK, &count);
+            if(result == FR_OK && (count != BENCH_FS_BLOCK || !benchCheck(block * BENCH_FS_BLOCK, BENCH_FS_BLOCK)))
+                ok = 0;
+        }
+        benchEmitRate(ctrl, "fatfs", "seq_read", blocks * (BENCH_FS_BLOCK / 1024), "KB/s", benchMillis() - startTime, result == FR_OK && ok);
+    }
+
+    // Random sector reads then writes, the writes put back the pattern read so the file stays verifiable.
+    if(result == FR_OK)
+    {
+        startTime = benchMillis();
+        for(idx=0; result == FR_OK && idx < BENCH_FS_RANDOM_OPS; idx++)
+        {
+            offset = (benchRandom() % ((blocks * BENCH_FS_BLOCK) / BENCH_FS_RANDOM_SIZE)) * BENCH_FS_RANDOM_SIZE;
+            result = f_lseek(&fp, offset);
+            if(result == FR_OK)
+                result = f_read(&fp, benchBuf, BENCH_FS_RANDOM_SIZE, &count);
+            if(result == FR_OK && (count != BENCH_FS_RANDOM_SIZE || !benchCheck(offset, BENCH_FS_RANDOM_SIZE)))
+                ok = 0;
+        }
+        benchEmitRate(ctrl, "fatfs", "rand_read", BENCH_FS_RANDOM_OPS, "ops/s", benchMillis() - startTime, result == FR_OK && ok);
+    }
+    if(result == FR_OK)
+    {
+        startTime = benchMillis();
+        for(idx=0; result == FR_OK && idx < BENCH_FS_RANDOM_OPS; idx++)
+        {
+            offset = (benchRandom() % ((blocks * BENCH_FS_BLOCK) / BENCH_FS_RANDOM_SIZE)) * BENCH_FS_RANDOM_SIZE;
+            for(block=0; block < BENCH_FS_RANDOM_SIZE / sizeof(uint32_t); block++)
+                benchBuf[block] = (offset / sizeof(uint32_t)) + block;
+            result = f_lseek(&fp, offset);
+            if(result == FR_OK)
+                result = f_write(&fp, benchBuf, BENCH_FS_RANDOM_SIZE, &count);
+            if(result == FR_OK && count != BENCH_FS_RANDOM_SIZE)
+                result = FR_DISK_ERR;
+        }
+        if(result == FR_OK)
+            result = f_sync(&fp);
+        benchEmitRate(ctrl, "fatfs", "rand_write", BENCH_FS_RANDOM_OPS, "ops/s", benchMillis() - startTime, result == FR_OK);
+    }
+    f_close(&fp);
+    f_unlink(BENCH_FS_FILE);
+
+    // Directory, created with empty files then scanned.
+    startTime = benchMillis();
+    result    = f_mkdir(BENCH_FS_DIR);
+    for(idx=0; result == FR_OK && idx < BENCH_FS_DIR_FILES; idx++)
+    {
+        sprintf(fileName, "%s/file%04lu.dat", BENCH_FS_DIR, (unsigned long)idx);
+        result = f_open(&fp, fileName, FA_CREATE_ALWAYS | FA_WRITE);
+        if(result == FR_OK)
+            result = f_close(&fp);
+    }
+    benchEmitRate(ctrl, "fatfs", "dir_create", BENCH_FS_DIR_FILES, "files/s", benchMillis() - startTime, result == FR_OK);
+    if(result == FR_OK)
+    {
+        entries   = 0;
+        startTime = benchMillis();
+        for(block=0; result == FR_OK && block < BENCH_FS_DIR_SCANS; block++)
+        {
+            result = f_opendir(&dirFp, BENCH_FS_DIR);
+            while(result == FR_OK)
+            {
+                result = f_readdir(&dirFp, &fno);
+                if(result != FR_OK || fno.fname[0] == 0)
+                    break;
+                entries++;
+            }
+            f_closedir(&dirFp);
+        }
+        benchEmitRate(ctrl, "fatfs", "dir_scan", entries, "entries/s", benchMillis() - startTime, result == FR_OK && entries == BENCH_FS_DIR_FILES * BENCH_FS_DIR_SCANS);
+    }
+    for(idx=0; idx < BENCH_FS_DIR_FILES; idx++)
+    {
+        sprintf(fileName, "%s/file%04lu.dat", BENCH_FS_DIR, (unsigned long)idx);
+        f_unlink(fileName);
+    }
+    f_unlink(BENCH_FS_DIR);
+    return;
+}
+
+// Method to run the selected tests in order.
+//
+static void benchRun(t_benchCtrl *ctrl)
+{
+    if(ctrl->tests & BENCH_COREMARK)
+        benchCoreMark(ctrl);
+    if(ctrl->tests & BENCH_DHRYSTONE)
+        benchDhrystone(ctrl);
+    if(ctrl->tests & BENCH_MEMORY)
+        benchMemory(ctrl);
+    if(ctrl->tests & BENCH_FATFS)
+        benchFatFS(ctrl);
+    return;
+}
+
+#if defined(__LINUX__)
+// FatFS partition table as used on the tranZPUter, volume 0 is the first partition.
+//
+PARTITION VolToPart[FF_VOLUMES] = {
+    {0, 1},
+    {0, 2},
+    {0, 3},
+    {0, 4},
+};
+
+// Disk image backing physical drive 0.
+static int       imageFd = -1;
+static DWORD     imageSectors;
+
+// Disk image driver. The host page cache is left to absorb the writes as the baseline tracks the filesystem code, not the
+// build machine disk, so a sync does not flush to the device.
+//
+DSTATUS disk_initialize(BYTE pdrv, BYTE cardtype) { return(pdrv == 0 && imageFd >= 0 ? 0 : STA_NOINIT); }
+DSTATUS disk_status(BYTE pdrv)                    { return(pdrv == 0 && imageFd >= 0 ? 0 : STA_NOINIT); }
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
+{
+    if(pdrv != 0 || sector + count > imageSectors) return(RES_PARERR);
+    return(pread(imageFd, buff, (size_t)count * FF_MAX_SS, (off_t)sector * FF_MAX_SS) == (ssize_t)count * FF_MAX_SS ? RES_OK : RES_ERROR);
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
+{
+    if(pdrv != 0 || sector + count > imageSectors) return(RES_PARERR);
+    return(pwrite(imageFd, buff, (size_t)count * FF_MAX_SS, (off_t)sector * FF_MAX_SS) == (ssize_t)count * FF_MAX_SS ? RES_OK : RES_ERROR);
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
+{
+    switch(cmd)
+    {
+        case CTRL_SYNC:        return(RES_OK);
+        case GET_SECTOR_COUNT: *(DWORD *)buff = imageSectors; return(RES_OK);
+        case GET_SECTOR_SIZE:  *(WORD *)buff  = FF_MAX_SS;    return(RES_OK);
+        case GET_BLOCK_SIZE:   *(DWORD *)buff = 1;            return(RES_OK);
+    }
+    return(RES_PARERR);
+}
+
+// FF_FS_NORTC is set, the timestamp comes from FF_NORTC_*, this is only used if it is changed.
+DWORD get_fattime(void) { return(0); }
+
+// Method to open the disk image and mount it, an image which does not exist is created and formatted.
+//
+static FRESULT benchImage(const char *image, FATFS *fatFs)
+{
+    // Locals.
+    static uint8_t  work[FF_MAX_SS * 4];
+    DWORD           plist[] = {100, 0, 0, 0};
+    struct stat     st;
+    uint8_t         create = (stat(image, &st) != 0);
+    FRESULT         result;
+
+    if((imageFd = open(image, O_RDWR | O_CREAT, 0644)) < 0)
+        return(FR_NOT_READY);
+    if(create && ftruncate(imageFd, (off_t)BENCH_IMAGE_MB * 1024 * 1024) != 0)
+        return(FR_NOT_READY);
+    imageSectors = (DWORD)((create ? (off_t)BENCH_IMAGE_MB * 1024 * 1024 : st.st_size) / FF_MAX_SS);
+
+    if(create && ((result = f_fdisk(0, plist, work)) != FR_OK || (result = f_mkfs("0:", FM_FAT32, 0, work, sizeof(work))) != FR_OK))
+        return(result);
+    return(f_mount(fatFs, "0:", 1));
+}
+
+// Native entry point, the options map onto the run parameters of the target app.
+//
+int main(int argc, char *argv[])
+{
+    // Locals.
+    static FATFS    fatFs;
+    t_benchCtrl     ctrl;
+    const char      *image = BENCH_IMAGE;
+    uint8_t         *memArea;
+    FRESULT         result;
+    int             opt;
+
+    memset(&ctrl, 0x00, sizeof(t_benchCtrl));
+    ctrl.tests        = BENCH_ALL;
+    ctrl.memMB        = BENCH_MEM_DEFAULT_MB;
+    ctrl.fsKB         = BENCH_FS_DEFAULT_KB;
+    ctrl.cmIterations = BENCH_COREMARK_ITERATIONS;
+    ctrl.cmContexts   = 1;
+    ctrl.dhryRuns     = BENCH_DHRY_RUNS;
+
+    while((opt = getopt(argc, argv, "t:ji:c:p:d:m:f:")) != -1)
+    {
+        switch(opt)
+        {
+            case 't': ctrl.tests        = (uint8_t)strtoul(optarg, NULL, 0) & BENCH_ALL; break;
+            case 'j': ctrl.format       = BENCH_FMT_JSON;                                 break;
+            case 'i': image             = optarg;                                         break;
+            case 'c': ctrl.cmIterations = strtol(optarg, NULL, 0);                        break;
+            case 'p': ctrl.cmContexts   = (uint32_t)strtoul(optarg, NULL, 0);             break;
+            case 'd': ctrl.dhryRuns     = strtol(optarg, NULL, 0);                        break;
+            case 'm': ctrl.memMB        = strtoul(optarg, NULL, 0);                       break;
+            case 'f': ctrl.fsKB         = strtoul(optarg, NULL, 0);                       break;
+            default:
+                printf("Usage: %s [-t <tests>] [-j] [-i <image>] [-c <iterations>] [-p <contexts>] [-d <runs>] [-m <MB>] [-f <KB>]\n", argv[0]);
+                printf("  tests: mask of 1 CoreMark, 2 Dhrystone, 4 memory, 8 FatFS, default 0x%x\n", BENCH_ALL);
+                return(1);
+        }
+    }
+
+    // The memory test runs over a block of its own.
+    if((memArea = (uint8_t *)malloc(BENCH_MEM_AREA)) != NULL)
+    {
+        ctrl.memStart = (unsigned long)memArea;
+        ctrl.memEnd   = ctrl.memStart + BENCH_MEM_AREA - 1;
+    }
+    if((ctrl.tests & BENCH_FATFS) && (result = benchImage(image, &fatFs)) != FR_OK)
+    {
+        printf("Failed to open disk image %s, error %d.\n", image, result);
+        return(1);
+    }
+
+    benchRun(&ctrl);
+
+    if(imageFd >= 0)
+    {
+        f_mount(NULL, "0:", 0);
+        close(imageFd);
+    }
+    free(memArea);
+    return(0);
+}
+
+#else
+
+// Main entry and start point of a zOS/ZPUTA Application. Only 2 parameters are catered for and a 32bit return code, additional parameters can be added by changing the appcrt0.s
+// startup code to add them to the stack prior to app() call.
+//
+// Return code for the ZPU is saved in _memreg by the C compiler, this is transferred to _memreg in zOS/ZPUTA in appcrt0.s prior to return.
+// The K64F ARM processor uses the standard register passing conventions, return code is stored in R0.
+//
+uint32_t app(uint32_t param1, uint32_t param2)
+{
+    // Initialisation.
+    //
+    char         *ptr = (char *)param1;
+    long         tests;
+    long         format;
+    long         memStart;
+    long         memEnd;
+    long         memMB;
+    t_benchCtrl  ctrl;
+
+    memset(&ctrl, 0x00, sizeof(t_benchCtrl));
+    ctrl.memMB      = BENCH_MEM_DEFAULT_MB;
+    ctrl.fsKB       = BENCH_FS_DEFAULT_KB;
+    ctrl.cmContexts = 1;
+
+    if(!xatoi(&ptr, &tests) || tests == 0)
+    {
+        tests = BENCH_ALL;
+    }
+    if(!xatoi(&ptr, &format))
+    {
+        format = BENCH_FMT_CSV;
+    }
+    if(xatoi(&ptr, &memStart) && xatoi(&ptr, &memEnd))
+    {
+        ctrl.memStart = (unsigned long)memStart;
+        ctrl.memEnd   = (unsigned long)memEnd;
+        if(xatoi(&ptr, &memMB) && memMB > 0)
+        {
+            ctrl.memMB = (unsigned long)memMB;
+        }
+    }
+    ctrl.tests  = (uint8_t)(tests & BENCH_ALL);
+    ctrl.format = format == BENCH_FMT_JSON ? BENCH_FMT_JSON : BENCH_FMT_CSV;
+
+    benchRun(&ctrl);
+
+    return(0);
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
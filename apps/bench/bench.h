@@ -0,0 +1,118 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            bench.h
+// Created:         October 2026
+// Author(s):       Philip Smart
+// Description:     Standalone App for the zOS/ZPU test application.
+//                  This program implements a loadable appliation which can be loaded from SD card by
+//                  the zOS/ZPUTA application. The idea is that commands or programs can be stored on the
+//                  SD card and executed by zOS/ZPUTA just like an OS such as Linux. The primary purpose
+//                  is to be able to minimise the size of zOS/ZPUTA for applications where minimal ram is
+//                  available.
+//
+// Credits:         
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         Oct 2026     - Initial version, benchmark runner for CoreMark, Dhrystone, memory and FatFS I/O
+//                                 with one machine readable result line per test.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef BENCH_H
+#define BENCH_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+// Constants.
+
+// Tests, selected by a bit mask.
+//
+#define BENCH_COREMARK              0x01                                 // CoreMark, iterations per second.
+#define BENCH_DHRYSTONE             0x02                                 // Dhrystone, Dhrystones per second and DMIPS.
+#define BENCH_MEMORY                0x04                                 // Memory bandwidth by the mperf method, needs a test area.
+#define BENCH_FATFS                 0x08                                 // FatFS sequential and random I/O and directory scan.
+#define BENCH_ALL                   0x0F
+
+// Output formats. Each test emits one line, as CSV:
+//   BENCH,<target>,<test>,<variant>,<value>,<unit>,<ms>,<status>
+// or as a single line JSON object with the same fields. The value carries 3 decimal places, ms is the measured
+// interval and status is one of ok, fail (result did not verify), raw (memory rate over the loop time as the loop
+// overhead could not be taken off), short (interval too short to measure) or skip.
+//
+#define BENCH_FMT_CSV               0
+#define BENCH_FMT_JSON              1
+
+// Application execution constants.
+//
+#define BENCH_FS_FILE               "benchtmp.dat"                       // Scratch file for the FatFS tests, created in the current directory.
+#define BENCH_FS_DIR                "benchdir"                           // Scratch directory for the directory scan.
+#define BENCH_FS_RANDOM_SIZE        512                                  // Bytes per random read or write, one sector.
+#define BENCH_MEM_MIN_MS            200                                  // Shortest memory test base loop, the volume is doubled until it is reached.
+#define BENCH_MEM_MAX_XFER          0x80000000UL                         // Largest volume moved per memory test, within 32 bits on the ZPU and K64F.
+#if defined __ZPU__
+  #define BENCH_FS_BLOCK            1024                                 // Bytes per sequential read or write.
+  #define BENCH_FS_DEFAULT_KB       512                                  // Size of the scratch file.
+  #define BENCH_FS_RANDOM_OPS       128                                  // Random reads, then writes.
+  #define BENCH_FS_DIR_FILES        32                                   // Files created in the scratch directory.
+  #define BENCH_FS_DIR_SCANS        1                                    // Passes made over the scratch directory.
+  #define BENCH_MEM_DEFAULT_MB      1                                    // Volume moved per memory test.
+#elif defined __K64F__
+  #define BENCH_FS_BLOCK            4096
+  #define BENCH_FS_DEFAULT_KB       2048
+  #define BENCH_FS_RANDOM_OPS       512
+  #define BENCH_FS_DIR_FILES        128
+  #define BENCH_FS_DIR_SCANS        4
+  #define BENCH_MEM_DEFAULT_MB      4
+#else
+  #define BENCH_FS_BLOCK            4096
+  #define BENCH_FS_DEFAULT_KB       (32*1024)
+  #define BENCH_FS_RANDOM_OPS       8192
+  #define BENCH_FS_DIR_FILES        1000
+  #define BENCH_FS_DIR_SCANS        100
+  #define BENCH_MEM_DEFAULT_MB      512
+  #define BENCH_MEM_AREA            (1024*1024)                          // Test area allocated for the memory test.
+  #define BENCH_IMAGE               "bench.img"                          // Default disk image.
+  #define BENCH_IMAGE_MB            128                                  // Size of a disk image created by the benchmark.
+  #define BENCH_COREMARK_ITERATIONS 30000                                // Default CoreMark iterations per context.
+  #define BENCH_DHRY_RUNS           20000000                             // Default Dhrystone runs.
+#endif
+
+// Benchmark run parameters.
+//
+typedef struct {
+    uint8_t                         tests;                               // Tests to run, BENCH_* mask.
+    uint8_t                         format;                              // Output format, BENCH_FMT_*.
+    unsigned long                   memStart;                            // Memory test area, the test is skipped if zero.
+    unsigned long                   memEnd;
+    unsigned long                   memMB;                               // MBytes moved per memory test, doubled until the base loop takes BENCH_MEM_MIN_MS.
+    unsigned long                   fsKB;                                // Size of the FatFS scratch file.
+    long                            cmIterations;                        // CoreMark iterations per context, 0 leaves the built in value.
+    uint32_t                        cmContexts;                          // CoreMark contexts run in parallel.
+    long                            dhryRuns;                            // Dhrystone runs, 0 leaves the built in value.
+} t_benchCtrl;
+
+// Components to be embedded in the program.
+//
+// Test components to be embedded in the program.
+#define BUILTIN_TST_BENCH           1
+
+#ifdef __cplusplus
+}
+#endif
+#endif // BENCH_H
@@ -11,6 +11,8 @@
 // Copyright:       modifications (c) 2019-2020 Philip Smart <philip.smart@net2net.org>
 //
 // History:         January 2020   - Utilities assembled from various sources.
+//                  Oct 2026       - Word at a time memcpy/memset/memmove/memcmp, K64F uses the teensy3 assembler
+//                                   memcpy/memset.
 //
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 // This source file is free software: you can redistribute it and#or modify
@@ -40,6 +42,7 @@
   #define int16_t  __int16_t
   #define int8_t   __int8_t
 #elif defined(__ZPU__)
+  #include <stdint.h>
   #include <stdio.h>
   #include <stdlib.h>
 #else
@@ -78,19 +81,69 @@ int strlen(const char* s) {
     return i;
 }
 
-void* memcpy(void* dst, const void* src, int sz) {
-    char* d = (char*) dst;
-    char* s = (char*) src;
+// Block memory functions work a word at a time when both pointers share the same alignment, a bytewise head brings
+// them onto a word boundary and a bytewise tail finishes off. The ZPU and 68000 cannot issue unaligned word accesses so
+// differing alignments use a byte loop. On the K64F memcpy/memset are provided by teensy3/memcpy-armv7m.S and memset.S.
+#define WORD_MIN_BYTES   16
+#define WORD_ALIGNED(a, b) ((((unsigned long)(a) ^ (unsigned long)(b)) & 3) == 0)
+
+// Forward copy, also safe for memmove when dst < src as each source word is read before the lower destination is written.
+static void fwdcopy(char* d, const char* s, int sz) {
+    if (sz >= WORD_MIN_BYTES && WORD_ALIGNED(d, s)) {
+        while (((unsigned long)d & 3) != 0) {
+            *(d++) = *(s++);
+            sz--;
+        }
+        uint32_t* wd = (uint32_t*) d;
+        uint32_t* ws = (uint32_t*) s;
+        while (sz >= 16) {
+            wd[0] = ws[0];
+            wd[1] = ws[1];
+            wd[2] = ws[2];
+            wd[3] = ws[3];
+            wd += 4;
+            ws += 4;
+            sz -= 16;
+        }
+        while (sz >= 4) {
+            *(wd++) = *(ws++);
+            sz -= 4;
+        }
+        d = (char*) wd;
+        s = (char*) ws;
+    }
     while (sz-- > 0) {
         *(d++) = *(s++);
     }
+}
+
+#if !defined(__K64F__)
+void* memcpy(void* dst, const void* src, int sz) {
+    fwdcopy((char*) dst, (const char*) src, sz);
     return dst;
 }
+#endif
 
 int memcmp(const void* dst, const void* src, int sz) {
     unsigned char* d = (unsigned char*) dst;
     unsigned char* s = (unsigned char*) src;
     int i, v;
+    if (sz >= WORD_MIN_BYTES && WORD_ALIGNED(d, s)) {
+        while (((unsigned long)d & 3) != 0) {
+            if ((v = *d - *s) != 0) {
+                return v;
+            }
+            d++; s++; sz--;
+        }
+        // Skip equal words, the first mismatch is resolved bytewise so the result is endian independent.
+        uint32_t* wd = (uint32_t*) d;
+        uint32_t* ws = (uint32_t*) s;
+        while (sz >= 4 && *wd == *ws) {
+            wd++; ws++; sz -= 4;
+        }
+        d = (unsigned char*) wd;
+        s = (unsigned char*) ws;
+    }
     for (i = 0; i < sz; i++) {
         v = *(d++) - *(s++);
         if (v != 0) {
@@ -100,26 +153,77 @@ int memcmp(const void* dst, const void* src, int sz) {
     return 0;
 }
 
+#if !defined(__K64F__)
 void *memset (void *dest, int val, size_t len)
 {
   unsigned char *ptr = dest;
+  if (len >= WORD_MIN_BYTES)
+  {
+    uint32_t pattern = (unsigned char)val;
+    uint32_t *wptr;
+
+    pattern |= pattern << 8;
+    pattern |= pattern << 16;
+    while (((unsigned long)ptr & 3) != 0)
+    {
+      *ptr++ = val;
+      len--;
+    }
+    wptr = (uint32_t *)ptr;
+    while (len >= 16)
+    {
+      wptr[0] = pattern;
+      wptr[1] = pattern;
+      wptr[2] = pattern;
+      wptr[3] = pattern;
+      wptr += 4;
+      len -= 16;
+    }
+    while (len >= 4)
+    {
+      *wptr++ = pattern;
+      len -= 4;
+    }
+    ptr = (unsigned char *)wptr;
+  }
   while (len-- > 0)
     *ptr++ = val;
   return dest;
 }
+#endif
 
 void* memmove(void* dst, const void* src, int sz) {
     unsigned char* d = (unsigned char*) dst;
     unsigned char* s = (unsigned char*) src;
-    int i;
     if (d < s) {
-        for (i = 0; i < sz; i++) {
-            *(d++) = *(s++);
-        }
+        fwdcopy((char*) d, (const char*) s, sz);
     } else {
         d += sz;
         s += sz;
-        for (i = 0; i < sz; i++) {
+        if (sz >= WORD_MIN_BYTES && WORD_ALIGNED(d, s)) {
+            while (((unsigned long)d & 3) != 0) {
+                *(--d) = *(--s);
+                sz--;
+            }
+            uint32_t* wd = (uint32_t*) d;
+            uint32_t* ws = (uint32_t*) s;
+            while (sz >= 16) {
+                wd -= 4;
+                ws -= 4;
+                wd[3] = ws[3];
+                wd[2] = ws[2];
+                wd[1] = ws[1];
+                wd[0] = ws[0];
+                sz -= 16;
+            }
+            while (sz >= 4) {
+                *(--wd) = *(--ws);
+                sz -= 4;
+            }
+            d = (unsigned char*) wd;
+            s = (unsigned char*) ws;
+        }
+        while (sz-- > 0) {
             *(--d) = *(--s);
         }
     }
@@ -15,6 +15,7 @@
 //
 // History:         July 2019    - Initial framework creation.
 //                  April 2020   - Updates to function with the K64F processor and zOS.
+//                  Oct 2026     - Report the sector cache statistics when the cache layer is active.
 //
 // Notes:           See Makefile to enable/disable conditional components
 //
@@ -72,8 +73,8 @@
 #include "tools.c"
 
 // Version info.
-#define VERSION      "v1.1"
-#define VERSION_DATE "10/04/2020"
+#define VERSION      "v1.2"
+#define VERSION_DATE "16/10/2026"
 #define APP_NAME     "DSTAT"
 
 // Main entry and start point of a zOS/ZPUTA Application. Only 2 parameters are catered for and a 32bit return code, additional parameters can be added by changing the appcrt0.s
@@ -91,6 +92,7 @@ uint32_t app(uint32_t param1, uint32_t param2)
     long      drive;
     long      sector;
     uint8_t   cardType;
+    DCACHE_STAT cacheStat;
 
     if (xatoi(&ptr, &drive))
     {
@@ -131,6 +133,17 @@ uint32_t app(uint32_t param1, uint32_t param2)
         {
             line[20] = '\0'; printf("S/N: %s\n", line);
         }
+        if (disk_ioctl((BYTE)drive, CTRL_CACHE_STAT, &cacheStat) == RES_OK)
+        {
+            printf("Sector cache: %u sets x %u ways, %u dirty\n", cacheStat.sets, cacheStat.ways, cacheStat.dirty);
+            printf("  Read  hits: %lu misses: %lu", cacheStat.readHits, cacheStat.readMisses);
+            if((cacheStat.readHits + cacheStat.readMisses) > 0)
+            {
+                printf(" (%lu%%)", (cacheStat.readHits * 100) / (cacheStat.readHits + cacheStat.readMisses));
+            }
+            printf("\n  Write hits: %lu misses: %lu write-backs: %lu\n", cacheStat.writeHits, cacheStat.writeMisses, cacheStat.writeBacks);
+            printf("  Bypass reads: %lu writes: %lu\n", cacheStat.bypassReads, cacheStat.bypassWrites);
+        }
     } else
     {
          printf("Illegal <#pd> value.\n");
@@ -22,6 +22,8 @@
 // History:         April 2020   - Ported v0.0.1 of Kilo and stripped it of features to get a leaner
 //                                 memory using editor. Some functionality has been lost from the 
 //                                 original editor but it is still very useable.
+//                  Oct 2026     - Text held in a piece table read from the SD card on demand, only the
+//                                 rows on screen are held in memory, in a row cache.
 //
 // Notes:           See Makefile to enable/disable conditional components
 //
@@ -40,7 +42,7 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-#define ED_VERSION "1.0"
+#define ED_VERSION "1.1"
 
 #ifdef __cplusplus
     extern "C" {
@@ -67,6 +69,7 @@
 #endif
 #include "interrupts.h"
 #include "ff.h"            /* Declarations of FatFs API */
+#include "textbuf.h"
 #include "utils.h"
 //
 #if defined __ZPUTA__
@@ -84,14 +87,15 @@
 #include "tools.c"
 
 // Version info.
-#define VERSION              "v1.0"
-#define VERSION_DATE         "22/04/2020"
+#define VERSION              "v1.1"
+#define VERSION_DATE         "16/10/2026"
 #define APP_NAME             "ED"
 
 #define MAX_APPEND_BUFSIZE   1024
 #define ED_QUIT_TIMES        3
 #define ED_QUERY_LEN         256
 #define ED_TAB_SIZE          4
+#define ED_ROW_ALLOC         80
 
 
 struct editorSyntax {
@@ -105,8 +109,9 @@ struct editorSyntax {
 
 /* This structure represents a single line of the file we are editing. */
 typedef struct erow {
-    int idx;                /* Row index in the file, zero-based. */
+    int idx;                /* Row index in the file, zero-based, -1 when unused. */
     int size;               /* Size of the row, excluding the null term. */
+    int alloc;              /* Bytes allocated to chars. */
     char *chars;            /* Row content. */
 } erow;
 
@@ -117,7 +122,9 @@ struct editorConfig {
     int screenrows;         /* Number of rows that we can show */
     int screencols;         /* Number of cols that we can show */
     int numrows;            /* Number of rows */
-    erow *row;              /* Rows */
+    erow *row;              /* Cache of the rows being displayed. */
+    int rowcache;           /* Number of rows in the cache. */
+    t_textBuf text;         /* Text of the file. */
     int dirty;              /* File modified but not saved. */
     char *filename;         /* Currently open filename */
     char statusmsg[80];
@@ -350,42 +357,80 @@ int getWindowSize(int *rows, int *cols)
 
 /* ======================= Editor rows implementation ======================= */
 
-/* Insert a row at the specified position, shifting the other rows on the bottom
- * if required.
+/* The file is held in a piece table, E.text, which reads it from the SD card
+ * as needed. Only the rows being displayed are held in memory, in a cache of
+ * E.rowcache entries indexed by the file row modulo the cache size.
 */
-int editorInsertRow(int at, char *s, size_t len)
+
+/* Drop the cached rows from the given file row onwards, they are reloaded
+ * when next needed.
+*/
+void editorInvalidateRows(int from)
 {
-	int j;
+    int j;
 
-    if (at > E.numrows) return 0;
+    for (j = 0; j < E.rowcache; j++)
+        if (E.row[j].idx >= from) E.row[j].idx = -1;
+}
 
-    E.row = sys_realloc(E.row,sizeof(erow)*(E.numrows+1));
-    if(E.row == NULL) { printf("editorInsertRow: Memory exhausted\n"); return 1; }
+/* Return the row at the given file position, loading it into the row cache
+ * if needed, or NULL if there is no such row.
+*/
+erow *editorRow(int filerow)
+{
+    erow *row;
+    char *chars;
+    int  len;
 
-    if (at != E.numrows)
+    if (filerow < 0 || filerow >= E.numrows || E.row == NULL) return NULL;
+    row = &E.row[filerow % E.rowcache];
+    if (row->idx == filerow) return row;
+
+    row->idx = -1;
+    if (row->chars == NULL)
+    {
+        row->chars = sys_malloc(ED_ROW_ALLOC);
+        if(row->chars == NULL) { printf("editorRow: Memory exhausted\n"); return NULL; }
+        row->alloc = ED_ROW_ALLOC;
+    }
+    len = tbGetLine(&E.text, filerow, row->chars, row->alloc);
+    if (len >= row->alloc)
     {
-        memmove(E.row+at+1,E.row+at,sizeof(E.row[0])*(E.numrows-at));
-        for (j = at+1; j <= E.numrows; j++) E.row[j].idx++;
+        chars = sys_realloc(row->chars, len+1);
+        if(chars == NULL) { printf("editorRow: Memory exhausted\n"); return NULL; }
+        row->chars = chars;
+        row->alloc = len+1;
+        len = tbGetLine(&E.text, filerow, row->chars, row->alloc);
     }
+    if (len < 0) return NULL;
+    row->size = len;
+    row->idx = filerow;
+    return row;
+}
 
-    E.row[at].size = len;
-    E.row[at].chars = sys_malloc(len+1);
-    if(E.row[at].chars == NULL) { printf("editorInsertRow: Memory exhausted\n"); return 1; }
-    memcpy(E.row[at].chars,s,len+1);
-    E.row[at].idx = at;
-    E.numrows++;
-    E.dirty++;
-    return 0;
+/* Report a failed piece table update on the status line. */
+int editorTextError(int result)
+{
+    if (result == TB_OK) return 0;
+    sprintf(E.statusmsg, result == TB_NO_MEMORY ? "Memory exhausted" : "File read error");
+    E.statusmsg_time = sysmillis();
+    return 1;
 }
 
-/* Free row's heap allocated stuff. */
-void editorFreeRow(erow *row)
+/* Insert a row at the specified position, shifting the other rows on the bottom
+ * if required.
+*/
+int editorInsertRow(int at, char *s, size_t len)
 {
-    if(row->chars != NULL)
-    {
-        sys_free(row->chars);
-        row->chars = NULL;
-    }
+    if (at > E.numrows) return 0;
+
+    /* The newline goes in first so appending after the last row works. */
+    if (editorTextError(tbInsert(&E.text, at, 0, "\n", 1)) ||
+        editorTextError(tbInsert(&E.text, at, 0, s, len))) return 1;
+    E.numrows = E.text.lines;
+    editorInvalidateRows(at);
+    E.dirty++;
+    return 0;
 }
 
 // Method to release all used memory back to the heap.
@@ -394,12 +439,12 @@ void editorCleanup(void)
 {
     int  idx;
 
-    // Free the editor config structure.
+    // Free the row cache.
     if(E.row)
     {
         // Go through and free all row memory.
         //
-        for(idx=0; idx < E.numrows; idx++)
+        for(idx=0; idx < E.rowcache; idx++)
         {
             if(E.row[idx].chars != NULL)
             {
@@ -410,6 +455,9 @@ void editorCleanup(void)
         sys_free(E.row);
     }
 
+    // Close the file and release the piece table.
+    tbFree(&E.text);
+
     // Reset necessary variables.
     E.cx = 0;
     E.cy = 0;
@@ -417,70 +465,32 @@ void editorCleanup(void)
     E.coloff = 0;
     E.numrows = 0;
     E.row = NULL;
+    E.rowcache = 0;
     E.dirty = 0;
     return;
 }
 
-/* Remove the row at the specified position, shifting the remainign on the
- * top. */
-void editorDelRow(int at) {
-	int j;
-    erow *row;
-
-    if (at >= E.numrows) return;
-    row = E.row+at;
-    editorFreeRow(row);
-    memmove(E.row+at,E.row+at+1,sizeof(E.row[0])*(E.numrows-at-1));
-    for (j = at; j < E.numrows-1; j++) E.row[j].idx++;
-    E.numrows--;
-    E.dirty++;
-}
-
 /* Insert a character at the specified position in a row, moving the remaining
  * chars on the right if needed.
 */
 int editorRowInsertChar(erow *row, int at, int c)
 {
-    if (at > row->size)
-    {
-        /* Pad the string with spaces if the insert location is outside the
-         * current length by more than a single character.
-        */
-        int padlen = at-row->size;
+    char ch = c;
+    int  filerow = row->idx;
+    int  padlen;
 
-        /* In the next line +2 means: new char and null term.
-        */
-        row->chars = sys_realloc(row->chars,row->size+padlen+2);
-        if(row->chars == NULL) { printf("editorRowInsertChar: Memory exhausted\n"); return 1; }
-        memset(row->chars+row->size,' ',padlen);
-        row->chars[row->size+padlen+1] = '\0';
-        row->size += padlen+1;
-    } else {
-        /* If we are in the middle of the string just make space for 1 new
-         * char plus the (already existing) null term.
-        */
-        row->chars = sys_realloc(row->chars,row->size+2);
-        if(row->chars == NULL) { printf("editorRowInsertChar: Memory exhausted\n"); return 1; }
-        memmove(row->chars+at+1,row->chars+at,row->size-at+1);
-        row->size++;
+    /* Pad the string with spaces if the insert location is outside the
+     * current length by more than a single character.
+    */
+    while (at > row->size)
+    {
+        padlen = at-row->size > 8 ? 8 : at-row->size;
+        if (editorTextError(tbInsert(&E.text, filerow, row->size, "        ", padlen))) return 1;
+        row->size += padlen;
     }
-    row->chars[at] = c;
+    if (editorTextError(tbInsert(&E.text, filerow, at, &ch, 1))) return 1;
+    row->idx = -1;
     E.dirty++;
-
-    return 0;
-}
-
-/* Append the string 's' at the end of a row */
-int editorRowAppendString(erow *row, char *s, size_t len)
-{
-    row->chars = sys_realloc(row->chars,row->size+len+1);
-    if(row->chars == NULL) { printf("editorRowAppendString: Memory exhausted\n"); return 1; }
-    memcpy(row->chars+row->size,s,len);
-
-    row->size += len;
-    row->chars[row->size] = '\0';
-    E.dirty++;
-
     return 0;
 }
 
@@ -488,8 +498,8 @@ int editorRowAppendString(erow *row, char *s, size_t len)
 int editorRowDelChar(erow *row, int at)
 {
     if (row->size <= at) return 0;
-    memmove(row->chars+at,row->chars+at+1,row->size-at);
-    row->size--;
+    if (editorTextError(tbDelete(&E.text, row->idx, at, 1))) return 1;
+    row->idx = -1;
     E.dirty++;
     return 0;
 }
@@ -499,7 +509,7 @@ void editorInsertChar(int c)
 {
     int filerow = E.rowoff+E.cy;
     int filecol = E.coloff+E.cx;
-    erow *row = (filerow >= E.numrows) ? NULL : &E.row[filerow];
+    erow *row = editorRow(filerow);
 
     /* If the row where the cursor is currently located does not exist in our
      * logical representaion of the file, add enough empty rows as needed. */
@@ -510,7 +520,7 @@ void editorInsertChar(int c)
             if(editorInsertRow(E.numrows,"",0) != 0) return;
         }
     }
-    row = &E.row[filerow];
+    if ((row = editorRow(filerow)) == NULL) return;
     editorRowInsertChar(row,filecol,c);
     if (E.cx == E.screencols-1)
         E.coloff++;
@@ -519,14 +529,14 @@ void editorInsertChar(int c)
     E.dirty++;
 }
 
-/* Inserting a newline is slightly complex as we have to handle inserting a
- * newline in the middle of a line, splitting the line as needed.
+/* Inserting a newline splits the line at the cursor, or adds an empty row when
+ * the cursor is on the row after the last.
 */
 int editorInsertNewline(void)
 {
     int filerow = E.rowoff+E.cy;
     int filecol = E.coloff+E.cx;
-    erow *row = (filerow >= E.numrows) ? NULL : &E.row[filerow];
+    erow *row = editorRow(filerow);
 
     if (!row)
     {
@@ -540,17 +550,10 @@ int editorInsertNewline(void)
     /* If the cursor is over the current line size, we want to conceptually
      * think it's just over the last character. */
     if (filecol >= row->size) filecol = row->size;
-    if (filecol == 0)
-    {
-        if(editorInsertRow(filerow,"",0) != 0) return 1;
-    } else
-    {
-        /* We are in the middle of a line. Split it between two rows. */
-        if(editorInsertRow(filerow+1,row->chars+filecol,row->size-filecol) != 0) return 1;
-        row = &E.row[filerow];
-        row->chars[filecol] = '\0';
-        row->size = filecol;
-    }
+    if (editorTextError(tbInsert(&E.text, filerow, filecol, "\n", 1))) return 1;
+    E.numrows = E.text.lines;
+    editorInvalidateRows(filerow);
+    E.dirty++;
 fixcursor:
     if (E.cy == E.screenrows-1)
     {
@@ -569,7 +572,8 @@ int editorDelChar()
 {
     int filerow = E.rowoff+E.cy;
     int filecol = E.coloff+E.cx;
-    erow *row = (filerow >= E.numrows) ? NULL : &E.row[filerow];
+    erow *row = editorRow(filerow);
+    erow *prev;
 
     if (!row || (filecol == 0 && filerow == 0)) return 0;
     if (filecol == 0)
@@ -577,10 +581,11 @@ int editorDelChar()
         /* Handle the case of column 0, we need to move the current line
          * on the right of the previous one.
         */
-        filecol = E.row[filerow-1].size;
-        editorRowAppendString(&E.row[filerow-1],row->chars,row->size);
-        editorDelRow(filerow);
-        row = NULL;
+        if ((prev = editorRow(filerow-1)) == NULL) return 1;
+        filecol = prev->size;
+        if (editorTextError(tbJoinLines(&E.text, filerow-1))) return 1;
+        E.numrows = E.text.lines;
+        editorInvalidateRows(filerow-1);
         if (E.cy == 0)
             E.rowoff--;
         else
@@ -594,7 +599,7 @@ int editorDelChar()
         }
     } else
     {
-        editorRowDelChar(row,filecol-1);
+        if (editorRowDelChar(row,filecol-1)) return 1;
         if (E.cx == 0 && E.coloff)
             E.coloff--;
         else
@@ -604,68 +609,34 @@ int editorDelChar()
     return 0;
 }
 
-/* Load the specified program in the editor memory and returns 0 on success
- * or 1 on error.
+/* Open the specified file in the editor and returns 0 on success, 1 if memory
+ * is exhausted or 2 if the file cannot be opened. The file is indexed but not
+ * loaded, rows are read as they are displayed.
 */
 int editorOpen(char *filename)
 {
-    FIL     fp;
-    FRESULT fr;
-    char    buf[132];
-    uint8_t linelen;
-    int     rowNo;
+    int result;
+    int idx;
 
     E.dirty = 0;
     E.filename = filename;
-    fr = f_open(&fp, filename, FA_OPEN_ALWAYS | FA_READ);
-    if(fr)
+
+    result = tbOpen(&E.text, filename);
+    if(result == TB_IO_ERROR)
     {
         printf("Failed to open file:%s\n", filename);
         return 2;
     }
+    if(result != TB_OK) return 1;
 
-    // First parse to get number of lines in file to better allocate memory.
+    // Allocate the row cache, enough rows for the screen.
     //
-    E.numrows = 0;
-    while(f_gets(buf, sizeof(buf), &fp) != NULL)
-    {
-        E.numrows++;
-    }
-    fr = f_lseek(&fp, 0);
-    if(fr)
-    {
-        printf("Failed to rewind file:%s\n", filename);
-        return 3;
-    }
-
-    // If there is data in the file, load it.
-    //
-    if(E.numrows)
-    {
-        // Allocate memory for the row array.
-        //
-        E.row = sys_malloc(sizeof(erow)*(E.numrows));
-        if(E.row == NULL) { printf("editorOpen: Memory exhausted\n"); return 1; }
-        memset(E.row, '\0', sizeof(erow)*(E.numrows));
-
-        // Now go through the file again and populate each row with the data.
-        //
-        rowNo = 0;
-        while(f_gets(buf, sizeof(buf), &fp) != NULL)
-        {
-            linelen = strlen(buf);
-            if (linelen && (buf[linelen-1] == '\n' || buf[linelen-1] == '\r'))
-                buf[--linelen] = '\0';
-
-            E.row[rowNo].size = linelen;
-            E.row[rowNo].chars = sys_malloc(linelen+1);
-            if(E.row[rowNo].chars == NULL) { printf("editorOpen: Memory exhausted\n"); return 1; }
-            memcpy(E.row[rowNo].chars, buf, linelen+1);
-            E.row[rowNo].idx = rowNo;
-            rowNo++;
-        }
-    }
-    f_close(&fp);
+    E.rowcache = E.screenrows+1;
+    E.row = sys_malloc(sizeof(erow)*E.rowcache);
+    if(E.row == NULL) { printf("editorOpen: Memory exhausted\n"); E.rowcache = 0; return 1; }
+    memset(E.row, '\0', sizeof(erow)*E.rowcache);
+    for(idx=0; idx < E.rowcache; idx++) E.row[idx].idx = -1;
+    E.numrows = E.text.lines;
     return 0;
 }
 
@@ -674,49 +645,21 @@ int editorOpen(char *filename)
 */
 int editorSave(char *newFileName)
 {
-    FIL          fp;
-    FRESULT      fr;
-    unsigned int bytes;
-    int          totlen = 0;
-    int          j;
-
-    // Open existing file or create.
-    fr = f_open(&fp, (newFileName == NULL ? E.filename : newFileName), FA_OPEN_ALWAYS | FA_WRITE | FA_READ);
-    if(fr)
+    uint32_t written;
+    int      result;
+
+    result = tbSave(&E.text, (newFileName == NULL ? E.filename : newFileName), &written);
+    if(result != TB_OK)
     {
-        sprintf(E.statusmsg, "Failed to open file:%s\n", (newFileName == NULL ? E.filename : newFileName));
+        sprintf(E.statusmsg, result == TB_NO_MEMORY ? "Can't save! Memory exhausted" : "Can't save! I/O error");
         E.statusmsg_time = sysmillis();
         return 1;
     }
 
-    /* Use truncate to zero the file the loop through the line buffers and
-     * write the contents to the file.
-    */
-    if (f_truncate(&fp) != 0) goto writeerr;
-
-    // Loop through the row records and write out the characters.
-    //
-    totlen = 0;
-    for (j = 0; j < E.numrows; j++)
-    {
-        fr = f_write(&fp, E.row[j].chars, E.row[j].size, &bytes);
-        if(fr != 0) goto writeerr;
-        fr = f_putc('\n', &fp);
-        if(fr == -1) goto writeerr;
-        totlen += bytes + 1;
-    }
-    f_close(&fp);
-
     E.dirty = 0;
-    sprintf(E.statusmsg, "%d bytes written on disk", totlen);
+    sprintf(E.statusmsg, "%lu bytes written on disk", (unsigned long)written);
     E.statusmsg_time = sysmillis();
     return 0;
-
-writeerr:
-    f_close(&fp);
-    sprintf(E.statusmsg, "Can't save! I/O error");
-    E.statusmsg_time = sysmillis();
-    return 1;
 }
 
 /* ============================= Terminal update ============================ */
@@ -816,9 +759,9 @@ int editorRefreshScreen(void)
             continue;
         }
 
-        r = &E.row[filerow];
+        r = editorRow(filerow);
 
-        int len = r->size - E.coloff;
+        int len = r ? r->size - E.coloff : 0;
         if (len > 0) {
             if (len > E.screencols) len = E.screencols;
             char *c = r->chars+E.coloff;
@@ -886,7 +829,7 @@ int editorRefreshScreen(void)
     int j;
     int cx = 1;
     int filerow = E.rowoff+E.cy;
-    erow *row = (filerow >= E.numrows) ? NULL : &E.row[filerow];
+    erow *row = editorRow(filerow);
     if (row)
     {
         for (j = E.coloff; j < (E.cx+E.coloff); j++)
@@ -912,6 +855,8 @@ void editorFind(void) {
     int qlen = 0;
     int last_match = -1; /* Last line where a match was found. -1 for none. */
     int find_next = 0; /* if 1 search next, if -1 search prev. */
+    char *line = NULL; /* Line being searched, read from the text buffer. */
+    int linesize = 0;
 
     /* Save the cursor position in order to restore it later. */
     int saved_cx = E.cx, saved_cy = E.cy;
@@ -932,6 +877,7 @@ void editorFind(void) {
                 E.cx = saved_cx; E.cy = saved_cy;
                 E.coloff = saved_coloff; E.rowoff = saved_rowoff;
             }
+            if (line) sys_free(line);
 	    E.statusmsg[0] = '\0';
             E.statusmsg_time = sysmillis();
             return;
@@ -952,15 +898,25 @@ void editorFind(void) {
         if (find_next) {
             char *match = NULL;
             int match_offset = 0;
-            int i, current = last_match;
+            int i, len, current = last_match;
+            char *newline;
 
             for (i = 0; i < E.numrows; i++) {
                 current += find_next;
                 if (current == -1) current = E.numrows-1;
                 else if (current == E.numrows) current = 0;
-                match = strstr(E.row[current].chars,query);
+                len = tbGetLine(&E.text, current, line, linesize);
+                if (len >= linesize) {
+                    newline = sys_realloc(line, len+ED_QUERY_LEN);
+                    if (newline == NULL) { printf("editorFind: Memory exhausted\n"); break; }
+                    line = newline;
+                    linesize = len+ED_QUERY_LEN;
+                    len = tbGetLine(&E.text, current, line, linesize);
+                }
+                if (len < 0) break;
+                match = strstr(line,query);
                 if (match) {
-                    match_offset = match-E.row[current].chars;
+                    match_offset = match-line;
                     break;
                 }
             }
@@ -991,7 +947,7 @@ void editorMoveCursor(int key)
     int filerow = E.rowoff+E.cy;
     int filecol = E.coloff+E.cx;
     int rowlen;
-    erow *row = (filerow >= E.numrows) ? NULL : &E.row[filerow];
+    erow *row = editorRow(filerow);
 
     switch(key)
     {
@@ -1002,7 +958,8 @@ void editorMoveCursor(int key)
                 } else {
                     if (filerow > 0) {
                         E.cy--;
-                        E.cx = E.row[filerow-1].size;
+                        row = editorRow(filerow-1);
+                        E.cx = row ? row->size : 0;
                         if (E.cx > E.screencols-1) {
                             E.coloff = E.cx-E.screencols+1;
                             E.cx = E.screencols-1;
@@ -1061,7 +1018,7 @@ void editorMoveCursor(int key)
             break;
 
         case END_KEY:
-            E.cx = row->size;
+            E.cx = row ? row->size : 0;
             E.coloff = 0;
             if (E.cx > E.screencols-1)
             {
@@ -1073,7 +1030,7 @@ void editorMoveCursor(int key)
     /* Fix cx if the current line has not enough chars. */
     filerow = E.rowoff+E.cy;
     filecol = E.coloff+E.cx;
-    row = (filerow >= E.numrows) ? NULL : &E.row[filerow];
+    row = editorRow(filerow);
     rowlen = row ? row->size : 0;
     if (filecol > rowlen)
     {
@@ -1206,8 +1163,10 @@ uint32_t initEditor(void)
     E.coloff = 0;
     E.numrows = 0;
     E.row = NULL;
+    E.rowcache = 0;
     E.dirty = 0;
     E.filename = NULL;
+    tbInit(&E.text);
     E.syntax = NULL;
     if (getWindowSize(&E.screenrows,&E.screencols) == -1)
     {
@@ -0,0 +1,177 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            fcrc.c
+// Created:         October 2026
+// Author(s):       Philip Smart
+// Description:     Standalone App for the zOS/ZPU test application.
+//                  This program implements a loadable appliation which can be loaded from SD card by
+//                  the zOS/ZPUTA application. The idea is that commands or programs can be stored on the
+//                  SD card and executed by zOS/ZPUTA just like an OS such as Linux. The primary purpose
+//                  is to be able to minimise the size of zOS/ZPUTA for applications where minimal ram is
+//                  available.
+//
+// Credits:         
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         Oct 2026     - Initial version, CRC32 checksum of one or more files using the slicing-by-8
+//                                 CRC in common/crc32.c. The result matches the standard crc32/cksum -a crc32b
+//                                 tools on a host so images can be checked after copying to the SD card.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+#if defined(__K64F__)
+  #include <stdio.h>
+  #include <stdint.h>
+  #include <string.h>
+  #include "k64f_soc.h"
+  #include <../../libraries/include/stdmisc.h>
+#elif defined(__ZPU__)
+  #include <stdint.h>
+  #include <stdio.h>	    
+  #include "zpu_soc.h"
+  #include <stdlib.h>
+  #include <string.h>
+  #include <stdmisc.h>
+#else
+  #error "Target CPU not defined, use __ZPU__ or __K64F__"
+#endif
+#include "interrupts.h"
+#include "ff.h"            /* Declarations of FatFs API */
+#include "utils.h"
+//
+#if defined __ZPUTA__
+  #include "zputa_app.h"
+#elif defined __ZOS__
+  #include "zOS_app.h"
+#else
+  #error OS not defined, use __ZPUTA__ or __ZOS__      
+#endif
+//
+#include "app.h"
+#include "crc32.h"
+#include "fcrc.h"
+
+// Utility functions.
+#include "tools.c"
+
+// Version info.
+#define VERSION      "v1.0"
+#define VERSION_DATE "16/10/2026"
+#define APP_NAME     "FCRC"
+
+// File read buffer, word aligned for the CRC word loads.
+uint32_t crcBuff[FCRC_BUFFER_SIZE / sizeof(uint32_t)];
+
+// Method to calculate the CRC32 of a file, the size is returned along with the CRC.
+//
+FRESULT fileCrc(char *src, uint32_t *crc, uint32_t *size)
+{
+    // Locals.
+    //
+    FIL          File;
+    unsigned int readSize;
+    FRESULT      fr;
+
+    // Try and open the source file.
+    fr = f_open(&File, src, FA_OPEN_EXISTING | FA_READ);
+    if(fr)
+        return(fr);
+
+    *crc  = crc32_init();
+    *size = 0;
+    while((fr = f_read(&File, crcBuff, FCRC_BUFFER_SIZE, &readSize)) == FR_OK && readSize > 0)
+    {
+        *crc   = crc32_update(*crc, crcBuff, readSize);
+        *size += readSize;
+    }
+    *crc = ~(*crc);
+
+    f_close(&File);
+    return(fr);
+}
+
+// Main entry and start point of a zOS/ZPUTA Application. Only 2 parameters are catered for and a 32bit return code, additional parameters can be added by changing the appcrt0.s
+// startup code to add them to the stack prior to app() call.
+//
+// Return code for the ZPU is saved in _memreg by the C compiler, this is transferred to _memreg in zOS/ZPUTA in appcrt0.s prior to return.
+// The K64F ARM processor uses the standard register passing conventions, return code is stored in R0.
+//
+uint32_t app(uint32_t param1, uint32_t param2)
+{
+    // Initialisation.
+    //
+    char      *ptr       = (char *)param1;
+    char      *fileName;
+    uint32_t  retCode    = 0;
+    uint32_t  crc;
+    uint32_t  size;
+    uint32_t  totalSize  = 0;
+    uint32_t  mSec;
+    uint32_t  files      = 0;
+  #if defined __K64F__
+    uint32_t  perfTime   = *G->millis;
+  #endif
+    FRESULT   fr;
+
+  #if defined __ZPU__
+    TIMER_MILLISECONDS_UP = 0;
+  #endif
+
+    // Checksum each file named on the command line.
+    while(*(fileName = getStrParam(&ptr)) != 0x00)
+    {
+        fr = fileCrc(fileName, &crc, &size);
+        if(fr)
+        {
+            printf("%s: ", fileName);
+            printFSCode(fr);
+            retCode = 0xffffffff;
+        } else
+        {
+            printf("%08lX %10lu  %s\n", crc, size, fileName);
+            totalSize += size;
+        }
+        files++;
+    }
+    if(files == 0)
+    {
+        printf("Illegal <file> value.\n");
+        return(0xffffffff);
+    }
+
+    // Throughput of the read and checksum.
+  #if defined __ZPU__
+    mSec = TIMER_MILLISECONDS_UP;
+  #elif defined __K64F__
+    mSec = *G->millis - perfTime;
+  #else
+    #error "Target CPU not defined, use __ZPU__ or __K64F__"
+  #endif
+    if(totalSize > 0)
+        printBytesPerSec(totalSize, mSec > 0 ? mSec : 1, "checksummed");
+
+    return(retCode);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,55 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            fcrc.h
+// Created:         October 2026
+// Author(s):       Philip Smart
+// Description:     Standalone App for the zOS/ZPU test application.
+//                  This program implements a loadable appliation which can be loaded from SD card by
+//                  the zOS/ZPUTA application. The idea is that commands or programs can be stored on the
+//                  SD card and executed by zOS/ZPUTA just like an OS such as Linux. The primary purpose
+//                  is to be able to minimise the size of zOS/ZPUTA for applications where minimal ram is
+//                  available.
+//
+// Credits:         
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         Oct 2026     - Initial version, CRC32 checksum of one or more files.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef FCRC_H
+#define FCRC_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+// Constants.
+
+// Application execution constants.
+//
+#define FCRC_BUFFER_SIZE            2048                                 // Bytes read from the file per call, a multiple of the sector size.
+
+// Components to be embedded in the program.
+//
+// Filesystem components to be embedded in the program.
+#define BUILTIN_FS_CRC              1
+
+#ifdef __cplusplus
+}
+#endif
+#endif // FCRC_H
@@ -15,6 +15,7 @@
 //
 // History:         July 2019    - Initial framework creation.
 //                  April 2020   - Updates to function with the K64F processor and zOS.
+//                  Oct 2026     - Added a random seek benchmark, normal seek vs fast seek (cluster link map).
 //
 // Notes:           See Makefile to enable/disable conditional components
 //
@@ -71,10 +72,109 @@
 #include "tools.c"
 
 // Version info.
-#define VERSION      "v1.1"
-#define VERSION_DATE "10/04/2020"
+#define VERSION      "v1.2"
+#define VERSION_DATE "16/10/2026"
 #define APP_NAME     "FSEEK"
 
+// A method to access the millisecond counter within the hardware or main OS.
+//
+uint32_t benchMillis(void)
+{
+    uint32_t milliSec;
+
+  #if defined __ZPU__
+    milliSec = (uint32_t)TIMER_MILLISECONDS_UP;
+  #elif defined __K64F__
+    milliSec = (uint32_t)*G->millis;
+  #else
+    #error "Target CPU not defined, use __ZPU__ or __K64F__"
+  #endif    
+    return milliSec;
+}
+
+// Method to seek to a number of pseudo random sector aligned positions across the open file, reading a sector at each,
+// and report the time taken. The same seed is used on every pass so that normal and fast seek modes are compared on
+// identical offsets.
+//
+FRESULT benchSeek(FIL *fp, uint32_t count, const char *mode)
+{
+    // Locals.
+    //
+    uint32_t  seed = FSEEK_BENCH_SEED;
+    uint32_t  sectors = (uint32_t)(f_size(fp) / FSEEK_BENCH_READ);
+    uint32_t  startTime;
+    uint32_t  elapsed;
+    uint32_t  idx;
+    UINT      readSize;
+    FRESULT   fr = FR_OK;
+
+    startTime = benchMillis();
+    for(idx=0; idx < count && fr == FR_OK; idx++)
+    {
+        // Xorshift32, sufficient to spread the seeks over the whole file.
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+
+        fr = f_lseek(fp, (FSIZE_t)(seed % sectors) * FSEEK_BENCH_READ);
+        if(fr == FR_OK)
+            fr = f_read(fp, G->Buff, FSEEK_BENCH_READ, &readSize);
+    }
+    elapsed = benchMillis() - startTime;
+
+    if(fr == FR_OK)
+    {
+        printf("%-12s: %lu seeks in %lums, %luus/seek\n", mode, count, elapsed, (elapsed * 1000) / count);
+    }
+    return(fr);
+}
+
+// Method to benchmark random seeks across the open file, first in normal seek mode, which walks the FAT chain from the
+// start of the file on each seek, then in fast seek mode using a cluster link map table.
+//
+FRESULT benchFile(FIL *fp, uint32_t count)
+{
+    // Locals.
+    //
+  #if FF_USE_FASTSEEK == 1
+    static DWORD clmt[FSEEK_CLMT_SIZE];
+  #endif
+    FSIZE_t   fptr = fp->fptr;
+    FRESULT   fr;
+
+    if(f_size(fp) < FSEEK_BENCH_READ)
+    {
+        printf("File too small to benchmark.\n");
+        return(FR_OK);
+    }
+    printf("Random seek benchmark, file size:%lu\n", (DWORD)f_size(fp));
+
+    fr = benchSeek(fp, count, "Normal seek");
+
+  #if FF_USE_FASTSEEK == 1
+    if(fr == FR_OK)
+    {
+        clmt[0] = FSEEK_CLMT_SIZE;
+        fp->cltbl = clmt;
+        fr = f_lseek(fp, CREATE_LINKMAP);
+        if(fr == FR_OK)
+        {
+            printf("Link map    : %lu fragments\n", (clmt[0] - 2) / 2);
+            fr = benchSeek(fp, count, "Fast seek");
+        } else
+        if(fr == FR_NOT_ENOUGH_CORE)
+        {
+            printf("File too fragmented for a %u entry link map, needs %lu.\n", FSEEK_CLMT_SIZE, clmt[0]);
+            fr = FR_OK;
+        }
+        fp->cltbl = NULL;
+    }
+  #endif
+
+    // Return the file pointer to its original position.
+    if(fr == FR_OK)
+        fr = f_lseek(fp, fptr);
+    return(fr);
+}
+
 // Main entry and start point of a zOS/ZPUTA Application. Only 2 parameters are catered for and a 32bit return code, additional parameters can be added by changing the appcrt0.s
 // startup code to add them to the stack prior to app() call.
 //
@@ -95,6 +195,15 @@ uint32_t app(uint32_t param1, uint32_t param2)
         puts("No file open, cannot seek.\n");
     } else
     {
+        // Benchmark mode, perform random seeks across the file.
+        while(*ptr == ' ') ptr++;
+        if(*ptr == 'b')
+        {
+            ptr++;
+            if (!xatoi(&ptr, &pos) || pos <= 0)
+                pos = FSEEK_BENCH_COUNT;
+            fr = benchFile(&G->File[0], (uint32_t)pos);
+        } else
         if (!xatoi(&ptr, &pos))
         {
             printf("Illegal <pos> value.\n");
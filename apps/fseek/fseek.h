@@ -43,6 +43,10 @@
 
 // Application execution constants.
 //
+#define FSEEK_BENCH_COUNT           1000                                 // Default number of random seeks in benchmark mode.
+#define FSEEK_BENCH_READ            512                                  // Bytes read at each seek position, one sector.
+#define FSEEK_BENCH_SEED            0x2545F491                           // Seed of the pseudo random seek positions, fixed so each mode sees the same offsets.
+#define FSEEK_CLMT_SIZE             256                                  // Size in DWORDS of the cluster link map table used in fast seek mode.
 
 // Components to be embedded in the program.
 //
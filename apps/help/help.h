@@ -15,6 +15,9 @@
 //
 // History:         July 2019    - Initial framework creation.
 //                  April 2020   - Updates to function with the K64F processor and zOS.
+//                  Oct 2026     - Added the mbench and fcrc command flags.
+//                  Oct 2026     - Added the hus command flag.
+//                  Oct 2026     - Added the apps command flag.
 //
 // Notes:           See Makefile to enable/disable conditional components
 //
@@ -61,6 +64,7 @@
   #define BUILTIN_MEM_DIFF            0
   #define BUILTIN_MEM_DUMP            0
   #define BUILTIN_MEM_TEST            0
+  #define BUILTIN_MEM_BENCH           0
   #define BUILTIN_MEM_PERF            0
   #define BUILTIN_MEM_SRCH            0
   #define BUILTIN_MEM_EDIT_BYTES      0
@@ -70,6 +74,7 @@
   #define BUILTIN_HW_SHOW_REGISTER    0
   #define BUILTIN_HW_TEST_TIMERS      0
   #define BUILTIN_HW_TCPU             0
+  #define BUILTIN_HW_UART_STATS       0
   // Filesystem components to be embedded in the program.
   #define BUILTIN_FS_STATUS           0
   #define BUILTIN_FS_DIRLIST          0
@@ -97,6 +102,7 @@
   #define BUILTIN_FS_DUMP             0
   #define BUILTIN_FS_CONCAT           0
   #define BUILTIN_FS_XTRACT           0
+  #define BUILTIN_FS_CRC              0
   #define BUILTIN_FS_SAVE             0
   #define BUILTIN_FS_EXEC             0
   // Test components to be embedded in the program.
@@ -105,6 +111,8 @@
   // Miscellaneous components to be embedded in this program.
   #define BUILTIN_MISC_HELP           1
   #define BUILTIN_MISC_SETTIME        0
+  #define BUILTIN_MISC_APPS           0
+  #define BUILTIN_MISC_EVENTS         0
   #define BUILTIN_MISC_TEST           1
 
 #else
@@ -126,6 +134,7 @@
   #define BUILTIN_MEM_DIFF            0
   #define BUILTIN_MEM_DUMP            0
   #define BUILTIN_MEM_TEST            0
+  #define BUILTIN_MEM_BENCH           0
   #define BUILTIN_MEM_PERF            0
   #define BUILTIN_MEM_SRCH            0
   #define BUILTIN_MEM_EDIT_BYTES      0
@@ -135,6 +144,7 @@
   #define BUILTIN_HW_SHOW_REGISTER    0
   #define BUILTIN_HW_TEST_TIMERS      0
   #define BUILTIN_HW_TCPU             0
+  #define BUILTIN_HW_UART_STATS       0
   // Filesystem components to be embedded in the program.
   #define BUILTIN_FS_STATUS           0
   #define BUILTIN_FS_DIRLIST          0
@@ -162,6 +172,7 @@
   #define BUILTIN_FS_DUMP             0
   #define BUILTIN_FS_CONCAT           0
   #define BUILTIN_FS_XTRACT           0
+  #define BUILTIN_FS_CRC              0
   #define BUILTIN_FS_SAVE             0
   #define BUILTIN_FS_EXEC             0
   // Test components to be embedded in the program.
@@ -170,6 +181,8 @@
   // Miscellaneous components to be embedded in this program.
   #define BUILTIN_MISC_HELP           1
   #define BUILTIN_MISC_SETTIME        0
+  #define BUILTIN_MISC_APPS           0
+  #define BUILTIN_MISC_EVENTS         0
 #endif
 
 #ifdef __cplusplus
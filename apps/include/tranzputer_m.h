@@ -789,6 +789,7 @@ uint8_t                               isZ80Reset(void);
 uint8_t                               isZ80MemorySwapped(void);
 uint8_t                               getZ80IO(uint8_t *);
 void                                  clearZ80Reset(void);
+uint8_t                               setZ80BurstMode(uint8_t);
 void                                  convertSharpFilenameToAscii(char *, char *, uint8_t);
 
 // tranZPUter OS i/f methods.
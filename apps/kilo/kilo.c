@@ -20,6 +20,11 @@
 //
 // History:         April 2020   - Ported v0.0.1 of Kilo and made quite a few changes for it to work
 //                                 in an embedded environment.
+//                  Oct 2026     - Screen buffer written with fwrite so it reaches the console as a block.
+//                  Oct 2026     - Screen shadow, a refresh only sends the changed spans of each row with
+//                                 the cheapest cursor motion. Ctrl-D shows the bytes sent per refresh.
+//                  Oct 2026     - Text held in a piece table read from the SD card on demand, only the
+//                                 rows on screen are rendered and highlighted, in a row cache.
 //
 // Notes:           See Makefile to enable/disable conditional components
 //
@@ -66,6 +71,7 @@
 #endif
 #include "interrupts.h"
 #include "ff.h"            /* Declarations of FatFs API */
+#include "textbuf.h"
 #include "utils.h"
 //
 #if defined __ZPUTA__
@@ -83,8 +89,8 @@
 #include "tools.c"
 
 // Version info.
-#define VERSION              "v1.01"
-#define VERSION_DATE         "10/04/2020"
+#define VERSION              "v1.03"
+#define VERSION_DATE         "16/10/2026"
 #define APP_NAME             "KILO"
 
 /* Syntax highlight types */
@@ -105,6 +111,8 @@
 #define KILO_QUIT_TIMES      3
 #define KILO_QUERY_LEN       256
 #define KILO_TAB_SIZE        4
+#define KILO_ROW_ALLOC       80     /* Initial allocation for a cached row. */
+#define KILO_HL_LOOKBACK     40     /* Rows scanned back for an open comment when the row above is not cached. */
 
 
 struct editorSyntax {
@@ -118,8 +126,9 @@ struct editorSyntax {
 
 /* This structure represents a single line of the file we are editing. */
 typedef struct erow {
-    int idx;                /* Row index in the file, zero-based. */
+    int idx;                /* Row index in the file, zero-based, -1 if the cache entry is unused. */
     int size;               /* Size of the row, excluding the null term. */
+    int alloc;              /* Bytes allocated to chars. */
     int rsize;              /* Size of the rendered row. */
     char *chars;            /* Row content. */
     char *render;           /* Row content "rendered" for screen (for TABs). */
@@ -138,7 +147,9 @@ struct editorConfig {
     int screenrows;         /* Number of rows that we can show */
     int screencols;         /* Number of cols that we can show */
     int numrows;            /* Number of rows */
-    erow *row;              /* Rows */
+    erow *row;              /* Cache of the rows being displayed. */
+    int rowcache;           /* Number of rows in the cache. */
+    t_textBuf text;         /* The file, held in a piece table. */
     int dirty;              /* File modified but not saved. */
     char *filename;         /* Currently open filename */
     char statusmsg[80];
@@ -433,6 +444,52 @@ int editorRowHasOpenComment(erow *row)
     return 0;
 }
 
+/* Return true if the row before the given file row ends inside a multi line
+ * comment. Normally the row above is in the row cache, otherwise, rather than
+ * highlighting the file from the start, up to KILO_HL_LOOKBACK rows are
+ * scanned for comment delimiters outside of strings.
+*/
+int editorPrevOpenComment(int filerow)
+{
+    char buf[KILO_QUERY_LEN];
+    char *p;
+    char quote;
+    int  row;
+    int  in_comment = 0;
+    erow *prev;
+
+    if (filerow <= 0 || E.syntax == NULL || E.row == NULL) return 0;
+    prev = &E.row[(filerow-1) % E.rowcache];
+    if (prev->idx == filerow-1) return prev->hl_oc;
+
+    char *scs = E.syntax->singleline_comment_start;
+    char *mcs = E.syntax->multiline_comment_start;
+    char *mce = E.syntax->multiline_comment_end;
+    for (row = filerow > KILO_HL_LOOKBACK ? filerow-KILO_HL_LOOKBACK : 0; row < filerow; row++)
+    {
+        if (tbGetLine(&E.text, row, buf, sizeof(buf)) < 0) return 0;
+        for (p = buf; *p; p++)
+        {
+            if (in_comment)
+            {
+                if (p[0] == mce[0] && p[1] == mce[1]) { in_comment = 0; p++; }
+            } else if (p[0] == scs[0] && p[1] == scs[1])
+            {
+                break;
+            } else if (p[0] == mcs[0] && p[1] == mcs[1])
+            {
+                in_comment = 1; p++;
+            } else if (*p == '"' || *p == '\'')
+            {
+                for (quote = *p++; *p && *p != quote; p++)
+                    if (*p == '\\' && p[1]) p++;
+                if (!*p) break;
+            }
+        }
+    }
+    return in_comment;
+}
+
 /* Set every byte of row->hl (that corresponds to every character in the line)
  * to the right syntax highlight type (HL_* defines). */
 int editorUpdateSyntax(erow *row)
@@ -467,7 +524,7 @@ int editorUpdateSyntax(erow *row)
     /* If the previous line has an open comment, this line starts
      * with an open comment state.
     */
-    if (row->idx > 0 && editorRowHasOpenComment(&E.row[row->idx-1]))
+    if (editorPrevOpenComment(row->idx))
         in_comment = 1;
 
     while(*p)
@@ -582,16 +639,9 @@ int editorUpdateSyntax(erow *row)
         p++; i++;
     }
 
-    /* Propagate syntax change to the next row if the open commen
-     * state changed. This may recursively affect all the following rows
-     * in the file.
+    /* A change in the open comment state is propagated to the rows below
+     * by editorRowChanged().
     */
-    int oc = editorRowHasOpenComment(row);
-    if (row->hl_oc != oc && row->idx+1 < E.numrows)
-    {
-        if(editorUpdateSyntax(&E.row[row->idx+1])) { printf("Exit from here\n"); return 1; }
-    }
-    row->hl_oc = oc;
     return 0;
 }
 
@@ -641,6 +691,13 @@ void editorSelectSyntaxHighlight(char *filename)
 
 /* ======================= Editor rows implementation ======================= */
 
+/* The file is held in a piece table, E.text, which reads it from the SD card
+ * as needed. Only the rows being displayed are held as erow's, rendered and
+ * highlighted, in a cache of E.rowcache entries indexed by the file row modulo
+ * the cache size. The cache has room for the screen plus the row above so the
+ * rows on screen never evict each other.
+*/
+
 /* Update the rendered version and the syntax highlight of a row. */
 int editorUpdateRow(erow *row)
 {
@@ -673,63 +730,99 @@ int editorUpdateRow(erow *row)
     row->rsize = idx;
     row->render[idx] = '\0';
 
-    /* Update the syntax highlighting attributes of the row.
+    /* Update the syntax highlighting attributes of the row, an empty row
+     * carries the open comment state of the row above.
     */
     if(editorUpdateSyntax(row)) return 1;
+    row->hl_oc = row->rsize ? editorRowHasOpenComment(row) : editorPrevOpenComment(row->idx);
     return 0;
 }
 
-/* Insert a row at the specified position, shifting the other rows on the bottom
- * if required.
+/* Drop the cached rows from the given file row onwards, they are reloaded
+ * when next needed.
 */
-int editorInsertRow(int at, char *s, size_t len)
+void editorInvalidateRows(int from)
 {
     int j;
 
-    if (at > E.numrows) return 0;
+    for (j = 0; j < E.rowcache; j++)
+        if (E.row[j].idx >= from) E.row[j].idx = -1;
+}
+
+/* Return the row at the given file position, loading it into the row cache
+ * if needed, or NULL if there is no such row.
+*/
+erow *editorRow(int filerow)
+{
+    erow *row;
+    char *chars;
+    int  len;
 
-    E.row = sys_realloc(E.row,sizeof(erow)*(E.numrows+1));
-    if(E.row == NULL) { printf("editorInsertRow: Memory exhausted\n"); return 1; }
+    if (filerow < 0 || filerow >= E.numrows || E.row == NULL) return NULL;
+    row = &E.row[filerow % E.rowcache];
+    if (row->idx == filerow) return row;
 
-    if (at != E.numrows)
+    row->idx = -1;
+    if (row->chars == NULL)
+    {
+        row->chars = sys_malloc(KILO_ROW_ALLOC);
+        if(row->chars == NULL) { printf("editorRow: Memory exhausted\n"); return NULL; }
+        row->alloc = KILO_ROW_ALLOC;
+    }
+    len = tbGetLine(&E.text, filerow, row->chars, row->alloc);
+    if (len >= row->alloc)
     {
-        memmove(E.row+at+1,E.row+at,sizeof(E.row[0])*(E.numrows-at));
-        for (j = at+1; j <= E.numrows; j++) E.row[j].idx++;
+        chars = sys_realloc(row->chars, len+1);
+        if(chars == NULL) { printf("editorRow: Memory exhausted\n"); return NULL; }
+        row->chars = chars;
+        row->alloc = len+1;
+        len = tbGetLine(&E.text, filerow, row->chars, row->alloc);
     }
+    if (len < 0) return NULL;
+    row->size = len;
+    row->idx = filerow;
+    if (editorUpdateRow(row)) { row->idx = -1; return NULL; }
+    return row;
+}
+
+/* Report a failed piece table update on the status line. */
+int editorTextError(int result)
+{
+    if (result == TB_OK) return 0;
+    sprintf(E.statusmsg, result == TB_NO_MEMORY ? "Memory exhausted" : "File read error");
+    E.statusmsg_time = sysmillis();
+    return 1;
+}
+
+/* Reload a row after an edit. If its open comment state changed the rows
+ * below are dropped from the cache so they are highlighted again.
+*/
+int editorRowChanged(int filerow)
+{
+    erow *row = &E.row[filerow % E.rowcache];
+    int  oc = (row->idx == filerow) ? row->hl_oc : -1;
 
-    E.row[at].size = len;
-    E.row[at].chars = sys_malloc(len+1);
-    if(E.row[at].chars == NULL) { printf("editorInsertRow: Memory exhausted\n"); return 1; }
-    memcpy(E.row[at].chars,s,len+1);
-    E.row[at].hl = NULL;
-    E.row[at].hl_oc = 0;
-    E.row[at].render = NULL;
-    E.row[at].rsize = 0;
-    E.row[at].idx = at;
-    if(editorUpdateRow(E.row+at)) return 1;
-    E.numrows++;
+    row->idx = -1;
+    if ((row = editorRow(filerow)) == NULL) return 1;
+    if (row->hl_oc != oc) editorInvalidateRows(filerow+1);
     E.dirty++;
     return 0;
 }
 
-/* Free row's heap allocated stuff. */
-void editorFreeRow(erow *row)
+/* Insert a row at the specified position, shifting the other rows on the bottom
+ * if required.
+*/
+int editorInsertRow(int at, char *s, size_t len)
 {
-    if(row->render != NULL)
-    {
-        sys_free(row->render);
-        row->render = NULL;
-    }
-    if(row->chars != NULL)
-    {
-        sys_free(row->chars);
-        row->chars = NULL;
-    }
-    if(row->hl != NULL)
-    {
-        sys_free(row->hl);
-        row->hl = NULL;
-    }
+    if (at > E.numrows) return 0;
+
+    /* The newline goes in first so appending after the last row works. */
+    if (editorTextError(tbInsert(&E.text, at, 0, "\n", 1)) ||
+        editorTextError(tbInsert(&E.text, at, 0, s, len))) return 1;
+    E.numrows = E.text.lines;
+    editorInvalidateRows(at);
+    E.dirty++;
+    return 0;
 }
 
 // Method to release all used memory back to the heap.
@@ -738,12 +831,12 @@ void editorCleanup(void)
 {
     int  idx;
 
-    // Free the editor config structure.
+    // Free the row cache.
     if(E.row)
     {
         // Go through and free all row memory.
         //
-        for(idx=0; idx < E.numrows; idx++)
+        for(idx=0; idx < E.rowcache; idx++)
         {
             if(E.row[idx].chars != NULL)
             {
@@ -762,6 +855,13 @@ void editorCleanup(void)
         sys_free(E.row);
     }
 
+    // Close the file and release the piece table.
+    tbFree(&E.text);
+
+    // Release the screen shadow and output buffer.
+    scrFree();
+    abFree();
+
     // Reset necessary variables.
     E.cx = 0;
     E.cy = 0;
@@ -769,84 +869,39 @@ void editorCleanup(void)
     E.coloff = 0;
     E.numrows = 0;
     E.row = NULL;
+    E.rowcache = 0;
     E.dirty = 0;
     return;
 }
 
-/* Remove the row at the specified position, shifting the remainign on the
- * top. */
-void editorDelRow(int at) {
-    int j;
-    erow *row;
-
-    if (at >= E.numrows) return;
-    row = E.row+at;
-    editorFreeRow(row);
-    memmove(E.row+at,E.row+at+1,sizeof(E.row[0])*(E.numrows-at-1));
-    for (j = at; j < E.numrows-1; j++) E.row[j].idx++;
-    E.numrows--;
-    E.dirty++;
-}
-
 /* Insert a character at the specified position in a row, moving the remaining
  * chars on the right if needed.
 */
 int editorRowInsertChar(erow *row, int at, int c)
 {
-    if (at > row->size)
-    {
-        /* Pad the string with spaces if the insert location is outside the
-         * current length by more than a single character.
-        */
-        int padlen = at-row->size;
+    char ch = c;
+    int  filerow = row->idx;
+    int  padlen;
 
-        /* In the next line +2 means: new char and null term.
-        */
-        row->chars = sys_realloc(row->chars,row->size+padlen+2);
-        if(row->chars == NULL) { printf("editorRowInsertChar: Memory exhausted\n"); return 1; }
-        memset(row->chars+row->size,' ',padlen);
-        row->chars[row->size+padlen+1] = '\0';
-        row->size += padlen+1;
-    } else {
-        /* If we are in the middle of the string just make space for 1 new
-         * char plus the (already existing) null term.
-        */
-        row->chars = sys_realloc(row->chars,row->size+2);
-        if(row->chars == NULL) { printf("editorRowInsertChar: Memory exhausted\n"); return 1; }
-        memmove(row->chars+at+1,row->chars+at,row->size-at+1);
-        row->size++;
+    /* Pad the string with spaces if the insert location is outside the
+     * current length by more than a single character.
+    */
+    while (at > row->size)
+    {
+        padlen = at-row->size > 8 ? 8 : at-row->size;
+        if (editorTextError(tbInsert(&E.text, filerow, row->size, "        ", padlen))) return 1;
+        row->size += padlen;
     }
-    row->chars[at] = c;
-    if(editorUpdateRow(row)) return 1;
-    E.dirty++;
-
-    return 0;
-}
-
-/* Append the string 's' at the end of a row */
-int editorRowAppendString(erow *row, char *s, size_t len)
-{
-    row->chars = sys_realloc(row->chars,row->size+len+1);
-    if(row->chars == NULL) { printf("editorRowAppendString: Memory exhausted\n"); return 1; }
-    memcpy(row->chars+row->size,s,len);
-
-    row->size += len;
-    row->chars[row->size] = '\0';
-    if(editorUpdateRow(row)) return 1;
-    E.dirty++;
-
-    return 0;
+    if (editorTextError(tbInsert(&E.text, filerow, at, &ch, 1))) return 1;
+    return editorRowChanged(filerow);
 }
 
 /* Delete the character at offset 'at' from the specified row. */
 int editorRowDelChar(erow *row, int at)
 {
     if (row->size <= at) return 0;
-    memmove(row->chars+at,row->chars+at+1,row->size-at);
-    if(editorUpdateRow(row)) return 1;
-    row->size--;
-    E.dirty++;
-    return 0;
+    if (editorTextError(tbDelete(&E.text, row->idx, at, 1))) return 1;
+    return editorRowChanged(row->idx);
 }
 
 /* Insert the specified char at the current prompt position. */
@@ -854,7 +909,7 @@ void editorInsertChar(int c)
 {
     int filerow = E.rowoff+E.cy;
     int filecol = E.coloff+E.cx;
-    erow *row = (filerow >= E.numrows) ? NULL : &E.row[filerow];
+    erow *row = editorRow(filerow);
 
     /* If the row where the cursor is currently located does not exist in our
      * logical representaion of the file, add enough empty rows as needed. */
@@ -865,7 +920,7 @@ void editorInsertChar(int c)
             if(editorInsertRow(E.numrows,"",0) != 0) return;
         }
     }
-    row = &E.row[filerow];
+    if ((row = editorRow(filerow)) == NULL) return;
     editorRowInsertChar(row,filecol,c);
     if (E.cx == E.screencols-1)
         E.coloff++;
@@ -874,14 +929,14 @@ void editorInsertChar(int c)
     E.dirty++;
 }
 
-/* Inserting a newline is slightly complex as we have to handle inserting a
- * newline in the middle of a line, splitting the line as needed.
+/* Inserting a newline splits the line at the cursor, or adds an empty row when
+ * the cursor is on the row after the last.
 */
 int editorInsertNewline(void)
 {
     int filerow = E.rowoff+E.cy;
     int filecol = E.coloff+E.cx;
-    erow *row = (filerow >= E.numrows) ? NULL : &E.row[filerow];
+    erow *row = editorRow(filerow);
 
     if (!row)
     {
@@ -895,18 +950,10 @@ int editorInsertNewline(void)
     /* If the cursor is over the current line size, we want to conceptually
      * think it's just over the last character. */
     if (filecol >= row->size) filecol = row->size;
-    if (filecol == 0)
-    {
-        if(editorInsertRow(filerow,"",0) != 0) return 1;
-    } else
-    {
-        /* We are in the middle of a line. Split it between two rows. */
-        if(editorInsertRow(filerow+1,row->chars+filecol,row->size-filecol) != 0) return 1;
-        row = &E.row[filerow];
-        row->chars[filecol] = '\0';
-        row->size = filecol;
-        if(editorUpdateRow(row)) return 1;
-    }
+    if (editorTextError(tbInsert(&E.text, filerow, filecol, "\n", 1))) return 1;
+    E.numrows = E.text.lines;
+    editorInvalidateRows(filerow);
+    E.dirty++;
 fixcursor:
     if (E.cy == E.screenrows-1)
     {
@@ -925,7 +972,8 @@ int editorDelChar()
 {
     int filerow = E.rowoff+E.cy;
     int filecol = E.coloff+E.cx;
-    erow *row = (filerow >= E.numrows) ? NULL : &E.row[filerow];
+    erow *row = editorRow(filerow);
+    erow *prev;
 
     if (!row || (filecol == 0 && filerow == 0)) return 0;
     if (filecol == 0)
@@ -933,10 +981,11 @@ int editorDelChar()
         /* Handle the case of column 0, we need to move the current line
          * on the right of the previous one.
         */
-        filecol = E.row[filerow-1].size;
-        editorRowAppendString(&E.row[filerow-1],row->chars,row->size);
-        editorDelRow(filerow);
-        row = NULL;
+        if ((prev = editorRow(filerow-1)) == NULL) return 1;
+        filecol = prev->size;
+        if (editorTextError(tbJoinLines(&E.text, filerow-1))) return 1;
+        E.numrows = E.text.lines;
+        editorInvalidateRows(filerow-1);
         if (E.cy == 0)
             E.rowoff--;
         else
@@ -950,83 +999,50 @@ int editorDelChar()
         }
     } else
     {
-        editorRowDelChar(row,filecol-1);
+        if (editorRowDelChar(row,filecol-1)) return 1;
         if (E.cx == 0 && E.coloff)
             E.coloff--;
         else
             E.cx--;
     }
-    if (row)
-        if(editorUpdateRow(row)) return 1;
     E.dirty++;
     return 0;
 }
 
-/* Load the specified program in the editor memory and returns 0 on success
- * or 1 on error.
+/* Allocate the row cache, enough rows for the screen and the row above.
+*/
+int editorInitRows(void)
+{
+    int idx;
+
+    E.rowcache = E.screenrows+2;
+    E.row = sys_malloc(sizeof(erow)*E.rowcache);
+    if(E.row == NULL) { printf("editorInitRows: Memory exhausted\n"); E.rowcache = 0; return 1; }
+    memset(E.row, '\0', sizeof(erow)*E.rowcache);
+    for(idx=0; idx < E.rowcache; idx++) E.row[idx].idx = -1;
+    E.numrows = E.text.lines;
+    return 0;
+}
+
+/* Open the specified file in the editor and returns 0 on success, 1 if memory
+ * is exhausted or 2 if the file cannot be opened. The file is indexed but not
+ * loaded, rows are read as they are displayed.
 */
 int editorOpen(char *filename)
 {
-    FIL     fp;
-    FRESULT fr;
-    char    buf[132];
-    uint8_t linelen;
-    int     rowNo;
+    int result;
 
     E.dirty = 0;
     E.filename = filename;
 
-    fr = f_open(&fp, filename, FA_OPEN_ALWAYS | FA_READ);
-    if(fr)
+    result = tbOpen(&E.text, filename);
+    if(result == TB_IO_ERROR)
     {
         printf("Failed to open file:%s\n", filename);
         return 2;
     }
-
-    // First parse to get number of lines in file to better allocate memory.
-    //
-    E.numrows = 0;
-    while(f_gets(buf, sizeof(buf), &fp) != NULL)
-    {
-        E.numrows++;
-    }
-    fr = f_lseek(&fp, 0);
-    if(fr)
-    {
-        printf("Failed to rewind file:%s\n", filename);
-        return 3;
-    }
-
-    // If there is data in the file, load it.
-    //
-    if(E.numrows)
-    {
-        // Allocate memory for the row array.
-        //
-        E.row = sys_malloc(sizeof(erow)*(E.numrows));
-        if(E.row == NULL) { printf("editorOpen: Memory exhausted\n"); return 1; }
-    memset(E.row, '\0', sizeof(erow)*(E.numrows));
-
-        // Now go through the file again and populate each row with the data.
-        //
-        rowNo = 0;
-        while(f_gets(buf, sizeof(buf), &fp) != NULL)
-        {
-            linelen = strlen(buf);
-            if (linelen && (buf[linelen-1] == '\n' || buf[linelen-1] == '\r'))
-                buf[--linelen] = '\0';
-
-            E.row[rowNo].size = linelen;
-            E.row[rowNo].chars = sys_malloc(linelen+1);
-            if(E.row[rowNo].chars == NULL) { printf("editorOpen: Memory exhausted\n"); return 1; }
-            memcpy(E.row[rowNo].chars, buf, linelen+1);
-            E.row[rowNo].idx = rowNo;
-            if(editorUpdateRow(E.row+rowNo)) return 1;
-            rowNo++;
-        }
-    }
-    f_close(&fp);
-    return 0;
+    if(result != TB_OK) return 1;
+    return editorInitRows();
 }
 
 
@@ -1034,49 +1050,21 @@ int editorOpen(char *filename)
 */
 int editorSave(char *newFileName)
 {
-    FIL          fp;
-    FRESULT      fr;
-    unsigned int bytes;
-    int          totlen = 0;
-    int          j;
-
-    // Open existing file or create.
-    fr = f_open(&fp, (newFileName == NULL ? E.filename : newFileName), FA_OPEN_ALWAYS | FA_WRITE | FA_READ);
-    if(fr)
+    uint32_t written;
+    int      result;
+
+    result = tbSave(&E.text, (newFileName == NULL ? E.filename : newFileName), &written);
+    if(result != TB_OK)
     {
-        sprintf(E.statusmsg, "Failed to open file:%s\n", (newFileName == NULL ? E.filename : newFileName));
+        sprintf(E.statusmsg, result == TB_NO_MEMORY ? "Can't save! Memory exhausted" : "Can't save! I/O error");
         E.statusmsg_time = sysmillis();
         return 1;
     }
 
-    /* Use truncate to zero the file the loop through the line buffers and
-     * write the contents to the file.
-    */
-    if (f_truncate(&fp) != 0) goto writeerr;
-
-    // Loop through the row records and write out the characters.
-    //
-    totlen = 0;
-    for (j = 0; j < E.numrows; j++)
-    {
-        fr = f_write(&fp, E.row[j].chars, E.row[j].size, &bytes);
-        if(fr != 0) goto writeerr;
-        fr = f_putc('\n', &fp);
-        if(fr == -1) goto writeerr;
-        totlen += bytes + 1;
-    }
-    f_close(&fp);
-
     E.dirty = 0;
-    sprintf(E.statusmsg, "%d bytes written on disk", totlen);
+    sprintf(E.statusmsg, "%lu bytes written on disk", (unsigned long)written);
     E.statusmsg_time = sysmillis();
     return 0;
-
-writeerr:
-    f_close(&fp);
-    sprintf(E.statusmsg, "Can't save! I/O error");
-    E.statusmsg_time = sysmillis();
-    return 1;
 }
 
 /* ============================= Terminal update ============================ */
@@ -1084,172 +1072,422 @@ writeerr:
 /* Output buffer append method. The idea behind this is to avoid flickering
  * effects on the VT100 terminal. The original method buffered everything 
  * and sent it in one go, but on MPU's the resources are limited, so the 
- * buffer is smaller and more flushes are made as needed.
+ * buffer is smaller and more flushes are made as needed. The buffer is
+ * allocated on first use and held until the editor exits, abFree(), if it
+ * cannot be allocated the data is written straight out.
 */
 struct abuf {
     char *b;
     int len;
+    uint32_t sent;          /* Bytes appended, for the refresh statistics. */
 };
 
+static struct abuf AB = { NULL, 0, 0 };
+
 void abAppend(const char *s, int len, int flush)
 {
-    static struct abuf *ab = NULL;
-
     // First call, allocate memory for the buffer.
-    if(ab == NULL)
+    if(AB.b == NULL)
     {
-        ab = sys_malloc(sizeof(struct abuf));
-        if(ab == NULL) { printf("abAppend: Memory exhausted\n"); return; }
-        ab->b = sys_malloc(MAX_APPEND_BUFSIZE);
-        if(ab->b == NULL) { sys_free(ab); printf("abAppend: Memory exhausted\n"); return; }
-        ab->len = 0;
+        AB.b = sys_malloc(MAX_APPEND_BUFSIZE);
+        AB.len = 0;
     }
+    AB.sent += len;
 
     // If adding this new text will overflow the buffer, flush before adding.
-    if((ab->len + len) >= MAX_APPEND_BUFSIZE || flush)
+    if(AB.b != NULL && (AB.len + len) > MAX_APPEND_BUFSIZE)
     {
-        const char *ptr = ab->b;
-        for(ptr=ab->b; ptr < ab->b+ab->len; ptr++)
-            fputc(*ptr, stdout);
+        fwrite(AB.b, 1, AB.len, stdout);
+        AB.len = 0;
+    }
 
-        // If we are flushing then write out the additional data passed in to the method.
-        //
-        if(flush)
-        {
-            for(ptr=s; ptr < s+len; ptr++)
-            fputc(*ptr, stdout);
+    // Tag the passed data onto the buffer unless it wont fit.
+    if(AB.b != NULL && len <= MAX_APPEND_BUFSIZE)
+    {
+        memcpy(AB.b + AB.len, s, len);
+        AB.len += len;
+    } else
+    {
+        fwrite(s, 1, len, stdout);
+    }
 
+    if(flush)
+    {
+        if(AB.b != NULL && AB.len)
+            fwrite(AB.b, 1, AB.len, stdout);
+        AB.len = 0;
+        fflush(stdout);
+    }
+}
+
+/* Release the append buffer back to the heap.
+*/
+void abFree(void)
+{
+    if(AB.b != NULL)
+        sys_free(AB.b);
+    AB.b = NULL;
+    AB.len = 0;
+}
+
+/* Screen shadow. Holds what was last sent to each terminal row, a character
+ * and an attribute per cell, so that a refresh only sends the spans of cells
+ * which changed rather than the whole screen. Each row is composed into the
+ * line buffer, compared with the shadow and the differences sent with the
+ * cheapest cursor motion. The attribute is ATTR_NORMAL, ATTR_INVERSE or a
+ * foreground colour from editorSyntaxToColor().
+*/
+#define ATTR_NORMAL          0
+#define ATTR_INVERSE         7
+
+struct screenShadow {
+    int rows, cols;         /* Terminal rows including the status rows. */
+    char *chars;            /* rows*cols characters as on the terminal, NULL if no memory, every row is then resent. */
+    unsigned char *attr;    /* rows*cols attributes. */
+    char *lchars;           /* Row being composed. */
+    unsigned char *lattr;
+    int valid;              /* Shadow matches the terminal. */
+    int crow, ccol;         /* Terminal cursor position, -1 if unknown. */
+    int cattr;              /* Terminal attribute in effect. */
+    int hidden;             /* Cursor hidden during this refresh. */
+    int stats;              /* Show the refresh statistics, Ctrl-D toggles. */
+    uint32_t lastSent;      /* Bytes sent by the last refresh. */
+    uint32_t lastRows;      /* Rows changed by the last refresh. */
+    uint32_t refreshes;     /* Statistics totals. */
+    uint32_t totalSent;
+};
+
+static struct screenShadow S;
+
+/* Allocate the shadow for the current screen size, falling back to the line
+ * buffer only when memory is short.
+*/
+void scrInit(void)
+{
+    S.rows = E.screenrows+2;
+    S.cols = E.screencols;
+    S.chars = sys_malloc((S.rows+1)*S.cols*2);
+    if(S.chars != NULL)
+    {
+        S.attr   = (unsigned char *)S.chars+(S.rows*S.cols);
+        S.lchars = (char *)S.attr+(S.rows*S.cols);
+    } else
+    {
+        S.attr   = NULL;
+        S.lchars = sys_malloc(S.cols*2);
+    }
+    S.lattr = S.lchars == NULL ? NULL : (unsigned char *)S.lchars+S.cols;
+    S.valid = 0;
+    S.crow = S.ccol = -1;
+    S.lastSent = S.lastRows = S.refreshes = S.totalSent = 0;
+}
+
+void scrFree(void)
+{
+    if(S.chars != NULL)
+        sys_free(S.chars);
+    else if(S.lchars != NULL)
+        sys_free(S.lchars);
+    S.chars = S.lchars = NULL;
+    S.attr = S.lattr = NULL;
+}
+
+/* Force the next refresh to clear the terminal and redraw every row.
+*/
+void scrInvalidate(void)
+{
+    S.valid = 0;
+}
+
+void scrHide(void)
+{
+    if(!S.hidden)
+    {
+        abAppend("\x1b[?25l",6, 0);
+        S.hidden = 1;
+    }
+}
+
+/* Change the terminal attribute with the fewest bytes.
+*/
+void scrAttr(int attr)
+{
+    char buf[8];
+
+    if(attr == S.cattr) return;
+    if(S.cattr == ATTR_INVERSE)
+    {
+        abAppend("\x1b[0m",4, 0);
+        S.cattr = ATTR_NORMAL;
+    }
+    if(attr == ATTR_INVERSE)
+    {
+        if(S.cattr != ATTR_NORMAL) abAppend("\x1b[39m",5, 0);
+        abAppend("\x1b[7m",4, 0);
+    } else if(attr == ATTR_NORMAL)
+    {
+        if(S.cattr != ATTR_NORMAL) abAppend("\x1b[39m",5, 0);
+    } else
+    {
+        sprintf(buf,"\x1b[%dm",attr);
+        abAppend(buf,strlen(buf), 0);
+    }
+    S.cattr = attr;
+}
+
+/* Move the terminal cursor, choosing the shortest of an absolute position,
+ * a relative move, CR or CR/LF, or rewriting the unchanged cells between the
+ * cursor and the target when they are fewer bytes than the escape sequence.
+*/
+void scrMove(int row, int col)
+{
+    char abs[32], rel[32];
+    int  absLen, relLen = 0;
+    int  idx;
+
+    if(row == S.crow && col == S.ccol) return;
+    sprintf(abs,"\x1b[%d;%dH",row+1,col+1);
+    absLen = strlen(abs);
+
+    if(S.crow == row && S.ccol >= 0)
+    {
+        if(col == 0)
+        {
+            strcpy(rel,"\r");
+        } else if(col < S.ccol)
+        {
+            sprintf(rel,"\x1b[%dD",S.ccol-col);
+        } else
+        {
+            sprintf(rel,"\x1b[%dC",col-S.ccol);
+            relLen = strlen(rel);
+            if(S.chars != NULL && col-S.ccol <= (relLen < absLen ? relLen : absLen))
+            {
+                for(idx=S.ccol; idx < col && S.attr[row*S.cols+idx] == S.cattr; idx++);
+                if(idx == col)
+                {
+                    abAppend(S.chars+row*S.cols+S.ccol, col-S.ccol, 0);
+                    S.ccol = col;
+                    return;
+                }
+            }
         }
-        ab->len = 0;
+    } else if(S.crow >= 0 && S.ccol >= 0 && row == S.crow+1 && col == 0)
+    {
+        strcpy(rel,"\r\n");
+    } else if(S.crow >= 0 && S.ccol == col)
+    {
+        sprintf(rel,"\x1b[%d%c",row < S.crow ? S.crow-row : row-S.crow, row < S.crow ? 'A' : 'B');
+    } else
+    {
+        rel[0] = '\0';
     }
+    relLen = strlen(rel);
 
-    // If we arent flushing, tag the passed data onto the buffer.
-    //
-    if(!flush)
+    if(relLen && relLen < absLen)
+        abAppend(rel,relLen, 0);
+    else
+        abAppend(abs,absLen, 0);
+    S.crow = row;
+    S.ccol = col;
+}
+
+/* Send the composed cells start..end-1 of a row and record them in the shadow.
+*/
+void scrEmit(int row, int start, int end)
+{
+    int idx;
+    int run;
+
+    scrHide();
+    scrMove(row, start);
+    for(idx=start; idx < end; idx = run)
+    {
+        scrAttr(S.lattr[idx]);
+        for(run=idx; run < end && S.lattr[run] == S.lattr[idx]; run++);
+        abAppend(S.lchars+idx, run-idx, 0);
+    }
+    if(S.chars != NULL)
     {
-        memcpy(ab->b + ab->len, s, len);
-        ab->len += len;
+        memcpy(S.chars+row*S.cols+start, S.lchars+start, end-start);
+        memcpy(S.attr+row*S.cols+start, S.lattr+start, end-start);
+    }
+
+    // Writing the last column leaves the cursor in a terminal dependent state.
+    S.ccol = end < S.cols ? end : -1;
+}
+
+/* Compose helper, place text into the line buffer, returns the next column.
+*/
+int scrText(int col, const char *s, int len, int attr)
+{
+    while(len-- > 0 && col < S.cols)
+    {
+        S.lchars[col] = *s++;
+        S.lattr[col++] = attr;
+    }
+    return col;
+}
+
+/* Compare the composed row with the shadow and send the differences. Trailing
+ * blank cells are cleared with erase to end of line rather than sent. Returns
+ * 1 if anything was sent.
+*/
+int scrRow(int row)
+{
+    char          *oc = S.chars == NULL ? NULL : S.chars+row*S.cols;
+    unsigned char *oa = S.attr  == NULL ? NULL : S.attr+row*S.cols;
+    int           newLen = S.cols;
+    int           oldLen = S.cols;
+    int           idx;
+    int           start;
+    int           changed = 0;
+
+    while(newLen && S.lchars[newLen-1] == ' ' && S.lattr[newLen-1] == ATTR_NORMAL) newLen--;
+    if(oc == NULL)
+    {
+        if(newLen) scrEmit(row, 0, newLen);
+        changed = 1;
     } else
     {
-        // On flush we free up the memory, extra cycles in alloc and free but keeps the heap balanced and no memory leaks when we exit.
-        //
-        sys_free(ab->b);
-        sys_free(ab);
-        ab = NULL;
+        while(oldLen && oc[oldLen-1] == ' ' && oa[oldLen-1] == ATTR_NORMAL) oldLen--;
+        for(idx=0; idx < newLen; )
+        {
+            if(S.lchars[idx] == oc[idx] && S.lattr[idx] == oa[idx]) { idx++; continue; }
+            start = idx;
+            while(idx < newLen && (S.lchars[idx] != oc[idx] || S.lattr[idx] != oa[idx])) idx++;
+            scrEmit(row, start, idx);
+            changed = 1;
+        }
+    }
+    if(oc == NULL || oldLen > newLen)
+    {
+        scrHide();
+        scrMove(row, newLen);
+        scrAttr(ATTR_NORMAL);
+        abAppend("\x1b[0K",4, 0);
+        if(oc != NULL)
+        {
+            memset(oc+newLen, ' ', S.cols-newLen);
+            memset(oa+newLen, ATTR_NORMAL, S.cols-newLen);
+        }
+        changed = 1;
     }
+    return changed;
 }
 
-/* This function writes the whole screen using VT100 escape characters
- * starting from the logical state of the editor in the global state 'E'.
+/* This function updates the screen using VT100 escape characters starting
+ * from the logical state of the editor in the global state 'E'. Each row is
+ * composed and only the cells which differ from the screen shadow are sent.
 */
 int editorRefreshScreen(void)
 {
-    int    y;
-    int    lastLine = -1;
-    erow   *r;
-    char   buf[32];
-
-    abAppend("\x1b[?25l",6, 0); /* Hide cursor. */
-    abAppend("\x1b[H",3, 0);    /* Go home. */
-    for (y = 0; y < E.screenrows; y++)
+    int      y;
+    int      lastLine = -1;
+    int      col;
+    erow     *r;
+    uint32_t sent;
+    uint32_t rows = 0;
+
+    if(S.lchars == NULL)
+    {
+        scrInit();
+        if(S.lchars == NULL) { printf("editorRefreshScreen: Memory exhausted\n"); return(lastLine); }
+    }
+    S.hidden = 0;
+    sent = AB.sent;
+
+    /* Unknown terminal contents, clear it and start from a blank shadow. */
+    if(!S.valid)
+    {
+        scrHide();
+        abAppend("\x1b[0m\x1b[H\x1b[2J",11, 0);
+        if(S.chars != NULL)
+        {
+            memset(S.chars, ' ', S.rows*S.cols);
+            memset(S.attr, ATTR_NORMAL, S.rows*S.cols);
+        }
+        S.crow = S.ccol = 0;
+        S.cattr = ATTR_NORMAL;
+        S.valid = 1;
+    }
+
+    for (y = 0; y < S.rows; y++)
     {
         int filerow = E.rowoff+y;
 
-        if (filerow >= E.numrows) {
+        memset(S.lchars, ' ', S.cols);
+        memset(S.lattr, ATTR_NORMAL, S.cols);
+
+        if (y == E.screenrows)
+        {
+            /* Create a two rows status. First row: */
+            char status[80], rstatus[80];
+            sprintf(status, "%-20s - %d lines %s", E.filename, E.numrows, E.dirty > 0  ? "(modified)" : "");
+            sprintf(rstatus, "%d/%d",E.rowoff+E.cy+1,E.numrows);
+            int rlen = strlen(rstatus);
+            memset(S.lattr, ATTR_INVERSE, S.cols);
+            scrText(0, status, strlen(status), ATTR_INVERSE);
+            if (S.cols - rlen > (int)strlen(status))
+                scrText(S.cols-rlen, rstatus, rlen, ATTR_INVERSE);
+        } else if (y == E.screenrows+1)
+        {
+            /* Second row depends on E.statusmsg and the status message update time. */
+            int msglen = strlen(E.statusmsg);
+            if (msglen && sysmillis() - E.statusmsg_time < 5000)
+                scrText(0, E.statusmsg, msglen, ATTR_NORMAL);
+
+            /* Debug, bytes sent by the previous refresh. */
+            if (S.stats)
+            {
+                char stats[72];
+                sprintf(stats, "refresh %lu bytes %lu rows, avg %lu",
+                        (unsigned long)S.lastSent, (unsigned long)S.lastRows,
+                        (unsigned long)(S.refreshes ? S.totalSent/S.refreshes : 0));
+                col = strlen(stats);
+                if (col < S.cols) scrText(S.cols-col-1, stats, col, ATTR_INVERSE);
+            }
+        } else if (filerow >= E.numrows)
+        {
             if (E.numrows == 0 && y == E.screenrows/3)
             {
                 char welcome[80];
-                sprintf(welcome, "Kilo editor -- version %s\x1b[0K\r\n", KILO_VERSION);
+                sprintf(welcome, "Kilo editor -- version %s", KILO_VERSION);
                 int welcomelen = strlen(welcome);
                 int padding = (E.screencols-welcomelen)/2;
-                if (padding)
-                {
-                    abAppend("~",1, 0);
-                    padding--;
-                }
-                while(padding--) abAppend(" ",1, 0);
-                abAppend(welcome,welcomelen, 0);
+                scrText(0, "~", 1, ATTR_NORMAL);
+                scrText(padding > 0 ? padding : 0, welcome, welcomelen, ATTR_NORMAL);
             } else {
                 if(lastLine == -1) lastLine = y;
-                abAppend("~\x1b[0K\r\n",7, 0);
+                scrText(0, "~", 1, ATTR_NORMAL);
             }
-            continue;
-        }
-
-        r = &E.row[filerow];
-
-        int len = r->rsize - E.coloff;
-        int current_color = -1;
-        if (len > 0) {
-            if (len > E.screencols) len = E.screencols;
-            char *c = r->render+E.coloff;
-            unsigned char *hl = r->hl+E.coloff;
-            int j;
-            for (j = 0; j < len; j++)
-            {
-                if (hl[j] == HL_NONPRINT)
-                {
-                    char sym;
-                    abAppend("\x1b[7m",4, 0);
-                    if (c[j] <= 26)
-                        sym = '@'+c[j];
-                    else
-                        sym = '?';
-                    abAppend(&sym,1, 0);
-                    abAppend("\x1b[0m",4, 0);
-                } else if (hl[j] == HL_NORMAL)
+        } else
+        {
+            r = editorRow(filerow);
+
+            int len = r ? r->rsize - E.coloff : 0;
+            if (len > 0) {
+                if (len > E.screencols) len = E.screencols;
+                char *c = r->render+E.coloff;
+                unsigned char *hl = r->hl+E.coloff;
+                int j;
+                for (j = 0; j < len; j++)
                 {
-                    if (current_color != -1)
+                    if (hl[j] == HL_NONPRINT)
                     {
-                        abAppend("\x1b[39m",5, 0);
-                        current_color = -1;
-                    }
-                    abAppend(c+j,1, 0);
-                } else {
-                    int color = editorSyntaxToColor(hl[j]);
-                    if (color != current_color)
+                        S.lchars[j] = c[j] <= 26 ? '@'+c[j] : '?';
+                        S.lattr[j]  = ATTR_INVERSE;
+                    } else
                     {
-                        char buf[16];
-                        sprintf(buf,"\x1b[%dm",color);
-                        int clen = strlen(buf);
-                        current_color = color;
-                        abAppend(buf,clen, 0);
+                        S.lchars[j] = c[j];
+                        S.lattr[j]  = hl[j] == HL_NORMAL ? ATTR_NORMAL : editorSyntaxToColor(hl[j]);
                     }
-                    abAppend(c+j,1, 0);
                 }
             }
         }
-        abAppend("\x1b[39m",5, 0);
-        abAppend("\x1b[0K",4, 0);
-        abAppend("\r\n",2, 0);
-    }
-
-    /* Create a two rows status. First row: */
-    abAppend("\x1b[0K",4, 0);
-    abAppend("\x1b[7m",4, 0);
-    char status[80], rstatus[80];
-    sprintf(status, "%-20s - %d lines %s", E.filename, E.numrows, E.dirty > 0  ? "(modified)" : "");
-    int len = strlen(status);
-    sprintf(rstatus, "%d/%d",E.rowoff+E.cy+1,E.numrows);
-    int rlen = strlen(rstatus);
-    if (len > E.screencols) len = E.screencols;
-    abAppend(status,len, 0);
-    while(len < E.screencols) {
-        if (E.screencols - len == rlen) {
-            abAppend(rstatus,rlen, 0);
-            break;
-        } else {
-            abAppend(" ",1, 0);
-            len++;
-        }
+        rows += scrRow(y);
     }
-    abAppend("\x1b[0m\r\n",6, 0);
-
-    /* Second row depends on E.statusmsg and the status message update time. */
-    abAppend("\x1b[0K",4, 0);
-    int msglen = strlen(E.statusmsg);
-    if (msglen && sysmillis() - E.statusmsg_time < 5000)
-        abAppend(E.statusmsg,msglen <= E.screencols ? msglen : E.screencols, 0);
+    scrAttr(ATTR_NORMAL);
 
     /* Put cursor at its current position. Note that the horizontal position
      * at which the cursor is displayed may be different compared to 'E.cx'
@@ -1258,20 +1496,26 @@ int editorRefreshScreen(void)
     int j;
     int cx = 1;
     int filerow = E.rowoff+E.cy;
-    erow *row = (filerow >= E.numrows) ? NULL : &E.row[filerow];
+    erow *row = editorRow(filerow);
     if (row) {
         for (j = E.coloff; j < (E.cx+E.coloff); j++) {
             if (j < row->size && row->chars[j] == TAB) cx += (KILO_TAB_SIZE-1)-((cx)%KILO_TAB_SIZE);
             cx++;
         }
     }
-    sprintf(buf,"\x1b[%d;%dH",E.cy+1,cx);
-    abAppend(buf,strlen(buf), 0);
+    scrMove(E.cy, cx <= S.cols ? cx-1 : S.cols-1);
 
-    /* Show cursor and Flush to complete.
+    /* Show cursor if hidden and Flush to complete.
     */
-    abAppend("\x1b[?25h",6, 1);
+    if(S.hidden)
+        abAppend("\x1b[?25h",6, 1);
+    else
+        abAppend("",0, 1);
 
+    S.lastSent   = AB.sent - sent;
+    S.lastRows   = rows;
+    S.totalSent += S.lastSent;
+    S.refreshes++;
     return(lastLine);
 }
 
@@ -1283,12 +1527,15 @@ void editorFind(void) {
     int last_match = -1; /* Last line where a match was found. -1 for none. */
     int find_next = 0; /* if 1 search next, if -1 search prev. */
     int saved_hl_line = -1;  /* No saved HL */
-    char *saved_hl = NULL;
+    char *line = NULL; /* Line being searched, read from the text buffer. */
+    int linesize = 0;
 
+    /* The match highlight is removed by reloading the row from the text. */
 #define FIND_RESTORE_HL do { \
-    if (saved_hl) { \
-        memcpy(E.row[saved_hl_line].hl,saved_hl, E.row[saved_hl_line].rsize); \
-        saved_hl = NULL; \
+    if (saved_hl_line != -1) { \
+        if (E.row[saved_hl_line % E.rowcache].idx == saved_hl_line) \
+            E.row[saved_hl_line % E.rowcache].idx = -1; \
+        saved_hl_line = -1; \
     } \
 } while (0)
 
@@ -1312,6 +1559,7 @@ void editorFind(void) {
                 E.coloff = saved_coloff; E.rowoff = saved_rowoff;
             }
             FIND_RESTORE_HL;
+            if (line) sys_free(line);
             E.statusmsg[0] = '\0';
             E.statusmsg_time = sysmillis();
             return;
@@ -1332,15 +1580,27 @@ void editorFind(void) {
         if (find_next) {
             char *match = NULL;
             int match_offset = 0;
-            int i, current = last_match;
+            int i, len, current = last_match;
+            char *newline;
 
+            /* Lines are searched in the text buffer rather than the row
+             * cache so the whole file need not be rendered. */
             for (i = 0; i < E.numrows; i++) {
                 current += find_next;
                 if (current == -1) current = E.numrows-1;
                 else if (current == E.numrows) current = 0;
-                match = strstr(E.row[current].render,query);
+                len = tbGetLine(&E.text, current, line, linesize);
+                if (len >= linesize) {
+                    newline = sys_realloc(line, len+KILO_QUERY_LEN);
+                    if (newline == NULL) { printf("editorFind: Memory exhausted\n"); break; }
+                    line = newline;
+                    linesize = len+KILO_QUERY_LEN;
+                    len = tbGetLine(&E.text, current, line, linesize);
+                }
+                if (len < 0) break;
+                match = strstr(line,query);
                 if (match) {
-                    match_offset = match-E.row[current].render;
+                    match_offset = match-line;
                     break;
                 }
             }
@@ -1350,14 +1610,17 @@ void editorFind(void) {
             FIND_RESTORE_HL;
 
             if (match) {
-                erow *row = &E.row[current];
+                erow *row = editorRow(current);
                 last_match = current;
-                if (row->hl) {
+                if (row && row->hl) {
+                    /* Highlight the match in the rendered row, tabs expanded. */
+                    int rx = 0;
+                    for (i = 0; i < match_offset && i < row->size; i++) {
+                        if (row->chars[i] == TAB) rx += (KILO_TAB_SIZE-1)-(rx%KILO_TAB_SIZE);
+                        rx++;
+                    }
                     saved_hl_line = current;
-                    saved_hl = sys_malloc(row->rsize);
-                    if(saved_hl == NULL) { printf("editorFind: Memory exhausted\n"); return; }
-                    memcpy(saved_hl,row->hl,row->rsize);
-                    memset(row->hl+match_offset,HL_MATCH,qlen);
+                    memset(row->hl+rx,HL_MATCH,rx+qlen <= row->rsize ? qlen : row->rsize-rx);
                 }
                 E.cy = 0;
                 E.cx = match_offset;
@@ -1382,7 +1645,7 @@ void editorMoveCursor(int key)
     int filerow = E.rowoff+E.cy;
     int filecol = E.coloff+E.cx;
     int rowlen;
-    erow *row = (filerow >= E.numrows) ? NULL : &E.row[filerow];
+    erow *row = editorRow(filerow);
 
     switch(key)
     {
@@ -1393,7 +1656,8 @@ void editorMoveCursor(int key)
                 } else {
                     if (filerow > 0) {
                         E.cy--;
-                        E.cx = E.row[filerow-1].size;
+                        row = editorRow(filerow-1);
+                        E.cx = row ? row->size : 0;
                         if (E.cx > E.screencols-1) {
                             E.coloff = E.cx-E.screencols+1;
                             E.cx = E.screencols-1;
@@ -1452,7 +1716,7 @@ void editorMoveCursor(int key)
             break;
 
         case END_KEY:
-            E.cx = row->size;
+            E.cx = row ? row->size : 0;
             E.coloff = 0;
             if (E.cx > E.screencols-1)
             {
@@ -1464,7 +1728,7 @@ void editorMoveCursor(int key)
     /* Fix cx if the current line has not enough chars. */
     filerow = E.rowoff+E.cy;
     filecol = E.coloff+E.cx;
-    row = (filerow >= E.numrows) ? NULL : &E.row[filerow];
+    row = editorRow(filerow);
     rowlen = row ? row->size : 0;
     if (filecol > rowlen)
     {
@@ -1569,7 +1833,12 @@ uint32_t editorProcessKeypress(void)
             break;
 
         case CTRL_L: /* ctrl+l, clear screen */
-            /* Just refresh the line as side effect. */
+            /* Clear and redraw everything on the next refresh. */
+            scrInvalidate();
+            break;
+
+        case CTRL_D: /* ctrl+d, toggle the refresh statistics */
+            S.stats = !S.stats;
             break;
 
         case ESC:
@@ -1597,8 +1866,10 @@ uint32_t initEditor(void)
     E.coloff = 0;
     E.numrows = 0;
     E.row = NULL;
+    E.rowcache = 0;
     E.dirty = 0;
     E.filename = NULL;
+    tbInit(&E.text);
     E.syntax = NULL;
     if (getWindowSize(&E.screenrows,&E.screencols) == -1)
     {
@@ -1619,7 +1890,7 @@ uint32_t app(uint32_t param1, uint32_t param2)
 {
     // Initialisation.
     //
-    char      *ptr = (char *)param1;
+    char      *ptr = (char *)(uintptr_t)param1;
     char      *pathName;    
     uint32_t  retCode = 1;
     
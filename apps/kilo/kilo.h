@@ -20,6 +20,7 @@
 //
 // History:         April 2020   - Ported v0.0.1 of Kilo and made quite a few changes for it to work
 //                                 in an embedded environment.
+//                  Oct 2026     - Prototypes for the screen shadow and output buffer release.
 //
 // Notes:           See Makefile to enable/disable conditional components
 //
@@ -49,6 +50,10 @@
 // Application execution constants.
 //
 
+// Prototypes.
+void abFree(void);
+void scrFree(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -77,11 +77,30 @@ int ndimvariables;         /* number of dimensioned arrays */
 LINE *lines = NULL;        /* list of line starts */
 int nlines = 0;            /* number of BASIC lines in program */
 
-const char *string;        /* string we are parsing */
+BCODE *bcode;              /* compiled program */
+int nbcode;                /* cells used in bcode */
+int maxbcode;              /* cells allocated in bcode */
+
+double *constants;         /* numeric literals of the compiled program */
+int nconstants;            /* number of numeric literals */
+
+char **literals;           /* string literals of the compiled program */
+int nliterals;             /* number of string literals */
+
+const BCODE *pc;           /* compiled code we are executing */
 int token;                 /* current token (lookahead) */
+int jumpindex;             /* line index of a resolved jump, -1 if none */
 int errorflag;             /* set when error in input encountered */
 
 
+int compileBasicScript(void);
+int compileline(int curline);
+void resolvejumps(int curline);
+void resolvefor(int curline);
+int emit(int cell);
+int addconstant(double x);
+int addliteral(const char *str);
+int tokenops(int tok);
 void cleanup(void);
 
 void reporterror(int lineno);
@@ -115,7 +134,7 @@ double dimvariable(void);
 
 VARIABLE *findvariable(const char *id);
 DIMVAR *finddimvar(const char *id);
-DIMVAR *dimension(const char *id, int ndims, ...);
+DIMVAR *dimension(DIMVAR *dv, int ndims, ...);
 void *getdimvar(DIMVAR *dv, ...);
 VARIABLE *addfloat(const char *id);
 VARIABLE *addstring(const char *id);
@@ -136,7 +155,6 @@ int integer(double x);
 
 void match(int tok);
 void seterror(int errorcode);
-int getnextline(int);
 int gettoken(const char *str);
 int tokenlen(const char *str, int token);
 
@@ -172,12 +190,24 @@ int execBasicScript(void)
     variables = 0;
     dimvariables = 0;
     ndimvariables = 0;
+    nfors = 0;
+
+    // Compile the script, the variables are created here so that the bytecode can refer to them by slot.
+    curline = compileBasicScript();
+    if(curline != -1)
+    {
+        reporterror(lines[curline].no);
+        cleanup();
+        return(1);
+    }
+    curline = 0;
 
     while(curline != -1)
     {
-        string = lines[curline].str;
-        token = gettoken(string);
+        pc = bcode + lines[curline].code;
+        token = *pc;
         errorflag = 0;
+        jumpindex = -1;
         nextline = line(curline);
         if(errorflag)
         {
@@ -204,7 +234,11 @@ int execBasicScript(void)
             break;
         }
 
-        if(nextline == 0)
+        if(jumpindex != -1)
+        {
+            curline = jumpindex;
+        }
+        else if(nextline == 0)
         {
             curline++;
             if(curline == nlines)
@@ -226,6 +260,288 @@ int execBasicScript(void)
     return answer;
 }
 
+/*
+  compile the program into bytecode.
+  Each line becomes a run of tokens ending in EOS. Numbers are replaced by
+  an index into the constant pool, string literals by an index into the
+  literal pool and identifiers by their slot in the variable tables, so
+  the source text is not scanned again while the program runs.
+  Returns: -1 on success, else the index of the line in error.
+*/
+int compileBasicScript(void)
+{
+  int i;
+
+  nbcode = 0;
+  errorflag = 0;
+
+  for(i=0;i<nlines;i++)
+  {
+    lines[i].code = nbcode;
+    if(compileline(i))
+      return i;
+  }
+
+  /* all line offsets are known, now resolve the jump targets */
+  for(i=0;i<nlines;i++)
+  {
+    resolvejumps(i);
+    resolvefor(i);
+  }
+
+  return -1;
+}
+
+/*
+  compile one source line.
+  Params: curline - index of the line to compile
+  Returns: 0 on success, 1 on error (errorflag set)
+*/
+int compileline(int curline)
+{
+  const char *str = lines[curline].str;
+  char id[32];
+  char *substr;
+  char *end;
+  int tok;
+  int len;
+  int slot;
+  VARIABLE *var;
+  DIMVAR *dimvar;
+
+  do
+  {
+    tok = gettoken(str);
+    while(isspace(*str))
+      str++;
+
+    switch(tok)
+    {
+      case VALUE:
+        emit(VALUE);
+        emit(addconstant(getvalue(str, &len)));
+        str += len;
+        break;
+      case FLTID:
+      case STRID:
+        getid(str, id, &len);
+        var = findvariable(id);
+        if(!var)
+          var = (tok == FLTID) ? addfloat(id) : addstring(id);
+        slot = var ? var - variables : 0;
+        emit(tok);
+        emit(slot);
+        str += len;
+        break;
+      case DIMFLTID:
+      case DIMSTRID:
+        getid(str, id, &len);
+        dimvar = finddimvar(id);
+        if(!dimvar)
+          dimvar = adddimvar(id);
+        slot = dimvar ? dimvar - dimvariables : 0;
+        emit(tok);
+        emit(slot);
+        str += len;
+        break;
+      case QUOTE:
+        end = mystrend(str, '"');
+        if(!end)
+        {
+          seterror(ERR_SYNTAX);
+          break;
+        }
+        substr = sys_malloc(end - str);
+        if(!substr)
+        {
+          seterror(ERR_OUTOFMEMORY);
+          break;
+        }
+        mystrgrablit(substr, str);
+        emit(QUOTE);
+        emit(addliteral(substr));
+        str = end + 1;
+        break;
+      case FOR:
+        /* operand is the line holding the matching NEXT, filled in by resolvefor() */
+        emit(FOR);
+        emit(-1);
+        str += tokenlen(str, tok);
+        break;
+      case REM:
+        /* the rest of the line is not parsed */
+        emit(REM);
+        tok = EOS;
+        break;
+      case EOL:
+        tok = EOS;
+        break;
+      case ERROR:
+        seterror(ERR_SYNTAX);
+        break;
+      default:
+        if(tok != EOS)
+          emit(tok);
+        str += tokenlen(str, tok);
+        break;
+    }
+  } while(tok != EOS && !errorflag);
+
+  emit(EOS);
+
+  return errorflag ? 1 : 0;
+}
+
+/*
+  replace a constant GOTO or THEN target with the index of the line it
+  refers to, targets which do not exist are left for the run time error.
+  Params: curline - index of the line to resolve
+*/
+void resolvejumps(int curline)
+{
+  BCODE *code = bcode + lines[curline].code;
+  double target;
+  int idx;
+
+  while(*code != EOS)
+  {
+    if((*code == GOTO || *code == THEN) && code[1] == VALUE && code[3] == EOS)
+    {
+      target = constants[code[2]];
+      if(target == (int) target && (idx = findline((int) target)) != -1)
+      {
+        code[1] = LINEREF;
+        code[2] = idx;
+      }
+      return;
+    }
+    code += 1 + tokenops(*code);
+  }
+}
+
+/*
+  find the NEXT closing a FOR so a loop which does not execute can jump
+  straight past it.
+  Params: curline - index of the line to resolve
+*/
+void resolvefor(int curline)
+{
+  BCODE *code = bcode + lines[curline].code;
+  const BCODE *next;
+  int idx;
+
+  /* a statement is line number, keyword, operands */
+  if(code[2] != FOR || (code[4] != FLTID && code[4] != DIMFLTID))
+    return;
+
+  for(idx=curline+1;idx<nlines;idx++)
+  {
+    next = bcode + lines[idx].code;
+    if(next[2] == NEXT && next[3] == code[4] && next[4] == code[5])
+    {
+      code[3] = idx;
+      return;
+    }
+  }
+}
+
+/*
+  append a cell to the bytecode.
+  Params: cell - token or operand to append
+  Returns: 0 on success, 1 if out of memory (errorflag set)
+*/
+int emit(int cell)
+{
+  BCODE *temp;
+
+  if(nbcode == maxbcode)
+  {
+    temp = sys_realloc(bcode, (maxbcode + BCODE_CHUNK) * sizeof(BCODE));
+    if(!temp)
+    {
+      seterror(ERR_OUTOFMEMORY);
+      return 1;
+    }
+    bcode = temp;
+    maxbcode += BCODE_CHUNK;
+  }
+  bcode[nbcode++] = (BCODE) cell;
+  return 0;
+}
+
+/*
+  add a number to the constant pool.
+  Params: x - the value
+  Returns: index in the pool
+*/
+int addconstant(double x)
+{
+  double *temp;
+
+  if(nconstants == BCODE_MAXOPERAND)
+  {
+    seterror(ERR_OUTOFMEMORY);
+    return 0;
+  }
+  temp = sys_realloc(constants, (nconstants + 1) * sizeof(double));
+  if(!temp)
+  {
+    seterror(ERR_OUTOFMEMORY);
+    return 0;
+  }
+  constants = temp;
+  constants[nconstants] = x;
+  return nconstants++;
+}
+
+/*
+  add a string to the literal pool.
+  Params: str - malloced string, the pool takes ownership
+  Returns: index in the pool
+*/
+int addliteral(const char *str)
+{
+  char **temp;
+
+  if(nliterals == BCODE_MAXOPERAND)
+  {
+    sys_free((void *) str);
+    seterror(ERR_OUTOFMEMORY);
+    return 0;
+  }
+  temp = sys_realloc(literals, (nliterals + 1) * sizeof(char *));
+  if(!temp)
+  {
+    sys_free((void *) str);
+    seterror(ERR_OUTOFMEMORY);
+    return 0;
+  }
+  literals = temp;
+  literals[nliterals] = (char *) str;
+  return nliterals++;
+}
+
+/*
+  number of operand cells following a token in the bytecode
+*/
+int tokenops(int tok)
+{
+  switch(tok)
+  {
+    case VALUE:
+    case FLTID:
+    case STRID:
+    case DIMFLTID:
+    case DIMSTRID:
+    case QUOTE:
+    case LINEREF:
+    case FOR:
+      return 1;
+    default:
+      return 0;
+  }
+}
+
 /*
   frees all the memory we have allocated
 */
@@ -269,6 +585,24 @@ void cleanup(void)
   dimvariables = 0;
   ndimvariables = 0;
 
+  if(bcode)
+    sys_free(bcode);
+  bcode = 0;
+  nbcode = 0;
+  maxbcode = 0;
+
+  if(constants)
+    sys_free(constants);
+  constants = 0;
+  nconstants = 0;
+
+  for(i=0;i<nliterals;i++)
+    sys_free(literals[i]);
+  if(literals)
+    sys_free(literals);
+  literals = 0;
+  nliterals = 0;
+
   if(lines)
     sys_free(lines);
 
@@ -398,7 +732,6 @@ int findline(int no)
 int line(int curline)
 {
   int answer = 0;
-  const char *str;
 
   match(VALUE);
 
@@ -445,20 +778,7 @@ int line(int curline)
   }
 
   if(token != EOS)
-  {
-    /*match(VALUE);*/
-    /* check for a newline */
-    str = string;
-    while(isspace(*str))
-    {
-      if(*str == '\n')
-        break;
-      str++;
-    }
-
-    if(*str != '\n')
-      seterror(ERR_SYNTAX);
-  }
+    seterror(ERR_SYNTAX);
 
   return answer;
 }
@@ -542,8 +862,6 @@ void dodim(int curline)
 {
   int ndims = 0;
   double dims[6];
-  char name[32];
-  int len;
   DIMVAR *dimvar;
   int i;
   int size = 1;
@@ -554,7 +872,7 @@ void dodim(int curline)
   {
     case DIMFLTID:
     case DIMSTRID:
-      getid(string, name, &len);
+      dimvar = &dimvariables[pc[1]];
       match(token);
       dims[ndims++] = expr();
       while(token == COMMA)
@@ -581,19 +899,19 @@ void dodim(int curline)
       switch(ndims)
       {
         case 1:
-          dimvar = dimension(name, 1, (int) dims[0]);
+          dimvar = dimension(dimvar, 1, (int) dims[0]);
           break;
         case 2:
-          dimvar = dimension(name, 2, (int) dims[0], (int) dims[1]);
+          dimvar = dimension(dimvar, 2, (int) dims[0], (int) dims[1]);
           break;
         case 3:
-          dimvar = dimension(name, 3, (int) dims[0], (int) dims[1], (int) dims[2]);
+          dimvar = dimension(dimvar, 3, (int) dims[0], (int) dims[1], (int) dims[2]);
           break;
         case 4:
-          dimvar = dimension(name, 4, (int) dims[0], (int) dims[1], (int) dims[2], (int) dims[3]);
+          dimvar = dimension(dimvar, 4, (int) dims[0], (int) dims[1], (int) dims[2], (int) dims[3]);
           break;
         case 5:
-          dimvar = dimension(name, 5, (int) dims[0], (int) dims[1], (int) dims[2], (int) dims[3], (int) dims[4]);
+          dimvar = dimension(dimvar, 5, (int) dims[0], (int) dims[1], (int) dims[2], (int) dims[3], (int) dims[4]);
           break;
       }
       break;
@@ -665,6 +983,15 @@ int doif(int curline)
   match(IF);
   condition = boolexpr();
   match(THEN);
+  if(token == LINEREF)
+  {
+    jump = pc[1];
+    match(LINEREF);
+    if(!condition)
+      return 0;
+    jumpindex = jump;
+    return lines[jump].no;
+  }
   jump = integer( expr() );
   if(condition)
     return jump;
@@ -679,6 +1006,12 @@ int doif(int curline)
 int dogoto(int curline)
 {
   match(GOTO);
+  if(token == LINEREF)
+  {
+    jumpindex = pc[1];
+    match(LINEREF);
+    return lines[jumpindex].no;
+  }
   return integer( expr() );
 }
 
@@ -692,18 +1025,13 @@ int dogoto(int curline)
 int dofor(int curline)
 {
   LVALUE lv;
-  char        id[32];
-  char        nextid[32];
-  int         len;
-  int         idx;
+  int         nextline;
   double      initval;
   double      toval;
   double      stepval;
-  const char  *savestring;
-  int         answer;
 
+  nextline = pc[1];
   match(FOR);
-  getid(string, id, &len);
 
   lvalue(&lv);
   if(lv.type != FLTID)
@@ -735,37 +1063,20 @@ int dofor(int curline)
 
   if((stepval < 0 && initval < toval) || (stepval > 0 && initval > toval))
   {
-    savestring = string;
-    for(idx=curline+1; idx < nlines; idx++)
+    /* loop not taken, continue below the matching NEXT found at compile time */
+    if(nextline == -1)
     {
-        string = lines[idx].str;
-        errorflag = 0;
-        token = gettoken(string);
-        match(VALUE);
-        if(token == NEXT)
-        {
-            match(NEXT);
-            if(token == FLTID || token == DIMFLTID)
-            {
-                getid(string, nextid, &len);
-                if(!strcmp(id, nextid))
-                {
-                    answer = getnextline(curline);
-                    string = savestring;
-                    token = gettoken(string);
-                    return answer ? answer : -1;
-                }
-            }
-        }
+      seterror(ERR_NONEXT);
+      return -1;
     }
-
-    seterror(ERR_NONEXT);
-    return -1;
+    if(nextline + 1 >= nlines)
+      return -1;
+    jumpindex = nextline + 1;
+    return lines[jumpindex].no;
   }
   else
   {
-      strcpy(forstack[nfors].id, id);
-      forstack[nfors].nextline = getnextline(curline);
+      forstack[nfors].nextline = curline + 1;
       forstack[nfors].step = stepval;
       forstack[nfors].toval = toval;
       nfors++;
@@ -779,15 +1090,12 @@ int dofor(int curline)
 */
 int donext(int curline)
 {
-  char id[32];
-  int len;
   LVALUE lv;
 
   match(NEXT);
 
   if(nfors)
   {
-    getid(string, id, &len);
     lvalue(&lv);
     if(lv.type != FLTID)
     {
@@ -803,7 +1111,8 @@ int donext(int curline)
     }
     else
     {
-      return forstack[nfors-1].nextline;
+      jumpindex = forstack[nfors-1].nextline;
+      return lines[jumpindex].no;
     }
   }
   else
@@ -920,8 +1229,6 @@ int dopoke(int curline)
 */
 void lvalue(LVALUE *lv)
 {
-  char name[32];
-  int len;
   VARIABLE *var;
   DIMVAR *dimvar;
   int index[5];
@@ -935,31 +1242,17 @@ void lvalue(LVALUE *lv)
   switch(token)
   {
     case FLTID:
-      getid(string, name, &len);
+      var = &variables[pc[1]];
       match(FLTID);
-      var = findvariable(name);
-      if(!var)
-        var = addfloat(name);
-      if(!var)
-      {
-        seterror(ERR_OUTOFMEMORY);
-        return;
-      }
+      var->set = 1;
       lv->type = FLTID;
       lv->dval = &var->dval;
       lv->sval = 0;
       break;
     case STRID:
-      getid(string, name, &len);
+      var = &variables[pc[1]];
       match(STRID);
-      var = findvariable(name);
-      if(!var)
-        var = addstring(name);
-      if(!var)
-      {
-        seterror(ERR_OUTOFMEMORY);
-        return;
-      }
+      var->set = 1;
       lv->type = STRID;
       lv->sval = &var->sval;
       lv->dval = 0;
@@ -967,10 +1260,9 @@ void lvalue(LVALUE *lv)
     case DIMFLTID:
     case DIMSTRID:
       type = (token == DIMFLTID) ? FLTID : STRID;
-      getid(string, name, &len);
+      dimvar = &dimvariables[pc[1]];
       match(token);
-      dimvar = finddimvar(name);
-      if(dimvar)
+      if(dimvar->ndims)
       {
         switch(dimvar->ndims)
         {
@@ -1287,7 +1579,6 @@ double factor(void)
     double   answer = 0;
     char     *str;
     char     *end;
-    int      len;
     uint32_t addr;
     uint32_t width;
   
@@ -1299,7 +1590,7 @@ double factor(void)
         match(CPAREN);
         break;
       case VALUE:
-        answer = getvalue(string, &len);
+        answer = constants[pc[1]];
         match(VALUE);
         break;
       case MINUS:
@@ -1577,13 +1868,10 @@ double instr(void)
 double variable(void)
 {
   VARIABLE *var;
-  char id[32];
-  int len;
 
-  getid(string, id, &len);
+  var = &variables[pc[1]];
   match(FLTID);
-  var = findvariable(id);
-  if(var)
+  if(var->set)
     return var->dval;
   else
   {
@@ -1599,16 +1887,13 @@ double variable(void)
 double dimvariable(void)
 {
   DIMVAR *dimvar;
-  char id[32];
-  int len;
   int index[5];
   double *answer;
 
   answer = NULL;
-  getid(string, id, &len);
+  dimvar = &dimvariables[pc[1]];
   match(DIMFLTID);
-  dimvar = finddimvar(id);
-  if(!dimvar)
+  if(!dimvar->ndims)
   {
     seterror(ERR_NOSUCHVARIABLE);
     return 0.0;
@@ -1703,13 +1988,12 @@ DIMVAR *finddimvar(const char *id)
 
 /*
   dimension an array.
-  Params: id - the id of the array (include leading ()
+  Params: dv - the array's entry in variable list
           ndims - number of dimension (1-5)
           ... - integers giving dimension size, 
 */
-DIMVAR *dimension(const char *id, int ndims, ...)
+DIMVAR *dimension(DIMVAR *dv, int ndims, ...)
 {
-  DIMVAR *dv;
   va_list vargs;
   int size = 1;
   int oldsize = 1;
@@ -1722,15 +2006,6 @@ DIMVAR *dimension(const char *id, int ndims, ...)
   if(ndims > 5)
     return 0;
 
-  dv = finddimvar(id);
-  if(!dv)
-    dv = adddimvar(id);
-  if(!dv)
-  {
-    seterror(ERR_OUTOFMEMORY);
-    return 0;
-  }
-
   if(dv->ndims)
   {
     for(i=0;i<dv->ndims;i++)
@@ -1908,6 +2183,7 @@ VARIABLE *addfloat(const char *id)
     strcpy(variables[nvariables].id, id);
     variables[nvariables].dval = 0;
     variables[nvariables].sval = 0;
+    variables[nvariables].set = 0;
     nvariables++;
     return &variables[nvariables-1];
   }
@@ -1933,6 +2209,7 @@ VARIABLE *addstring(const char *id)
     strcpy(variables[nvariables].id, id);
     variables[nvariables].sval = 0;
     variables[nvariables].dval = 0;
+    variables[nvariables].set = 0;
     nvariables++;
     return &variables[nvariables-1];
   }
@@ -2274,18 +2551,15 @@ char *stringstring(void)
 */
 char *stringdimvar(void)
 {
-  char id[32];
-  int len;
   DIMVAR *dimvar;
   char **answer;
   int index[5];
 
   answer = NULL;
-  getid(string, id, &len);
+  dimvar = &dimvariables[pc[1]];
   match(DIMSTRID);
-  dimvar = finddimvar(id);
 
-  if(dimvar)
+  if(dimvar->ndims)
   {
     switch(dimvar->ndims)
     {
@@ -2350,14 +2624,11 @@ char *stringdimvar(void)
 */
 char *stringvar(void)
 {
-  char id[32];
-  int len;
   VARIABLE *var;
 
-  getid(string, id, &len);
+  var = &variables[pc[1]];
   match(STRID);
-  var = findvariable(id);
-  if(var)
+  if(var->set)
   {
     if(var->sval)
       return var->sval;
@@ -2370,52 +2641,26 @@ char *stringvar(void)
 /*
   parse a string literal
   Returns: malloced string literal
-  Notes: newlines aren't allwed in literals, but blind
-         concatenation across newlines is. 
+  Notes: adjacent literals are concatenated.
 */
 char *stringliteral(void)
 {
-  int len = 1;
   char *answer = 0;
   char *temp;
-  char *substr;
-  char *end;
 
   while(token == QUOTE)
   {
-    while(isspace(*string))
-      string++;
-
-    end = mystrend(string, '"');
-    if(end)
+    if(answer)
     {
-      len = end - string;
-      substr = sys_malloc(len);
-      if(!substr)
-      {
-        seterror(ERR_OUTOFMEMORY);
-        return answer;
-      }
-      mystrgrablit(substr, string);
-      if(answer)
-      {
-        temp = mystrconcat(answer, substr);
-        sys_free(substr);
-        sys_free(answer);
-        answer = temp;
-        if(!answer)
-        {
-          seterror(ERR_OUTOFMEMORY);
-          return answer;
-        }
-      }
-      else
-        answer = substr;
-      string = end;
+      temp = mystrconcat(answer, literals[pc[1]]);
+      sys_free(answer);
+      answer = temp;
     }
     else
+      answer = mystrdup(literals[pc[1]]);
+    if(!answer)
     {
-      seterror(ERR_SYNTAX);
+      seterror(ERR_OUTOFMEMORY);
       return answer;
     }
 
@@ -2444,7 +2689,7 @@ int integer(double x)
 /*
   check that we have a token of the passed type 
   (if not set the errorflag)
-  Move parser on to next token. Sets token and string.
+  Move parser on to next token in the bytecode. Sets token and pc.
 */
 void match(int tok)
 {
@@ -2454,13 +2699,11 @@ void match(int tok)
     return;
   }
 
-  while(isspace(*string))
-    string++;
+  if(token == EOS)
+    return;
 
-  string += tokenlen(string, token);
-  token = gettoken(string);
-  if(token == ERROR)
-    seterror(ERR_SYNTAX);
+  pc += 1 + tokenops(token);
+  token = *pc;
 }
 
 /*
@@ -2474,30 +2717,6 @@ void seterror(int errorcode)
     errorflag = errorcode;
 }
 
-/*
-  get the next line number
-  Params: curline - line being processed.
-  Returns: line no of next line, 0 if end
-  Notes: goes to next line then finds
-         first line starting with a digit.
-*/
-int getnextline(int curline)
-{
-    int        idx;
-    const char *str;
-
-    for(idx=curline+1; idx < nlines; idx++)
-    {
-        str = lines[idx].str;
-        while(*str && *str == ' ') str++;
-        if(*str == 0)
-            return 0;
-        if(isdigit(*str))
-            return atoi(str);
-    }
-    return 0;
-}
-
 /*
   get a token from the string
   Params: str - string to read token from
@@ -0,0 +1,20 @@
+10 REM Array benchmark, fill and bubble sort a numeric array.
+20 LET N = 100
+30 DIM A(100)
+40 FOR I = 1 TO N
+50 LET A(I) = (I * 7919) MOD 1000
+60 NEXT I
+70 FOR I = 1 TO N - 1
+80 FOR J = 1 TO N - I
+90 IF A(J) <= A(J + 1) THEN 130
+100 LET T = A(J)
+110 LET A(J) = A(J + 1)
+120 LET A(J + 1) = T
+130 NEXT J
+140 NEXT I
+150 LET K = 1
+160 FOR I = 1 TO N - 1
+170 IF A(I) <= A(I + 1) THEN 190
+180 LET K = 0
+190 NEXT I
+200 PRINT "Sorted ", K, " first ", A(1), " last ", A(N)
@@ -0,0 +1,10 @@
+10 REM Loop benchmark, FOR/NEXT and GOTO loops with arithmetic.
+20 LET S = 0
+30 FOR I = 1 TO 20000
+40 LET S = S + I * 2 - 1
+50 NEXT I
+60 PRINT "FOR loop sum ", S
+70 LET J = 0
+80 LET J = J + 1
+90 IF J < 20000 THEN 80
+100 PRINT "GOTO loop count ", J
@@ -0,0 +1,14 @@
+10 REM String benchmark, concatenation, slicing, comparison and search.
+20 LET A$ = ""
+30 FOR I = 1 TO 200
+40 LET A$ = A$ + CHR$(65 + I MOD 26)
+50 NEXT I
+60 LET C = 0
+70 LET P = 0
+80 FOR I = 1 TO 2000
+90 LET B$ = MID$(A$, I MOD 150 + 1, 10)
+100 IF LEFT$(B$, 1) <> "A" THEN 120
+110 LET C = C + 1
+120 LET P = P + INSTR(A$, RIGHT$(B$, 2), 1)
+130 NEXT I
+140 PRINT "Length ", LEN(A$), " matches ", C, " positions ", P
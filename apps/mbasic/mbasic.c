@@ -18,6 +18,8 @@
 //
 // History:         April 2020   - Ported v1.0 of Mini Basic from Malcolm McLean to work on the ZPU and
 //                                 K64F, updates to function with the K64F processor and zOS.
+//                  Oct 2026     - v1.1 RUN compiles the program to bytecode before execution, see
+//                                 bench/*.bas for timing programs.
 //
 // Notes:           See Makefile to enable/disable conditional components
 //
@@ -76,8 +78,8 @@
 #include "tools.c"
 
 // Version info.
-#define VERSION      "v1.0"
-#define VERSION_DATE "10/04/2020"
+#define VERSION      "v1.1"
+#define VERSION_DATE "16/10/2026"
 #define APP_NAME     "MBASIC"
 
 // List of commands processed by the glue logic between mini basic and ed.
@@ -18,6 +18,8 @@
 //
 // History:         April 2020   - Ported v1.0 of Mini Basic from Malcolm McLean to work on the ZPU and
 //                                 K64F, updates to function with the K64F processor and zOS.
+//                  Oct 2026     - Programs are compiled to bytecode at RUN time, variables, literals and
+//                                 GOTO/FOR/NEXT targets are resolved once rather than on every execution.
 //
 // Notes:           See Makefile to enable/disable conditional components
 //
@@ -100,6 +102,7 @@
 #define GREATER                     28
 #define LESS                        29
 #define SEMICOLON                   30
+#define LINEREF                     31    /* compiled only, resolved GOTO/THEN target line index */
 
 #define PRINT                       100
 #define LET                         101
@@ -177,6 +180,8 @@
 #define ERR_NOTINT                  21
 
 #define MAXFORS                     32    /* maximum number of nested fors */
+#define BCODE_CHUNK                 256   /* bytecode buffer growth in cells */
+#define BCODE_MAXOPERAND            32767 /* largest pool index or slot an operand cell can hold */
 
 struct editorSyntax {
     char **filematch;
@@ -251,11 +256,15 @@ enum KEY_ACTION{
 };
 
 
+/* compiled program cell, a token or the operand following it */
+typedef int16_t BCODE;
+
 typedef struct
 {
   int no;                  /* line number */
   int eno;                 /* Editor line number */
   const char *str;         /* points to start of line */
+  int code;                /* offset of the compiled line in the bytecode */
 }LINE;
 
 typedef struct
@@ -263,6 +272,7 @@ typedef struct
   char id[32];             /* id of variable */
   double dval;             /* its value if a real */
   char *sval;              /* its value if a string (malloced) */
+  int set;                 /* assigned, reads before this are an error */
 } VARIABLE;
 
 typedef struct
@@ -284,8 +294,7 @@ typedef struct
 
 typedef struct
 {
-  char id[32];             /* id of control variable */
-  int nextline;            /* line below FOR to which control passes */
+  int nextline;            /* index of line below FOR to which control passes */
   double toval;            /* terminal value */
   double step;             /* step size */
 } FORLOOP;
@@ -320,6 +329,14 @@ int                editorFileWasModified(void);
 int                editorAddBasicLine(int, char *, size_t);
 uint32_t           initEditor(void);
 int                execBasicScript(void);
+int                compileBasicScript(void);
+int                compileline(int);
+void               resolvejumps(int);
+void               resolvefor(int);
+int                emit(int);
+int                addconstant(double);
+int                addliteral(const char *);
+int                tokenops(int);
 void               cleanup(void);
 void               reporterror(int);
 int                findline(int);
@@ -346,7 +363,7 @@ double             variable(void);
 double             dimvariable(void);
 VARIABLE          *findvariable(const char *);
 DIMVAR            *finddimvar(const char *);
-DIMVAR            *dimension(const char *, int , ...);
+DIMVAR            *dimension(DIMVAR *, int , ...);
 void              *getdimvar(DIMVAR *, ...);
 VARIABLE          *addfloat(const char *);
 VARIABLE          *addstring(const char *);
@@ -364,7 +381,6 @@ char              *stringliteral(void);
 int                integer(double);
 void               match(int);
 void               seterror(int);
-int                getnextline(int);
 int                gettoken(const char *);
 int                tokenlen(const char *, int);
 int                isstring(int);
@@ -0,0 +1,244 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            mbench.c
+// Created:         October 2026
+// Author(s):       Philip Smart
+// Description:     Standalone App for the zOS/ZPU test application.
+//                  This program implements a loadable appliation which can be loaded from SD card by
+//                  the zOS/ZPUTA application. The idea is that commands or programs can be stored on the
+//                  SD card and executed by zOS/ZPUTA just like an OS such as Linux. The primary purpose
+//                  is to be able to minimise the size of zOS/ZPUTA for applications where minimal ram is
+//                  available.
+//
+// Credits:         
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         Oct 2026     - Initial version, benchmark of the memcpy/memmove/memset/memcmp library functions.
+//                                 Reports bytes per CPU cycle for each size class so the word at a time library
+//                                 routines can be compared across the ZPU and K64F builds.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+#if defined(__K64F__)
+  #include <stdio.h>
+  #include <stdint.h>
+  #include <string.h>
+  #include "k64f_soc.h"
+  #include "kinetis.h"
+  #include <../../libraries/include/stdmisc.h>
+#elif defined(__ZPU__)
+  #include <stdint.h>
+  #include <stdio.h>	    
+  #include "zpu_soc.h"
+  #include <stdlib.h>
+  #include <string.h>
+  #include <stdmisc.h>
+#else
+  #error "Target CPU not defined, use __ZPU__ or __K64F__"
+#endif
+#include "interrupts.h"
+#include "ff.h"            /* Declarations of FatFs API */
+#include "utils.h"
+//
+#if defined __ZPUTA__
+  #include "zputa_app.h"
+#elif defined __ZOS__
+  #include "zOS_app.h"
+#else
+  #error OS not defined, use __ZPUTA__ or __ZOS__      
+#endif
+//
+#include "app.h"
+#include "mbench.h"
+
+// Utility functions.
+#include "tools.c"
+
+// Version info.
+#define VERSION      "v1.0"
+#define VERSION_DATE "16/10/2026"
+#define APP_NAME     "MBENCH"
+
+// Functions under test.
+enum MBENCHFUNC {
+    MBENCH_MEMCPY,                                   // Aligned memcpy.
+    MBENCH_MEMCPY_UNALIGNED,                         // memcpy with the destination one byte off the source alignment.
+    MBENCH_MEMMOVE,                                  // Overlapping memmove, destination above source so it runs backwards.
+    MBENCH_MEMSET,                                   // Aligned memset.
+    MBENCH_MEMCMP,                                   // memcmp of two identical blocks, ie. a full scan.
+    MBENCH_FUNCS
+};
+
+// Sink for the memcmp result so the calls cannot be discarded.
+volatile int benchSink;
+
+// Method to prepare the cycle counter. On the K64F the DWT cycle counter is used directly, on the ZPU the millisecond
+// timer is scaled by the system clock frequency reported by the SoC.
+//
+uint32_t benchInit(void)
+{
+    uint32_t  cpuFreqKHz;
+
+  #if defined __ZPU__
+    cpuFreqKHz = IS_IMPL_SOCCFG ? SOCCFG(SOCCFG_SYSFREQ) * 100 : CLK_FREQ / 1000;
+  #elif defined __K64F__
+    ARM_DEMCR    |= ARM_DEMCR_TRCENA;
+    ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+    cpuFreqKHz    = F_CPU / 1000;
+  #else
+    #error "Target CPU not defined, use __ZPU__ or __K64F__"
+  #endif
+    return(cpuFreqKHz);
+}
+
+// Method to return a free running count, in CPU cycles on the K64F and milliseconds on the ZPU.
+//
+uint32_t benchCount(void)
+{
+    uint32_t  count;
+
+  #if defined __ZPU__
+    count = (uint32_t)TIMER_MILLISECONDS_UP;
+  #elif defined __K64F__
+    count = ARM_DWT_CYCCNT;
+  #else
+    #error "Target CPU not defined, use __ZPU__ or __K64F__"
+  #endif
+    return(count);
+}
+
+// Method to run one function over blocks of a given size until the requested volume has been processed and return the
+// rate in bytes per cycle, scaled by 1000.
+//
+uint32_t benchFunc(enum MBENCHFUNC func, uint8_t *src, uint8_t *dst, uint32_t size, uint32_t bytes, uint32_t cpuFreqKHz)
+{
+    // Locals.
+    //
+    uint32_t  blocks = bytes / size;
+    uint32_t  startCount;
+    uint32_t  cycles;
+    uint32_t  idx;
+
+    startCount = benchCount();
+    switch(func)
+    {
+        case MBENCH_MEMCPY:
+            for(idx=0; idx < blocks; idx++) { memcpy(dst, src, size); }
+            break;
+
+        case MBENCH_MEMCPY_UNALIGNED:
+            for(idx=0; idx < blocks; idx++) { memcpy(dst+1, src, size); }
+            break;
+
+        case MBENCH_MEMMOVE:
+            for(idx=0; idx < blocks; idx++) { memmove(src+4, src, size); }
+            break;
+
+        case MBENCH_MEMSET:
+            for(idx=0; idx < blocks; idx++) { memset(dst, (int)idx, size); }
+            break;
+
+        case MBENCH_MEMCMP:
+        default:
+            for(idx=0; idx < blocks; idx++) { benchSink += memcmp(dst, src, size); }
+            break;
+    }
+    cycles = benchCount() - startCount;
+
+  #if defined __ZPU__
+    // Millisecond resolution, express the rate per millisecond first to stay within 32 bits.
+    return(cycles == 0 ? 0 : ((blocks * size) / cycles) * 1000 / cpuFreqKHz);
+  #else
+    return(cycles == 0 ? 0 : (blocks * size * 1000) / cycles);
+  #endif
+}
+
+// Main entry and start point of a zOS/ZPUTA Application. Only 2 parameters are catered for and a 32bit return code, additional parameters can be added by changing the appcrt0.s
+// startup code to add them to the stack prior to app() call.
+//
+// Return code for the ZPU is saved in _memreg by the C compiler, this is transferred to _memreg in zOS/ZPUTA in appcrt0.s prior to return.
+// The K64F ARM processor uses the standard register passing conventions, return code is stored in R0.
+//
+uint32_t app(uint32_t param1, uint32_t param2)
+{
+    // Initialisation.
+    //
+    char      *ptr = (char *)param1;
+    long      startAddr;
+    long      xferKB;
+    uint32_t  sizes[] = MBENCH_SIZE_CLASSES;
+    uint32_t  cpuFreqKHz;
+    uint32_t  rate;
+    uint8_t   *src;
+    uint8_t   *dst;
+    int       sizeIdx;
+    int       func;
+
+    if (!xatoi(&ptr, &startAddr))
+    {
+        printf("Illegal <start addr> value.\n");
+    } else
+    {
+        if(!xatoi(&ptr, &xferKB) || xferKB <= 0)
+        {
+            xferKB = MBENCH_DEFAULT_KB;
+        }
+        if(xferKB > MBENCH_MAX_KB)
+        {
+            xferKB = MBENCH_MAX_KB;
+        }
+
+        // Word align the work area, source block first, destination block after with slack for the unaligned and overlapping tests.
+        src = (uint8_t *)((startAddr + 3) & ~3L);
+        dst = src + MBENCH_MAX_SIZE + 8;
+        cpuFreqKHz = benchInit();
+
+        printf("Memory function performance, area:%08lx:%08lx, %ldKB per test, CPU:%luMHz\n", (long)src, (long)src + MBENCH_AREA_SIZE - 1, xferKB, cpuFreqKHz / 1000);
+        printf("Bytes/cycle   memcpy  memcpy+1   memmove    memset    memcmp\n");
+        memset(src, 0x55, MBENCH_MAX_SIZE + 8);
+        memset(dst, 0x55, MBENCH_MAX_SIZE + 8);
+
+        for(sizeIdx=0; sizeIdx < (int)(sizeof(sizes)/sizeof(uint32_t)); sizeIdx++)
+        {
+            printf("%5lu     ", sizes[sizeIdx]);
+            for(func=0; func < MBENCH_FUNCS; func++)
+            {
+                // memmove leaves the source shifted, restore it so memcmp still compares identical blocks.
+                if(func == MBENCH_MEMCMP)
+                {
+                    memset(src, 0x55, MBENCH_MAX_SIZE + 8);
+                    memset(dst, 0x55, MBENCH_MAX_SIZE + 8);
+                }
+                rate = benchFunc((enum MBENCHFUNC)func, src, dst, sizes[sizeIdx], xferKB * 1024, cpuFreqKHz);
+                printf("%4lu.%03lu ", rate / 1000, rate % 1000);
+            }
+            printf("\n");
+        }
+    }
+
+    return(0);
+}
+
+#ifdef __cplusplus
+}
+#endif
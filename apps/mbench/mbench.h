@@ -0,0 +1,59 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            mbench.h
+// Created:         October 2026
+// Author(s):       Philip Smart
+// Description:     Standalone App for the zOS/ZPU test application.
+//                  This program implements a loadable appliation which can be loaded from SD card by
+//                  the zOS/ZPUTA application. The idea is that commands or programs can be stored on the
+//                  SD card and executed by zOS/ZPUTA just like an OS such as Linux. The primary purpose
+//                  is to be able to minimise the size of zOS/ZPUTA for applications where minimal ram is
+//                  available.
+//
+// Credits:         
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         Oct 2026     - Initial version, benchmark of the memcpy/memmove/memset/memcmp library functions.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef MBENCH_H
+#define MBENCH_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+// Constants.
+
+// Application execution constants.
+//
+#define MBENCH_MAX_SIZE             4096                                 // Largest size class, the work area must hold 2 blocks of this size plus alignment slack.
+#define MBENCH_AREA_SIZE            ((MBENCH_MAX_SIZE * 2) + 16)         // Bytes needed at <start addr> for the source and destination blocks.
+#define MBENCH_DEFAULT_KB           256                                  // Default volume in KBytes moved per function and size class.
+#define MBENCH_MAX_KB               1024                                 // Upper limit keeps bytes * 1000 within 32 bits for the rate calculation.
+#define MBENCH_SIZE_CLASSES         { 4, 16, 64, 256, 1024, MBENCH_MAX_SIZE }
+
+// Components to be embedded in the program.
+//
+// Memory components to be embedded in the program.
+#define BUILTIN_MEM_BENCH           1
+
+#ifdef __cplusplus
+}
+#endif
+#endif // MBENCH_H
@@ -2,6 +2,7 @@
 #include "basic_editor.h"
 #include "basic_utils.h"
 #include "basic_tokens.h"
+#include "basic_exectoks.h"
 #include "basic_extern.h"
 #include "basic_textual.h"
 
@@ -110,6 +111,7 @@ char editorLoadParsed() {
         return 0;
     }
     storageOperation(lineSpace, -2);
+    resetVarSlots();
     while (1) {
         storageOperation(p, (short) -sizeof(short));
         if (*((short*)p) == 0) {
@@ -121,6 +123,7 @@ char editorLoadParsed() {
         storageOperation(lineSpace, -len);
         lineSpace[len] = 0;
         parseLine(lineSpace, toksBody);
+        bindVarSlots(toksBody);
         len = tokenChainSize(toksBody);
         *((char*)p) = len;
         memcpy((char*)p + 1, toksBody, len);
@@ -21,6 +21,9 @@ labelCacheElem* labelCache;
 short labelsCached;
 numeric lastDim;
 static numeric execStepsCount;
+static short slotName[VAR_SLOTS];
+static unsigned char slotVar[VAR_SLOTS];
+static unsigned char numSlots;
 static numeric delayT0, delayLimit;
 
 void execRem(void);
@@ -136,6 +139,74 @@ void setVar(short name, numeric value) {
     vars[i].value = value;
 }
 
+void resetVarSlots(void) {
+    numSlots = 0;
+}
+
+short varSlot(short name) {
+    unsigned char i;
+    for (i = 0; i < numSlots; i++) {
+        if (slotName[i] == name) {
+            return i;
+        }
+    }
+    if (numSlots >= VAR_SLOTS) {
+        return -1;
+    }
+    slotName[numSlots] = name;
+    return numSlots++;
+}
+
+void bindVarSlots(token* t) {
+    token* next;
+    short slot;
+    char input = 0;
+    while (t->type != TT_NONE && t->type != TT_ERROR) {
+        next = nextToken(t);
+        if (t->type == TT_VARIABLE || t->type == TT_NAME) {
+            slot = varSlot(shortVarName(&(t->body.str)));
+            // INPUT keeps its name for the prompt, the slot just makes sure the variable exists
+            if (slot >= 0 && !input) {
+                t->type = TT_VARSLOT;
+                t->body.symbol = slot;
+                memmove(nextToken(t), next, tokenChainSize(next));
+                next = nextToken(t);
+            }
+        }
+        input = (t->type == TT_COMMAND && t->body.command == CMD_INPUT);
+        t = next;
+    }
+}
+
+void resolveVarSlots(void) {
+    unsigned char i, v;
+    // create every bound variable first, scalars sort below arrays so later DIMs do not move them
+    for (i = 0; i < numSlots; i++) {
+        v = findVar(slotName[i]);
+        if (v >= numVars || vars[v].name != slotName[i]) {
+            setVar(slotName[i], 0);
+        }
+    }
+    for (i = 0; i < numSlots; i++) {
+        v = findVar(slotName[i]);
+        slotVar[i] = (v < numVars && vars[v].name == slotName[i]) ? v : NO_VAR_SLOT;
+    }
+}
+
+numeric getSlot(unsigned char slot) {
+    unsigned char v = slotVar[slot];
+    return v != NO_VAR_SLOT ? vars[v].value : getVar(slotName[slot]);
+}
+
+void setSlot(unsigned char slot, numeric value) {
+    unsigned char v = slotVar[slot];
+    if (v != NO_VAR_SLOT) {
+        vars[v].value = value;
+    } else {
+        setVar(slotName[slot], value);
+    }
+}
+
 short findLabel(short num) {
     short hi = labelsCached;
     short lo = 0;
@@ -226,6 +297,15 @@ void calcOperation(char op) {
     }
 }
 
+numeric calcConstant(char op, numeric left, numeric right, char operands) {
+    if (operands > 1) {
+        calcStack[--sp] = left;
+    }
+    calcStack[--sp] = right;
+    calcOperation(op);
+    return calcStack[sp++];
+}
+
 void calcFunction(nstring* name) {
     short i;
     numeric r;
@@ -288,6 +368,9 @@ numeric calcExpression(void) {
             case TT_VARIABLE:
                 calcStack[--sp] = getVar(shortVarName(&(curTok->body.str)));
                 break;
+            case TT_VARSLOT:
+                calcStack[--sp] = getSlot(curTok->body.symbol);
+                break;
             case TT_SYMBOL:
                 calcOperation(curTok->body.symbol);
                 break;
@@ -303,6 +386,13 @@ numeric calcExpression(void) {
 }
 
 void execLet(void) {
+    unsigned char slot;
+    if (curTok->type == TT_VARSLOT) {
+        slot = curTok->body.symbol;
+        advance();
+        setSlot(slot, calcExpression());
+        return;
+    }
     short varname = shortVarName(&(curTok->body.str));
     advance();
     setVar(varname, calcExpression());
@@ -567,6 +657,7 @@ void initParsedRun(void) {
     progLine = findLine(nextLineNum);
     labelsCached = 0;
     labelCache = (labelCacheElem*)(void*)(prgStore + prgSize);
+    resolveVarSlots();
     mainState |= STATE_RUN;
 }
 
@@ -14,6 +14,9 @@ void execBreak(void);
 void executeNonParsed(numeric count);
 void initParsedRun(void);
 void executeParsedRun(void);
+void resetVarSlots(void);
+void bindVarSlots(token* t);
+numeric calcConstant(char op, numeric left, numeric right, char operands);
 void setLastInput(short c);
 void dispatchInput(void);
 void dispatchDelay(void);
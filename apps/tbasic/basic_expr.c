@@ -2,6 +2,7 @@
 #include "basic_tokens.h"
 #include "basic_tokenint.h"
 #include "basic_expr.h"
+#include "basic_exectoks.h"
 
 char parseExprUnary() {
     char c = *getCurTokPos();
@@ -177,14 +178,52 @@ void shuntingYard(token* next) {
     }
 }
 
+void removeTokens(token* from, token* to) {
+    short len = (char*)(void*)to - (char*)(void*)from;
+    memmove(from, to, (char*)(void*)curTok - (char*)(void*)to + 1);
+    curTok = (token*)(void*)((char*)(void*)curTok - len);
+}
+
+char foldOnce(token* t) {
+    token* a = NULL;
+    token* b = NULL;
+    char op;
+    while (t->type != TT_ERROR) {
+        if (t->type == TT_SYMBOL && b != NULL && b->type == TT_NUMBER) {
+            op = t->body.symbol;
+            if (isUnary(op)) {
+                b->body.integer = calcConstant(op, 0, b->body.integer, 1);
+                removeTokens(t, nextToken(t));
+                return 1;
+            }
+            if (a != NULL && a->type == TT_NUMBER
+                    && !((op == '/' || op == '%') && b->body.integer == 0)) {
+                a->body.integer = calcConstant(op, a->body.integer, b->body.integer, 2);
+                removeTokens(b, nextToken(t));
+                return 1;
+            }
+        }
+        a = b;
+        b = t;
+        t = nextToken(t);
+    }
+    return 0;
+}
+
+void foldConstants(token* start) {
+    while (foldOnce(start));
+}
+
 void convertToRpn(token* next) {
     char buf[MAX_LINE_LEN * 2];
+    token* start = next;
     curTok->type = TT_ERROR;
     memcpy(buf, next, ((char*)(void*)curTok) - ((char*)(void*)next) + 1);
     curTok = next;
     next = (token*)(void*) buf;
     shuntingYard(next);
     curTok->type = TT_ERROR;
+    foldConstants(start);
     prevTok = NULL;
 }
 
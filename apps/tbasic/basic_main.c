@@ -7,6 +7,7 @@
 #include "basic_textual.h"
 
 static short listLine, listPage;
+static numeric benchStart = -1;
 token* toksBody;
 char mainState;
 
@@ -128,6 +129,23 @@ void executeRun() {
     }
 }
 
+void executeBench() {
+    executeRun();
+    if ((mainState & STATE_RUN) != 0) {
+        benchStart = sysMillis(1);
+    }
+}
+
+void reportBench() {
+    if (benchStart < 0 || (mainState & STATE_RUN) != 0) {
+        return;
+    }
+    outputConstStr(ID_COMMON_STRINGS, 14, NULL); // Time ms:
+    outputInt(sysMillis(1) - benchStart);
+    outputCr();
+    benchStart = -1;
+}
+
 void manualSave(void) {
     editorSave();
     outputConstStr(ID_COMMON_STRINGS, 6, NULL); // Saved
@@ -177,6 +195,8 @@ void metaOrError() {
         executeSteps();
     } else if (h == 0x1AC) { // RUN
         executeRun();
+    } else if (h == 0x7FE) { // BENCH
+        executeBench();
     } else if (h == 0x375) { // SAVE
         manualSave();
     } else if (h == 0x39A) { // LOAD
@@ -253,6 +273,7 @@ void dispatch() {
     }
     if ((mainState & (STATE_RUN | STATE_SLOWED)) == STATE_RUN) {
         executeParsedRun();
+        reportBench();
         return;
     }
     switch (mainState & STATE_SLOWED) {
@@ -265,6 +286,7 @@ void dispatch() {
             return;
         case STATE_BREAK:
             dispatchBreak();
+            reportBench();
             lastInput = 0;
             return;
     }
@@ -3,7 +3,7 @@
 
 #define CONST_COMMON_STRINGS "TBASIC 1.7\ncode: \nvars: \nnext: \n"\
     "BREAK\nEnd of code\nSaved\nLoaded\nbytes\nLoad failed\n"\
-    "Autorun in 1 sec\nCanceled!\nLow VARS mem\nLow PROG mem\n"
+    "Autorun in 1 sec\nCanceled!\nLow VARS mem\nLow PROG mem\nTime ms: \n"
 
 #define CONST_PARSING_ERRORS "\nCmd or Var expectedd\nSymbol '=' expected\nName expected\n"\
     "Symbol ';' expected\nExtra chars at end\nUnexpected error\nNumber out of range\n"\
@@ -60,6 +60,7 @@ short tokenSize(token* t) {
         case TT_FUNC_END:
         case TT_SYMBOL:
         case TT_ARRAY:
+        case TT_VARSLOT:
         case TT_COMMAND:
             return 1 + sizeof(t->body.symbol);
         case TT_NONE:
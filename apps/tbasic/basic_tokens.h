@@ -12,6 +12,7 @@
 #define TT_FUNC_END 0x31
 #define TT_SEPARATOR 0x32
 #define TT_ARRAY 0x33
+#define TT_VARSLOT 0x34
 #define TT_LITERAL 0x40
 #define TT_COMMENT 0x41
 
@@ -3,6 +3,10 @@
 
 #define MAX_LINE_LEN 80
 
+// variable slots bound when the program is loaded parsed
+#define VAR_SLOTS 64
+#define NO_VAR_SLOT 0xFF
+
 #define STATE_INTERACTIVE 0x00
 #define STATE_DELAY 0x01
 #define STATE_INPUT 0x02
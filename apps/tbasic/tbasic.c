@@ -18,6 +18,8 @@
 //
 // History:         April 2020   - Ported the Miskatino version to work on the ZPU and K64F, updatesdto
 //                                 function with the K64F processor and zOS.
+//                  Oct 2026     - v1.1 Variables bound to fixed slots on RUN, constant expressions
+//                                 folded at parse time and BENCH command to time a run.
 //
 // Notes:           See Makefile to enable/disable conditional components
 //
@@ -90,8 +92,8 @@
 #include "tools.c"
 
 // Version info.
-#define VERSION      "v1.0"
-#define VERSION_DATE "10/04/2020"
+#define VERSION      "v1.1"
+#define VERSION_DATE "16/10/2026"
 #define APP_NAME     "TBASIC"
 
 #define VARS_SPACE_SIZE 512
@@ -14,6 +14,8 @@
 //                             driver source.
 //                  Feb 2021 - Getopt too buggy with long arguments so replaced with optparse.
 //                  Mar 2021 - Change sector size to K64F default and fixed some bugs.
+//                  Oct 2026 - Each programmed sector is verified by CRC32 against the file data and
+//                             reprogrammed on mismatch, the CRC of the whole image is compared at the end.
 //
 // Notes:           See Makefile to enable/disable conditional components
 //
@@ -81,14 +83,15 @@
 #include <tranzputer_m.h>
 #include "tzflupd.h"
 #include "fsl_flash.h"
+#include "crc32.h"
 #endif
 
 // Utility functions.
 //#include <tools.c>
 
 // Version info.
-#define VERSION              "v1.2"
-#define VERSION_DATE         "11/03/2021"
+#define VERSION              "v1.3"
+#define VERSION_DATE         "16/10/2026"
 #define APP_NAME             "TZFLUPD"
 
 // Global scope variables.
@@ -274,6 +277,9 @@ uint32_t app(uint32_t param1, uint32_t param2)
     unsigned int    readSize          = 0;
     uint32_t        sizeToRead;
     uint32_t        bytesProcessed;
+    uint32_t        fileCrc;
+    uint32_t        flashCrc;
+    int             attempt;
     flash_config_t  flashDriver;                                            // Flash driver Structure
     status_t        flashResult;                                            // Return code from each flash driver function
     FRESULT         fResult;                                                // Fat FS result.
@@ -412,6 +418,9 @@ uint32_t app(uint32_t param1, uint32_t param2)
         uint32_t startTime = *G->millis;
         while((*G->millis - startTime) < 1000) {};
 
+        // Build the CRC tables whilst the kernel is still intact, the running CRC covers the file data as read.
+        fileCrc = crc32_init();
+
         // Enter a loop, interrupts disabled, reading sector at a time from the SD card and flashing it into the Flash RAM.
         //
         __disable_irq();
@@ -420,6 +429,7 @@ uint32_t app(uint32_t param1, uint32_t param2)
             sizeToRead = (fileSize-bytesProcessed) > FSL_FEATURE_FLASH_PFLASH_BLOCK_SECTOR_SIZE ? FSL_FEATURE_FLASH_PFLASH_BLOCK_SECTOR_SIZE : fileSize - bytesProcessed;
             fResult = f_read(&fileHandle, buffer, sizeToRead, &readSize);
             if (fResult || readSize == 0) break;   /* error or eof */                
+            fileCrc = crc32_update(fileCrc, buffer, readSize);
 
             // If a sector isnt full, ie. last sector, pad with 0xFF.
             //
@@ -429,22 +439,43 @@ uint32_t app(uint32_t param1, uint32_t param2)
             }
 
             // Flash the sector into the correct location governed by the bytes already processed. We flash a K64F programming sector at a time with unused space set to 0xFF.
+            // The programmed sector is read back through the flash memory map and its CRC compared with the buffer, on mismatch it is erased and programmed again.
             //
-            flashResult = FLASH_Erase(&flashDriver, bytesProcessed, FSL_FEATURE_FLASH_PFLASH_BLOCK_SECTOR_SIZE, kFLASH_ApiEraseKey);
-            // If no previous errors, program the next sector.
-            if(flashResult == kStatus_FLASH_Success)
+            for(attempt=0; attempt < FLASH_PROGRAM_ATTEMPTS; attempt++)
             {
-                flashResult = FLASH_Program(&flashDriver, bytesProcessed, (uint32_t*)buffer, FSL_FEATURE_FLASH_PFLASH_BLOCK_SECTOR_SIZE);
+                flashResult = FLASH_Erase(&flashDriver, bytesProcessed, FSL_FEATURE_FLASH_PFLASH_BLOCK_SECTOR_SIZE, kFLASH_ApiEraseKey);
+                // If no previous errors, program the next sector.
+                if(flashResult == kStatus_FLASH_Success)
+                {
+                    flashResult = FLASH_Program(&flashDriver, bytesProcessed, (uint32_t*)buffer, FSL_FEATURE_FLASH_PFLASH_BLOCK_SECTOR_SIZE);
+                }
+                if(flashResult == kStatus_FLASH_Success)
+                {
+                    if(crc32_update(CRC32_INITIAL, buffer, FSL_FEATURE_FLASH_PFLASH_BLOCK_SECTOR_SIZE) == crc32_update(CRC32_INITIAL, (uint8_t *)bytesProcessed, FSL_FEATURE_FLASH_PFLASH_BLOCK_SECTOR_SIZE))
+                        break;
+                    flashResult = kStatus_FLASH_CommandFailure;
+                }
             }
 
             // Update the address/bytes processed count.
             bytesProcessed += FSL_FEATURE_FLASH_PFLASH_BLOCK_SECTOR_SIZE;
         } while(bytesProcessed < fileSize && flashResult == kStatus_FLASH_Success);
+
+        // Final check, the CRC of the image in flash, mapped from address 0, must match that of the file.
+        fileCrc  = ~fileCrc;
+        flashCrc = ~crc32_update(CRC32_INITIAL, (uint8_t *)0, fileSize);
+        if(flashResult == kStatus_FLASH_Success && flashCrc != fileCrc)
+        {
+            flashResult = kStatus_FLASH_CommandFailure;
+        }
         __enable_irq();
 
         // Verbose output.
         if(verbose_flag)
+        {
             printf("Bytes processed:%ld, exit status:%s\n", bytesProcessed, flashResult == kStatus_FLASH_Success ? "Success" : "Fail");
+            printf("CRC32 file:%08lX, flash:%08lX\n", fileCrc, flashCrc);
+        }
 
         // Success in programming, clear rest of flash RAM.
         if(flashResult == kStatus_FLASH_Success)
@@ -49,6 +49,7 @@
 
 // Application execution constants.
 //
+#define FLASH_PROGRAM_ATTEMPTS          2                                    // Times a sector is programmed before a CRC verify failure is fatal.
 
 // Macros to enable/disable the K64F interrupts.
 //
@@ -10,6 +10,8 @@
 // Copyright:       (c) 2019-2020 Philip Smart <philip.smart@net2net.org>
 //
 // History:         May 2021    - Initial framework creation.
+//                  Oct 2026    - Added a block transfer benchmark to measure the Z80 bus throughput
+//                                per target with the block transfer engine enabled and disabled.
 //
 // Notes:           See Makefile to enable/disable conditional components
 //
@@ -80,8 +82,8 @@
 #include "tools.c"
 
 // Version info.
-#define VERSION      "v1.0"
-#define VERSION_DATE "15/05/2021"
+#define VERSION      "v1.1"
+#define VERSION_DATE "16/10/2026"
 #define APP_NAME     "TZMTEST"
 
 // Simple help screen to remmber how this utility works!!
@@ -92,6 +94,7 @@ void usage(void)
     printf("\nCommands:-\n");
     printf("  -h | --help              This help text.\n");
     printf("  -a | --start             Start address.\n");
+    printf("  -b | --bench             Benchmark block transfers over the given range, reporting KB/s with the block transfer engine on and off.\n");
     printf("\nOptions:-\n");
     printf("  -e | --end               End address (alternatively use --size).\n");
     printf("  -s | --size              Size of memory block to test (alternatively use --end).\n");
@@ -104,10 +107,75 @@ void usage(void)
 
     printf("\nExamples:\n");
     printf("  tzmtest -a 0x000000 -s 0x20000   # Test 128K tranZPUter memory from 0x000000 to 0x020000.\n");
+    printf("  tzmtest -b -f -a 0x000000 -s 0x10000 # Benchmark 64K transfers to/from the FPGA memory.\n");
 
 }
 
 
+// Method to calculate and print a transfer rate in KB/s.
+//
+static void printKBPerSec(const char *mode, const char *action, uint32_t bytes, uint32_t mSec)
+{
+    if(mSec == 0)
+        mSec = 1;
+    printf("  %-7s %-5s %8lu bytes in %6lu ms, %6lu KB/s\n", mode, action, bytes, mSec, (bytes * 1000 / mSec) / 1024);
+}
+
+// Method to benchmark the Z80 bus block transfer engine against the byte at a time bus cycles. The given memory range is written
+// and read back via copyToZ80/copyFromZ80 in BENCH_BLOCK_SIZE chunks, first with the engine enabled, then disabled, and the data
+// is verified so any timing issue with the engine is reported.
+//
+static void benchZ80Transfer(uint32_t startAddr, uint32_t endAddr, enum TARGETS target)
+{
+    // Locals.
+    uint8_t    wrBuf[BENCH_BLOCK_SIZE];
+    uint8_t    rdBuf[BENCH_BLOCK_SIZE];
+    uint32_t   perfTime;
+    uint32_t   writeTime;
+    uint32_t   readTime;
+    uint32_t   blockSize;
+    uint32_t   errors;
+    uint8_t    lastMode;
+
+    // Fill the source buffer with a pattern which changes all data lines.
+    for(uint32_t idx=0; idx < BENCH_BLOCK_SIZE; idx++)
+    {
+        wrBuf[idx] = (uint8_t)((idx * 7) ^ (idx >> 8));
+    }
+
+    printf("Benchmark %s memory 0x%08lX to 0x%08lX:\n", target == MAINBOARD ? "mainboard" : target == FPGA ? "FPGA" : "tranZPUter", startAddr, endAddr);
+    lastMode = setZ80BurstMode(1);
+    for(int8_t mode=1; mode >= 0; mode--)
+    {
+        setZ80BurstMode(mode);
+        errors = 0;
+
+        perfTime = *G->millis;
+        for(uint32_t addr=startAddr; addr < endAddr; addr += blockSize)
+        {
+            blockSize = (endAddr - addr) > BENCH_BLOCK_SIZE ? BENCH_BLOCK_SIZE : (endAddr - addr);
+            copyToZ80(addr, wrBuf, blockSize, target);
+        }
+        writeTime = *G->millis - perfTime;
+
+        perfTime = *G->millis;
+        for(uint32_t addr=startAddr; addr < endAddr; addr += blockSize)
+        {
+            blockSize = (endAddr - addr) > BENCH_BLOCK_SIZE ? BENCH_BLOCK_SIZE : (endAddr - addr);
+            copyFromZ80(rdBuf, addr, blockSize, target);
+            if(memcmp(wrBuf, rdBuf, blockSize) != 0)
+                errors++;
+        }
+        readTime = *G->millis - perfTime;
+
+        printKBPerSec(mode == 1 ? "block" : "byte", "write", endAddr - startAddr, writeTime);
+        printKBPerSec(mode == 1 ? "block" : "byte", "read",  endAddr - startAddr, readTime);
+        if(errors)
+            printf("  %s mode: %lu block(s) failed verification.\n", mode == 1 ? "block" : "byte", errors);
+    }
+    setZ80BurstMode(lastMode);
+}
+
 // Main entry and start point of a zOS/ZPUTA Application. Only 2 parameters are catered for and a 32bit return code, additional parameters can be added by changing the appcrt0.s
 // startup code to add them to the stack prior to app() call.
 //
@@ -132,6 +200,7 @@ uint32_t app(uint32_t param1, uint32_t param2)
     int        mainboard_flag    = 0;
   //int        mempage_flag      = 0;
     int        verbose_flag      = 0;
+    int        bench_flag        = 0;
     int        opt; 
     long       val               = 0;
     char      *argv[20];
@@ -160,6 +229,7 @@ uint32_t app(uint32_t param1, uint32_t param2)
     {
         {"help",          'h',  OPTPARSE_NONE},
         {"start",         'a',  OPTPARSE_REQUIRED},
+        {"bench",         'b',  OPTPARSE_NONE},
         {"end",           'e',  OPTPARSE_REQUIRED},
         {"size",          's',  OPTPARSE_REQUIRED},
         {"fpga",          'f',  OPTPARSE_NONE},
@@ -190,6 +260,10 @@ uint32_t app(uint32_t param1, uint32_t param2)
                 mainboard_flag = 1;
                 break;
 
+            case 'b':
+                bench_flag = 1;
+                break;
+
             case 'a':
                 if(xatoi(&options.optarg, &val) == 0)
                 {
@@ -298,6 +372,16 @@ uint32_t app(uint32_t param1, uint32_t param2)
         return(15);
     }
 
+    // Benchmark rather than test?
+    if(bench_flag == 1)
+    {
+        for(uint32_t idx=0; idx < iter; idx++)
+        {
+            benchZ80Transfer(startAddr, endAddr, mainboard_flag == 1 ? MAINBOARD : fpga_flag == 1 ? FPGA : TRANZPUTER);
+        }
+        return(0);
+    }
+
     // Setup the test/width indicator flag.
     testsToDo = (width << 16) | test;
 
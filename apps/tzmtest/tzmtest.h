@@ -38,6 +38,7 @@
 
 // Application execution constants.
 //
+#define BENCH_BLOCK_SIZE            1024                               // Size of the buffer used per copyToZ80/copyFromZ80 call in the benchmark.
 
 // Components to be embedded in the program.
 //
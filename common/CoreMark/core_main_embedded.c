@@ -68,6 +68,7 @@ ee_s32 get_seed_32(int i);
 ee_u8 static_memblk[TOTAL_DATA_SIZE];
 #endif
 char *mem_name[3] = {"Static","Heap","Stack"};
+core_summary coremark_summary;
 /* Function: main
 	Main entry routine for the benchmark.
 	This function is responsible for the following steps:
@@ -294,6 +295,13 @@ MAIN_RETURN_TYPE CoreMarkTest(void) {
 		}
 	}
 	total_errors+=check_data_types();
+	coremark_summary.iterations=results[0].iterations;
+	coremark_summary.contexts=default_num_contexts;
+	coremark_summary.size=results[0].size;
+	coremark_summary.ticks=total_time;
+	coremark_summary.seedcrc=seedcrc;
+	coremark_summary.crc=results[0].crc;
+	coremark_summary.errors=total_errors;
 	/* and report results */
 	ee_printf("CoreMark Size    : %lu\n", (long unsigned) results[0].size);
 	ee_printf("Total ticks      : %lu\n", (long unsigned) total_time);
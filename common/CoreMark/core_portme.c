@@ -24,6 +24,11 @@ Original Author: Shay Gal-on
   #include <string.h>
   #include "k64f_soc.h"
   extern uint32_t milliseconds(void);
+#elif defined __LINUX__
+  #include <stdint.h>
+  #include <stdio.h>
+  #include <string.h>
+  #include <time.h>
 #else
   #include <stdint.h>
   #include <stdio.h>
@@ -64,8 +69,12 @@ CORETIMETYPE barebones_clock() {
   #elif defined(__K64F__) && (defined(__ZPUTA__) || defined(__ZOS__))
     uint32_t millis(void); 
     CORETIMETYPE clockInuS = millis();
+  #elif defined __LINUX__
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    CORETIMETYPE clockInuS = (CORETIMETYPE)((ts.tv_sec * 1000) + (ts.tv_nsec / 1000000));
   #else
-    #error "Target CPU not defined, use __ZPU__ or __K64F__"
+    #error "Target CPU not defined, use __ZPU__, __K64F__ or __LINUX__"
   #endif
 
 #ifdef DEBUG
@@ -87,6 +96,9 @@ CORETIMETYPE barebones_clock() {
 #define MYTIMEDIFF(fin,ini) ((fin)-(ini))
 #define TIMER_RES_DIVIDER 1
 #define SAMPLE_TIME_IMPLEMENTATION 1
+#if defined __LINUX__
+#undef CLOCKS_PER_SEC
+#endif
 #define CLOCKS_PER_SEC 1000
 #define EE_TICKS_PER_SEC (CLOCKS_PER_SEC / TIMER_RES_DIVIDER)
 
@@ -137,6 +149,22 @@ secs_ret time_in_secs(CORE_TICKS ticks) {
 
 ee_u32 default_num_contexts=1;
 
+#if (MULTITHREAD>1) && USE_PTHREAD
+/* Function : core_start_parallel
+	Start a context running the benchmark on its own thread.
+*/
+ee_u8 core_start_parallel(core_results *res) {
+	return (ee_u8)pthread_create(&(res->port.thread),NULL,iterate,(void *)res);
+}
+/* Function : core_stop_parallel
+	Wait for a context started by <core_start_parallel> to complete.
+*/
+ee_u8 core_stop_parallel(core_results *res) {
+	void *retval;
+	return (ee_u8)pthread_join(res->port.thread,&retval);
+}
+#endif
+
 /* Function : portable_init
 	Target specific initialization code 
 	Test for some common mistakes.
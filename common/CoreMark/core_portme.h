@@ -90,7 +90,12 @@ typedef signed int ee_s32;
 typedef double ee_f32;
 typedef unsigned char ee_u8;
 typedef unsigned int ee_u32;
+#if defined __LINUX__
+#include <stdint.h>
+typedef uintptr_t ee_ptr_int;
+#else
 typedef ee_u32 ee_ptr_int;
+#endif
 typedef size_t ee_size_t;
 
 // ZPU compiler already defines NULL
@@ -146,6 +151,13 @@ typedef ee_u32 CORE_TICKS;
 	It is valid to have a different implementation of <core_start_parallel> and <core_end_parallel> in <core_portme.c>,
 	to fit a particular architecture. 
 */
+// The native Linux build runs up to MULTITHREAD contexts, one thread each, the number used is set in <default_num_contexts>.
+#if defined(__LINUX__) && !defined(MULTITHREAD)
+#define MULTITHREAD 8
+#define USE_PTHREAD 1
+#define USE_FORK 0
+#define USE_SOCKET 0
+#endif
 #ifndef MULTITHREAD
 #define MULTITHREAD 1
 #define USE_PTHREAD 0
@@ -178,13 +190,21 @@ typedef ee_u32 CORE_TICKS;
 #define MAIN_HAS_NORETURN 0
 #endif
 
+#if (MULTITHREAD>1) && USE_PTHREAD
+#include <pthread.h>
+#define PARALLEL_METHOD "PThreads"
+#endif
+
 /* Variable : default_num_contexts
-	Not used for this simple port, must cintain the value 1.
+	Number of contexts to run in parallel, 1 on the ZPU and K64F, up to MULTITHREAD on the native Linux build.
 */
 extern ee_u32 default_num_contexts;
 
 typedef struct CORE_PORTABLE_S {
 	ee_u8	portable_id;
+#if (MULTITHREAD>1) && USE_PTHREAD
+	pthread_t thread;
+#endif
 } core_portable;
 
 /* target specific init/fini */
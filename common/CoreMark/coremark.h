@@ -47,6 +47,11 @@ Original Author: Shay Gal-on
 #if defined HAS_PRINTF && HAS_PRINTF == 1
 #define ee_printf printf
 #endif
+/* The report is suppressed when built into a harness which emits its own results from <core_summary>. */
+#if defined COREMARK_QUIET
+#undef ee_printf
+#define ee_printf(...) ((void)0)
+#endif
 
 /* Actual benchmark execution in iterate */
 void *iterate(void *pres);
@@ -176,6 +181,18 @@ ee_u16 core_bench_state(ee_u32 blksize, ee_u8 *memblock,
 ee_u32 core_init_matrix(ee_u32 blksize, void *memblk, ee_s32 seed, mat_params *p);
 ee_u16 core_bench_matrix(mat_params *p, ee_s16 seed, ee_u16 crc);
 
+/* Summary of the last run, filled in by <CoreMarkTest> for a harness to report */
+typedef struct CORE_SUMMARY_S {
+	ee_u32	iterations;	/* Iterations run by each context */
+	ee_u32	contexts;	/* Contexts run in parallel */
+	ee_u32	size;		/* Data size per algorithm */
+	CORE_TICKS ticks;	/* Ticks taken by all contexts */
+	ee_u16	seedcrc;	/* CRC of the seeds, identifies the run type */
+	ee_u16	crc;		/* Final CRC of the first context */
+	ee_s16	errors;		/* CRC mismatches, -1 if the seeds have no known result */
+} core_summary;
+extern core_summary coremark_summary;
+
 /* Embedded entry point, when using CoreMark as part of a test suite and not a standalone program */
 MAIN_RETURN_TYPE CoreMarkTest(void);
 
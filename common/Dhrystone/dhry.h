@@ -360,7 +360,7 @@
 #ifdef TIMES
   #include <sys/types.h>
 
-  #if defined __K64F__
+  #if defined __K64F__ || defined __LINUX__
     #include <sys/times.h> /* for "times" */
   #endif
 #endif
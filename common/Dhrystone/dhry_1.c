@@ -21,6 +21,10 @@
   #include <stdint.h>
   #include "k64f_soc.h"
   extern uint32_t milliseconds(void);
+#elif defined __LINUX__
+  #include <stdio.h>
+  #include <stdint.h>
+  #include <time.h>
 #else
   #include <stdint.h>
   #include <stdio.h>
@@ -31,6 +35,23 @@
 #include <stdarg.h>
 #include "dhry.h"
 
+/* The report is suppressed when built into a harness which emits its own results from User_Time. */
+#if defined DHRY_QUIET
+  #undef printf
+  #define printf(...) ((void)0)
+#endif
+
+#if defined __LINUX__
+/* Monotonic millisecond clock for the native build. */
+static long _linuxMilliseconds(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return((long)((ts.tv_sec * 1000) + (ts.tv_nsec / 1000000)));
+}
+#endif
+
 /* Global Variables: */
 
 Rec_Pointer     Ptr_Glob,
@@ -173,8 +194,10 @@ int main_dhry ()
  #elif defined(__K64F__) && (defined(__ZPUTA__) || defined(__ZOS__))
   uint32_t millis(void);
   Begin_Time = millis();
+ #elif defined __LINUX__
+  Begin_Time = _linuxMilliseconds();
  #else
-  #error "Target CPU not defined, use __ZPU__ or __K64F__"
+  #error "Target CPU not defined, use __ZPU__, __K64F__ or __LINUX__"
  #endif
   printf("Begin time        : %08ld\n", Begin_Time);
 #endif
@@ -243,8 +266,10 @@ int main_dhry ()
   End_Time = milliseconds();
  #elif defined(__K64F__) && (defined(__ZPUTA__) || defined(__ZOS__))
   End_Time = millis();
+ #elif defined __LINUX__
+  End_Time = _linuxMilliseconds();
  #else
-  #error "Target CPU not defined, use __ZPU__ or __K64F__"
+  #error "Target CPU not defined, use __ZPU__, __K64F__ or __LINUX__"
  #endif
   printf("End time          : %08ld\n", End_Time);
 #endif
@@ -329,9 +354,12 @@ int main_dhry ()
     Vax_Mips = Dhrystones_Per_Second / 1757.0;
 #endif
 #else
+    // A run too short to register, or a long native run, must not divide by zero or overflow an int.
+    if (User_Time == 0)
+      User_Time = 1;
     Microseconds = (1000*User_Time) / Number_Of_Runs;
-    Dhrystones_Per_Second =  (Number_Of_Runs*1000) / User_Time;
-    Vax_Mips = (Number_Of_Runs*569) / User_Time;
+    Dhrystones_Per_Second =  ((long)Number_Of_Runs*1000) / User_Time;
+    Vax_Mips = ((long)Number_Of_Runs*569) / User_Time;
 #endif 
     printf ("Microseconds for one run through Dhrystone: ");
     printf ("%ld \r\n", (int32_t)Microseconds);
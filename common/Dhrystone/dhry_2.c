@@ -20,6 +20,9 @@
   #include <stdio.h>
   #include <stdint.h>
   #include "k64f_soc.h"
+#elif defined __LINUX__
+  #include <stdio.h>
+  #include <stdint.h>
 #else
   #include <stdint.h>
   #include <stdio.h>
@@ -1,229 +1,319 @@
-/*-----------------------------------------------------------------------*/
-/* Low level disk I/O module skeleton for FatFs     (C)ChaN, 2016        */
-/*-----------------------------------------------------------------------*/
-/* If a working storage control module is available, it should be        */
-/* attached to the FatFs via a glue function rather than modifying it.   */
-/* This is an example of glue functions to attach various exsisting      */
-/* storage control modules to the FatFs module with a defined API.       */
-/*-----------------------------------------------------------------------*/
-
-#include "ff.h"			/* Obtains integer types */
-#include "diskio.h"		/* Declarations of disk functions */
-
-/* Definitions of physical drive number for each drive */
-#define DEV_RAM		0	/* Example: Map Ramdisk to physical drive 0 */
-#define DEV_MMC		1	/* Example: Map MMC/SD card to physical drive 1 */
-#define DEV_USB		2	/* Example: Map USB MSD to physical drive 2 */
-
-
-/*-----------------------------------------------------------------------*/
-/* Get Drive Status                                                      */
-/*-----------------------------------------------------------------------*/
-
-DSTATUS disk_status (
-	BYTE pdrv		/* Physical drive nmuber to identify the drive */
-)
-{
-	DSTATUS stat;
-	int result;
-
-	switch (pdrv) {
-	case DEV_RAM :
-		result = RAM_disk_status();
-
-		// translate the reslut code here
-
-		return stat;
-
-	case DEV_MMC :
-		result = MMC_disk_status();
-
-		// translate the reslut code here
-
-		return stat;
-
-	case DEV_USB :
-		result = USB_disk_status();
-
-		// translate the reslut code here
-
-		return stat;
-	}
-	return STA_NOINIT;
-}
-
-
-
-/*-----------------------------------------------------------------------*/
-/* Inidialize a Drive                                                    */
-/*-----------------------------------------------------------------------*/
-
-DSTATUS disk_initialize (
-	BYTE pdrv				/* Physical drive nmuber to identify the drive */
-)
-{
-	DSTATUS stat;
-	int result;
-
-	switch (pdrv) {
-	case DEV_RAM :
-		result = RAM_disk_initialize();
-
-		// translate the reslut code here
-
-		return stat;
-
-	case DEV_MMC :
-		result = MMC_disk_initialize();
-
-		// translate the reslut code here
-
-		return stat;
-
-	case DEV_USB :
-		result = USB_disk_initialize();
-
-		// translate the reslut code here
-
-		return stat;
-	}
-	return STA_NOINIT;
-}
-
-
-
-/*-----------------------------------------------------------------------*/
-/* Read Sector(s)                                                        */
-/*-----------------------------------------------------------------------*/
-
-DRESULT disk_read (
-	BYTE pdrv,		/* Physical drive nmuber to identify the drive */
-	BYTE *buff,		/* Data buffer to store read data */
-	DWORD sector,	/* Start sector in LBA */
-	UINT count		/* Number of sectors to read */
-)
-{
-	DRESULT res;
-	int result;
-
-	switch (pdrv) {
-	case DEV_RAM :
-		// translate the arguments here
-
-		result = RAM_disk_read(buff, sector, count);
-
-		// translate the reslut code here
-
-		return res;
-
-	case DEV_MMC :
-		// translate the arguments here
-
-		result = MMC_disk_read(buff, sector, count);
-
-		// translate the reslut code here
-
-		return res;
-
-	case DEV_USB :
-		// translate the arguments here
-
-		result = USB_disk_read(buff, sector, count);
-
-		// translate the reslut code here
-
-		return res;
-	}
-
-	return RES_PARERR;
-}
-
-
-
-/*-----------------------------------------------------------------------*/
-/* Write Sector(s)                                                       */
-/*-----------------------------------------------------------------------*/
-
-#if FF_FS_READONLY == 0
-
-DRESULT disk_write (
-	BYTE pdrv,			/* Physical drive nmuber to identify the drive */
-	const BYTE *buff,	/* Data to be written */
-	DWORD sector,		/* Start sector in LBA */
-	UINT count			/* Number of sectors to write */
-)
-{
-	DRESULT res;
-	int result;
-
-	switch (pdrv) {
-	case DEV_RAM :
-		// translate the arguments here
-
-		result = RAM_disk_write(buff, sector, count);
-
-		// translate the reslut code here
-
-		return res;
-
-	case DEV_MMC :
-		// translate the arguments here
-
-		result = MMC_disk_write(buff, sector, count);
-
-		// translate the reslut code here
-
-		return res;
-
-	case DEV_USB :
-		// translate the arguments here
-
-		result = USB_disk_write(buff, sector, count);
-
-		// translate the reslut code here
-
-		return res;
-	}
-
-	return RES_PARERR;
-}
-
-#endif
-
-
-/*-----------------------------------------------------------------------*/
-/* Miscellaneous Functions                                               */
-/*-----------------------------------------------------------------------*/
-
-DRESULT disk_ioctl (
-	BYTE pdrv,		/* Physical drive nmuber (0..) */
-	BYTE cmd,		/* Control code */
-	void *buff		/* Buffer to send/receive control data */
-)
-{
-	DRESULT res;
-	int result;
-
-	switch (pdrv) {
-	case DEV_RAM :
-
-		// Process of the command for the RAM drive
-
-		return res;
-
-	case DEV_MMC :
-
-		// Process of the command for the MMC/SD card
-
-		return res;
-
-	case DEV_USB :
-
-		// Process of the command the USB drive
-
-		return res;
-	}
-
-	return RES_PARERR;
-}
-
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            diskio.c
+// Created:         October 2026
+// Author(s):       ChaN (framework), Philip Smart (sector cache)
+// Description:     Disk I/O layer sitting between FatFS and the physical disk drivers (sdmmc_k64f.cpp,
+//                  sdmmc_zpu.c). It implements an N-way set associative write-back sector cache so
+//                  that frequently accessed FAT and directory sectors, ie. during floppy emulation or
+//                  CP/M drive servicing, are not re-read from the SD card on every access.
+//                  Single sector requests are cached with least recently used eviction, multi-sector
+//                  requests (file data streamed by FatFS) bypass the cache so as not to pollute it,
+//                  being kept coherent with any cached sectors in their range.
+//                  The physical driver is accessed via the disk_phys_xxx entry points so this layer
+//                  can sit in front of any block device which provides them, ie. a file backed image.
+//
+// Credits:
+// Copyright:       (C) 2016    ChaN, all rights reserved - framework.
+// Copyright:       (C) 2019-26 Philip Smart <philip.smart@net2net.org>
+//
+// History:         October 2026 - Initial write of the sector cache layer.
+//
+// Notes:           Enabled and sized via FF_USE_SECTOR_CACHE, FF_SCACHE_SETS and FF_SCACHE_WAYS in
+//                  ffconf.h.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "ff.h"        /* Obtains integer types */
+#include "diskio.h"    /* Declarations of disk functions */
+
+#if FF_USE_SECTOR_CACHE == 1
+
+#include <string.h>
+
+#if (FF_SCACHE_SETS & (FF_SCACHE_SETS - 1)) != 0
+  #error "FF_SCACHE_SETS must be a power of 2"
+#endif
+
+/* Physical driver entry points, renamed in the driver via DISKIO_PHYSICAL_DRIVER. */
+DSTATUS disk_phys_initialize (BYTE pdrv, BYTE cardtype);
+DRESULT disk_phys_read (BYTE pdrv, BYTE* buff, DWORD sector, UINT count);
+DRESULT disk_phys_write (BYTE pdrv, const BYTE* buff, DWORD sector, UINT count);
+DRESULT disk_phys_ioctl (BYTE pdrv, BYTE cmd, void* buff);
+
+/* Cache line tag. */
+typedef struct {
+    DWORD   sector;                                   /* Sector held in the line */
+    DWORD   lastUsed;                                 /* LRU stamp, higher is more recent */
+    BYTE    pdrv;                                     /* Physical drive the sector belongs to */
+    BYTE    valid;                                    /* Line holds a sector */
+    BYTE    dirty;                                    /* Line differs from the disk and must be written back */
+} SCACHE_TAG;
+
+static SCACHE_TAG  cacheTag[FF_SCACHE_SETS][FF_SCACHE_WAYS];
+static BYTE        cacheData[FF_SCACHE_SETS][FF_SCACHE_WAYS][FF_MAX_SS] __attribute__((aligned(4)));
+static DWORD       cacheClock;
+static DCACHE_STAT cacheStat;
+
+#define SCACHE_SET(s)  ((s) & (FF_SCACHE_SETS - 1))
+
+
+/*-----------------------------------------------------------------------*/
+/* Locate a sector in the cache, returns the way or -1 if not present    */
+/*-----------------------------------------------------------------------*/
+static int cache_find (BYTE pdrv, DWORD sector)
+{
+    SCACHE_TAG *tag = cacheTag[SCACHE_SET(sector)];
+    int         way;
+
+    for (way = 0; way < FF_SCACHE_WAYS; way++) {
+        if (tag[way].valid && tag[way].sector == sector && tag[way].pdrv == pdrv) return way;
+    }
+    return -1;
+}
+
+/*-----------------------------------------------------------------------*/
+/* Write back a dirty line                                               */
+/*-----------------------------------------------------------------------*/
+static DRESULT cache_writeback (UINT set, int way)
+{
+    SCACHE_TAG *tag = &cacheTag[set][way];
+    DRESULT     res = RES_OK;
+
+    if (tag->valid && tag->dirty) {
+        res = disk_phys_write(tag->pdrv, cacheData[set][way], tag->sector, 1);
+        if (res == RES_OK) {
+            tag->dirty = 0;
+            cacheStat.writeBacks++;
+            cacheStat.dirty--;
+        }
+    }
+    return res;
+}
+
+/*-----------------------------------------------------------------------*/
+/* Allocate a line for a sector, evicting the least recently used        */
+/*-----------------------------------------------------------------------*/
+static int cache_alloc (BYTE pdrv, DWORD sector)
+{
+    UINT        set = SCACHE_SET(sector);
+    SCACHE_TAG *tag = cacheTag[set];
+    int         way;
+    int         victim = 0;
+
+    for (way = 0; way < FF_SCACHE_WAYS; way++) {
+        if (!tag[way].valid) { victim = way; break; }
+        if (tag[way].lastUsed < tag[victim].lastUsed) victim = way;
+    }
+
+    /* A dirty victim must reach the disk before the line is reused. */
+    if (cache_writeback(set, victim) != RES_OK) return -1;
+
+    tag[victim].pdrv   = pdrv;
+    tag[victim].sector = sector;
+    tag[victim].valid  = 0;
+    tag[victim].dirty  = 0;
+    return victim;
+}
+
+/*-----------------------------------------------------------------------*/
+/* Flush all dirty lines of a drive to the disk                          */
+/*-----------------------------------------------------------------------*/
+static DRESULT cache_flush (BYTE pdrv)
+{
+    UINT    set;
+    int     way;
+    DRESULT res = RES_OK;
+
+    for (set = 0; set < FF_SCACHE_SETS && cacheStat.dirty; set++) {
+        for (way = 0; way < FF_SCACHE_WAYS; way++) {
+            if (cacheTag[set][way].pdrv == pdrv && cache_writeback(set, way) != RES_OK) res = RES_ERROR;
+        }
+    }
+    return res;
+}
+
+/*-----------------------------------------------------------------------*/
+/* Invalidate all lines of a drive                                       */
+/*-----------------------------------------------------------------------*/
+static void cache_invalidate (BYTE pdrv)
+{
+    UINT set;
+    int  way;
+
+    for (set = 0; set < FF_SCACHE_SETS; set++) {
+        for (way = 0; way < FF_SCACHE_WAYS; way++) {
+            if (cacheTag[set][way].pdrv == pdrv) {
+                if (cacheTag[set][way].valid && cacheTag[set][way].dirty) cacheStat.dirty--;
+                cacheTag[set][way].valid = 0;
+                cacheTag[set][way].dirty = 0;
+            }
+        }
+    }
+}
+
+
+/*-----------------------------------------------------------------------*/
+/* Initialize a Drive                                                    */
+/*-----------------------------------------------------------------------*/
+DSTATUS disk_initialize ( BYTE pdrv,             /* Physical drive nmuber */
+                          BYTE cardtype )        /* 0 = SD, 1 = SDHC */
+{
+    /* A remount of the same card must not lose FAT or directory updates which were never synced, dirty lines are written out
+       first. The lines are then dropped as the media may change, unless they could not be written and the card is still present. */
+    if (cache_flush(pdrv) == RES_OK || (disk_status(pdrv) & STA_NODISK)) cache_invalidate(pdrv);
+    cacheStat.sets = FF_SCACHE_SETS;
+    cacheStat.ways = FF_SCACHE_WAYS;
+
+    return disk_phys_initialize(pdrv, cardtype);
+}
+
+/*-----------------------------------------------------------------------*/
+/* Read Sector(s)                                                        */
+/*-----------------------------------------------------------------------*/
+DRESULT disk_read ( BYTE pdrv,           /* Physical drive nmuber */
+                    BYTE *buff,          /* Pointer to the data buffer to store read data */
+                    DWORD sector,        /* Start sector number (LBA) */
+                    UINT count    )      /* Sector count */
+{
+    DRESULT res;
+    UINT    set;
+    int     way;
+    UINT    idx;
+
+    /* Multi-sector reads bypass the cache, sectors held dirty in the cache are newer than the disk copy. */
+    if (count != 1) {
+        res = disk_phys_read(pdrv, buff, sector, count);
+        if (res == RES_OK) {
+            cacheStat.bypassReads++;
+            for (idx = 0; idx < count && cacheStat.dirty; idx++) {
+                if ((way = cache_find(pdrv, sector + idx)) >= 0 && cacheTag[SCACHE_SET(sector + idx)][way].dirty) {
+                    memcpy(buff + (idx * FF_MAX_SS), cacheData[SCACHE_SET(sector + idx)][way], FF_MAX_SS);
+                }
+            }
+        }
+        return res;
+    }
+
+    set = SCACHE_SET(sector);
+    if ((way = cache_find(pdrv, sector)) >= 0) {
+        cacheStat.readHits++;
+    } else {
+        if ((way = cache_alloc(pdrv, sector)) < 0) return RES_ERROR;
+        res = disk_phys_read(pdrv, cacheData[set][way], sector, 1);
+        if (res != RES_OK) return res;
+        cacheTag[set][way].valid = 1;
+        cacheStat.readMisses++;
+    }
+    cacheTag[set][way].lastUsed = ++cacheClock;
+    memcpy(buff, cacheData[set][way], FF_MAX_SS);
+
+    return RES_OK;
+}
+
+/*-----------------------------------------------------------------------*/
+/* Write Sector(s)                                                       */
+/*-----------------------------------------------------------------------*/
+#if FF_FS_READONLY == 0
+DRESULT disk_write ( BYTE pdrv,           /* Physical drive nmuber */
+                     const BYTE *buff,    /* Pointer to the data to be written */
+                     DWORD sector,        /* Start sector number (LBA) */
+                     UINT count       )   /* Sector count */
+{
+    DRESULT res;
+    UINT    set;
+    int     way;
+    UINT    idx;
+
+    /* Multi-sector writes go straight to the disk, any cached copies are refreshed and become clean. */
+    if (count != 1) {
+        res = disk_phys_write(pdrv, buff, sector, count);
+        if (res == RES_OK) {
+            cacheStat.bypassWrites++;
+            for (idx = 0; idx < count; idx++) {
+                if ((way = cache_find(pdrv, sector + idx)) >= 0) {
+                    set = SCACHE_SET(sector + idx);
+                    memcpy(cacheData[set][way], buff + (idx * FF_MAX_SS), FF_MAX_SS);
+                    if (cacheTag[set][way].dirty) cacheStat.dirty--;
+                    cacheTag[set][way].dirty = 0;
+                }
+            }
+        }
+        return res;
+    }
+
+    /* Single sector, write back. The sector is held dirty until evicted or synced. */
+    set = SCACHE_SET(sector);
+    if ((way = cache_find(pdrv, sector)) >= 0) {
+        cacheStat.writeHits++;
+    } else {
+        if ((way = cache_alloc(pdrv, sector)) < 0) return RES_ERROR;
+        cacheTag[set][way].valid = 1;
+        cacheStat.writeMisses++;
+    }
+    memcpy(cacheData[set][way], buff, FF_MAX_SS);
+    if (!cacheTag[set][way].dirty) cacheStat.dirty++;
+    cacheTag[set][way].dirty    = 1;
+    cacheTag[set][way].lastUsed = ++cacheClock;
+
+    return RES_OK;
+}
+#endif
+
+/*-----------------------------------------------------------------------*/
+/* Miscellaneous Functions                                               */
+/*-----------------------------------------------------------------------*/
+DRESULT disk_ioctl ( BYTE pdrv,         /* Physical drive nmuber */
+                     BYTE cmd,          /* Control code */
+                     void *buff )       /* Buffer to send/receive control data */
+{
+    DRESULT res;
+
+    switch (cmd)
+    {
+        case CTRL_SYNC :              // Write back all dirty sectors before the driver completes any pending write.
+            res = cache_flush(pdrv);
+            if (res == RES_OK) res = disk_phys_ioctl(pdrv, cmd, buff);
+            break;
+
+        case CTRL_CACHE_STAT :        // Return the cache statistics.
+            cacheStat.sets = FF_SCACHE_SETS;
+            cacheStat.ways = FF_SCACHE_WAYS;
+            memcpy(buff, &cacheStat, sizeof(DCACHE_STAT));
+            res = RES_OK;
+            break;
+
+        case CTRL_CACHE_RESET :       // Flush and invalidate the drive, clear the statistics.
+            {
+                WORD dirty;
+
+                res = cache_flush(pdrv);
+                cache_invalidate(pdrv);
+                dirty = cacheStat.dirty;
+                memset(&cacheStat, 0, sizeof(DCACHE_STAT));
+                cacheStat.dirty = dirty;
+            }
+            break;
+
+        default:
+            res = disk_phys_ioctl(pdrv, cmd, buff);
+            break;
+    }
+
+    return res;
+}
+
+#endif // FF_USE_SECTOR_CACHE
@@ -23,6 +23,31 @@ typedef enum {
 } DRESULT;
 
 
+/* Sector cache statistics (CTRL_CACHE_STAT) */
+typedef struct {
+	DWORD	readHits;		/* Single sector reads satisfied from the cache */
+	DWORD	readMisses;		/* Single sector reads fetched from the disk */
+	DWORD	writeHits;		/* Single sector writes into an already cached sector */
+	DWORD	writeMisses;	/* Single sector writes allocating a new cache line */
+	DWORD	writeBacks;		/* Dirty sectors written to the disk on eviction or sync */
+	DWORD	bypassReads;	/* Multi-sector reads passed straight to the disk */
+	DWORD	bypassWrites;	/* Multi-sector writes passed straight to the disk */
+	WORD	sets;			/* Cache geometry, number of sets */
+	WORD	ways;			/* Cache geometry, sectors per set */
+	WORD	dirty;			/* Number of dirty sectors currently held */
+} DCACHE_STAT;
+
+
+/* When the sector cache is enabled the physical driver entry points are renamed so that */
+/* diskio.c presents the disk_xxx API to FatFs and calls the driver underneath.           */
+#if FF_USE_SECTOR_CACHE == 1 && defined(DISKIO_PHYSICAL_DRIVER)
+#define disk_initialize	disk_phys_initialize
+#define disk_read		disk_phys_read
+#define disk_write		disk_phys_write
+#define disk_ioctl		disk_phys_ioctl
+#endif
+
+
 /*---------------------------------------*/
 /* Prototypes for disk control functions */
 
@@ -68,6 +93,10 @@ DRESULT disk_ioctl (BYTE pdrv, BYTE cmd, void* buff);
 #define ISDIO_WRITE			56	/* Write data to SD iSDIO register */
 #define ISDIO_MRITE			57	/* Masked write data to SD iSDIO register */
 
+/* Sector cache specific command (Not used by FatFs) */
+#define CTRL_CACHE_STAT		70	/* Get the sector cache statistics (DCACHE_STAT) */
+#define CTRL_CACHE_RESET	71	/* Flush, invalidate and clear the statistics of the sector cache */
+
 /* ATA/CF specific command (Not used by FatFs) */
 #define ATA_GET_REV			60	/* Get F/W revision */
 #define ATA_GET_MODEL		61	/* Get model name */
@@ -42,8 +42,14 @@
 /* This option switches f_mkfs() function. (0:Disable or 1:Enable) */
 
 
+#if defined __K64F__
+#define FF_USE_FASTSEEK	1
+#else
 #define FF_USE_FASTSEEK	0
-/* This option switches fast seek function. (0:Disable or 1:Enable) */
+#endif
+/* This option switches fast seek function. (0:Disable or 1:Enable)
+/  Enabled on the K64F where mounted disk images are accessed randomly, each image
+/  is given a cluster link map table when it is mounted. */
 
 
 #define FF_USE_EXPAND	1
@@ -291,5 +297,28 @@
 /* #include <windows.h>	// O/S definitions  */
 
 
+/*---------------------------------------------------------------------------/
+/ Disk I/O Layer Configurations (diskio.c)
+/---------------------------------------------------------------------------*/
+
+#if defined __K64F__
+#define FF_USE_SECTOR_CACHE	1
+#else
+#define FF_USE_SECTOR_CACHE	0
+#endif
+#define FF_SCACHE_SETS		16
+#define FF_SCACHE_WAYS		4
+/* The option FF_USE_SECTOR_CACHE enables an N-way set associative write-back sector
+/  cache between FatFs and the physical disk driver (0:Disable or 1:Enable). Single
+/  sector requests, typically FAT and directory sectors, are cached and evicted on a
+/  least recently used basis, multi-sector requests bypass the cache. Dirty sectors
+/  are written back on eviction or CTRL_SYNC. When enabled, diskio.c must be added
+/  to the project and the physical driver defines DISKIO_PHYSICAL_DRIVER before
+/  including diskio.h so its entry points are renamed disk_phys_xxx.
+/
+/  FF_SCACHE_SETS defines the number of sets (power of 2) and FF_SCACHE_WAYS the
+/  number of sectors per set, memory used is SETS * WAYS * FF_MAX_SS bytes. */
+
+
 
 /*--- End of configuration options ---*/
@@ -13,6 +13,7 @@
 // Copyright:       (C) 2019-20 Philip Smart <philip.smart@net2net.org>
 //
 // History:         January 2019   - Initial script written for the STORM processor then changed to the ZPU.
+//                  October 2026   - Multi-sector requests use a single CMD18/CMD25 transaction.
 //
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 // This source file is free software: you can redistribute it and#or modify
@@ -41,6 +42,7 @@
 #endif
 
 #include "ff.h"        /* Obtains integer types for FatFs */
+#define DISKIO_PHYSICAL_DRIVER  /* Entry points are called via the sector cache in diskio.c when enabled */
 #include "diskio.h"    /* Common include file for FatFs and disk I/O layer */
 
 /*-------------------------------------------------------------------------*/
@@ -87,6 +89,7 @@
 #define CMD55        (55)        /* APP_CMD */
 #define CMD58        (58)        /* READ_OCR */
 #define SECTOR_SIZE  512         /* Default size of an SD Sector */
+#define MAX_MULTI_BLOCKS 0xFFFF  /* Maximum number of sectors in one CMD18/CMD25 transaction, limited by the SDHC block counter */
 
 static
 DSTATUS Stat[SD_DEVICE_CNT] = { STA_NOINIT };    /* Disk status */
@@ -160,6 +163,7 @@ DRESULT disk_read ( BYTE drv,            /* Physical drive nmuber (0) */
                     UINT count    )      /* Sector count (1..128) */
 {
     int   status;
+    UINT  blocks;
 
     // Check the drive, if it hasnt been initialised then exit.
     if (disk_status(drv) & STA_NOINIT) return RES_NOTRDY;
@@ -168,13 +172,15 @@ DRESULT disk_read ( BYTE drv,            /* Physical drive nmuber (0) */
     if(drv > 0) return RES_NOTRDY;
     if(count == 0) return RES_NOTRDY;
 
-    // call the NXP method to read in a sector, loop for required number of sectors.
+    // call the NXP method to read in the sectors, a multi-sector request is read in one CMD18 transaction.
     do {
-        status = SDHC_CardReadBlock(buff, sector);
+        blocks = count > MAX_MULTI_BLOCKS ? MAX_MULTI_BLOCKS : count;
+        status = SDHC_CardReadBlocks(buff, sector, blocks);
 
-        buff += 512;
-        sector++;
-    } while(status == 0 && --count);
+        buff   += blocks * SECTOR_SIZE;
+        sector += blocks;
+        count  -= blocks;
+    } while(status == 0 && count);
 
     // Any status other than OK results in a FAT ERROR.
     return status == 0 ? RES_OK : RES_ERROR;
@@ -189,7 +195,8 @@ DRESULT disk_write ( BYTE drv,            /* Physical drive nmuber (0) */
                      UINT count       )   /* Sector count (1..128) */
 {
     int   status;
-printf("Disk write:%02x,%08lx,%08lx,%d\n", drv, buff, sector, count);
+    UINT  blocks;
+
     // Check the drive, if it hasnt been initialised then exit.
     if (disk_status(drv) & STA_NOINIT) return RES_NOTRDY;
  
@@ -197,12 +204,15 @@ printf("Disk write:%02x,%08lx,%08lx,%d\n", drv, buff, sector, count);
     if(drv > 0) return RES_NOTRDY;
     if(count == 0) return RES_NOTRDY;
    
-    // call the NXP method to write a sector, loop for required number of sectors.
+    // call the NXP method to write the sectors, a multi-sector request is pre-erased and written in one CMD25 transaction.
     do {
-        status = SDHC_CardWriteBlock(buff, sector);
-        buff += 512;
-        sector++;
-    } while(status == 0 && --count);
+        blocks = count > MAX_MULTI_BLOCKS ? MAX_MULTI_BLOCKS : count;
+        status = SDHC_CardWriteBlocks(buff, sector, blocks);
+
+        buff   += blocks * SECTOR_SIZE;
+        sector += blocks;
+        count  -= blocks;
+    } while(status == 0 && count);
 
     // Any status other than OK results in a FAT ERROR.
     return status == 0 ? RES_OK : RES_ERROR;
@@ -29,6 +29,7 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "ff.h"        /* Obtains integer types for FatFs */
+#define DISKIO_PHYSICAL_DRIVER  /* Entry points are called via the sector cache in diskio.c when enabled */
 #include "diskio.h"    /* Common include file for FatFs and disk I/O layer */
 
 /*-------------------------------------------------------------------------*/
@@ -0,0 +1,418 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            appreg.c
+// Created:         Oct 2026
+// Version:         v1.0
+// Author(s):       Philip Smart
+// Description:     zOS application registry and image cache.
+//                  A command which is not built in was resolved by trying up to four path forms in turn,
+//                  each an SD directory search, and the application was then read from the SD card on
+//                  every run. This module reads the application bin directory once at boot into a hash
+//                  table of command name to filename, size and timestamp. A registered command is
+//                  resolved with a hash lookup and opened directly by its full path.
+//
+//                  With APP_CACHE the images of recently run applications are kept on the heap, up to
+//                  APP_CACHE_SLOTS images within APP_CACHE_SIZE bytes, the least recently used dropped
+//                  first. An image is cached on the second run of an application so a one off command does
+//                  not displace those a script runs repeatedly. An image is keyed by filename, FAT timestamp
+//                  and size and carries the CRC32 of its contents, it is copied to the load address and the
+//                  copy checked against the CRC before it is used, a changed file or a corrupted image falls
+//                  back to the SD card.
+//
+//                  The time from lookup to loaded image is recorded per command.
+//
+// Credits:
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         v1.0 Oct 2026  - Initial write.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//                  APP_CACHE             - Cache application images in RAM.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined __ZPU__
+  #include "zpu_soc.h"
+#elif defined __K64F__
+  #include "k64f_soc.h"
+#elif defined __M68K__
+  #include "m68k_soc.h"
+#endif
+#include "ff.h"
+#if defined(APP_CACHE)
+  #include "crc32.h"
+#endif
+#include "appreg.h"
+
+// Millisecond time, the K64F counter is maintained by the systick interrupt.
+#if defined __K64F__
+  extern volatile uint32_t systick_millis_count;
+  #define APPREG_MILLIS()            (systick_millis_count)
+#else
+  #define APPREG_MILLIS()            (TIMER_MILLISECONDS_UP)
+#endif
+
+// Registry, an array of entries grown as needed and chained from the hash buckets.
+//
+static t_appEntry                    *appTable    = NULL;
+static uint16_t                      appAllocated = 0;
+static uint16_t                      appBucket[APPREG_BUCKETS];
+static char                          appPrefix[APPREG_PATH_LEN - APPREG_FILE_LEN];
+static t_appRegStats                 appStats;
+#if defined(APP_CACHE)
+static t_appCacheSlot                appCache[APP_CACHE_SLOTS];
+static uint32_t                      appSequence  = 0;
+#endif
+
+// Method to convert a character to lower case.
+//
+static char appRegLower(char c)
+{
+    return(c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c);
+}
+
+// Method to hash the first len characters of a command, case insensitive (FNV-1a).
+//
+static uint16_t appRegHash(const char *name, uint8_t len)
+{
+    uint32_t hash = 2166136261UL;
+
+    while(len--)
+    {
+        hash = (hash ^ (uint8_t)appRegLower(*name++)) * 16777619UL;
+    }
+    return((uint16_t)(hash & (APPREG_BUCKETS - 1)));
+}
+
+// Method to compare two strings case insensitive, returns 1 if they match.
+//
+static uint8_t appRegMatch(const char *str1, const char *str2)
+{
+    while(*str1 && appRegLower(*str1) == appRegLower(*str2))
+    {
+        str1++;
+        str2++;
+    }
+    return(*str1 == *str2);
+}
+
+// Method to find a command in the registry, returns the entry index or APPREG_NONE.
+//
+static uint16_t appRegFind(const char *name)
+{
+    uint16_t    idx;
+    uint8_t     len = strlen(name);
+    uint8_t     pos;
+
+    if(appTable == NULL || len == 0 || len >= APPREG_FILE_LEN)
+        return(APPREG_NONE);
+
+    for(idx = appBucket[appRegHash(name, len)]; idx != APPREG_NONE; idx = appTable[idx].next)
+    {
+        for(pos=0; pos < len && appTable[idx].file[pos] == appRegLower(name[pos]); pos++);
+        if(pos == len && appTable[idx].file[pos] == '.')
+            break;
+    }
+    return(idx);
+}
+
+// Method to read the application bin directory into the registry. Every file with the given extension is
+// registered under its name without the extension. Any previous registry is released first.
+//
+FRESULT appRegBuild(uint8_t drive, const char *dir, const char *ext)
+{
+    // Locals.
+    DIR          dirFp;
+    FILINFO      fno;
+    t_appEntry   *entry;
+    t_appEntry   *newTable;
+    const char   *dot;
+    uint32_t     startTime = APPREG_MILLIS();
+    uint16_t     hash;
+    uint8_t      pos;
+    FRESULT      result;
+
+    // Release the previous registry, cached images are kept as they are keyed by file and stamp.
+    if(appTable != NULL)
+        free(appTable);
+    appTable     = NULL;
+    appAllocated = 0;
+    appStats.entries = 0;
+    for(hash=0; hash < APPREG_BUCKETS; hash++)
+        appBucket[hash] = APPREG_NONE;
+
+    if(strlen(dir) + 5 > sizeof(appPrefix))
+        return(FR_INVALID_NAME);
+    sprintf(appPrefix, "%d:\\%s\\", drive, dir);
+
+    if((result = f_opendir(&dirFp, appPrefix)) != FR_OK)
+        return(result);
+    while(result == FR_OK)
+    {
+        result = f_readdir(&dirFp, &fno);
+        if(result != FR_OK || fno.fname[0] == 0)
+            break;
+
+        // Only files named <command>.<ext> which fit an entry are registered.
+        dot = strrchr(fno.fname, '.');
+        if((fno.fattrib & AM_DIR) || dot == NULL || dot == fno.fname || strlen(fno.fname) >= APPREG_FILE_LEN || !appRegMatch(dot + 1, ext))
+            continue;
+
+        if(appStats.entries == appAllocated)
+        {
+            if((newTable = (t_appEntry *)realloc(appTable, (appAllocated + APPREG_GROW) * sizeof(t_appEntry))) == NULL)
+            {
+                result = FR_NOT_ENOUGH_CORE;
+                break;
+            }
+            appTable      = newTable;
+            appAllocated += APPREG_GROW;
+        }
+
+        // Command held in lower case, the extension as found.
+        entry = &appTable[appStats.entries];
+        memset(entry, 0, sizeof(t_appEntry));
+        for(pos=0; fno.fname[pos]; pos++)
+            entry->file[pos] = &fno.fname[pos] < dot ? appRegLower(fno.fname[pos]) : fno.fname[pos];
+        entry->fsize = fno.fsize;
+        entry->fdate = fno.fdate;
+        entry->ftime = fno.ftime;
+
+        hash = appRegHash(entry->file, dot - fno.fname);
+        entry->next     = appBucket[hash];
+        appBucket[hash] = appStats.entries++;
+    }
+    f_closedir(&dirFp);
+
+    appStats.buildMs = (uint16_t)(APPREG_MILLIS() - startTime);
+    return(result);
+}
+
+// Method to return a registry entry by index, NULL beyond the last.
+//
+t_appEntry *appRegEntry(uint16_t idx)
+{
+    return(idx < appStats.entries ? &appTable[idx] : NULL);
+}
+
+// Method to return the registry and cache summary.
+//
+void appRegGetStats(t_appRegStats *stats)
+{
+    memcpy(stats, &appStats, sizeof(t_appRegStats));
+}
+
+#if defined(APP_CACHE)
+// Method to release a cached image.
+//
+static void appCacheDrop(t_appCacheSlot *slot)
+{
+    free(slot->image);
+    slot->image = NULL;
+    appStats.cacheBytes -= slot->fsize;
+    appStats.cacheImages--;
+}
+
+// Method to find the cached image of an entry, NULL if not cached or the file has changed since.
+//
+static t_appCacheSlot *appCacheFind(t_appEntry *entry)
+{
+    uint8_t idx;
+
+    for(idx=0; idx < APP_CACHE_SLOTS; idx++)
+    {
+        if(appCache[idx].image != NULL && strcmp(appCache[idx].file, entry->file) == 0)
+        {
+            if(appCache[idx].fdate == entry->fdate && appCache[idx].ftime == entry->ftime && appCache[idx].fsize == entry->fsize)
+                return(&appCache[idx]);
+
+            // Stale, the file has been replaced.
+            appCacheDrop(&appCache[idx]);
+        }
+    }
+    return(NULL);
+}
+
+// Method to drop the least recently used image, returns 0 if the cache is empty.
+//
+static uint8_t appCacheEvict(void)
+{
+    t_appCacheSlot *victim = NULL;
+    uint8_t         idx;
+
+    for(idx=0; idx < APP_CACHE_SLOTS; idx++)
+    {
+        if(appCache[idx].image != NULL && (victim == NULL || appCache[idx].lastUsed < victim->lastUsed))
+            victim = &appCache[idx];
+    }
+    if(victim == NULL)
+        return(0);
+
+    appCacheDrop(victim);
+    appStats.cacheEvictions++;
+    return(1);
+}
+
+// Method to cache the image of an entry just loaded at addr, making room as needed.
+//
+static void appCacheStore(t_appEntry *entry, uint32_t addr)
+{
+    t_appCacheSlot *slot;
+    uint8_t        *image;
+    uint8_t         idx;
+
+    if(entry->fsize == 0 || entry->fsize > APP_CACHE_SIZE)
+        return;
+
+    // Room within the budget and a free slot.
+    while(appStats.cacheBytes + entry->fsize > APP_CACHE_SIZE && appCacheEvict());
+    do {
+        for(idx=0; idx < APP_CACHE_SLOTS && appCache[idx].image != NULL; idx++);
+    } while(idx == APP_CACHE_SLOTS && appCacheEvict());
+    slot = &appCache[idx];
+
+    // The heap is shared, give up older images until the allocation succeeds.
+    while((image = (uint8_t *)malloc(entry->fsize)) == NULL)
+    {
+        if(!appCacheEvict())
+            return;
+    }
+    memcpy(image, (uint8_t *)(uintptr_t)addr, entry->fsize);
+
+    strcpy(slot->file, entry->file);
+    slot->fdate    = entry->fdate;
+    slot->ftime    = entry->ftime;
+    slot->fsize    = entry->fsize;
+    slot->crc      = ~crc32_update(crc32_init(), image, entry->fsize);
+    slot->lastUsed = ++appSequence;
+    slot->image    = image;
+    appStats.cacheBytes += entry->fsize;
+    appStats.cacheImages++;
+}
+
+// Method to indicate if an entry has an image in the cache.
+//
+uint8_t appRegIsCached(t_appEntry *entry)
+{
+    uint8_t idx;
+
+    for(idx=0; idx < APP_CACHE_SLOTS; idx++)
+    {
+        if(appCache[idx].image != NULL && strcmp(appCache[idx].file, entry->file) == 0)
+            return(1);
+    }
+    return(0);
+}
+#else
+uint8_t appRegIsCached(t_appEntry *entry)
+{
+    return(0);
+}
+#endif
+
+// Method to load a registered application into memory at addr. Returns FR_NO_FILE if the command is not
+// registered so the caller can fall back to a search, otherwise the result of the load.
+//
+FRESULT appRegLoad(const char *name, uint32_t addr)
+{
+    // Locals.
+    FIL         fp;
+    t_appEntry  *entry;
+    char        path[APPREG_PATH_LEN];
+    uint32_t    startTime = APPREG_MILLIS();
+    uint32_t    mSec;
+    UINT        readSize;
+    uint16_t    idx;
+    uint8_t     hit = 0;
+    FRESULT     result;
+  #if defined(APP_CACHE)
+    FILINFO     fno;
+    t_appCacheSlot *slot;
+    uint8_t     admit = 0;
+  #endif
+
+    if((idx = appRegFind(name)) == APPREG_NONE)
+        return(FR_NO_FILE);
+    entry = &appTable[idx];
+    strcpy(path, appPrefix);
+    strcat(path, entry->file);
+
+  #if defined(APP_CACHE)
+    // An image is only cached from the second run so an application run once does not displace those run
+    // repeatedly. The current timestamp is needed to validate a cached image or to cache a new one, the file
+    // may have been replaced since the registry was built.
+    if(entry->launches > 0 || appRegIsCached(entry))
+    {
+        if((result = f_stat(path, &fno)) != FR_OK)
+            return(result);
+        entry->fsize = fno.fsize;
+        entry->fdate = fno.fdate;
+        entry->ftime = fno.ftime;
+        admit        = 1;
+
+        if((slot = appCacheFind(entry)) != NULL)
+        {
+            memcpy((uint8_t *)(uintptr_t)addr, slot->image, slot->fsize);
+            if(~crc32_update(crc32_init(), (uint8_t *)(uintptr_t)addr, slot->fsize) == slot->crc)
+            {
+                slot->lastUsed = ++appSequence;
+                hit = 1;
+            } else
+            {
+                appCacheDrop(slot);
+                appStats.cacheRejects++;
+            }
+        }
+    }
+  #endif
+
+    // Read the whole file in one request, FatFS transfers complete sectors directly to the destination.
+    if(!hit)
+    {
+        if((result = f_open(&fp, path, FA_OPEN_EXISTING | FA_READ)) != FR_OK)
+            return(result);
+        entry->fsize = f_size(&fp);
+        result = f_read(&fp, (void *)(uintptr_t)addr, entry->fsize, &readSize);
+        f_close(&fp);
+        if(result == FR_OK && readSize != entry->fsize)
+            result = FR_INT_ERR;
+        if(result != FR_OK)
+            return(result);
+      #if defined(APP_CACHE)
+        if(admit)
+            appCacheStore(entry, addr);
+      #endif
+    }
+
+    mSec = APPREG_MILLIS() - startTime;
+    entry->launches++;
+    entry->hits    += hit;
+    entry->lastMs   = mSec > 0xFFFF ? 0xFFFF : (uint16_t)mSec;
+    entry->totalMs += mSec;
+    return(FR_OK);
+}
+
+#ifdef __cplusplus
+    }
+#endif
@@ -0,0 +1,256 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            blkupload.c
+// Created:         Oct 2026
+// Version:         v1.0
+// Author(s):       Philip Smart
+// Description:     Block framed serial upload.
+//                  Receiver for the IOCP block upload protocol, see blkupload.h for the framing. The
+//                  original upload streamed the whole image with a single CRC checked at the end, one bad
+//                  byte meant sending everything again and a lost byte left the loader waiting forever.
+//                  Here each block carries its own CRC and is acknowledged as soon as it is stored, the
+//                  host keeps a window of blocks in flight so the line stays busy and only the blocks
+//                  which fail are sent again.
+//
+//                  Data is stored straight into the destination memory a word at a time as it arrives and
+//                  the block CRC is accumulated alongside, there is no intermediate buffer and no pass over
+//                  the block afterwards. A block is only stored whilst it is missing, a repeat of a block
+//                  already held is read, checked and acknowledged again without touching memory.
+//
+// Credits:
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         v1.0 Oct 2026  - Initial write.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include "zpu_soc.h"
+#include "uart.h"
+#include "crc32.h"
+#include "blkupload.h"
+
+// Data register access, overridable so the receiver can be run against a UART model on the host.
+#if !defined(UART_GET)
+  #define UART_GET(x)                    UART_DATA(x)
+#endif
+
+// Method to wait for a byte from the console UART. Returns the byte or -1 if none arrives within the given
+// number of milliseconds.
+//
+static int blkGetByte(uint32_t timeout)
+{
+    uint32_t start = TIMER_MILLISECONDS_UP;
+
+    do {
+        if(UART_IS_RX_DATA_READY(UART_STATUS(UART0)))
+            return((int)(UART_GET(UART0) & 0xFF));
+    } while((uint32_t)(TIMER_MILLISECONDS_UP - start) < timeout);
+
+    return(-1);
+}
+
+// Method to read a word sent most significant byte first. Returns 0 on timeout.
+//
+static int blkGetWord(uint32_t *word)
+{
+    int c;
+    int idx;
+
+    for(idx=0; idx < 4; idx++)
+    {
+        if((c = blkGetByte(BLK_BYTE_TIMEOUT)) < 0)
+            return(0);
+        *word = (*word << 8) | (uint32_t)c;
+    }
+    return(1);
+}
+
+// Method to send a two byte response.
+//
+static void blkReply(uint8_t code, uint8_t value)
+{
+    _putchar(code);
+    _putchar(value);
+}
+
+// Method to receive the data and CRC of a block. If dst is given the data is stored a word at a time as it
+// arrives, otherwise it is only checked. Returns 1 if the block is intact, 0 on a CRC mismatch and -1 if
+// the frame was cut short.
+//
+static int blkReceive(uint32_t *dst, uint32_t len)
+{
+    // Locals.
+    union {
+        uint32_t word;
+        uint8_t  byte[4];
+    }        data;
+    uint32_t crc = crc32_init();
+    uint32_t crcSrc;
+    uint32_t pos;
+    int      idx;
+    int      c;
+
+    for(pos=0; pos < len; pos+=4)
+    {
+        for(idx=0; idx < 4; idx++)
+        {
+            if((c = blkGetByte(BLK_BYTE_TIMEOUT)) < 0)
+                return(-1);
+            data.byte[idx] = (uint8_t)c;
+        }
+        crc = crc32_update(crc, data.byte, 4);
+        if(dst)
+            *dst++ = data.word;
+    }
+    if(!blkGetWord(&crcSrc))
+        return(-1);
+
+    return(crcSrc == ~crc ? 1 : 0);
+}
+
+// Function to receive an image into memory with the block protocol, called once the start sequence has been
+// read. Statistics are returned in stats if given. Returns BLK_OK or the reason for failure.
+//
+int blkUpload(uint32_t memAddr, uint32_t memSize, t_blkStats *stats)
+{
+    // Locals.
+    t_blkStats  local;
+    uint32_t    header[3] = { 0, 0, 0 };
+    uint32_t    blocks;
+    uint32_t    base    = 0;                 // Lowest block still missing.
+    uint32_t    held    = 0;                 // Blocks held above base, bit n is block base+n.
+    uint32_t    blockNo;
+    uint32_t    len;
+    uint32_t    crc;
+    int32_t     offset;
+    uint8_t     store;
+    int         result;
+    int         n;
+    int         c;
+
+    if(stats == NULL)
+        stats = &local;
+    memset(stats, 0, sizeof(t_blkStats));
+
+    // Header, the image size and CRC protected by a CRC of their own.
+    //
+    if(!blkGetWord(&header[0]) || !blkGetWord(&header[1]) || !blkGetWord(&header[2]))
+        return(BLK_ERR_TIMEOUT);
+    crc = ~crc32_addword(crc32_addword(crc32_init(), header[0]), header[1]);
+    if(crc != header[2])
+    {
+        blkReply(BLK_CAN, BLK_ERR_HEADER);
+        return(BLK_ERR_HEADER);
+    }
+    if(header[0] == 0 || header[0] > memSize || (header[0] & 3))
+    {
+        blkReply(BLK_CAN, BLK_ERR_SIZE);
+        return(BLK_ERR_SIZE);
+    }
+    blocks = (header[0] + BLK_SIZE - 1) / BLK_SIZE;
+    blkReply(BLK_READY, BLK_WINDOW);
+
+    // Receive blocks until the host signals it has every block acknowledged. Until every block is held an
+    // EOT can only be a data byte passed over whilst looking for the next frame.
+    //
+    while(1)
+    {
+        if((c = blkGetByte(BLK_IDLE_TIMEOUT)) < 0)
+            return(BLK_ERR_TIMEOUT);
+        if(c == BLK_EOT && base == blocks)
+            break;
+        if(c != BLK_SOH)
+        {
+            stats->resyncs++;
+            continue;
+        }
+
+        // Block number and its inverse, a mismatch means the SOH was a data byte and the search continues.
+        if((n = blkGetByte(BLK_BYTE_TIMEOUT)) < 0 || (c = blkGetByte(BLK_BYTE_TIMEOUT)) < 0)
+        {
+            stats->timeouts++;
+            continue;
+        }
+        if((n ^ c) != 0xFF)
+        {
+            stats->resyncs++;
+            continue;
+        }
+
+        // Place the block relative to the lowest missing block, the host never sends beyond the window
+        // and may repeat blocks below base whose acknowledgement it missed.
+        offset  = (int8_t)(uint8_t)(n - base);
+        blockNo = base + offset;
+        if(offset >= BLK_WINDOW || (int32_t)base + offset < 0 || blockNo >= blocks)
+        {
+            stats->resyncs++;
+            continue;
+        }
+        len    = blockNo == blocks - 1 ? header[0] - (blockNo * BLK_SIZE) : BLK_SIZE;
+        store  = offset >= 0 && !(held & (1 << offset));
+        result = blkReceive(store ? (uint32_t *)(uintptr_t)(memAddr + (blockNo * BLK_SIZE)) : NULL, len);
+
+        if(result <= 0)
+        {
+            if(result < 0)
+                stats->timeouts++;
+            else
+                stats->naks++;
+            blkReply(BLK_NAK, n);
+            continue;
+        }
+        if(store)
+        {
+            stats->blocks++;
+            held |= (1 << offset);
+            while(held & 1)
+            {
+                held >>= 1;
+                base++;
+            }
+        } else
+        {
+            stats->duplicates++;
+        }
+        blkReply(BLK_ACK, n);
+    }
+
+    // Check the image as a whole.
+    //
+    crc = ~crc32_update(crc32_init(), (uint8_t *)(uintptr_t)memAddr, header[0]);
+    result = crc == header[1] ? BLK_OK : BLK_ERR_CRC;
+    blkReply(BLK_DONE, result);
+
+    // The completion may be lost, answer a repeated end until the host goes quiet.
+    while((c = blkGetByte(BLK_LINGER)) >= 0)
+    {
+        if(c == BLK_EOT)
+            blkReply(BLK_DONE, result);
+    }
+    return(result);
+}
+
+#ifdef __cplusplus
+    }
+#endif
@@ -0,0 +1,203 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            crc32.c
+// Created:         Oct 2026
+// Version:         v1.0
+// Author(s):       Philip Smart
+// Description:     CRC32 (IEEE 802.3, polynomial 0xEDB88320) checksum.
+//                  The original implementation fed the CRC a 32bit word at a time through a single 256
+//                  entry table, one table lookup and shift per byte. This module processes a buffer with
+//                  slicing-by-8, 8 bytes are combined with the CRC and looked up in 8 tables in parallel
+//                  which needs 8KB of tables but removes the serial dependency between the bytes. Where
+//                  memory is short, ie. the IOCP in BRAM, CRC32_SMALL_TABLE builds the bytewise single
+//                  table version.
+//
+//                  The ZPU and 68000 are big endian, a 32bit load places the first byte in the most
+//                  significant position, so on these targets the tables are held byte swapped and the
+//                  CRC is swapped on entry and exit, allowing the same aligned word loads as the little
+//                  endian K64F.
+//
+// Credits:
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         v1.0 Oct 2026  - Initial write, replaces the word at a time CRC in utils/simple_utils.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//                  CRC32_SMALL_TABLE     - Use a single 256 entry table and process a byte at a time.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+#include <stdint.h>
+#include "crc32.h"
+
+// Big endian targets hold the tables byte swapped.
+#if (defined(__ZPU__) || defined(__M68K__)) && !defined(CRC32_BIG_ENDIAN)
+  #define CRC32_BIG_ENDIAN
+#endif
+
+// Aligned 32bit load, overridable so the big endian path can be exercised on a little endian host.
+#if !defined(CRC32_LOAD)
+  #define CRC32_LOAD(p)                  (*(const uint32_t *)(p))
+#endif
+#define CRC32_SWAP(w)                    ((((w) >> 24) & 0x000000FF) | (((w) >> 8) & 0x0000FF00) | (((w) << 8) & 0x00FF0000) | (((w) << 24) & 0xFF000000))
+
+static uint32_t crc32table[CRC32_TABLES][256];
+static uint8_t  crc32ready = 0;
+
+// Function to setup the CRC polynomial tables prior to use, they are only built on the first call. Returns
+// the starting value for a CRC calculation.
+//
+uint32_t crc32_init(void)
+{
+    // Locals.
+    uint32_t   byte;
+    uint32_t   crc;
+    int        bit;
+  #if CRC32_TABLES > 1
+    int        tbl;
+  #endif
+
+    if(!crc32ready)
+    {
+        for(byte = 0; byte < 256; byte++)
+        {
+            crc = byte;
+            for(bit = 0; bit < 8; bit++)
+            {
+                crc = (crc >> 1) ^ (CRC32_POLYNOMIAL & -(crc & 1));
+            }
+            crc32table[0][byte] = crc;
+        }
+
+      #if CRC32_TABLES > 1
+        // Table n gives the CRC of a byte followed by n zero bytes.
+        for(byte = 0; byte < 256; byte++)
+        {
+            crc = crc32table[0][byte];
+            for(tbl = 1; tbl < CRC32_TABLES; tbl++)
+            {
+                crc = (crc >> 8) ^ crc32table[0][crc & 0xFF];
+                crc32table[tbl][byte] = crc;
+            }
+        }
+       #if defined(CRC32_BIG_ENDIAN)
+        for(tbl = 0; tbl < CRC32_TABLES; tbl++)
+        {
+            for(byte = 0; byte < 256; byte++)
+            {
+                crc32table[tbl][byte] = CRC32_SWAP(crc32table[tbl][byte]);
+            }
+        }
+       #endif
+      #endif
+        crc32ready = 1;
+    }
+
+    // Starting value for CRC calculation.
+    //
+    return(CRC32_INITIAL);
+}
+
+// Function to add a buffer into the CRC sum.
+//
+uint32_t crc32_update(uint32_t crc, const void *buf, uint32_t len)
+{
+    // Locals.
+    const uint8_t *ptr = (const uint8_t *)buf;
+  #if CRC32_TABLES > 1
+    uint32_t       one;
+    uint32_t       two;
+  #endif
+
+  #if CRC32_TABLES == 1
+    while(len--)
+    {
+        crc = (crc >> 8) ^ crc32table[0][(crc ^ *ptr++) & 0xFF];
+    }
+  #elif defined(CRC32_BIG_ENDIAN)
+    crc = CRC32_SWAP(crc);
+
+    // Bytewise up to a word boundary, then 8 bytes per step, then the tail.
+    while(len && ((unsigned long)ptr & 3))
+    {
+        crc = crc32table[0][(crc >> 24) ^ *ptr++] ^ (crc << 8);
+        len--;
+    }
+    while(len >= 8)
+    {
+        one  = CRC32_LOAD(ptr) ^ crc;
+        two  = CRC32_LOAD(ptr + 4);
+        crc  = crc32table[7][one >> 24]          ^ crc32table[6][(one >> 16) & 0xFF] ^
+               crc32table[5][(one >> 8) & 0xFF]  ^ crc32table[4][one & 0xFF]         ^
+               crc32table[3][two >> 24]          ^ crc32table[2][(two >> 16) & 0xFF] ^
+               crc32table[1][(two >> 8) & 0xFF]  ^ crc32table[0][two & 0xFF];
+        ptr += 8;
+        len -= 8;
+    }
+    while(len--)
+    {
+        crc = crc32table[0][(crc >> 24) ^ *ptr++] ^ (crc << 8);
+    }
+    crc = CRC32_SWAP(crc);
+  #else
+    // Bytewise up to a word boundary, then 8 bytes per step, then the tail.
+    while(len && ((unsigned long)ptr & 3))
+    {
+        crc = (crc >> 8) ^ crc32table[0][(crc ^ *ptr++) & 0xFF];
+        len--;
+    }
+    while(len >= 8)
+    {
+        one  = CRC32_LOAD(ptr) ^ crc;
+        two  = CRC32_LOAD(ptr + 4);
+        crc  = crc32table[7][one & 0xFF]         ^ crc32table[6][(one >> 8) & 0xFF]  ^
+               crc32table[5][(one >> 16) & 0xFF] ^ crc32table[4][one >> 24]          ^
+               crc32table[3][two & 0xFF]         ^ crc32table[2][(two >> 8) & 0xFF]  ^
+               crc32table[1][(two >> 16) & 0xFF] ^ crc32table[0][two >> 24];
+        ptr += 8;
+        len -= 8;
+    }
+    while(len--)
+    {
+        crc = (crc >> 8) ^ crc32table[0][(crc ^ *ptr++) & 0xFF];
+    }
+  #endif
+
+    return(crc);
+}
+
+// Function to add a word into the CRC sum, most significant byte first.
+//
+uint32_t crc32_addword(uint32_t crc, uint32_t word)
+{
+    // Locals.
+    uint8_t    bytes[4];
+
+    bytes[0] = (uint8_t)(word >> 24);
+    bytes[1] = (uint8_t)(word >> 16);
+    bytes[2] = (uint8_t)(word >> 8);
+    bytes[3] = (uint8_t)word;
+
+    return(crc32_update(crc, bytes, 4));
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,417 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            dircache.c
+// Created:         Oct 2026
+// Version:         v1.2
+// Author(s):       Philip Smart
+// Description:     SD directory cache builder.
+//                  This module builds the tranZPUter directory cache used by the TZFS/CPM directory and
+//                  find services. Each MZF file has to be opened to read its header which, on a large
+//                  directory, takes several seconds. To avoid this the headers are saved in an index
+//                  file within the directory along with the FAT size and modified timestamp of the file
+//                  they came from. On the next build, entries whose size and timestamp still match, as
+//                  returned by the directory read, are taken from the index and only new or changed
+//                  files are opened. The index is only rewritten when something has changed.
+//                  The cache itself is held in a single allocation, the map array followed by the
+//                  filenames, rather than two allocations per file.
+//
+// Credits:
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         v1.0 Oct 2026  - Initial write.
+//                  v1.1 Oct 2026  - Yields to the event queue between entries of a build.
+//                  v1.2 Oct 2026  - Only the cache is held at a yield, the SD card is free between entries.
+//                                   A build is not nested within one which has yielded.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "ff.h"
+#include <tranzputer.h>
+#include <dircache.h>
+#if defined(__TRANZPUTER__)
+  #include <evq.h>
+#endif
+
+// FAT details of a cached file, kept during the build so the index can be written out.
+//
+typedef struct {
+    uint32_t                         fsize;                              // FAT file size.
+    uint16_t                         fdate;                              // FAT modified date.
+    uint16_t                         ftime;                              // FAT modified time.
+} t_dirStamp;
+
+// Largest valid index file, every entry with a maximum length LFN name.
+//
+#define DIRCACHE_INDEX_MAX           (sizeof(t_dirIndexHdr) + TZSVC_MAX_DIR_ENTRIES * (sizeof(t_dirIndexRec) + FF_LFN_BUF))
+
+// Statistics of the last build.
+//
+static t_dirCacheStats               dirCacheStats;
+
+// Set whilst a build is in progress, a request run at one of its yield points cannot start another.
+//
+static uint8_t                       dirCacheBuilding = 0;
+
+// Method to check if an SD directory entry belongs in a cache of the given type. The index file is never cached.
+//
+static uint8_t dirCacheMatchType(FILINFO *fno, enum FILE_TYPE type)
+{
+    // Locals.
+    const char *ext = strrchr(fno->fname, '.');
+
+    if(strcasecmp(fno->fname, DIRCACHE_INDEX_NAME) == 0)
+        return(0);
+    if(type == MZF && (!ext || strcasecmp(ext+1, TZSVC_DEFAULT_MZF_EXT) != 0))
+        return(0);
+    if(type == BAS && (!ext || strcasecmp(ext+1, TZSVC_DEFAULT_BAS_EXT) != 0))
+        return(0);
+    if(type == CAS && (!ext || strcasecmp(ext+1, TZSVC_DEFAULT_CAS_EXT) != 0))
+        return(0);
+    if(type == ALL && !ext)
+        return(0);
+    return(1);
+}
+
+// Method to load the index file of a directory into memory. The records are checked to exactly fill the file so that
+// a truncated or corrupt index is discarded rather than used. Returns NULL if there is no usable index.
+//
+static uint8_t *dirCacheLoadIndex(const char *directory, uint32_t *indexSize, uint16_t *indexEntries)
+{
+    // Locals.
+    char           fqfn[FF_LFN_BUF + 13];
+    FIL            File;
+    UINT           readSize;
+    t_dirIndexHdr  hdr;
+    uint8_t        *index    = NULL;
+    uint8_t        *pos;
+    uint32_t       size;
+
+    sprintf(fqfn, "0:\\%s\\%s", directory, DIRCACHE_INDEX_NAME);
+    if(f_open(&File, fqfn, FA_OPEN_EXISTING | FA_READ) != FR_OK)
+        return(NULL);
+
+    size = f_size(&File);
+    if(size > sizeof(t_dirIndexHdr) && size <= DIRCACHE_INDEX_MAX &&
+       f_read(&File, &hdr, sizeof(t_dirIndexHdr), &readSize) == FR_OK && readSize == sizeof(t_dirIndexHdr) &&
+       hdr.magic == DIRCACHE_INDEX_MAGIC && hdr.version == DIRCACHE_INDEX_VERSION && hdr.entries <= TZSVC_MAX_DIR_ENTRIES)
+    {
+        size -= sizeof(t_dirIndexHdr);
+        index = (uint8_t *)malloc(size);
+        if(index != NULL && (f_read(&File, index, size, &readSize) != FR_OK || readSize != size))
+        {
+            free(index);
+            index = NULL;
+        }
+
+        // Walk the records, they must end exactly at the end of the file.
+        pos = index;
+        for(uint16_t idx=0; pos != NULL && idx < hdr.entries; idx++)
+        {
+            if(pos + sizeof(t_dirIndexRec) > index + size || pos + sizeof(t_dirIndexRec) + ((t_dirIndexRec *)pos)->nameLen > index + size)
+                pos = NULL;
+            else
+                pos += sizeof(t_dirIndexRec) + ((t_dirIndexRec *)pos)->nameLen;
+        }
+        if(index != NULL && pos != index + size)
+        {
+            free(index);
+            index = NULL;
+        }
+        *indexSize    = size;
+        *indexEntries = hdr.entries;
+    }
+    f_close(&File);
+
+    return(index);
+}
+
+// Method to find the index record for a file. The directory is normally read in the same order as when the index was
+// written so the search starts at the record after the last match, wrapping round to cover every record.
+//
+static t_dirIndexRec *dirCacheFindIndex(uint8_t *index, uint32_t indexSize, uint16_t indexEntries, uint8_t **cursor, const char *name)
+{
+    // Locals.
+    size_t         nameLen   = strlen(name);
+    uint8_t        *pos      = *cursor;
+    t_dirIndexRec  *rec;
+
+    for(uint16_t idx=0; idx < indexEntries; idx++)
+    {
+        if(pos >= index + indexSize)
+            pos = index;
+
+        rec = (t_dirIndexRec *)pos;
+        pos += sizeof(t_dirIndexRec) + rec->nameLen;
+        if(rec->nameLen == nameLen && memcmp((uint8_t *)rec + sizeof(t_dirIndexRec), name, nameLen) == 0)
+        {
+            *cursor = pos;
+            return(rec);
+        }
+    }
+    return(NULL);
+}
+
+// Method to write out the index file for a freshly built cache. Failure, ie. a write protected card, is not an error,
+// the cache is valid and the next build will simply open every file again.
+//
+static uint8_t dirCacheWriteIndex(t_dirMap *dirMap, const char *directory, t_dirStamp *stamp)
+{
+    // Locals.
+    char           fqfn[FF_LFN_BUF + 13];
+    FIL            File;
+    UINT           writeSize;
+    t_dirIndexHdr  hdr;
+    t_dirIndexRec  rec;
+    FRESULT        result;
+
+    sprintf(fqfn, "0:\\%s\\%s", directory, DIRCACHE_INDEX_NAME);
+    result = f_open(&File, fqfn, FA_CREATE_ALWAYS | FA_WRITE);
+    if(result != FR_OK)
+        return(0);
+
+    hdr.magic   = DIRCACHE_INDEX_MAGIC;
+    hdr.version = DIRCACHE_INDEX_VERSION;
+    hdr.entries = dirMap->entries;
+    result = f_write(&File, &hdr, sizeof(t_dirIndexHdr), &writeSize);
+
+    for(uint16_t idx=0; result == FR_OK && idx < dirMap->entries; idx++)
+    {
+        rec.fsize   = stamp[idx].fsize;
+        rec.fdate   = stamp[idx].fdate;
+        rec.ftime   = stamp[idx].ftime;
+        rec.nameLen = (uint8_t)strlen((char *)dirMap->mzfFile[idx]->sdFileName);
+        memcpy(&rec.mzfHeader, &dirMap->mzfFile[idx]->mzfHeader, TZSVC_CMPHDR_SIZE);
+
+        result = f_write(&File, &rec, sizeof(t_dirIndexRec), &writeSize);
+        if(result == FR_OK)
+            result = f_write(&File, dirMap->mzfFile[idx]->sdFileName, rec.nameLen, &writeSize);
+    }
+    if(f_close(&File) != FR_OK)
+        result = FR_DISK_ERR;
+
+    // Dont leave a partial index behind, hide a good one from directory listings on other machines.
+    if(result != FR_OK)
+        f_unlink(fqfn);
+    else
+        f_chmod(fqfn, AM_HID, AM_HID);
+
+    return(result == FR_OK);
+}
+
+// Method to build the cache of all the files in a directory of a given type, for MZF files this includes the MZF header
+// used by TZFS/CPM for name matching. Any existing cache is released first. Returns FR_LOCKED if a build is already in progress.
+//
+FRESULT dirCacheBuild(t_dirMap *dirMap, const char *directory, enum FILE_TYPE type)
+{
+    // Locals.
+    char           fqfn[FF_LFN_BUF + 13];  // 0:\12345678\<filename>
+    FIL            File;
+    FILINFO        fno;
+    DIR            dirFp;
+    UINT           readSize;
+    FRESULT        result    = FR_OK;
+    uint16_t       entries   = 0;
+    uint16_t       fileNo    = 0;
+    uint32_t       nameBytes = 0;
+    uint32_t       arenaSize = 0;
+    uint32_t       indexSize = 0;
+    uint16_t       indexEntries = 0;
+    uint8_t        *index    = NULL;
+    uint8_t        *cursor;
+    uint8_t        changed   = 0;
+    char           *names;
+    t_sharpToSDMap *maps;
+    t_dirStamp     *stamp    = NULL;
+    t_dirIndexRec  *rec;
+
+    if(dirCacheBuilding)
+        return(FR_LOCKED);
+    dirCacheBuilding = 1;
+    dirCacheFree(dirMap);
+    memset(&dirCacheStats, 0x00, sizeof(t_dirCacheStats));
+
+    // First pass counts the files and filename space so the cache can be allocated in one block.
+    //
+    result = f_opendir(&dirFp, directory);
+    while(result == FR_OK && entries < TZSVC_MAX_DIR_ENTRIES)
+    {
+        result = f_readdir(&dirFp, &fno);
+        if(result != FR_OK || fno.fname[0] == 0) break;
+
+        if(dirCacheMatchType(&fno, type))
+        {
+            entries++;
+            nameBytes += strlen(fno.fname) + 1;
+        }
+    }
+    f_closedir(&dirFp);
+
+    if(result == FR_OK)
+    {
+        arenaSize = (type == MZF ? entries * sizeof(t_sharpToSDMap) : 0) + nameBytes;
+        dirMap->arena = malloc(arenaSize > 0 ? arenaSize : 1);
+        if(dirMap->arena == NULL)
+        {
+            printf("Out of memory cacheing directory:%s\n", directory);
+            result = FR_NOT_ENOUGH_CORE;
+        } else
+        {
+            dirCacheStats.arenaSize = arenaSize;
+        }
+    }
+
+    // MZF headers can come from the index, the stamps are needed to write an updated index.
+    //
+    if(result == FR_OK && type == MZF && entries > 0)
+    {
+        index = dirCacheLoadIndex(directory, &indexSize, &indexEntries);
+        stamp = (t_dirStamp *)malloc(entries * sizeof(t_dirStamp));
+        dirCacheStats.indexLoaded = (index != NULL);
+    }
+    cursor = index;
+
+    // Second pass fills in the cache.
+    //
+    maps  = (t_sharpToSDMap *)dirMap->arena;
+    names = (char *)dirMap->arena + (type == MZF ? entries * sizeof(t_sharpToSDMap) : 0);
+    if(result == FR_OK)
+        result = f_opendir(&dirFp, directory);
+    while(result == FR_OK && fileNo < entries)
+    {
+      #if defined(__TRANZPUTER__)
+        // Pending events are served between entries. Each FatFs call has completed so only the cache, invalid until the end, is held.
+        evqYield(EVQ_USES_DIRCACHE);
+      #endif
+        result = f_readdir(&dirFp, &fno);
+        if(result != FR_OK || fno.fname[0] == 0) break;
+
+        if(!dirCacheMatchType(&fno, type))
+            continue;
+
+        // Guard against the directory growing between passes.
+        if(names + strlen(fno.fname) + 1 > (char *)dirMap->arena + arenaSize)
+            break;
+
+        if(type == MZF)
+        {
+            // Use the indexed header if the file hasnt changed since it was read, otherwise open the file and read it.
+            //
+            rec = index != NULL ? dirCacheFindIndex(index, indexSize, indexEntries, &cursor, fno.fname) : NULL;
+            if(rec != NULL && rec->fsize == fno.fsize && rec->fdate == fno.fdate && rec->ftime == fno.ftime)
+            {
+                memcpy((char *)&maps[fileNo].mzfHeader, (char *)&rec->mzfHeader, TZSVC_CMPHDR_SIZE);
+                dirCacheStats.reused++;
+            } else
+            {
+                changed = 1;
+                sprintf(fqfn, "0:\\%s\\%s", directory, fno.fname);
+                result = f_open(&File, fqfn, FA_OPEN_EXISTING | FA_READ);
+                if(!result)
+                {
+                    result = f_read(&File, (char *)&maps[fileNo].mzfHeader, TZSVC_CMPHDR_SIZE, &readSize);
+                    f_close(&File);
+                }
+                dirCacheStats.scanned++;
+
+                // Files too short to hold a header are not MZF files, skip them.
+                if(result || readSize != TZSVC_CMPHDR_SIZE)
+                    continue;
+            }
+            if(stamp != NULL)
+            {
+                stamp[fileNo].fsize = fno.fsize;
+                stamp[fileNo].fdate = fno.fdate;
+                stamp[fileNo].ftime = fno.ftime;
+            }
+            maps[fileNo].sdFileName = (uint8_t *)names;
+            dirMap->mzfFile[fileNo] = &maps[fileNo];
+        } else
+        {
+            dirMap->sdFileName[fileNo] = (uint8_t *)names;
+        }
+        strcpy(names, fno.fname);
+        names += strlen(fno.fname) + 1;
+        fileNo++;
+    }
+    f_closedir(&dirFp);
+
+    if(result == FR_OK)
+    {
+        // Validate the cache.
+        dirMap->valid   = 1;
+        dirMap->entries = (uint8_t)fileNo;
+        dirMap->type    = type;
+        strcpy(dirMap->directory, directory);
+        dirCacheStats.entries = fileNo;
+
+        // Files added, changed or removed, update the index.
+        if(type == MZF && stamp != NULL && (changed || indexEntries != fileNo))
+            dirCacheStats.indexWritten = dirCacheWriteIndex(dirMap, directory, stamp);
+    } else
+    {
+        dirCacheFree(dirMap);
+    }
+
+    if(index != NULL)
+        free(index);
+    if(stamp != NULL)
+        free(stamp);
+
+    dirCacheBuilding = 0;
+    return(result);
+}
+
+// Method to invalidate a cache and release its memory.
+//
+void dirCacheFree(t_dirMap *dirMap)
+{
+    dirMap->valid   = 0;
+    if(dirMap->arena != NULL)
+        free(dirMap->arena);
+    dirMap->arena   = NULL;
+    memset(dirMap->mzfFile, 0x00, sizeof(dirMap->mzfFile));
+    dirMap->entries = 0;
+    dirMap->type    = MZF;
+}
+
+// Method to test if a cache build is in progress.
+//
+uint8_t dirCacheBusy(void)
+{
+    return(dirCacheBuilding);
+}
+
+// Method to return the statistics of the last cache build.
+//
+void dirCacheGetStats(t_dirCacheStats *stats)
+{
+    memcpy(stats, &dirCacheStats, sizeof(t_dirCacheStats));
+}
+
+#ifdef __cplusplus
+}
+#endif
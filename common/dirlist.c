@@ -0,0 +1,321 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            dirlist.c
+// Created:         Oct 2026
+// Version:         v1.0
+// Author(s):       Philip Smart
+// Description:     Sorted directory list for the file browser.
+//                  The emulator file browser allocated every name it read separately then ordered the list
+//                  with a pass over every pair of entries, so a directory of a few thousand tape or disk
+//                  images took seconds to appear and left the heap fragmented. Names are now packed into a
+//                  single arena which doubles as needed, the index holds offsets into it so remains valid
+//                  when the arena moves. The directory is read a page at a time, each page heap sorted,
+//                  which needs no recursion or extra memory, and merged into the index from the top down so
+//                  the list is in order after every page and the first screen can be shown before a long
+//                  directory has been read. Directories sort ahead of files, each case insensitive, which
+//                  lets a typed prefix be found with a binary search in each run.
+//
+// Credits:
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         v1.0 Oct 2026  - Initial write.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "ff.h"
+#include <dirlist.h>
+
+// Method to check if a directory entry belongs in the list. Hidden directories are skipped, files must match the filter extension
+// unless the filter is a wildcard.
+//
+static uint8_t dirListMatch(t_dirList *list, FILINFO *fno)
+{
+    // Locals.
+    const char *ext       = strrchr(fno->fname, '.');
+    const char *filterExt = strrchr(list->filter, '.');
+
+    if(fno->fname[0] == 0)
+        return(0);
+    if(fno->fattrib & AM_DIR)
+        return(fno->fname[0] != '.');
+    if(strcmp(fno->fname, ".") == 0)
+        return(0);
+    if(filterExt != NULL && strcmp(filterExt, ".*") == 0)
+        return(1);
+    return(ext != NULL && strcasecmp(ext+1, (filterExt == NULL ? list->filter : filterExt+1)) == 0);
+}
+
+// Method to order two entries, directories first then by name ignoring case.
+//
+static int dirListCompare(t_dirList *list, t_dirEntry *a, t_dirEntry *b)
+{
+    if(a->isDir != b->isDir)
+        return(a->isDir ? -1 : 1);
+    return(strcasecmp(list->arena + a->nameOffset, list->arena + b->nameOffset));
+}
+
+// Method to sift an entry down the page heap until it is no smaller than its children.
+//
+static void dirListSift(t_dirList *list, uint16_t root, uint16_t entries)
+{
+    // Locals.
+    t_dirEntry  *page = list->page;
+    t_dirEntry  temp;
+    uint16_t    child;
+
+    while((child = 2*root + 1) < entries)
+    {
+        if(child+1 < entries && dirListCompare(list, &page[child], &page[child+1]) < 0)
+            child++;
+        if(dirListCompare(list, &page[root], &page[child]) >= 0)
+            break;
+        temp = page[root]; page[root] = page[child]; page[child] = temp;
+        root = child;
+    }
+    return;
+}
+
+// Method to sort the entries of a page, a heap sort as it is in place and needs no recursion.
+//
+static void dirListSortPage(t_dirList *list, uint16_t entries)
+{
+    // Locals.
+    t_dirEntry  *page = list->page;
+    t_dirEntry  temp;
+    uint16_t    idx;
+
+    for(idx=entries/2; idx > 0; idx--)
+        dirListSift(list, idx-1, entries);
+    for(idx=entries; idx > 1; idx--)
+    {
+        temp = page[0]; page[0] = page[idx-1]; page[idx-1] = temp;
+        dirListSift(list, 0, idx-1);
+    }
+    return;
+}
+
+// Method to merge a sorted page into the index. The merge works down from the top of the index so no further memory is needed, the
+// tracked index, if given, is moved with its entry.
+//
+static void dirListMerge(t_dirList *list, uint16_t entries, int16_t *track)
+{
+    // Locals.
+    int32_t     idx     = (int32_t)list->count - 1;
+    int32_t     pageIdx = (int32_t)entries - 1;
+    int32_t     dst     = (int32_t)list->count + entries - 1;
+    int16_t     tracked = (track != NULL ? *track : -1);
+
+    while(pageIdx >= 0)
+    {
+        if(idx >= 0 && dirListCompare(list, &list->entries[idx], &list->page[pageIdx]) > 0)
+        {
+            if(idx == tracked)
+                *track = (int16_t)dst;
+            list->entries[dst--] = list->entries[idx--];
+        } else
+        {
+            list->entries[dst--] = list->page[pageIdx--];
+        }
+    }
+    for(idx=0; idx < entries; idx++)
+    {
+        if(list->page[idx].isDir)
+            list->dirs++;
+    }
+    list->count += entries;
+    return;
+}
+
+// Method to read the next page of the directory into the list, called until scanning is clear. The directory is closed after the last
+// entry, on error or when the list is full. Returns FR_NOT_ENOUGH_CORE if memory ran out, the entries read before remain valid.
+//
+FRESULT dirListScan(t_dirList *list, int16_t *track)
+{
+    // Locals.
+    FRESULT        result  = FR_OK;
+    uint8_t        end     = 0;
+    uint16_t       entries = 0;
+    uint16_t       capacity;
+    uint32_t       len;
+    uint32_t       size;
+    void           *ptr;
+    static FILINFO fno;
+
+    if(!list->scanning)
+        return(FR_OK);
+
+    while(entries < DIRLIST_PAGE)
+    {
+        if(list->count + entries >= DIRLIST_MAX_ENTRIES)
+        {
+            end = 1;
+            break;
+        }
+        result = f_readdir(&list->dirFp, &fno);
+        if(result != FR_OK || fno.fname[0] == 0)
+        {
+            end = 1;
+            break;
+        }
+        if(!dirListMatch(list, &fno))
+            continue;
+
+        // Grow the arena if the name does not fit, the index holds offsets so is unaffected by a move.
+        len = strlen(fno.fname) + 1;
+        if(list->arenaUsed + len > list->arenaSize)
+        {
+            for(size=(list->arenaSize == 0 ? DIRLIST_ARENA_START : list->arenaSize * 2); size < list->arenaUsed + len; size *= 2);
+            if((ptr = realloc(list->arena, size)) == NULL)
+            {
+                result = FR_NOT_ENOUGH_CORE;
+                end    = 1;
+                break;
+            }
+            list->arena     = (char *)ptr;
+            list->arenaSize = size;
+        }
+        memcpy(list->arena + list->arenaUsed, fno.fname, len);
+        list->page[entries].nameOffset = list->arenaUsed;
+        list->page[entries].isDir      = (fno.fattrib & AM_DIR) ? 1 : 0;
+        list->arenaUsed += len;
+        entries++;
+    }
+
+    // Grow the index to take the page.
+    if(entries > 0 && list->count + entries > list->capacity)
+    {
+        for(capacity=(list->capacity == 0 ? DIRLIST_INDEX_START : list->capacity * 2); capacity < list->count + entries; capacity *= 2);
+        if(capacity > DIRLIST_MAX_ENTRIES)
+            capacity = DIRLIST_MAX_ENTRIES;
+        if((ptr = realloc(list->entries, capacity * sizeof(t_dirEntry))) == NULL)
+        {
+            result  = FR_NOT_ENOUGH_CORE;
+            end     = 1;
+            entries = 0;
+        } else
+        {
+            list->entries  = (t_dirEntry *)ptr;
+            list->capacity = capacity;
+        }
+    }
+    if(entries > 0)
+    {
+        dirListSortPage(list, entries);
+        dirListMerge(list, entries, track);
+    }
+
+    if(end)
+    {
+        f_closedir(&list->dirFp);
+        list->scanning = 0;
+    }
+    return(result);
+}
+
+// Method to open a directory and read the first page of it into the list, any previous list is released. Further pages are read
+// by calling dirListScan whilst scanning is set.
+//
+FRESULT dirListOpen(t_dirList *list, const char *path, const char *filter)
+{
+    // Locals.
+    FRESULT  result;
+
+    dirListRelease(list);
+    strncpy(list->filter, filter, DIRLIST_FILTER_LEN-1);
+    list->filter[DIRLIST_FILTER_LEN-1] = 0;
+
+    result = f_opendir(&list->dirFp, (char *)path);
+    if(result == FR_OK)
+    {
+        list->scanning = 1;
+        result = dirListScan(list, NULL);
+    }
+    return(result);
+}
+
+// Method to release the list, a directory still being read is closed.
+//
+void dirListRelease(t_dirList *list)
+{
+    if(list->scanning)
+        f_closedir(&list->dirFp);
+    if(list->arena != NULL)
+        free(list->arena);
+    if(list->entries != NULL)
+        free(list->entries);
+    memset(list, 0x00, sizeof(t_dirList));
+    return;
+}
+
+// Method to get the name of an entry, NULL if out of range.
+//
+const char *dirListName(t_dirList *list, uint16_t idx)
+{
+    return(idx < list->count ? list->arena + list->entries[idx].nameOffset : NULL);
+}
+
+// Method to test if an entry is a directory.
+//
+uint8_t dirListIsDir(t_dirList *list, uint16_t idx)
+{
+    return(idx < list->count ? list->entries[idx].isDir : 0);
+}
+
+// Method to find the first entry, in list order, which starts with the given prefix ignoring case. The directory and file runs are
+// each sorted so the first candidate in a run is found with a binary search. Returns the entry index or -1 if there is no match.
+//
+int16_t dirListFind(t_dirList *list, const char *prefix)
+{
+    // Locals.
+    size_t     len = strlen(prefix);
+    uint16_t   low;
+    uint16_t   high;
+    uint16_t   mid;
+    uint16_t   runEnd[2] = { list->dirs, list->count };
+
+    if(len == 0)
+        return(-1);
+
+    for(uint8_t run=0; run < 2; run++)
+    {
+        for(low=(run == 0 ? 0 : runEnd[0]), high=runEnd[run]; low < high; )
+        {
+            mid = low + (high - low) / 2;
+            if(strncasecmp(list->arena + list->entries[mid].nameOffset, prefix, len) < 0)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        if(low < runEnd[run] && strncasecmp(list->arena + list->entries[low].nameOffset, prefix, len) == 0)
+            return((int16_t)low);
+    }
+    return(-1);
+}
+
+#ifdef __cplusplus
+}
+#endif
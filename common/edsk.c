@@ -0,0 +1,183 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            edsk.c
+// Created:         Oct 2026
+// Version:         v1.0
+// Author(s):       Philip Smart
+// Description:     Extended CPC DSK (EDSK) floppy image index.
+//                  An EDSK image holds a table of track sizes in its Disk Information Block and a Sector
+//                  Information List at the head of each track, so the position of a sector depends on the
+//                  size of every track before it and every sector before it on its track. Rather than
+//                  traverse the image on each sector request the layout is parsed once, when the image is
+//                  mounted, into a single heap block holding the offset and length of each track and the
+//                  ID and size code of each listed sector. A sector request is then located from memory
+//                  and completed with a single seek and read.
+//
+// Credits:
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         v1.0 Oct 2026  - Initial write, index moved out of emumz.c so it can be built on the host.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "ff.h"
+#include <edsk.h>
+
+// Method to build a compact index of an EDSK image, the offset of every track and the ID/size of every sector listed in each track.
+// The image is traversed once here rather than on each sector request. Returns a single heap allocation, released with free(), or NULL
+// if the image cannot be read, has an illegal track count or there is insufficient memory.
+//
+t_edskIndex *edskBuildIndex(FIL *fp)
+{
+    // Locals.
+    //
+    uint8_t        dib[EDSK_DIB_SIZE];
+    uint8_t        tib[EDSK_TIB_SIZE];
+    uint8_t        trackSize;
+    uint8_t        sectors;
+    uint8_t        pass;
+    uint16_t       noTracks;
+    uint16_t       noSectors = 0;
+    uint16_t       idx;
+    uint16_t       sdx;
+    uint32_t       offset;
+    UINT           readSize;
+    UINT           actualReadSize;
+    t_edskIndex    *index = NULL;
+    FRESULT        result;
+
+    // Read the Disk Information Block, the track size table gives the offset of every track.
+    result = f_lseek(fp, 0);
+    if(!result)
+        result = f_read(fp, dib, EDSK_DIB_SIZE, &actualReadSize);
+    if(result || actualReadSize != EDSK_DIB_SIZE)
+        return(NULL);
+    noTracks = dib[EDSK_DIB_TRACKS] * dib[EDSK_DIB_SIDES];
+    if(noTracks == 0 || noTracks > EDSK_MAX_TRACKS)
+        return(NULL);
+
+    // Two passes, the first reads the sector count of each track to size the index, the second reads the Sector Information Lists into it.
+    for(pass = 0; pass < 2; pass++)
+    {
+        offset    = EDSK_DIB_SIZE;
+        noSectors = 0;
+        for(idx = 0; idx < noTracks; idx++)
+        {
+            trackSize = dib[EDSK_DIB_TRACK_SIZES + idx];
+
+            // Bug on HD images, track reports 0x25 sectors but this is only applicable for the first track.
+            if(idx > 0 && trackSize == 0x25) trackSize = 0x11;
+
+            // Some EDSK files have missing tracks, a request for one is an error.
+            sectors = 0;
+            if(trackSize != 0)
+            {
+                readSize = pass == 0 ? EDSK_TIB_SECTORS + 1 : EDSK_TIB_SIZE;
+                result = f_lseek(fp, offset);
+                if(!result)
+                    result = f_read(fp, tib, readSize, &actualReadSize);
+                if(result || actualReadSize != readSize)
+                {
+                    if(index != NULL) free(index);
+                    return(NULL);
+                }
+
+                // There are some wierd formats available, some report one set of sectors in the TIB which differs from the SIB and the TIB is right yet others
+                // report sectors in the TIB which differs from the SIB and the SIB is right! Work around, choose the maximum sector as the search will either find it
+                // or error out.
+                sectors = trackSize > tib[EDSK_TIB_SECTORS] ? trackSize : tib[EDSK_TIB_SECTORS];
+                if(sectors > EDSK_MAX_SIL_ENTRIES) sectors = EDSK_MAX_SIL_ENTRIES;
+            }
+
+            if(pass == 1)
+            {
+                index->track[idx].offset      = trackSize != 0 ? offset : 0;
+                index->track[idx].length      = (uint32_t)trackSize * 0x100;
+                index->track[idx].firstSector = noSectors;
+                index->track[idx].sectors     = sectors;
+                for(sdx = 0; sdx < sectors; sdx++)
+                {
+                    index->sector[noSectors + sdx].sectorId = tib[EDSK_TIB_SIL + (sdx * EDSK_SIL_ENTRY_SIZE) + EDSK_SIL_SECTOR_ID];
+                    index->sector[noSectors + sdx].sizeCode = tib[EDSK_TIB_SIL + (sdx * EDSK_SIL_ENTRY_SIZE) + EDSK_SIL_SECTOR_SIZE];
+                }
+            }
+            noSectors += sectors;
+            offset    += (uint32_t)trackSize * 0x100;
+        }
+
+        // Allocate the index as a single block, header, tracks then sectors.
+        if(pass == 0)
+        {
+            index = (t_edskIndex *)malloc(sizeof(t_edskIndex) + (noTracks * sizeof(t_edskTrack)) + (noSectors * sizeof(t_edskSector)));
+            if(index == NULL)
+                return(NULL);
+            index->noTracks  = noTracks;
+            index->noSectors = noSectors;
+            index->track     = (t_edskTrack *)(index + 1);
+            index->sector    = (t_edskSector *)(index->track + noTracks);
+        }
+    }
+    return(index);
+}
+
+// Method to locate a sector in an indexed image. The track, (track * sides) + side, is looked up and its sector list searched for the
+// sector ID, the search constrained to the track length because of the loose usage by host software of the 'sector' number and sector
+// count which differs in the TIB/SIB. On success the offset of the sector data in the image and its size are returned.
+//
+uint8_t edskLocateSector(t_edskIndex *index, uint16_t trackIdx, uint8_t sectorNo, uint32_t *offset, uint32_t *size)
+{
+    // Locals.
+    //
+    t_edskTrack    *track;
+    t_edskSector   *sector;
+    uint32_t       sectorOffset = 0;
+    uint32_t       sectorSize   = 0;
+    uint8_t        idx;
+
+    if(index == NULL || trackIdx >= index->noTracks || index->track[trackIdx].offset == 0)
+        return(EDSK_TRACK_NOT_FOUND);
+    track = &index->track[trackIdx];
+
+    for(idx = 0; idx < track->sectors && sectorOffset < track->length; idx++)
+    {
+        sector     = &index->sector[track->firstSector + idx];
+        sectorSize = sector->sizeCode == 0x00 ? 128 : sector->sizeCode == 0x01 ? 256 : sector->sizeCode == 0x02 ? 512 : 1024;
+        if(sector->sectorId == sectorNo)
+            break;
+        sectorOffset += sectorSize;
+    }
+
+    // Add in the offset to track data, which follows the Track Information Block.
+    sectorOffset += EDSK_TIB_SIZE;
+    if(idx == track->sectors || sectorOffset >= track->length)
+        return(EDSK_SECTOR_NOT_FOUND);
+
+    *offset = track->offset + sectorOffset;
+    *size   = sectorSize;
+    return(EDSK_OK);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -19,6 +19,14 @@
 //                  v1.3 Dec 2021  - Adding MZ800 logic.
 //                  v1.4 Jan 2022  - Adding floppy disk support.
 //                  v1.5 Mar 2022  - Consolidation and bug rectification.
+//                  v1.6 Oct 2026  - Floppy disk images are mapped with a FatFS cluster link map at mount
+//                                   so that random sector seeks no longer walk the FAT chain.
+//                                   EDSK images are indexed at mount, a sector request is now a single
+//                                   seek and read.
+//                  v1.7 Oct 2026  - File list read into a sorted, arena backed directory list a page at a
+//                                   time, the remaining pages read in the background. Typed characters
+//                                   build a search prefix located by binary search.
+//                                   EDSK index moved into the edsk module.
 //
 // Notes:           See Makefile to enable/disable conditional components
 //
@@ -71,7 +79,10 @@ extern "C" {
 #include <fonts.h>
 #include <bitmaps.h>
 #include <tranzputer.h>
+#include <evq.h>
 #include <osd.h>
+#include <dirlist.h>
+#include <edsk.h>
 #include <emumz.h>
 
 // Debug enable.
@@ -82,8 +93,8 @@ extern "C" {
 #define debugfx(a, ...)       if(emuControl.debug) { printf("\033[1;32m%s: " a "\033[0m\n", __func__, ##__VA_ARGS__); }
 
 // Version data.
-#define EMUMZ_VERSION       1.50
-#define EMUMZ_VERSION_DATE  "16/03/2022"
+#define EMUMZ_VERSION       1.60
+#define EMUMZ_VERSION_DATE  "16/10/2026"
 
 //////////////////////////////////////////////////////////////
 // Sharp MZ Series Emulation Service Methods                //
@@ -773,6 +784,15 @@ const static t_scanMap             mapToScanCode[] = { //          MZ-80K
 static t_emuControl          emuControl;
 static t_emuConfig           emuConfig;
 
+// Index and cluster link map of the mounted floppy disk images, built at mount time and used by the FDD service if the image name matches
+// the one mounted. The mount sequence is bumped on each mount so that the FDD service can detect a remount and reopen the image.
+static char                  fddMountFile[MZ_EMU_FDD_MAX_DISKS][MAX_FILENAME_LEN];
+static uint8_t               fddMountSeq[MZ_EMU_FDD_MAX_DISKS];
+static t_edskIndex           *fddIndex[MZ_EMU_FDD_MAX_DISKS];
+#if FF_USE_FASTSEEK == 1
+static DWORD                 *fddClmt[MZ_EMU_FDD_MAX_DISKS];
+#endif
+
 // Real time millisecond counter, interrupt driven. Needs to be volatile in order to prevent the compiler optimising it away.
 uint32_t volatile            *ms = &systick_millis_count;
 
@@ -2672,107 +2692,52 @@ void EMZProcessMenuKey(uint8_t data, uint8_t ctrl)
 //
 void EMZReleaseDirMemory(void)
 {
-    // Free up memory used by the directory name buffer from previous use prior to allocating new buffers.
+    // Free up the directory list, a directory still being read is closed and the background read finishes on its next slice.
     //
-    for(uint16_t idx=0; idx < NUMELEM(emuControl.fileList.dirEntries); idx++)
+    dirListRelease(&emuControl.fileList.dirList);
+}
+
+// Background job to read the remaining pages of a long directory. Each page is merged into the sorted list, the selected entry is
+// kept selected as entries are inserted ahead of it, and the file list redrawn if on screen.
+//
+static uint8_t EMZReadDirectoryJob(void *ctx)
+{
+    // Locals.
+    int16_t      activeRow = emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx];
+
+    if(!emuControl.fileList.dirList.scanning)
+        return(EVQ_JOB_DONE);
+
+    if(dirListScan(&emuControl.fileList.dirList, &activeRow) == FR_NOT_ENOUGH_CORE)
+        printf("Memory exhausted, directory list truncated!\n");
+    emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx] = activeRow;
+
+    if(emuControl.activeDialog == DIALOG_FILELIST)
     {
-        if(emuControl.fileList.dirEntries[idx].name != NULL)
-        {
-            free(emuControl.fileList.dirEntries[idx].name);
-            emuControl.fileList.dirEntries[idx].name = NULL;
-        }
+        EMZDrawFileList(activeRow, 0);
+        OSDRefreshScreen();
     }
+    return(emuControl.fileList.dirList.scanning ? EVQ_JOB_MORE : EVQ_JOB_DONE);
 }
 
 // Method to cache a directory contents with suitable filters in order to present a perusable list to the user via the OSD.
+// The first page is read before returning so the list can be shown straight away, the rest of a long directory is read in the background.
 //
 uint8_t EMZReadDirectory(const char *path, const char *filter)
 {
     // Locals.
-    uint16_t          dirCnt = 0;
-    uint8_t           result = 0;
-    static DIR        dirFp;
-    static FILINFO    fno;
-
-    // Release any previous memory.
-    //
-    EMZReleaseDirMemory();
+    uint8_t           result;
 
-    // Read and process the directory contents.
-    result = f_opendir(&dirFp, (char *)path);
-    if(result == FR_OK)
+    // Any previous list is released by the open.
+    emuControl.fileList.keyPrefix[0] = 0x00;
+    result = dirListOpen(&emuControl.fileList.dirList, path, filter);
+    if(result == FR_NOT_ENOUGH_CORE)
     {
-        while(dirCnt < MAX_DIRENTRY)
-        {
-            result = f_readdir(&dirFp, &fno);
-            if(result != FR_OK || fno.fname[0] == 0) break;
-
-            // Filter out none-files.
-            if(strlen(fno.fname) == 0)
-                continue;
-
-            // Filter out all files if we are just selecting directories.
-            if(!(fno.fattrib & AM_DIR) && strcmp(fno.fname, ".") == 0)
-                continue;
-
-            // Filter out files not relevant to the caller based on the provided filter.
-            const char *ext = strrchr(fno.fname, '.');
-            const char *filterExt = strrchr(filter, '.');
-printf("ext=%s, filterExt=%s, filter=%s, file=%s\n", ext, filterExt, filter, fno.fname);
-//FIX ME: Doesnt process wildcard filename           
-// ext=.dsk, filterExt=.*, filter=*.*, file=z80bcpm.dsk
-            //   Is a File                Is not a Wildcard      Filter doesnt match the extension
-            if(!(fno.fattrib & AM_DIR) && !(filterExt != NULL && strcmp(filterExt, "\.\*") == 0) && (ext == NULL || strcasecmp(++ext, (filterExt == NULL ? filter : ++filterExt)) != 0))
-                continue;
-           
-            // Filter out hidden directories.
-            if((fno.fattrib & AM_DIR) && fno.fname[0] == '.')
-                continue;
-
-            // Allocate memory for the filename and fill in the required information. 
-            if((emuControl.fileList.dirEntries[dirCnt].name = (char *)malloc(strlen(fno.fname)+1)) == NULL)
-            {
-                printf("Memory exhausted, aborting!\n");
-                return(1);
-            }
-            strcpy(emuControl.fileList.dirEntries[dirCnt].name, fno.fname);
-            emuControl.fileList.dirEntries[dirCnt].isDir = fno.fattrib & AM_DIR ? 1 : 0;
-            dirCnt++;
-        }
-
-        // Pre sort the list so it is alphabetic to speed up short key indexing.
-        //
-        uint16_t idx, idx2, idx3;
-        for(idx=0; idx < MAX_DIRENTRY; idx++)
-        {
-            if(emuControl.fileList.dirEntries[idx].name == NULL)
-                continue;
-
-            for(idx2=0; idx2 < MAX_DIRENTRY; idx2++)
-            {
-                if(emuControl.fileList.dirEntries[idx2].name == NULL)
-                    continue;
-
-                // Locate the next slot just in case the list is fragmented.
-                for(idx3=idx2+1; idx3 < MAX_DIRENTRY && emuControl.fileList.dirEntries[idx3].name == NULL; idx3++);
-                if(idx3 == MAX_DIRENTRY)
-                    break;
-
-                // Compare the 2 closest strings and swap if needed. Priority to directories as they need to appear at the top of the list.
-                if( (!emuControl.fileList.dirEntries[idx2].isDir && emuControl.fileList.dirEntries[idx3].isDir)                                                        || 
-                    (((emuControl.fileList.dirEntries[idx2].isDir  && emuControl.fileList.dirEntries[idx3].isDir) || (!emuControl.fileList.dirEntries[idx2].isDir && !emuControl.fileList.dirEntries[idx3].isDir)) && strcasecmp(emuControl.fileList.dirEntries[idx2].name, emuControl.fileList.dirEntries[idx3].name) > 0) )
-                {
-                    t_dirEntry temp = emuControl.fileList.dirEntries[idx2];
-                    emuControl.fileList.dirEntries[idx2].name  = emuControl.fileList.dirEntries[idx3].name;
-                    emuControl.fileList.dirEntries[idx2].isDir = emuControl.fileList.dirEntries[idx3].isDir;
-                    emuControl.fileList.dirEntries[idx3].name  = temp.name;
-                    emuControl.fileList.dirEntries[idx3].isDir = temp.isDir;
-                }
-            }
-        }
+        printf("Memory exhausted, aborting!\n");
+        return(1);
     }
-    if(dirCnt == 0 && result != FR_OK)
-        f_closedir(&dirFp);
+    if(result == FR_OK && emuControl.fileList.dirList.scanning)
+        evqDefer(EMZReadDirectoryJob, NULL, EVQ_USES_SDCARD | EVQ_USES_EMU);
     return(result);
 }
 
@@ -2783,12 +2748,12 @@ void EMZGetFileListBoundaries(int16_t *firstFileListRow, int16_t *lastFileListRo
     *firstFileListRow = *lastFileListRow = -1;
     *visibleRows = 0;
 
-    // Npw scan the file list elements and work out first, last and number of visible rows.
-    for(uint16_t idx=0; idx < MAX_DIRENTRY; idx++)
+    // The list is contiguous, entries 0 to count-1.
+    if(emuControl.fileList.dirList.count > 0)
     {
-        if(emuControl.fileList.dirEntries[idx].name != NULL && *firstFileListRow == -1) { *firstFileListRow = idx; }
-        if(emuControl.fileList.dirEntries[idx].name != NULL)                            { *lastFileListRow  = idx; }
-        if(emuControl.fileList.dirEntries[idx].name != NULL)                            { *visibleRows += 1; }
+        *firstFileListRow = 0;
+        *lastFileListRow  = emuControl.fileList.dirList.count - 1;
+        *visibleRows      = emuControl.fileList.dirList.count;
     }
     return;
 }
@@ -2850,42 +2815,24 @@ int16_t EMZDrawFileList(int16_t activeRow, uint8_t direction)
     if(firstFileListRow == -1 || lastFileListRow == -1 || visibleRows == 0)
         return(activeRow);
 
-    // Forward to the next active row if the one provided isnt active.
+    // Use the last active row of the directory if none provided.
     if(activeRow <= -1)
     {
-        activeRow = (emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx] < 0 || emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx] >= MAX_DIRENTRY ? 0 : emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx]);
+        activeRow = (emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx] < 0 || emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx] > lastFileListRow ? 0 : emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx]);
     }
     // Sanity check.
-    if(activeRow > MAX_DIRENTRY-1)
+    if(activeRow > lastFileListRow)
         activeRow = lastFileListRow;
-    if(emuControl.fileList.dirEntries[activeRow].name == NULL)
-    {
-        // Get the next or previous active file list row.
-        uint16_t loopCheck = MAX_DIRENTRY;
-        while(emuControl.fileList.dirEntries[activeRow].name == NULL && loopCheck > 0)
-        {
-            activeRow += (direction == 1 ? 1 : -1);
-            if(activeRow < 0) activeRow = 0;
-            if(activeRow >= MAX_DIRENTRY) activeRow = MAX_DIRENTRY-1;
-            loopCheck--;
-        }
-        if(activeRow == 0 || activeRow == MAX_DIRENTRY-1) activeRow = firstFileListRow;
-        if(activeRow == 0 || activeRow == MAX_DIRENTRY-1) activeRow = lastFileListRow;
-    }
 
     // Loop through all the visible rows and output.
-    for(uint16_t dspRow=0, fileRow=activeRow < maxRow-1 ? 0 : activeRow - (maxRow-1); fileRow < MAX_DIRENTRY; fileRow++)
+    for(uint16_t dspRow=0, fileRow=activeRow < maxRow-1 ? 0 : activeRow - (maxRow-1); fileRow <= lastFileListRow && dspRow < maxRow; fileRow++)
     {
-        // Skip inactive or hidden rows.
-        if(emuControl.fileList.dirEntries[fileRow].name == NULL)
-            continue;
-        if(dspRow >= maxRow)
-            continue;
+        const char *name = dirListName(&emuControl.fileList.dirList, fileRow);
 
         // Format the data into a single buffer for output.
         uint16_t selectionWidth = EMZGetFileListColumnWidth() - 9;
-        uint16_t nameStart      = strlen(emuControl.fileList.dirEntries[fileRow].name) > selectionWidth ? strlen(emuControl.fileList.dirEntries[fileRow].name) - selectionWidth : 0;
-        sprintf(activeBuf, " %-*s%-7s ",  selectionWidth, &emuControl.fileList.dirEntries[fileRow].name[nameStart], (emuControl.fileList.dirEntries[fileRow].isDir == 1) ? "<DIR> \x10" : "");
+        uint16_t nameStart      = strlen(name) > selectionWidth ? strlen(name) - selectionWidth : 0;
+        sprintf(activeBuf, " %-*s%-7s ",  selectionWidth, &name[nameStart], dirListIsDir(&emuControl.fileList.dirList, fileRow) ? "<DIR> \x10" : "");
 
         // Finall output the row according to selection.
         if(activeRow == fileRow) 
@@ -2930,26 +2877,41 @@ void EMZProcessFileListKey(uint8_t data, uint8_t ctrl)
         EMZSwitchToMenu(emuControl.activeMenu.menu[emuControl.activeMenu.menuIdx]);
     } else
     {
+        // Any other key ends a typed search prefix.
+        if(!isalnum(data))
+            emuControl.fileList.keyPrefix[0] = 0x00;
+
         // Process according to pressed key.
         //
         switch(data)
         {
-            // Short keys to index into the file list.
+            // Short keys to index into the file list. Characters typed in quick succession build a prefix, the list is sorted so the
+            // first entry starting with it is found by a binary search.
             case 'a' ... 'z':
             case 'A' ... 'Z':
             case '0' ... '9':
-                for(int16_t idx=0; idx < MAX_DIRENTRY; idx++)
                 {
-                    if(emuControl.fileList.dirEntries[idx].name == NULL)
-                        continue;
-    
-                    // If the key pressed is the first letter of a filename then jump to it.
-                    if((!emuControl.fileList.dirEntries[idx].isDir && emuControl.fileList.dirEntries[idx].name[0] == tolower(data)) || emuControl.fileList.dirEntries[idx].name[0] == toupper(data))
+                    uint8_t  len = strlen(emuControl.fileList.keyPrefix);
+                    int16_t  idx;
+
+                    if(*ms - emuControl.fileList.keyPrefixTime > KEY_PREFIX_TIMEOUT || len >= MAX_KEY_PREFIX)
+                        len = 0;
+                    emuControl.fileList.keyPrefix[len++] = data;
+                    emuControl.fileList.keyPrefix[len]   = 0x00;
+                    emuControl.fileList.keyPrefixTime    = *ms;
+
+                    // No entry starts with the longer prefix, start again with the key just pressed.
+                    if((idx = dirListFind(&emuControl.fileList.dirList, emuControl.fileList.keyPrefix)) < 0 && len > 1)
+                    {
+                        emuControl.fileList.keyPrefix[0] = data;
+                        emuControl.fileList.keyPrefix[1] = 0x00;
+                        idx = dirListFind(&emuControl.fileList.dirList, emuControl.fileList.keyPrefix);
+                    }
+                    if(idx >= 0)
                     {
                         emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx] = idx;
                         EMZDrawFileList(emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx], 0);
                         OSDRefreshScreen();
-                        break;
                     }
                 }
                 break;
@@ -2970,7 +2932,7 @@ void EMZProcessFileListKey(uint8_t data, uint8_t ctrl)
                 // Shift Down pressed?
                 if(ctrl & KEY_SHIFT_BIT)
                 {
-                    emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx] = emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx] + maxRow -1 > 0 ? emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx] + maxRow -1 : MAX_DIRENTRY-1;
+                    emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx] = emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx] + maxRow -1 > 0 ? emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx] + maxRow -1 : emuControl.fileList.dirList.count-1;
                 }
                 emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx] = EMZDrawFileList(++emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx], 1);
                 OSDRefreshScreen();
@@ -2992,19 +2954,19 @@ void EMZProcessFileListKey(uint8_t data, uint8_t ctrl)
             // Carriage Return - action or select sub directory.
             case 0x0D:
             case 0xA3: // Right Key
-                if(emuControl.fileList.dirEntries[emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx]].name != NULL)
+                if(dirListName(&emuControl.fileList.dirList, emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx]) != NULL)
                 {
                     // If selection is chosen by CR on a path, execute the return callback to process the path and return control to the menu system.
                     //
-                    if(data == 0x0D && emuControl.fileList.selectDir && emuControl.fileList.dirEntries[emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx]].isDir && emuControl.fileList.returnCallback != NULL)
+                    if(data == 0x0D && emuControl.fileList.selectDir && dirListIsDir(&emuControl.fileList.dirList, emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx]) && emuControl.fileList.returnCallback != NULL)
                     {
-                        sprintf(tmpbuf, "%s\%s", emuControl.activeDir.dir[emuControl.activeDir.dirIdx], emuControl.fileList.dirEntries[emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx]].name);
+                        sprintf(tmpbuf, "%s\%s", emuControl.activeDir.dir[emuControl.activeDir.dirIdx], dirListName(&emuControl.fileList.dirList, emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx]));
                         emuControl.fileList.returnCallback(tmpbuf);
                         EMZSwitchToMenu(emuControl.activeMenu.menu[emuControl.activeMenu.menuIdx]);
                     }
                     // If selection is on a directory, increase the menu depth, read the directory and refresh the file list.
                     //
-                    else if(emuControl.fileList.dirEntries[emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx]].isDir && emuControl.activeDir.dirIdx+1 < MAX_DIR_DEPTH)
+                    else if(dirListIsDir(&emuControl.fileList.dirList, emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx]) && emuControl.activeDir.dirIdx+1 < MAX_DIR_DEPTH)
                     {
                         emuControl.activeDir.dirIdx++;
                         if(emuControl.activeDir.dir[emuControl.activeDir.dirIdx] != NULL)
@@ -3014,11 +2976,11 @@ void EMZProcessFileListKey(uint8_t data, uint8_t ctrl)
                         }
                         if(emuControl.activeDir.dirIdx == 1)
                         {
-                            sprintf(tmpbuf, "0:\\%s", emuControl.fileList.dirEntries[emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx-1]].name);
+                            sprintf(tmpbuf, "0:\\%s", dirListName(&emuControl.fileList.dirList, emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx-1]));
                         }
                         else
                         {
-                            sprintf(tmpbuf, "%s\\%s", emuControl.activeDir.dir[emuControl.activeDir.dirIdx-1], emuControl.fileList.dirEntries[emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx-1]].name);
+                            sprintf(tmpbuf, "%s\\%s", emuControl.activeDir.dir[emuControl.activeDir.dirIdx-1], dirListName(&emuControl.fileList.dirList, emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx-1]));
                         }
                         if((emuControl.activeDir.dir[emuControl.activeDir.dirIdx] = (char *)malloc(strlen(tmpbuf)+1)) == NULL)
                         {
@@ -3042,9 +3004,9 @@ void EMZProcessFileListKey(uint8_t data, uint8_t ctrl)
                         }
                     }
                     // If the selection is on a file, execute the return callback to process the file and return control to the menu system.
-                    else if(emuControl.fileList.returnCallback != NULL && !emuControl.fileList.dirEntries[emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx]].isDir)
+                    else if(emuControl.fileList.returnCallback != NULL && !dirListIsDir(&emuControl.fileList.dirList, emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx]))
                     {
-                        sprintf(tmpbuf, "%s\\%s", emuControl.activeDir.dir[emuControl.activeDir.dirIdx], emuControl.fileList.dirEntries[emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx]].name);
+                        sprintf(tmpbuf, "%s\\%s", emuControl.activeDir.dir[emuControl.activeDir.dirIdx], dirListName(&emuControl.fileList.dirList, emuControl.activeDir.activeRow[emuControl.activeDir.dirIdx]));
                         emuControl.fileList.returnCallback(tmpbuf);
                         EMZSwitchToMenu(emuControl.activeMenu.menu[emuControl.activeMenu.menuIdx]);
                     }
@@ -3094,12 +3056,9 @@ void EMZLoadDirectToRAM(enum ACTIONMODE mode)
         EMZReadDirectory(emuControl.activeDir.dir[emuControl.activeDir.dirIdx], emuControl.fileList.fileFilter);
         EMZRefreshFileList();
 
-        for(uint16_t idx=0; idx < MAX_DIRENTRY; idx++)
+        for(uint16_t idx=0; idx < emuControl.fileList.dirList.count; idx++)
         {
-            if(emuControl.fileList.dirEntries[idx].name != NULL)
-            {
-                printf("%-40s%s\n", emuControl.fileList.dirEntries[idx].name, emuControl.fileList.dirEntries[idx].isDir == 1 ? "<DIR>" : "");
-            }
+            printf("%-40s%s\n", dirListName(&emuControl.fileList.dirList, idx), dirListIsDir(&emuControl.fileList.dirList, idx) ? "<DIR>" : "");
         }
 
         // Switch to the File List Dialog mode setting the return Callback which will be activated after a file has been chosen.
@@ -5213,6 +5172,46 @@ short EMZCheckFDDImage(char *fileName)
     return(imgType);
 }
 
+// Method to prepare an open floppy disk image for the FDD service, releasing the index and map of any previous image on the drive.
+// An EDSK image is indexed and, when fast seek is enabled, a cluster link map is created and left attached to the file.
+//
+short EMZMapFDDImage(FIL *fp, uint8_t driveNo, char *fileName, enum IMAGETYPES imgType)
+{
+    // Release the previous image.
+    if(fddIndex[driveNo] != NULL)
+    {
+        free(fddIndex[driveNo]);
+        fddIndex[driveNo] = NULL;
+    }
+  #if FF_USE_FASTSEEK == 1
+    if(fddClmt[driveNo] != NULL)
+    {
+        free(fddClmt[driveNo]);
+        fddClmt[driveNo] = NULL;
+    }
+  #endif
+    fddMountFile[driveNo][0] = 0x00;
+    fddMountSeq[driveNo]++;
+
+  #if FF_USE_FASTSEEK == 1
+    // Map the image clusters first so the index is built using fast seeks.
+    if(createFastSeekMap(fp) == FR_OK)
+        fddClmt[driveNo] = fp->cltbl;
+  #endif
+
+    if(imgType == IMAGETYPE_EDSK)
+    {
+        fddIndex[driveNo] = edskBuildIndex(fp);
+        if(fddIndex[driveNo] == NULL)
+        {
+            debugf("Failed to index image:%s", fileName);
+            return(-1);
+        }
+    }
+    strcpy(fddMountFile[driveNo], fileName);
+    return(0);
+}
+
 // A method to retrieve the floppy definitions from the image and if valid, store in the configuration.
 short EMZSetFDDImageParams(char *fileName, uint8_t driveNo, enum IMAGETYPES imgType)
 {
@@ -5341,11 +5340,20 @@ printf("SectorSize:%08lx,%02x\n", sectorSize, tmpBuf[4]);
         return(-1);
     }    
 
-    // Set parameters on success.
-    strcpy(emuConfig.params[emuConfig.machineModel].fdd[driveNo].fileName, fileName);
+    // Index and map the image for the FDD service, which would otherwise traverse the image on every sector request. The map is owned
+    // by the drive, detach it before closing.
+    idx = EMZMapFDDImage(&fileDesc, driveNo, fileName, imgType) == -1 ? 0 : 1;
+  #if FF_USE_FASTSEEK == 1
+    fileDesc.cltbl = NULL;
+  #endif
 
     // Close image to exit.
     f_close(&fileDesc);
+    if(idx == 0)
+        return(-1);
+
+    // Set parameters on success.
+    strcpy(emuConfig.params[emuConfig.machineModel].fdd[driveNo].fileName, fileName);
 
     // Success.
     return(0);
@@ -5360,18 +5368,13 @@ enum FLOPPYERRORCODES EMZProcessFDDRequest(uint8_t ctrlReg, uint8_t trackNo, uin
     static FIL        fileDesc[MZ_EMU_FDD_MAX_DISKS];
     static uint8_t    opened;
     static uint8_t    dirty;
-    static uint8_t    lastTrack[MZ_EMU_FDD_MAX_DISKS]   = {0xff, 0xff, 0xff, 0xff};
-    static uint8_t    lastSide[MZ_EMU_FDD_MAX_DISKS]    = {0xff, 0xff, 0xff, 0xff};
-    static uint32_t   trackOffset[MZ_EMU_FDD_MAX_DISKS] = {0, 0, 0, 0};
-    static uint32_t   trackLen[MZ_EMU_FDD_MAX_DISKS]    = {0, 0, 0, 0};
-    static uint8_t    sectorCount[MZ_EMU_FDD_MAX_DISKS];
+    static uint8_t    openedSeq[MZ_EMU_FDD_MAX_DISKS];
     uint8_t           driveNo         = ((ctrlReg & FDD_IOP_DISK_SELECT_NO) >> 5) & 0x03;
     uint8_t           noSides         = FLOPPY_DEFINITIONS[emuConfig.params[emuConfig.machineModel].fdd[driveNo].diskType].heads;
     uint8_t           side            = ctrlReg & FDD_IOP_SIDE ? 1 : 0;
     uint8_t           sectorsPerTrack = FLOPPY_DEFINITIONS[emuConfig.params[emuConfig.machineModel].fdd[driveNo].diskType].sectors;
     uint8_t           cmd             = (ctrlReg & FDD_IOP_SERVICE_REQ) == 0 ? FDD_IOP_REQ_NOP : ctrlReg & FDD_IOP_REQ_MODE;
     uint8_t           sectorBuffer[1024];
-    uint8_t           idx;
   //  uint16_t          sectorSize      = FLOPPY_DEFINITIONS[emuConfig.params[emuConfig.machineModel].fdd[driveNo].diskType].sectorSize;
     uint32_t          actualReadSize;
     uint32_t          sectorOffset;
@@ -5386,6 +5389,16 @@ printf("Drive No:%d, %02x, %d\n", driveNo, ctrlReg & FDD_IOP_SERVICE_REQ, emuCon
         //
         if(emuConfig.params[emuConfig.machineModel].fdd[driveNo].mounted)
         {
+            // If the image has been remounted since it was opened, close it so the new image, its index and map are used.
+            if(((opened >> driveNo) & 0x01) && openedSeq[driveNo] != fddMountSeq[driveNo])
+            {
+              #if FF_USE_FASTSEEK == 1
+                fileDesc[driveNo].cltbl = NULL;
+              #endif
+                f_close(&fileDesc[driveNo]);
+                opened &= ~(1 << driveNo);
+            }
+
             // If the disk hasnt yet been opened, open to save time on next sector requests.
             if(!((opened >> driveNo) & 0x01))
             {
@@ -5396,6 +5409,24 @@ printf("Opening disk:%s,%d\n", emuConfig.params[emuConfig.machineModel].fdd[driv
                     debugf("[open] File:%s, error: %d.\n", emuConfig.params[emuConfig.machineModel].fdd[driveNo].fileName, fileDesc[driveNo]);
                     return(FLPYERR_DISK_ERROR);
                 } 
+
+                // Use the index and map built at mount time. If the image was mounted by other means, ie. a configuration load, build them now.
+                if(strcmp(fddMountFile[driveNo], emuConfig.params[emuConfig.machineModel].fdd[driveNo].fileName) == 0)
+                {
+                  #if FF_USE_FASTSEEK == 1
+                    fileDesc[driveNo].cltbl = fddClmt[driveNo];
+                  #endif
+                } else
+                if(EMZMapFDDImage(&fileDesc[driveNo], driveNo, emuConfig.params[emuConfig.machineModel].fdd[driveNo].fileName, emuConfig.params[emuConfig.machineModel].fdd[driveNo].imgType) == -1)
+                {
+                  #if FF_USE_FASTSEEK == 1
+                    fileDesc[driveNo].cltbl = NULL;
+                  #endif
+                    f_close(&fileDesc[driveNo]);
+                    return(FLPYERR_DISK_ERROR);
+                }
+                openedSeq[driveNo] = fddMountSeq[driveNo];
+
                 // Mark drive as being opened.
                 opened |= 1 << driveNo;
             }
@@ -5403,136 +5434,16 @@ printf("Opening disk:%s,%d\n", emuConfig.params[emuConfig.machineModel].fdd[driv
             // Locate sector according to image type.
             if(emuConfig.params[emuConfig.machineModel].fdd[driveNo].imgType == IMAGETYPE_EDSK)
             {
-                // If track or side has changed (or first call as lastTrack = 255), calculate the track offset position.
-                // This is necessary as the track length can vary from track to track, side to side.
-                if(trackNo != lastTrack[driveNo] || side != lastSide[driveNo])
+                // The image was indexed when mounted, lookup the track then search its sector list for the requested sector ID.
+                switch(edskLocateSector(fddIndex[driveNo], (trackNo * noSides) + side, sectorNo, &sectorOffset, &thisSectorSize))
                 {
-                    // Seek to the track information block, get initial sector count to calculate the track length, then back to the start to iterate tracks.
-                    result = f_lseek(&fileDesc[driveNo], 0x34);
-                //    if(!result) result = f_read(&fileDesc, &sectorBuffer, 2, &actualReadSize);
-                //    if(!result) result = f_lseek(&fileDesc[driveNo], 0x34);
-                    if(result)
-                    {
-                        debugf("Failed to seek to start of TIB:%d, sector:%d, drive:%d", trackNo, sectorNo, driveNo);
-                        return(FLPYERR_TRACK_NOT_FOUND);
-                    }
-
-                    // Go to track and retrieve the sector information.
-                    trackLen[driveNo] = 0x0100;
-                    trackOffset[driveNo] = 0x00000000;
-                    for(idx = 0; idx == 0 || idx <= (trackNo * noSides)+side; idx++)
-                    {
-                        result = f_read(&fileDesc[driveNo], &sectorBuffer, 1, &actualReadSize);
-                        if(actualReadSize != 1)
-                        {
-                            debugf("Failed to traverse track structure:%d", trackNo);
-                            return(FLPYERR_TRACK_NOT_FOUND);
-                        }
-
-                        // Bug on HD images, track reports 0x25 sectors but this is only applicable for the first track.
-                        if(idx > 0 && sectorBuffer[0] == 0x25) sectorBuffer[0] = 0x11;
-
-                    //    if(idx == 0)
-                    //    {
-                    //        // Disk Information Block size.
-                    //        trackOffset[driveNo] = 0x100;
-                    //    } else
-                    //    {
-                    //        trackOffset[driveNo] += sectorBuffer[0] * 0x100;
-                   //     }
-                        trackOffset[driveNo] += trackLen[driveNo];
-                        trackLen[driveNo] = (uint32_t)sectorBuffer[0] * 0x100;
-//printf("idx=%d,%08lx:%02x:%08lx,\n", idx,trackOffset[driveNo], sectorBuffer[0], trackLen[driveNo]);
-                    }
-                    // Get next track length for Side 1 offset addition.
-               //     result = f_read(&fileDesc[driveNo], &sectorBuffer, 1, &actualReadSize);
-               //     if(result)
-               //     {
-               //         debugf("Failed to seek to start of TIB:%d, sector:%d, drive:%d", trackNo, sectorNo, driveNo);
-               //         return(FLPYERR_TRACK_NOT_FOUND);
-               //     }
-               //     trackLen[driveNo] = (uint32_t)sectorBuffer[0] * 0x100;
-                    // Check to see if the track exists, some EDSK files have missing tracks and a request for one is an error.
-                    //
-                    if(sectorBuffer[0] == 0x00)
-                    {
+                    case EDSK_TRACK_NOT_FOUND:
                         debugf("Track doesnt exist (%d,%d), bad image:%s", side, trackNo, emuConfig.params[emuConfig.machineModel].fdd[driveNo].fileName);
                         return(FLPYERR_TRACK_NOT_FOUND);
-                    }
-                    uint8_t sectorCountFromTIB = sectorBuffer[0];
-
-                    // Read the sector count for this track,
-                    result = f_lseek(&fileDesc[driveNo], trackOffset[driveNo] + 0x14);
-                    if(!result)
-                        result = f_read(&fileDesc[driveNo], &sectorBuffer, 2, &actualReadSize);
-                    if(result)
-                    {
-                        debugf("Failed to seek to sector count in TIB:%d, sector:%d, trackOffset:%04x, drive:%d", trackNo, sectorNo, trackOffset[driveNo], driveNo);
-                        return(FLPYERR_TRACK_NOT_FOUND);
-                    }
-                    // There are some wierd formats available, some report one set of sectors in the TIB which differes from the SIB and the TIB is right yet others
-                    // report sectors in the TIB which differs from the SIB and the SIB is right! Work around, choose the maximum sector as the loop below will either find it or error out.
-                    sectorCount[driveNo] = (uint8_t)sectorCountFromTIB > (uint8_t)sectorBuffer[1] ? (uint8_t)sectorCountFromTIB : (uint8_t)sectorBuffer[1];
-printf("trackLen=%08lx, trackOffset=%08lx, sectorCount=%d, %02x,%02x\n", trackLen[driveNo], trackOffset[driveNo], sectorCount[driveNo], sectorBuffer[0], sectorBuffer[1]);
-                    thisSectorSize = sectorBuffer[0] == 0x00 ? 128 : sectorBuffer[0] == 0x01 ? 256 : sectorBuffer[0] == 0x02 ? 512 : 1024;
-printf("%02x,%02x trackOffset:%08lx, side:%d, thisSectorSize:%d\n", sectorBuffer[0], sectorBuffer[1], trackOffset[driveNo], side, thisSectorSize);
-printf("trackLen:%08lx\n", trackLen[driveNo]);
-
-                    // Store track and side so this section is skipped if we remain on a track and side.
-                    lastTrack[driveNo] = trackNo;
-                    lastSide[driveNo] = side;
-                }
-              
-           //     // Check sector requested against sector available, error if request is greater.
-           //     //
-           //     if(sectorNo > sectorCount)
-           //     {
-           //         debugf("Requested sector (%d) greater than track max sector (%d), drive:%d", sectorNo, sectorCount, driveNo);
-           //         return(FLPYERR_SECTOR_NOT_FOUND);
-           //     }
-
-                // Traverse the sector list to find the required sector.
-                sectorOffset = trackOffset[driveNo]; // + (side ? trackLen[driveNo] : 0);
-                uint32_t offsetLimit = sectorOffset + trackLen[driveNo];
-                
-                // Seek to the Sector Information List for this track.
-                result = f_lseek(&fileDesc[driveNo], sectorOffset + 0x18); //trackOffset[driveNo] + (side ? trackLen[driveNo] : 0) + 0x18);
 
-                // Loop through the SIL looking for a sector/head match. Constrain the search to a maximum track length of data. This check is in place
-                // because of the loose usage by host software of the 'sector' number and sector count which differs in the TIB/SIB.
-                //sectorOffset += 0x0100;
-                for(idx = 1; idx <= sectorCount[driveNo] && sectorOffset < offsetLimit; idx++)
-                {
-                    if(!result) result = f_read(&fileDesc[driveNo], &sectorBuffer, 8, &actualReadSize);
-                    if(result)
-                    {
-                        debugf("Failed to seek and read the Sector Information List for track:%d, sector:%d", trackNo, sectorNo);
+                    case EDSK_SECTOR_NOT_FOUND:
+                        debugf("Sector not found, Track:%d, Sector:%d", trackNo, sectorNo);
                         return(FLPYERR_SECTOR_NOT_FOUND);
-                    }
-//printf("%d:%d:%d,%02x,%02x,%08lx\n", idx, sectorNo, side, sectorBuffer[2], sectorBuffer[1], sectorOffset);
-
-                    thisSectorSize = sectorBuffer[3] == 0x00 ? 128 : sectorBuffer[3] == 0x01 ? 256 : sectorBuffer[3] == 0x02 ? 512 : 1024;
-                    if(sectorBuffer[2] == sectorNo)
-                    {
-                     //   // Check the sector size for mismatch - if any found then this code needs to be updated to change the controller size parameter dynamically.
-                     //   if(thisSectorSize != sectorSize)
-                     //   {
-                     //       debugf("Sector size mismatch, Track:%d, Sector:%d, DefSize:%d, ReadSize:%d", trackNo, sectorNo, sectorSize, thisSectorSize);
-                     //       return(FLPYERR_SECTOR_NOT_FOUND);
-                     //   }
-                       // sectorOffset += 0x100; //thisSectorSize;
-                        break;
-                    }
-                    sectorOffset += thisSectorSize;
-                }
-                // Add in the offset to track data, which is 256 bytes from the Track Information Block.
-                sectorOffset += 0x100;
-printf("Offset End:%08lx,idx=%d,sectorCount=%d\n", sectorOffset, idx, sectorCount[driveNo]+1);
-                // Not found?
-                if(idx == sectorCount[driveNo]+1 || sectorOffset >= offsetLimit)
-                {
-                    debugf("Sector not found, Track:%d, Sector:%d", trackNo, sectorNo);
-                    return(FLPYERR_SECTOR_NOT_FOUND);
                 }
             } else
 
@@ -5605,10 +5516,13 @@ printf("Check2:%08lx, %08lx, %08lx, %08lx\n", sectorSize, *sectorSize, rotationa
             if(opened >> idx)
             {
 printf("Closing disk:%d\n", idx);
+              #if FF_USE_FASTSEEK == 1
+                // The map is owned by the mount, detach it before closing.
+                fileDesc[idx].cltbl = NULL;
+              #endif
                 f_close(&fileDesc[idx]);
                 opened &= ~(1 << idx);
                 dirty  &= ~(1 << idx);
-                lastTrack[idx] = 0xff;
             }
         }
     }
@@ -0,0 +1,282 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            evq.c
+// Created:         Oct 2026
+// Version:         v1.1
+// Author(s):       Philip Smart
+// Description:     tranZPUter event queue.
+//                  The zOS service loop used to poll flags set by the interrupt handlers, taking one event per
+//                  pass and running the emulator scheduling on every idle pass. Events are now posted by the
+//                  interrupt handlers, with the cycle counter as timestamp, into a small fixed priority queue,
+//                  one entry per event type as an event is level driven and coalesces until served. The
+//                  dispatcher runs every pending event, highest priority first, each handler running to
+//                  completion, and only when nothing is pending gives a slice to a deferred background job.
+//                  Long operations, a directory cache build or ROM load, call evqYield between chunks. Each
+//                  handler, job and yielding operation declares the resources it uses; a pending event runs
+//                  at a yield point or beside a job only when its resources are free, so no handler is ever
+//                  re-entered or run over a resource in use.
+//
+// Credits:
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         v1.0 Oct 2026  - Initial write.
+//                  v1.1 Oct 2026  - Timer tick event removed, it had no handler. A pending event can
+//                                   be dropped if it was posted before a given time.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#if defined(__K64F__)
+  #include <core_pins.h>
+#endif
+#include <evq.h>
+
+// Queue state, the posted flags and times are shared with the interrupt handlers.
+//
+t_evqControl                         evqControl;
+
+static const char                    *evqNames[EVQ_EVENTS] = { "reset", "svcreq", "sysreq", "ioevent" };
+
+// Method to initialise the queue, all events discarded and no jobs. The cycle counter used for the timestamps is enabled.
+//
+void evqInit(void)
+{
+    memset(&evqControl, 0x00, sizeof(t_evqControl));
+  #if defined(__K64F__)
+    ARM_DEMCR    |= ARM_DEMCR_TRCENA;
+    ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+  #endif
+    return;
+}
+
+// Method to set the handler of an event and the resources it uses. A NULL handler discards the event.
+//
+void evqRegister(enum EVQ_EVENT event, t_evqHandler handler, uint8_t uses)
+{
+    evqControl.handler[event] = handler;
+    evqControl.uses[event]    = uses;
+    return;
+}
+
+// Method to post an event from code, the interrupt handlers post directly. An event already pending keeps its first post time.
+//
+void evqPost(enum EVQ_EVENT event)
+{
+    if(!evqControl.posted[event])
+    {
+        evqControl.postedAt[event] = EVQ_CLOCK;
+        evqControl.posted[event]   = 1;
+    }
+    return;
+}
+
+// Method to test for a pending event.
+//
+uint8_t evqPending(enum EVQ_EVENT event)
+{
+    return(evqControl.posted[event]);
+}
+
+// Method to drop a pending event without running its handler.
+//
+void evqClear(enum EVQ_EVENT event)
+{
+    evqControl.posted[event] = 0;
+    return;
+}
+
+// Method to drop a pending event posted before the given EVQ_CLOCK time, one posted since is kept. Returns 1 if the event was dropped.
+//
+uint8_t evqClearBefore(enum EVQ_EVENT event, uint32_t time)
+{
+    if(evqControl.posted[event] && (int32_t)(evqControl.postedAt[event] - time) < 0)
+    {
+        evqControl.posted[event] = 0;
+        return(1);
+    }
+    return(0);
+}
+
+// Method to defer a background job, run a slice at a time when no event is pending. A job already deferred with the same argument
+// is not added twice. Returns 0 on success, 1 if the job table is full.
+//
+uint8_t evqDefer(t_evqJob job, void *ctx, uint8_t uses)
+{
+    // Locals.
+    t_evqJobSlot *slot = NULL;
+
+    for(uint8_t idx=0; idx < EVQ_MAX_JOBS; idx++)
+    {
+        if(evqControl.jobs[idx].job == job && evqControl.jobs[idx].ctx == ctx)
+            return(0);
+        if(slot == NULL && evqControl.jobs[idx].job == NULL)
+            slot = &evqControl.jobs[idx];
+    }
+    if(slot == NULL)
+        return(1);
+    slot->job  = job;
+    slot->ctx  = ctx;
+    slot->uses = uses;
+    return(0);
+}
+
+// Internal method to run the handler of a pending event, recording its latency and run time.
+//
+static void evqRun(uint8_t event, uint8_t nested)
+{
+    // Locals.
+    t_evqStats *stats = &evqControl.stats[event];
+    uint8_t    held   = evqControl.held;
+    uint32_t   postedAt;
+    uint32_t   start;
+    uint32_t   latency;
+    uint32_t   run;
+    uint32_t   limit;
+    uint8_t    bucket;
+
+    // Taken off the queue before the handler starts so a post during the handler is served afterwards.
+    postedAt                 = evqControl.postedAt[event];
+    evqControl.posted[event] = 0;
+    start                    = EVQ_CLOCK;
+    latency                  = (start - postedAt) / EVQ_CLOCKS_PER_US;
+    for(bucket=0, limit=4; bucket < EVQ_HIST_BUCKETS-1 && latency >= limit; bucket++, limit <<= 2);
+    stats->hist[bucket]++;
+    stats->count++;
+    if(nested)
+        stats->nested++;
+    if(latency > stats->maxLatencyUs)
+        stats->maxLatencyUs = latency;
+
+    if(evqControl.handler[event] != NULL)
+    {
+        evqControl.running |= (1 << event);
+        evqControl.held    |= evqControl.uses[event];
+        evqControl.handler[event]();
+        evqControl.held     = held;
+        evqControl.running &= ~(1 << event);
+
+        run = (EVQ_CLOCK - start) / EVQ_CLOCKS_PER_US;
+        if(run > stats->maxRunUs)
+            stats->maxRunUs = run;
+    }
+    return;
+}
+
+// Internal method to run the pending events whose resources are free, highest priority first. After each handler the scan restarts
+// at the top so an event posted during a handler is taken in priority order, each event runs at most once per call so an event which
+// is posted continuously cannot hold the caller.
+//
+static uint8_t evqRunPending(uint8_t nested)
+{
+    // Locals.
+    uint8_t    done    = 0;
+    uint8_t    handled = 0;
+    uint8_t    event   = 0;
+
+    while(event < EVQ_EVENTS)
+    {
+        if(evqControl.posted[event] && !(done & (1 << event)) && !(evqControl.running & (1 << event)) && !(evqControl.uses[event] & evqControl.held))
+        {
+            evqRun(event, nested);
+            done |= (1 << event);
+            handled++;
+            event = 0;
+        } else
+        {
+            event++;
+        }
+    }
+    return(handled);
+}
+
+// Method to run the event queue, called from the service loop. All pending events are run and, if there were none, the next
+// background job gets a slice. Returns the number of events handled.
+//
+uint8_t evqDispatch(void)
+{
+    // Locals.
+    uint8_t       handled;
+    t_evqJobSlot  *slot;
+
+    handled = evqRunPending(0);
+    if(handled == 0)
+    {
+        for(uint8_t idx=0; idx < EVQ_MAX_JOBS; idx++)
+        {
+            slot = &evqControl.jobs[evqControl.nextJob];
+            evqControl.nextJob = (evqControl.nextJob + 1) % EVQ_MAX_JOBS;
+            if(slot->job != NULL && !(slot->uses & evqControl.held))
+            {
+                // The job holds its resources for the slice, a finished job is only removed if it did not replace itself.
+                uint8_t  held = evqControl.held;
+                t_evqJob job  = slot->job;
+
+                evqControl.held |= slot->uses;
+                evqControl.jobSlices++;
+                if(job(slot->ctx) == EVQ_JOB_DONE && slot->job == job)
+                    slot->job = NULL;
+                evqControl.held  = held;
+                break;
+            }
+        }
+    }
+    return(handled);
+}
+
+// Method for a long operation to call between chunks of work. Pending events which use none of the resources held by the operation,
+// or by whatever it was called from, are run. Returns the number of events handled.
+//
+uint8_t evqYield(uint8_t holding)
+{
+    // Locals.
+    uint8_t   held = evqControl.held;
+    uint8_t   handled;
+
+    evqControl.yields++;
+    evqControl.held |= holding;
+    handled = evqRunPending(1);
+    evqControl.held  = held;
+    return(handled);
+}
+
+// Method to clear the statistics.
+//
+void evqResetStats(void)
+{
+    memset(evqControl.stats, 0x00, sizeof(evqControl.stats));
+    evqControl.jobSlices = 0;
+    evqControl.yields    = 0;
+    return;
+}
+
+// Method to return the name of an event.
+//
+const char *evqName(enum EVQ_EVENT event)
+{
+    return(event < EVQ_EVENTS ? evqNames[event] : "?");
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -81,6 +81,14 @@ void DisableInterrupt(uint32_t intrMask)
   #endif
 }
 
+// Method to change the interrupt setting from within an interrupt handler. The controller is left disabled,
+// the new setting is applied when the handler calls EnableInterrupts on exit.
+//
+void UpdateInterruptSetting(uint32_t setMask, uint32_t clearMask)
+{
+    intrSetting = (intrSetting & ~clearMask) | setMask;
+}
+
 // Method to disable interrupts.
 //
 inline void DisableInterrupts(void)
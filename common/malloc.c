@@ -210,7 +210,7 @@ void *malloc(size_t size)
 #endif
 
 	fp = (struct free_arena_header *)_sbrk(fsize);
-	if(fp==0 || fp == -1)
+	if(fp==0 || fp == (struct free_arena_header *)-1)
 		return(NULL);
 
 	/* Insert the block into the management chains.  We need to set
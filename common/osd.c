@@ -15,6 +15,10 @@
 // Copyright:       (c) 2019-2021 Philip Smart <philip.smart@net2net.org>
 //
 // History:         v1.0 May 2021  - Initial write of the OSD software.
+//                  v1.1 Oct 2026  - Dirty span tracking per colour plane, a refresh only sends the changed
+//                                   bytes to the FPGA.
+//                  v1.2 Oct 2026  - Glyph cache of fonts pre-rotated to the orientation in use, strings are
+//                                   blitted a row at a time writing whole bytes per colour plane.
 //
 // Notes:           See Makefile to enable/disable conditional components
 //
@@ -81,11 +85,16 @@ static t_OSDWindow    osdWindow    = {.mode=MENU, .params={ {.attr=0,  .row=0,
                                                              .cursor={.flashing=0, .enabled=0}
                                                             } 
                                                           },
-                                      .debug=0, .inDebug=0, .display=NULL};
+                                      .debug=0, .inDebug=0, .display=NULL, .refreshBytes=0, .refreshTotalBytes=0, .refreshCount=0};
 
 // Real time millisecond counter, interrupt driven. Needs to be volatile in order to prevent the compiler optimising it away.
 uint32_t volatile            *msecs = &systick_millis_count;
 
+// Fonts pre-rotated for the string blitter.
+static t_OSDGlyphCache       osdGlyphCache[OSD_GLYPH_SLOTS];
+static uint32_t              osdGlyphSeq    = 0;
+static uint32_t              osdGlyphBuilds = 0;
+
 // Method to get internal public member values. This module ideally should be written in C++ but with the limitations of the GNU C Compiler for the ZPU (v3.4.2) and the performance penalty on
 // an embedded processor, it was decided to write it in C but the methodology and naming conventions (ie. OSDDrawLine = OSD.DrawLine, OSDInit = OSD::OSD constructor) are kept loosly 
 // associated with C++. Ideally for this getter method function overloading is required!
@@ -106,6 +115,22 @@ uint32_t OSDGet(enum OSDPARAMS param)
             result = (uint32_t)osdWindow.params[osdWindow.mode].maxY;
             break;
 
+        case REFRESH_BYTES:
+            result = osdWindow.refreshBytes;
+            break;
+
+        case REFRESH_TOTAL_BYTES:
+            result = osdWindow.refreshTotalBytes;
+            break;
+
+        case REFRESH_COUNT:
+            result = osdWindow.refreshCount;
+            break;
+
+        case GLYPH_CACHE_BUILDS:
+            result = osdGlyphBuilds;
+            break;
+
         default:
             result = 0xFFFFFFFF;
             break;
@@ -125,24 +150,24 @@ fontStruct *OSDGetFont(enum FONTS font)
     switch(font)
     {
         case FONT_3X6:
-            fontptr = &font3x6;
+            fontptr = (fontStruct *)&font3x6;
             break;
 
         case FONT_7X8:
-            fontptr = &font7x8extended;
+            fontptr = (fontStruct *)&font7x8extended;
             break;
 
         case FONT_9X16:
-            fontptr = &font9x16;
+            fontptr = (fontStruct *)&font9x16;
             break;
             
         case FONT_11X16:
-            fontptr = &font11x16;
+            fontptr = (fontStruct *)&font11x16;
             break;
 
         case FONT_5X7:
         default:
-            fontptr = &font5x7extended;
+            fontptr = (fontStruct *)&font5x7extended;
             break;
     }
     return(fontptr);
@@ -154,22 +179,22 @@ bitmapStruct *OSDGetBitmap(enum BITMAPS bitmap)
 {
     // Locals.
     //
-    fontStruct    *bitmapptr;
+    bitmapStruct  *bitmapptr;
 
     // Obtain the bitmap structure based on the provided type.
     switch(bitmap)
     {
         case BITMAP_ARGO_SMALL:
-            bitmapptr = &argo64x32;
+            bitmapptr = (bitmapStruct *)&argo64x32;
             break;
 
         case BITMAP_ARGO_MEDIUM:
-            bitmapptr = &argo128x64;
+            bitmapptr = (bitmapStruct *)&argo128x64;
             break;
 
         case BITMAP_ARGO:
         default:
-            bitmapptr = &argo256x128;
+            bitmapptr = (bitmapStruct *)&argo256x128;
             break;
     }
     return(bitmapptr);
@@ -186,6 +211,7 @@ void OSDSetPixel(uint16_t x, uint16_t y, enum COLOUR colour)
             if(colour & (1 << c))
             {
                 osdWindow.display[c][((y * osdWindow.params[osdWindow.mode].maxX) + x)/8] |= 0x80 >> x%8;
+                markDirty(c, ((y * osdWindow.params[osdWindow.mode].maxX) + x)/8);
             }
         }
     }
@@ -203,6 +229,7 @@ void OSDClearPixel(uint16_t x, uint16_t y, enum COLOUR colour)
             if(colour & (1 << c))
             {
                 osdWindow.display[c][((y * osdWindow.params[osdWindow.mode].maxX) + x)/8] &= ~(0x80 >> x%8);
+                markDirty(c, ((y * osdWindow.params[osdWindow.mode].maxX) + x)/8);
             }
         }
     }
@@ -223,6 +250,7 @@ void OSDChangePixelColour(uint16_t x, uint16_t y, enum COLOUR fg, enum COLOUR bg
             isPixelSet |= osdWindow.display[c][((y * osdWindow.params[osdWindow.mode].maxX) + x)/8];
             // Clear out the pixel as it will be redefined.
             osdWindow.display[c][((y * osdWindow.params[osdWindow.mode].maxX) + x)/8] &= ~(0x80 >> x%8);
+            markDirty(c, ((y * osdWindow.params[osdWindow.mode].maxX) + x)/8);
         }
 
         // Go through all the colours and set the new colour.
@@ -314,6 +342,10 @@ void _OSDwrite(uint8_t x, uint8_t y, int8_t xoff, int8_t yoff, uint8_t xpad, uin
         return;
     }
 
+    // All colour planes are updated across the rows of the character cell, including padding. Padding and spacing can spill a byte into
+    // the adjacent row so the span is widened by a row either side.
+    OSDMarkDirtyRows(startY - ypad - 1, startY + height + ypad + 1, WHITE);
+
     // Write according to orientation.
     switch(orientation)
     {
@@ -513,6 +545,224 @@ void _OSDwrite(uint8_t x, uint8_t y, int8_t xoff, int8_t yoff, uint8_t xpad, uin
     }
 }
 
+// Internal method to read a single pixel of a character as _OSDwrite places it, row and col being within the rotated character
+// cell, width and height its rotated size. The bitmap indexing is that of _OSDwrite so the glyph cache reproduces it exactly.
+//
+static uint8_t _OSDglyphPixel(fontStruct *font, enum ORIENTATION orientation, uint8_t chr, uint16_t width, uint16_t height, int16_t row, int16_t col)
+{
+    // Locals.
+    uint8_t    vChrRow;
+    uint8_t    bitStartOffset;
+    uint8_t    bitPos;
+    uint8_t    chrByteSize;
+    uint8_t    chrByteOffset;
+
+    switch(orientation)
+    {
+        case DEG90:
+            bitStartOffset = ((width%8) != 0 ? (8-(width%8)) : 0);
+            bitPos         = (col+bitStartOffset)/8 == 0 ? bitStartOffset + (col%8) : col%8;
+            chrByteSize    = (width < 8 ? 1 : width/8);
+            chrByteOffset  = (abs(width - col - 1)/8);
+            vChrRow        = font->bitmap[((chr - font->start) * (height * chrByteSize)) + (row * chrByteSize) + chrByteOffset ];
+            return((vChrRow & 0x80 >> bitPos) != 0);
+
+        case DEG180:
+            chrByteSize    = (height < 8 ? 1 : height/8);
+            bitStartOffset = ((height%8) != 0 ? (8-(height%8)) : 0);
+            bitPos         = (row+bitStartOffset)/8 == 0 ? bitStartOffset + (row%8) : row%8;
+            vChrRow        = font->bitmap[((chr - font->start) * (width * chrByteSize)) + (height > 8 ? col*2 : col) + (height-row-1)/8];
+            return((vChrRow & 0x80 >> bitPos) != 0);
+
+        case DEG270:
+            chrByteSize    = (width < 8 ? 1 : width/8);
+            chrByteOffset  = (col/8);
+            vChrRow        = font->bitmap[((chr - font->start) * (height * chrByteSize)) + ((height-row-1) * chrByteSize) + chrByteOffset ];
+            return((vChrRow & 1 << (col%8)) != 0);
+
+        case NORMAL:
+        default:
+            vChrRow        = font->bitmap[((chr - font->start) * (width * (height < 8 ? 1 : height/8))) + (height > 8 ? col*2 : col) + row/8];
+            return((vChrRow & (1 << (row % 8))) != 0);
+    }
+}
+
+// Internal method to return a font pre-rotated to the given orientation, building it into the least recently used glyph cache
+// slot when not held. Each character row becomes a left justified mask of its foreground pixels in framebuffer order, so the
+// rotation and the font bitmap layout are resolved once per font rather than per pixel. NULL is returned when the heap cannot
+// hold the font, or for a 180 degree font with spacing other than 1 which _OSDwrite does not place on a pixel grid.
+//
+static t_OSDGlyphCache *_OSDGetGlyphCache(fontStruct *font, enum ORIENTATION orientation)
+{
+    // Locals.
+    t_OSDGlyphCache *slot = &osdGlyphCache[0];
+    uint16_t         width;
+    uint16_t         height;
+    uint16_t         *rowPtr;
+    uint16_t         mask;
+
+    for(uint8_t idx=0; idx < OSD_GLYPH_SLOTS; idx++)
+    {
+        if(osdGlyphCache[idx].font == font && osdGlyphCache[idx].orientation == orientation)
+        {
+            osdGlyphCache[idx].lastUsed = ++osdGlyphSeq;
+            return(&osdGlyphCache[idx]);
+        }
+        if(osdGlyphCache[idx].lastUsed < slot->lastUsed)
+            slot = &osdGlyphCache[idx];
+    }
+    if(orientation == DEG180 && font->spacing != 1)
+        return(NULL);
+
+    // Rebuild the oldest slot for this font.
+    if(slot->rows != NULL)
+        free(slot->rows);
+    slot->font   = NULL;
+    width        = (orientation == DEG90 || orientation == DEG270) ? font->height : font->width;
+    height       = (orientation == DEG90 || orientation == DEG270) ? font->width  : font->height;
+    slot->rows   = malloc((font->end - font->start + 1) * height * sizeof(uint16_t));
+    if(slot->rows == NULL)
+    {
+        debugf("No heap for the glyph cache, %lu bytes\n", (unsigned long)((font->end - font->start + 1) * height * sizeof(uint16_t)));
+        return(NULL);
+    }
+
+    // A 180 degree character is mirrored, its first column lands rightmost and the spacing column leftmost.
+    rowPtr = slot->rows;
+    for(uint16_t chr=font->start; chr <= font->end; chr++)
+    {
+        for(int16_t row=0; row < height; row++)
+        {
+            mask = 0;
+            for(int16_t col=0; col < width; col++)
+            {
+                if(_OSDglyphPixel(font, orientation, (uint8_t)chr, width, height, row, orientation == DEG180 ? width - col - 1 : col))
+                    mask |= 0x8000 >> col;
+            }
+            *rowPtr++ = mask;
+        }
+    }
+    slot->font        = font;
+    slot->orientation = orientation;
+    slot->width       = width;
+    slot->height      = height;
+    slot->inkOffset   = orientation == DEG180 ? font->spacing : 0;
+    slot->lastUsed    = ++osdGlyphSeq;
+    osdGlyphBuilds++;
+    return(slot);
+}
+
+// Internal method to position a character for the blitter, the placement being that of _OSDwrite. The character start pixel and its
+// glyph rows are stored in the cell along with the per plane byte masks of the foreground and background colours. Returns 0 when
+// the blitter cannot place the character exactly, ie. out of bounds, a cell reaching left of or above the framebuffer or wider than
+// the blitter handles, so the caller falls back to _OSDwrite.
+//
+static uint8_t _OSDplaceGlyph(uint8_t x, uint8_t y, int8_t xoff, int8_t yoff, uint8_t xpad, uint8_t ypad, t_OSDGlyphCache *cache, uint8_t chr, uint16_t attr, enum COLOUR fg, enum COLOUR bg, t_OSDGlyphCell *cell)
+{
+    // Locals.
+    fontStruct *font    = cache->font;
+    uint16_t   width    = cache->width;
+    uint16_t   height   = cache->height;
+    uint16_t   spacing  = font->spacing;
+    uint16_t   startX;
+    uint16_t   startY;
+    uint8_t    fgPlanes = (attr & HILIGHT_FG_ACTIVE) ? (attr & ~HILIGHT_FG_ACTIVE) : fg;
+    uint8_t    bgPlanes = (attr & HILIGHT_BG_ACTIVE) ? (attr & ~HILIGHT_BG_ACTIVE) : bg;
+
+    if(chr < font->start || chr > font->end || width + spacing + 2*xpad > 25)
+        return(0);
+
+    switch(cache->orientation)
+    {
+        case DEG90:
+            startX  = osdWindow.params[osdWindow.mode].maxX - ((y+1) * (width + spacing)) - yoff;
+            startY  = x * (height + spacing) + xoff;
+            break;
+
+        case DEG180:
+            startX  = osdWindow.params[osdWindow.mode].maxX - ((x+1) * (width + spacing)) - xoff;
+            startY  = osdWindow.params[osdWindow.mode].maxY - ((y+1) * (height + spacing)) - yoff;
+            break;
+
+        case DEG270:
+            startX  = (y * (width + spacing)) + yoff;
+            startY  = osdWindow.params[osdWindow.mode].maxY - ((x+1) * (height + spacing)) - xoff;
+            break;
+
+        case NORMAL:
+        default:
+            startX  = (x * (width + spacing + 2*xpad)) + xpad + xoff;
+            startY  = (y * (height + spacing + 2*ypad)) + ypad + yoff;
+            break;
+    }
+    if(startX > osdWindow.params[osdWindow.mode].maxX || startY > osdWindow.params[osdWindow.mode].maxY || startX+width > osdWindow.params[osdWindow.mode].maxX || startY+height > osdWindow.params[osdWindow.mode].maxY || startX < xpad || startY < ypad)
+        return(0);
+
+    cell->startX = startX - xpad;
+    cell->startY = startY;
+    cell->glyph  = &cache->rows[(chr - font->start) * height];
+    for(uint8_t c=0; c < (VC_MENU_RGB_BITS > VC_STATUS_RGB_BITS ? VC_MENU_RGB_BITS : VC_STATUS_RGB_BITS); c++)
+    {
+        cell->fgMask[c] = fgPlanes & (1 << c) ? 0xFF : 0x00;
+        cell->bgMask[c] = bgPlanes & (1 << c) ? 0xFF : 0x00;
+    }
+    return(1);
+}
+
+// Internal method to blit a run of characters sharing a start row. The run is drawn a framebuffer row at a time; for each character the
+// cell and glyph row masks are shifted to the byte alignment of the cell and written a whole byte per colour plane, the cell bits taking
+// the foreground colour where the glyph is set and the background elsewhere, the bits outside the cell left untouched. Characters are
+// drawn in string order within each row so overlapping padding resolves as it does with _OSDwrite.
+//
+static void _OSDblitGlyphs(t_OSDGlyphCache *cache, t_OSDGlyphCell *cells, uint8_t count, uint8_t xpad, uint8_t ypad)
+{
+    // Locals.
+    uint16_t   bytesPerRow = osdWindow.params[osdWindow.mode].maxX / 8;
+    uint16_t   startY      = cells[0].startY;
+    int16_t    height      = cache->height;
+    uint8_t    cellWidth   = cache->width + cache->font->spacing + 2*xpad;
+    uint8_t    inkStart    = xpad + cache->inkOffset;
+    uint32_t   cellMask    = 0xFFFFFFFF << (32 - cellWidth);
+    uint32_t   rowAddr;
+    uint32_t   addr;
+    uint32_t   cover;
+    uint32_t   ink;
+    uint8_t    bitOffset;
+    uint8_t    cm;
+    uint8_t    im;
+    uint8_t    *dst;
+
+    if(count == 0)
+        return;
+    OSDMarkDirtyRows(startY - ypad - 1, startY + height + ypad + 1, WHITE);
+
+    for(int16_t row=-ypad; row < height+ypad; row++)
+    {
+        rowAddr = (uint32_t)(startY + row) * bytesPerRow;
+        for(uint8_t idx=0; idx < count; idx++)
+        {
+            bitOffset = cells[idx].startX % 8;
+            addr      = rowAddr + cells[idx].startX/8;
+            cover     = cellMask >> bitOffset;
+            ink       = (row < 0 || row >= height) ? 0 : ((uint32_t)cells[idx].glyph[row] << 16) >> (bitOffset + inkStart);
+            while(cover)
+            {
+                cm = cover >> 24;
+                im = ink >> 24;
+                for(uint8_t c=0; c < (VC_MENU_RGB_BITS > VC_STATUS_RGB_BITS ? VC_MENU_RGB_BITS : VC_STATUS_RGB_BITS); c++)
+                {
+                    dst  = &osdWindow.display[c][addr];
+                    *dst = (*dst & ~cm) | (im & cells[idx].fgMask[c]) | (cm & ~im & cells[idx].bgMask[c]);
+                }
+                cover <<= 8;
+                ink   <<= 8;
+                addr++;
+            }
+        }
+    }
+    return;
+}
+
 // Method to draw a stored bitmap onto the OSD display.
 void OSDWriteBitmap(uint16_t x, uint16_t y, enum BITMAPS bitmap, enum COLOUR fg, enum COLOUR bg)
 {
@@ -531,6 +781,7 @@ void OSDWriteBitmap(uint16_t x, uint16_t y, enum BITMAPS bitmap, enum COLOUR fg,
         debugf("Bitmap coordinates out of range:(%d,%d)\n", x, y);
         return;
     }
+    OSDMarkDirtyRows(y, y+height, WHITE);
    
     // Trace out the bitmap into the framebuffer.
     for(int16_t row=y; row < (y+height >= osdWindow.params[osdWindow.mode].maxY ? osdWindow.params[osdWindow.mode].maxY : y+height); row++)
@@ -609,6 +860,9 @@ void OSDWriteString(uint8_t x, uint8_t y, int8_t xoff, int8_t yoff, uint8_t xpad
     uint8_t       ypos = y;
     uint8_t       *ptr;
     uint16_t      *aptr;
+    t_OSDGlyphCache *glyphCache;
+    t_OSDGlyphCell  cells[OSD_BLIT_CELLS];
+    uint8_t       cellCount = 0;
 
     // Obtain the font structure based on the provided type.
     fontptr = OSDGetFont(font);
@@ -646,10 +900,27 @@ void OSDWriteString(uint8_t x, uint8_t y, int8_t xoff, int8_t yoff, uint8_t xpad
             break;
     }
 
-    // Output the string.
+    // Output the string. Characters sharing a start row are gathered and blitted together from the pre-rotated glyph cache, any character
+    // the blitter cannot place, and all output whilst debugging, goes through _OSDwrite in string order.
+    glyphCache = osdWindow.debug ? NULL : _OSDGetGlyphCache(fontptr, orientation);
     for(ptr=str,aptr=attr; *ptr != 0x00; ptr++, aptr++)
     {
-        _OSDwrite(xpos++, ypos, xoff, yoff, xpad, ypad, orientation, (*ptr), (attr != NULL ? (*aptr) : NOATTR), fg, bg, fontptr);
+        if(glyphCache != NULL && _OSDplaceGlyph(xpos, ypos, xoff, yoff, xpad, ypad, glyphCache, (*ptr), (attr != NULL ? (*aptr) : NOATTR), fg, bg, &cells[cellCount]))
+        {
+            if(cellCount > 0 && (cells[cellCount].startY != cells[0].startY || cellCount == OSD_BLIT_CELLS - 1))
+            {
+                _OSDblitGlyphs(glyphCache, cells, cellCount, xpad, ypad);
+                cells[0]  = cells[cellCount];
+                cellCount = 0;
+            }
+            cellCount++;
+            xpos++;
+        } else
+        {
+            _OSDblitGlyphs(glyphCache, cells, cellCount, xpad, ypad);
+            cellCount = 0;
+            _OSDwrite(xpos++, ypos, xoff, yoff, xpad, ypad, orientation, (*ptr), (attr != NULL ? (*aptr) : NOATTR), fg, bg, fontptr);
+        }
                 
         if(xpos > maxX)
         {
@@ -662,6 +933,7 @@ void OSDWriteString(uint8_t x, uint8_t y, int8_t xoff, int8_t yoff, uint8_t xpad
             }
         }
     }
+    _OSDblitGlyphs(glyphCache, cells, cellCount, xpad, ypad);
     
     return;
 }
@@ -683,24 +955,78 @@ void OSDUpdateScreenSize(void)
         osdWindow.params[STATUS].maxY = (uint16_t)(osdInData[3] * 8) + (uint16_t)(osdInData[5] * 8);
         osdWindow.params[MENU].maxX   = (uint16_t)(osdInData[0] * 8);
         osdWindow.params[MENU].maxY   = (uint16_t)(osdInData[1] * 8);
+        _OSDMarkDirtyAll();
+    }
+
+    return;
+}
+
+// Method to mark a range of framebuffer rows, startRow to endRow-1, as changed in the given colour planes. The rows are contiguous in
+// the framebuffer so a row range maps directly onto a byte span.
+//
+void OSDMarkDirtyRows(int16_t startRow, int16_t endRow, uint8_t planes)
+{
+    // Locals.
+    //
+    uint16_t      bytesPerRow = osdWindow.params[osdWindow.mode].maxX / 8;
+    uint16_t      start;
+    uint16_t      end;
+
+    if(startRow < 0) startRow = 0;
+    if(endRow > osdWindow.params[osdWindow.mode].maxY) endRow = osdWindow.params[osdWindow.mode].maxY;
+    if(startRow >= endRow)
+        return;
+
+    start = startRow * bytesPerRow;
+    end   = endRow * bytesPerRow;
+    for(uint8_t c=0; c < (VC_MENU_RGB_BITS > VC_STATUS_RGB_BITS ? VC_MENU_RGB_BITS : VC_STATUS_RGB_BITS); c++)
+    {
+        if(planes & (1 << c))
+        {
+            if(start < osdWindow.dirtyStart[c]) osdWindow.dirtyStart[c] = start;
+            if(end   > osdWindow.dirtyEnd[c])   osdWindow.dirtyEnd[c]   = end;
+        }
     }
+    return;
+}
 
+// Internal method to mark the entire framebuffer as changed, used when the window or its geometry changes.
+//
+void _OSDMarkDirtyAll(void)
+{
+    for(uint8_t c=0; c < (VC_MENU_RGB_BITS > VC_STATUS_RGB_BITS ? VC_MENU_RGB_BITS : VC_STATUS_RGB_BITS); c++)
+    {
+        osdWindow.dirtyStart[c] = 0;
+        osdWindow.dirtyEnd[c]   = VC_MENU_BUFFER_SIZE > VC_STATUS_BUFFER_SIZE ? VC_MENU_BUFFER_SIZE : VC_STATUS_BUFFER_SIZE;
+    }
     return;
 }
 
-// Method to refresh the active screen from the buffer contents.
+// Method to refresh the active screen from the buffer contents. Only the dirty span of each colour plane is written to the FPGA, a cursor
+// flash or menu row change therefore sends a few hundred bytes rather than the entire framebuffer.
 void OSDRefreshScreen(void)
 {
     // Locals.
     //
     uint32_t      addr = VIDEO_OSD_BLUE_ADDR;
 
-    // Loop through the colour buffers and write contents out to the FPGA memory.
+    // Loop through the colour buffers and write the changed contents out to the FPGA memory.
+    osdWindow.refreshBytes = 0;
     for(uint8_t c=0; c < (VC_MENU_RGB_BITS > VC_STATUS_RGB_BITS ? VC_MENU_RGB_BITS : VC_STATUS_RGB_BITS); c++)
     {
-        writeZ80Array(addr, osdWindow.display[c], (VC_MENU_BUFFER_SIZE > VC_STATUS_BUFFER_SIZE ? VC_MENU_BUFFER_SIZE : VC_STATUS_BUFFER_SIZE), FPGA);
+        if(osdWindow.dirtyStart[c] < osdWindow.dirtyEnd[c])
+        {
+            writeZ80Array(addr + osdWindow.dirtyStart[c], &osdWindow.display[c][osdWindow.dirtyStart[c]], osdWindow.dirtyEnd[c] - osdWindow.dirtyStart[c], FPGA);
+            osdWindow.refreshBytes += osdWindow.dirtyEnd[c] - osdWindow.dirtyStart[c];
+        }
+
+        // Plane is now clean.
+        osdWindow.dirtyStart[c] = VC_MENU_BUFFER_SIZE > VC_STATUS_BUFFER_SIZE ? VC_MENU_BUFFER_SIZE : VC_STATUS_BUFFER_SIZE;
+        osdWindow.dirtyEnd[c]   = 0;
         addr += 0x10000;
     }
+    osdWindow.refreshTotalBytes += osdWindow.refreshBytes;
+    osdWindow.refreshCount++;
     return;
 }
 
@@ -713,6 +1039,7 @@ void OSDClearScreen(enum COLOUR colour)
     {
         memset(osdWindow.display[c], (colour & 1 << c ? 0xFF : 0x00), VC_MENU_BUFFER_SIZE > VC_STATUS_BUFFER_SIZE ? VC_MENU_BUFFER_SIZE : VC_STATUS_BUFFER_SIZE);
     }
+    _OSDMarkDirtyAll();
     return;
 }
 
@@ -729,6 +1056,7 @@ void OSDClearArea(int16_t startX, int16_t startY, int16_t endX, int16_t endY, en
     // Sanity check.
     if(sx < 0 || ex >= osdWindow.params[osdWindow.mode].maxX || sx > ex || sy < 0 || ey >= osdWindow.params[osdWindow.mode].maxY || sy > ey)
         return;
+    OSDMarkDirtyRows(sy, ey+1, WHITE);
 
     // Not the most efficient but speed not essential, go through the entire pixel area and clear or set the required colour bit for each pixel.
     //
@@ -892,8 +1220,9 @@ void OSDDrawEllipse(int16_t startX, int16_t startY, int16_t endX, int16_t endY,
 // (ie. FPGA BRAM, OSD display buffer etc).
 void OSDSetActiveWindow(enum WINDOWS window)
 {
-    // Set the starting default window.
+    // Set the starting default window, the framebuffer is shared so all of it must be resent.
     osdWindow.mode = window;
+    _OSDMarkDirtyAll();
     return;
 }
 
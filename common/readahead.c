@@ -0,0 +1,170 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            readahead.c
+// Created:         Oct 2026
+// Version:         v1.1
+// Author(s):       Philip Smart
+// Description:     Service file read-ahead.
+//                  The Z80 reads a file one sector per service request, copying the sector out of the
+//                  service record before issuing the next request. Reading from the SD card only when the
+//                  request arrives leaves the card idle whilst the Z80 copies and the Z80 idle whilst the
+//                  card is read. This module double buffers the reads, once a request has been answered
+//                  and the Z80 released, the following sector is fetched into a second buffer so that a
+//                  sequential request completes with a memory copy. Any non sequential request discards
+//                  the prefetched sector and reading reverts to on demand until the requests are
+//                  sequential again.
+//                  Bulk loads, ROM and program images written to Z80 memory, stream the file through a
+//                  buffer instead. The first read is cut short at a sector boundary so every read after
+//                  it is of whole sectors, which FatFs transfers straight into the buffer in a single
+//                  multi-sector card read rather than a sector at a time through the file window.
+//
+// Credits:
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         v1.0 Oct 2026  - Initial write.
+//                  v1.1 Oct 2026  - Added readAheadStream for bulk loads.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include "ff.h"
+#include <tranzputer.h>
+#include <readahead.h>
+
+// Method to attach the read-ahead state to a newly opened file, positioned at the start.
+//
+void readAheadInit(t_readAhead *ra, FIL *file)
+{
+    memset(ra, 0x00, sizeof(t_readAhead));
+    ra->file       = file;
+    ra->sequential = 1;
+}
+
+// Method to read a sector of the file into the callers buffer. A prefetched sector is returned if it is the one
+// requested, otherwise it is discarded and the file read, seeking first if the request is not sequential.
+//
+FRESULT readAheadRead(t_readAhead *ra, uint8_t sector, uint8_t *dst, UINT *readSize)
+{
+    // Locals.
+    FRESULT        result    = FR_OK;
+
+    if(ra->valid && ra->bufSector == sector)
+    {
+        memcpy(dst, ra->buf, ra->bufSize);
+        *readSize      = ra->bufSize;
+        ra->valid      = 0;
+        ra->sequential = (ra->bufSize == TZSVC_SECTOR_SIZE);
+        ra->hits++;
+        return(FR_OK);
+    }
+    if(ra->valid)
+    {
+        ra->valid = 0;
+        ra->drops++;
+    }
+
+    // If the Z80 is requesting a non sequential sector then seek to the correct location prior to the read.
+    //
+    ra->sequential = (ra->nextSector == sector);
+    if(!ra->sequential)
+    {
+        result = f_lseek(ra->file, (sector * TZSVC_SECTOR_SIZE));
+        ra->nextSector = sector;
+    }
+    if(!result)
+    {
+        result = f_read(ra->file, dst, TZSVC_SECTOR_SIZE, readSize);
+
+        // Nothing to fetch beyond the end of the file.
+        if(!result && *readSize < TZSVC_SECTOR_SIZE)
+            ra->sequential = 0;
+    }
+    ra->nextSector++;
+    ra->misses++;
+
+    return(result);
+}
+
+// Method to fetch the next sector into the read-ahead buffer, called once the Z80 has been released. Nothing is done
+// unless the requests are sequential. On error the file position is restored so the following request reads the
+// sector directly and reports the error itself.
+//
+FRESULT readAheadFetch(t_readAhead *ra)
+{
+    // Locals.
+    FRESULT        result    = FR_OK;
+
+    if(ra->file == NULL || ra->valid || !ra->sequential)
+        return(FR_OK);
+
+    result = f_read(ra->file, ra->buf, TZSVC_SECTOR_SIZE, &ra->bufSize);
+    if(result == FR_OK)
+    {
+        ra->bufSector = ra->nextSector++;
+        ra->valid     = 1;
+    } else
+    {
+        f_lseek(ra->file, (ra->nextSector * TZSVC_SECTOR_SIZE));
+        ra->sequential = 0;
+    }
+    return(result);
+}
+
+// Method to stream size bytes of the file, from the current position, to the sink a buffer at a time. The buffer size must be a
+// multiple of the sector size. Streaming stops early at the end of the file or on error, the number of bytes passed to the sink is
+// returned in streamed.
+//
+FRESULT readAheadStream(FIL *file, uint32_t size, uint8_t *buf, UINT bufSize, t_readAheadSink sink, void *ctx, uint32_t *streamed)
+{
+    // Locals.
+    FRESULT        result    = FR_OK;
+    uint32_t       done      = 0;
+    UINT           chunk;
+    UINT           readSize;
+
+    while(done < size)
+    {
+        // Read up to the next sector boundary, after which the file position stays sector aligned.
+        chunk = bufSize - (UINT)(f_tell(file) % FF_MAX_SS);
+        if(chunk > size - done)
+            chunk = size - done;
+
+        result = f_read(file, buf, chunk, &readSize);
+        if(result != FR_OK || readSize == 0)
+            break;
+        sink(ctx, buf, readSize);
+        done += readSize;
+
+        // End of file.
+        if(readSize < chunk)
+            break;
+    }
+    if(streamed != NULL)
+        *streamed = done;
+
+    return(result);
+}
+
+#ifdef __cplusplus
+}
+#endif
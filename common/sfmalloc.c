@@ -0,0 +1,546 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            sfmalloc.c
+// Created:         Oct 2026
+// Version:         v1.0
+// Author(s):       Philip Smart
+// Description:     Segregated fit memory allocator.
+//                  Small blocks are kept on exact size class free lists, a bitmap of the non-empty
+//                  lists gives the next larger class in a single scan. Blocks larger than the biggest
+//                  class are kept in a size ordered binary tree and allocated best fit. The remainder
+//                  of the last split is held aside as a victim block which small requests carve from
+//                  before splitting into the tree again. Every block carries a header with its size and
+//                  the in-use state of itself and its predecessor, free blocks also carry a footer, so a
+//                  free coalesces with both neighbours in O(1) without walking any list.
+//                  Built with __SFMALLOC__ defined the allocator provides malloc/calloc/realloc/free and
+//                  replaces umm_malloc (ZPU) or the C library allocator (K64F). The heap is the fixed
+//                  __HEAPADDR__/__HEAPSIZE__ area when defined, otherwise it grows through _sbrk().
+//                  Without __SFMALLOC__ only the sfm_ entry points exist, which is how the host based
+//                  trace replay benchmark (tools/src/mallocbench.c) links it against the other allocators.
+//
+// Credits:
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         v1.0 Oct 2026  - Initial write.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "sfmalloc.h"
+
+#if defined(__SFMALLOC__)
+  #define sfm_malloc                 malloc
+  #define sfm_calloc                 calloc
+  #define sfm_realloc                realloc
+  #define sfm_free                   free
+  #if !defined(__HEAPADDR__) || !defined(__HEAPSIZE__)
+    #define SFM_USE_SBRK
+    extern void *_sbrk(int);
+  #endif
+#endif
+
+// Block header flags, held in the low bits of the size as sizes are always a multiple of SFM_GRAIN.
+//
+#define SFM_INUSE                    0x1                                 // Block is allocated.
+#define SFM_PINUSE                   0x2                                 // Preceding block is allocated, when clear the word before this block is its size.
+#define SFM_TREE                     0x4                                 // Free block is the member of its size ring which is linked into the tree.
+#define SFM_FLAGS                    (SFM_INUSE | SFM_PINUSE | SFM_TREE)
+#define SFM_WORD                     sizeof(size_t)
+
+// A block as seen from its header. The payload of an allocated block starts at next, the tree links
+// only exist in free blocks larger than SFM_SMALL_MAX.
+//
+typedef struct sfm_block {
+    size_t                           head;                               // Size | flags.
+    struct sfm_block                *next;                               // Free list or same size ring.
+    struct sfm_block                *prev;
+    struct sfm_block                *left;                               // Tree links, large free blocks only.
+    struct sfm_block                *right;
+    struct sfm_block                *parent;
+} SFM_BLOCK;
+
+#define SFM_SIZE(b)                  ((b)->head & ~(size_t)SFM_FLAGS)
+#define SFM_AT(b, off)               ((SFM_BLOCK *)((char *)(b) + (off)))
+#define SFM_FOOT(b, sz)              (*(size_t *)((char *)(b) + (sz) - SFM_WORD))
+#define SFM_PAYLOAD(b)               ((void *)((char *)(b) + SFM_WORD))
+#define SFM_HEADER(p)                ((SFM_BLOCK *)((char *)(p) - SFM_WORD))
+
+// Allocator state.
+//
+static SFM_BLOCK                    *smallBin[SFM_SMALL_CLASSES];
+static uint32_t                      smallMap;
+static SFM_BLOCK                    *treeRoot;
+static SFM_BLOCK                    *victim;                             // Remainder of the last split, carved first and kept off the lists.
+static struct {
+    char                            *start;
+    char                            *end;
+} region[SFM_MAX_REGIONS];
+static uint8_t                       regions;
+static uint8_t                       initialised;
+static uint32_t                      allocCount;
+static uint32_t                      failCount;
+static uint32_t                      histogram[SFM_HIST_BUCKETS];
+
+// Convert a request into a block size, header included and rounded to the grain.
+//
+static size_t sfm_blocksize(size_t size)
+{
+    size = (size + SFM_WORD + SFM_GRAIN - 1) & ~(SFM_GRAIN - 1);
+    return(size < SFM_MIN_BLOCK ? SFM_MIN_BLOCK : size);
+}
+
+// Index of the lowest set bit, the map is never zero when called.
+//
+static unsigned int sfm_lowbit(uint32_t map)
+{
+    unsigned int idx = 0;
+
+    if((map & 0xFFFF) == 0) { map >>= 16; idx += 16; }
+    if((map & 0xFF)   == 0) { map >>= 8;  idx += 8;  }
+    if((map & 0xF)    == 0) { map >>= 4;  idx += 4;  }
+    if((map & 0x3)    == 0) { map >>= 2;  idx += 2;  }
+    if((map & 0x1)    == 0) {             idx += 1;  }
+    return(idx);
+}
+
+// Replace node u in the tree by v (which may be NULL).
+//
+static void sfm_transplant(SFM_BLOCK *u, SFM_BLOCK *v)
+{
+    if(u->parent == NULL)
+        treeRoot = v;
+    else if(u == u->parent->left)
+        u->parent->left = v;
+    else
+        u->parent->right = v;
+    if(v != NULL)
+        v->parent = u->parent;
+}
+
+// Link a free block of the given size into the size class lists or the tree.
+//
+static void sfm_insert(SFM_BLOCK *blk, size_t size)
+{
+    SFM_BLOCK *node, *parent;
+    unsigned int idx;
+
+    if(size <= SFM_SMALL_MAX)
+    {
+        idx = (size / SFM_GRAIN) - 2;
+        blk->prev = NULL;
+        blk->next = smallBin[idx];
+        if(blk->next != NULL)
+            blk->next->prev = blk;
+        smallBin[idx] = blk;
+        smallMap |= (1UL << idx);
+        return;
+    }
+
+    // Same size blocks share a ring, only one member sits in the tree.
+    parent = NULL;
+    for(node = treeRoot; node != NULL; )
+    {
+        if(SFM_SIZE(node) == size)
+        {
+            blk->head &= ~(size_t)SFM_TREE;
+            blk->next = node->next;
+            blk->prev = node;
+            node->next->prev = blk;
+            node->next = blk;
+            return;
+        }
+        parent = node;
+        node = size < SFM_SIZE(node) ? node->left : node->right;
+    }
+    blk->head |= SFM_TREE;
+    blk->next = blk->prev = blk;
+    blk->left = blk->right = NULL;
+    blk->parent = parent;
+    if(parent == NULL)
+        treeRoot = blk;
+    else if(size < SFM_SIZE(parent))
+        parent->left = blk;
+    else
+        parent->right = blk;
+}
+
+// Unlink a free block from whichever list or tree it is on.
+//
+static void sfm_remove(SFM_BLOCK *blk, size_t size)
+{
+    SFM_BLOCK *sib, *y;
+    unsigned int idx;
+
+    if(blk == victim)
+    {
+        victim = NULL;
+        return;
+    }
+    if(size <= SFM_SMALL_MAX)
+    {
+        idx = (size / SFM_GRAIN) - 2;
+        if(blk->prev != NULL)
+            blk->prev->next = blk->next;
+        else
+            smallBin[idx] = blk->next;
+        if(blk->next != NULL)
+            blk->next->prev = blk->prev;
+        if(smallBin[idx] == NULL)
+            smallMap &= ~(1UL << idx);
+        return;
+    }
+
+    sib = blk->next;
+    if(sib != blk)
+    {
+        sib->prev = blk->prev;
+        blk->prev->next = sib;
+
+        // A ring member takes over the tree position.
+        if(blk->head & SFM_TREE)
+        {
+            sib->head |= SFM_TREE;
+            sib->left = blk->left;
+            sib->right = blk->right;
+            if(sib->left != NULL)  sib->left->parent = sib;
+            if(sib->right != NULL) sib->right->parent = sib;
+            sfm_transplant(blk, sib);
+        }
+        return;
+    }
+
+    if(blk->left == NULL)
+        sfm_transplant(blk, blk->right);
+    else if(blk->right == NULL)
+        sfm_transplant(blk, blk->left);
+    else
+    {
+        for(y = blk->right; y->left != NULL; y = y->left);
+        if(y->parent != blk)
+        {
+            sfm_transplant(y, y->right);
+            y->right = blk->right;
+            y->right->parent = y;
+        }
+        sfm_transplant(blk, y);
+        y->left = blk->left;
+        y->left->parent = y;
+    }
+}
+
+// Smallest free tree block of at least size bytes, preferring a ring member which avoids re-linking the tree.
+//
+static SFM_BLOCK *sfm_bestfit(size_t size)
+{
+    SFM_BLOCK *node, *best = NULL;
+
+    for(node = treeRoot; node != NULL; )
+    {
+        if(SFM_SIZE(node) == size)
+        {
+            best = node;
+            break;
+        }
+        if(SFM_SIZE(node) > size)
+        {
+            best = node;
+            node = node->left;
+        } else
+            node = node->right;
+    }
+    return(best != NULL && best->next != best ? best->next : best);
+}
+
+// Make a free block the victim, the previous victim goes back on the lists.
+//
+static void sfm_setvictim(SFM_BLOCK *blk)
+{
+    if(victim != NULL)
+        sfm_insert(victim, SFM_SIZE(victim));
+    victim = blk;
+}
+
+// Mark a free block (already unlinked) as allocated, the usable tail becomes the victim so a run of
+// allocations carve from the same block without touching the lists.
+//
+static void *sfm_carve(SFM_BLOCK *blk, size_t bsize, size_t size)
+{
+    SFM_BLOCK *rem;
+    size_t     rsize = bsize - size;
+
+    if(rsize >= SFM_MIN_BLOCK)
+    {
+        blk->head = size | SFM_INUSE | (blk->head & SFM_PINUSE);
+        rem = SFM_AT(blk, size);
+        rem->head = rsize | SFM_PINUSE;
+        SFM_FOOT(rem, rsize) = rsize;
+        sfm_setvictim(rem);
+    } else
+    {
+        blk->head = bsize | SFM_INUSE | (blk->head & SFM_PINUSE);
+        SFM_AT(blk, bsize)->head |= SFM_PINUSE;
+    }
+    return(SFM_PAYLOAD(blk));
+}
+
+// Return a block to the pool, merging with free neighbours. A block which absorbs the victim takes its place.
+//
+static void sfm_release(SFM_BLOCK *blk)
+{
+    size_t     size = SFM_SIZE(blk);
+    size_t     psize;
+    SFM_BLOCK *nxt = SFM_AT(blk, size);
+    SFM_BLOCK *vict = victim;
+
+    if(!(nxt->head & SFM_INUSE))
+    {
+        sfm_remove(nxt, SFM_SIZE(nxt));
+        size += SFM_SIZE(nxt);
+    }
+    if(!(blk->head & SFM_PINUSE))
+    {
+        psize = *(size_t *)((char *)blk - SFM_WORD);
+        blk = SFM_AT(blk, -(ptrdiff_t)psize);
+        sfm_remove(blk, psize);
+        size += psize;
+    }
+    blk->head = size | SFM_PINUSE;
+    SFM_FOOT(blk, size) = size;
+    SFM_AT(blk, size)->head &= ~(size_t)SFM_PINUSE;
+    if(vict != NULL && victim == NULL)
+        victim = blk;
+    else
+        sfm_insert(blk, size);
+}
+
+// Add a region of memory to the heap. The region is aligned so payloads fall on a grain boundary and
+// terminated with an in-use sentinel header so coalescing never runs off the end.
+//
+int sfm_add(void *mem, size_t size)
+{
+    char      *start = (char *)mem;
+    char      *end   = start + size;
+    SFM_BLOCK *blk;
+    size_t     bsize;
+
+    if(regions >= SFM_MAX_REGIONS)
+        return(-1);
+
+    while(((uintptr_t)start + SFM_WORD) & (SFM_GRAIN - 1))
+        start++;
+    end -= ((uintptr_t)end - (uintptr_t)start) & (SFM_GRAIN - 1);
+    if(end < start + SFM_MIN_BLOCK + SFM_GRAIN)
+        return(-1);
+
+    // Last grain holds the sentinel.
+    bsize = (end - start) - SFM_GRAIN;
+    blk = (SFM_BLOCK *)start;
+    blk->head = bsize | SFM_PINUSE;
+    SFM_FOOT(blk, bsize) = bsize;
+    SFM_AT(blk, bsize)->head = SFM_INUSE;
+    sfm_insert(blk, bsize);
+
+    region[regions].start = start;
+    region[regions].end   = end;
+    regions++;
+    initialised = 1;
+    return(0);
+}
+
+// Reset the allocator to an empty state and, on target builds with a fixed heap, add the heap area.
+//
+void sfm_init(void)
+{
+    memset(smallBin, 0, sizeof(smallBin));
+    memset(histogram, 0, sizeof(histogram));
+    smallMap = 0;
+    treeRoot = NULL;
+    victim = NULL;
+    regions = 0;
+    allocCount = failCount = 0;
+    initialised = 1;
+  #if defined(__SFMALLOC__) && !defined(SFM_USE_SBRK)
+    sfm_add((void *)__HEAPADDR__, __HEAPSIZE__);
+  #endif
+}
+
+void *sfm_malloc(size_t size)
+{
+    SFM_BLOCK   *blk;
+    size_t       bsize;
+    unsigned int idx;
+    uint32_t     map;
+    size_t       hsize;
+
+    if(!initialised)
+        sfm_init();
+    if(size == 0 || size > ((size_t)-1 >> 1))
+        return(NULL);
+
+    for(idx = 0, hsize = 8; idx < SFM_HIST_BUCKETS - 1 && size > hsize; idx++, hsize <<= 1);
+    histogram[idx]++;
+
+    size = sfm_blocksize(size);
+    blk = NULL;
+
+    // Exact or next larger non-empty class first, then the victim and finally the best fit tree.
+    if(size <= SFM_SMALL_MAX)
+    {
+        idx = (size / SFM_GRAIN) - 2;
+        map = smallMap & ~((1UL << idx) - 1);
+        if(map != 0)
+            blk = smallBin[sfm_lowbit(map)];
+    }
+    if(blk == NULL && victim != NULL && SFM_SIZE(victim) >= size)
+        blk = victim;
+    if(blk == NULL)
+        blk = sfm_bestfit(size);
+
+  #if defined(SFM_USE_SBRK)
+    if(blk == NULL)
+    {
+        bsize = size + 2 * SFM_GRAIN < SFM_GROW_SIZE ? SFM_GROW_SIZE : size + 2 * SFM_GRAIN;
+        blk = (SFM_BLOCK *)_sbrk((int)bsize);
+        if(blk != NULL && blk != (SFM_BLOCK *)-1 && sfm_add(blk, bsize) == 0)
+            blk = sfm_bestfit(size);
+        else
+            blk = NULL;
+    }
+  #endif
+    if(blk == NULL)
+    {
+        failCount++;
+        return(NULL);
+    }
+
+    bsize = SFM_SIZE(blk);
+    sfm_remove(blk, bsize);
+    allocCount++;
+    return(sfm_carve(blk, bsize, size));
+}
+
+void sfm_free(void *ptr)
+{
+    if(ptr == NULL)
+        return;
+    sfm_release(SFM_HEADER(ptr));
+}
+
+void *sfm_calloc(size_t num, size_t size)
+{
+    void   *ptr;
+    size_t  total = num * size;
+
+    if(size != 0 && total / size != num)
+        return(NULL);
+    ptr = sfm_malloc(total);
+    if(ptr != NULL)
+        memset(ptr, 0, total);
+    return(ptr);
+}
+
+// Shrink in place, grow in place into a free successor, otherwise move.
+//
+void *sfm_realloc(void *ptr, size_t size)
+{
+    SFM_BLOCK *blk, *nxt, *tail;
+    size_t     bsize, nsize, need;
+    void      *nptr;
+
+    if(ptr == NULL)
+        return(sfm_malloc(size));
+    if(size == 0)
+    {
+        sfm_free(ptr);
+        return(NULL);
+    }
+
+    blk   = SFM_HEADER(ptr);
+    bsize = SFM_SIZE(blk);
+    need  = sfm_blocksize(size);
+
+    if(need <= bsize)
+    {
+        if(bsize - need >= SFM_MIN_BLOCK)
+        {
+            blk->head = need | SFM_INUSE | (blk->head & SFM_PINUSE);
+            tail = SFM_AT(blk, need);
+            tail->head = (bsize - need) | SFM_INUSE | SFM_PINUSE;
+            sfm_release(tail);
+        }
+        return(ptr);
+    }
+
+    nxt = SFM_AT(blk, bsize);
+    if(!(nxt->head & SFM_INUSE) && bsize + (nsize = SFM_SIZE(nxt)) >= need)
+    {
+        sfm_remove(nxt, nsize);
+        return(sfm_carve(blk, bsize + nsize, need));
+    }
+
+    nptr = sfm_malloc(size);
+    if(nptr != NULL)
+    {
+        memcpy(nptr, ptr, bsize - SFM_WORD);
+        sfm_free(ptr);
+    }
+    return(nptr);
+}
+
+// Walk every region block by block to build the usage and fragmentation figures.
+//
+void sfm_stats(SFM_STATS *stats)
+{
+    SFM_BLOCK *blk;
+    size_t     size;
+    uint8_t    idx;
+
+    memset(stats, 0, sizeof(SFM_STATS));
+    for(idx = 0; idx < regions; idx++)
+    {
+        stats->totalBytes += region[idx].end - region[idx].start;
+        for(blk = (SFM_BLOCK *)region[idx].start; (size = SFM_SIZE(blk)) != 0; blk = SFM_AT(blk, size))
+        {
+            if(blk->head & SFM_INUSE)
+            {
+                stats->usedBytes += size;
+                stats->usedBlocks++;
+            } else
+            {
+                stats->freeBytes += size;
+                stats->freeBlocks++;
+                if(size > stats->largestFree)
+                    stats->largestFree = size;
+            }
+        }
+    }
+    stats->fragmentation = stats->freeBytes == 0 ? 0 : (uint32_t)(100 - (stats->largestFree * 100) / stats->freeBytes);
+    stats->allocations   = allocCount;
+    stats->failures      = failCount;
+    memcpy(stats->histogram, histogram, sizeof(histogram));
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -2,7 +2,7 @@
 //
 // Name:            sharpmz.c
 // Created:         December 2020
-// Version:         v1.0
+// Version:         v1.1
 // Author(s):       Philip Smart
 // Description:     The Sharp MZ library.
 //                  This file contains methods which allow the ZPU to access and control the Sharp MZ
@@ -15,8 +15,12 @@
 // Copyright:       (c) 2019-2020 Philip Smart <philip.smart@net2net.org>
 //
 // History:         v1.0 Dec 2020  - Initial write of the Sharp MZ series hardware interface software.
+//                  v1.1 Oct 2026  - Display backing store held as a ring of rows, a scroll advances the ring
+//                                   head and only the newly exposed rows are written to the display.
 //
 // Notes:           See Makefile to enable/disable conditional components
+//                  VC_HW_SCROLL          - Scroll the display with the video module hardware scroll registers,
+//                                          VRAM is then addressed relative to the scroll start.
 //
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 // This source file is free software: you can redistribute it and#or modify
@@ -84,7 +88,7 @@ extern "C" {
 uint32_t volatile *ms;
 t_z80Control      z80Control;
 t_osControl       osControl;
-t_svcControl      *svcControl = TZSVC_CMD_STRUCT_ADDR_ZOS;
+t_svcControl      *svcControl = (t_svcControl *)TZSVC_CMD_STRUCT_ADDR_ZOS;
 
 // Mapping table to map Sharp MZ80A Ascii to Standard ASCII.
 //
@@ -742,11 +746,105 @@ static t_AnsiTerm ansiterm = { .state = ANSITERM_ESC, .charcnt = 0, .paramcnt =
 // Colour map for the Ansi Terminal.
 const unsigned char ansiColourMap[8] = { 0, 4, 2, 6, 1, 5, 3, 7 };
 
+// Offset into VRAM/ARAM of a physical display position. With the hardware scroll the display starts at the
+// scroll setting and wraps within the video RAM.
+#if defined(VC_HW_SCROLL)
+  #define VC_VRAM_OFFSET(row, col)   (((((uint32_t)display.hwScroll) << 3) + ((row) * display.maxScreenCol) + (col)) & (VIDEO_VRAM_SIZE-1))
+#else
+  #define VC_VRAM_OFFSET(row, col)   (((row) * display.maxScreenCol) + (col))
+#endif
+
 
 // --------------------------------------------------------------------------------------------------------------
 // Methods
 // --------------------------------------------------------------------------------------------------------------
 
+// Method to map a position in the backing store, (row * maxScreenCol) + col, to its index in the ring.
+//
+static inline uint32_t mzBufIdx(uint32_t pos)
+{
+    // Locals.
+    uint32_t ringSize = display.maxScreenRow * display.maxScreenCol;
+
+    pos += display.headRow * display.maxScreenCol;
+    return(pos >= ringSize ? pos - ringSize : pos);
+}
+
+// Method to return the backing store row shown at the top of the display.
+//
+static inline uint16_t mzWindowTop(void)
+{
+    return(display.screenRow < display.maxDisplayRow ? 0 : (display.screenRow - display.maxDisplayRow)+1);
+}
+
+// Method to return the ring buffer row which should be on the first row of the display.
+//
+static inline uint8_t mzWindowRing(void)
+{
+    return((display.headRow + mzWindowTop()) % display.maxScreenRow);
+}
+
+// Method to clear a span of the backing store.
+//
+static void mzClearBuffer(uint32_t startPos, uint32_t endPos)
+{
+    if(endPos > display.maxScreenRow * display.maxScreenCol)
+        endPos = display.maxScreenRow * display.maxScreenCol;
+    for(uint32_t pos = startPos; pos < endPos; pos++)
+    {
+        display.screenCharBuf[mzBufIdx(pos)] = 0x20;
+        display.screenAttrBuf[mzBufIdx(pos)] = display.screenAttr;
+    }
+}
+
+// Method to write rows of the backing store window to the physical display.
+//
+static void mzRefreshRows(uint8_t row, uint8_t rows)
+{
+    // Locals.
+    uint32_t srcIdx;
+    uint32_t dstIdx;
+    uint16_t top = mzWindowTop();
+
+    for(; rows > 0 && row < display.maxDisplayRow; row++, rows--)
+    {
+        // A row never straddles the end of the ring.
+        srcIdx = mzBufIdx((top + row) * display.maxScreenCol);
+        dstIdx = VC_VRAM_OFFSET(row, 0);
+        for(uint8_t col = 0; col < display.maxScreenCol; col++, srcIdx++)
+        {
+          #if defined(VC_HW_SCROLL)
+            dstIdx = VC_VRAM_OFFSET(row, col);
+          #endif
+            *(uint8_t *)(uintptr_t)(VIDEO_VRAM_BASE_ADDR + dstIdx) = dispCodeMap[display.screenCharBuf[srcIdx]].dispCode;
+            *(uint8_t *)(uintptr_t)(VIDEO_ARAM_BASE_ADDR + dstIdx) = display.screenAttrBuf[srcIdx];
+          #if !defined(VC_HW_SCROLL)
+            dstIdx++;
+          #endif
+        }
+    }
+}
+
+// Method to move the physical display up by a number of rows, the rows exposed at the bottom are not written.
+//
+static void mzShiftDisplay(uint8_t rows)
+{
+  #if defined(VC_HW_SCROLL)
+    // Advance the display start, a read of a scroll register sets the start to 8 times its offset.
+    display.hwScroll = (uint8_t)(display.hwScroll + ((rows * display.maxScreenCol) >> 3));
+    (void)*(volatile uint8_t *)(uintptr_t)(VCADDR_8BIT_SCLDSP + display.hwScroll);
+  #else
+    // Move the rows which remain visible, a row is a multiple of 4 bytes so copy a word at a time.
+    uint32_t shift = rows * display.maxScreenCol;
+    uint32_t end   = display.maxDisplayRow * display.maxScreenCol;
+    for(uint32_t dstIdx = 0; dstIdx + shift < end; dstIdx += 4)
+    {
+        *(uint32_t *)(uintptr_t)(VIDEO_VRAM_BASE_ADDR + dstIdx) = *(uint32_t *)(uintptr_t)(VIDEO_VRAM_BASE_ADDR + dstIdx + shift);
+        *(uint32_t *)(uintptr_t)(VIDEO_ARAM_BASE_ADDR + dstIdx) = *(uint32_t *)(uintptr_t)(VIDEO_ARAM_BASE_ADDR + dstIdx + shift);
+    }
+  #endif
+}
+
 // Method to configure the motherboard hardware after a reset.
 //
 uint8_t mzInitMBHardware(void)
@@ -850,6 +948,7 @@ void mzClearScreen(uint8_t mode, uint8_t updPos)
             dstARAMStartAddr = VIDEO_ARAM_BASE_ADDR;
             startIdx = 0;
             endIdx   = VC_DISPLAY_BUFFER_SIZE;
+            display.headRow = 0;
             // Reset parameters to start of screen.
             if(updPos)
             {
@@ -861,6 +960,14 @@ void mzClearScreen(uint8_t mode, uint8_t updPos)
     }
 
     // Clear the physical character display and attribute RAM.
+  #if defined(VC_HW_SCROLL)
+    // The display wraps within the video RAM, clear a byte at a time relative to the scroll start.
+    for(uint32_t pos = dstVRAMStartAddr - VIDEO_VRAM_BASE_ADDR; pos < dstVRAMEndAddr - VIDEO_VRAM_BASE_ADDR; pos++)
+    {
+        *(uint8_t *)(uintptr_t)(VIDEO_VRAM_BASE_ADDR + VC_VRAM_OFFSET(0, pos)) = 0x00;
+        *(uint8_t *)(uintptr_t)(VIDEO_ARAM_BASE_ADDR + VC_VRAM_OFFSET(0, pos)) = display.screenAttr;
+    }
+  #else
     // Select 32bit or 8 bit clear depending on the start/end position.
     //
     if((dstVRAMStartAddr&0x3) == 0 && (dstVRAMEndAddr&0x3) ==0)
@@ -868,23 +975,22 @@ void mzClearScreen(uint8_t mode, uint8_t updPos)
         uint32_t screenAttr = display.screenAttr << 24 | display.screenAttr << 16 | display.screenAttr << 8 | display.screenAttr;
         for(uint32_t dstVRAMAddr=dstVRAMStartAddr, dstARAMAddr = dstARAMStartAddr; dstVRAMAddr < dstVRAMEndAddr; dstVRAMAddr+=4, dstARAMAddr+=4)
         {
-            *(uint32_t *)(dstVRAMAddr) = 0x00000000;
-            *(uint32_t *)(dstARAMAddr) = screenAttr;
+            *(uint32_t *)(uintptr_t)(dstVRAMAddr) = 0x00000000;
+            *(uint32_t *)(uintptr_t)(dstARAMAddr) = screenAttr;
         }
     } else
     {
         for(uint32_t dstVRAMAddr=dstVRAMStartAddr, dstARAMAddr = dstARAMStartAddr; dstVRAMAddr <= dstVRAMEndAddr; dstVRAMAddr+=1, dstARAMAddr+=1)
         {
-            *(uint8_t *)(dstVRAMAddr) = 0x00;
-            *(uint8_t *)(dstARAMAddr) = display.screenAttr;
+            *(uint8_t *)(uintptr_t)(dstVRAMAddr) = 0x00;
+            *(uint8_t *)(uintptr_t)(dstARAMAddr) = display.screenAttr;
         }
     }
+  #endif
     // Clear the shadow display scrollback RAM.
-    for(uint32_t dstAddr = startIdx; dstAddr < endIdx; dstAddr++)
-    {
-        display.screenCharBuf[dstAddr] = 0x20;
-        display.screenAttrBuf[dstAddr] = display.screenAttr;
-    }
+    mzClearBuffer(startIdx, endIdx);
+    if(mode == 3)
+        display.vramTop = mzWindowRing();
 
     return;
 }
@@ -912,6 +1018,14 @@ void mzClearLine(int row, int colStart, int colEnd, uint8_t updPos)
     uint32_t dstVRAMEndAddr   = dstVRAMStartAddr + newColEnd;
     uint32_t dstARAMStartAddr = VIDEO_ARAM_BASE_ADDR+(newRow*VC_MAX_COLUMNS)+newColStart; 
 
+  #if defined(VC_HW_SCROLL)
+    // The display wraps within the video RAM, clear a byte at a time relative to the scroll start.
+    for(uint32_t pos = dstVRAMStartAddr - VIDEO_VRAM_BASE_ADDR; pos <= dstVRAMEndAddr - VIDEO_VRAM_BASE_ADDR; pos++)
+    {
+        *(uint8_t *)(uintptr_t)(VIDEO_VRAM_BASE_ADDR + VC_VRAM_OFFSET(0, pos)) = 0x00;
+        *(uint8_t *)(uintptr_t)(VIDEO_ARAM_BASE_ADDR + VC_VRAM_OFFSET(0, pos)) = display.screenAttr;
+    }
+  #else
     // Select 32bit or 8 bit clear depending on the start/end position.
     //
     if((dstVRAMStartAddr&0x3) == 0 && (dstVRAMEndAddr&0x3) ==0)
@@ -919,25 +1033,22 @@ void mzClearLine(int row, int colStart, int colEnd, uint8_t updPos)
         uint32_t screenAttr = display.screenAttr << 24 | display.screenAttr << 16 | display.screenAttr << 8 | display.screenAttr;
         for(uint32_t dstVRAMAddr=dstVRAMStartAddr, dstARAMAddr = dstARAMStartAddr; dstVRAMAddr < dstVRAMEndAddr; dstVRAMAddr+=4, dstARAMAddr+=4)
         {
-            *(uint32_t *)(dstVRAMAddr) = 0x00000000;
-            *(uint32_t *)(dstARAMAddr) = screenAttr;
+            *(uint32_t *)(uintptr_t)(dstVRAMAddr) = 0x00000000;
+            *(uint32_t *)(uintptr_t)(dstARAMAddr) = screenAttr;
         }
     } else
     {
         for(uint32_t dstVRAMAddr=dstVRAMStartAddr, dstARAMAddr = dstARAMStartAddr; dstVRAMAddr <= dstVRAMEndAddr; dstVRAMAddr+=1, dstARAMAddr+=1)
         {
-            *(uint8_t *)(dstVRAMAddr) = 0x00;
-            *(uint8_t *)(dstARAMAddr) = display.screenAttr;
+            *(uint8_t *)(uintptr_t)(dstVRAMAddr) = 0x00;
+            *(uint8_t *)(uintptr_t)(dstARAMAddr) = display.screenAttr;
         }
     }
+  #endif
 
     // Clear the shadow display scrollback RAM.
     uint32_t startIdx = (((display.screenRow < display.maxDisplayRow ? newRow : (display.screenRow - display.maxDisplayRow + newRow))) * display.maxScreenCol) + newColStart;
-    for(uint32_t dstAddr = startIdx; dstAddr <= startIdx + newColEnd; dstAddr++)
-    {
-        display.screenCharBuf[dstAddr] = 0x20;
-        display.screenAttrBuf[dstAddr] = display.screenAttr;
-    }
+    mzClearBuffer(startIdx, startIdx + newColEnd + 1);
 
     // Update the screen pointer if needed.
     if(updPos)
@@ -992,7 +1103,7 @@ uint8_t mzSetMachineVideoMode(uint8_t vmode)
         return(1);
     
     // Set the hardware video mode.
-    *(volatile uint8_t *)(VCADDR_8BIT_VMCTRL) = mode | hwmode;
+    *(volatile uint8_t *)(VCADDR_8BIT_VMCTRL) = mode | vmode;
 
     return(0);
 }
@@ -1027,25 +1138,40 @@ uint8_t mzSetScreenWidth(uint8_t width)
         display.maxScreenCol = 80;
     }
 
+    // The row layout has changed, the next scroll rewrites the display.
+    display.vramTop = 0xFF;
+
     return(0);
 }
 
 // Method to refresh the screen from the scrollback buffer contents.
 void mzRefreshScreen(void)
 {
+  #if defined(VC_HW_SCROLL)
+    // Return the display start to the beginning of the video RAM.
+    display.hwScroll = 0;
+    (void)*(volatile uint8_t *)(VCADDR_8BIT_SCLDSP);
+  #endif
+
     // Refresh the screen with buffer window contents
-    uint32_t startIdx = (display.screenRow < display.maxDisplayRow ? 0 : (display.screenRow - display.maxDisplayRow)+1) * display.maxScreenCol;
-    for(uint32_t srcIdx = startIdx, dstVRAMAddr = VIDEO_VRAM_BASE_ADDR, dstARAMAddr = VIDEO_ARAM_BASE_ADDR; srcIdx < startIdx+(display.maxDisplayRow*display.maxScreenCol); srcIdx++)
-    {
-        *(uint8_t *)(dstVRAMAddr++) = dispCodeMap[display.screenCharBuf[srcIdx]].dispCode;
-        *(uint8_t *)(dstARAMAddr++) = display.screenAttrBuf[srcIdx];
-    }
+    mzRefreshRows(0, display.maxDisplayRow);
+    display.vramTop = mzWindowRing();
 }
 
 // Method to scroll the screen contents upwards, either because new data is being added to the bottom or for scrollback.
+// At the end of the backing store the ring head is advanced, the display is moved up and only the rows exposed are
+// written, so a scroll costs a row rather than the whole buffer and screen.
 //
 uint8_t mzScrollUp(uint8_t lines, uint8_t clear)
 {
+    // Locals.
+    uint32_t clearPos = 0;
+    uint32_t clearEnd = 0;
+    uint8_t  inStep;
+    uint8_t  shift;
+    int      first;
+    int      last;
+
     // Sanity check.
     if(lines > display.maxDisplayRow)
         return(1);
@@ -1053,6 +1179,9 @@ uint8_t mzScrollUp(uint8_t lines, uint8_t clear)
     // Restore cursor character before scrolling.
     mzFlashCursor(CURSOR_RESTORE);
 
+    // The display can only be moved if it currently shows the buffer window, otherwise it is rewritten.
+    inStep = (display.vramTop == mzWindowRing());
+
     // Add the lines to the current row address. If the row exceeds the maximum then scroll the screen up.
     display.screenRow += lines;
     display.displayRow += lines;
@@ -1061,39 +1190,47 @@ uint8_t mzScrollUp(uint8_t lines, uint8_t clear)
         display.displayRow = display.maxDisplayRow - 1;
     }
 
-    // At end of buffer? Shift up.
+    // At end of buffer? Advance the ring head past the rows overflowing, the rows entering at the end are cleared.
     if(display.screenRow >= display.maxScreenRow)
     {
-        uint32_t srcAddr = (lines * display.maxScreenCol);
-        uint32_t dstAddr = 0;
-        for(; srcAddr < VC_DISPLAY_BUFFER_SIZE; srcAddr++, dstAddr++)
-        {
-            display.screenCharBuf[dstAddr] = display.screenCharBuf[srcAddr];
-            display.screenAttrBuf[dstAddr] = display.screenAttrBuf[srcAddr];
-        }
-        for(; dstAddr < VC_DISPLAY_BUFFER_SIZE; dstAddr++)
-        {
-            display.screenCharBuf[dstAddr] = 0x20;
-            display.screenAttrBuf[dstAddr] = display.screenAttr;
-        }
+        display.headRow   = (display.headRow + display.screenRow - (display.maxScreenRow-1)) % display.maxScreenRow;
         display.screenRow = display.maxScreenRow-1;
+        clearPos = (display.maxScreenRow - lines) * display.maxScreenCol;
+        clearEnd = display.maxScreenRow * display.maxScreenCol;
     }
     // If we havent scrolled at the end of the buffer then clear the lines scrolled if requested.
     else if(clear && display.displayRow == display.maxDisplayRow - 1)
     {
-        uint32_t startIdx = (display.screenRow - lines + 1) * display.maxScreenCol;
-        uint32_t endIdx   = startIdx + (lines * display.maxScreenCol);
+        clearPos = (display.screenRow - lines + 1) * display.maxScreenCol;
+        clearEnd = clearPos + (lines * display.maxScreenCol);
+    }
+    mzClearBuffer(clearPos, clearEnd);
 
-        // Clear the shadow display scrollback RAM.
-        for(uint32_t dstAddr = startIdx; dstAddr < endIdx; dstAddr++)
+    // Rows the window has moved through the ring.
+    shift = (mzWindowRing() + display.maxScreenRow - display.vramTop) % display.maxScreenRow;
+    if(!inStep || shift >= display.maxDisplayRow)
+    {
+        mzRefreshScreen();
+    } else
+    {
+        if(shift > 0)
+        {
+            mzShiftDisplay(shift);
+            mzRefreshRows(display.maxDisplayRow - shift, shift);
+            display.vramTop = mzWindowRing();
+        }
+
+        // Cleared rows on the display which have not just been written.
+        if(clearEnd > clearPos)
         {
-            display.screenCharBuf[dstAddr] = 0x20;
-            display.screenAttrBuf[dstAddr] = display.screenAttr;
+            first = (int)(clearPos / display.maxScreenCol) - (int)mzWindowTop();
+            last  = first + lines;
+            if(first < 0) first = 0;
+            if(last > display.maxDisplayRow - shift) last = display.maxDisplayRow - shift;
+            if(first < last)
+                mzRefreshRows(first, last - first);
         }
     }
-       
-    // Refresh the screen with buffer window contents
-    mzRefreshScreen();
     return(0);
 }
 
@@ -1233,13 +1370,13 @@ int mzPutChar(char c, FILE *stream)
     if(output)
     {
         // Output character using default attributes.
-        dispMemAddr = VIDEO_VRAM_BASE_ADDR + (display.displayRow * display.maxScreenCol) + display.displayCol;
-        *(uint8_t *)(dispMemAddr) = (char)dispCodeMap[c].dispCode;
-        display.screenCharBuf[(display.screenRow * display.maxScreenCol) + display.displayCol] = c;
+        dispMemAddr = VIDEO_VRAM_BASE_ADDR + VC_VRAM_OFFSET(display.displayRow, display.displayCol);
+        *(uint8_t *)(uintptr_t)(dispMemAddr) = (char)dispCodeMap[c].dispCode;
+        display.screenCharBuf[mzBufIdx((display.screenRow * display.maxScreenCol) + display.displayCol)] = c;
         //
-        dispMemAddr = VIDEO_ARAM_BASE_ADDR + (display.displayRow * display.maxScreenCol) + display.displayCol;
-        *(uint8_t *)(dispMemAddr) = display.screenAttr;
-        display.screenAttrBuf[(display.screenRow * display.maxScreenCol) + display.displayCol] = display.screenAttr;
+        dispMemAddr = VIDEO_ARAM_BASE_ADDR + VC_VRAM_OFFSET(display.displayRow, display.displayCol);
+        *(uint8_t *)(uintptr_t)(dispMemAddr) = display.screenAttr;
+        display.screenAttrBuf[mzBufIdx((display.screenRow * display.maxScreenCol) + display.displayCol)] = display.screenAttr;
         if(++display.displayCol >= display.maxScreenCol)
         {
             if(display.lineWrap)
@@ -1281,13 +1418,13 @@ int mzPutRaw(char c)
     uint32_t dispMemAddr;
 
     // Output character using default attributes.
-    dispMemAddr = VIDEO_VRAM_BASE_ADDR + (display.displayRow * display.maxScreenCol) + display.displayCol;
-    *(uint8_t *)(dispMemAddr) = (char)dispCodeMap[c].dispCode;
-    display.screenCharBuf[(display.screenRow * display.maxScreenCol) + display.displayCol] = c;
+    dispMemAddr = VIDEO_VRAM_BASE_ADDR + VC_VRAM_OFFSET(display.displayRow, display.displayCol);
+    *(uint8_t *)(uintptr_t)(dispMemAddr) = (char)dispCodeMap[c].dispCode;
+    display.screenCharBuf[mzBufIdx((display.screenRow * display.maxScreenCol) + display.displayCol)] = c;
     //
-    dispMemAddr = VIDEO_ARAM_BASE_ADDR + (display.displayRow * display.maxScreenCol) + display.displayCol;
-    *(uint8_t *)(dispMemAddr) = display.screenAttr;
-    display.screenAttrBuf[(display.screenRow * display.maxScreenCol) + display.displayCol] = display.screenAttr;
+    dispMemAddr = VIDEO_ARAM_BASE_ADDR + VC_VRAM_OFFSET(display.displayRow, display.displayCol);
+    *(uint8_t *)(uintptr_t)(dispMemAddr) = display.screenAttr;
+    display.screenAttrBuf[mzBufIdx((display.screenRow * display.maxScreenCol) + display.displayCol)] = display.screenAttr;
     if(++display.displayCol >= display.maxScreenCol)
     {
         if(display.lineWrap)
@@ -1859,8 +1996,8 @@ void mzDebugOut(uint8_t set, uint8_t data1)
 uint8_t mzFlashCursor(enum CURSOR_STATES state)
 {
     // Locals.
-    uint32_t dispMemAddr = VIDEO_VRAM_BASE_ADDR + (display.displayRow * display.maxScreenCol) + display.displayCol;
-    uint16_t srcIdx = (display.screenRow * display.maxScreenCol) + display.displayCol;
+    uint32_t dispMemAddr = VIDEO_VRAM_BASE_ADDR + VC_VRAM_OFFSET(display.displayRow, display.displayCol);
+    uint16_t srcIdx = mzBufIdx((display.screenRow * display.maxScreenCol) + display.displayCol);
 
     // Action according to request.
     switch(state)
@@ -1871,7 +2008,7 @@ uint8_t mzFlashCursor(enum CURSOR_STATES state)
             // Only restore character if it had been previously saved and active.
             if(keyboard.cursorOn == 1 && keyboard.displayCursor == 1)
             {
-                *(uint8_t *)(dispMemAddr) = dispCodeMap[display.screenCharBuf[srcIdx]].dispCode;
+                *(uint8_t *)(uintptr_t)(dispMemAddr) = dispCodeMap[display.screenCharBuf[srcIdx]].dispCode;
             }
             keyboard.cursorOn = 0;
             break;
@@ -1885,7 +2022,7 @@ uint8_t mzFlashCursor(enum CURSOR_STATES state)
         case CURSOR_RESTORE:
             if(keyboard.displayCursor == 1)
             {
-                *(uint8_t *)(dispMemAddr) = dispCodeMap[display.screenCharBuf[srcIdx]].dispCode;
+                *(uint8_t *)(uintptr_t)(dispMemAddr) = dispCodeMap[display.screenCharBuf[srcIdx]].dispCode;
             }
             break;
 
@@ -1900,19 +2037,19 @@ uint8_t mzFlashCursor(enum CURSOR_STATES state)
                     switch(keyboard.mode)
                     {
                         case KEYB_LOWERCASE:
-                            *(uint8_t *)(dispMemAddr) = CURSOR_UNDERLINE;
+                            *(uint8_t *)(uintptr_t)(dispMemAddr) = CURSOR_UNDERLINE;
                             break;
                         case KEYB_CAPSLOCK:
-                            *(uint8_t *)(dispMemAddr) = CURSOR_BLOCK;
+                            *(uint8_t *)(uintptr_t)(dispMemAddr) = CURSOR_BLOCK;
                             break;
                         case KEYB_SHIFTLOCK:
                         default:
-                            *(uint8_t *)(dispMemAddr) = CURSOR_THICK_BLOCK;
+                            *(uint8_t *)(uintptr_t)(dispMemAddr) = CURSOR_THICK_BLOCK;
                             break;
                     }
                 } else
                 {
-                    *(uint8_t *)(dispMemAddr) = dispCodeMap[display.screenCharBuf[srcIdx]].dispCode;
+                    *(uint8_t *)(uintptr_t)(dispMemAddr) = dispCodeMap[display.screenCharBuf[srcIdx]].dispCode;
                 }
             }
             break;
@@ -2266,9 +2403,9 @@ uint8_t mzSDRead(uint8_t drive, uint32_t sector, uint32_t buffer)
     if((uint8_t)status == TZSVC_STATUS_OK)
     {
         // Copy the received sector into the provided buffer.
-        for(uint32_t srcAddr=(uint32_t)svcControl->sector, dstAddr=buffer; dstAddr < buffer+TZSVC_SECTOR_SIZE; srcAddr++, dstAddr++)
+        for(uint32_t srcAddr=(uint32_t)(uintptr_t)svcControl->sector, dstAddr=buffer; dstAddr < buffer+TZSVC_SECTOR_SIZE; srcAddr++, dstAddr++)
         {
-            *(uint8_t *)(dstAddr) = *(uint8_t *)srcAddr;
+            *(uint8_t *)(uintptr_t)(dstAddr) = *(uint8_t *)(uintptr_t)srcAddr;
         }
     } else
     {
@@ -2290,9 +2427,9 @@ uint8_t mzSDWrite(uint8_t drive, uint32_t sector, uint32_t buffer)
     svcControl->sectorLBA = convBigToLittleEndian(sector);
    
     // Copy the provided buffer into service control record sector buffer.
-    for(uint32_t srcAddr=buffer, dstAddr=(uint32_t)svcControl->sector; srcAddr < buffer+TZSVC_SECTOR_SIZE; srcAddr++, dstAddr++)
+    for(uint32_t srcAddr=buffer, dstAddr=(uint32_t)(uintptr_t)svcControl->sector; srcAddr < buffer+TZSVC_SECTOR_SIZE; srcAddr++, dstAddr++)
     {
-        *(uint8_t *)(dstAddr) = *(uint8_t *)srcAddr;
+        *(uint8_t *)(uintptr_t)(dstAddr) = *(uint8_t *)(uintptr_t)srcAddr;
     }
  
     // Make the disk write service call.
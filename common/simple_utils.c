@@ -12,6 +12,7 @@
 // Copyright:       (c) 2019 Philip Smart <philip.smart@net2net.org>
 //
 // History:         January 2019   - Initial script written.
+//                  Oct 2026       - CRC32 moved into crc32.c.
 //
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 // This source file is free software: you can redistribute it and#or modify
@@ -114,43 +115,7 @@ int memoryDump(uint32_t memaddr, uint32_t memsize)
 }
 #endif
 
-// Function to setup the CRC polynomial table prior to use.
-//
 #if !defined(FUNCTIONALITY) || FUNCTIONALITY == 0
-static unsigned int crc32table[256];
-unsigned int crc32_init(void)
-{
-    int j;
-    unsigned int byte, crc, mask;
-
-    for(byte = 0; byte <= 255; byte++)
-    {
-        crc = byte;
-        for (j = 7; j >= 0; j--)
-        {
-           mask = -(crc & 1);
-           crc = (crc >> 1) ^ (0xEDB88320 & mask);
-        }
-        crc32table[byte] = crc;
-    }
-
-    // Starting value for CRC calculation.
-    //
-    return 0xFFFFFFFF;
-}
-
-// Function to add a word into the CRC sum.
-//
-unsigned int crc32_addword(unsigned int crc_in, unsigned int word)
-{
-   crc_in = (crc_in >> 8) ^ crc32table[(crc_in ^ ((word >> 24)&0xFF)) & 0xFF];
-   crc_in = (crc_in >> 8) ^ crc32table[(crc_in ^ ((word >> 16)&0xFF)) & 0xFF];
-   crc_in = (crc_in >> 8) ^ crc32table[(crc_in ^ ((word >>  8)&0xFF)) & 0xFF];
-   crc_in = (crc_in >> 8) ^ crc32table[(crc_in ^ (word        &0xFF)) & 0xFF];
-
-   return crc_in;
-}
-
 // Function to read a 32bit word from the active serial port.
 //
 unsigned int get_dword(void)
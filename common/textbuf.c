@@ -0,0 +1,753 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            textbuf.c
+// Created:         Oct 2026
+// Version:         v1.0
+// Author(s):       Philip Smart
+// Description:     Piece table text storage.
+//                  The editors originally read the whole file into memory as an array of rows, each with
+//                  its own allocations, which limits the file size to a fraction of the heap and fragments
+//                  it. This module leaves the file on the SD card and describes the text as a table of
+//                  pieces, each a span of the original file or of an append only buffer holding the
+//                  inserted text. Opening a file is a single pass to count the lines, the file being
+//                  indexed into pieces of at most TB_PIECE_LINES lines so that finding a line scans no more
+//                  than one piece. An insert splits a piece and adds one for the new text, consecutive
+//                  inserts, as when typing, extend the same piece. A delete trims or splits pieces.
+//
+//                  Every line ends with a newline, one is added if the file does not end with one. A line
+//                  ending in CR/LF is returned without the CR and is written back unchanged.
+//
+//                  On save the text is written to a temporary file which then replaces the original, the
+//                  pieces are then rebased onto the new file and the add buffer released.
+//
+// Credits:
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         v1.0 Oct 2026  - Initial write.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ff.h"
+#include "textbuf.h"
+
+#if defined __APP__
+  #define     malloc     sys_malloc
+  #define     realloc    sys_realloc
+  #define     free       sys_free
+  void        *sys_malloc(size_t);            // Allocate memory managed by the OS.
+  void        *sys_realloc(void *, size_t);   // Reallocate a block of memory managed by the OS.
+  void        sys_free(void *);               // Free memory managed by the OS.
+#endif
+
+// Method to read part of a piece into a buffer.
+//
+static int tbRead(t_textBuf *tb, const t_piece *pc, uint32_t off, char *dst, uint32_t len)
+{
+    // Locals.
+    uint32_t   pos = pc->offset + off;
+    UINT       readSize;
+
+    if(pc->src == TB_SRC_ADD)
+    {
+        memcpy(dst, tb->add + pos, len);
+        return(TB_OK);
+    }
+    if(tb->file == NULL)
+        return(TB_IO_ERROR);
+    if(f_tell(tb->file) != pos && f_lseek(tb->file, pos) != FR_OK)
+        return(TB_IO_ERROR);
+    if(f_read(tb->file, dst, len, &readSize) != FR_OK || readSize != len)
+        return(TB_IO_ERROR);
+    tb->fileReads++;
+    return(TB_OK);
+}
+
+// Method to count the newlines in part of a piece.
+//
+static int tbCount(t_textBuf *tb, const t_piece *pc, uint32_t off, uint32_t len, uint32_t *lines)
+{
+    // Locals.
+    char       buf[TB_COPY_SIZE];
+    const char *data;
+    const char *ptr;
+    uint32_t   size;
+
+    *lines = 0;
+    while(len)
+    {
+        size = len > TB_COPY_SIZE ? TB_COPY_SIZE : len;
+        if(pc->src == TB_SRC_ADD)
+        {
+            data = tb->add + pc->offset + off;
+            size = len;
+        } else
+        {
+            if(tbRead(tb, pc, off, buf, size) != TB_OK)
+                return(TB_IO_ERROR);
+            data = buf;
+        }
+        for(ptr=data; (ptr = memchr(ptr, '\n', size - (ptr - data))) != NULL; ptr++)
+            (*lines)++;
+        off += size;
+        len -= size;
+    }
+    return(TB_OK);
+}
+
+// Method to find the offset within a piece following its nth newline.
+//
+static int tbScan(t_textBuf *tb, const t_piece *pc, uint32_t nth, uint32_t *off)
+{
+    // Locals.
+    char       buf[TB_COPY_SIZE];
+    const char *data;
+    const char *ptr;
+    uint32_t   pos = 0;
+    uint32_t   size;
+
+    while(pos < pc->len)
+    {
+        size = pc->len - pos > TB_COPY_SIZE ? TB_COPY_SIZE : pc->len - pos;
+        if(pc->src == TB_SRC_ADD)
+        {
+            data = tb->add + pc->offset + pos;
+            size = pc->len - pos;
+        } else
+        {
+            if(tbRead(tb, pc, pos, buf, size) != TB_OK)
+                return(TB_IO_ERROR);
+            data = buf;
+        }
+        for(ptr=data; (ptr = memchr(ptr, '\n', size - (ptr - data))) != NULL; ptr++)
+        {
+            if(--nth == 0)
+            {
+                *off = pos + (ptr - data) + 1;
+                return(TB_OK);
+            }
+        }
+        pos += size;
+    }
+    *off = pc->len;
+    return(TB_OK);
+}
+
+// Method to open a gap of count pieces at index at.
+//
+static int tbMakeRoom(t_textBuf *tb, uint32_t at, uint32_t count)
+{
+    // Locals.
+    t_piece    *piece;
+
+    if(tb->pieces + count > tb->maxPieces)
+    {
+        piece = realloc(tb->piece, (tb->maxPieces + count + TB_PIECE_CHUNK) * sizeof(t_piece));
+        if(piece == NULL)
+            return(TB_NO_MEMORY);
+        tb->piece      = piece;
+        tb->maxPieces += count + TB_PIECE_CHUNK;
+    }
+    memmove(&tb->piece[at + count], &tb->piece[at], (tb->pieces - at) * sizeof(t_piece));
+    tb->pieces += count;
+    return(TB_OK);
+}
+
+// Method to ensure the add buffer has room for len more bytes.
+//
+static int tbAddRoom(t_textBuf *tb, uint32_t len)
+{
+    // Locals.
+    char       *add;
+
+    if(tb->addLen + len > tb->addSize)
+    {
+        add = realloc(tb->add, tb->addLen + len + TB_ADD_CHUNK);
+        if(add == NULL)
+            return(TB_NO_MEMORY);
+        tb->add     = add;
+        tb->addSize = tb->addLen + len + TB_ADD_CHUNK;
+    }
+    return(TB_OK);
+}
+
+// Edits invalidate the search hint, restart from the first piece.
+//
+static void tbResetHint(t_textBuf *tb)
+{
+    tb->hintPiece = 0;
+    tb->hintPos   = 0;
+    tb->hintLine  = 0;
+}
+
+// Method to locate the piece holding a text offset. An offset at the end of the text gives the piece count.
+//
+static void tbLocate(t_textBuf *tb, uint32_t pos, uint32_t *idx, uint32_t *off)
+{
+    // Locals.
+    uint32_t   p     = tb->hintPiece;
+    uint32_t   start = tb->hintPos;
+    uint32_t   line  = tb->hintLine;
+
+    if(p >= tb->pieces || pos < start)
+    {
+        p = start = line = 0;
+    }
+    while(p < tb->pieces && pos >= start + tb->piece[p].len)
+    {
+        start += tb->piece[p].len;
+        line  += tb->piece[p].lines;
+        p++;
+    }
+    if(p < tb->pieces)
+    {
+        tb->hintPiece = p;
+        tb->hintPos   = start;
+        tb->hintLine  = line;
+    }
+    *idx = p;
+    *off = pos - start;
+}
+
+// Method to find the text offset of the start of a line.
+//
+static int tbLineStart(t_textBuf *tb, uint32_t line, uint32_t *pos)
+{
+    // Locals.
+    uint32_t   p     = tb->hintPiece;
+    uint32_t   start = tb->hintPos;
+    uint32_t   cum   = tb->hintLine;
+    uint32_t   off;
+
+    if(line == 0 || line >= tb->lines)
+    {
+        *pos = line == 0 ? 0 : tb->size;
+        return(TB_OK);
+    }
+
+    // The line starts after newline number 'line', find the piece holding it.
+    if(p >= tb->pieces || cum >= line)
+    {
+        p = start = cum = 0;
+    }
+    while(p < tb->pieces && cum + tb->piece[p].lines < line)
+    {
+        start += tb->piece[p].len;
+        cum   += tb->piece[p].lines;
+        p++;
+    }
+    if(p == tb->pieces)
+        return(TB_IO_ERROR);
+    tb->hintPiece = p;
+    tb->hintPos   = start;
+    tb->hintLine  = cum;
+
+    if(tbScan(tb, &tb->piece[p], line - cum, &off) != TB_OK)
+        return(TB_IO_ERROR);
+    *pos = start + off;
+    return(TB_OK);
+}
+
+// Method to insert text at a text offset.
+//
+static int tbInsertAt(t_textBuf *tb, uint32_t pos, const char *s, uint32_t len)
+{
+    // Locals.
+    uint32_t   lines = 0;
+    uint32_t   head;
+    uint32_t   idx;
+    uint32_t   off;
+    t_piece    *pc;
+    const char *ptr;
+
+    if(len == 0)
+        return(TB_OK);
+    if(pos > tb->size)
+        return(TB_IO_ERROR);
+    for(ptr=s; (ptr = memchr(ptr, '\n', len - (ptr - s))) != NULL; ptr++)
+        lines++;
+    if(tbAddRoom(tb, len) != TB_OK)
+        return(TB_NO_MEMORY);
+    tbLocate(tb, pos, &idx, &off);
+
+    // Extend the previous piece when the insert follows on from it in the add buffer, as when typing.
+    if(off == 0 && idx > 0 && tb->piece[idx-1].src == TB_SRC_ADD && tb->piece[idx-1].offset + tb->piece[idx-1].len == tb->addLen)
+    {
+        pc = &tb->piece[idx-1];
+    } else
+    if(off == 0)
+    {
+        if(tbMakeRoom(tb, idx, 1) != TB_OK)
+            return(TB_NO_MEMORY);
+        pc = &tb->piece[idx];
+        pc->src    = TB_SRC_ADD;
+        pc->offset = tb->addLen;
+        pc->len    = 0;
+        pc->lines  = 0;
+    } else
+    {
+        // Split the piece around the insertion point.
+        if(tbCount(tb, &tb->piece[idx], 0, off, &head) != TB_OK)
+            return(TB_IO_ERROR);
+        if(tbMakeRoom(tb, idx+1, 2) != TB_OK)
+            return(TB_NO_MEMORY);
+        tb->piece[idx+2]         = tb->piece[idx];
+        tb->piece[idx+2].offset += off;
+        tb->piece[idx+2].len    -= off;
+        tb->piece[idx+2].lines  -= head;
+        tb->piece[idx].len       = off;
+        tb->piece[idx].lines     = head;
+        pc = &tb->piece[idx+1];
+        pc->src    = TB_SRC_ADD;
+        pc->offset = tb->addLen;
+        pc->len    = 0;
+        pc->lines  = 0;
+    }
+    memcpy(tb->add + tb->addLen, s, len);
+    tb->addLen += len;
+    pc->len    += len;
+    pc->lines  += lines;
+    tb->size   += len;
+    tb->lines  += lines;
+    tbResetHint(tb);
+    return(TB_OK);
+}
+
+// Method to delete text starting at a text offset.
+//
+static int tbDeleteAt(t_textBuf *tb, uint32_t pos, uint32_t len)
+{
+    // Locals.
+    uint32_t   idx;
+    uint32_t   off;
+    uint32_t   take;
+    uint32_t   lines;
+    uint32_t   head;
+    t_piece    *pc;
+
+    if(pos >= tb->size)
+        return(TB_OK);
+    if(len > tb->size - pos)
+        len = tb->size - pos;
+    tbLocate(tb, pos, &idx, &off);
+
+    while(len && idx < tb->pieces)
+    {
+        pc   = &tb->piece[idx];
+        take = pc->len - off > len ? len : pc->len - off;
+        if(tbCount(tb, pc, off, take, &lines) != TB_OK)
+            return(TB_IO_ERROR);
+
+        if(off == 0 && take == pc->len)
+        {
+            // Whole piece.
+            memmove(pc, pc+1, (tb->pieces - idx - 1) * sizeof(t_piece));
+            tb->pieces--;
+        } else
+        if(off == 0)
+        {
+            // Front of the piece.
+            pc->offset += take;
+            pc->len    -= take;
+            pc->lines  -= lines;
+        } else
+        if(off + take == pc->len)
+        {
+            // Tail of the piece.
+            pc->len    -= take;
+            pc->lines  -= lines;
+            idx++;
+        } else
+        {
+            // Middle of the piece, split it.
+            if(tbCount(tb, pc, 0, off, &head) != TB_OK)
+                return(TB_IO_ERROR);
+            if(tbMakeRoom(tb, idx+1, 1) != TB_OK)
+                return(TB_NO_MEMORY);
+            pc = &tb->piece[idx];
+            tb->piece[idx+1]         = *pc;
+            tb->piece[idx+1].offset += off + take;
+            tb->piece[idx+1].len    -= off + take;
+            tb->piece[idx+1].lines  -= head + lines;
+            pc->len                  = off;
+            pc->lines                = head;
+        }
+        tb->size  -= take;
+        tb->lines -= lines;
+        len       -= take;
+        off        = 0;
+    }
+    tbResetHint(tb);
+    return(TB_OK);
+}
+
+// Method to initialise an empty text buffer with no file.
+//
+void tbInit(t_textBuf *tb)
+{
+    memset(tb, 0x00, sizeof(t_textBuf));
+}
+
+// Method to open a file, creating it if it doesnt exist, and index it into pieces.
+//
+int tbOpen(t_textBuf *tb, const char *name)
+{
+    // Locals.
+    char       buf[TB_COPY_SIZE];
+    const char *ptr;
+    uint32_t   fileSize;
+    uint32_t   pos       = 0;
+    uint32_t   start     = 0;
+    uint32_t   lines     = 0;
+    char       last      = '\n';
+    UINT       readSize;
+
+    tbInit(tb);
+    if((tb->name = malloc(strlen(name)+1)) == NULL || (tb->file = malloc(sizeof(FIL))) == NULL)
+    {
+        tbFree(tb);
+        return(TB_NO_MEMORY);
+    }
+    strcpy(tb->name, name);
+    if(f_open(tb->file, name, FA_OPEN_ALWAYS | FA_READ) != FR_OK)
+    {
+        free(tb->file);
+        tb->file = NULL;
+        tbFree(tb);
+        return(TB_IO_ERROR);
+    }
+
+    // Single pass through the file, cutting a piece every TB_PIECE_LINES lines.
+    fileSize = f_size(tb->file);
+    while(pos < fileSize)
+    {
+        if(f_read(tb->file, buf, sizeof(buf), &readSize) != FR_OK || readSize == 0)
+        {
+            tbFree(tb);
+            return(TB_IO_ERROR);
+        }
+        tb->fileReads++;
+        for(ptr=buf; (ptr = memchr(ptr, '\n', readSize - (ptr - buf))) != NULL; ptr++)
+        {
+            tb->lines++;
+            if(++lines == TB_PIECE_LINES)
+            {
+                if(tbMakeRoom(tb, tb->pieces, 1) != TB_OK)
+                {
+                    tbFree(tb);
+                    return(TB_NO_MEMORY);
+                }
+                tb->piece[tb->pieces-1].src    = TB_SRC_FILE;
+                tb->piece[tb->pieces-1].offset = start;
+                tb->piece[tb->pieces-1].len    = pos + (ptr - buf) + 1 - start;
+                tb->piece[tb->pieces-1].lines  = lines;
+                start = pos + (ptr - buf) + 1;
+                lines = 0;
+            }
+        }
+        last = buf[readSize-1];
+        pos += readSize;
+    }
+    if(start < fileSize)
+    {
+        if(tbMakeRoom(tb, tb->pieces, 1) != TB_OK)
+        {
+            tbFree(tb);
+            return(TB_NO_MEMORY);
+        }
+        tb->piece[tb->pieces-1].src    = TB_SRC_FILE;
+        tb->piece[tb->pieces-1].offset = start;
+        tb->piece[tb->pieces-1].len    = fileSize - start;
+        tb->piece[tb->pieces-1].lines  = lines;
+    }
+    tb->size = fileSize;
+
+    // Terminate an unterminated last line.
+    if(last != '\n' && tbInsertAt(tb, tb->size, "\n", 1) != TB_OK)
+    {
+        tbFree(tb);
+        return(TB_NO_MEMORY);
+    }
+    return(TB_OK);
+}
+
+// Method to close the file and release all memory.
+//
+void tbFree(t_textBuf *tb)
+{
+    if(tb->file != NULL)
+    {
+        f_close(tb->file);
+        free(tb->file);
+    }
+    if(tb->name != NULL)
+        free(tb->name);
+    if(tb->piece != NULL)
+        free(tb->piece);
+    if(tb->add != NULL)
+        free(tb->add);
+    tbInit(tb);
+}
+
+// Method to copy a line, without its line ending, into a buffer of size bytes, truncating if needed. The buffer
+// is always terminated. Returns the length of the line, which may exceed the buffer, or -1 on error.
+//
+int tbGetLine(t_textBuf *tb, uint32_t line, char *dst, int size)
+{
+    // Locals.
+    char       buf[TB_COPY_SIZE];
+    const char *data;
+    const char *nl;
+    uint32_t   pos;
+    uint32_t   idx;
+    uint32_t   off;
+    uint32_t   avail;
+    uint32_t   copy;
+    int        len       = 0;
+    char       last      = '\0';
+
+    if(line >= tb->lines || size < 1 || tbLineStart(tb, line, &pos) != TB_OK)
+        return(-1);
+    tbLocate(tb, pos, &idx, &off);
+
+    while(idx < tb->pieces)
+    {
+        avail = tb->piece[idx].len - off;
+        if(tb->piece[idx].src == TB_SRC_ADD)
+        {
+            data = tb->add + tb->piece[idx].offset + off;
+        } else
+        {
+            avail = avail > TB_COPY_SIZE ? TB_COPY_SIZE : avail;
+            if(tbRead(tb, &tb->piece[idx], off, buf, avail) != TB_OK)
+                return(-1);
+            data = buf;
+        }
+        nl   = memchr(data, '\n', avail);
+        copy = nl == NULL ? avail : (uint32_t)(nl - data);
+        if(copy)
+        {
+            if(len < size-1)
+                memcpy(dst + len, data, (int)copy > size-1-len ? (uint32_t)(size-1-len) : copy);
+            last = data[copy-1];
+            len += copy;
+        }
+        if(nl != NULL)
+            break;
+        off += avail;
+        if(off == tb->piece[idx].len)
+        {
+            idx++;
+            off = 0;
+        }
+    }
+    if(last == '\r')
+        len--;
+    dst[len < size-1 ? len : size-1] = '\0';
+    return(len);
+}
+
+// Method to insert text at a line and column, the column must be within the line.
+//
+int tbInsert(t_textBuf *tb, uint32_t line, uint32_t col, const char *s, uint32_t len)
+{
+    // Locals.
+    uint32_t   pos;
+
+    if(line > tb->lines || tbLineStart(tb, line, &pos) != TB_OK)
+        return(TB_IO_ERROR);
+    return(tbInsertAt(tb, pos + col, s, len));
+}
+
+// Method to delete text at a line and column.
+//
+int tbDelete(t_textBuf *tb, uint32_t line, uint32_t col, uint32_t len)
+{
+    // Locals.
+    uint32_t   pos;
+
+    if(line >= tb->lines || tbLineStart(tb, line, &pos) != TB_OK)
+        return(TB_IO_ERROR);
+    return(tbDeleteAt(tb, pos + col, len));
+}
+
+// Method to join a line to the one following by removing its line ending.
+//
+int tbJoinLines(t_textBuf *tb, uint32_t line)
+{
+    // Locals.
+    uint32_t   pos;
+    uint32_t   idx;
+    uint32_t   off;
+    char       c         = '\0';
+
+    if(line+1 >= tb->lines)
+        return(TB_OK);
+    if(tbLineStart(tb, line+1, &pos) != TB_OK)
+        return(TB_IO_ERROR);
+
+    // CR/LF line endings are removed as a pair.
+    if(pos >= 2)
+    {
+        tbLocate(tb, pos-2, &idx, &off);
+        if(tbRead(tb, &tb->piece[idx], off, &c, 1) != TB_OK)
+            return(TB_IO_ERROR);
+    }
+    return(c == '\r' ? tbDeleteAt(tb, pos-2, 2) : tbDeleteAt(tb, pos-1, 1));
+}
+
+// Method to write the text to a file. Saving over the original file writes a temporary file in the same
+// directory which then replaces it, the pieces are rebased onto the new file and the add buffer released.
+//
+int tbSave(t_textBuf *tb, const char *name, uint32_t *written)
+{
+    // Locals.
+    char       buf[TB_COPY_SIZE];
+    char       *tmpName  = NULL;
+    const char *ptr;
+    FIL        *out;
+    t_piece    *piece;
+    FRESULT    result    = FR_OK;
+    UINT       writeSize;
+    uint32_t   idx;
+    uint32_t   off;
+    uint32_t   size;
+    uint32_t   pos;
+    int        replace   = (tb->name != NULL && strcmp(name, tb->name) == 0);
+    int        prefix;
+
+    *written = 0;
+    if((out = malloc(sizeof(FIL))) == NULL)
+        return(TB_NO_MEMORY);
+    if(replace)
+    {
+        for(ptr=name, prefix=0; *ptr; ptr++)
+        {
+            if(*ptr == '/' || *ptr == '\\' || *ptr == ':') prefix = ptr - name + 1;
+        }
+        if((tmpName = malloc(prefix + sizeof(TB_TEMP_NAME))) == NULL)
+        {
+            free(out);
+            return(TB_NO_MEMORY);
+        }
+        memcpy(tmpName, name, prefix);
+        strcpy(tmpName + prefix, TB_TEMP_NAME);
+    }
+
+    // Write out each piece in turn.
+    if(f_open(out, replace ? tmpName : name, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+    {
+        free(out);
+        if(tmpName) free(tmpName);
+        return(TB_IO_ERROR);
+    }
+    for(idx=0; idx < tb->pieces && result == FR_OK; idx++)
+    {
+        for(off=0; off < tb->piece[idx].len && result == FR_OK; off += size)
+        {
+            if(tb->piece[idx].src == TB_SRC_ADD)
+            {
+                size   = tb->piece[idx].len;
+                result = f_write(out, tb->add + tb->piece[idx].offset, size, &writeSize);
+            } else
+            {
+                size   = tb->piece[idx].len - off > TB_COPY_SIZE ? TB_COPY_SIZE : tb->piece[idx].len - off;
+                result = tbRead(tb, &tb->piece[idx], off, buf, size) == TB_OK ? f_write(out, buf, size, &writeSize) : FR_DISK_ERR;
+            }
+            if(result == FR_OK && writeSize != size)
+                result = FR_DENIED;
+        }
+    }
+    if(f_close(out) != FR_OK)
+        result = FR_DISK_ERR;
+    free(out);
+    if(result != FR_OK)
+    {
+        if(tmpName) { f_unlink(tmpName); free(tmpName); }
+        return(TB_IO_ERROR);
+    }
+    *written = tb->size;
+    if(!replace)
+        return(TB_OK);
+
+    // Replace the original with the new file. Should the rename fail the temporary file becomes the source.
+    if(tb->file != NULL)
+        f_close(tb->file);
+    else if((tb->file = malloc(sizeof(FIL))) == NULL)
+    {
+        free(tmpName);
+        return(TB_NO_MEMORY);
+    }
+    result = f_unlink(name);
+    if(result == FR_OK || result == FR_NO_FILE)
+        result = f_rename(tmpName, name);
+    if(result != FR_OK)
+    {
+        free(tb->name);
+        tb->name = tmpName;
+        tmpName  = NULL;
+    }
+    if(f_open(tb->file, tb->name, FA_OPEN_EXISTING | FA_READ) != FR_OK)
+    {
+        free(tb->file);
+        tb->file = NULL;
+        result   = FR_DISK_ERR;
+    }
+    if(tmpName) free(tmpName);
+
+    // Rebase the pieces onto the file just written, merging them back up to TB_PIECE_LINES lines.
+    for(idx=0, pos=0, off=0; idx < tb->pieces; idx++)
+    {
+        if(off > 0 && tb->piece[off-1].lines + tb->piece[idx].lines <= TB_PIECE_LINES)
+        {
+            tb->piece[off-1].len   += tb->piece[idx].len;
+            tb->piece[off-1].lines += tb->piece[idx].lines;
+        } else
+        {
+            tb->piece[off].src    = TB_SRC_FILE;
+            tb->piece[off].offset = pos;
+            tb->piece[off].len    = tb->piece[idx].len;
+            tb->piece[off].lines  = tb->piece[idx].lines;
+            off++;
+        }
+        pos += tb->piece[idx].len;
+    }
+    tb->pieces = off;
+    if(tb->maxPieces > tb->pieces + TB_PIECE_CHUNK && (piece = realloc(tb->piece, (tb->pieces + TB_PIECE_CHUNK) * sizeof(t_piece))) != NULL)
+    {
+        tb->piece     = piece;
+        tb->maxPieces = tb->pieces + TB_PIECE_CHUNK;
+    }
+    if(tb->add != NULL)
+        free(tb->add);
+    tb->add     = NULL;
+    tb->addLen  = 0;
+    tb->addSize = 0;
+    tbResetHint(tb);
+    return(result == FR_OK ? TB_OK : TB_IO_ERROR);
+}
+
+#ifdef __cplusplus
+}
+#endif
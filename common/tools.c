@@ -10,6 +10,9 @@
 // Copyright:       (c) 2019 Philip Smart <philip.smart@net2net.org>
 //
 // History:         January 2019   - Initial script written.
+//                  Oct 2026       - fileExec split so a program already in memory can be run (memExec),
+//                                   apps command listing the application registry.
+//                                 - info command lists the heap statistics when built with __SFMALLOC__.
 //
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 // This source file is free software: you can redistribute it and#or modify
@@ -47,6 +50,15 @@ extern "C" {
 #if defined(__SD_CARD__)
   #include "ff.h"
 #endif
+#if defined(BUILTIN_MISC_APPS) && BUILTIN_MISC_APPS == 1
+  #include "appreg.h"
+#endif
+#if defined(BUILTIN_MISC_EVENTS) && BUILTIN_MISC_EVENTS == 1
+  #include "evq.h"
+#endif
+#if defined(__SFMALLOC__)
+  #include "sfmalloc.h"
+#endif
 #include "utils.h"
 #include "tools.h"
 
@@ -665,7 +677,7 @@ FRESULT fileLoad(char *src, uint32_t addr, uint8_t showStats)
       #endif
         loadSize = 0;
         for (;;) {
-            fr0 = f_read(&File[0], memPtr, SECTOR_SIZE, &readSize);
+            fr0 = f_read(&File[0], memPtr, FILE_LOAD_XFER_SIZE, &readSize);
             if (fr0 || readSize == 0) break;   /* error or eof */
             loadSize += readSize;
             memPtr += readSize;
@@ -831,10 +843,10 @@ FRESULT fileDump(char *src, uint32_t width)
 extern uint32_t _memreg; 
 #endif
 
-// Method to load a file into memory and execute it.
+// Method to execute a program already loaded in memory.
 //
 #if defined(BUILTIN_FS_EXEC) && BUILTIN_FS_EXEC == 1
-uint32_t fileExec(char *src, uint32_t addr, uint32_t execAddr, uint8_t execMode, uint32_t param1, uint32_t param2, uint32_t G, uint32_t cfg)
+uint32_t memExec(uint32_t execAddr, uint8_t execMode, uint32_t param1, uint32_t param2, uint32_t G, uint32_t cfg)
 {
     // Locals.
     //
@@ -852,39 +864,52 @@ uint32_t fileExec(char *src, uint32_t addr, uint32_t execAddr, uint8_t execMode,
     #error "Target CPU not defined, use __ZPU__, __K64F__ or __M68K__"
   #endif
     void      *gotoptr       = (void *)execAddr;
+
+    switch(execMode)
+    {
+        // Call the loaded program entry address, return expected.
+        case EXEC_MODE_CALL:
+          #if defined __ZPU__
+          //printf("0=%08lx, 1=%08lx, 2=%08lx, _IOB=%08lx %08lx %08lx\n", __iob[0], __iob[1], __iob[2], (uint32_t)(__iob), (uint32_t *)__iob, __iob   );
+          //printf("ExecAddr=%08lx, execMode=%02x, param1=%08lx, param2=%08lx, G=%08lx, cfg=%08lx\n", execAddr, execMode, param1, param2, G, cfg);
+            retCode = func(param1, param2, &_memreg, G, cfg, (uint32_t)__iob);
+          #elif defined __K64F__
+            retCode = func(param1, param2, G, cfg, (uint32_t)stdin, (uint32_t)stdout, (uint32_t)stderr);
+          #elif defined __M68K__ 
+            retCode = func(param1, param2, G, cfg, (uint32_t)stdin, (uint32_t)stdout, (uint32_t)stderr);
+          #else
+            #error "Target CPU not defined, use __ZPU__, __K64F__ or __M68K__"
+          #endif
+            break;
+
+        // Jump to the loaded program entry address, no return expected.
+        case EXEC_MODE_JMP: 
+            goto *gotoptr;
+            break;
+
+        default:
+            break;
+    }
+
+    return(retCode);
+}
+
+// Method to load a file into memory and execute it.
+//
+uint32_t fileExec(char *src, uint32_t addr, uint32_t execAddr, uint8_t execMode, uint32_t param1, uint32_t param2, uint32_t G, uint32_t cfg)
+{
+    // Locals.
+    //
+    uint32_t   retCode = 0xffffffff;
     FRESULT    fr0;
 
     // Load the file.
     fr0 = fileLoad(src, addr, 0);
 
-    // If no errors occurred, 
+    // If no errors occurred, execute.
     if(!fr0)
     {
-        switch(execMode)
-        {
-            // Call the loaded program entry address, return expected.
-            case EXEC_MODE_CALL:
-              #if defined __ZPU__
-              //printf("0=%08lx, 1=%08lx, 2=%08lx, _IOB=%08lx %08lx %08lx\n", __iob[0], __iob[1], __iob[2], (uint32_t)(__iob), (uint32_t *)__iob, __iob   );
-              //printf("ExecAddr=%08lx, execMode=%02x, param1=%08lx, param2=%08lx, G=%08lx, cfg=%08lx\n", execAddr, execMode, param1, param2, G, cfg);
-                retCode = func(param1, param2, &_memreg, G, cfg, (uint32_t)__iob);
-              #elif defined __K64F__
-                retCode = func(param1, param2, G, cfg, (uint32_t)stdin, (uint32_t)stdout, (uint32_t)stderr);
-              #elif defined __M68K__ 
-                retCode = func(param1, param2, G, cfg, (uint32_t)stdin, (uint32_t)stdout, (uint32_t)stderr);
-              #else
-                #error "Target CPU not defined, use __ZPU__, __K64F__ or __M68K__"
-              #endif
-                break;
-
-            // Jump to the loaded program entry address, no return expected.
-            case EXEC_MODE_JMP: 
-                goto *gotoptr;
-                break;
-
-            default:
-                break;
-        }
+        retCode = memExec(execAddr, execMode, param1, param2, G, cfg);
     }
 
     return(retCode);
@@ -1163,6 +1188,161 @@ int memoryDump(uint32_t memaddr, uint32_t memsize, uint32_t memwidth, uint32_t d
 }
 #endif
 
+// Method to show the console UART statistics and, when a size is given, measure the sustained output rate
+// by sending that many KBytes of test lines.
+//
+#if defined(BUILTIN_HW_UART_STATS) && BUILTIN_HW_UART_STATS == 1
+void uartDiagnostics(uint32_t kb)
+{
+    // Locals.
+    t_uartStats stats;
+    uint32_t    bytes = kb * 1024;
+    uint32_t    queuedMs;
+    uint32_t    mSec;
+    char        line[64];
+
+    if(bytes > 0)
+    {
+        // Test line of 63 printable characters and a newline.
+        for(uint8_t idx = 0; idx < 63; idx++)
+            line[idx] = '!' + idx;
+        line[63] = '\n';
+
+        uart_flush();
+        uart_get_stats(&stats, 1);
+        TIMER_MILLISECONDS_UP = 0;
+        for(uint32_t sent = 0; sent < bytes; sent += sizeof(line))
+            fwrite(line, 1, sizeof(line), stdout);
+        fflush(stdout);
+        queuedMs = TIMER_MILLISECONDS_UP;
+        uart_flush();
+        mSec = TIMER_MILLISECONDS_UP;
+
+        // A CR is sent with every line.
+        bytes += bytes / sizeof(line);
+        printf("\nWriter released after %lu ms, transmitter idle after %lu ms.", queuedMs, mSec);
+        printBytesPerSec(bytes, mSec > 0 ? mSec : 1, "sent");
+    }
+
+    uart_get_stats(&stats, 0);
+  #if defined(UART_RINGS)
+    printf("Console UART0 rings, TX %u bytes, RX %u bytes.\n", UART_TX_RING_SIZE, UART_RX_RING_SIZE);
+  #else
+    printf("Console UART0 polled, no statistics collected.\n");
+  #endif
+    printf("  TX %10lu bytes, peak %5u, overrun %lu, underrun %lu\n", stats.txBytes, stats.txPeak, stats.txOverrun, stats.txUnderrun);
+    printf("  RX %10lu bytes, peak %5u, overrun %lu\n", stats.rxBytes, stats.rxPeak, stats.rxOverrun);
+}
+#endif
+
+// Method to list the application registry with the launch times of each command and the state of the
+// image cache. With rescan set the bin directory is read again first.
+//
+#if defined(BUILTIN_MISC_APPS) && BUILTIN_MISC_APPS == 1
+void printAppRegistry(uint8_t rescan)
+{
+    // Locals.
+    t_appRegStats stats;
+    t_appEntry    *entry;
+    char          name[APPREG_FILE_LEN];
+    uint16_t      idx;
+    uint8_t       pos;
+    FRESULT       fr;
+
+    if(rescan)
+    {
+        fr = appRegBuild(APP_CMD_BIN_DRIVE, APP_CMD_BIN_DIR, APP_CMD_EXTENSION);
+        if(fr) { printFSCode(fr); }
+    }
+    appRegGetStats(&stats);
+
+    printf("%u applications in %d:\\%s, read in %u ms.\n", stats.entries, APP_CMD_BIN_DRIVE, APP_CMD_BIN_DIR, stats.buildMs);
+    printf("%-15s %8s %5s %5s %8s %8s\n", "Command", "Size", "Runs", "Hits", "Last ms", "Avg ms");
+    for(idx=0; (entry = appRegEntry(idx)) != NULL; idx++)
+    {
+        for(pos=0; entry->file[pos] != '.'; pos++)
+            name[pos] = entry->file[pos];
+        name[pos] = 0x00;
+        printf("%-15s %8lu %5u %5u%c%8u %8lu\n", name, entry->fsize, entry->launches, entry->hits, appRegIsCached(entry) ? '*' : ' ',
+                                                   entry->lastMs, entry->launches ? entry->totalMs / entry->launches : 0);
+    }
+  #if defined(APP_CACHE)
+    printf("Image cache %lu of %lu bytes, %u of %u images (*), %u evicted, %u failed CRC.\n", stats.cacheBytes, (uint32_t)APP_CACHE_SIZE,
+                                                   stats.cacheImages, APP_CACHE_SLOTS, stats.cacheEvictions, stats.cacheRejects);
+  #else
+    printf("Image cache not enabled.\n");
+  #endif
+}
+#endif
+
+// Method to list the tranZPUter event queue statistics, the latency from an interrupt posting an event to its
+// handler starting as a histogram per event. With reset set the statistics are cleared after display.
+//
+#if defined(BUILTIN_MISC_EVENTS) && BUILTIN_MISC_EVENTS == 1
+void printEventStats(uint8_t reset)
+{
+    // Locals.
+    t_evqStats    *stats;
+    uint8_t       event;
+    uint8_t       bucket;
+
+    printf("%-8s %8s %8s %10s %10s\n", "Event", "Count", "Nested", "Max us", "Max run us");
+    for(event=0; event < EVQ_EVENTS; event++)
+    {
+        stats = &evqControl.stats[event];
+        printf("%-8s %8lu %8lu %10lu %10lu\n", evqName((enum EVQ_EVENT)event), stats->count, stats->nested, stats->maxLatencyUs, stats->maxRunUs);
+    }
+    printf("\n%-8s %5s %5s %5s %5s %5s %5s %5s %5s %5s %5s %5s\n", "Latency", "<4u", "<16u", "<64u", "<256u", "<1m", "<4m", "<16m", "<66m", "<262m", "<1s", ">=1s");
+    for(event=0; event < EVQ_EVENTS; event++)
+    {
+        stats = &evqControl.stats[event];
+        printf("%-8s", evqName((enum EVQ_EVENT)event));
+        for(bucket=0; bucket < EVQ_HIST_BUCKETS; bucket++)
+        {
+            printf(" %5lu", stats->hist[bucket]);
+        }
+        printf("\n");
+    }
+    printf("%lu background job slices, %lu yield points.\n", evqControl.jobSlices, evqControl.yields);
+
+    if(reset)
+        evqResetStats();
+}
+#endif
+
+// Method to list the heap statistics of the segregated fit allocator, usage, free space, fragmentation and a
+// histogram of allocation request sizes.
+//
+#if defined(__SFMALLOC__)
+void printHeapInfo(void)
+{
+    // Locals.
+    SFM_STATS     stats;
+    uint8_t       bucket;
+
+    sfm_stats(&stats);
+
+    printf("Heap (segregated fit):\n");
+    printf("    Total                    = %lu bytes\n", (uint32_t)stats.totalBytes);
+    printf("    Used                     = %lu bytes in %lu blocks\n", (uint32_t)stats.usedBytes, stats.usedBlocks);
+    printf("    Free                     = %lu bytes in %lu blocks\n", (uint32_t)stats.freeBytes, stats.freeBlocks);
+    printf("    Largest Free Block       = %lu bytes\n", (uint32_t)stats.largestFree);
+    printf("    Fragmentation            = %lu%%\n", stats.fragmentation);
+    printf("    Allocations              = %lu, %lu failed\n", stats.allocations, stats.failures);
+    printf("    Request Sizes   ");
+    for(bucket=0; bucket < SFM_HIST_BUCKETS - 1; bucket++)
+    {
+        printf(" <=%5u", 8 << bucket);
+    }
+    printf("  >%5u\n                    ", 8 << (SFM_HIST_BUCKETS - 2));
+    for(bucket=0; bucket < SFM_HIST_BUCKETS; bucket++)
+    {
+        printf(" %7lu", stats.histogram[bucket]);
+    }
+    printf("\n");
+}
+#endif
+
 // Method to output a help page based on the current set of enabled commands. This is done via
 // the group and command tables defined in the header.
 #if defined(BUILTIN_MISC_HELP) && BUILTIN_MISC_HELP == 1
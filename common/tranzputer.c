@@ -68,6 +68,20 @@
 //                                   as this is catered for by the Sharp MZ Series. 
 //                                   MZ-2000 support added as the tranZPUter SW-700 now functions
 //                                   on the MZ-2000 host hardware.
+//                  v1.9 Oct 2026  - Directory cache built by the dircache module which keeps a persistent
+//                                   MZF header index in each directory, only new or changed files are
+//                                   opened when the cache is rebuilt.
+//                                   File read service double buffered, the next sector is prefetched
+//                                   whilst the Z80 consumes the current one.
+//                                   Interrupts post RESET and service requests to the evq event queue,
+//                                   ROM loads yield to it between sectors. The emulator service job
+//                                   and the emulation resource of a service request are only added
+//                                   to the queue once an emulation is started.
+//                                   The directory cache refresh after a save or erase is a background
+//                                   job which holds only the cache, service requests run between its
+//                                   entries. A reset drops a service request made before it.
+//                                   Files loaded into Z80 memory are streamed in sector aligned
+//                                   multi-sector reads and written with the block transfer engine.
 //
 // Notes:           See Makefile to enable/disable conditional components
 //
@@ -119,6 +133,9 @@ extern "C" {
 #include <fonts.h>
 #include <bitmaps.h>
 #include <tranzputer.h>
+#include <dircache.h>
+#include <readahead.h>
+#include <evq.h>
 
 // Bring in public declarations from emuMZ module (pseudo class).
 #define EMUMZ_H
@@ -337,7 +354,8 @@ static void __attribute((naked, noinline)) irqPortC_dummy(void)
 // This method is called everytime an active irq triggers on Port E. For this design, this means the two IO CS
 // lines, CTL_SVCREQ and TZ_SYSREQ. The SVCREQ is used when the Z80 requires a service, the SYSREQ is yet to
 // be utilised.
-//
+// The request is posted to the event queue stamped with the core cycle counter. The line is level driven so
+// a request already pending keeps its original stamp.
 //
 static void __attribute((naked, noinline)) irqPortE(void)
 {
@@ -349,18 +367,24 @@ static void __attribute((naked, noinline)) irqPortE(void)
                  "                        ldr      r5, [r4, #0]             \n"
                  "                        str      r5, [r4, #0]             \n"
 
-                                          // Is CTL_SVCREQ (E24) active (low), set flag and exit if it is.
-                 "                        movs     r4, #1                   \n"
+                                          // Is CTL_SVCREQ (E24) active (low), post EVQ_SVCREQ unless already pending and exit.
                  "                        tst      r5, #0x01000000          \n"
                  "                        beq      irqPortE_Exit            \n"
+                 "                        ldrb     r4, %[val0]              \n"
+                 "                        cmp      r4, #0                   \n"
+                 "                        bne      irqPortE_Exit            \n"
+                 "                        ldr      r4, =0xE0001004          \n"
+                 "                        ldr      r4, [r4, #0]             \n"
+                 "                        str      r4, %[val1]              \n"
+                 "                        movs     r4, #1                   \n"
                  "                        strb     r4, %[val0]              \n" 
 
                  "              irqPortE_Exit:                              \n"
 
-                                          : [val0] "+m" (z80Control.svcRequest),
-                                            [val1] "+m" (z80Control.sysRequest) 
+                                          : [val0] "+m" (evqControl.posted[EVQ_SVCREQ]),
+                                            [val1] "+m" (evqControl.postedAt[EVQ_SVCREQ]) 
                                           :
-                                          : "r4","r5","r7","r8","r9","r10","r11","r12"
+                                          : "r4","r5","r6","r7","r8","r9","r10","r11","r12"
                 );
     asm volatile("                        pop      {r0-r5,pc}               \n");
 
@@ -369,7 +393,7 @@ static void __attribute((naked, noinline)) irqPortE(void)
 
 // This method is called everytime an active irq triggers on Port D. For this design, this means the IORQ and RESET lines.
 //
-// Basic RESET detection.
+// Basic RESET detection, posted to the event queue as EVQ_RESET in the same manner as the service request.
 //
 static void __attribute((naked, noinline)) irqPortD(void)
 {
@@ -381,15 +405,22 @@ static void __attribute((naked, noinline)) irqPortD(void)
                  "                        ldr      r0, [r1, #0]             \n"
                  "                        str      r0, [r1, #0]             \n"
 
-                                          // Is Z80_RESET active, set flag and exit.
-                 "                        movs     r1, #1                   \n"
+                                          // Is Z80_RESET active, post EVQ_RESET unless already pending and exit.
                  "                        tst      r0, #0x0010              \n"
                  "                        beq      irqPortD_Exit            \n"
+                 "                        ldrb     r1, %[val0]              \n"
+                 "                        cmp      r1, #0                   \n"
+                 "                        bne      irqPortD_Exit            \n"
+                 "                        ldr      r1, =0xE0001004          \n"
+                 "                        ldr      r1, [r1, #0]             \n"
+                 "                        str      r1, %[val1]              \n"
+                 "                        movs     r1, #1                   \n"
                  "                        strb     r1, %[val0]              \n"
 
                  "              irqPortD_Exit:                              \n"
             
-                                          : [val0] "=m" (z80Control.resetEvent)
+                                          : [val0] "+m" (evqControl.posted[EVQ_RESET]),
+                                            [val1] "+m" (evqControl.postedAt[EVQ_RESET])
                                           : 
                                           : "r0","r1","r4","r5","r6","r7","r8","r9","r10","r11","r12");
 
@@ -612,6 +643,35 @@ static void restoreIRQ(void)
     return;
 }
 
+// Event queue handler for a Z80 RESET, the tranZPUter is reset and the host ROMs reloaded. A service request made before the reset
+// is dropped, the Z80 which made it has restarted and its request block would otherwise be actioned against the reset machine.
+//
+static void resetEventHandler(void)
+{
+    evqClearBefore(EVQ_SVCREQ, evqControl.postedAt[EVQ_RESET]);
+    hardResetTranZPUter();
+
+    // Clear the reset event raised by the reload itself.
+    evqClear(EVQ_RESET);
+    return;
+}
+
+// Event queue handler for a captured Z80 I/O operation.
+//
+static void ioEventHandler(void)
+{
+    printf("I/O:%2x\n", z80Control.ioAddr);
+    return;
+}
+
+// Event queue background job, a slice of the tranZPUter service (emulator scheduling), deferred when an emulation is started and run whenever no event is pending.
+//
+static uint8_t TZPUserviceJob(void *ctx)
+{
+    TZPUservice();
+    return(EVQ_JOB_MORE);
+}
+
 // Method to setup the pins and the pin map to power up default.
 // The OS millisecond counter address is passed into this library to gain access to time without the penalty of procedure calls.
 // Time is used for timeouts and seriously affects pulse width of signals when procedure calls are made.
@@ -740,9 +800,6 @@ void setupZ80Pins(uint8_t initK64F, volatile uint32_t *millisecondTick)
 
         // Control structure elements only in zOS.
         //
-        z80Control.resetEvent        = 0;
-        z80Control.svcRequest        = 0;
-        z80Control.sysRequest        = 0;
         z80Control.ioAddr            = 0;
         z80Control.ioEvent           = 0;
         z80Control.mz700.config      = 0x202;
@@ -750,6 +807,17 @@ void setupZ80Pins(uint8_t initK64F, volatile uint32_t *millisecondTick)
         z80Control.memorySwap        = 0;
         z80Control.crtMode           = 0;
         z80Control.scroll            = 0;
+        z80Control.burstMode         = TZ_BURST_DEFAULT;
+
+        // Setup the event queue before the interrupts which post to it. The zOS service loop dispatches the events, the tranZPUter
+        // service only has work once an emulation is started so it, and the emulation state a service request then uses, are added
+        // to the queue at that point. A service request does not hold the directory cache, a build in progress is not nested, see
+        // svcCacheDir, so requests run between the entries of a background refresh.
+        evqInit();
+        evqRegister(EVQ_RESET,   resetEventHandler,     EVQ_USES_Z80BUS | EVQ_USES_SDCARD);
+        evqRegister(EVQ_SVCREQ,  processServiceRequest, EVQ_USES_Z80BUS | EVQ_USES_SDCARD);
+        evqRegister(EVQ_SYSREQ,  NULL,                  0);
+        evqRegister(EVQ_IOEVENT, ioEventHandler,        0);
 
         // Setup the Interrupts for IORQ and MREQ.
         setupIRQ();
@@ -1112,19 +1180,19 @@ uint8_t writeZ80Memory(uint32_t addr, uint8_t data, enum TARGETS target)
     if(target == FPGA)
     {
         // Allow time for the address and data to settle then pulse the MREQ and WR line low.
-        for(volatile uint32_t pulseWidth = 0; pulseWidth < 3; pulseWidth++);
+        z80BusDelay(3);
         pinLow(Z80_MREQ);
-        for(volatile uint32_t pulseWidth = 0; pulseWidth < 5; pulseWidth++);
+        z80BusDelay(5);
         pinLow(Z80_WR);
-        for(volatile uint32_t pulseWidth = 0; pulseWidth < 5; pulseWidth++);
+        z80BusDelay(5);
         pinHigh(Z80_WR);
     }
     else
     {
         // Setup time before applying control signals.
-        for(volatile uint32_t pulseWidth = 0; pulseWidth < 3; pulseWidth++);
+        z80BusDelay(3);
         pinLow(Z80_MREQ);
-        for(volatile uint32_t pulseWidth = 0; pulseWidth < 3; pulseWidth++);
+        z80BusDelay(3);
 
         // Different logic according to what is being accessed. The mainboard needs to uphold timing and WAIT signals whereas the Tranzputer logic has no wait
         // signals and faster memory.
@@ -1139,7 +1207,7 @@ uint8_t writeZ80Memory(uint32_t addr, uint8_t data, enum TARGETS target)
             pinLow(Z80_WR);
 
             // On a K64F running at 120MHz this delay gives a pulsewidth of 760nS.
-            for(volatile uint32_t pulseWidth=0; pulseWidth < 4; pulseWidth++);
+            z80BusDelay(4);
 
             // Another wait loop check as the Z80 can assert wait at the time of Write or anytime before it is deasserted.
             while((*ms - startTime) < 200 && pinGet(Z80_WAIT) == 0);
@@ -1150,7 +1218,7 @@ uint8_t writeZ80Memory(uint32_t addr, uint8_t data, enum TARGETS target)
 
             // On a K64F running at 120MHz this delay gives a pulsewidth of 760nS.
             // With the tranZPUter SW v2 boards, need to increase the write pulse width, alternatively wait until a positive edge on the CPU clock.
-            for(volatile uint32_t pulseWidth=0; pulseWidth < 3; pulseWidth++);
+            z80BusDelay(3);
         }
     }
     
@@ -1182,7 +1250,7 @@ uint8_t readZ80Memory(uint32_t addr)
             blnkDetLast = blnkDet;
             blnkDet = readZ80Memory(0xE008) & 0x80;
         } while(!(blnkDet == 0x80 && blnkDetLast == 0x00));
-        for(volatile uint32_t pulseWidth=0; pulseWidth < 10; pulseWidth++);
+        z80BusDelay(10);
         startTime = *ms;
     }
 
@@ -1191,10 +1259,10 @@ uint8_t readZ80Memory(uint32_t addr)
     setZ80Addr(addr);
 
     // Setup time before applying control signals.
-    for(volatile uint32_t pulseWidth = 0; pulseWidth < 3; pulseWidth++);
+    z80BusDelay(3);
     pinLow(Z80_MREQ);
     pinLow(Z80_RD);
-    for(volatile uint32_t pulseWidth = 0; pulseWidth < 3; pulseWidth++);
+    z80BusDelay(3);
   
     // Different logic according to what is being accessed. The mainboard needs to uphold timing and WAIT signals whereas the Tranzputer logic has no wait
     // signals and faster memory.
@@ -1203,14 +1271,14 @@ uint8_t readZ80Memory(uint32_t addr)
     {
         // On a K64F running at 120MHz this delay gives a pulsewidth of 760nS. This gives time for the addressed device to present the data
         // on the data bus.
-        for(volatile uint32_t pulseWidth=0; pulseWidth < 4; pulseWidth++);
+        z80BusDelay(4);
 
         // A wait loop check as the Z80 can assert wait during the Read operation to request more time. Set a timeout in case of hardware lockup.
         while((*ms - startTime) < 100 && pinGet(Z80_WAIT) == 0);
     } else
     {
         // On the tranZPUter v1.1, because of reorganisation of the signals, the time to process is less and so the pulse width under v1.0 is insufficient.
-        for(volatile uint32_t pulseWidth=0; pulseWidth < 4; pulseWidth++);
+        z80BusDelay(4);
     }
 
     // Fetch the data before deasserting the signals.
@@ -1226,6 +1294,166 @@ uint8_t readZ80Memory(uint32_t addr)
     return(data);
 }
 
+// Block transfer engine.
+// The single byte methods present the full 24bit address, data and control signals and evaluate the target and bus mode on every call. When
+// transferring a block the bus is configured once, the full address is presented at the start of each 256 byte page and thereafter only
+// A7:A0 are updated between bytes. Each target has its own loop, unrolled by 4, using the timing profile (TZ_BURST_*) for that target which
+// mirrors the pulse widths validated in the single byte methods. The bus must already be under K64F control with the direction set.
+//
+// Single FPGA write cycle, the FPGA translates the pulse into a write so no WAIT states are observed.
+#define z80BurstWriteFPGA(a, d)      { setZ80AddrLower(a); setZ80Data(d);\
+                                       z80BusDelay(TZ_BURST_FPGA_SETUP); pinLow(Z80_MREQ);\
+                                       z80BusDelay(TZ_BURST_FPGA_MREQ);  pinLow(Z80_WR);\
+                                       z80BusDelay(TZ_BURST_FPGA_WR);    pinHigh(Z80_WR); pinHigh(Z80_MREQ); }
+
+// Single tranZPUter static RAM write cycle, no WAIT states.
+#define z80BurstWriteTZPU(a, d)      { setZ80AddrLower(a); setZ80Data(d);\
+                                       z80BusDelay(TZ_BURST_TZPU_SETUP); pinLow(Z80_MREQ);\
+                                       z80BusDelay(TZ_BURST_TZPU_MREQ);  pinLow(Z80_WR);\
+                                       z80BusDelay(TZ_BURST_TZPU_WR);    pinHigh(Z80_WR); pinHigh(Z80_MREQ); }
+
+// Single tranZPUter static RAM or FPGA read cycle, no WAIT states.
+#define z80BurstReadTZPU(a, d)       { setZ80AddrLower(a);\
+                                       z80BusDelay(TZ_BURST_TZPU_SETUP); pinLow(Z80_MREQ); pinLow(Z80_RD);\
+                                       z80BusDelay(TZ_BURST_TZPU_RD);\
+                                       d = readZ80DataBus(); pinHigh(Z80_RD); pinHigh(Z80_MREQ); }
+
+// Method to write a block of bytes to the tranZPUter, FPGA or mainboard memory using the block transfer engine.
+//
+static void writeZ80Block(uint32_t addr, uint8_t *data, uint32_t size, enum TARGETS target)
+{
+    // Locals.
+    uint32_t          startTime;
+    uint32_t          pageSize;
+
+    while(size > 0)
+    {
+        // Size of the run to the end of the current 256 byte page, only A7:A0 change within the run.
+        pageSize = 0x100 - (addr & 0xff);
+        if(pageSize > size)
+            pageSize = size;
+        size -= pageSize;
+
+        // Present the full address at the start of the run.
+        setZ80Addr(addr);
+
+        if(target == FPGA)
+        {
+            for(; pageSize >= 4; pageSize -= 4, addr += 4, data += 4)
+            {
+                z80BurstWriteFPGA(addr,   data[0]);
+                z80BurstWriteFPGA(addr+1, data[1]);
+                z80BurstWriteFPGA(addr+2, data[2]);
+                z80BurstWriteFPGA(addr+3, data[3]);
+            }
+            for(; pageSize > 0; pageSize--, addr++, data++)
+            {
+                z80BurstWriteFPGA(addr, *data);
+            }
+        }
+        else if(z80Control.ctrlMode == MAINBOARD_ACCESS)
+        {
+            // The mainboard must uphold the Z80 timing and WAIT states so it isnt unrolled, the WAIT checks dominate.
+            for(; pageSize > 0; pageSize--, addr++, data++)
+            {
+                startTime = *ms;
+                setZ80AddrLower(addr);
+                setZ80Data(*data);
+                z80BusDelay(TZ_BURST_MB_SETUP);
+                pinLow(Z80_MREQ);
+                z80BusDelay(TZ_BURST_MB_MREQ);
+
+                // If WAIT has been asserted, loop with a timeout as per writeZ80Memory.
+                while((*ms - startTime) < 100 && pinGet(Z80_WAIT) == 0);
+                pinLow(Z80_WR);
+                z80BusDelay(TZ_BURST_MB_WR);
+                while((*ms - startTime) < 200 && pinGet(Z80_WAIT) == 0);
+                pinHigh(Z80_WR);
+                pinHigh(Z80_MREQ);
+            }
+        }
+        else
+        {
+            for(; pageSize >= 4; pageSize -= 4, addr += 4, data += 4)
+            {
+                z80BurstWriteTZPU(addr,   data[0]);
+                z80BurstWriteTZPU(addr+1, data[1]);
+                z80BurstWriteTZPU(addr+2, data[2]);
+                z80BurstWriteTZPU(addr+3, data[3]);
+            }
+            for(; pageSize > 0; pageSize--, addr++, data++)
+            {
+                z80BurstWriteTZPU(addr, *data);
+            }
+        }
+    }
+    return;
+}
+
+// Method to read a block of bytes from the tranZPUter, FPGA or mainboard memory using the block transfer engine.
+//
+static void readZ80Block(uint32_t addr, uint8_t *data, uint32_t size)
+{
+    // Locals.
+    uint32_t          startTime;
+    uint32_t          pageSize;
+
+    while(size > 0)
+    {
+        // Size of the run to the end of the current 256 byte page, only A7:A0 change within the run.
+        pageSize = 0x100 - (addr & 0xff);
+        if(pageSize > size)
+            pageSize = size;
+        size -= pageSize;
+
+        if(z80Control.ctrlMode == MAINBOARD_ACCESS)
+        {
+            // Video RAM requires synchronisation with the blanking period which readZ80Memory performs, it also changes the address bus.
+            if(addr >= 0xD000 && addr < 0xE000)
+            {
+                for(; pageSize > 0; pageSize--, addr++, data++)
+                {
+                    *data = readZ80Memory(addr);
+                }
+                continue;
+            }
+
+            setZ80Addr(addr);
+            for(; pageSize > 0; pageSize--, addr++, data++)
+            {
+                startTime = *ms;
+                setZ80AddrLower(addr);
+                z80BusDelay(TZ_BURST_MB_SETUP);
+                pinLow(Z80_MREQ);
+                pinLow(Z80_RD);
+                z80BusDelay(TZ_BURST_MB_RD);
+
+                // A wait loop check as the Z80 can assert wait during the Read operation to request more time.
+                while((*ms - startTime) < 100 && pinGet(Z80_WAIT) == 0);
+                *data = readZ80DataBus();
+                pinHigh(Z80_RD);
+                pinHigh(Z80_MREQ);
+            }
+        }
+        else
+        {
+            setZ80Addr(addr);
+            for(; pageSize >= 4; pageSize -= 4, addr += 4, data += 4)
+            {
+                z80BurstReadTZPU(addr,   data[0]);
+                z80BurstReadTZPU(addr+1, data[1]);
+                z80BurstReadTZPU(addr+2, data[2]);
+                z80BurstReadTZPU(addr+3, data[3]);
+            }
+            for(; pageSize > 0; pageSize--, addr++, data++)
+            {
+                z80BurstReadTZPU(addr, *data);
+            }
+        }
+    }
+    return;
+}
+
 // Method to write an array of values to Z80 memory.
 //
 uint8_t writeZ80Array(uint32_t addr, uint8_t *data, uint32_t size, enum TARGETS target)
@@ -1263,15 +1491,17 @@ uint8_t writeZ80Array(uint32_t addr, uint8_t *data, uint32_t size, enum TARGETS
         //
         setZ80Direction(WRITE);
 
-        // Loop through the array and write out the data to the next Z80 memory location.
-        for(uint32_t idx=0; idx < size; idx++, nxtAddr++, ptr++)
+        // Use the block transfer engine if enabled otherwise loop through the array and write out the data to the next Z80 memory location.
+        if(z80Control.burstMode)
+        {
+            writeZ80Block(nxtAddr, ptr, size, target);
+        } else
         {
-//printf("%08lx:%02x ", nxtAddr, *ptr);
-//if(addr >= 0x300000 && addr < 0x300010)
-//    delay(1);
-            writeZ80Memory(nxtAddr, *ptr, target);
+            for(uint32_t idx=0; idx < size; idx++, nxtAddr++, ptr++)
+            {
+                writeZ80Memory(nxtAddr, *ptr, target);
+            }
         }
-//printf("\n");
     }
 
     // Release the bus if it is not being held for further transations.
@@ -1317,10 +1547,16 @@ uint8_t readZ80Array(uint32_t addr, uint8_t *data, uint32_t size, enum TARGETS t
         //
         setZ80Direction(READ);
 
-        // Loop through the given size reading byte at a time from the Z80 into the callers array.
-        for(uint32_t idx=0; idx < size; idx++, nxtAddr++, ptr++)
+        // Use the block transfer engine if enabled otherwise loop through the given size reading byte at a time from the Z80 into the callers array.
+        if(z80Control.burstMode)
         {
-           *ptr = readZ80Memory(nxtAddr);
+            readZ80Block(nxtAddr, ptr, size);
+        } else
+        {
+            for(uint32_t idx=0; idx < size; idx++, nxtAddr++, ptr++)
+            {
+               *ptr = readZ80Memory(nxtAddr);
+            }
         }
     }
 
@@ -1804,20 +2040,32 @@ uint8_t copyFromZ80(uint8_t *dst, uint32_t src, uint32_t size, enum TARGETS targ
         writeCtrlLatch(z80Control.curCtrlLatch);
         setZ80Direction(READ);
 
-        for(uint32_t idx=0; idx < size; idx++)
+        if(z80Control.burstMode)
         {
-            // Perform a refresh on the main memory every 2ms.
-            //
-            if(idx % RFSH_BYTE_CNT == 0)
+            // Transfer in blocks of RFSH_BYTE_CNT with a full row refresh of the DRAM between each block.
+            for(uint32_t idx=0, blockSize; idx < size; idx += blockSize)
             {
-                // Perform a full row refresh to maintain the DRAM.
+                blockSize = (size - idx) > RFSH_BYTE_CNT ? RFSH_BYTE_CNT : (size - idx);
                 refreshZ80AllRows();
+                readZ80Block(src + idx, dst + idx, blockSize);
+            }
+        } else
+        {
+            for(uint32_t idx=0; idx < size; idx++)
+            {
+                // Perform a refresh on the main memory every 2ms.
+                //
+                if(idx % RFSH_BYTE_CNT == 0)
+                {
+                    // Perform a full row refresh to maintain the DRAM.
+                    refreshZ80AllRows();
+                }
+             
+                // And now read the byte and store.
+                *dst = readZ80Memory((uint32_t)src);
+                src++;
+                dst++;
             }
-         
-            // And now read the byte and store.
-            *dst = readZ80Memory((uint32_t)src);
-            src++;
-            dst++;
         }
     }
   
@@ -1888,20 +2136,32 @@ uint8_t copyToZ80(uint32_t dst, uint8_t *src, uint32_t size, enum TARGETS target
         //
         writeCtrlLatch(z80Control.curCtrlLatch);
 
-        for(uint32_t idx=0; idx < size; idx++)
+        if(z80Control.burstMode)
         {
-            // Perform a refresh on the main memory every 2ms.
-            //
-            if(idx % RFSH_BYTE_CNT == 0)
+            // Transfer in blocks of RFSH_BYTE_CNT with a full row refresh of the DRAM between each block.
+            for(uint32_t idx=0, blockSize; idx < size; idx += blockSize)
             {
-                // Perform a full row refresh to maintain the DRAM.
+                blockSize = (size - idx) > RFSH_BYTE_CNT ? RFSH_BYTE_CNT : (size - idx);
                 refreshZ80AllRows();
+                writeZ80Block(dst + idx, src + idx, blockSize, target);
+            }
+        } else
+        {
+            for(uint32_t idx=0; idx < size; idx++)
+            {
+                // Perform a refresh on the main memory every 2ms.
+                //
+                if(idx % RFSH_BYTE_CNT == 0)
+                {
+                    // Perform a full row refresh to maintain the DRAM.
+                    refreshZ80AllRows();
+                }
+               
+                // And now write the byte and to the next address!
+                writeZ80Memory((uint32_t)dst, *src, target);
+                src++;
+                dst++;
             }
-           
-            // And now write the byte and to the next address!
-            writeZ80Memory((uint32_t)dst, *src, target);
-            src++;
-            dst++;
         }
     }
  
@@ -2529,6 +2789,46 @@ char *getAttributeFrame(enum VIDEO_FRAMES frame)
     return((char *)&z80Control.attributeRAM[frame]);
 }
 
+// Destination of a file being loaded into Z80 memory and the buffer it is streamed through. Loads are never nested, the event
+// queue does not run a handler using the bus or SD card from within one, so a single static buffer serves.
+//
+typedef struct {
+    uint32_t                         addr;                               // Address for the next chunk.
+    enum TARGETS                     target;                             // Memory being loaded.
+} t_loadSink;
+static uint8_t                       loadBuf[TZ_LOAD_BUF_SIZE] __attribute__((aligned(4)));
+
+// Method to write a chunk of a file being loaded to Z80 memory, called by readAheadStream for each buffer read. The chunk is written in
+// RFSH_BYTE_CNT blocks with a full refresh before each and after the last, maintaining the DRAM across the SD card read which follows.
+//
+static void loadZ80Sink(void *ctx, uint8_t *data, UINT size)
+{
+    // Locals.
+    t_loadSink *sink = (t_loadSink *)ctx;
+
+    for(UINT idx=0, blockSize; idx < size; idx += blockSize)
+    {
+        blockSize = (size - idx) > RFSH_BYTE_CNT ? RFSH_BYTE_CNT : (size - idx);
+        refreshZ80AllRows();
+        if(z80Control.burstMode)
+        {
+            writeZ80Block(sink->addr + idx, data + idx, blockSize, sink->target);
+        } else
+        {
+            for(UINT pos=idx; pos < idx + blockSize; pos++)
+            {
+                writeZ80Memory(sink->addr + pos, data[pos], sink->target);
+            }
+        }
+    }
+    refreshZ80AllRows();
+    sink->addr += size;
+
+    // Serve any pending events which need neither the bus nor the SD card between chunks.
+    evqYield(EVQ_USES_Z80BUS | EVQ_USES_SDCARD);
+    return;
+}
+
 // Method to load a file from the SD card directly into the tranZPUter static RAM or mainboard RAM.
 //
 FRESULT loadZ80Memory(const char *src, uint32_t fileOffset, uint32_t addr, uint32_t size, uint32_t *bytesRead, enum TARGETS target, uint8_t releaseBus)
@@ -2537,10 +2837,7 @@ FRESULT loadZ80Memory(const char *src, uint32_t fileOffset, uint32_t addr, uint3
     //
     FIL           File;
     uint32_t      loadSize       = 0L;
-    uint32_t      sizeToRead     = 0L;
-    uint32_t      memPtr         = addr;
-    unsigned int  readSize;
-    unsigned char buf[SECTOR_SIZE];
+    t_loadSink    sink;
     FRESULT       fr0;
 
     // Sanity check on filenames.
@@ -2619,33 +2916,11 @@ printf("Loading file(%s,%08lx,%08lx)\n", src, addr, size);
                 outZ80IO(IO_TZ_MMIO1, 0);
             }
 
-            // Loop, reading a sector at a time from SD file and writing it directly into the Z80 tranZPUter RAM or mainboard RAM.
+            // Stream the file into the Z80 tranZPUter RAM, FPGA or mainboard RAM, a buffer of whole sectors at a time.
             //
-            loadSize = 0;
-            memPtr = addr;
-            do {
-                // Wrap a disk read with two full refresh periods to counter for the amount of time taken to read disk.
-                refreshZ80AllRows();
-                sizeToRead = (size-loadSize) > SECTOR_SIZE ? SECTOR_SIZE : size - loadSize;
-                fr0 = f_read(&File, buf, sizeToRead, &readSize);
-                refreshZ80AllRows();
-                if (fr0 || readSize == 0) break;   /* error or eof */
-
-                // Go through each byte in sector and send to Z80 bus.
-                for(unsigned int idx=0; idx < readSize; idx++)
-                {
-                    // At the halfway mark perform a full refresh.
-                    if(idx == (SECTOR_SIZE/2)) 
-                    {
-                        refreshZ80AllRows();
-                    }
-                   
-                    // And now write the byte and to the next address!
-                    writeZ80Memory((uint32_t)memPtr, buf[idx], target);
-                    memPtr++;
-                }
-                loadSize += readSize;
-            } while(loadSize < size);
+            sink.addr   = addr;
+            sink.target = target;
+            fr0 = readAheadStream(&File, size, loadBuf, TZ_LOAD_BUF_SIZE, loadZ80Sink, &sink, &loadSize);
           
             // Reset the memory management for MZ-700/MZ-800.
             //
@@ -3177,8 +3452,8 @@ void printfHost(uint8_t x, uint8_t y, char *format, ...)
 // Method to test if a reset event has occurred, ie. the user pressed the RESET button.
 uint8_t isZ80Reset(void)
 {
-    // Return the value which would have been updated in the interrupt routine.
-    return(z80Control.resetEvent == 1);
+    // Return the value which would have been posted by the interrupt routine.
+    return(evqPending(EVQ_RESET));
 }
 
 // Method to test to see if the main memory has been swapped from 0000-0FFF to C000-CFFF
@@ -3188,26 +3463,27 @@ uint8_t isZ80MemorySwapped(void)
     return(z80Control.memorySwap == 1);
 }
 
-// Method to get an IO instruction event should one have occurred since last poll.
+// Method to get an IO instruction event should one have occurred since last poll. The zOS service loop dispatches
+// these events itself, this method remains for applications which poll whilst they have control.
 //
 uint8_t getZ80IO(uint8_t *addr)
 {
     // Locals.
     uint8_t retcode = 1;
 
-    if(z80Control.svcRequest == 1)
+    if(evqPending(EVQ_SVCREQ))
     {
         *addr = IO_TZ_SVCREQ;
-        z80Control.svcRequest = 0;
+        evqClear(EVQ_SVCREQ);
     } else
-    if(z80Control.sysRequest == 1)
+    if(evqPending(EVQ_SYSREQ))
     {
         *addr = IO_TZ_SYSREQ;
-        z80Control.sysRequest = 0;
+        evqClear(EVQ_SYSREQ);
     } else
-    if(z80Control.ioEvent == 1)
+    if(evqPending(EVQ_IOEVENT))
     {
-        z80Control.ioEvent = 0;
+        evqClear(EVQ_IOEVENT);
         printf("I/O:%2x\n", z80Control.ioAddr);
     } else
     {
@@ -3221,7 +3497,19 @@ uint8_t getZ80IO(uint8_t *addr)
 //
 void clearZ80Reset(void)
 {
-    z80Control.resetEvent = 0;
+    evqClear(EVQ_RESET);
+}
+
+// Method to enable (1) or disable (0) the block transfer engine used by the array and copy methods. Disabling reverts to the
+// byte at a time bus cycles and is primarily used to benchmark or diagnose timing issues. The previous setting is returned.
+//
+uint8_t setZ80BurstMode(uint8_t enable)
+{
+    // Locals.
+    uint8_t lastMode = z80Control.burstMode;
+
+    z80Control.burstMode = (enable != 0);
+    return(lastMode);
 }
 
 // Method to convert a Sharp filename into an Ascii filename.
@@ -4212,7 +4500,6 @@ uint8_t svcReadDirCache(uint8_t mode, enum FILE_TYPE type)
                         } else
                         // All other types just output the filename upto the limit truncating as necessary.
                         {
-                            osControl.dirMap.sdFileName[dirEntry][TZSVC_LONG_FNAME_SIZE] = 0x00;
                             strncpy((char *)&dirBlock->dirEnt[idx].fileName, (char *)osControl.dirMap.sdFileName[dirEntry],  TZSVC_LONG_FNAME_SIZE);
                         }
 
@@ -4273,14 +4560,14 @@ uint8_t svcFindFileCache(char *file, char *searchFile, uint8_t searchNo, enum FI
             do {
                 // Check to see if the file matches any given wildcard. If we dont have a match loop to next directory entry.
                 //
-                if(matchFileWithWildcard((char *)&svcControl.wildcard, type == MZF ? (char *)&osControl.dirMap.mzfFile[idx]->mzfHeader.fileName : (char *)&osControl.dirMap.sdFileName[idx], 0, 0))
+                if(matchFileWithWildcard((char *)&svcControl.wildcard, type == MZF ? (char *)&osControl.dirMap.mzfFile[idx]->mzfHeader.fileName : (char *)osControl.dirMap.sdFileName[idx], 0, 0))
                 {
                     // If a filename has been given, see if this file matches it.
                     if(searchFile != NULL)
                     {
                         // Check to see if the file matches the name given with wildcard expansion if needed.
                         //
-                        if(matchFileWithWildcard(searchFile, type == MZF ? (char *)&osControl.dirMap.mzfFile[idx]->mzfHeader.fileName : (char *)&osControl.dirMap.sdFileName[idx], 0, 0))
+                        if(matchFileWithWildcard(searchFile, type == MZF ? (char *)&osControl.dirMap.mzfFile[idx]->mzfHeader.fileName : (char *)osControl.dirMap.sdFileName[idx], 0, 0))
                         {
                             found = 2;
                         }
@@ -4317,161 +4604,78 @@ uint8_t svcFindFileCache(char *file, char *searchFile, uint8_t searchNo, enum FI
     return(result == FR_OK ? (found == 0 ? 0 : 1) : 0);
 }
 
+// Directory to be cached by the background refresh, a request made whilst a refresh is in progress builds again once it completes.
+//
+static struct {
+    char                             directory[TZSVC_DIRNAME_SIZE];      // Directory to cache.
+    enum FILE_TYPE                   type;                               // Type of file being cached.
+    uint8_t                          pending;                            // A (re)build has been requested.
+} svcCacheRefresh;
+
 // Method to build up a cache of all the files on the SD card in a given directory along with any mapping to Sharp MZ80A headers if required.
-// For Sharp MZ80A files this involves scanning each file to extract the MZF header and creating a map.
+// For Sharp MZ80A files the MZF headers are taken from the directory index where possible, see dircache.c, only new or changed files are opened.
 //
 uint8_t svcCacheDir(const char *directory, enum FILE_TYPE type, uint8_t force)
 {
     // Locals
-    uint8_t        fileNo    = 0;
-    unsigned int   readSize;
-    char           fqfn[FF_LFN_BUF + 13];  // 0:\12345678\<filename>
-    FIL            File;
-    FILINFO        fno;
-    DIR            dirFp;
     FRESULT        result    = FR_OK;
-    t_svcCmpDirEnt dirEnt;
+    DIR            dirFp;
 
     // No need to cache directory if we have already cached it.
     if(force == 0 && osControl.dirMap.valid && strcasecmp(directory, osControl.dirMap.directory) == 0 && osControl.dirMap.type == type)
         return(1);
 
-    // Invalidate the map and free existing memory incase of errors.
-    //
-    osControl.dirMap.valid = 0;
-    for(uint8_t idx=0; idx < osControl.dirMap.entries; idx++)
+    // Called at a yield point of a background refresh, the cache is invalid until it completes and callers read the directory directly.
+    // The directory is validated here and, if another, the cache rebuilt for it once the refresh is done.
+    if(dirCacheBusy())
     {
-        if(osControl.dirMap.type == MZF && osControl.dirMap.mzfFile[idx])
-        {
-            free(osControl.dirMap.mzfFile[idx]->sdFileName);
-            free(osControl.dirMap.mzfFile[idx]);
-            osControl.dirMap.mzfFile[idx] = 0;
-        } else
+        result = f_opendir(&dirFp, directory);
+        if(result == FR_OK)
         {
-            free(osControl.dirMap.sdFileName[idx]);
-            osControl.dirMap.sdFileName[idx] = 0;
+            f_closedir(&dirFp);
+            if(strcasecmp(directory, svcCacheRefresh.directory) != 0 || type != svcCacheRefresh.type)
+                svcCacheDirDefer(directory, type);
         }
+        return(result == FR_OK ? TZSVC_STATUS_OK : TZSVC_STATUS_FILE_ERROR);
     }
-    osControl.dirMap.entries = 0;
-    osControl.dirMap.type = MZF;
-
-    // Open the directory and extract all files.
-    result = f_opendir(&dirFp, directory);
-    if(result == FR_OK)
-    {
-        fileNo = 0;
-        
-        do {
-            // Read an SD directory entry. If reading Sharp MZ80A files then open the returned SD file so that we can to read out the important MZF data for name matching.
-            //
-            result = f_readdir(&dirFp, &fno);
-
-            // If an error occurs or we are at the end of the directory listing close the sector and pass back.
-            if(result != FR_OK || fno.fname[0] == 0) break;
-
-            // Check to see if this is a valid file for the given type.
-            const char *ext = strrchr(fno.fname, '.');
-            if(type == MZF && (!ext || strcasecmp(++ext, TZSVC_DEFAULT_MZF_EXT) != 0))
-                continue;
-            if(type == BAS && (!ext || strcasecmp(++ext, TZSVC_DEFAULT_BAS_EXT) != 0))
-                continue;
-            if(type == CAS && (!ext || strcasecmp(++ext, TZSVC_DEFAULT_CAS_EXT) != 0))
-                continue;
-            if(type == ALL && !ext)
-                continue;
-
-            // Sharp files need special handling, the file needs te opened and the Sharp filename read out, this is then used in the cache.
-            //
-            if(type == MZF)
-            {
-                // Build filename.
-                //
-                sprintf(fqfn, "0:\\%s\\%s", directory, fno.fname);
-
-                // Open the file so we can read out the MZF header which is the information TZFS/CPM needs.
-                //
-                result = f_open(&File, fqfn, FA_OPEN_EXISTING | FA_READ);
-             
-                // If no error occurred, read in the header.
-                //
-                if(!result) result = f_read(&File, (char *)&dirEnt, TZSVC_CMPHDR_SIZE, &readSize);
-
-                // No errors, read the header.
-                if(!result && readSize == TZSVC_CMPHDR_SIZE)
-                {
-                    // Close the file, no longer needed.
-                    f_close(&File);
-
-                    // Cache this entry. The SD filename is dynamically allocated as it's size can be upto 255 characters for LFN names. The Sharp name is 
-                    // fixed at 17 characters as you cant reliably rely on terminators and the additional data makes it a constant 32 chars long.
-                    osControl.dirMap.mzfFile[fileNo] = (t_sharpToSDMap *)malloc(sizeof(t_sharpToSDMap));
-                    if(osControl.dirMap.mzfFile[fileNo] != NULL)
-                        osControl.dirMap.mzfFile[fileNo]->sdFileName = (uint8_t *)malloc(strlen(fno.fname)+1);
 
-                    if(osControl.dirMap.mzfFile[fileNo] == NULL || osControl.dirMap.mzfFile[fileNo]->sdFileName == NULL)
-                    {
-                        printf("Out of memory cacheing directory:%s\n", directory);
-                        for(uint8_t idx=0; idx <= fileNo; idx++)
-                        {
-                            if(osControl.dirMap.mzfFile[idx])
-                            {
-                                free(osControl.dirMap.mzfFile[idx]->sdFileName);
-                                free(osControl.dirMap.mzfFile[idx]);
-                                osControl.dirMap.mzfFile[idx] = 0;
-                            }
-                        }
-                        result = FR_NOT_ENOUGH_CORE;
-                    } else
-                    {
-                        // Copy in details into this maps node.
-                        strcpy((char *)osControl.dirMap.mzfFile[fileNo]->sdFileName, fno.fname);
-                        memcpy((char *)&osControl.dirMap.mzfFile[fileNo]->mzfHeader, (char *)&dirEnt, TZSVC_CMPHDR_SIZE);
-                        fileNo++;
-                    }
-                }
-            } else
-            {
-                // Cache this entry. The SD filename is dynamically allocated as it's size can be upto 255 characters for LFN names. The SD service header is based
-                // on Sharp names which are fixed at 17 characters which shouldnt be a problem, just truncate the name as there is no support for longer names yet!
-                osControl.dirMap.sdFileName[fileNo] = (uint8_t *)malloc(strlen(fno.fname)+1);
+    // Release the existing cache and build the new one, the map is only valid on success.
+    //
+    result = dirCacheBuild(&osControl.dirMap, directory, type);
 
-                if(osControl.dirMap.sdFileName[fileNo] == NULL)
-                {
-                    printf("Out of memory cacheing directory:%s\n", directory);
-                    for(uint8_t idx=0; idx <= fileNo; idx++)
-                    {
-                        if(osControl.dirMap.sdFileName[idx])
-                        {
-                            free(osControl.dirMap.sdFileName[idx]);
-                            osControl.dirMap.sdFileName[idx] = 0;
-                        }
-                    }
-                    result = FR_NOT_ENOUGH_CORE;
-                } else
-                {
-                    // Copy in details into this maps node.
-                    strcpy((char *)osControl.dirMap.sdFileName[fileNo], fno.fname);
-                    fileNo++;
-                }
-            }
-        } while(!result && fileNo < TZSVC_MAX_DIR_ENTRIES);
+    // Return values: 0 - Success : maps to TZSVC_STATUS_OK
+    //                1 - Fail    : maps to TZSVC_STATUS_FILE_ERROR
+    return(result == FR_OK ? TZSVC_STATUS_OK : TZSVC_STATUS_FILE_ERROR);
+}
 
-    }
+// Event queue background job to rebuild the directory cache. The build yields between entries holding only the cache, so a service
+// request is not held up by a refresh, see svcCacheDir.
+//
+static uint8_t svcCacheDirJob(void *ctx)
+{
+    // Locals.
+    char           directory[TZSVC_DIRNAME_SIZE];
 
-    // Success?
-    if(result == FR_OK && (fno.fname[0] == 0 || fileNo == TZSVC_MAX_DIR_ENTRIES))
+    if(svcCacheRefresh.pending)
     {
-        // Validate the cache.
-        osControl.dirMap.valid = 1;
-        osControl.dirMap.entries = fileNo;
-        strcpy(osControl.dirMap.directory, directory);
-        // Save the filetype.
-        osControl.dirMap.type = type;
+        // Taken before the build as a request at one of its yield points may replace it.
+        svcCacheRefresh.pending = 0;
+        strcpy(directory, svcCacheRefresh.directory);
+        svcCacheDir(directory, svcCacheRefresh.type, 1);
     }
+    return(svcCacheRefresh.pending ? EVQ_JOB_MORE : EVQ_JOB_DONE);
+}
 
-    // Return values: 0 - Success : maps to TZSVC_STATUS_OK
-    //                1 - Fail    : maps to TZSVC_STATUS_FILE_ERROR
-    return(result == FR_OK ? TZSVC_STATUS_OK : TZSVC_STATUS_FILE_ERROR);
+// Method to rebuild the directory cache in the background, used once a service which changed the directory has returned its result.
+//
+void svcCacheDirDefer(const char *directory, enum FILE_TYPE type)
+{
+    strncpy(svcCacheRefresh.directory, directory, TZSVC_DIRNAME_SIZE-1);
+    svcCacheRefresh.directory[TZSVC_DIRNAME_SIZE-1] = 0x00;
+    svcCacheRefresh.type    = type;
+    svcCacheRefresh.pending = 1;
+    evqDefer(svcCacheDirJob, NULL, EVQ_USES_DIRCACHE);
+    return;
 }
 
 // Method to open a file for reading and return requested sectors.
@@ -4482,7 +4686,7 @@ uint8_t svcReadFile(uint8_t mode, enum FILE_TYPE type)
     //
     static FIL        File;
     static uint8_t    fileOpen   = 0;         // Seperate flag as their is no public way to validate that File is open and valid, the method in FatFS is private for this functionality.
-    static uint8_t    fileSector = 0;         // Sector number being read.
+    static t_readAhead readAhead;             // Double buffer, sector position and sequential detection for the open file.
     FRESULT           result    = FR_OK;
     unsigned int      readSize;
     char              fqfn[FF_LFN_BUF + 13];  // 0:\12345678\<filename>
@@ -4518,37 +4722,28 @@ uint8_t svcReadFile(uint8_t mode, enum FILE_TYPE type)
                 // Reentrant call to actually read the data.
                 //
                 fileOpen   = 1; 
-                fileSector = 0;
+                readAheadInit(&readAhead, &File);
                 result     = (FRESULT)svcReadFile(TZSVC_NEXT, type);
             }
         }
     }
   
-    // Read the next sector from the file.
+    // Read the next sector from the file. The read-ahead module returns the prefetched sector if it is the one requested,
+    // otherwise it seeks as needed and reads the sector directly.
     else if(mode == TZSVC_NEXT && fileOpen == 1)
     {
-        // If the Z80 is requesting a non sequential sector then seek to the correct location prior to the read.
-        //
-        if(fileSector != svcControl.fileSector)
-        {
-            result = f_lseek(&File, (svcControl.fileSector * TZSVC_SECTOR_SIZE));
-            fileSector = svcControl.fileSector;
-        }
+        result = readAheadRead(&readAhead, svcControl.fileSector, (uint8_t *)&svcControl.sector, &readSize);
 
-        // Proceed if no errors have occurred.
+        // Place number of bytes read into the record for the Z80 to know where EOF is.
         //
         if(!result)
-        {
-            // Read the required sector.
-            result = f_read(&File, (char *)&svcControl.sector, TZSVC_SECTOR_SIZE, &readSize);
-
-            // Place number of bytes read into the record for the Z80 to know where EOF is.
-            //
             svcControl.loadSize = readSize;
-        }
+    }
 
-        // Move onto next sector.
-        fileSector++;
+    // Fetch the following sector whilst the Z80 consumes the one just returned.
+    else if(mode == TZSVC_PREFETCH && fileOpen == 1)
+    {
+        readAheadFetch(&readAhead);
     }
    
     // Close the currently open file.
@@ -4557,6 +4752,7 @@ uint8_t svcReadFile(uint8_t mode, enum FILE_TYPE type)
         if(fileOpen)
             f_close(&File);
         fileOpen = 0;
+        readAheadInit(&readAhead, NULL);
     }
 
     // Return values: 0 - Success : maps to TZSVC_STATUS_OK
@@ -4817,6 +5013,77 @@ uint8_t svcEraseFile(enum FILE_TYPE type)
     return(result == FR_OK ? TZSVC_STATUS_OK : TZSVC_STATUS_FILE_ERROR);
 }
 
+#if FF_USE_FASTSEEK == 1
+// Method to create a cluster link map table (CLMT) for an open disk image so that random seeks go direct to the cluster
+// rather than walking the FAT chain from the start of the file. The map size is probed with a small stack table and, if
+// larger, allocated on the heap up to TZ_CLMT_MAX_SIZE. If the heap cannot satisfy the request the file is left in normal
+// seek mode, which is slower but functionally identical. In fast seek mode a file cannot be extended, so a map should only
+// be created for images which are already at their full size.
+//
+FRESULT createFastSeekMap(FIL *fp)
+{
+    // Locals.
+    //
+    DWORD          probe[TZ_CLMT_PROBE_SIZE];
+    DWORD          *clmt;
+    FRESULT        result;
+
+    // Release any existing map and dont map empty files, they have no cluster chain.
+    releaseFastSeekMap(fp);
+    if(f_size(fp) == 0)
+        return(FR_OK);
+
+    // Probe with the stack table, most images are contiguous or nearly so and fit.
+    probe[0] = TZ_CLMT_PROBE_SIZE;
+    fp->cltbl = probe;
+    result = f_lseek(fp, CREATE_LINKMAP);
+    fp->cltbl = NULL;
+
+    // On success probe[0] holds the number of DWORDS used, on FR_NOT_ENOUGH_CORE the number required.
+    if((result == FR_OK || result == FR_NOT_ENOUGH_CORE) && probe[0] <= TZ_CLMT_MAX_SIZE)
+    {
+        clmt = (DWORD *)malloc(probe[0] * sizeof(DWORD));
+        if(clmt == NULL)
+        {
+            result = FR_NOT_ENOUGH_CORE;
+        } else
+        if(result == FR_OK)
+        {
+            memcpy(clmt, probe, probe[0] * sizeof(DWORD));
+            fp->cltbl = clmt;
+        } else
+        {
+            clmt[0]   = probe[0];
+            fp->cltbl = clmt;
+            result    = f_lseek(fp, CREATE_LINKMAP);
+            if(result)
+            {
+                releaseFastSeekMap(fp);
+            }
+        }
+    }
+
+    // Lack of memory or a heavily fragmented image isnt an error, the image is still accessible via normal seek.
+    if(result == FR_NOT_ENOUGH_CORE || (result == FR_OK && fp->cltbl == NULL))
+    {
+        printf("Fast seek map not created (%lu), using normal seek.\n", probe[0]);
+        result = FR_OK;
+    }
+    return(result);
+}
+
+// Method to release a cluster link map table and return the file to normal seek mode.
+//
+void releaseFastSeekMap(FIL *fp)
+{
+    if(fp->cltbl != NULL)
+    {
+        free(fp->cltbl);
+        fp->cltbl = NULL;
+    }
+}
+#endif
+
 // Method to add a SD disk file as a CP/M disk drive for read/write by CP/M.
 //
 uint8_t svcAddCPMDrive(void)
@@ -4835,6 +5102,10 @@ uint8_t svcAddCPMDrive(void)
     {
         if(osControl.cpmDriveMap.drive[svcControl.fileNo]->fileName != NULL)
         {
+            f_close(&osControl.cpmDriveMap.drive[svcControl.fileNo]->File);
+          #if FF_USE_FASTSEEK == 1
+            releaseFastSeekMap(&osControl.cpmDriveMap.drive[svcControl.fileNo]->File);
+          #endif
             free(osControl.cpmDriveMap.drive[svcControl.fileNo]->fileName);
             osControl.cpmDriveMap.drive[svcControl.fileNo]->fileName = 0;
         }
@@ -4871,9 +5142,16 @@ uint8_t svcAddCPMDrive(void)
             {
                 osControl.cpmDriveMap.drive[svcControl.fileNo]->lastTrack = 0;
                 osControl.cpmDriveMap.drive[svcControl.fileNo]->lastSector = 0;
-            } else
+
+              #if FF_USE_FASTSEEK == 1
+                // Map the image clusters so that track/sector seeks dont walk the FAT chain.
+                result = createFastSeekMap(&osControl.cpmDriveMap.drive[svcControl.fileNo]->File);
+              #endif
+            }
+            if(result)
             {
-                // Error opening file so free up and release slot, return error.
+                // Error opening or mapping file so close, free up and release slot, return error.
+                f_close(&osControl.cpmDriveMap.drive[svcControl.fileNo]->File);
                 free(osControl.cpmDriveMap.drive[svcControl.fileNo]->fileName);
                 osControl.cpmDriveMap.drive[svcControl.fileNo]->fileName = 0;
                 free(osControl.cpmDriveMap.drive[svcControl.fileNo]);
@@ -4960,6 +5238,14 @@ uint8_t svcWriteCPMDrive(void)
     // Calculate the offset into the file.
     fileOffset = ((svcControl.trackNo * CPM_SECTORS_PER_TRACK) + svcControl.sectorNo) * SECTOR_SIZE;
 
+  #if FF_USE_FASTSEEK == 1
+    // A file in fast seek mode cannot be extended, if the write lies beyond the end of the image revert to normal seek.
+    if(fileOffset + SECTOR_SIZE > f_size(&osControl.cpmDriveMap.drive[svcControl.fileNo]->File))
+    {
+        releaseFastSeekMap(&osControl.cpmDriveMap.drive[svcControl.fileNo]->File);
+    }
+  #endif
+
     // Seek to the correct location as directed by the track/sector.
     result = f_lseek(&osControl.cpmDriveMap.drive[svcControl.fileNo]->File, fileOffset);
     if(!result)
@@ -5103,6 +5389,7 @@ void processServiceRequest(void)
     uint8_t    status          = 0;
     uint8_t    doExit          = 0;
     uint8_t    doReset         = 0;
+    uint8_t    doReadAhead     = 0;
     uint32_t   actualFreq;
     uint32_t   copySize        = TZSVC_CMD_STRUCT_SIZE;
 
@@ -5160,11 +5447,13 @@ void processServiceRequest(void)
                 // Open a file stream and return the first block.
                 case TZSVC_CMD_READFILE:
                     status=svcReadFile(TZSVC_OPEN, svcControl.fileType);
+                    doReadAhead = (status == TZSVC_STATUS_OK);
                     break;
 
                 // Read the next block in the file stream.
                 case TZSVC_CMD_NEXTREADFILE:
                     status=svcReadFile(TZSVC_NEXT, svcControl.fileType);
+                    doReadAhead = (status == TZSVC_STATUS_OK);
                     break;
 
                 // Create a file for data write.
@@ -5381,7 +5670,7 @@ void processServiceRequest(void)
                     writeZ80IO(IO_TZ_VMCTRL, VMMODE_MZ700, TRANZPUTER);
                    
                     // Set a reset event so that the ROMS are reloaded and the Z80 set.
-                    z80Control.resetEvent = 1;
+                    evqPost(EVQ_RESET);
                     break;
 
                 // Switch the hardware to select the soft T80 CPU. This involves the switch.
@@ -5392,7 +5681,7 @@ void processServiceRequest(void)
                     writeZ80IO(IO_TZ_CPUCFG, CPUMODE_SET_T80, TRANZPUTER);
                   
                     // Set a reset event so that the ROMS are reloaded and a reset occurs.
-                    z80Control.resetEvent = 1;
+                    evqPost(EVQ_RESET);
                     break;
                    
                 // Switch the hardware to select the soft ZPU Evolution CPU. This involves the switch.
@@ -5403,7 +5692,7 @@ void processServiceRequest(void)
                     writeZ80IO(IO_TZ_CPUCFG, CPUMODE_SET_ZPU_EVO, TRANZPUTER);
                   
                     // Set a reset event so that the ROMS are reloaded and a reset occurs.
-                    z80Control.resetEvent = 1;
+                    evqPost(EVQ_RESET);
                     break;
 
                 // Switch the hardware to select the Sharp MZ Series Emulations and load up the settings accordingly.
@@ -5425,11 +5714,14 @@ void processServiceRequest(void)
                         // Switch to the emulation CPU (T80).
                         writeZ80IO(IO_TZ_CPUCFG, CPUMODE_SET_EMU_MZ, TRANZPUTER);
 
-                        // Enable the emulator service methods to handle User OSD Menu, tape/floppy loading etc.
+                        // Enable the emulator service methods to handle User OSD Menu, tape/floppy loading etc. A service request is now an
+                        // emulator interrupt and the periodic service runs as a background job, both use the emulation state.
                         z80Control.emuMZactive = 1;
+                        evqRegister(EVQ_SVCREQ, processServiceRequest, EVQ_USES_Z80BUS | EVQ_USES_SDCARD | EVQ_USES_EMU);
+                        evqDefer(TZPUserviceJob, NULL, EVQ_USES_Z80BUS | EVQ_USES_SDCARD | EVQ_USES_EMU);
 
                         // Set a reset event so that the ROMS are reloaded and a reset occurs.
-                        z80Control.resetEvent = 1;
+                        evqPost(EVQ_RESET);
                     } else
                     {
                         printf("Failed to init EmuMZ core\n");
@@ -5490,14 +5782,18 @@ void processServiceRequest(void)
         svcControl.result = status;
         copyToZ80(z80Control.svcControlAddr, (uint8_t *)&svcControl, copySize, z80Control.svcControlAddr > TZ_MAX_Z80_MEM ? FPGA : TRANZPUTER);
 
-        // Need to refresh the directory? Do this at the end of the routine so the Sharp MZ80A isnt held up.
+        // Need to refresh the directory? This is done in the background once the result is with the Z80 so it isnt held up, nor is its next request.
         if(refreshCacheDir)
-            svcCacheDir((const char *)svcControl.directory, svcControl.fileType, 1);
+            svcCacheDirDefer((const char *)svcControl.directory, svcControl.fileType);
 
         // Finally, return the memory management mode to original and release the Z80 Bus.
         writeCtrlLatch(z80Control.runCtrlLatch);
         z80Control.holdZ80 = 0;
         releaseZ80();
+
+        // With the Z80 now copying out the sector just read, fetch the next one so a sequential request is answered from memory.
+        if(doReadAhead)
+            svcReadFile(TZSVC_PREFETCH, svcControl.fileType);
    
         // If the doExit flag is set it means the CPU should be set to original memory mode and reset.
         if(doExit == 1)
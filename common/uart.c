@@ -21,17 +21,172 @@
 #endif
 
 #include "uart.h"
+#if defined(UART_RINGS)
+  #include "interrupts.h"
+#endif
+
+// Data register access, overridable so the driver can be run against a UART model on the host.
+#if !defined(UART_PUT)
+  #define UART_PUT(x, c)               UART_DATA(x) = (c)
+  #define UART_GET(x)                  UART_DATA(x)
+#endif
+#define UART_TX_READY(x)               (!((UART_IS_TX_FIFO_ENABLED(x) && UART_IS_TX_FIFO_FULL(x)) || (UART_IS_TX_FIFO_DISABLED(x) && UART_IS_TX_DATA_LOADED(x))))
+#define UART_TX_IDLE(x)                (!UART_IS_TX_BUSY(x) && (UART_IS_TX_FIFO_ENABLED(x) ? ((x) & UART_TX_FIFO_EMPTY) != 0 : !UART_IS_TX_DATA_LOADED(x)))
 
 static uint8_t uart_channel = 0;
 
+#if defined(UART_RINGS)
+// Console rings for UART0. The indexes run freely and are masked on access, the TX ring is filled by the
+// writers and drained into the UART FIFO under interrupt, the RX ring is filled under interrupt and drained
+// by the readers. A writer holds txLock whilst it works on the TX ring so the interrupt leaves it alone.
+//
+static uint8_t           txRing[UART_TX_RING_SIZE];
+static uint8_t           rxRing[UART_RX_RING_SIZE];
+static volatile uint16_t txHead   = 0;
+static volatile uint16_t txTail   = 0;
+static volatile uint16_t rxHead   = 0;
+static volatile uint16_t rxTail   = 0;
+static volatile uint8_t  txLock   = 0;
+static volatile uint8_t  txActive = 0;
+static t_uartStats       uartStats;
+
+// Method to move received bytes from the UART FIFO into the RX ring.
+//
+static void uartRxPump(void)
+{
+    uint32_t status = UART_STATUS(UART0);
+    uint16_t used;
+
+    if(status & UART_RX_OVERRUN)
+        uartStats.rxOverrun++;
+
+    while(UART_IS_RX_DATA_READY(status))
+    {
+        used = (uint16_t)(rxHead - rxTail);
+        if(used >= UART_RX_RING_SIZE)
+        {
+            (void)UART_GET(UART0);
+            uartStats.rxOverrun++;
+        } else
+        {
+            rxRing[rxHead & (UART_RX_RING_SIZE-1)] = (uint8_t)UART_GET(UART0);
+            rxHead++;
+            if(++used > uartStats.rxPeak)
+                uartStats.rxPeak = used;
+        }
+        uartStats.rxBytes++;
+        status = UART_STATUS(UART0);
+    }
+}
+
+// Method to move bytes from the TX ring into the UART FIFO. Returns 1 if bytes remain waiting in the ring.
+//
+static uint8_t uartTxPump(void)
+{
+    uint32_t status = UART_STATUS(UART0);
+
+    // The line has gone idle whilst bytes were waiting for the interrupt.
+    if(txActive && UART_TX_IDLE(status))
+        uartStats.txUnderrun++;
+
+    while(txHead != txTail && UART_TX_READY(status))
+    {
+        UART_PUT(UART0, txRing[txTail & (UART_TX_RING_SIZE-1)]);
+        txTail++;
+        uartStats.txBytes++;
+        status = UART_STATUS(UART0);
+    }
+    txActive = (txHead != txTail);
+    return(txActive);
+}
+
+// Method to queue bytes in the TX ring, expanding NL to CR NL if requested. When the ring is full the caller
+// either waits, moving bytes into the UART itself, or stops. Returns the number of bytes taken from buf.
+//
+static int uartTxQueue(const char *buf, int len, uint8_t addCR, uint8_t block)
+{
+    int      sent = 0;
+    uint16_t used;
+    uint16_t need;
+
+    txLock = 1;
+    DisableInterrupt(INTR_UART0_TX);
+    while(sent < len)
+    {
+        need = (addCR && buf[sent] == '\n') ? 2 : 1;
+        used = (uint16_t)(txHead - txTail);
+        if(used + need > UART_TX_RING_SIZE)
+        {
+            uartStats.txOverrun++;
+            if(!block)
+                break;
+            do {
+                uartTxPump();
+            } while((uint16_t)(txHead - txTail) + need > UART_TX_RING_SIZE);
+            used = (uint16_t)(txHead - txTail);
+        }
+        if(need == 2)
+        {
+            txRing[txHead & (UART_TX_RING_SIZE-1)] = '\r';
+            txHead++;
+        }
+        txRing[txHead & (UART_TX_RING_SIZE-1)] = buf[sent++];
+        txHead++;
+        if(used + need > uartStats.txPeak)
+            uartStats.txPeak = used + need;
+    }
+
+    // Start the transmitter, the interrupt carries on with anything the FIFO cannot yet take.
+    uartTxPump();
+    txLock = 0;
+    if(txActive)
+        EnableInterrupt(INTR_UART0_TX);
+    return(sent);
+}
+
+// Method to service the UART0 interrupts, called from the interrupt handler.
+//
+void uart_service(void)
+{
+    uartRxPump();
+    if(!txLock && !uartTxPump())
+    {
+        // Nothing left to send, stop the transmit interrupt. The handler applies the setting on exit.
+        UpdateInterruptSetting(0, INTR_UART0_TX);
+    }
+}
+
+// Method to wait for a received byte in the RX ring, collecting directly from the UART whilst the
+// receive interrupt is disabled.
+//
+static uint8_t uartRxWait(uint8_t block)
+{
+    while(rxHead == rxTail)
+    {
+        if(!(INTERRUPT_CTRL(INTR0) & INTR_UART0_RX))
+            uartRxPump();
+        if(!block && rxHead == rxTail)
+            return(0);
+    }
+    return(1);
+}
+#endif
+
 inline int _putchar(unsigned char c)
 {
     uint32_t status;
 
+  #if defined(UART_RINGS)
+    if(uart_channel == 0)
+    {
+        uartTxQueue((const char *)&c, 1, 0, 1);
+        return(c);
+    }
+  #endif
     do {
         status = UART_STATUS(uart_channel == 0 ? UART0 : UART1);
-    } while((UART_IS_TX_FIFO_ENABLED(status) && UART_IS_TX_FIFO_FULL(status)) || (UART_IS_TX_FIFO_DISABLED(status) && UART_IS_TX_DATA_LOADED(status)));
-    UART_DATA(uart_channel == 0 ? UART0 : UART1) = (int)c;
+    } while(!UART_TX_READY(status));
+    UART_PUT(uart_channel == 0 ? UART0 : UART1, (int)c);
 
     return(c);
 }
@@ -49,6 +204,14 @@ int uart_putchar(char c, FILE *stream)
 {
     uint32_t status;
 
+  #if defined(UART_RINGS)
+    if(uart_channel == 0)
+    {
+        uartTxQueue(&c, 1, 1, 1);
+        return(0);
+    }
+  #endif
+
     // Add CR when NL detected.
     if (c == '\n')
         uart_putchar('\r', stream);
@@ -56,11 +219,115 @@ int uart_putchar(char c, FILE *stream)
     // Wait for a slot to become available in UART buffer and then send character.
     do {
         status = UART_STATUS(uart_channel == 0 ? UART0 : UART1);
-    } while((UART_IS_TX_FIFO_ENABLED(status) && UART_IS_TX_FIFO_FULL(status)) || (UART_IS_TX_FIFO_DISABLED(status) && UART_IS_TX_DATA_LOADED(status)));
-    UART_DATA(uart_channel == 0 ? UART0 : UART1) = c;
+    } while(!UART_TX_READY(status));
+    UART_PUT(uart_channel == 0 ? UART0 : UART1, c);
 
     return(0);
 }
+
+// Stream block write for stdio, sends a run of characters with the UART selected once rather than a
+// function call and channel lookup per character.
+//
+int uart_write(const char *buf, int len, FILE *stream)
+{
+    uint32_t status;
+    uint32_t uart = (uart_channel == 0 ? UART0 : UART1);
+    char     c;
+
+  #if defined(UART_RINGS)
+    if(uart_channel == 0)
+    {
+        uartTxQueue(buf, len, 1, 1);
+        return(0);
+    }
+  #endif
+
+    while(len-- > 0)
+    {
+        c = *buf++;
+
+        // Add CR when NL detected.
+        if(c == '\n')
+        {
+            do {
+                status = UART_STATUS(uart);
+            } while(!UART_TX_READY(status));
+            UART_PUT(uart, '\r');
+        }
+        do {
+            status = UART_STATUS(uart);
+        } while(!UART_TX_READY(status));
+        UART_PUT(uart, c);
+    }
+    return(0);
+}
+
+// Non-blocking write of raw bytes to the console UART, returns the number of bytes accepted which may be
+// fewer than requested, the remainder should be offered again later.
+//
+int uart_write_nb(const char *buf, int len)
+{
+  #if defined(UART_RINGS)
+    return(uartTxQueue(buf, len, 0, 0));
+  #else
+    int sent = 0;
+
+    while(sent < len && UART_TX_READY(UART_STATUS(UART0)))
+    {
+        UART_PUT(UART0, buf[sent++]);
+    }
+    return(sent);
+  #endif
+}
+
+// Method to return the bytes which can be written to the console UART without waiting.
+//
+int uart_tx_free(void)
+{
+  #if defined(UART_RINGS)
+    return(UART_TX_RING_SIZE - (uint16_t)(txHead - txTail));
+  #else
+    return(UART_TX_READY(UART_STATUS(UART0)) ? 1 : 0);
+  #endif
+}
+
+// Method to return the bytes waiting to be read from the console UART.
+//
+int uart_rx_avail(void)
+{
+  #if defined(UART_RINGS)
+    uartRxWait(0);
+    return((uint16_t)(rxHead - rxTail));
+  #else
+    return(UART_IS_RX_DATA_READY(UART_STATUS(UART0)) ? 1 : 0);
+  #endif
+}
+
+// Method to wait until everything written to the console UART has left the transmitter.
+//
+void uart_flush(void)
+{
+  #if defined(UART_RINGS)
+    txLock = 1;
+    DisableInterrupt(INTR_UART0_TX);
+    while(uartTxPump());
+    txLock = 0;
+  #endif
+    while(!UART_TX_IDLE(UART_STATUS(UART0)));
+}
+
+// Method to return the console UART statistics, optionally resetting them.
+//
+void uart_get_stats(t_uartStats *stats, uint8_t reset)
+{
+  #if defined(UART_RINGS)
+    *stats = uartStats;
+    if(reset)
+        memset(&uartStats, 0, sizeof(t_uartStats));
+  #else
+    memset(stats, 0, sizeof(t_uartStats));
+  #endif
+}
 #endif
 
 #if !defined(FUNCTIONALITY) || FUNCTIONALITY <= 2
@@ -123,10 +390,19 @@ char getserial(void)
 {
     uint32_t reg;
 
+  #if defined(UART_RINGS)
+    if(uart_channel == 0)
+    {
+        uartRxWait(1);
+        reg = rxRing[rxTail & (UART_RX_RING_SIZE-1)];
+        rxTail++;
+        return((char)reg);
+    }
+  #endif
     do {
         reg = UART_STATUS(uart_channel == 0 ? UART0 : UART1);
     } while(!UART_IS_RX_DATA_READY(reg));
-    reg=UART_DATA(uart_channel == 0 ? UART0 : UART1);
+    reg=UART_GET(uart_channel == 0 ? UART0 : UART1);
 
     return((char)reg & 0xFF);
 }
@@ -144,6 +420,16 @@ int8_t getserial_nonblocking(void)
 {
     int8_t reg;
 
+  #if defined(UART_RINGS)
+    if(uart_channel == 0)
+    {
+        if(!uartRxWait(0))
+            return(-1);
+        reg = rxRing[rxTail & (UART_RX_RING_SIZE-1)];
+        rxTail++;
+        return(reg);
+    }
+  #endif
     reg = UART_STATUS(uart_channel == 0 ? UART0 : UART1);
     if(!UART_IS_RX_DATA_READY(reg))
     {
@@ -151,7 +437,7 @@ int8_t getserial_nonblocking(void)
     }
     else
     {
-        reg = UART_DATA(uart_channel == 0 ? UART0 : UART1);
+        reg = UART_GET(uart_channel == 0 ? UART0 : UART1);
     }
 
     return(reg);
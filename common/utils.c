@@ -11,6 +11,7 @@
 // Copyright:       (c) 2019 Philip Smart <philip.smart@net2net.org>
 //
 // History:         January 2019   - Initial script written.
+//                  Oct 2026       - Removed the unused CRC32 functions, now in crc32.c.
 //
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 // This source file is free software: you can redistribute it and#or modify
@@ -93,43 +94,6 @@ void printdhex(uint32_t c)
     printhexbyte((uint8_t)(c));
 }
 #endif
-#if defined(ABCD)
-// Function to setup the CRC polynomial table prior to use.
-//
-static unsigned int crc32table[256];
-unsigned int crc32_init(void)
-{
-    int j;
-    unsigned int byte, crc, mask;
-
-    for(byte = 0; byte <= 255; byte++)
-    {
-        crc = byte;
-        for (j = 7; j >= 0; j--)
-        {
-           mask = -(crc & 1);
-           crc = (crc >> 1) ^ (0xEDB88320 & mask);
-        }
-        crc32table[byte] = crc;
-    }
-
-    // Starting value for CRC calculation.
-    //
-    return 0xFFFFFFFF;
-}
-
-// Function to add a word into the CRC sum.
-//
-unsigned int crc32_addword(unsigned int crc_in, unsigned int word)
-{
-   crc_in = (crc_in >> 8) ^ crc32table[(crc_in ^ ((word >> 24)&0xFF)) & 0xFF];
-   crc_in = (crc_in >> 8) ^ crc32table[(crc_in ^ ((word >> 16)&0xFF)) & 0xFF];
-   crc_in = (crc_in >> 8) ^ crc32table[(crc_in ^ ((word >>  8)&0xFF)) & 0xFF];
-   crc_in = (crc_in >> 8) ^ crc32table[(crc_in ^ (word        &0xFF)) & 0xFF];
-
-   return crc_in;
-}
-#endif
 
 // Function to read a 32bit word from the active serial port.
 //
@@ -0,0 +1,105 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            appreg.h
+// Created:         Oct 2026
+// Version:         v1.0
+// Author(s):       Philip Smart
+// Description:     zOS application registry and image cache.
+//                  Header for the module which indexes the application bin directory at boot into a hash
+//                  table, name to file, size and timestamp, so a command is resolved without a search of
+//                  the SD card, and optionally (APP_CACHE) keeps the images of recently run applications
+//                  in RAM so a repeated launch does not read the SD card.
+//
+// Credits:
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         v1.0 Oct 2026  - Initial write.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//                  APP_CACHE             - Cache application images in RAM, budget APP_CACHE_SIZE bytes
+//                                          held in at most APP_CACHE_SLOTS images.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef APPREG_H
+#define APPREG_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+// Constants.
+//
+#define APPREG_BUCKETS               32                                  // Hash table size, a power of 2.
+#define APPREG_GROW                  16                                  // Entries added to the table when it fills.
+#define APPREG_FILE_LEN              20                                  // Longest application filename, 15 character command plus extension.
+#define APPREG_PATH_LEN              32                                  // Longest resolved path, drive and bin directory prefixed.
+#define APPREG_NONE                  0xFFFF                              // End of a hash chain.
+#if !defined(APP_CACHE_SIZE)
+  #define APP_CACHE_SIZE             0x8000                              // Bytes of heap the cached images may occupy.
+#endif
+#if !defined(APP_CACHE_SLOTS)
+  #define APP_CACHE_SLOTS            4                                   // Images held at most.
+#endif
+
+// Registry entry, one per application found in the bin directory.
+//
+typedef struct {
+    char                             file[APPREG_FILE_LEN];              // Filename within the bin directory, command in lower case plus extension.
+    uint32_t                         fsize;                              // FAT file size.
+    uint16_t                         fdate;                              // FAT modified date.
+    uint16_t                         ftime;                              // FAT modified time.
+    uint16_t                         next;                               // Next entry in the hash chain.
+    uint16_t                         launches;                           // Times the application has been run.
+    uint16_t                         hits;                               // Launches served from the image cache.
+    uint16_t                         lastMs;                             // Launch time, lookup to loaded, of the last run.
+    uint32_t                         totalMs;                            // Launch time of all runs.
+} t_appEntry;
+
+// Cached application image.
+//
+typedef struct {
+    char                             file[APPREG_FILE_LEN];              // Key, the filename within the bin directory,
+    uint16_t                         fdate;                              // its FAT modified date and time
+    uint16_t                         ftime;                              //
+    uint32_t                         fsize;                              // and size.
+    uint32_t                         crc;                                // CRC32 of the image, checked on every copy out.
+    uint32_t                         lastUsed;                           // Launch sequence number of the last use, lowest is evicted first.
+    uint8_t                          *image;                             // Image, NULL when the slot is free.
+} t_appCacheSlot;
+
+// Summary of the registry and cache.
+//
+typedef struct {
+    uint16_t                         entries;                            // Applications registered.
+    uint16_t                         buildMs;                            // Time taken to read the bin directory.
+    uint32_t                         cacheBytes;                         // Bytes held in cached images.
+    uint16_t                         cacheImages;                        // Images cached.
+    uint16_t                         cacheEvictions;                     // Images dropped to make room.
+    uint16_t                         cacheRejects;                       // Cached images which failed their CRC check.
+} t_appRegStats;
+
+// Prototypes.
+//
+FRESULT                              appRegBuild(uint8_t, const char *, const char *);
+FRESULT                              appRegLoad(const char *, uint32_t);
+t_appEntry                           *appRegEntry(uint16_t);
+uint8_t                              appRegIsCached(t_appEntry *);
+void                                 appRegGetStats(t_appRegStats *);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // APPREG_H
@@ -0,0 +1,99 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            blkupload.h
+// Created:         Oct 2026
+// Version:         v1.0
+// Author(s):       Philip Smart
+// Description:     Block framed serial upload.
+//                  Header for the IOCP block upload protocol, shared by the target receiver and the host
+//                  uploader (tools/src/iocpupload.c). The image is sent in numbered blocks each carrying
+//                  its own CRC32, the host keeps a window of blocks in flight and the target acknowledges
+//                  each block as it is stored so only failed blocks are sent again.
+//
+//                  Host                                      Target
+//                  "IOCB"                                    (start sequence, read by uploadToMemory)
+//                  size, image CRC, header CRC       ->
+//                                                    <-      READY, window     or  CAN, reason
+//                  SOH, n, ~n, data, block CRC       ->      (repeated, up to window blocks unacknowledged)
+//                                                    <-      ACK, n            or  NAK, n
+//                  EOT                               ->
+//                                                    <-      DONE, status
+//
+//                  Words are sent most significant byte first. The size is a multiple of 4, every block
+//                  is BLK_SIZE bytes apart from the last which holds the remainder. n is the block number
+//                  modulo 256, the target places it relative to the lowest block still missing. A CRC is
+//                  the inverted CRC32 of the bytes it covers.
+//
+// Credits:
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         v1.0 Oct 2026  - Initial write.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef BLKUPLOAD_H
+#define BLKUPLOAD_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+// Constants.
+//
+#define BLK_START_SEQ                    "IOCB"                              // Start sequence selecting the block protocol.
+#define BLK_SIZE                         256                                 // Data bytes per block.
+#define BLK_WINDOW                       8                                   // Blocks the host may have unacknowledged, at most 32.
+#define BLK_BYTE_TIMEOUT                 50                                  // ms between bytes of a frame before it is abandoned.
+#define BLK_IDLE_TIMEOUT                 5000                                // ms without a frame before the upload is abandoned.
+#define BLK_LINGER                       1000                                // ms the target answers repeats after completing.
+
+// Control bytes.
+//
+#define BLK_SOH                          0x01                                // Start of a block.
+#define BLK_EOT                          0x04                                // Host has all blocks acknowledged, ignored until they are.
+#define BLK_ACK                          0x06                                // Block stored.
+#define BLK_READY                        0x12                                // Header accepted.
+#define BLK_NAK                          0x15                                // Block failed its CRC or was cut short.
+#define BLK_DONE                         0x17                                // Upload complete, followed by the status.
+#define BLK_CAN                          0x18                                // Header refused, followed by the reason.
+
+// Header refusal reasons and completion status.
+//
+#define BLK_OK                           0
+#define BLK_ERR_CRC                      1                                   // Image CRC mismatch.
+#define BLK_ERR_HEADER                   2                                   // Header CRC mismatch.
+#define BLK_ERR_SIZE                     3                                   // Image too big or not a word multiple.
+#define BLK_ERR_TIMEOUT                  4                                   // Host went quiet.
+
+// Receiver statistics.
+//
+typedef struct {
+    uint32_t                         blocks;                             // Blocks stored.
+    uint32_t                         naks;                               // Blocks refused.
+    uint32_t                         duplicates;                         // Blocks received again after being stored.
+    uint32_t                         timeouts;                           // Frames abandoned part way.
+    uint32_t                         resyncs;                            // Bytes skipped looking for a frame.
+} t_blkStats;
+
+// Prototypes.
+//
+int                                  blkUpload(uint32_t, uint32_t, t_blkStats *);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // BLKUPLOAD_H
@@ -0,0 +1,67 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            crc32.h
+// Created:         Oct 2026
+// Version:         v1.0
+// Author(s):       Philip Smart
+// Description:     CRC32 (IEEE 802.3, polynomial 0xEDB88320) checksum.
+//                  Header for the table driven CRC32 used by the IOCP serial upload, the fcrc command
+//                  and flash verification. By default the buffer is processed 8 bytes at a time using
+//                  8 lookup tables (slicing-by-8, 8KB), define CRC32_SMALL_TABLE to build the bytewise
+//                  single table (1KB) version for targets short of BRAM.
+//
+//                  The CRC is carried between calls as the raw register value, start with the value
+//                  returned by crc32_init() and invert the final value:
+//                      crc = crc32_init();
+//                      crc = crc32_update(crc, buf, len);
+//                      crc = ~crc;
+//
+// Credits:
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         v1.0 Oct 2026  - Initial write, replaces the word at a time CRC in utils/simple_utils.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//                  CRC32_SMALL_TABLE     - Use a single 256 entry table and process a byte at a time.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef CRC32_H
+#define CRC32_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+// Constants.
+//
+#define CRC32_POLYNOMIAL                 0xEDB88320                          // Reflected IEEE 802.3 polynomial.
+#define CRC32_INITIAL                    0xFFFFFFFF                          // Register value at the start of a calculation.
+#if defined(CRC32_SMALL_TABLE)
+  #define CRC32_TABLES                   1                                   // Bytewise, one 256 entry table.
+#else
+  #define CRC32_TABLES                   8                                   // Slicing-by-8, eight 256 entry tables.
+#endif
+
+// Prototypes.
+//
+uint32_t                                 crc32_init(void);
+uint32_t                                 crc32_addword(uint32_t, uint32_t);
+uint32_t                                 crc32_update(uint32_t, const void *, uint32_t);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // CRC32_H
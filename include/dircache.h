@@ -0,0 +1,85 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            dircache.h
+// Created:         Oct 2026
+// Version:         v1.0
+// Author(s):       Philip Smart
+// Description:     SD directory cache builder.
+//                  Header for the module which builds the tranZPUter directory cache, mapping SD filenames
+//                  to their Sharp MZF headers, using a persistent index file stored in each directory so
+//                  that only new or changed files need to be opened when the cache is rebuilt.
+//
+// Credits:
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         v1.0 Oct 2026  - Initial write.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef DIRCACHE_H
+#define DIRCACHE_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+// Constants.
+//
+#define DIRCACHE_INDEX_NAME          "TZFSDIR.IDX"                       // Name of the index file held in each cached MZF directory.
+#define DIRCACHE_INDEX_MAGIC         0x5844545A                          // 'TZDX' marker at the start of an index file.
+#define DIRCACHE_INDEX_VERSION       1                                   // Index file layout version, a mismatch forces a full rescan.
+
+// Index file header, followed by one variable length record per cached file.
+//
+typedef struct __attribute__((__packed__)) {
+    uint32_t                         magic;                              // DIRCACHE_INDEX_MAGIC.
+    uint16_t                         version;                            // DIRCACHE_INDEX_VERSION.
+    uint16_t                         entries;                            // Number of records which follow.
+} t_dirIndexHdr;
+
+// Index file record. The SD filename, nameLen bytes without terminator, immediately follows the record.
+//
+typedef struct __attribute__((__packed__)) {
+    uint32_t                         fsize;                              // FAT file size when the header was read.
+    uint16_t                         fdate;                              // FAT modified date when the header was read.
+    uint16_t                         ftime;                              // FAT modified time when the header was read.
+    t_svcCmpDirEnt                   mzfHeader;                          // Compact Sharp header data of the file.
+    uint8_t                          nameLen;                            // Length of the SD filename which follows.
+} t_dirIndexRec;
+
+// Statistics of the last cache build, used to gauge the effectiveness of the index.
+//
+typedef struct {
+    uint16_t                         entries;                            // Files placed in the cache.
+    uint16_t                         reused;                             // MZF headers taken from the index file.
+    uint16_t                         scanned;                            // MZF files opened to read the header.
+    uint8_t                          indexLoaded;                        // An index file was present and valid.
+    uint8_t                          indexWritten;                       // The index file was (re)written.
+    uint32_t                         arenaSize;                          // Bytes allocated to hold the cache.
+} t_dirCacheStats;
+
+// Prototypes.
+//
+FRESULT                              dirCacheBuild(t_dirMap *, const char *, enum FILE_TYPE);
+void                                 dirCacheFree(t_dirMap *);
+uint8_t                              dirCacheBusy(void);
+void                                 dirCacheGetStats(t_dirCacheStats *);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // DIRCACHE_H
@@ -0,0 +1,84 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            dirlist.h
+// Created:         Oct 2026
+// Version:         v1.0
+// Author(s):       Philip Smart
+// Description:     Sorted directory list for the file browser.
+//                  Header for the module which reads a directory into a list held as a single arena of
+//                  packed names with an offset index, kept sorted, directories first, as it is read a page
+//                  at a time so a long directory can be shown before it has been read in full. A typed
+//                  prefix is located with a binary search.
+//
+// Credits:
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         v1.0 Oct 2026  - Initial write.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef DIRLIST_H
+#define DIRLIST_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+// Constants.
+//
+#define DIRLIST_MAX_ENTRIES          4096                                // Maximum number of entries read from a directory.
+#define DIRLIST_PAGE                 32                                  // Entries read per scan step, the first step fills the opening screen.
+#define DIRLIST_ARENA_START          2048                                // Initial size of the name arena, doubled as required.
+#define DIRLIST_INDEX_START          128                                 // Initial number of index entries, doubled as required.
+#define DIRLIST_FILTER_LEN           8                                   // Maximum length of a file filter.
+
+// Index entry, the name is held in the arena so the index stays valid when the arena is moved as it grows.
+//
+typedef struct {
+    uint32_t                         nameOffset;                         // Offset of the NUL terminated name in the arena.
+    uint8_t                          isDir;                              // Entry is a directory.
+} t_dirEntry;
+
+// Directory list. Entries 0..dirs-1 are the directories and dirs..count-1 the files, each run sorted case insensitive.
+//
+typedef struct {
+    char                             *arena;                             // Packed entry names.
+    uint32_t                         arenaSize;                          // Bytes allocated to the arena.
+    uint32_t                         arenaUsed;                          // Bytes of the arena in use.
+    t_dirEntry                       *entries;                           // Sorted index.
+    uint16_t                         capacity;                           // Entries allocated to the index.
+    uint16_t                         count;                              // Entries in the list.
+    uint16_t                         dirs;                               // Directories in the list.
+    uint8_t                          scanning;                           // Directory open, further pages to read.
+    char                             filter[DIRLIST_FILTER_LEN];         // Extension filter, "*.*" for all files.
+    t_dirEntry                       page[DIRLIST_PAGE];                 // Entries of the page being read, sorted before being merged into the index.
+    DIR                              dirFp;                              // Directory being read.
+} t_dirList;
+
+// Prototypes.
+//
+FRESULT                              dirListOpen(t_dirList *, const char *, const char *);
+FRESULT                              dirListScan(t_dirList *, int16_t *);
+void                                 dirListRelease(t_dirList *);
+const char                           *dirListName(t_dirList *, uint16_t);
+uint8_t                              dirListIsDir(t_dirList *, uint16_t);
+int16_t                              dirListFind(t_dirList *, const char *);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // DIRLIST_H
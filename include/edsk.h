@@ -0,0 +1,94 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            edsk.h
+// Created:         Oct 2026
+// Version:         v1.0
+// Author(s):       Philip Smart
+// Description:     Extended CPC DSK (EDSK) floppy image index.
+//                  Header for the module which parses the layout of an EDSK image once, the offset and
+//                  length of every track and the ID and size of every sector listed in each track, into a
+//                  compact index so that a sector request is located without reading the image.
+//
+// Credits:
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         v1.0 Oct 2026  - Initial write, index moved out of emumz.c so it can be built on the host.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef EDSK_H
+#define EDSK_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+// Extended CPC DSK (EDSK) image layout.
+//
+#define EDSK_DIB_TRACKS              0x30                                // Disk Information Block: number of tracks.
+#define EDSK_DIB_SIDES               0x31                                // Disk Information Block: number of sides.
+#define EDSK_DIB_TRACK_SIZES         0x34                                // Disk Information Block: table of track sizes, MSB only, one per track/side.
+#define EDSK_DIB_SIZE                0x100                               // Size of the Disk Information Block.
+#define EDSK_TIB_SECTORS             0x15                                // Track Information Block: number of sectors.
+#define EDSK_TIB_SIL                 0x18                                // Track Information Block: start of the Sector Information List.
+#define EDSK_TIB_SIZE                0x100                               // Size of the Track Information Block, sector data follows.
+#define EDSK_SIL_ENTRY_SIZE          8                                   // Size of a Sector Information List entry.
+#define EDSK_SIL_SECTOR_ID           2                                   // SIL entry: sector ID (R).
+#define EDSK_SIL_SECTOR_SIZE         3                                   // SIL entry: sector size code (N).
+#define EDSK_MAX_TRACKS              (EDSK_DIB_SIZE - EDSK_DIB_TRACK_SIZES) // Maximum track/side entries in the track size table.
+#define EDSK_MAX_SIL_ENTRIES         ((EDSK_TIB_SIZE - EDSK_TIB_SIL) / EDSK_SIL_ENTRY_SIZE) // Maximum sectors which can be described in a TIB.
+
+// Result of locating a sector.
+//
+#define EDSK_OK                      0                                   // Sector located.
+#define EDSK_TRACK_NOT_FOUND         1                                   // Track beyond the image or missing from it.
+#define EDSK_SECTOR_NOT_FOUND        2                                   // Sector ID not listed within the track length.
+
+// Compact index of an EDSK image, built once when the image is mounted. Tracks are indexed by (track * sides) + side
+// as stored in the image.
+//
+typedef struct
+{
+    uint32_t                         offset;                             // Offset of the Track Information Block in the image, 0 = track not present.
+    uint32_t                         length;                             // Length of the track, TIB plus sector data.
+    uint16_t                         firstSector;                        // Index into the sector list of the first sector of this track.
+    uint8_t                          sectors;                            // Number of sectors listed for this track.
+} t_edskTrack;
+
+typedef struct
+{
+    uint8_t                          sectorId;                           // Sector ID (R) as presented to the controller.
+    uint8_t                          sizeCode;                           // Sector size code (N), 0 = 128, 1 = 256, 2 = 512, 3 = 1024.
+} t_edskSector;
+
+typedef struct
+{
+    uint16_t                         noTracks;                           // Number of track/side entries.
+    uint16_t                         noSectors;                          // Number of sectors across all tracks.
+    t_edskTrack                      *track;                             // Track entries, noTracks in size.
+    t_edskSector                     *sector;                            // Sector entries, noSectors in size.
+} t_edskIndex;
+
+// Prototypes.
+//
+t_edskIndex                          *edskBuildIndex(FIL *);
+uint8_t                              edskLocateSector(t_edskIndex *, uint16_t, uint8_t, uint32_t *, uint32_t *);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // EDSK_H
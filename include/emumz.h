@@ -13,6 +13,7 @@
 // Copyright:       (c) 2019-2020 Philip Smart <philip.smart@net2net.org>
 //
 // History:         May 2020 - Initial write of the OSD software.
+//                  Oct 2026 - File list held in a sorted, arena backed directory list.
 //
 // Notes:           See Makefile to enable/disable conditional components
 //
@@ -48,10 +49,11 @@
 #define MENU_CHOICE_WIDTH            20                                  // Maximum width of a choice item.
 #define MAX_MENU_DEPTH               5                                   // Maximum depth of menus.
 #define MAX_MACHINE_TITLE_LEN        15                                  // Maximum length of the side bar machine name title.
-#define MAX_DIRENTRY                 512                                 // Maximum number of read and stored directory entries from the SD card per directory.
 #define MAX_DIR_DEPTH                4                                   // Maximum depth of sub-directories to enter.
 #define MAX_FILENAME_LEN             64                                  // Maximum supported length of a filename.
 #define MAX_FILTER_LEN               8                                   // Maximum length of a file filter.
+#define MAX_KEY_PREFIX               16                                  // Maximum length of a typed file list search prefix.
+#define KEY_PREFIX_TIMEOUT           1000                                // Milliseconds between typed characters before the search prefix restarts.
 #define TOPLEVEL_DIR                 "0:\\"                              // Top level directory for file list and select.
 #define MAX_TAPE_QUEUE               5                                   // Maximum number of files which can be queued in the virtual tape drive.
 #define CONFIG_FILENAME              "0:\\EMZ.CFG"                       // Configuration file for persisting the configuration.
@@ -505,13 +507,6 @@ typedef struct {
     t_menuItem                       *data[MAX_MENU_ROWS];               // Details of a row's data to be displayed such as text.
 } t_menu;
 
-// Structure to maintain a directory entry, wether it is a file or directory entry.
-//
-typedef struct {
-    char                             *name;
-    uint8_t                          isDir;
-} t_dirEntry;
-
 // Structure to hold and manipulate a list of files and directories which are required when the user is requested to select a file.
 //
 typedef struct {
@@ -527,7 +522,9 @@ typedef struct {
     enum FONTS                       font;                               // Font as a type, used in OSD calls.
     const fontStruct                 *rowFontptr;                        // General font used by file list row items.
     int16_t                          activeRow;                          // Active (selected) row. -1 = no selection.
-    t_dirEntry                       dirEntries[MAX_DIRENTRY];           // Scanned directory entries and their properties.
+    t_dirList                        dirList;                            // Scanned directory entries, sorted, directories first.
+    char                             keyPrefix[MAX_KEY_PREFIX+1];        // Characters typed to locate an entry.
+    uint32_t                         keyPrefixTime;                      // Time of the last typed character.
     uint8_t                          selectDir;                          // Flag to indicate if selection is on a path rather than file.
     t_dialogCallback                 returnCallback;                     // A callback activated when a file is selected and control is returned to the Menu state.
     char                             fileFilter[MAX_FILTER_LEN];         // Active filter applied to a directory contents read.
@@ -710,7 +707,7 @@ typedef struct {
 // Structure for traversing and maintaining as set of directory/sub-directories.
 typedef struct {
     char                             *dir[MAX_DIR_DEPTH];                // Entered directory list during user file selection.
-    uint8_t                          activeRow[MAX_DIR_DEPTH];           // Last active row in a given directory.
+    int16_t                          activeRow[MAX_DIR_DEPTH];           // Last active row in a given directory.
     uint8_t                          dirIdx;                             // Ptr to current active directory in file selection.
 } t_activeDir;
 
@@ -1038,6 +1035,7 @@ void       EMZNextMountDrive3(enum ACTIONMODE);
 enum FLOPPYERRORCODES  EMZProcessFDDRequest(uint8_t, uint8_t, uint8_t, uint8_t, uint16_t *, uint16_t *);
 short      EMZCheckFDDImage(char *);
 short      EMZSetFDDImageParams(char *, uint8_t, enum IMAGETYPES);
+short      EMZMapFDDImage(FIL *, uint8_t, char *, enum IMAGETYPES);
 
 void       EMZNextFDDDriveType(enum ACTIONMODE, uint8_t);
 void       EMZNextFDDDriveType0(enum ACTIONMODE);
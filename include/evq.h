@@ -0,0 +1,128 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            evq.h
+// Created:         Oct 2026
+// Version:         v1.1
+// Author(s):       Philip Smart
+// Description:     tranZPUter event queue.
+//                  Header for the module which replaces the polled service loop. The interrupt handlers post
+//                  events (reset, service request, system request, I/O event) with a timestamp, the dispatcher
+//                  runs every pending event in priority order with run to completion handlers and, when idle,
+//                  a slice of a deferred background job. Long operations call evqYield between chunks so events
+//                  which share no resource with the operation are not held up by it. Per event latency, post to
+//                  handler start, is kept as a histogram.
+//
+// Credits:
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         v1.0 Oct 2026  - Initial write.
+//                  v1.1 Oct 2026  - Timer tick event removed, it had no handler. A pending event can
+//                                   be dropped if it was posted before a given time.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef EVQ_H
+#define EVQ_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+// Constants.
+//
+#define EVQ_MAX_JOBS                 4                                   // Background jobs deferred at any one time.
+#define EVQ_HIST_BUCKETS             11                                  // Latency buckets, <4us, <16us ... <1s in powers of 4, then >= 1s.
+#define EVQ_JOB_DONE                 0                                   // Background job return, finished and removed.
+#define EVQ_JOB_MORE                 1                                   // Background job return, call again when idle.
+
+// Resources an event handler, job or yielding operation uses. A pending event is only run from a yield point or
+// beside a job when it uses none of the resources they hold, so handlers need not be re-entrant.
+#define EVQ_USES_Z80BUS              0x01                                // Z80 bus, memory and I/O of the host or tranZPUter.
+#define EVQ_USES_SDCARD              0x02                                // SD card, FatFs is not re-entrant.
+#define EVQ_USES_DIRCACHE            0x04                                // The service directory cache, held whilst it is built.
+#define EVQ_USES_EMU                 0x08                                // Sharp MZ emulation state and the OSD.
+
+// The event timestamp clock, on the K64F the free running core cycle counter which the interrupt handlers read directly.
+#if !defined(EVQ_CLOCK)
+  #define EVQ_CLOCK                  ARM_DWT_CYCCNT
+  #define EVQ_CLOCKS_PER_US          (F_CPU / 1000000)
+#endif
+
+// Events, in priority order, highest first.
+enum EVQ_EVENT {
+    EVQ_RESET                        = 0x00,                             // Z80 reset, from the port D interrupt or requested by a service.
+    EVQ_SVCREQ                       = 0x01,                             // Z80 service request, from the port E interrupt.
+    EVQ_SYSREQ                       = 0x02,                             // Z80 system request.
+    EVQ_IOEVENT                      = 0x03,                             // Z80 I/O operation captured.
+    EVQ_EVENTS                       = 0x04
+};
+
+// Handler and job prototypes. A job does a bounded slice of work per call.
+typedef void                         (*t_evqHandler)(void);
+typedef uint8_t                      (*t_evqJob)(void *);
+
+// Deferred background job.
+typedef struct {
+    t_evqJob                         job;                                // Job, NULL when the slot is free.
+    void                             *ctx;                               // Argument passed to each slice.
+    uint8_t                          uses;                               // Resources used by the job.
+} t_evqJobSlot;
+
+// Per event statistics.
+typedef struct {
+    uint32_t                         count;                              // Events handled.
+    uint32_t                         nested;                             // Events handled at a yield point within a long operation.
+    uint32_t                         maxLatencyUs;                       // Longest post to handler start.
+    uint32_t                         maxRunUs;                           // Longest handler run.
+    uint32_t                         hist[EVQ_HIST_BUCKETS];             // Latency histogram.
+} t_evqStats;
+
+// Event queue control. The posted flags and times are written by the interrupt handlers, a byte store posts an event.
+typedef struct {
+    volatile uint8_t                 posted[EVQ_EVENTS];                 // Event pending, set by the poster and cleared as the handler starts.
+    volatile uint32_t                postedAt[EVQ_EVENTS];               // EVQ_CLOCK when the event was posted.
+    t_evqHandler                     handler[EVQ_EVENTS];                // Run to completion handler, NULL to discard the event.
+    uint8_t                          uses[EVQ_EVENTS];                   // Resources used by the handler.
+    uint8_t                          held;                               // Resources held by running handlers, jobs and yielding operations.
+    uint8_t                          running;                            // Bit per event whose handler is running.
+    uint8_t                          nextJob;                            // Round robin position in the job table.
+    t_evqJobSlot                     jobs[EVQ_MAX_JOBS];                 // Deferred background jobs.
+    uint32_t                         jobSlices;                          // Background job slices run.
+    uint32_t                         yields;                             // Yield points passed.
+    t_evqStats                       stats[EVQ_EVENTS];                  // Per event statistics.
+} t_evqControl;
+
+extern t_evqControl                  evqControl;
+
+// Prototypes.
+//
+void                                 evqInit(void);
+void                                 evqRegister(enum EVQ_EVENT, t_evqHandler, uint8_t);
+void                                 evqPost(enum EVQ_EVENT);
+uint8_t                              evqPending(enum EVQ_EVENT);
+void                                 evqClear(enum EVQ_EVENT);
+uint8_t                              evqClearBefore(enum EVQ_EVENT, uint32_t);
+uint8_t                              evqDefer(t_evqJob, void *, uint8_t);
+uint8_t                              evqDispatch(void);
+uint8_t                              evqYield(uint8_t);
+void                                 evqResetStats(void);
+const char                           *evqName(enum EVQ_EVENT);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // EVQ_H
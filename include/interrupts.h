@@ -9,6 +9,7 @@ extern "C" {
 void SetIntHandler(void(*handler)());
 void EnableInterrupt(uint32_t);
 void DisableInterrupt(uint32_t);
+void UpdateInterruptSetting(uint32_t, uint32_t);
 extern void DisableInterrupts(void);
 extern void EnableInterrupts(void);
 
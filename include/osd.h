@@ -14,6 +14,7 @@
 // Copyright:       (c) 2019-2020 Philip Smart <philip.smart@net2net.org>
 //
 // History:         May 2020 - Initial write of the OSD software.
+//                  Oct 2026 - Glyph cache of pre-rotated fonts for the string blitter.
 //
 // Notes:           See Makefile to enable/disable conditional components
 //
@@ -47,6 +48,10 @@
 #define VC_MENU_RGB_BITS             3                                   // Number of colour bits in the Menu window. (/3 per colour).
 #define VC_STATUS_BUFFER_SIZE        (VC_STATUS_MAX_X_PIXELS * VC_STATUS_MAX_Y_PIXELS) / 8
 #define VC_MENU_BUFFER_SIZE          (VC_MENU_MAX_X_PIXELS * VC_MENU_MAX_Y_PIXELS) / 8
+#if !defined(OSD_GLYPH_SLOTS)
+  #define OSD_GLYPH_SLOTS            2                                   // Fonts held pre-rotated in the glyph cache.
+#endif
+#define OSD_BLIT_CELLS               32                                  // Characters of a string blitted together, row by row.
 #define VC_OSD_X_CORRECTION          1                                   // Correction factor to be applied to horizontal to compensate for pixel multiplication.
 #define VC_OSD_Y_CORRECTION          2                                   // Correction factor to be applied to vertical to compensate for pixel multiplication.
 
@@ -96,9 +101,12 @@
 #define VCADDR_8BIT_VMVGAMODE        VC_8BIT_BASE_ADDR + 0xBF            // Select VGA Output mode. [3:0] - required output resolution/frequency.
 #define VCADDR_8BIT_SYSCTRL          VC_8BIT_BASE_ADDR + 0xF0            // System board control register. [2:0] - 000 MZ80A Mode, 2MHz CPU/Bus, 001 MZ80B Mode, 4MHz CPU/Bus, 010 MZ700 Mode, 3.54MHz CPU/Bus.
 #define VCADDR_8BIT_GRAMMODE         VC_8BIT_BASE_ADDR + 0xF4            // MZ80B Graphics mode.  Bit 0 = 0, Write to Graphics RAM I, Bit 0 = 1, Write to Graphics RAM II. Bit 1 = 1, blend Graphics RAM I output on display, Bit 2 = 1, blend Graphics RAM II output on display.
-#define VCADDR_8BIT_VMPALETTE        VC_8BIT_BASE_ADDR + 0xF5            // Select Palette:
+// The palette register is defined above at 0xB0, as in sharpmz.h, and that definition takes precedence over this one.
+#if !defined(VCADDR_8BIT_VMPALETTE)
+  #define VCADDR_8BIT_VMPALETTE      VC_8BIT_BASE_ADDR + 0xF5            // Select Palette:
                                                                          //    0xF5 sets the palette. The Video Module supports 4 bit per colour output but there is only enough RAM for 1 bit per colour so the pallette is used to change the colours output.
                                                                          //      Bits [7:0] defines the pallete number. This indexes a lookup table which contains the required 4bit output per 1bit input.
+#endif
 
 #define VCADDR_8BIT_KEYPA            VC_8BIT_BASE_ADDR + 0xE000          // VideoModule 8255 Port A
 #define VCADDR_8BIT_KEYPB            VC_8BIT_BASE_ADDR + 0xE001          // VideoModule 8255 Port B
@@ -257,7 +265,7 @@
 #define IO_TZ_VMVGAMODE              0xBF                                // Select VGA Output mode. [3:0] - required output resolution/frequency.
 #define IO_TZ_GDGWF                  0xCC                                // MZ-800      write format register
 #define IO_TZ_GDGRF                  0xCD                                // MZ-800      read format register
-#define IO_TZ_GDCMD                  0xCE                                // MZ-800 CRTC Mode register
+#define IO_TZ_GDCMODE                0xCE                                // MZ-800 CRTC Mode register
 #define IO_TZ_GDCMD                  0xCF                                // MZ-800 CRTC control register
 #define IO_TZ_MMIO0                  0xE0                                // MZ-700/MZ-800 Memory management selection ports.
 #define IO_TZ_MMIO1                  0xE1                                // ""
@@ -305,13 +313,17 @@
 #define CPUMODE_IS_DDD               0x20                                // Place holder to indicate if a future soft CPU is available.
 #define CPUMODE_RESET_CPU            0x80                                // Reset the soft CPU. Active high, when high the CPU is held in RESET, when low the CPU runs.
 #define CPUMODE_IS_SOFT_AVAIL        0x040                               // Marker to indicate if the underlying FPGA can support soft CPU's.
-#define CPUMODE_IS_SOFT_MASK         0x0C0                               // Mask to filter out the Soft CPU availability flags.
+#if !defined(TRANZPUTER_H)
+  #define CPUMODE_IS_SOFT_MASK       0x0C0                               // Mask to filter out the Soft CPU availability flags.
+#endif
 
 // Video Module control bits.
 #define SYSMODE_MZ80A                0x00                                // System board mode MZ80A, 2MHz CPU/Bus.
 #define SYSMODE_MZ80B                0x01                                // System board mode MZ80B, 4MHz CPU/Bus.
 #define SYSMODE_MZ700                0x02                                // System board mode MZ700, 3.54MHz CPU/Bus.
-#define VMMODE_MASK                  0xF8                                // Mask to mask out video mode.
+#if !defined(TRANZPUTER_H)
+  #define VMMODE_MASK                0xF8                                // Mask to mask out video mode.
+#endif
 #define VMMODE_MZ80K                 0x00                                // Video mode = MZ80K
 #define VMMODE_MZ80C                 0x01                                // Video mode = MZ80C
 #define VMMODE_MZ1200                0x02                                // Video mode = MZ1200
@@ -371,14 +383,17 @@
 
 // Sharp MZ constants.
 //
-#define MZ_MROM_ADDR                 0x0000                              // Monitor ROM start address.
-#define MZ_MROM_STACK_ADDR           0x1000                              // Monitor ROM start stack address.
-#define MZ_MROM_STACK_SIZE           0x0200                              // Monitor ROM stack size.
-#define MZ_UROM_ADDR                 0xE800                              // User ROM start address.
-#define MZ_BANKRAM_ADDR              0xF000                              // Floppy API address which is used in TZFS as the paged RAM for additional functionality.
-#define MZ_CMT_ADDR                  0x10F0                              // Address of the CMT (tape) header record.
-#define MZ_CMT_DEFAULT_LOAD_ADDR     0x1200                              // The default load address for a CMT, anything below this is normally illegal.
-#define MZ_VID_RAM_ADDR              0xD000                              // Start of Video RAM
+// The addresses below are also defined by tranzputer.h, its definitions are used when both are included.
+#if !defined(TRANZPUTER_H)
+  #define MZ_MROM_ADDR               0x0000                              // Monitor ROM start address.
+  #define MZ_MROM_STACK_ADDR         0x1000                              // Monitor ROM start stack address.
+  #define MZ_MROM_STACK_SIZE         0x0200                              // Monitor ROM stack size.
+  #define MZ_UROM_ADDR               0xE800                              // User ROM start address.
+  #define MZ_BANKRAM_ADDR            0xF000                              // Floppy API address which is used in TZFS as the paged RAM for additional functionality.
+  #define MZ_CMT_ADDR                0x10F0                              // Address of the CMT (tape) header record.
+  #define MZ_CMT_DEFAULT_LOAD_ADDR   0x1200                              // The default load address for a CMT, anything below this is normally illegal.
+  #define MZ_VID_RAM_ADDR            0xD000                              // Start of Video RAM
+#endif
 #define MZ_VID_RAM_SIZE              2048                                // Size of Video RAM.
 #define MZ_VID_DFLT_BYTE             0x00                                // Default character (SPACE) for video RAM.
 #define MZ_ATTR_RAM_ADDR             0xD800                              // On machines with the upgrade, the start of the Attribute RAM.
@@ -488,6 +503,10 @@
 //
 // Convert big endiam to little endian.
 #define convBigToLittleEndian(num)   ((num>>24)&0xff) | ((num<<8)&0xff0000) | ((num>>8)&0xff00) | ((num<<24)&0xff000000)
+#define markDirty(c,addr)            { \
+                                         if((addr) < osdWindow.dirtyStart[c]) osdWindow.dirtyStart[c] = (addr); \
+                                         if((addr) >= osdWindow.dirtyEnd[c])  osdWindow.dirtyEnd[c]   = (addr)+1; \
+                                     }
 #define setPixel(x,y,colour)         if(y >= 0 && y < osdWindow.params[osdWindow.mode].maxY && x >= 0 && x < osdWindow.params[osdWindow.mode].maxX) \
                                      { \
                                          for(uint8_t c=0; c < (VC_MENU_RGB_BITS > VC_STATUS_RGB_BITS ? VC_MENU_RGB_BITS : VC_STATUS_RGB_BITS); c++) \
@@ -495,6 +514,7 @@
                                              if(colour & (1 << c)) \
                                              { \
                                                  osdWindow.display[c][((y * osdWindow.params[osdWindow.mode].maxX) + x)/8] |= 0x80 >> x%8; \
+                                                 markDirty(c, ((y * osdWindow.params[osdWindow.mode].maxX) + x)/8); \
                                              } \
                                          } \
                                      }
@@ -505,6 +525,7 @@
                                              if(colour & (1 << c)) \
                                              { \
                                                  osdWindow.display[c][((y * osdWindow.params[osdWindow.mode].maxX) + x)/8] &= ~(0x80 >> x%8); \
+                                                 markDirty(c, ((y * osdWindow.params[osdWindow.mode].maxX) + x)/8); \
                                              } \
                                          } \
                                      }
@@ -561,7 +582,11 @@ enum ATTRIBUTES {
 // Public settings, accessed via enumerated value.
 enum OSDPARAMS {
     ACTIVE_MAX_X                     = 0x00,                             // Width in pixels of the active framebuffer.
-    ACTIVE_MAX_Y                     = 0x01                              // Depth in pixels of the active framebuffer.
+    ACTIVE_MAX_Y                     = 0x01,                             // Depth in pixels of the active framebuffer.
+    REFRESH_BYTES                    = 0x02,                             // Bytes sent to the FPGA by the last screen refresh.
+    REFRESH_TOTAL_BYTES              = 0x03,                             // Bytes sent to the FPGA by all screen refreshes.
+    REFRESH_COUNT                    = 0x04,                             // Number of screen refreshes.
+    GLYPH_CACHE_BUILDS               = 0x05                              // Number of fonts rotated into the glyph cache.
 };
 
 // Structure to maintain data relevant to flashing a cursor at a given location.
@@ -621,6 +646,27 @@ typedef struct {
     t_CursorFlash                    cursor;                             // Data for enabling a flashing cursor at a given screen coordinate.
 } t_WindowParams;
 
+// Glyph cache slot, a font pre-rotated to an orientation. Each glyph row is a left justified 16 bit mask of the foreground
+// pixels in framebuffer order so a row of a character is placed with one shift and written a byte at a time.
+typedef struct {
+    fontStruct                       *font;                              // Font the glyphs were built from, NULL when the slot is free.
+    enum ORIENTATION                 orientation;                        // Orientation the glyphs were rotated to.
+    uint8_t                          width;                              // Glyph width and height as placed in the framebuffer.
+    uint8_t                          height;
+    uint8_t                          inkOffset;                          // Pixels between the character start and the first glyph column.
+    uint32_t                         lastUsed;                           // Use sequence number, the lowest is rebuilt first.
+    uint16_t                         *rows;                              // height rows per character, font->start first.
+} t_OSDGlyphCache;
+
+// A character positioned for the blitter.
+typedef struct {
+    uint16_t                         startX;                             // First pixel of the cell including padding.
+    uint16_t                         startY;                             // Row of the first glyph row.
+    uint16_t                         *glyph;                             // Glyph rows in the cache.
+    uint8_t                          fgMask[VC_MENU_RGB_BITS > VC_STATUS_RGB_BITS ? VC_MENU_RGB_BITS : VC_STATUS_RGB_BITS]; // Per plane byte mask of the foreground colour,
+    uint8_t                          bgMask[VC_MENU_RGB_BITS > VC_STATUS_RGB_BITS ? VC_MENU_RGB_BITS : VC_STATUS_RGB_BITS]; // and of the background.
+} t_OSDGlyphCell;
+
 // Structure to maintain the OSD window data.
 typedef struct {
     // Mode in which the OSD is operating.
@@ -635,6 +681,15 @@ typedef struct {
 
     // Framebuffer backing store. Data for display is assembled in this buffer prior to bulk copy into the FPGA memory.
     uint8_t                          (*display)[VC_MENU_BUFFER_SIZE > VC_STATUS_BUFFER_SIZE ? VC_MENU_BUFFER_SIZE : VC_STATUS_BUFFER_SIZE];
+
+    // Dirty span per colour plane, the byte range of the framebuffer changed since the last refresh. A span is clean when start >= end.
+    uint16_t                         dirtyStart[VC_MENU_RGB_BITS > VC_STATUS_RGB_BITS ? VC_MENU_RGB_BITS : VC_STATUS_RGB_BITS];
+    uint16_t                         dirtyEnd[VC_MENU_RGB_BITS > VC_STATUS_RGB_BITS ? VC_MENU_RGB_BITS : VC_STATUS_RGB_BITS];
+
+    // Refresh statistics.
+    uint32_t                         refreshBytes;                       // Bytes sent to the FPGA by the last refresh.
+    uint32_t                         refreshTotalBytes;                  // Bytes sent to the FPGA by all refreshes.
+    uint32_t                         refreshCount;                       // Number of refreshes.
 } t_OSDWindow;
 
 // Application execution constants.
@@ -654,6 +709,8 @@ void       OSDWriteBitmap(uint16_t, uint16_t, enum BITMAPS, enum COLOUR, enum CO
 void       OSDWriteChar(uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, enum FONTS, enum ORIENTATION, char, enum COLOUR, enum COLOUR);
 void       OSDWriteString(uint8_t, uint8_t, int8_t, int8_t, uint8_t, uint8_t, enum FONTS, enum ORIENTATION, char *, uint16_t *, enum COLOUR, enum COLOUR);
 void       OSDUpdateScreenSize(void);
+void       OSDMarkDirtyRows(int16_t, int16_t, uint8_t);
+void       _OSDMarkDirtyAll(void);
 void       OSDRefreshScreen(void);
 void       OSDClearScreen(enum COLOUR);
 void       OSDClearArea(int16_t, int16_t, int16_t, int16_t, enum COLOUR);
@@ -0,0 +1,72 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            readahead.h
+// Created:         Oct 2026
+// Version:         v1.1
+// Author(s):       Philip Smart
+// Description:     Service file read-ahead.
+//                  Header for the double buffered sector reader used by the tranZPUter file read service.
+//                  The sector after the one just returned to the Z80 is fetched into a second buffer while
+//                  the Z80 is busy consuming the first, so a sequential request completes from memory.
+//                  A file region can also be streamed to a sink in sector aligned multi-sector chunks.
+//
+// Credits:
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         v1.0 Oct 2026  - Initial write.
+//                  v1.1 Oct 2026  - Added readAheadStream for bulk loads.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef READAHEAD_H
+#define READAHEAD_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+// Read-ahead state for one open file. Sector numbers are 8 bit to match the service record, a file longer than
+// 256 sectors is read sequentially with the sector number wrapping, exactly as the Z80 issues them.
+//
+typedef struct {
+    FIL                              *file;                              // Open file being read.
+    uint8_t                          buf[TZSVC_SECTOR_SIZE];             // Prefetched sector.
+    UINT                             bufSize;                            // Bytes in the prefetched sector, less than a sector at EOF.
+    uint8_t                          bufSector;                          // Sector number held in buf.
+    uint8_t                          valid;                              // buf holds a prefetched sector.
+    uint8_t                          sequential;                         // Last request followed on from the one before, prefetch is worthwhile.
+    uint8_t                          nextSector;                         // Sector at the current file position.
+    uint32_t                         hits;                               // Requests completed from the prefetch buffer.
+    uint32_t                         misses;                             // Requests read directly from the file.
+    uint32_t                         drops;                              // Prefetched sectors discarded as the request jumped elsewhere.
+} t_readAhead;
+
+// Receiver of a streamed file region, called with each chunk as it is read.
+//
+typedef void                         (*t_readAheadSink)(void *, uint8_t *, UINT);
+
+// Prototypes.
+//
+void                                 readAheadInit(t_readAhead *, FIL *);
+FRESULT                              readAheadRead(t_readAhead *, uint8_t, uint8_t *, UINT *);
+FRESULT                              readAheadFetch(t_readAhead *);
+FRESULT                              readAheadStream(FIL *, uint32_t, uint8_t *, UINT, t_readAheadSink, void *, uint32_t *);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // READAHEAD_H
@@ -0,0 +1,77 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            sfmalloc.h
+// Created:         Oct 2026
+// Version:         v1.0
+// Author(s):       Philip Smart
+// Description:     Segregated fit memory allocator.
+//                  Header for the size class/best fit tree allocator which can be selected in place of
+//                  umm_malloc or the C library malloc when building zOS/ZPUTA.
+//
+// Credits:
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         v1.0 Oct 2026  - Initial write.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef SFMALLOC_H
+#define SFMALLOC_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+// Constants.
+//
+#define SFM_GRAIN                    (2 * sizeof(size_t))                // Block size granularity and payload alignment.
+#define SFM_SMALL_CLASSES            32                                  // Exact size free lists, one per grain from the minimum block size.
+#define SFM_MIN_BLOCK                (2 * SFM_GRAIN)                     // Smallest block, header, two links and the footer.
+#define SFM_SMALL_MAX                ((SFM_SMALL_CLASSES + 1) * SFM_GRAIN) // Largest block held on a size class list, larger blocks go in the tree.
+#define SFM_MAX_REGIONS              8                                   // Number of separate memory regions which can be added to the heap.
+#define SFM_GROW_SIZE                4096                                // Minimum sbrk() request when the heap grows dynamically.
+#define SFM_HIST_BUCKETS             10                                  // Allocation histogram buckets, <=8, <=16 ... <=2048, >2048 bytes.
+
+// Heap statistics, filled in by sfm_stats().
+//
+typedef struct {
+    size_t                           totalBytes;                         // Bytes under management, all regions.
+    size_t                           usedBytes;                          // Bytes in allocated blocks including headers.
+    size_t                           freeBytes;                          // Bytes in free blocks.
+    size_t                           largestFree;                        // Largest free block, the biggest allocation which can currently succeed is this less one word.
+    uint32_t                         usedBlocks;                         // Number of allocated blocks.
+    uint32_t                         freeBlocks;                         // Number of free blocks.
+    uint32_t                         fragmentation;                      // Percentage of free memory not in the largest free block, 0 = unfragmented.
+    uint32_t                         allocations;                        // Successful allocations since initialisation.
+    uint32_t                         failures;                           // Failed allocations since initialisation.
+    uint32_t                         histogram[SFM_HIST_BUCKETS];        // Allocation requests by size.
+} SFM_STATS;
+
+// Prototypes.
+//
+void                                 sfm_init(void);
+int                                  sfm_add(void *, size_t);
+void                                *sfm_malloc(size_t);
+void                                *sfm_calloc(size_t, size_t);
+void                                *sfm_realloc(void *, size_t);
+void                                 sfm_free(void *);
+void                                 sfm_stats(SFM_STATS *);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // SFMALLOC_H
@@ -2,7 +2,7 @@
 //
 // Name:            sharpmz.c
 // Created:         December 2020
-// Version:         v1.0
+// Version:         v1.1
 // Author(s):       Philip Smart
 // Description:     The Sharp MZ library.
 //                  This file contains methods which allow the ZPU to access and control the Sharp MZ
@@ -15,8 +15,10 @@
 // Copyright:       (c) 2019-2020 Philip Smart <philip.smart@net2net.org>
 //
 // History:         v1.0 Dec 2020  - Initial write of the Sharp MZ series hardware interface software.
+//                  v1.1 Oct 2026  - Display backing store held as a ring of rows.
 //
 // Notes:           See Makefile to enable/disable conditional components
+//                  VC_HW_SCROLL          - Scroll the display with the video module hardware scroll registers.
 //
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 // This source file is free software: you can redistribute it and#or modify
@@ -458,7 +460,7 @@
 #define IO_TZ_VMVGAMODE              0xBF                                // Select VGA Output mode. [3:0] - required output resolution/frequency.
 #define IO_TZ_GDGWF                  0xCC                                // MZ-800      write format register
 #define IO_TZ_GDGRF                  0xCD                                // MZ-800      read format register
-#define IO_TZ_GDCMD                  0xCE                                // MZ-800 CRTC Mode register
+#define IO_TZ_GDCMODE                0xCE                                // MZ-800 CRTC Mode register
 #define IO_TZ_GDCMD                  0xCF                                // MZ-800 CRTC control register
 #define IO_TZ_MMIO0                  0xE0                                // MZ-700/MZ-800 Memory management selection ports.
 #define IO_TZ_MMIO1                  0xE1                                // ""
@@ -1007,6 +1009,12 @@ typedef struct {
     uint8_t                          screenCharBuf[VC_DISPLAY_BUFFER_SIZE];
     uint8_t                          screenAttrBuf[VC_DISPLAY_BUFFER_SIZE];
 
+    // The backing store is a ring of maxScreenRow rows, scrolling past the end of the store advances the
+    // head rather than moving the contents.
+    uint8_t                          headRow;                            // Buffer row holding row 0 of the backing store.
+    uint8_t                          vramTop;                            // Buffer row shown on the first row of the physical display, 0xFF once the layout changes.
+    uint8_t                          hwScroll;                           // Hardware scroll setting, start of the display in VRAM in units of 8 bytes.
+
     // Maxims, dynamic to allow for future changes.
     uint8_t                          maxScreenRow;
     uint8_t                          maxDisplayRow;
@@ -12,6 +12,7 @@
 // Copyright:       (c) 2019 Philip Smart <philip.smart@net2net.org>
 //
 // History:         January 2019   - Initial script written.
+//                  Oct 2026       - CRC32 prototypes moved into crc32.h.
 //
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 // This source file is free software: you can redistribute it and#or modify
@@ -40,8 +41,6 @@ void printhexbyte(uint8_t c);
 void printhex(uint32_t c);
 void printdhex(uint32_t c);
 int memoryDump(uint32_t, uint32_t);
-unsigned int crc32_init(void);
-unsigned int crc32_addword(unsigned int, unsigned int);
 unsigned int get_dword(void);
 
 
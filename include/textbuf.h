@@ -0,0 +1,99 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Name:            textbuf.h
+// Created:         Oct 2026
+// Version:         v1.0
+// Author(s):       Philip Smart
+// Description:     Piece table text storage.
+//                  Header for the text buffer used by the kilo and ed editors. The file being edited is not
+//                  loaded, it stays open and is read on demand, edits are appended to an add buffer and the
+//                  text is described by a table of pieces, each a span of the file or of the add buffer.
+//                  The text is addressed by line and column, every line ends with a newline.
+//
+// Credits:
+// Copyright:       (c) 2019-2026 Philip Smart <philip.smart@net2net.org>
+//
+// History:         v1.0 Oct 2026  - Initial write.
+//
+// Notes:           See Makefile to enable/disable conditional components
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This source file is free software: you can redistribute it and#or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This source file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef TEXTBUF_H
+#define TEXTBUF_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+// Constants.
+//
+#define TB_SRC_FILE                      0                                   // Piece is a span of the original file.
+#define TB_SRC_ADD                       1                                   // Piece is a span of the add buffer.
+#define TB_PIECE_LINES                   64                                  // The file is indexed into pieces of at most this many lines, bounding the scan to find a line.
+#define TB_PIECE_CHUNK                   32                                  // Piece table growth step.
+#define TB_ADD_CHUNK                     256                                 // Add buffer growth step.
+#define TB_COPY_SIZE                     128                                 // Stack buffer used when scanning and copying file spans.
+#define TB_TEMP_NAME                     "TBSAVE.TMP"                        // File written on save before replacing the original.
+
+// Result codes, chosen to match the editors own return codes.
+//
+#define TB_OK                            0
+#define TB_NO_MEMORY                     1
+#define TB_IO_ERROR                      2
+
+// A span of text.
+//
+typedef struct {
+    uint32_t                         offset;                             // Offset within the source.
+    uint32_t                         len;                                // Length in bytes.
+    uint32_t                         lines;                              // Newlines within the span.
+    uint8_t                          src;                                // TB_SRC_FILE or TB_SRC_ADD.
+} t_piece;
+
+// Text buffer.
+//
+typedef struct {
+    FIL                              *file;                              // Original file, kept open and read on demand.
+    char                             *name;                              // Name of the original file.
+    t_piece                          *piece;                             // Piece table in text order.
+    uint32_t                         pieces;                             // Pieces in use.
+    uint32_t                         maxPieces;                          // Pieces allocated.
+    char                             *add;                               // Append only buffer of inserted text.
+    uint32_t                         addLen;                             // Bytes used in the add buffer.
+    uint32_t                         addSize;                            // Bytes allocated to the add buffer.
+    uint32_t                         size;                               // Total text size.
+    uint32_t                         lines;                              // Total lines.
+    uint32_t                         hintPiece;                          // Piece last located, searches start here.
+    uint32_t                         hintPos;                            // Text offset of the start of hintPiece.
+    uint32_t                         hintLine;                           // Lines ending before hintPiece.
+    uint32_t                         fileReads;                          // Reads made from the original file.
+} t_textBuf;
+
+// Prototypes.
+//
+void                                 tbInit(t_textBuf *);
+int                                  tbOpen(t_textBuf *, const char *);
+void                                 tbFree(t_textBuf *);
+int                                  tbGetLine(t_textBuf *, uint32_t, char *, int);
+int                                  tbInsert(t_textBuf *, uint32_t, uint32_t, const char *, uint32_t);
+int                                  tbDelete(t_textBuf *, uint32_t, uint32_t, uint32_t);
+int                                  tbJoinLines(t_textBuf *, uint32_t);
+int                                  tbSave(t_textBuf *, const char *, uint32_t *);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // TEXTBUF_H
@@ -11,6 +11,11 @@
 //
 // History:         January 2019   - Initial script written.
 //                  May 2021       - Added memory test tz command.
+//                  Oct 2026       - Added mbench memory function benchmark command.
+//                  Oct 2026       - Added fcrc file checksum command.
+//                  Oct 2026       - Added hus console UART diagnostics command.
+//                  Oct 2026       - Added apps application registry command.
+//                  Oct 2026       - Added bench benchmark runner command.
 //
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 // This source file is free software: you can redistribute it and#or modify
@@ -73,6 +78,7 @@ extern "C" {
 #define CMD_FS_XTRACT              46
 #define CMD_FS_SAVE                47
 #define CMD_FS_EXEC                48
+#define CMD_FS_CRC                 49
 #define CMD_MEM_CLEAR              60              // MEM Commands Range 60 .. 79
 #define CMD_MEM_COPY               61              
 #define CMD_MEM_DIFF               63
@@ -83,6 +89,7 @@ extern "C" {
 #define CMD_MEM_PERF               68
 #define CMD_MEM_SRCH               69
 #define CMD_MEM_TEST               70
+#define CMD_MEM_BENCH              71
 #define CMD_HW_INTR_DISABLE        80              // HW Commands Range 80 .. 99
 #define CMD_HW_INTR_ENABLE         81
 #define CMD_HW_SHOW_REGISTER       82
@@ -90,8 +97,10 @@ extern "C" {
 #define CMD_HW_FIFO_DISABLE        84
 #define CMD_HW_FIFO_ENABLE         85
 #define CMD_HW_TCPU                86
+#define CMD_HW_UART_STATS          87
 #define CMD_TEST_DHRYSTONE        100              // TEST Commands Range 100 .. 119
 #define CMD_TEST_COREMARK         101
+#define CMD_TEST_BENCH            102
 #define CMD_EXECUTE               120              // EXECUTE Commands Range 120 .. 129
 #define CMD_CALL                  121
 #define CMD_MISC_RESTART_APP      130              // MISC Commands Range 130 ..149 
@@ -102,6 +111,8 @@ extern "C" {
 #define CMD_MISC_TEST             135
 #define CMD_MISC_CLS              136              // Clear the console/screen of data.
 #define CMD_MISC_Z80              137              // Exit zOS and return control to host Z80 processor.
+#define CMD_MISC_APPS             138              // List the application registry and launch times.
+#define CMD_MISC_EVENTS           139              // tranZPUter event queue latency statistics.
 #define CMD_APP_TBASIC            140              // TinyBasic
 #define CMD_APP_MBASIC            141              // Mini Basic
 #define CMD_APP_KILO              142              // Kilo Editor
@@ -151,6 +162,11 @@ extern "C" {
 //
 #define SECTOR_SIZE                 512
 
+// Size of each read when loading a file directly into memory. Reads of multiple sectors bypass the FatFS
+// window and are passed to the disk driver as a single multi-block request.
+//
+#define FILE_LOAD_XFER_SIZE         (SECTOR_SIZE * 32)
+
 // Command list.
 //
 typedef struct {
@@ -299,6 +315,9 @@ static t_cmdstruct cmdTable[] = {
     #if (defined(BUILTIN_FS_DUMP) && BUILTIN_FS_DUMP == 1)              || (defined(BUILTIN_MISC_HELP) == 1 && BUILTIN_MISC_HELP == 1)
     { "fdump",      BUILTIN_FS_DUMP,          CMD_FS_DUMP,          CMD_GROUP_FS },
     #endif
+    #if (defined(BUILTIN_FS_CRC) && BUILTIN_FS_CRC == 1)                || (defined(BUILTIN_MISC_HELP) == 1 && BUILTIN_MISC_HELP == 1)
+    { "fcrc",       BUILTIN_FS_CRC,           CMD_FS_CRC,           CMD_GROUP_FS },
+    #endif
    #if FF_FS_RPATH
     #if (defined(BUILTIN_FS_CHANGEDIR) && BUILTIN_FS_CHANGEDIR == 1)    || (defined(BUILTIN_MISC_HELP) == 1 && BUILTIN_MISC_HELP == 1)
     { "fcd",        BUILTIN_FS_CHANGEDIR,     CMD_FS_CHANGEDIR,     CMD_GROUP_FS },
@@ -347,6 +366,9 @@ static t_cmdstruct cmdTable[] = {
     #if (defined(BUILTIN_MEM_TEST) && BUILTIN_MEM_TEST == 1)            || (defined(BUILTIN_MISC_HELP) == 1 && BUILTIN_MISC_HELP == 1)
     { "mtest",      BUILTIN_MEM_TEST,         CMD_MEM_TEST,         CMD_GROUP_MEM },
     #endif
+    #if (defined(BUILTIN_MEM_BENCH) && BUILTIN_MEM_BENCH == 1)          || (defined(BUILTIN_MISC_HELP) == 1 && BUILTIN_MISC_HELP == 1)
+    { "mbench",     BUILTIN_MEM_BENCH,        CMD_MEM_BENCH,        CMD_GROUP_MEM },
+    #endif
     #if (defined(BUILTIN_MEM_EDIT_BYTES) && BUILTIN_MEM_EDIT_BYTES == 1)|| (defined(BUILTIN_MISC_HELP) == 1 && BUILTIN_MISC_HELP == 1)
     { "meb",        BUILTIN_MEM_EDIT_BYTES,   CMD_MEM_EDIT_BYTES,   CMD_GROUP_MEM },
     #endif
@@ -370,6 +392,9 @@ static t_cmdstruct cmdTable[] = {
     #endif
     { "hfd",        BUILTIN_DEFAULT,          CMD_HW_FIFO_DISABLE,  CMD_GROUP_HW },
     { "hfe",        BUILTIN_DEFAULT,          CMD_HW_FIFO_ENABLE,   CMD_GROUP_HW },
+    #if (defined(BUILTIN_HW_UART_STATS) && BUILTIN_HW_UART_STATS == 1)  || (defined(BUILTIN_MISC_HELP) == 1 && BUILTIN_MISC_HELP == 1)
+    { "hus",        BUILTIN_HW_UART_STATS,    CMD_HW_UART_STATS,    CMD_GROUP_HW },
+    #endif
     // Test suite commands.
     #if (defined(BUILTIN_TST_DHRYSTONE) && BUILTIN_TST_DHRYSTONE == 1)  || (defined(BUILTIN_MISC_HELP) == 1 && BUILTIN_MISC_HELP == 1)
     { "dhry",       BUILTIN_TST_DHRYSTONE,    CMD_TEST_DHRYSTONE,   CMD_GROUP_TEST },
@@ -377,6 +402,9 @@ static t_cmdstruct cmdTable[] = {
     #if (defined(BUILTIN_TST_COREMARK) && BUILTIN_TST_COREMARK == 1)    || (defined(BUILTIN_MISC_HELP) == 1 && BUILTIN_MISC_HELP == 1)
     { "coremark",   BUILTIN_TST_COREMARK,     CMD_TEST_COREMARK,    CMD_GROUP_TEST },
     #endif
+    #if (defined(BUILTIN_TST_BENCH) && BUILTIN_TST_BENCH == 1)          || (defined(BUILTIN_MISC_HELP) == 1 && BUILTIN_MISC_HELP == 1)
+    { "bench",      BUILTIN_TST_BENCH,        CMD_TEST_BENCH,       CMD_GROUP_TEST },
+    #endif
     // Execution commands.
     { "call",       BUILTIN_DEFAULT,          CMD_CALL,             CMD_GROUP_EXEC },
     { "jmp",        BUILTIN_DEFAULT,          CMD_EXECUTE,          CMD_GROUP_EXEC },
@@ -393,6 +421,14 @@ static t_cmdstruct cmdTable[] = {
     #if (defined(BUILTIN_MISC_TEST) && BUILTIN_MISC_TEST == 1)    || (defined(BUILTIN_MISC_HELP) == 1 && BUILTIN_MISC_HELP == 1)
     { "test",       BUILTIN_MISC_TEST,        CMD_MISC_TEST,        CMD_GROUP_MISC },
     #endif
+    #if (defined(BUILTIN_MISC_APPS) && BUILTIN_MISC_APPS == 1)    || (defined(BUILTIN_MISC_HELP) == 1 && BUILTIN_MISC_HELP == 1)
+    { "apps",       BUILTIN_MISC_APPS,        CMD_MISC_APPS,        CMD_GROUP_MISC },
+    #endif
+  #if defined __TRANZPUTER__
+    #if (defined(BUILTIN_MISC_EVENTS) && BUILTIN_MISC_EVENTS == 1)    || (defined(BUILTIN_MISC_HELP) == 1 && BUILTIN_MISC_HELP == 1)
+    { "events",     BUILTIN_MISC_EVENTS,      CMD_MISC_EVENTS,      CMD_GROUP_MISC },
+    #endif
+  #endif
   #if defined __SHARPMZ__
     #if (defined(BUILTIN_MISC_CLS) && BUILTIN_MISC_CLS == 1)    || (defined(BUILTIN_MISC_HELP) == 1 && BUILTIN_MISC_HELP == 1)
     { "cls",        BUILTIN_DEFAULT,          CMD_MISC_CLS,         CMD_GROUP_MISC },
@@ -442,7 +478,7 @@ static t_helpstruct helpTable[] = {
     { CMD_FS_INIT,          "<ld#> [<mount>]",                    "Force init the volume" },
     { CMD_FS_OPEN,          "<mode> <file>",                      "Open a file" },
     { CMD_FS_CLOSE,         "",                                   "Close the file" },
-    { CMD_FS_SEEK,          "<ofs>",                              "Move fp in normal seek" },
+    { CMD_FS_SEEK,          "<ofs> | b [<cnt>]",                  "Move fp or benchmark random seeks" },
     { CMD_FS_READ,          "<len>",                              "Read part of file into buffer" },
     { CMD_FS_INSPECT,       "<len>",                              "Read part of file and examine" },
     { CMD_FS_WRITE,         "<len> <val>",                        "Write part of buffer into file" },
@@ -464,6 +500,7 @@ static t_helpstruct helpTable[] = {
     { CMD_FS_EXEC,          "<name> <ldAddr> <xAddr> <mode>",     "Load and execute file" },
     { CMD_FS_SAVE,          "<name> <addr> <len>",                "Save memory range to a file" },
     { CMD_FS_DUMP,          "<name> [<width>]",                   "Dump a file contents as hex" },
+    { CMD_FS_CRC,           "<name> [<name> ...]",                "CRC32 checksum of files" },
    #if FF_FS_RPATH
     { CMD_FS_CHANGEDIR,     "<path>",                             "Change current directory" },
     #if FF_VOLUMES >= 2
@@ -491,6 +528,7 @@ static t_helpstruct helpTable[] = {
     { CMD_MEM_PERF,         "<start> <end> [<width>] [<xfersz>]", "Test performance" },
     { CMD_MEM_SRCH,         "<start> <end> <value>",              "Search memory for value" },
     { CMD_MEM_TEST,         "[<start> [<end>] [iter] [tests]]",   "Test memory" },
+    { CMD_MEM_BENCH,        "<start> [<kb>]",                     "Benchmark mem functions" },
     // Hardware commands.
     { CMD_HW_INTR_DISABLE,  "",                                   "Disable Interrupts" },
     { CMD_HW_INTR_ENABLE,   "",                                   "Enable Interrupts" },
@@ -499,9 +537,11 @@ static t_helpstruct helpTable[] = {
     { CMD_HW_FIFO_DISABLE,  "",                                   "Disable UART FIFO" },
     { CMD_HW_FIFO_ENABLE,   "",                                   "Enable UART FIFO" },
     { CMD_HW_TCPU,          "",                                   "TranZPUter test progra" },
+    { CMD_HW_UART_STATS,    "[<kb>]",                             "UART statistics, send kb to time" },
     // Test suite commands.
     { CMD_TEST_DHRYSTONE,   "",                                   "Dhrystone Test v2.1" },
     { CMD_TEST_COREMARK,    "",                                   "CoreMark Test v1.0" },
+    { CMD_TEST_BENCH,       "[<mask> [<fmt> [<start> <end>]]]",   "Benchmarks, CSV/JSON results" },
     // Execution commands.
     { CMD_CALL,             "<addr>",                             "Call function @ <addr>" },
     { CMD_EXECUTE,          "<addr>",                             "Execute code @ <addr>" },
@@ -512,6 +552,8 @@ static t_helpstruct helpTable[] = {
     { CMD_MISC_INFO,        "",                                   "Config info" },
     { CMD_MISC_SETTIME,     "[<y> <m> <d> <h> <M> <s>]",          "Set/Show current time" },
     { CMD_MISC_TEST,        "",                                   "Debugging aid." },
+    { CMD_MISC_APPS,        "[r]",                                "List apps, r rescans bin" },
+    { CMD_MISC_EVENTS,      "[r]",                                "Event latency, r resets" },
   #if defined __SHARPMZ__
    #if (defined(BUILTIN_MISC_CLS) && BUILTIN_MISC_CLS == 1)    || (defined(BUILTIN_MISC_HELP) == 1 && BUILTIN_MISC_HELP == 1)
     { CMD_MISC_CLS,         "",                                   "Clear Screen" },
@@ -592,6 +634,21 @@ void printVersion(uint8_t);
 #if (defined(BUILTIN_FS_DUMP) && BUILTIN_FS_DUMP == 1) || (defined(BUILTIN_FS_INSPECT) && BUILTIN_FS_INSPECT == 1) || (defined(BUILTIN_DISK_DUMP) && BUILTIN_DISK_DUMP == 1) || (defined(BUILTIN_DISK_STATUS) && BUILTIN_DISK_STATUS == 1) || (defined(BUILTIN_BUFFER_DUMP) && BUILTIN_BUFFER_DUMP == 1) || (defined(BUILTIN_MEM_DUMP) && BUILTIN_MEM_DUMP == 1)
 int           memoryDump(uint32_t, uint32_t, uint32_t, uint32_t, uint8_t);
 #endif
+#if defined(BUILTIN_HW_UART_STATS) && BUILTIN_HW_UART_STATS == 1
+void          uartDiagnostics(uint32_t);
+#endif
+#if defined(BUILTIN_FS_EXEC) && BUILTIN_FS_EXEC == 1
+uint32_t      memExec(uint32_t, uint8_t, uint32_t, uint32_t, uint32_t, uint32_t);
+#endif
+#if defined(BUILTIN_MISC_APPS) && BUILTIN_MISC_APPS == 1
+void          printAppRegistry(uint8_t);
+#endif
+#if defined(BUILTIN_MISC_EVENTS) && BUILTIN_MISC_EVENTS == 1
+void          printEventStats(uint8_t);
+#endif
+#if defined(__SFMALLOC__)
+void          printHeapInfo(void);
+#endif
 
 #ifdef __cplusplus
 }
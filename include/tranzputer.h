@@ -12,6 +12,9 @@
 //                  Jul 2020 - Updates to accommodate v2.1 of the tranZPUter board.
 //                  Sep 2020 - Updates to accommodate v2.2 of the tranZPUter board.
 //                  May 2021 - Changes to use 512K-1Mbyte Z80 Static RAM, build time configurable.
+//                  Oct 2026 - Directory cache held in a single arena allocation.
+//                  Oct 2026 - Read-ahead request for the file read service.
+//                  Oct 2026 - Buffer size for streamed loads into Z80 memory.
 //
 // Notes:           See Makefile to enable/disable conditional components
 //
@@ -40,12 +43,36 @@
 //
 #define REFRESH_BYTE_COUNT           8                                   // This constant controls the number of bytes read/written to the z80 bus before a refresh cycle is needed.
 #define RFSH_BYTE_CNT                256                                 // Number of bytes we can write before needing a full refresh for the DRAM.
+#define TZ_LOAD_BUF_SIZE             4096                                // Bytes read from the SD card at a time when loading a file into Z80 memory, a multiple of the sector size.
 #define HOST_MON_TEST_VECTOR         0x4                                 // Address in the host monitor to test to identify host type.
 #define DEFAULT_BUSREQ_TIMEOUT       5000                                // Timeout for a Z80 Bus request operation in milliseconds.
 #define DEFAULT_RESET_PULSE_WIDTH    500000                              // Pulse width of a reset signal in K64F clock ticks.
 #define TZFS_AUTOBOOT_FLAG           "0:\\TZFSBOOT.FLG"                  // Filename used as a flag, if this file exists in the SD root directory then TZFS is booted automatically.
 #define TZ_MAX_Z80_MEM               0x100000                            // Maximum Z80 memory available on the tranZPUter board.
 #define TZ_MAX_FPGA_MEM              0x1000000                           // Maximum addressable memory area inside the FPGA.
+#define TZ_BURST_DEFAULT             1                                   // Enable (1) the block transfer engine for the array/copy methods at startup, 0 = byte at a time bus cycles.
+#define TZ_CLMT_PROBE_SIZE           32                                  // Size in DWORDS of the stack table used to probe the cluster link map size of a disk image, covers 15 fragments.
+#define TZ_CLMT_MAX_SIZE             1024                                // Maximum size in DWORDS of a heap allocated cluster link map, images more fragmented than this use normal seek.
+
+// Block transfer engine timing profiles. Delay loop counts for each phase of a bus cycle per target, these mirror the pulse widths of the
+// single byte read/write methods.
+//
+#define TZ_BURST_FPGA_SETUP          3                                   // FPGA: Address/data setup time before MREQ.
+#define TZ_BURST_FPGA_MREQ           5                                   // FPGA: MREQ to WR.
+#define TZ_BURST_FPGA_WR             5                                   // FPGA: WR pulse width.
+#define TZ_BURST_TZPU_SETUP          3                                   // tranZPUter: Address/data setup time before MREQ.
+#define TZ_BURST_TZPU_MREQ           3                                   // tranZPUter: MREQ to WR.
+#define TZ_BURST_TZPU_WR             3                                   // tranZPUter: WR pulse width.
+#define TZ_BURST_TZPU_RD             7                                   // tranZPUter/FPGA: MREQ/RD to data valid.
+#define TZ_BURST_MB_SETUP            3                                   // Mainboard: Address/data setup time before MREQ.
+#define TZ_BURST_MB_MREQ             3                                   // Mainboard: MREQ to WR.
+#define TZ_BURST_MB_WR               4                                   // Mainboard: WR pulse width, 760nS on a 120MHz K64F.
+#define TZ_BURST_MB_RD               7                                   // Mainboard: MREQ/RD to data valid, WAIT is observed after this period.
+
+// Bus cycle delay, the given count of volatile loop iterations. Used for every pulse width of the single byte methods and the block transfer
+// engine so both are timed by the same loop.
+//
+#define z80BusDelay(a)               { for(volatile uint32_t pulseWidth = 0; pulseWidth < (a); pulseWidth++); }
 
 // tranZPUter Memory Modes - select one of the 32 possible memory models using these constants.
 //
@@ -122,7 +149,7 @@
 #define IO_TZ_VMVGAMODE              0xBF                                // Select VGA Output mode, ie. Internal, 640x480 etc. Bits [3:0] specify required mode. Undefined default to internal standard frequency.
 #define IO_TZ_GDGWF                  0xCC                                // MZ-800      write format register
 #define IO_TZ_GDGRF                  0xCD                                // MZ-800      read format register
-#define IO_TZ_GDCMD                  0xCE                                // MZ-800 CRTC Mode register
+#define IO_TZ_GDCMODE                0xCE                                // MZ-800 CRTC Mode register
 #define IO_TZ_GDCMD                  0xCF                                // MZ-800 CRTC control register
 #define IO_TZ_MMIO0                  0xE0                                // MZ-700/MZ-800 Memory management selection ports.
 #define IO_TZ_MMIO1                  0xE1                                // ""
@@ -409,6 +436,7 @@
 #define TZSVC_OPEN                   0x00                                // Service request to open a directory or file.
 #define TZSVC_NEXT                   0x01                                // Service request to return the next directory block or file block or write the next file block.
 #define TZSVC_CLOSE                  0x02                                // Service request to close open dir/file.
+#define TZSVC_PREFETCH               0x03                                // Service request to fetch the next file block ahead of the Z80 requesting it.
 
 
 // Constants for the Sharp MZ80A MZF file format.
@@ -781,6 +809,7 @@ typedef struct __attribute__((__packed__)) {
         t_sharpToSDMap               *mzfFile[TZSVC_MAX_DIR_ENTRIES];    // File mapping of SD file to its Sharp MZ80A name.
         uint8_t                      *sdFileName[TZSVC_MAX_DIR_ENTRIES]; // No mapping for SD filenames, just the file name.
     };
+    void                             *arena;                             // Single allocation holding the map records and filenames pointed to above.
 } t_dirMap;
 
 
@@ -826,15 +855,16 @@ typedef struct {
     t_mz700                          mz700;                              // MZ700 emulation control to detect IO commands and adjust the memory map accordingly.
     t_mz80b                          mz80b;                              // MZ-80B emulation control to detect IO commands and adjust the memory map and I/O forwarding accordingly.
 
-    uint8_t                          resetEvent;                         // A Z80_RESET event occurred, probably user pressing RESET button.
-    uint8_t                          svcRequest;                         // A service request has been made by the Z80 (1).
-    uint8_t                          sysRequest;                         // A system request has been made by the Z80 (1).
+    uint8_t                          resetEvent;                         // Unused, Z80_RESET events are posted to the event queue (evq.h). Kept for structure layout.
+    uint8_t                          svcRequest;                         // Unused, service requests are posted to the event queue. Kept for structure layout.
+    uint8_t                          sysRequest;                         // Unused, system requests are posted to the event queue. Kept for structure layout.
     uint8_t                          ioAddr;                             // Address of a Z80 IO instruction.
     uint8_t                          ioEvent;                            // Event flag to indicate that an IO instruction was captured.
     uint8_t                          ioData;                             // Data of a Z80 IO instruction.
     uint8_t                          memorySwap;                         // A memory Swap event has occurred, 0000-0FFF -> C000-CFFF (1), or C000-CFFF -> 0000-0FFF (0)
     uint8_t                          crtMode;                            // A CRT event has occurred, Normal mode (0) or Reverse Mode (1)
     uint8_t                          scroll;                             // Hardware scroll offset.
+    uint8_t                          burstMode;                          // Block transfer engine enabled (1) for array/copy methods or byte at a time bus cycles (0).
     volatile uint32_t                portA;                              // ISR store of GPIO Port A used for signal decoding.
     volatile uint32_t                portB;                              // ISR store of GPIO Port B used for signal decoding.
     volatile uint32_t                portC;                              // ISR store of GPIO Port C used for signal decoding.
@@ -984,6 +1014,7 @@ uint8_t                               isZ80Reset(void);
 uint8_t                               isZ80MemorySwapped(void);
 uint8_t                               getZ80IO(uint8_t *);
 void                                  clearZ80Reset(void);
+uint8_t                               setZ80BurstMode(uint8_t);
 void                                  convertSharpFilenameToAscii(char *, char *, uint8_t);
 void                                  convertToFAT32FileNameFormat(char *);
 
@@ -995,12 +1026,17 @@ uint8_t                               svcFindFile(char *, char *, uint8_t, enum
 uint8_t                               svcReadDirCache(uint8_t, enum FILE_TYPE);
 uint8_t                               svcFindFileCache(char *, char *, uint8_t, enum FILE_TYPE);
 uint8_t                               svcCacheDir(const char *, enum FILE_TYPE, uint8_t);
+void                                  svcCacheDirDefer(const char *, enum FILE_TYPE);
 uint8_t                               svcReadFile(uint8_t, enum FILE_TYPE);
 uint8_t                               svcWriteFile(uint8_t, enum FILE_TYPE);
 uint8_t                               svcLoadFile(enum FILE_TYPE);
 uint8_t                               svcSaveFile(enum FILE_TYPE);
 uint8_t                               svcEraseFile(enum FILE_TYPE);
 uint8_t                               svcAddCPMDrive(void);
+#if FF_USE_FASTSEEK == 1
+FRESULT                               createFastSeekMap(FIL *);
+void                                  releaseFastSeekMap(FIL *);
+#endif
 uint8_t                               svcReadCPMDrive(void);
 uint8_t                               svcWriteCPMDrive(void);
 uint32_t                              getServiceAddr(void);
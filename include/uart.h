@@ -7,6 +7,25 @@
 extern "C" {
 #endif
 
+// Interrupt driven UART0 console rings, enabled with UART_RINGS. The sizes must be a power of 2.
+#if !defined(UART_TX_RING_SIZE)
+  #define UART_TX_RING_SIZE 1024
+#endif
+#if !defined(UART_RX_RING_SIZE)
+  #define UART_RX_RING_SIZE 256
+#endif
+
+// Console UART statistics.
+typedef struct {
+    uint32_t txBytes;                                // Bytes sent.
+    uint32_t rxBytes;                                // Bytes received.
+    uint32_t txOverrun;                              // Writes which found the TX ring full and waited or were refused.
+    uint32_t txUnderrun;                             // Times the line went idle with bytes still waiting in the TX ring.
+    uint32_t rxOverrun;                              // Received bytes lost, RX ring full or UART overrun.
+    uint16_t txPeak;                                 // Highest TX ring usage.
+    uint16_t rxPeak;                                 // Highest RX ring usage.
+} t_uartStats;
+
 // Method to direct output to stdout or stddebug.
 void set_serial_output(uint8_t);
 
@@ -18,10 +37,17 @@ char   getserial();
 char   getdbgserial();
 int8_t getserial_nonblocking();
 int8_t getdbgserial_nonblocking();
+int    uart_write_nb(const char *, int);
+int    uart_tx_free(void);
+int    uart_rx_avail(void);
+void   uart_flush(void);
+void   uart_service(void);
+void   uart_get_stats(t_uartStats *, uint8_t);
 
 // Only bring in stream functions for stdio.h
 #if !defined(FUNCTIONALITY)
 int    uart_putchar(char, FILE *);
+int    uart_write(const char *, int, FILE *);
 int    uart_getchar(FILE *);
 #endif
 
@@ -12,6 +12,7 @@
 // Copyright:       (c) 2019 Philip Smart <philip.smart@net2net.org>
 //
 // History:         January 2019   - Initial script written.
+//                  Oct 2026       - CRC32 prototypes moved into crc32.h.
 //
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 // This source file is free software: you can redistribute it and#or modify
@@ -51,8 +52,6 @@ void          printnibble(uint8_t c);
 void          printhexbyte(uint8_t c);
 void          printhex(uint32_t c);
 void          printdhex(uint32_t c);
-unsigned int  crc32_init(void);
-unsigned int  crc32_addword(unsigned int, unsigned int);
 unsigned int  get_dword(void);
 char         *getStrParam(char **);
 uint32_t      getUintParam(char **ptr);
@@ -16,6 +16,11 @@
 // History:         January 2019   - Initial script written.
 //                  July 2019      - Stripped down to the bare minimum, all other functionality moved
 //                                   into the testapp.
+//                  Oct 2026       - Upload CRC calculated over the received image with crc32_update rather
+//                                   than a word at a time in the receive loop, fixed the store address
+//                                   which only advanced by a byte per word.
+//                  Oct 2026       - Block framed upload with per block CRC, acknowledgement window and
+//                                   selective retransmit, selected by the start sequence IOCB.
 //
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 // This source file is free software: you can redistribute it and#or modify
@@ -41,11 +46,13 @@
 #include "diskio.h"
 #include <string.h>
 #include "simple_utils.h"
+#include "crc32.h"
+#include "blkupload.h"
 #include "iocp.h"
 
 // Version info.
-#define VERSION      "v1.5"
-#define VERSION_DATE "29/08/2019"
+#define VERSION      "v1.7"
+#define VERSION_DATE "16/10/2026"
 
 // Method to process interrupts. This involves reading the interrupt status register and then calling
 // the handlers for each triggered interrupt. A read of the interrupt controller clears the interrupt pending
@@ -81,12 +88,15 @@ void enableTimer()
 #endif
 
 #if !defined(FUNCTIONALITY) || FUNCTIONALITY == 0
-// Function to upload an application into memory from the serial channel in binary.
+// Function to upload an application into memory from the serial channel in binary. The start sequence
+// selects the protocol, IOCP streams the image with a single CRC, IOCB sends it in acknowledged blocks
+// (see blkupload.h).
 //
 int uploadToMemory(uint32_t memAddr, uint32_t memSize)
 {
     // Locals.
     uint8_t   resultCode = 1;
+    char      protocol   = 0;
 
     // Indicate mode selected and instructions to start upload.
     //
@@ -104,10 +114,24 @@ int uploadToMemory(uint32_t memAddr, uint32_t memSize)
         if(getserial() == 'I')
             if(getserial() == 'O')
                 if(getserial() == 'C')
-                    if(getserial() == 'P')
+                {
+                    protocol = getserial();
+                    if(protocol == 'P' || protocol == 'B')
                     {
                         start_seq = 1;
                     }
+                }
+    }
+
+    // Block protocol, the image is checked block by block as it is stored.
+    //
+    if(protocol == 'B')
+    {
+        resultCode = blkUpload(memAddr, memSize - 8, NULL);
+        OPTIONAL(dbg_puts("Block upload result="));
+        OPTIONAL(dbg_printdhex(resultCode));
+        OPTIONAL(dbg_puts("\n"));
+        return(resultCode != BLK_OK);
     }
 
     // Get size of image and validate.
@@ -122,20 +146,19 @@ int uploadToMemory(uint32_t memAddr, uint32_t memSize)
         //
         uint32_t crcSrc = get_dword();
 
-        // Read in image_size words and store.
+        // Read in image_size words and store, the receive loop is kept tight so the UART FIFO is emptied
+        // at the line rate and the CRC is calculated over the stored image afterwards. The ZPU is big endian
+        // so the stored bytes are in the order the words were sent.
         //
         uint32_t data_pointer = memAddr;
         uint32_t count = image_size;
-        uint32_t word;
         while(count > 0)
         {
-            word = get_dword();
-            *(uint32_t *)data_pointer = word;
-            crcDst = crc32_addword(crcDst, word);
-            data_pointer = data_pointer + 1;
+            *(uint32_t *)data_pointer = get_dword();
+            data_pointer = data_pointer + 4;
             count-=4;
         }
-        crcDst = ~crcDst;
+        crcDst = ~crc32_update(crcDst, (uint8_t *)memAddr, image_size);
  
         // Short delay to allow uploader to terminate.
         //
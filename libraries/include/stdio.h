@@ -245,7 +245,7 @@
 struct __file {
 	char	*buf;		/* buffer pointer */
 	unsigned char unget;	/* ungetc() buffer */
-	uint8_t	flags;		/* flags, see below */
+	uint16_t flags;		/* flags, see below */
 #define __SRD	0x0001		/* OK to read */
 #define __SWR	0x0002		/* OK to write */
 #define __SSTR	0x0004		/* this is an sprintf/snprintf string */
@@ -254,18 +254,20 @@ struct __file {
 #define __SEOF	0x0020		/* found EOF */
 #define __SUNGET 0x040		/* ungetc() happened */
 #define __SMALLOC 0x80		/* handle is malloc()ed */
-#if 0
-/* possible future extensions, will require uint16_t flags */
 #define __SRW	0x0100		/* open for reading & writing */
 #define __SLBF	0x0200		/* line buffered */
 #define __SNBF	0x0400		/* unbuffered */
-#define __SMBF	0x0800		/* buf is from malloc */
-#endif
+#define __SMBF	0x0800		/* obuf is from malloc */
 	int	size;		/* size of buffer */
 	int	len;		/* characters read or written so far */
 	int	(*put)(char, struct __file *);	/* function to write one char to device */
 	int	(*get)(struct __file *);	/* function to read one char from device */
 	void	*udata;		/* User defined and accessible data. */
+	int	(*write)(const char *, int, struct __file *);	/* optional function to write a block to device */
+	int	(*read)(char *, int, struct __file *);	/* optional function to read a block from device */
+	char	*obuf;		/* output buffer, NULL when unbuffered */
+	int	osize;		/* size of output buffer */
+	int	olen;		/* characters waiting in output buffer */
 };
 
 #endif /* not __DOXYGEN__ */
@@ -354,9 +356,32 @@ struct __file {
 		(stream)->get = g; \
 		(stream)->flags = f; \
 		(stream)->udata = 0; \
+		(stream)->write = 0; \
+		(stream)->read = 0; \
+		(stream)->obuf = 0; \
+		(stream)->osize = 0; \
+		(stream)->olen = 0; \
 	} while(0)
 #endif /* DOXYGEN */
 
+/**
+   Attach block level device functions to a stream set up with
+   fdev_setup_stream() or FDEV_SETUP_STREAM().
+
+   \c w is called as <tt>w(buf, len, stream)</tt> to send \c len
+   characters in one call and returns 0 on success, like \c put().
+   \c r is called as <tt>r(buf, len, stream)</tt> and returns the
+   number of characters read, or _FDEV_ERR/_FDEV_EOF.  Either may be
+   NULL, the per character function is then used.  fwrite(), fputs(),
+   puts(), the literal text of vfprintf() and flushing of a buffered
+   stream use \c w, fread() uses \c r.
+*/
+#define fdev_set_block(stream, w, r) \
+	do { \
+		(stream)->write = w; \
+		(stream)->read = r; \
+	} while(0)
+
 #define _FDEV_SETUP_READ  __SRD	/**< fdev_setup_stream() with read intent */
 #define _FDEV_SETUP_WRITE __SWR	/**< fdev_setup_stream() with write intent */
 #define _FDEV_SETUP_RW    (__SRD|__SWR)	/**< fdev_setup_stream() with read/write intent */
@@ -1060,21 +1085,36 @@ extern int	sscanf(const char *__buf, const char *__fmt, ...);
  */
 extern int	sscanf_P(const char *__buf, const char *__fmt, ...);
 
-#if defined(__DOXYGEN__)
 /**
-   Flush \c stream.
+   Flush \c stream, sending any characters waiting in its output
+   buffer to the device.  A NULL \c stream flushes \c stdout and
+   \c stderr.  Unbuffered streams are unaffected.
 
-   This is a null operation provided for source-code compatibility
-   only, as the standard IO implementation currently does not perform
-   any buffering.
+   Returns 0, or \c EOF if the device reported an error.
  */
 extern int	fflush(FILE *stream);
-#else
-static __inline__ int fflush(FILE *stream __attribute__((unused)))
-{
-	return 0;
-}
-#endif
+
+/**
+   Set the buffering of \c stream.  \c mode is one of _IOFBF (full
+   buffering, the buffer is sent when full or flushed), _IOLBF (line
+   buffering, also sent at each newline) or _IONBF (unbuffered, the
+   default for a stream set up with fdev_setup_stream()).  If \c buf
+   is NULL a buffer of \c size bytes, BUFSIZ if 0, is allocated with
+   malloc() and released by fclose() or the next setvbuf().
+
+   Buffered output on \c stdout and \c stderr is flushed before a
+   character is read from a device so that prompts appear.
+
+   Returns 0, or \c EOF if the mode is invalid or no memory is
+   available.
+ */
+extern int	setvbuf(FILE *__stream, char *__buf, int __mode, size_t __size);
+
+/**
+   Equivalent to setvbuf() with _IOFBF and BUFSIZ, or _IONBF if
+   \c buf is NULL.
+ */
+extern void	setbuf(FILE *__stream, char *__buf);
 
 #ifdef __cplusplus
 }
@@ -1091,6 +1131,14 @@ static __inline__ int fflush(FILE *stream __attribute__((unused)))
 #define SEEK_CUR 1
 #define SEEK_END 2
 
+/* Buffering modes for setvbuf(). */
+#define _IOFBF	0		/* full buffering */
+#define _IOLBF	1		/* line buffering */
+#define _IONBF	2		/* no buffering */
+
+/* Default buffer size for setvbuf() and setbuf(). */
+#define BUFSIZ	128
+
 #endif /* __ASSEMBLER */
 
 #endif /* _STDLIB_H_ */
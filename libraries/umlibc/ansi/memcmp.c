@@ -5,12 +5,41 @@
 /* $Id: memcmp.c,v 1.1.1.1 2005/04/21 14:56:05 beng Exp $ */
 
 #include	<string.h>
+#include	<stdint.h>
 
+/* Compares of less than this many bytes are not worth aligning. */
+#define	WORDCMP_MIN	16
+
+/*
+ * Equal words are skipped a word at a time when both buffers share the same
+ * alignment, the first differing word is then resolved bytewise so the result
+ * does not depend on the byte order of the target.
+ */
 int
 memcmp(const void *s1, const void *s2, size_t n)
 {
 	register const unsigned char *p1 = s1, *p2 = s2;
 
+	if (n >= WORDCMP_MIN && (((uintptr_t)p1 ^ (uintptr_t)p2) & 3) == 0) {
+		register const uint32_t *w1, *w2;
+
+		while (((uintptr_t)p1 & 3) != 0) {
+			if (*p1 != *p2)
+				return *p1 - *p2;
+			p1++;
+			p2++;
+			n--;
+		}
+		w1 = (const uint32_t *)p1;
+		w2 = (const uint32_t *)p2;
+		while (n >= 4 && *w1 == *w2) {
+			w1++;
+			w2++;
+			n -= 4;
+		}
+		p1 = (const unsigned char *)w1;
+		p2 = (const unsigned char *)w2;
+	}
 	if (n) {
 		n++;
 		while (--n > 0) {
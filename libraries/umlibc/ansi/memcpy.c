@@ -5,19 +5,53 @@
 /* $Header: /cvsup/minix/src/lib/ansi/memcpy.c,v 1.1.1.1 2005/04/21 14:56:05 beng Exp $ */
 
 #include	<string.h>
+#include	<stdint.h>
 
+/* Copies of less than this many bytes are not worth aligning. */
+#define	WORDCPY_MIN	16
+
+/*
+ * Word at a time copy. When source and destination share the same alignment
+ * the head is copied bytewise up to a word boundary, the bulk is moved 4 words
+ * per iteration and the tail is finished bytewise. Mismatched alignment falls
+ * back to a byte copy as the ZPU and 68000 cannot issue unaligned word accesses.
+ * The K64F build uses teensy3/memcpy-armv7m.S instead of this module.
+ */
 void *
 memcpy(void *s1, const void *s2, register size_t n)
 {
 	register char *p1 = s1;
 	register const char *p2 = s2;
 
+	if (n >= WORDCPY_MIN && (((uintptr_t)p1 ^ (uintptr_t)p2) & 3) == 0) {
+		register uint32_t *w1;
+		register const uint32_t *w2;
 
-	if (n) {
-		n++;
-		while (--n > 0) {
+		while (((uintptr_t)p1 & 3) != 0) {
 			*p1++ = *p2++;
+			n--;
 		}
+		w1 = (uint32_t *)p1;
+		w2 = (const uint32_t *)p2;
+		while (n >= 16) {
+			w1[0] = w2[0];
+			w1[1] = w2[1];
+			w1[2] = w2[2];
+			w1[3] = w2[3];
+			w1 += 4;
+			w2 += 4;
+			n -= 16;
+		}
+		while (n >= 4) {
+			*w1++ = *w2++;
+			n -= 4;
+		}
+		p1 = (char *)w1;
+		p2 = (const char *)w2;
+	}
+	while (n > 0) {
+		*p1++ = *p2++;
+		n--;
 	}
 	return s1;
 }
@@ -5,6 +5,50 @@
 /* $Header: /cvsup/minix/src/lib/ansi/memmove.c,v 1.1.1.1 2005/04/21 14:56:05 beng Exp $ */
 
 #include	<string.h>
+#include	<stdint.h>
+
+/* Moves of less than this many bytes are not worth aligning. */
+#define	WORDCPY_MIN	16
+
+/*
+ * Word at a time move. A forward move is always safe for the word loop as each
+ * word is read before the (lower) destination word is written. Overlapping
+ * moves to a higher address run backwards, aligning on the end pointers.
+ */
+static void
+fwdmove(register char *p1, register const char *p2, register size_t n)
+{
+	if (n >= WORDCPY_MIN && (((uintptr_t)p1 ^ (uintptr_t)p2) & 3) == 0) {
+		register uint32_t *w1;
+		register const uint32_t *w2;
+
+		while (((uintptr_t)p1 & 3) != 0) {
+			*p1++ = *p2++;
+			n--;
+		}
+		w1 = (uint32_t *)p1;
+		w2 = (const uint32_t *)p2;
+		while (n >= 16) {
+			w1[0] = w2[0];
+			w1[1] = w2[1];
+			w1[2] = w2[2];
+			w1[3] = w2[3];
+			w1 += 4;
+			w2 += 4;
+			n -= 16;
+		}
+		while (n >= 4) {
+			*w1++ = *w2++;
+			n -= 4;
+		}
+		p1 = (char *)w1;
+		p2 = (const char *)w2;
+	}
+	while (n > 0) {
+		*p1++ = *p2++;
+		n--;
+	}
+}
 
 void *
 memmove(void *s1, const void *s2, register size_t n)
@@ -17,15 +61,38 @@ memmove(void *s1, const void *s2, register size_t n)
 			/* overlap, copy backwards */
 			p1 += n;
 			p2 += n;
-			n++;
-			while (--n > 0) {
+			if (n >= WORDCPY_MIN && (((uintptr_t)p1 ^ (uintptr_t)p2) & 3) == 0) {
+				register uint32_t *w1;
+				register const uint32_t *w2;
+
+				while (((uintptr_t)p1 & 3) != 0) {
+					*--p1 = *--p2;
+					n--;
+				}
+				w1 = (uint32_t *)p1;
+				w2 = (const uint32_t *)p2;
+				while (n >= 16) {
+					w1 -= 4;
+					w2 -= 4;
+					w1[3] = w2[3];
+					w1[2] = w2[2];
+					w1[1] = w2[1];
+					w1[0] = w2[0];
+					n -= 16;
+				}
+				while (n >= 4) {
+					*--w1 = *--w2;
+					n -= 4;
+				}
+				p1 = (char *)w1;
+				p2 = (const char *)w2;
+			}
+			while (n > 0) {
 				*--p1 = *--p2;
+				n--;
 			}
 		} else {
-			n++;
-			while (--n > 0) {
-				*p1++ = *p2++;
-			}
+			fwdmove(p1, p2, n);
 		}
 	}
 	return s1;
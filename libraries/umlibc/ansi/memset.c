@@ -5,17 +5,50 @@
 /* $Header: /cvsup/minix/src/lib/ansi/memset.c,v 1.1.1.1 2005/04/21 14:56:05 beng Exp $ */
 
 #include	<string.h>
+#include	<stdint.h>
 
+/* Fills of less than this many bytes are not worth aligning. */
+#define	WORDSET_MIN	16
+
+/*
+ * Word at a time fill, bytewise head up to a word boundary, 4 words per
+ * iteration for the bulk and a bytewise tail.
+ * The K64F build uses teensy3/memset.S instead of this module.
+ */
 void *
 memset(void *s, register int c, register size_t n)
 {
 	register char *s1 = s;
 
-	if (n>0) {
-		n++;
-		while (--n > 0) {
+	if (n >= WORDSET_MIN) {
+		register uint32_t *w1;
+		register uint32_t pattern = (unsigned char)c;
+
+		pattern |= pattern << 8;
+		pattern |= pattern << 16;
+
+		while (((uintptr_t)s1 & 3) != 0) {
 			*s1++ = c;
+			n--;
+		}
+		w1 = (uint32_t *)s1;
+		while (n >= 16) {
+			w1[0] = pattern;
+			w1[1] = pattern;
+			w1[2] = pattern;
+			w1[3] = pattern;
+			w1 += 4;
+			n -= 16;
 		}
+		while (n >= 4) {
+			*w1++ = pattern;
+			n -= 4;
+		}
+		s1 = (char *)w1;
+	}
+	while (n > 0) {
+		*s1++ = c;
+		n--;
 	}
 	return s;
 }
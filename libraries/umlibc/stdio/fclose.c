@@ -40,6 +40,10 @@ fclose(FILE *stream)
 {
 	uint8_t i;
 
+	/* Send anything still buffered and release the buffer. */
+	if (!(stream->flags & __SSTR))
+		setvbuf(stream, NULL, _IONBF, 0);
+
 	if (!(stream->flags & __SMALLOC))
 		/*
 		 * If the stream had not been malloc()ed, this is
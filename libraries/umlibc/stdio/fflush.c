@@ -0,0 +1,80 @@
+/* Copyright (c) 2026, Philip Smart
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+   * Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+   * Neither the name of the copyright holders nor the names of
+     contributors may be used to endorse or promote products derived
+     from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "stdio_private.h"
+
+/*
+ * Send the characters waiting in the output buffer of a stream to
+ * its device.
+ */
+int
+__fflushbuf(FILE *stream)
+{
+	int i, rv = 0;
+
+	if (stream->obuf == NULL || stream->olen == 0)
+		return 0;
+
+	if (stream->write != NULL) {
+		rv = stream->write(stream->obuf, stream->olen, stream);
+	} else {
+		for (i = 0; i < stream->olen && rv == 0; i++)
+			rv = stream->put(stream->obuf[i], stream);
+	}
+	stream->olen = 0;
+
+	if (rv != 0) {
+		stream->flags |= __SERR;
+		return EOF;
+	}
+	return 0;
+}
+
+int
+fflush(FILE *stream)
+{
+	int rv = 0;
+
+	if (stream == NULL) {
+		if (stdout != NULL && __fflushbuf(stdout) != 0)
+			rv = EOF;
+		if (stderr != NULL && stderr != stdout &&
+		    __fflushbuf(stderr) != 0)
+			rv = EOF;
+		return rv;
+	}
+
+	if (stream->flags & __SSTR)
+		return 0;
+
+	return __fflushbuf(stream);
+}
@@ -56,6 +56,7 @@ fgetc(FILE *stream)
 			stream->buf++;
 		}
 	} else {
+		__fflushout();
 		rv = stream->get(stream);
 		if (rv < 0) {
 			/* if != _FDEV_ERR, assume it's _FDEV_EOF */
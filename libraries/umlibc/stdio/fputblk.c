@@ -0,0 +1,93 @@
+/* Copyright (c) 2026, Philip Smart
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+   * Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+   * Neither the name of the copyright holders nor the names of
+     contributors may be used to endorse or promote products derived
+     from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "stdio_private.h"
+
+/*
+ * Write a block of characters to a stream.  String streams are
+ * filled as fputc() does, buffered streams have the block copied
+ * into their buffer and unbuffered streams send it straight to the
+ * device, in one call if a block write function is attached.
+ * Returns the number of characters accepted.
+ */
+size_t
+__fputblk(const char *ptr, size_t n, FILE *stream)
+{
+	size_t i, chunk;
+
+	if (stream->flags & __SSTR) {
+		for (i = 0; i < n; i++) {
+			if (stream->len < stream->size)
+				*stream->buf++ = ptr[i];
+			stream->len++;
+		}
+		return n;
+	}
+
+	if (stream->obuf != NULL && n < (size_t)stream->osize) {
+		const char *start = ptr;
+
+		for (i = 0; i < n; i += chunk) {
+			chunk = stream->osize - stream->olen;
+			if (chunk > n - i)
+				chunk = n - i;
+			memcpy(stream->obuf + stream->olen, ptr + i, chunk);
+			stream->olen += chunk;
+			stream->len += chunk;
+			if (stream->olen == stream->osize &&
+			    __fflushbuf(stream) != 0)
+				return i + chunk;
+		}
+		if ((stream->flags & __SLBF) && memchr(start, '\n', n) != NULL)
+			__fflushbuf(stream);
+		return n;
+	}
+
+	/* Unbuffered, or too big to gain from the buffer. */
+	if (stream->obuf != NULL && __fflushbuf(stream) != 0)
+		return 0;
+	if (stream->write != NULL) {
+		if (stream->write(ptr, n, stream) != 0) {
+			stream->flags |= __SERR;
+			return 0;
+		}
+		stream->len += n;
+		return n;
+	}
+	for (i = 0; i < n; i++) {
+		if (stream->put(ptr[i], stream) != 0)
+			return i;
+		stream->len++;
+	}
+	return n;
+}
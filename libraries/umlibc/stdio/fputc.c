@@ -45,6 +45,14 @@ fputc(int c, FILE *stream)
 			*stream->buf++ = c;
 		stream->len++;
 		return c;
+	} else if (stream->obuf != NULL) {
+		stream->obuf[stream->olen++] = c;
+		stream->len++;
+		if (stream->olen >= stream->osize ||
+		    ((stream->flags & __SLBF) && c == '\n'))
+			if (__fflushbuf(stream) != 0)
+				return EOF;
+		return c;
 	} else {
 		if (stream->put(c, stream) == 0) {
 			stream->len++;
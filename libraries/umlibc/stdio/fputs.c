@@ -30,21 +30,21 @@
 /* $Id: fputs.c,v 1.3 2005/09/06 18:49:15 joerg_wunsch Exp $ */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "stdio_private.h"
 
 int
 fputs(const char *str, FILE *stream)
 {
-	char c;
-	int rv = 0;
+	size_t n;
 
 	if ((stream->flags & __SWR) == 0)
 		return EOF;
 
-	while ((c = *str++) != '\0')
-		if (stream->put(c, stream) != 0)
-			rv = EOF;
+	n = strlen(str);
+	if (__fputblk(str, n, stream) != n)
+		return EOF;
 
-	return rv;
+	return 0;
 }
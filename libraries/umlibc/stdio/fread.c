@@ -43,6 +43,33 @@ fread(void *ptr, size_t size, size_t nmemb, FILE *stream)
 	if ((stream->flags & __SRD) == 0)
 		return 0;
 
+	/* Block read from the device, after any ungetc() character. */
+	if (stream->read != NULL && (stream->flags & __SSTR) == 0 && size != 0) {
+		size_t n = size * nmemb;
+
+		__fflushout();
+		cp = (uint8_t *)ptr;
+		i = 0;
+		if ((stream->flags & __SUNGET) != 0 && n != 0) {
+			stream->flags &= ~__SUNGET;
+			*cp++ = stream->unget;
+			i++;
+		}
+		while (i < n) {
+			c = stream->read((char *)cp, n - i, stream);
+			if (c <= 0) {
+				if (c < 0)
+					/* if != _FDEV_ERR, assume it's _FDEV_EOF */
+					stream->flags |= (c == _FDEV_ERR)? __SERR: __SEOF;
+				break;
+			}
+			cp += c;
+			i += c;
+		}
+		stream->len += i;
+		return i / size;
+	}
+
 	for (i = 0, cp = (uint8_t *)ptr; i < nmemb; i++)
 		for (j = 0; j < size; j++) {
 			c = getc(stream);
@@ -36,16 +36,9 @@
 size_t
 fwrite(const void *ptr, size_t size, size_t nmemb, FILE *stream)
 {
-	size_t i, j;
-	const uint8_t *cp;
 
-	if ((stream->flags & __SWR) == 0)
+	if ((stream->flags & __SWR) == 0 || size == 0)
 		return 0;
 
-	for (i = 0, cp = (const uint8_t *)ptr; i < nmemb; i++)
-		for (j = 0; j < size; j++)
-			if (stream->put(*cp++, stream) != 0)
-				return i;
-
-	return i;
+	return __fputblk((const char *)ptr, size * nmemb, stream) / size;
 }
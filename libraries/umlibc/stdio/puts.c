@@ -30,22 +30,23 @@
 /* $Id: puts.c,v 1.3 2005/09/06 18:49:15 joerg_wunsch Exp $ */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "stdio_private.h"
 
 int
 puts(const char *str)
 {
-	char c;
+	size_t n;
 	int rv = 0;
 
 	if ((stdout->flags & __SWR) == 0)
 		return EOF;
 
-	while ((c = *str++) != '\0')
-		if (stdout->put(c, stdout) != 0)
-			rv = EOF;
-	if (stdout->put('\n', stdout) != 0)
+	n = strlen(str);
+	if (__fputblk(str, n, stdout) != n)
+		rv = EOF;
+	if (__fputblk("\n", 1, stdout) != 1)
 		rv = EOF;
 
 	return rv;
@@ -0,0 +1,79 @@
+/* Copyright (c) 2026, Philip Smart
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+   * Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+   * Neither the name of the copyright holders nor the names of
+     contributors may be used to endorse or promote products derived
+     from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "stdio_private.h"
+
+int
+setvbuf(FILE *stream, char *buf, int mode, size_t size)
+{
+
+	if (mode != _IOFBF && mode != _IOLBF && mode != _IONBF)
+		return EOF;
+
+	/* Release the current buffer, sending anything waiting in it. */
+	__fflushbuf(stream);
+	if (stream->flags & __SMBF)
+		free(stream->obuf);
+	stream->obuf = NULL;
+	stream->osize = 0;
+	stream->olen = 0;
+	stream->flags &= ~(__SLBF | __SNBF | __SMBF);
+
+	if (mode == _IONBF) {
+		stream->flags |= __SNBF;
+		return 0;
+	}
+
+	if (size == 0)
+		size = BUFSIZ;
+	if (buf == NULL) {
+		if ((buf = malloc(size)) == NULL) {
+			stream->flags |= __SNBF;
+			return EOF;
+		}
+		stream->flags |= __SMBF;
+	}
+	stream->obuf = buf;
+	stream->osize = size;
+	if (mode == _IOLBF)
+		stream->flags |= __SLBF;
+
+	return 0;
+}
+
+void
+setbuf(FILE *stream, char *buf)
+{
+
+	setvbuf(stream, buf, buf != NULL ? _IOFBF : _IONBF, BUFSIZ);
+}
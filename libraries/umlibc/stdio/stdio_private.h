@@ -43,3 +43,17 @@
 #define SCANF_STD 2
 #define SCANF_FLT 3
 #define SCANF_DBL 4
+
+/* block output through the stream buffer, fputblk.c */
+extern size_t __fputblk(const char *__ptr, size_t __n, FILE *__stream);
+
+/* send the output buffer of a stream to its device, fflush.c */
+extern int __fflushbuf(FILE *__stream);
+
+/* flush stdout and stderr before a device read so prompts appear */
+#define __fflushout() \
+	do { \
+		if ((stdout != 0 && stdout->olen != 0) || \
+		    (stderr != 0 && stderr->olen != 0)) \
+			fflush(0); \
+	} while(0)
@@ -558,8 +558,19 @@ vfprintf(FILE *stream, const char *fmt, va_list ap) {
 				prec = width = 0;
 #endif
 				base = 10;
-			} else
+			} else if (stream->flags & __SPGM) {
 				putc(c, stream);
+			} else {
+				/*
+				 * Send the literal text up to the next
+				 * conversion in one block.
+				 */
+				const char *run = fmt - 1;
+
+				while (*fmt != '\0' && *fmt != '%')
+					fmt++;
+				__fputblk(run, fmt - run, stream);
+			}
 	}
 
 	return stream->len;
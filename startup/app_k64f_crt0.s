@@ -379,4 +379,6 @@ BSS_END:    .word      __bss_section_end__
             defapifunc      hardResetTranZPUter       funcAddr
             .equ funcAddr,  funcAddr+funcNext;
             defapifunc      convertSharpFilenameToAscii funcAddr
+            .equ funcAddr,  funcAddr+funcNext;
+            defapifunc      setZ80BurstMode           funcAddr
     .end
@@ -1062,6 +1062,7 @@ void _ZPUTA_Vectors(void)
     __asm__ volatile ("b clearZ80Reset");
     __asm__ volatile ("b hardResetTranZPUter");
     __asm__ volatile ("b convertSharpFilenameToAscii");
+    __asm__ volatile ("b setZ80BurstMode");
   #endif
 }
 
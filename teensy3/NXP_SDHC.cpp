@@ -57,6 +57,10 @@ enum {
 #define SDHC_PROCTL_DTW_8BIT                (0x10)
 
 #define SDHC_INITIALIZATION_MAX_CNT 100000
+#define SDHC_DATA_MAX_CNT           (1 << 24)   // polls of a data transfer wait before it is given up, as SDHC_WaitStatus
+
+// data errors which end a transfer
+#define SDHC_IRQSTAT_DATA_ERR               (SDHC_IRQSTAT_DEBE | SDHC_IRQSTAT_DCE | SDHC_IRQSTAT_DTOE)
 
 /* SDHC commands */
 #define SDHC_CMD0                           (0)
@@ -426,6 +430,7 @@ static void SDHC_ReleaseGPIO(void);
 static uint32_t SDHC_WaitStatus(uint32_t mask);
 static int SDHC_ReadBlock(uint32_t* pData);
 static int SDHC_WriteBlock(const uint32_t* pData);
+static int SDHC_WaitTransferComplete(void);
 static int SDHC_CMD_Do(uint32_t xfertyp);
 static int SDHC_CMD0_GoToIdle(void);
 static int SDHC_CMD2_Identify(void);
@@ -439,6 +444,9 @@ static int SDHC_CMD12_StopTransferWaitForBusy(void);
 static int SDHC_CMD16_SetBlockSize(uint32_t block_size);
 static int SDHC_CMD17_ReadBlock(uint32_t sector);
 static int SDHC_CMD24_WriteBlock(uint32_t sector);
+static int SDHC_CMD18_ReadBlocks(uint32_t sector, uint32_t count);
+static int SDHC_CMD25_WriteBlocks(uint32_t sector, uint32_t count);
+static int SDHC_ACMD23_SetWrBlkEraseCount(uint32_t count);
 static int SDHC_ACMD41_SendOperationCond(uint32_t cond);
 
 /******************************************************************************
@@ -611,8 +619,9 @@ int SDHC_CardReadBlock(void * buff, uint32_t sector)
   if(result != SDHC_RESULT_OK) return result;
   result = SDHC_ReadBlock(pData);
 
-  // finish up
-  while (!(SDHC_IRQSTAT & SDHC_IRQSTAT_TC)) { }  // wait for transfer to complete
+  // finish up, a failed block has already been stopped so there is no transfer complete to wait for.
+  if (result == SDHC_RESULT_OK)
+    result = SDHC_WaitTransferComplete();
   SDHC_IRQSTAT = (SDHC_IRQSTAT_TC | SDHC_IRQSTAT_BRR | SDHC_IRQSTAT_AC12E);
 
   return result;
@@ -707,8 +716,9 @@ int SDHC_CardWriteBlock(const void * buff, uint32_t sector)
   if (result != SDHC_RESULT_OK) return result;
   result = SDHC_WriteBlock(pData);
 
-  // finish up
-  while (!(SDHC_IRQSTAT & SDHC_IRQSTAT_TC)) { }  // wait for transfer to complete
+  // finish up, a failed block has already been stopped so there is no transfer complete to wait for.
+  if (result == SDHC_RESULT_OK)
+    result = SDHC_WaitTransferComplete();
   SDHC_IRQSTAT = (SDHC_IRQSTAT_TC | SDHC_IRQSTAT_BWR | SDHC_IRQSTAT_AC12E);
 
   return result;
@@ -786,6 +796,122 @@ int SDHC_CardWriteBlock(const void * buff, uint32_t sector)
 }
 #endif
 
+//-----------------------------------------------------------------------------
+// FUNCTION:    SDHC_CardReadBlocks (disk_read)
+// SCOPE:       SDHC public related function
+// DESCRIPTION: Function reads multiple consecutive blocks from disk with one
+//              CMD18 transaction, the controller issues the stop (Auto CMD12)
+//              once the block count is reached.
+//
+// PARAMETERS:  buff - pointer on buffer where read data should be stored
+//              sector - index of start sector
+//              count - number of sectors to read (1..65535)
+//
+// RETURNS:     result of operation
+//-----------------------------------------------------------------------------
+int SDHC_CardReadBlocks(void * buff, uint32_t sector, uint32_t count)
+{
+  int result;
+  uint32_t* pData = (uint32_t*)buff;
+
+  // A single block doesnt warrant the stop command overhead.
+  if (count == 1)
+    return SDHC_CardReadBlock(buff, sector);
+  if (count == 0 || count > 0xFFFF)
+    return SDHC_RESULT_PARERR;
+
+  // Check if this is ready
+  if (sdCardDesc.status != 0)
+     return SDHC_RESULT_NOT_READY;
+
+  // Convert LBA to uint8_t address if needed
+  if (!sdCardDesc.highCapacity)
+    sector *= 512;
+
+  SDHC_IRQSTAT = 0xffff;
+#if defined(__IMXRT1062__)
+  SDHC_MIX_CTRL |= SDHC_MIX_CTRL_DTDSEL;
+#endif
+
+  result = SDHC_CMD18_ReadBlocks(sector, count);
+  if(result != SDHC_RESULT_OK) return result;
+  while (count-- && result == SDHC_RESULT_OK)
+  {
+    result = SDHC_ReadBlock(pData);
+    pData += SDHC_BLOCK_SIZE / 4;
+  }
+
+  // finish up, transfer complete is signalled after the Auto CMD12. A failed block has already been stopped.
+  if (result == SDHC_RESULT_OK)
+    result = SDHC_WaitTransferComplete();
+  SDHC_IRQSTAT = (SDHC_IRQSTAT_TC | SDHC_IRQSTAT_BRR | SDHC_IRQSTAT_AC12E);
+
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+// FUNCTION:    SDHC_CardWriteBlocks (disk_write)
+// SCOPE:       SDHC public related function
+// DESCRIPTION: Function writes multiple consecutive blocks to disk with one
+//              CMD25 transaction. The card is first given the number of blocks
+//              to be written (ACMD23) so it can pre-erase them, the controller
+//              issues the stop (Auto CMD12) once the block count is reached.
+//
+// PARAMETERS:  buff - pointer on buffer where is stored data
+//              sector - index of start sector
+//              count - number of sectors to write (1..65535)
+//
+// RETURNS:     result of operation
+//-----------------------------------------------------------------------------
+int SDHC_CardWriteBlocks(const void * buff, uint32_t sector, uint32_t count)
+{
+  int result;
+  uint32_t timeout;
+  const uint32_t *pData = (const uint32_t *)buff;
+
+  // A single block doesnt warrant the pre-erase and stop command overhead.
+  if (count == 1)
+    return SDHC_CardWriteBlock(buff, sector);
+  if (count == 0 || count > 0xFFFF)
+    return SDHC_RESULT_PARERR;
+
+  // Check if this is ready
+  if (sdCardDesc.status != 0) return SDHC_RESULT_NOT_READY;
+
+  // Convert LBA to uint8_t address if needed
+  if(!sdCardDesc.highCapacity)
+    sector *= 512;
+
+  SDHC_IRQSTAT = SDHC_IRQSTAT;
+#if defined(__IMXRT1062__)
+	SDHC_MIX_CTRL &= ~SDHC_MIX_CTRL_DTDSEL;
+#endif
+
+  // Pre-erase hint, not all cards act upon it so a failure isnt fatal.
+  (void)SDHC_ACMD23_SetWrBlkEraseCount(count);
+
+  result = SDHC_CMD25_WriteBlocks(sector, count);
+  if (result != SDHC_RESULT_OK) return result;
+  while (count-- && result == SDHC_RESULT_OK)
+  {
+    result = SDHC_WriteBlock(pData);
+    pData += SDHC_BLOCK_SIZE / 4;
+  }
+
+  // finish up, transfer complete is signalled after the Auto CMD12, then wait for the card to finish programming.
+  // A failed block has already been stopped.
+  if (result == SDHC_RESULT_OK)
+    result = SDHC_WaitTransferComplete();
+  SDHC_IRQSTAT = (SDHC_IRQSTAT_TC | SDHC_IRQSTAT_BWR | SDHC_IRQSTAT_AC12E);
+  for (timeout = SDHC_DATA_MAX_CNT; result == SDHC_RESULT_OK && (SDHC_PRSSTAT & SDHC_PRSSTAT_DLA); timeout--)
+  {
+    if (!timeout)
+      result = SDHC_RESULT_NO_RESPONSE;
+  }
+
+  return result;
+}
+
 /******************************************************************************
 
     Private functions
@@ -1098,19 +1224,22 @@ static uint32_t SDHC_WaitStatus(uint32_t mask)
 // reads one block
 static int SDHC_ReadBlock(uint32_t* pData)
 {
-	uint32_t i, irqstat;
+	uint32_t i, irqstat, timeout;
 	const uint32_t i_max = ((SDHC_BLOCK_SIZE) / (4 * SDHC_FIFO_BUFFER_SIZE));
 
 	for (i = 0; i < i_max; i++) {
 		irqstat = SDHC_IRQSTAT;
 		SDHC_IRQSTAT = irqstat | SDHC_IRQSTAT_BRR;
-		if (irqstat & (SDHC_IRQSTAT_DEBE | SDHC_IRQSTAT_DCE | SDHC_IRQSTAT_DTOE)) {
-			SDHC_IRQSTAT = irqstat | SDHC_IRQSTAT_BRR |
-				SDHC_IRQSTAT_DEBE | SDHC_IRQSTAT_DCE | SDHC_IRQSTAT_DTOE;
+		// wait for the data, an error raised whilst waiting or no data at all fails the block
+		for (timeout = SDHC_DATA_MAX_CNT; !(irqstat & SDHC_IRQSTAT_DATA_ERR) && !(SDHC_PRSSTAT & SDHC_PRSSTAT_BREN); timeout--) {
+			irqstat |= SDHC_IRQSTAT & SDHC_IRQSTAT_DATA_ERR;
+			if (!timeout) irqstat |= SDHC_IRQSTAT_DTOE;
+		}
+		if (irqstat & SDHC_IRQSTAT_DATA_ERR) {
+			SDHC_IRQSTAT = irqstat | SDHC_IRQSTAT_BRR | SDHC_IRQSTAT_DATA_ERR;
 			SDHC_CMD12_StopTransferWaitForBusy();
 			return SDHC_RESULT_ERROR;
 		}
-		while (!(SDHC_PRSSTAT & SDHC_PRSSTAT_BREN)) { };
 		*pData++ = SDHC_DATPORT;
 		*pData++ = SDHC_DATPORT;
 		*pData++ = SDHC_DATPORT;
@@ -1138,8 +1267,8 @@ static int SDHC_WriteBlock(const uint32_t* pData)
 	i_max = ((SDHC_BLOCK_SIZE) / (4 * SDHC_FIFO_BUFFER_SIZE));
 
 	for(i = 0; i < i_max; i++) {
-		while (!(SDHC_IRQSTAT & SDHC_IRQSTAT_BWR)) ; // wait
-		if (SDHC_IRQSTAT & (SDHC_IRQSTAT_DEBE | SDHC_IRQSTAT_DCE | SDHC_IRQSTAT_DTOE)) {
+		// wait for buffer space, an error raised whilst waiting or a timeout fails the block
+		if (SDHC_WaitStatus(SDHC_IRQSTAT_BWR | SDHC_IRQSTAT_DATA_ERR) != SDHC_IRQSTAT_BWR) {
 			SDHC_IRQSTAT |= SDHC_IRQSTAT_DEBE | SDHC_IRQSTAT_DCE |
 				SDHC_IRQSTAT_DTOE | SDHC_IRQSTAT_BWR;
 			(void)SDHC_CMD12_StopTransferWaitForBusy();
@@ -1160,6 +1289,19 @@ static int SDHC_WriteBlock(const uint32_t* pData)
 	return SDHC_RESULT_OK;
 }
 
+// waits for the end of a data transfer, on a data or Auto CMD12 error or a timeout the transfer is stopped
+static int SDHC_WaitTransferComplete(void)
+{
+  uint32_t irqstat;
+
+  irqstat = SDHC_WaitStatus(SDHC_IRQSTAT_TC | SDHC_IRQSTAT_DATA_ERR | SDHC_IRQSTAT_AC12E);
+  if (irqstat == SDHC_IRQSTAT_TC) return SDHC_RESULT_OK;
+
+  SDHC_IRQSTAT |= SDHC_IRQSTAT_DATA_ERR | SDHC_IRQSTAT_AC12E;
+  (void)SDHC_CMD12_StopTransferWaitForBusy();
+  return SDHC_RESULT_ERROR;
+}
+
 // sends the command to SDcard
 static int SDHC_CMD_Do(uint32_t xfertyp)
 {
@@ -1167,7 +1309,9 @@ static int SDHC_CMD_Do(uint32_t xfertyp)
   SDHC_IRQSTAT |= SDHC_IRQSTAT_CRM;
 
   // Wait for cmd line idle // to do timeout PRSSTAT[CDIHB] and the PRSSTAT[CIHB]
-  while ((SDHC_PRSSTAT & SDHC_PRSSTAT_CIHB) || (SDHC_PRSSTAT & SDHC_PRSSTAT_CDIHB)) { };
+  // An abort command is how a transfer holding the data line is stopped so it only waits for the cmd line.
+  while ((SDHC_PRSSTAT & SDHC_PRSSTAT_CIHB) ||
+         ((xfertyp & SDHC_XFERTYP_CMDTYP(SDHC_XFERTYP_CMDTYP_ABORT)) != SDHC_XFERTYP_CMDTYP(SDHC_XFERTYP_CMDTYP_ABORT) && (SDHC_PRSSTAT & SDHC_PRSSTAT_CDIHB))) { };
   SDHC_XFERTYP = xfertyp;
 
   /* Wait for response */
@@ -1414,6 +1558,73 @@ static int SDHC_CMD24_WriteBlock(uint32_t sector)
   return result;
 }
 
+// sends CMD18 to read multiple blocks, stopped by Auto CMD12 after count blocks
+static int SDHC_CMD18_ReadBlocks(uint32_t sector, uint32_t count)
+{
+  uint32_t xfertyp;
+  int result;
+
+  SDHC_CMDARG = sector;
+
+  SDHC_BLKATTR = SDHC_BLKATTR_BLKCNT(count) | 512;
+
+  xfertyp = (SDHC_XFERTYP_CMDINX(SDHC_CMD18) | SDHC_XFERTYP_CICEN |
+             SDHC_XFERTYP_CCCEN | SDHC_XFERTYP_RSPTYP(SDHC_XFERTYP_RSPTYP_48) |
+             SDHC_XFERTYP_DTDSEL | SDHC_XFERTYP_DPSEL |
+             SDHC_XFERTYP_MSBSEL | SDHC_XFERTYP_BCEN | SDHC_XFERTYP_AC12EN);
+
+  result = SDHC_CMD_Do(xfertyp);
+  if (result == SDHC_RESULT_OK) { (void)SDHC_CMDRSP0; }
+
+  return result;
+}
+
+// sends CMD25 to write multiple blocks, stopped by Auto CMD12 after count blocks
+static int SDHC_CMD25_WriteBlocks(uint32_t sector, uint32_t count)
+{
+  uint32_t xfertyp;
+  int result;
+
+  SDHC_CMDARG = sector;
+  SDHC_BLKATTR = SDHC_BLKATTR_BLKCNT(count) | 512;
+
+  xfertyp = (SDHC_XFERTYP_CMDINX(SDHC_CMD25) | SDHC_XFERTYP_CICEN |
+             SDHC_XFERTYP_CCCEN | SDHC_XFERTYP_RSPTYP(SDHC_XFERTYP_RSPTYP_48) |
+             SDHC_XFERTYP_DPSEL |
+             SDHC_XFERTYP_MSBSEL | SDHC_XFERTYP_BCEN | SDHC_XFERTYP_AC12EN);
+
+  result = SDHC_CMD_Do(xfertyp);
+  if (result == SDHC_RESULT_OK) { (void)SDHC_CMDRSP0; }
+
+  return result;
+}
+
+// ACMD 23 to set the number of blocks to pre-erase before a multiple block write
+static int SDHC_ACMD23_SetWrBlkEraseCount(uint32_t count)
+{
+  uint32_t xfertyp;
+  int result;
+
+  SDHC_CMDARG = sdCardDesc.address;
+  // first send CMD 55 Application specific command
+  xfertyp = (SDHC_XFERTYP_CMDINX(SDHC_CMD55) | SDHC_XFERTYP_CICEN |
+             SDHC_XFERTYP_CCCEN | SDHC_XFERTYP_RSPTYP(SDHC_XFERTYP_RSPTYP_48));
+
+  result = SDHC_CMD_Do(xfertyp);
+  if (result == SDHC_RESULT_OK) { (void)SDHC_CMDRSP0; } else { return result; }
+
+  SDHC_CMDARG = count & 0x007FFFFF;
+
+  // Send ACMD23
+  xfertyp = (SDHC_XFERTYP_CMDINX(SDHC_ACMD23) | SDHC_XFERTYP_CICEN |
+             SDHC_XFERTYP_CCCEN | SDHC_XFERTYP_RSPTYP(SDHC_XFERTYP_RSPTYP_48));
+
+  result = SDHC_CMD_Do(xfertyp);
+  if (result == SDHC_RESULT_OK) { (void)SDHC_CMDRSP0; }
+
+  return result;
+}
+
 // ACMD 41 to send operation condition
 static int SDHC_ACMD41_SendOperationCond(uint32_t cond)
 {
@@ -12,5 +12,7 @@ uint8_t SDHC_CardGetType(void);
 
 int SDHC_CardReadBlock(void * buff, uint32_t sector);
 int SDHC_CardWriteBlock(const void * buff, uint32_t sector);
+int SDHC_CardReadBlocks(void * buff, uint32_t sector, uint32_t count);
+int SDHC_CardWriteBlocks(const void * buff, uint32_t sector, uint32_t count);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,433 @@
+// appbench.c
+//
+// Host program to exercise the zOS application registry and image cache (common/appreg.c) and compare the cost of
+// launching applications with the original search, where each command is tried as a path in up to four forms
+// and the image read from the SD card on every run.
+//
+// common/appreg.c is included directly with the FatFS calls it makes routed to a model of the SD card holding a
+// bin directory of generated applications. The model charges time as a ZPU reading the card over SPI would spend
+// it: a directory search reads the directory sectors up to the entry (all of them when the file is missing), a
+// file read one sector time per sector, and with the cache the copy and CRC check run at memory speeds. The
+// times are therefore modelled, not measured, the parameters are given on the command line.
+//
+// A script in the style of an autoexec.bat runs a few applications repeatedly. Every launch is checked against
+// the file contents, part way through one application is replaced, which must invalidate its cached image, and
+// a cached image is corrupted, which must be caught by its CRC.
+//
+// Usage: appbench [-n <apps>] [-r <launches>] [-s <sector us>] [-m <memcpy MB/s>] [-c <crc MB/s>]
+//
+// The cache budget is that of the build, add -DAPP_CACHE_SIZE=<bytes> and -DAPP_CACHE_SLOTS=<n> to try another.
+//
+// Build (from the repository root), without -DAPP_CACHE only the registry is used:
+//   gcc -O2 -D__ZPU__ -DAPP_CACHE -DCRC32_SMALL_TABLE -Iinclude -Icommon -Icommon/FatFS -o tools/appbench tools/src/appbench.c
+//
+//   Created by: Philip Smart, Oct 2026.
+//
+// This software is free to use by anyone for any purpose.
+//
+
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+// FatFS has its own DIR.
+#define DIR              HOST_DIR
+#include <dirent.h>
+#undef  DIR
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// The SoC header names its register pointer type as the host does.
+#define register_t       soc_register_t
+#include "zpu_soc.h"
+#include "ff.h"
+
+// Modelled time in microseconds, the registry reads it as the millisecond timer.
+static uint64_t modelUs = 0;
+#undef  TIMER_MILLISECONDS_UP
+#define TIMER_MILLISECONDS_UP ((uint32_t)(modelUs / 1000))
+
+#include "crc32.c"
+
+// Model parameters.
+static uint32_t sectorUs   = 1000;                 // One 512 byte sector read from the card.
+static uint32_t memcpyMBs  = 20;                   // Memory copy rate.
+static uint32_t crcMBs     = 4;                    // CRC32 rate.
+static uint32_t entriesPerSector = 8;              // Directory entries per sector, LFN names take two slots.
+
+// Copies and CRCs within the registry are charged at memory speeds.
+static void *modelMemcpy(void *dst, const void *src, size_t len)
+{
+    modelUs += (uint64_t)len / memcpyMBs;
+    return(memcpy(dst, src, len));
+}
+static uint32_t modelCrc(uint32_t crc, const void *buf, uint32_t len)
+{
+    modelUs += (uint64_t)len / crcMBs;
+    return(crc32_update(crc, buf, len));
+}
+#define memcpy(d, s, l)          modelMemcpy(d, s, l)
+#define crc32_update(c, b, l)    modelCrc(c, b, l)
+#include "appreg.c"
+#undef  memcpy
+#undef  crc32_update
+
+#define MEM_ADDR         0x10000000          // Application load address, fixed as the registry takes a 32bit address.
+#define MEM_SIZE         0x100000
+#define MAX_APPS         64
+
+// The SD card, a host directory standing in for 0:\bin.
+static char     binDir[64];
+static char     appName[MAX_APPS][16];
+static uint32_t appSize[MAX_APPS];
+static int      apps       = 24;
+static FILE     *openFile  = NULL;
+static HOST_DIR *openDir   = NULL;
+static uint32_t sdReads    = 0;
+static uint32_t searches   = 0;
+
+// Host path of a zOS path, the filename after the last separator. Only 0:\bin holds files.
+static int hostPath(const char *path, char *host)
+{
+    const char *name = strrchr(path, '\\');
+
+    if(name == NULL || strncmp(path, "0:\\bin\\", 7) != 0 || strchr(name + 1, '.') == NULL)
+        return(0);
+    sprintf(host, "%s/%s", binDir, name + 1);
+    return(1);
+}
+
+// A directory search, the sectors up to the entry or all of them when missing. The root directory holding bin
+// is one sector.
+static void chargeSearch(const char *path)
+{
+    const char *name = strrchr(path, '\\');
+    int         idx;
+
+    searches++;
+    modelUs += sectorUs;
+    if(strncmp(path, "0:\\bin\\", 7) != 0)
+        return;
+    for(idx=0; idx < apps; idx++)
+    {
+        if(strncasecmp(name + 1, appName[idx], strlen(appName[idx])) == 0 && name[1 + strlen(appName[idx])] == '.')
+            break;
+    }
+    modelUs += (uint64_t)sectorUs * (idx / entriesPerSector + 1);
+}
+
+static void fatStamp(time_t mtime, FILINFO *fno)
+{
+    struct tm *tm = localtime(&mtime);
+
+    fno->fdate = ((tm->tm_year - 80) << 9) | ((tm->tm_mon + 1) << 5) | tm->tm_mday;
+    fno->ftime = (tm->tm_hour << 11) | (tm->tm_min << 5) | (tm->tm_sec / 2);
+}
+
+FRESULT f_stat(const TCHAR *path, FILINFO *fno)
+{
+    struct stat st;
+    char        host[128];
+
+    chargeSearch(path);
+    if(!hostPath(path, host) || stat(host, &st) != 0)
+        return(FR_NO_FILE);
+    fno->fsize   = st.st_size;
+    fno->fattrib = 0;
+    fatStamp(st.st_mtime, fno);
+    strcpy(fno->fname, strrchr(host, '/') + 1);
+    return(FR_OK);
+}
+
+FRESULT f_open(FIL *fp, const TCHAR *path, BYTE mode)
+{
+    char host[128];
+
+    chargeSearch(path);
+    if(!hostPath(path, host) || (openFile = fopen(host, "rb")) == NULL)
+        return(FR_NO_FILE);
+    fseek(openFile, 0, SEEK_END);
+    fp->obj.objsize = ftell(openFile);
+    rewind(openFile);
+    return(FR_OK);
+}
+
+FRESULT f_read(FIL *fp, void *buff, UINT btr, UINT *br)
+{
+    *br = fread(buff, 1, btr, openFile);
+    modelUs += (uint64_t)sectorUs * ((*br + 511) / 512);
+    sdReads += (*br + 511) / 512;
+    return(FR_OK);
+}
+
+FRESULT f_close(FIL *fp)
+{
+    if(openFile)
+        fclose(openFile);
+    openFile = NULL;
+    return(FR_OK);
+}
+
+FRESULT f_opendir(DIR *dp, const TCHAR *path)
+{
+    modelUs += sectorUs;
+    return((openDir = opendir(binDir)) == NULL ? FR_NO_PATH : FR_OK);
+}
+
+FRESULT f_readdir(DIR *dp, FILINFO *fno)
+{
+    static uint32_t read = 0;
+    struct dirent   *ent;
+    struct stat     st;
+    char            host[128];
+
+    do {
+        if((ent = readdir(openDir)) == NULL)
+        {
+            fno->fname[0] = 0;
+            return(FR_OK);
+        }
+    } while(ent->d_name[0] == '.');
+
+    if(++read % entriesPerSector == 0)
+        modelUs += sectorUs;
+    sprintf(host, "%s/%s", binDir, ent->d_name);
+    stat(host, &st);
+    strcpy(fno->fname, ent->d_name);
+    fno->fsize   = st.st_size;
+    fno->fattrib = 0;
+    fatStamp(st.st_mtime, fno);
+    return(FR_OK);
+}
+
+FRESULT f_closedir(DIR *dp)
+{
+    closedir(openDir);
+    return(FR_OK);
+}
+
+// The original zOS launch, the command tried in four forms until one loads.
+//
+static int searchLoad(const char *cmd)
+{
+    FIL      fp;
+    UINT     readSize;
+    char     path[64];
+    int      form;
+
+    for(form=1; form <= 4; form++)
+    {
+        switch(form)
+        {
+            case 1: sprintf(path, "%d:\\%s\\%s.%s", 0, "bin", cmd, "ZPU"); break;
+            case 2: sprintf(path, "%s", cmd);                              break;
+            case 3: sprintf(path, "%d:\\%s\\%s", 0, "bin", cmd);            break;
+            case 4: sprintf(path, "%d:\\%s", 0, cmd);                       break;
+        }
+        if(f_open(&fp, path, FA_OPEN_EXISTING | FA_READ) == FR_OK)
+        {
+            while(f_read(&fp, (void *)(uintptr_t)(MEM_ADDR + 0), MEM_SIZE, &readSize) == FR_OK && readSize == MEM_SIZE);
+            f_close(&fp);
+            return(1);
+        }
+    }
+    return(0);
+}
+
+// Write an application file of the given size, seeded so a rewrite changes the contents.
+//
+static void writeApp(int idx, uint32_t seed)
+{
+    char     host[128];
+    FILE     *fp;
+    uint32_t pos;
+
+    sprintf(host, "%s/%s.ZPU", binDir, appName[idx]);
+    fp = fopen(host, "wb");
+    srand(seed);
+    for(pos=0; pos < appSize[idx]; pos++)
+        fputc(rand() & 0xFF, fp);
+    fclose(fp);
+}
+
+// Compare the load area with the application file.
+//
+static int loaded(int idx)
+{
+    char     host[128];
+    uint8_t  *buf = malloc(appSize[idx]);
+    FILE     *fp;
+    int      same;
+
+    sprintf(host, "%s/%s.ZPU", binDir, appName[idx]);
+    fp = fopen(host, "rb");
+    same = fread(buf, 1, appSize[idx], fp) == appSize[idx] && memcmp(buf, (void *)(uintptr_t)MEM_ADDR, appSize[idx]) == 0;
+    fclose(fp);
+    free(buf);
+    return(same);
+}
+
+int main(int argc, char *argv[])
+{
+    static const char *cmdNames[] = { "dir", "cat", "cp", "hexdump", "ed", "kilo", "tbasic", "mbasic", "crc", "ls", "sort", "grep" };
+    t_appRegStats stats;
+    t_appEntry    *entry;
+    uint64_t      start;
+    uint64_t      searchUs  = 0;
+    uint64_t      regUs     = 0;
+    uint32_t      searchReads;
+    uint32_t      searchCount;
+    uint32_t      regReads;
+    uint32_t      regCount;
+    int           launches  = 200;
+    int           failures  = 0;
+    int           corrupted = 0;
+    int           opt;
+    int           idx;
+    int           run;
+    int           app;
+    char          cmd[16];
+
+    while((opt = getopt(argc, argv, "n:r:s:m:c:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n': apps      = atoi(optarg); break;
+            case 'r': launches  = atoi(optarg); break;
+            case 's': sectorUs  = atoi(optarg); break;
+            case 'm': memcpyMBs = atoi(optarg); break;
+            case 'c': crcMBs    = atoi(optarg); break;
+            default:
+                printf("Usage: %s [-n <apps>] [-r <launches>] [-s <sector us>] [-m <memcpy MB/s>] [-c <crc MB/s>]\n", argv[0]);
+                return(1);
+        }
+    }
+    if(apps > MAX_APPS) apps = MAX_APPS;
+    if(mmap((void *)MEM_ADDR, MEM_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED)
+    {
+        perror("mmap load memory");
+        return(1);
+    }
+
+    // A bin directory of applications 4KB to 28KB.
+    strcpy(binDir, "/tmp/appbenchXXXXXX");
+    if(mkdtemp(binDir) == NULL)
+    {
+        perror("mkdtemp");
+        return(1);
+    }
+    for(idx=0; idx < apps; idx++)
+    {
+        if(idx < (int)(sizeof(cmdNames) / sizeof(cmdNames[0])))
+            strcpy(appName[idx], cmdNames[idx]);
+        else
+            sprintf(appName[idx], "app%02d", idx);
+        appSize[idx] = 4096 + (((idx * 7919) % 13) * 2048);
+        writeApp(idx, idx + 1);
+    }
+
+    // Registry built at boot.
+    start = modelUs;
+    appRegBuild(0, "bin", "ZPU");
+    appRegGetStats(&stats);
+    printf("Registry of %u applications built in %u ms (modelled, %u us per sector).\n", stats.entries, (uint32_t)((modelUs - start) / 1000), sectorUs);
+    if(stats.entries != apps)
+        failures++;
+
+    // The script: three applications run in turn most of the time, the others now and again. Half way through
+    // the most used application is replaced and later its cached image corrupted.
+    srand(1);
+    searchReads = sdReads;
+    searchCount = searches;
+    for(run=0; run < launches; run++)
+    {
+        app = run % 4 != 3 ? run % 3 : 3 + (rand() % (apps - 3));
+        strcpy(cmd, appName[app]);
+
+        // Original search.
+        start = modelUs;
+        if(!searchLoad(cmd) || !loaded(app))
+            failures++;
+        searchUs += modelUs - start;
+    }
+    searchReads = sdReads - searchReads;
+    searchCount = searches - searchCount;
+
+    srand(1);
+    regReads = sdReads;
+    regCount = searches;
+    for(run=0; run < launches; run++)
+    {
+        app = run % 4 != 3 ? run % 3 : 3 + (rand() % (apps - 3));
+        strcpy(cmd, appName[app]);
+
+        if(run == launches / 2)
+        {
+            // Replaced with new contents and a later timestamp.
+            struct timespec ts[2] = { { 0, UTIME_OMIT }, { time(NULL) + 60, 0 } };
+            char            host[128];
+
+            writeApp(0, 1000);
+            sprintf(host, "%s/%s.ZPU", binDir, appName[0]);
+            utimensat(AT_FDCWD, host, ts, 0);
+        }
+      #if defined(APP_CACHE)
+        if(run >= (launches * 3) / 4 && !corrupted)
+        {
+            // The image about to be used, if cached.
+            for(idx=0; idx < APP_CACHE_SLOTS; idx++)
+            {
+                if(appCache[idx].image != NULL && strncmp(appCache[idx].file, cmd, strlen(cmd)) == 0 && appCache[idx].file[strlen(cmd)] == '.')
+                {
+                    appCache[idx].image[appCache[idx].fsize / 2] ^= 0x55;
+                    corrupted = 1;
+                }
+            }
+        }
+      #endif
+
+        start = modelUs;
+        if(appRegLoad(cmd, MEM_ADDR) != FR_OK || !loaded(app))
+        {
+            printf("Launch %d of %s loaded the wrong image.\n", run, cmd);
+            failures++;
+        }
+        regUs += modelUs - start;
+    }
+    regReads = sdReads - regReads;
+    regCount = searches - regCount;
+
+    appRegGetStats(&stats);
+    printf("%d launches of %d applications, 3 run in turn and the rest now and again:\n", launches, apps);
+    printf("  search and load      %8.1f ms, %6.2f ms per launch, %u searches, %u sectors read.\n",
+           searchUs / 1000.0, searchUs / 1000.0 / launches, searchCount, searchReads);
+    printf("  registry and cache   %8.1f ms, %6.2f ms per launch, %u searches, %u sectors read.\n",
+           regUs / 1000.0, regUs / 1000.0 / launches, regCount, regReads);
+    printf("  cache %u of %u bytes in %u images, %u evicted, %u failed CRC.\n", stats.cacheBytes, APP_CACHE_SIZE, stats.cacheImages, stats.cacheEvictions, stats.cacheRejects);
+    printf("%-10s %8s %5s %5s %8s %8s\n", "Command", "Size", "Runs", "Hits", "Last ms", "Avg ms");
+    for(idx=0; (entry = appRegEntry(idx)) != NULL; idx++)
+    {
+        if(entry->launches)
+            printf("%-10.*s %8u %5u %5u%c%8u %8u\n", (int)(strchr(entry->file, '.') - entry->file), entry->file, entry->fsize, entry->launches, entry->hits,
+                   appRegIsCached(entry) ? '*' : ' ', entry->lastMs, entry->totalMs / entry->launches);
+    }
+  #if defined(APP_CACHE)
+    if(stats.cacheRejects != corrupted || !corrupted)
+        failures++;
+  #endif
+
+    for(idx=0; idx < apps; idx++)
+    {
+        char host[128];
+        sprintf(host, "%s/%s.ZPU", binDir, appName[idx]);
+        unlink(host);
+    }
+    rmdir(binDir);
+
+    printf("Verification: %s\n", failures ? "FAILED" : "ok");
+    return(failures ? 1 : 0);
+}
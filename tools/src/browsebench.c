@@ -0,0 +1,453 @@
+// browsebench.c
+//
+// Host program to measure the emulator file browser directory list, common/dirlist.c, against the original
+// method of common/emumz.c on a synthetic FAT volume.
+//
+// A RAM disk is formatted with the zOS FatFS configuration and a directory is filled, in random order, with tape
+// images matching the browser filter, disk images which do not match, a set of sub-directories and a hidden
+// directory. The directory is then read by:
+//
+//   legacy  - the original method, a malloc per name into a fixed table then a pass over every adjacent pair
+//             repeated for every entry. The table limit, 512 on the K64F, is raised to the directory size so
+//             both methods list the same entries.
+//   dirlist - names packed into one arena, each page heap sorted and merged into the offset index.
+//
+// Host time, name comparisons, heap calls and the blocks left allocated are reported. Comparisons are what
+// count on the K64F, each being a strcasecmp over names which mostly share a long leading part. For dirlist
+// the time, sector reads and comparisons to the first page, ie. when the first screen can be drawn, are given
+// as well as for the whole directory.
+//
+// Typed prefixes are then located, each 1, 2 and 3 character prefix of every name, by the original first letter
+// scan and by the binary search, and each result checked against a linear scan of the list.
+//
+// The final order is verified against qsort of the same entries, the legacy order must match it too, and an
+// entry selected after the first page must still be selected once the remaining pages are merged in.
+//
+// Usage: browsebench [-n <entries>] [-s <seed>]
+//
+// Build (from the repository root):
+//   gcc -O2 -Iinclude -Icommon/FatFS -Wl,--wrap=malloc,--wrap=realloc,--wrap=free,--wrap=strcasecmp,--wrap=strncasecmp -o tools/browsebench tools/src/browsebench.c common/dirlist.c common/FatFS/ff.c common/FatFS/ffunicode.c
+//
+//   Created by: Philip Smart, Oct 2026.
+//
+// This software is free to use by anyone for any purpose.
+//
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include "ff.h"
+#include "diskio.h"
+#include "dirlist.h"
+
+#define DISK_SECTORS  (64 * 2048)                                  // 64MB RAM disk.
+#define SECTOR_SIZE   512
+#define BENCH_DIR     "0:\\TAPES"
+#define BENCH_FILTER  "*.MZF"
+#define SUB_DIRS      40                                           // Sub-directories in the synthetic directory.
+#define OTHER_FILES   5                                            // Percentage of files which the filter excludes.
+
+// FatFS partition table as used on the tranZPUter, volume 0 is the first partition.
+//
+PARTITION VolToPart[FF_VOLUMES] = {
+    {0, 1},
+    {0, 2},
+    {0, 3},
+    {0, 4},
+};
+
+static uint8_t   *disk;
+static uint32_t  sectorReads;
+static FATFS     fatFs;
+
+// Heap and comparison counters, the calls are wrapped at link time so dirlist.c is measured unmodified.
+//
+static uint32_t  heapCalls;
+static int32_t   heapBlocks;
+static uint32_t  compares;
+
+void *__real_malloc(size_t);
+void *__real_realloc(void *, size_t);
+void __real_free(void *);
+int __real_strcasecmp(const char *, const char *);
+int __real_strncasecmp(const char *, const char *, size_t);
+
+void *__wrap_malloc(size_t size)                 { heapCalls++; heapBlocks++; return(__real_malloc(size)); }
+void *__wrap_realloc(void *ptr, size_t size)     { heapCalls++; if(ptr == NULL) heapBlocks++; return(__real_realloc(ptr, size)); }
+void __wrap_free(void *ptr)                      { if(ptr != NULL) heapBlocks--; __real_free(ptr); }
+int __wrap_strcasecmp(const char *a, const char *b)            { compares++; return(__real_strcasecmp(a, b)); }
+int __wrap_strncasecmp(const char *a, const char *b, size_t n) { compares++; return(__real_strncasecmp(a, b, n)); }
+
+// RAM disk driver.
+//
+DSTATUS disk_initialize(BYTE pdrv, BYTE cardtype) { return(pdrv == 0 ? 0 : STA_NOINIT); }
+DSTATUS disk_status(BYTE pdrv)                    { return(pdrv == 0 ? 0 : STA_NOINIT); }
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
+{
+    if(pdrv != 0 || sector + count > DISK_SECTORS) return(RES_PARERR);
+    memcpy(buff, disk + (size_t)sector * SECTOR_SIZE, (size_t)count * SECTOR_SIZE);
+    sectorReads += count;
+    return(RES_OK);
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
+{
+    if(pdrv != 0 || sector + count > DISK_SECTORS) return(RES_PARERR);
+    memcpy(disk + (size_t)sector * SECTOR_SIZE, buff, (size_t)count * SECTOR_SIZE);
+    return(RES_OK);
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
+{
+    switch(cmd)
+    {
+        case CTRL_SYNC:        return(RES_OK);
+        case GET_SECTOR_COUNT: *(DWORD *)buff = DISK_SECTORS; return(RES_OK);
+        case GET_SECTOR_SIZE:  *(WORD *)buff  = SECTOR_SIZE;  return(RES_OK);
+        case GET_BLOCK_SIZE:   *(DWORD *)buff = 1;            return(RES_OK);
+    }
+    return(RES_PARERR);
+}
+
+// FF_FS_NORTC is set, the timestamp comes from FF_NORTC_*, this is only used if it is changed.
+DWORD get_fattime(void) { return(0); }
+
+static double elapsedMs(struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return((now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_nsec - start->tv_nsec) / 1000000.0);
+}
+
+static void remount(void)
+{
+    f_mount(NULL, "0:", 0);
+    if(f_mount(&fatFs, "0:", 1) != FR_OK)
+    {
+        printf("Mount failed.\n");
+        exit(1);
+    }
+}
+
+static void resetCounters(void)
+{
+    sectorReads = heapCalls = compares = 0;
+}
+
+// The original list, a fixed table of separately allocated names.
+//
+typedef struct {
+    char     *name;
+    uint8_t  isDir;
+} t_legacyEntry;
+
+static t_legacyEntry *legacyEntries;
+static int           legacyMax;
+
+// The original EMZReadDirectory, filter, allocation and sort as they were less the debug print of every entry.
+//
+static int legacyRead(const char *path, const char *filter)
+{
+    int              dirCnt = 0;
+    int              idx, idx2, idx3;
+    DIR              dirFp;
+    static FILINFO   fno;
+
+    if(f_opendir(&dirFp, path) != FR_OK)
+        return(-1);
+    while(dirCnt < legacyMax)
+    {
+        if(f_readdir(&dirFp, &fno) != FR_OK || fno.fname[0] == 0) break;
+        if(strlen(fno.fname) == 0)
+            continue;
+        if(!(fno.fattrib & AM_DIR) && strcmp(fno.fname, ".") == 0)
+            continue;
+        const char *ext = strrchr(fno.fname, '.');
+        const char *filterExt = strrchr(filter, '.');
+        if(!(fno.fattrib & AM_DIR) && !(filterExt != NULL && strcmp(filterExt, ".*") == 0) && (ext == NULL || strcasecmp(++ext, (filterExt == NULL ? filter : ++filterExt)) != 0))
+            continue;
+        if((fno.fattrib & AM_DIR) && fno.fname[0] == '.')
+            continue;
+        if((legacyEntries[dirCnt].name = (char *)malloc(strlen(fno.fname)+1)) == NULL)
+            return(-1);
+        strcpy(legacyEntries[dirCnt].name, fno.fname);
+        legacyEntries[dirCnt].isDir = fno.fattrib & AM_DIR ? 1 : 0;
+        dirCnt++;
+    }
+    f_closedir(&dirFp);
+
+    for(idx=0; idx < legacyMax; idx++)
+    {
+        if(legacyEntries[idx].name == NULL)
+            continue;
+        for(idx2=0; idx2 < legacyMax; idx2++)
+        {
+            if(legacyEntries[idx2].name == NULL)
+                continue;
+            for(idx3=idx2+1; idx3 < legacyMax && legacyEntries[idx3].name == NULL; idx3++);
+            if(idx3 == legacyMax)
+                break;
+            if( (!legacyEntries[idx2].isDir && legacyEntries[idx3].isDir) ||
+                (((legacyEntries[idx2].isDir && legacyEntries[idx3].isDir) || (!legacyEntries[idx2].isDir && !legacyEntries[idx3].isDir)) && strcasecmp(legacyEntries[idx2].name, legacyEntries[idx3].name) > 0) )
+            {
+                t_legacyEntry temp   = legacyEntries[idx2];
+                legacyEntries[idx2] = legacyEntries[idx3];
+                legacyEntries[idx3] = temp;
+            }
+        }
+    }
+    return(dirCnt);
+}
+
+static void legacyRelease(void)
+{
+    for(int idx=0; idx < legacyMax; idx++)
+    {
+        if(legacyEntries[idx].name != NULL)
+        {
+            free(legacyEntries[idx].name);
+            legacyEntries[idx].name = NULL;
+        }
+    }
+}
+
+// The original hot key, first entry whose first character matches.
+//
+static int legacyFind(int entries, char key)
+{
+    for(int idx=0; idx < entries; idx++)
+    {
+        if((!legacyEntries[idx].isDir && legacyEntries[idx].name[0] == tolower(key)) || legacyEntries[idx].name[0] == toupper(key))
+            return(idx);
+    }
+    return(-1);
+}
+
+// Reference order, directories first then case insensitive name.
+//
+typedef struct {
+    char     name[FF_LFN_BUF + 1];
+    uint8_t  isDir;
+} t_refEntry;
+
+static int refCompare(const void *a, const void *b)
+{
+    const t_refEntry *ra = (const t_refEntry *)a;
+    const t_refEntry *rb = (const t_refEntry *)b;
+
+    if(ra->isDir != rb->isDir)
+        return(ra->isDir ? -1 : 1);
+    return(__real_strcasecmp(ra->name, rb->name));
+}
+
+// Create the synthetic directory in random order. Names share long leading parts as real collections do.
+//
+static int createDirectory(int entries, t_refEntry *ref)
+{
+    static const char *words[] = { "Space", "Invaders", "Galaxian", "Frogger", "Basic", "Pascal", "Monitor", "Sharp", "Tape", "Demo", "Utility", "Forth", "Adventure", "Chess", "Othello", "Defender" };
+    int               *order;
+    int               refCnt = 0;
+    char              name[FF_LFN_BUF + 1];
+    char              fqfn[FF_LFN_BUF + 16];
+    FIL               File;
+
+    if(f_mkdir(BENCH_DIR) != FR_OK || f_mkdir(BENCH_DIR "\\.hidden") != FR_OK)
+        return(-1);
+    order = (int *)__real_malloc(entries * sizeof(int));
+    for(int idx=0; idx < entries; idx++)
+        order[idx] = idx;
+    for(int idx=entries-1; idx > 0; idx--)
+    {
+        int swap = rand() % (idx + 1), temp = order[idx];
+        order[idx] = order[swap]; order[swap] = temp;
+    }
+    for(int idx=0; idx < entries; idx++)
+    {
+        int     fileNo = order[idx];
+        uint8_t isDir  = fileNo < SUB_DIRS;
+        uint8_t other  = !isDir && (fileNo % 100) < OTHER_FILES;
+
+        snprintf(name, sizeof(name), "%s%s %s %04d%s", (fileNo & 1) ? "" : "the ", words[fileNo % 16], words[(fileNo / 16) % 16], fileNo, isDir ? "" : (other ? ".dsk" : ((fileNo & 2) ? ".mzf" : ".MZF")));
+        if(fileNo % 7 == 0)
+            name[0] = toupper(name[0]);
+        snprintf(fqfn, sizeof(fqfn), "%s\\%s", BENCH_DIR, name);
+        if(isDir ? f_mkdir(fqfn) != FR_OK : (f_open(&File, fqfn, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK || f_close(&File) != FR_OK))
+        {
+            printf("Failed to create %s\n", fqfn);
+            return(-1);
+        }
+        if(!other)
+        {
+            strcpy(ref[refCnt].name, name);
+            ref[refCnt].isDir = isDir;
+            refCnt++;
+        }
+    }
+    __real_free(order);
+    qsort(ref, refCnt, sizeof(t_refEntry), refCompare);
+    return(refCnt);
+}
+
+int main(int argc, char *argv[])
+{
+    static uint8_t   work[FF_MAX_SS * 4];
+    static t_dirList dirList;
+    DWORD            plist[] = {100, 0, 0, 0};
+    struct timespec  start;
+    t_refEntry       *ref;
+    int              entries = 2000;
+    int              refCnt;
+    int              legacyCnt;
+    int              errors  = 0;
+    int              opt;
+    unsigned int     seed    = 1;
+    double           ms;
+    double           firstMs;
+    uint32_t         firstReads;
+    uint32_t         firstCompares;
+    uint32_t         firstCount;
+    int16_t          track;
+    char             trackName[FF_LFN_BUF + 1];
+    char             prefix[4];
+    uint32_t         searches;
+    uint32_t         examined;
+    int              found;
+
+    while((opt = getopt(argc, argv, "n:s:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n': entries = atoi(optarg); break;
+            case 's': seed    = atoi(optarg); break;
+            default:
+                printf("Usage: %s [-n <entries>] [-s <seed>]\n", argv[0]);
+                return(1);
+        }
+    }
+    if(entries <= SUB_DIRS || entries > DIRLIST_MAX_ENTRIES)
+    {
+        printf("Entries must be between %d and %d.\n", SUB_DIRS+1, DIRLIST_MAX_ENTRIES);
+        return(1);
+    }
+    srand(seed);
+
+    disk = (uint8_t *)calloc(DISK_SECTORS, SECTOR_SIZE);
+    ref  = (t_refEntry *)__real_malloc(entries * sizeof(t_refEntry));
+    if(disk == NULL || f_fdisk(0, plist, work) != FR_OK || f_mkfs("0:", FM_FAT32, 0, work, sizeof(work)) != FR_OK)
+    {
+        printf("Failed to create the FAT volume.\n");
+        return(1);
+    }
+    remount();
+    if((refCnt = createDirectory(entries, ref)) < 0)
+        return(1);
+    printf("Directory %s with %d entries, %d sub-directories, %d listed with filter %s.\n\n", BENCH_DIR, entries + 1, SUB_DIRS, refCnt, BENCH_FILTER);
+
+    // Original method.
+    legacyMax     = entries;
+    legacyEntries = (t_legacyEntry *)__real_malloc(legacyMax * sizeof(t_legacyEntry));
+    memset(legacyEntries, 0x00, legacyMax * sizeof(t_legacyEntry));
+    remount();
+    resetCounters();
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    legacyCnt = legacyRead(BENCH_DIR, BENCH_FILTER);
+    ms = elapsedMs(&start);
+    printf("legacy   list  %9.3f ms  reads %5u  compares %9u  heap calls %5u  blocks %5d\n", ms, sectorReads, compares, heapCalls, heapBlocks);
+    if(legacyCnt != refCnt)
+        errors++;
+    for(int idx=0; idx < legacyCnt && idx < refCnt; idx++)
+    {
+        if(strcmp(legacyEntries[idx].name, ref[idx].name) != 0 || legacyEntries[idx].isDir != ref[idx].isDir)
+            errors++;
+    }
+
+    // Directory list, first page then the remainder. An entry is selected after the first page as a user would.
+    remount();
+    resetCounters();
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if(dirListOpen(&dirList, BENCH_DIR, BENCH_FILTER) != FR_OK)
+    {
+        printf("dirListOpen failed.\n");
+        return(1);
+    }
+    firstMs       = elapsedMs(&start);
+    firstReads    = sectorReads;
+    firstCompares = compares;
+    firstCount    = dirList.count;
+    track         = dirList.count / 2;
+    strcpy(trackName, dirListName(&dirList, track));
+    while(dirList.scanning)
+    {
+        if(dirListScan(&dirList, &track) != FR_OK)
+        {
+            printf("dirListScan failed.\n");
+            return(1);
+        }
+    }
+    ms = elapsedMs(&start);
+    printf("dirlist  first %9.3f ms  reads %5u  compares %9u  entries %u\n", firstMs, firstReads, firstCompares, firstCount);
+    printf("dirlist  list  %9.3f ms  reads %5u  compares %9u  heap calls %5u  blocks %5d  arena %u/%u  index %u\n",
+           ms, sectorReads, compares, heapCalls, heapBlocks - legacyCnt, dirList.arenaUsed, dirList.arenaSize, dirList.capacity);
+    if(dirList.count != refCnt || dirList.dirs != SUB_DIRS)
+        errors++;
+    for(int idx=0; idx < dirList.count && idx < refCnt; idx++)
+    {
+        if(strcmp(dirListName(&dirList, idx), ref[idx].name) != 0 || dirListIsDir(&dirList, idx) != ref[idx].isDir)
+            errors++;
+    }
+    if(strcmp(dirListName(&dirList, track), trackName) != 0)
+    {
+        printf("Selected entry lost, %s now %s.\n", trackName, dirListName(&dirList, track));
+        errors++;
+    }
+
+    // Typed keys. The original could only jump on the first character.
+    examined = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(int idx=0; idx < legacyCnt; idx++)
+        examined += legacyFind(legacyCnt, legacyEntries[idx].name[0]) + 1;
+    ms = elapsedMs(&start);
+    printf("\nlegacy   key   %9.3f ms  %5d first character jumps, %.1f entries examined per jump\n", ms, legacyCnt, (double)examined / legacyCnt);
+
+    searches = 0;
+    resetCounters();
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(int idx=0; idx < refCnt; idx++)
+    {
+        for(int len=1; len <= 3; len++)
+        {
+            strncpy(prefix, ref[idx].name, len);
+            prefix[len] = 0;
+            dirListFind(&dirList, prefix);
+            searches++;
+        }
+    }
+    ms = elapsedMs(&start);
+    printf("dirlist  find  %9.3f ms  %5u prefix searches, %.1f compares per search\n", ms, searches, (double)compares / searches);
+
+    // Check every search against a linear scan of the list in display order.
+    for(int idx=0; idx < refCnt; idx++)
+    {
+        for(int len=1; len <= 3; len++)
+        {
+            strncpy(prefix, ref[idx].name, len);
+            prefix[len] = 0;
+            for(found=0; found < dirList.count && __real_strncasecmp(dirListName(&dirList, found), prefix, len) != 0; found++);
+            if(dirListFind(&dirList, prefix) != found)
+                errors++;
+        }
+    }
+    if(dirListFind(&dirList, "zzz") != -1)
+        errors++;
+
+    legacyRelease();
+    dirListRelease(&dirList);
+    printf("\nVerification: %s\n", errors ? "FAILED" : "ok");
+    return(errors ? 1 : 0);
+}
@@ -0,0 +1,427 @@
+// cachebench.c
+//
+// Host program to measure the sector cache in common/FatFS/diskio.c. The cache layer is compiled into this
+// program in front of a file backed disk image, the image taking the place of the SD card driver via the
+// disk_phys_xxx entry points, exactly as sdmmc_k64f.cpp sits beneath it on the K64F.
+//
+// The image is formatted with the zOS FatFS configuration and holds the files the tranZPUter services work on:
+// CP/M drive images, written interleaved so their cluster chains are fragmented as on a well used card, and a
+// directory of floppy images. A trace of service requests is then replayed, generated from a fixed seed so it
+// is identical on every run:
+//
+//   cpm read  - svcReadCPMDrive(), lseek to a track/sector of a CP/M drive and read 512 bytes.
+//   cpm write - svcWriteCPMDrive(), lseek, write 512 bytes and sync.
+//   floppy    - the floppy service, open an image by path, lseek to a sector, read 256 bytes and close.
+//   dir scan  - the directory cache, read every entry of the floppy image directory.
+//
+// The trace is run twice, with the cache in the path and with FatFS calling the image driver directly, each
+// starting from a freshly mounted volume. Hit rate, physical reads and writes and a modelled card time (the
+// per transaction and per sector costs set with -c/-s, microseconds) are reported. Every read is checked
+// against a shadow copy of the CP/M drives and the known floppy image contents, and after each run the CP/M
+// drives are read back in full to ensure all written sectors reached the image.
+//
+// Usage: cachebench [-n <requests>] [-c <cmd us>] [-s <sector us>]
+//
+// Build (from the repository root):
+//   gcc -O2 -Iinclude -Icommon/FatFS -o tools/cachebench tools/src/cachebench.c common/FatFS/ff.c common/FatFS/ffunicode.c
+//
+//   Created by: Philip Smart, Oct 2026.
+//
+// This software is free to use by anyone for any purpose.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "ff.h"
+#include "diskio.h"
+
+// The cache layer is built here whatever the target configuration, its disk_xxx entry points renamed so that
+// the calls FatFS makes can be routed through it or straight to the image.
+#undef  FF_USE_SECTOR_CACHE
+#define FF_USE_SECTOR_CACHE 1
+#define disk_initialize     cache_initialize
+#define disk_read           cache_read
+#define disk_write          cache_write
+#define disk_ioctl          cache_ioctl
+#include "../../common/FatFS/diskio.c"
+#undef  disk_initialize
+#undef  disk_read
+#undef  disk_write
+#undef  disk_ioctl
+
+#define DISK_SECTORS      (64 * 2048)                              // 64MB disk image.
+#define SECTOR_SIZE       512
+#define CPM_DRIVES        2
+#define CPM_DRIVE_SIZE    (1024 * 1024)                            // 1MB CP/M hard disk images.
+#define CPM_SECTORS       (CPM_DRIVE_SIZE / SECTOR_SIZE)
+#define FDD_IMAGES        48
+#define FDD_IMAGE_SIZE    (80 * 16 * 256)                          // 320KB, 80 tracks of 16 x 256 byte sectors.
+
+PARTITION VolToPart[FF_VOLUMES] = {
+    {0, 1},
+    {0, 2},
+    {0, 3},
+    {0, 4},
+};
+
+// Disk image and work counters.
+static int         diskFd     = -1;
+static int         useCache;
+static uint32_t    physReads;
+static uint32_t    physReadSectors;
+static uint32_t    physWrites;
+static uint32_t    physWriteSectors;
+static FATFS       fatFs;
+static uint8_t     cpmShadow[CPM_DRIVES][CPM_DRIVE_SIZE];
+
+// Model parameters and trace length.
+static uint32_t    cmdUs      = 120;
+static uint32_t    sectorUs   = 45;
+static uint32_t    requests   = 20000;
+
+static uint64_t nowNs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return((uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+
+// Same generator on every run so both passes replay an identical trace.
+static uint32_t rngState;
+static uint32_t rng(void) { rngState = rngState * 1103515245 + 12345; return((rngState >> 8) & 0xFFFFFF); }
+
+// Physical driver, the disk image. Each call is one card transaction whatever its sector count.
+//
+DSTATUS disk_phys_initialize(BYTE pdrv, BYTE cardtype) { return(pdrv == 0 ? 0 : STA_NOINIT); }
+
+DRESULT disk_phys_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
+{
+    if(pdrv != 0 || sector + count > DISK_SECTORS) return(RES_PARERR);
+    if(pread(diskFd, buff, (size_t)count * SECTOR_SIZE, (off_t)sector * SECTOR_SIZE) != (ssize_t)count * SECTOR_SIZE) return(RES_ERROR);
+    physReads++;
+    physReadSectors += count;
+    return(RES_OK);
+}
+
+DRESULT disk_phys_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
+{
+    if(pdrv != 0 || sector + count > DISK_SECTORS) return(RES_PARERR);
+    if(pwrite(diskFd, buff, (size_t)count * SECTOR_SIZE, (off_t)sector * SECTOR_SIZE) != (ssize_t)count * SECTOR_SIZE) return(RES_ERROR);
+    physWrites++;
+    physWriteSectors += count;
+    return(RES_OK);
+}
+
+DRESULT disk_phys_ioctl(BYTE pdrv, BYTE cmd, void *buff)
+{
+    switch(cmd)
+    {
+        case CTRL_SYNC:        return(RES_OK);
+        case GET_SECTOR_COUNT: *(DWORD *)buff = DISK_SECTORS; return(RES_OK);
+        case GET_SECTOR_SIZE:  *(WORD *)buff  = SECTOR_SIZE;  return(RES_OK);
+        case GET_BLOCK_SIZE:   *(DWORD *)buff = 1;            return(RES_OK);
+    }
+    return(RES_PARERR);
+}
+
+// The entry points FatFS calls, through the cache or direct to the image.
+//
+DSTATUS disk_initialize(BYTE pdrv, BYTE cardtype)                   { return(useCache ? cache_initialize(pdrv, cardtype) : disk_phys_initialize(pdrv, cardtype)); }
+DSTATUS disk_status(BYTE pdrv)                                      { return(pdrv == 0 ? 0 : STA_NOINIT); }
+DRESULT disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)  { return(useCache ? cache_read(pdrv, buff, sector, count) : disk_phys_read(pdrv, buff, sector, count)); }
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count) { return(useCache ? cache_write(pdrv, buff, sector, count) : disk_phys_write(pdrv, buff, sector, count)); }
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)                 { return(useCache ? cache_ioctl(pdrv, cmd, buff) : disk_phys_ioctl(pdrv, cmd, buff)); }
+
+DWORD get_fattime(void) { return(0); }
+
+static uint8_t fddByte(uint32_t image, uint32_t pos) { return((uint8_t)((pos * 7) ^ (pos >> 9) ^ (image * 31))); }
+
+static void fddName(char *name, uint32_t image) { sprintf(name, "0:\\FDD\\DISK%03u.DSK", image); }
+
+// Results of a run.
+typedef struct {
+    uint32_t          ops[4];
+    uint32_t          reads;
+    uint32_t          readSectors;
+    uint32_t          writes;
+    uint32_t          writeSectors;
+    DCACHE_STAT       stat;
+    double            modelUs;
+    double            hostUs;
+} t_result;
+
+// Replay the trace, checking every read against the expected contents.
+//
+static int run(int cache, t_result *res)
+{
+    FIL       cpmFile[CPM_DRIVES];
+    FIL       File;
+    DIR       dir;
+    FILINFO   fno;
+    char      name[32];
+    uint8_t   buf[SECTOR_SIZE];
+    UINT      size;
+    uint32_t  drive, sector, image, pos, entries;
+    uint64_t  startNs;
+    int       errors = 0;
+    FRESULT   fr;
+
+    memset(res, 0, sizeof(t_result));
+    useCache = cache;
+    rngState = 0x5EED;
+
+    // Remount so FatFS starts with an empty window and nothing is cached.
+    f_mount(NULL, "0:", 0);
+    if(useCache)
+        disk_ioctl(0, CTRL_CACHE_RESET, NULL);
+    if(f_mount(&fatFs, "0:", 1) != FR_OK)
+        return(1);
+    for(drive=0; drive < CPM_DRIVES; drive++)
+    {
+        sprintf(name, "0:\\CPM\\CPMDSK%02u.RAW", drive);
+        if(f_open(&cpmFile[drive], name, FA_OPEN_EXISTING | FA_READ | FA_WRITE) != FR_OK)
+            return(1);
+    }
+    physReads = physReadSectors = physWrites = physWriteSectors = 0;
+    startNs = nowNs();
+
+    for(uint32_t req=0; req < requests; req++)
+    {
+        uint32_t op = rng() % 100;
+        op = op < 65 ? 0 : op < 80 ? 1 : op < 97 ? 2 : 3;
+        res->ops[op]++;
+
+        switch(op)
+        {
+            case 0:
+                drive  = rng() % CPM_DRIVES;
+                sector = rng() % CPM_SECTORS;
+                fr = f_lseek(&cpmFile[drive], sector * SECTOR_SIZE);
+                if(!fr)
+                    fr = f_read(&cpmFile[drive], buf, SECTOR_SIZE, &size);
+                if(fr || size != SECTOR_SIZE || memcmp(buf, &cpmShadow[drive][sector * SECTOR_SIZE], SECTOR_SIZE) != 0)
+                {
+                    printf("  CP/M drive %u sector %u read back incorrectly.\n", drive, sector);
+                    errors++;
+                }
+                break;
+
+            case 1:
+                drive  = rng() % CPM_DRIVES;
+                sector = rng() % CPM_SECTORS;
+                for(pos=0; pos < SECTOR_SIZE; pos++)
+                    cpmShadow[drive][sector * SECTOR_SIZE + pos] = (uint8_t)(rng() >> 4);
+                fr = f_lseek(&cpmFile[drive], sector * SECTOR_SIZE);
+                if(!fr)
+                    fr = f_write(&cpmFile[drive], &cpmShadow[drive][sector * SECTOR_SIZE], SECTOR_SIZE, &size);
+                if(!fr)
+                    fr = f_sync(&cpmFile[drive]);
+                if(fr || size != SECTOR_SIZE)
+                {
+                    printf("  CP/M drive %u sector %u write failed, result %d.\n", drive, sector, fr);
+                    errors++;
+                }
+                break;
+
+            case 2:
+                image = rng() % FDD_IMAGES;
+                pos   = (rng() % (FDD_IMAGE_SIZE / 256)) * 256;
+                fddName(name, image);
+                fr = f_open(&File, name, FA_OPEN_EXISTING | FA_READ);
+                if(!fr)
+                    fr = f_lseek(&File, pos);
+                if(!fr)
+                    fr = f_read(&File, buf, 256, &size);
+                f_close(&File);
+                for(uint32_t idx=0; !fr && idx < 256; idx++)
+                {
+                    if(buf[idx] != fddByte(image, pos + idx))
+                        fr = FR_INT_ERR;
+                }
+                if(fr || size != 256)
+                {
+                    printf("  Floppy image %u offset %06x read back incorrectly.\n", image, pos);
+                    errors++;
+                }
+                break;
+
+            case 3:
+                entries = 0;
+                if(f_opendir(&dir, "0:\\FDD") == FR_OK)
+                {
+                    while(f_readdir(&dir, &fno) == FR_OK && fno.fname[0] != 0)
+                        entries++;
+                    f_closedir(&dir);
+                }
+                if(entries != FDD_IMAGES)
+                {
+                    printf("  Directory scan found %u images.\n", entries);
+                    errors++;
+                }
+                break;
+        }
+    }
+    for(drive=0; drive < CPM_DRIVES; drive++)
+        f_close(&cpmFile[drive]);
+    disk_ioctl(0, CTRL_SYNC, NULL);
+
+    res->hostUs       = (nowNs() - startNs) / 1000.0;
+    res->reads        = physReads;
+    res->readSectors  = physReadSectors;
+    res->writes       = physWrites;
+    res->writeSectors = physWriteSectors;
+    res->modelUs      = (physReads + physWrites) * (double)cmdUs + (physReadSectors + physWriteSectors) * (double)sectorUs;
+    if(useCache)
+    {
+        disk_ioctl(0, CTRL_CACHE_STAT, &res->stat);
+
+        // A remount must write out a sector held dirty rather than drop it. The last sector is beyond the files, it is restored after.
+        uint8_t check[SECTOR_SIZE];
+        if(disk_read(0, buf, DISK_SECTORS - 1, 1) == RES_OK)
+        {
+            for(pos=0; pos < SECTOR_SIZE; pos++)
+                check[pos] = (uint8_t)~buf[pos];
+            disk_write(0, check, DISK_SECTORS - 1, 1);
+            f_mount(NULL, "0:", 0);
+            if(f_mount(&fatFs, "0:", 1) != FR_OK || disk_phys_read(0, buf, DISK_SECTORS - 1, 1) != RES_OK || memcmp(buf, check, SECTOR_SIZE) != 0)
+            {
+                printf("  A sector held dirty in the cache was lost on remount.\n");
+                errors++;
+            }
+            for(pos=0; pos < SECTOR_SIZE; pos++)
+                buf[pos] = (uint8_t)~check[pos];
+            disk_phys_write(0, buf, DISK_SECTORS - 1, 1);
+        }
+    }
+
+    // Everything written must now be on the image, read the drives back with the cache out of the path.
+    useCache = 0;
+    f_mount(NULL, "0:", 0);
+    if(f_mount(&fatFs, "0:", 1) != FR_OK)
+        return(errors + 1);
+    for(drive=0; drive < CPM_DRIVES; drive++)
+    {
+        sprintf(name, "0:\\CPM\\CPMDSK%02u.RAW", drive);
+        fr = f_open(&File, name, FA_OPEN_EXISTING | FA_READ);
+        for(sector=0; !fr && sector < CPM_SECTORS; sector++)
+        {
+            fr = f_read(&File, buf, SECTOR_SIZE, &size);
+            if(!fr && (size != SECTOR_SIZE || memcmp(buf, &cpmShadow[drive][sector * SECTOR_SIZE], SECTOR_SIZE) != 0))
+                fr = FR_INT_ERR;
+        }
+        f_close(&File);
+        if(fr)
+        {
+            printf("  CP/M drive %u differs on the image at sector %u.\n", drive, sector - 1);
+            errors++;
+        }
+    }
+    return(errors);
+}
+
+static void report(const char *label, t_result *res, int cache)
+{
+    printf("%s\n", label);
+    printf("  Requests: %u cpm read, %u cpm write, %u floppy, %u dir scan\n", res->ops[0], res->ops[1], res->ops[2], res->ops[3]);
+    printf("  Physical reads  %7u (%u sectors)\n", res->reads, res->readSectors);
+    printf("  Physical writes %7u (%u sectors)\n", res->writes, res->writeSectors);
+    if(cache)
+    {
+        uint32_t lookups = res->stat.readHits + res->stat.readMisses;
+        printf("  Cache %ux%u, read hits %u misses %u (%.1f%%), write hits %u misses %u, write backs %u, bypass %u/%u\n",
+               res->stat.sets, res->stat.ways, res->stat.readHits, res->stat.readMisses, lookups ? res->stat.readHits * 100.0 / lookups : 0.0,
+               res->stat.writeHits, res->stat.writeMisses, res->stat.writeBacks, res->stat.bypassReads, res->stat.bypassWrites);
+    }
+    printf("  Model %.2f ms, host %.3f ms\n\n", res->modelUs / 1000.0, res->hostUs / 1000.0);
+}
+
+int main(int argc, char *argv[])
+{
+    static uint8_t work[FF_MAX_SS * 4];
+    DWORD          plist[] = {100, 0, 0, 0};
+    char           diskName[] = "/tmp/cachebenchXXXXXX";
+    char           name[32];
+    uint8_t        buf[SECTOR_SIZE];
+    FIL            cpmFile[CPM_DRIVES];
+    FIL            File;
+    UINT           writeSize;
+    t_result       direct, cached;
+    int            errors = 0;
+    int            opt;
+
+    while((opt = getopt(argc, argv, "n:c:s:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n': requests = atoi(optarg); break;
+            case 'c': cmdUs    = atoi(optarg); break;
+            case 's': sectorUs = atoi(optarg); break;
+            default:
+                printf("Usage: %s [-n <requests>] [-c <cmd us>] [-s <sector us>]\n", argv[0]);
+                return(1);
+        }
+    }
+
+    // Create the disk image, the volume and the files, formatted direct to the image.
+    //
+    diskFd = mkstemp(diskName);
+    if(diskFd < 0 || ftruncate(diskFd, (off_t)DISK_SECTORS * SECTOR_SIZE) != 0 || f_fdisk(0, plist, work) != FR_OK ||
+       f_mkfs("0:", FM_ANY, 0, work, sizeof(work)) != FR_OK || f_mount(&fatFs, "0:", 1) != FR_OK)
+    {
+        printf("Failed to create the FAT volume.\n");
+        return(1);
+    }
+    unlink(diskName);
+    f_mkdir("CPM");
+    f_mkdir("FDD");
+
+    // CP/M drives written a sector at a time in turn, so their clusters interleave.
+    for(uint32_t drive=0; drive < CPM_DRIVES; drive++)
+    {
+        sprintf(name, "0:\\CPM\\CPMDSK%02u.RAW", drive);
+        if(f_open(&cpmFile[drive], name, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+            return(1);
+        for(uint32_t pos=0; pos < CPM_DRIVE_SIZE; pos++)
+            cpmShadow[drive][pos] = (uint8_t)(pos ^ (pos >> 8) ^ (drive * 0x55));
+    }
+    for(uint32_t sector=0; sector < CPM_SECTORS; sector++)
+    {
+        for(uint32_t drive=0; drive < CPM_DRIVES; drive++)
+            f_write(&cpmFile[drive], &cpmShadow[drive][sector * SECTOR_SIZE], SECTOR_SIZE, &writeSize);
+    }
+    for(uint32_t drive=0; drive < CPM_DRIVES; drive++)
+        f_close(&cpmFile[drive]);
+
+    for(uint32_t image=0; image < FDD_IMAGES; image++)
+    {
+        fddName(name, image);
+        if(f_open(&File, name, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+            return(1);
+        for(uint32_t pos=0; pos < FDD_IMAGE_SIZE; pos += SECTOR_SIZE)
+        {
+            for(uint32_t byte=0; byte < SECTOR_SIZE; byte++)
+                buf[byte] = fddByte(image, pos + byte);
+            f_write(&File, buf, SECTOR_SIZE, &writeSize);
+        }
+        f_close(&File);
+    }
+
+    printf("%u requests, card %uus/transaction + %uus/sector.\n\n", requests, cmdUs, sectorUs);
+    errors += run(0, &direct);
+    report("Cache off:", &direct, 0);
+    errors += run(1, &cached);
+    report("Cache on:", &cached, 1);
+
+    printf("Physical reads %u -> %u (%.1fx fewer), writes %u -> %u, model %.2f ms -> %.2f ms (%.1fx).\n",
+           direct.reads, cached.reads, cached.reads ? (double)direct.reads / cached.reads : 0.0, direct.writes, cached.writes,
+           direct.modelUs / 1000.0, cached.modelUs / 1000.0, cached.modelUs > 0 ? direct.modelUs / cached.modelUs : 0.0);
+    printf("Verification: %s\n", errors ? "FAILED" : "ok");
+
+    close(diskFd);
+    return(errors ? 1 : 0);
+}
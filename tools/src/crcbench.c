@@ -0,0 +1,250 @@
+// crcbench.c
+//
+// Host program to measure the throughput of the CRC32 variants in common/crc32.c against the original word at
+// a time crc32_addword() and a bitwise reference, and to check they all produce the same result.
+//
+// The variants are compiled from common/crc32.c into separate objects with their functions renamed:
+//   s8     - slicing-by-8, the default build (8KB of tables).
+//   small  - CRC32_SMALL_TABLE, bytewise with a single 1KB table as used in the IOCP.
+//   s8be   - slicing-by-8 big endian path as built for the ZPU and 68000, word loads byte swapped to give big
+//            endian semantics on the host. Only its correctness is meaningful, the host pays for the swaps.
+//
+// Buffers are checksummed at several sizes and alignments, the rate is in MBytes/sec on the host, the ratios
+// between the variants being the figure of interest for the targets.
+//
+// Usage: crcbench [-m <MBytes per test>]
+//
+// Build (from the repository root):
+//   gcc -O2 -Iinclude -Dcrc32_init=crc32_init_s8 -Dcrc32_update=crc32_update_s8 -Dcrc32_addword=crc32_addword_s8 -c -o /tmp/crc_s8.o common/crc32.c
+//   gcc -O2 -Iinclude -Dcrc32_init=crc32_init_small -Dcrc32_update=crc32_update_small -Dcrc32_addword=crc32_addword_small -DCRC32_SMALL_TABLE -c -o /tmp/crc_small.o common/crc32.c
+//   gcc -O2 -Iinclude -Dcrc32_init=crc32_init_s8be -Dcrc32_update=crc32_update_s8be -Dcrc32_addword=crc32_addword_s8be -DCRC32_BIG_ENDIAN '-DCRC32_LOAD(p)=__builtin_bswap32(*(const uint32_t *)(p))' -c -o /tmp/crc_s8be.o common/crc32.c
+//   gcc -O2 -o tools/crcbench tools/src/crcbench.c /tmp/crc_s8.o /tmp/crc_small.o /tmp/crc_s8be.o
+//
+//   Created by: Philip Smart, Oct 2026.
+//
+// This software is free to use by anyone for any purpose.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_BUF       65536
+
+uint32_t crc32_init_s8(void);
+uint32_t crc32_update_s8(uint32_t, const void *, uint32_t);
+uint32_t crc32_addword_s8(uint32_t, uint32_t);
+uint32_t crc32_init_small(void);
+uint32_t crc32_update_small(uint32_t, const void *, uint32_t);
+uint32_t crc32_addword_small(uint32_t, uint32_t);
+uint32_t crc32_init_s8be(void);
+uint32_t crc32_update_s8be(uint32_t, const void *, uint32_t);
+uint32_t crc32_addword_s8be(uint32_t, uint32_t);
+
+// The original utils.c/simple_utils.c implementation, a word at a time most significant byte first.
+//
+static uint32_t legacyTable[256];
+
+static uint32_t legacy_init(void)
+{
+    uint32_t byte, crc, mask;
+    int      j;
+
+    for(byte = 0; byte <= 255; byte++)
+    {
+        crc = byte;
+        for (j = 7; j >= 0; j--)
+        {
+           mask = -(crc & 1);
+           crc = (crc >> 1) ^ (0xEDB88320 & mask);
+        }
+        legacyTable[byte] = crc;
+    }
+    return 0xFFFFFFFF;
+}
+
+static uint32_t legacy_addword(uint32_t crc_in, uint32_t word)
+{
+   crc_in = (crc_in >> 8) ^ legacyTable[(crc_in ^ ((word >> 24)&0xFF)) & 0xFF];
+   crc_in = (crc_in >> 8) ^ legacyTable[(crc_in ^ ((word >> 16)&0xFF)) & 0xFF];
+   crc_in = (crc_in >> 8) ^ legacyTable[(crc_in ^ ((word >>  8)&0xFF)) & 0xFF];
+   crc_in = (crc_in >> 8) ^ legacyTable[(crc_in ^ (word        &0xFF)) & 0xFF];
+   return crc_in;
+}
+
+// The IOCP fed the CRC one received word at a time, the word being assembled most significant byte first.
+//
+static uint32_t legacy_update(uint32_t crc, const void *buf, uint32_t len)
+{
+    const uint8_t *ptr = (const uint8_t *)buf;
+
+    for(; len >= 4; len -= 4, ptr += 4)
+        crc = legacy_addword(crc, ((uint32_t)ptr[0] << 24) | ((uint32_t)ptr[1] << 16) | ((uint32_t)ptr[2] << 8) | ptr[3]);
+    while(len--)
+        crc = (crc >> 8) ^ legacyTable[(crc ^ *ptr++) & 0xFF];
+    return crc;
+}
+
+// Bitwise reference.
+//
+static uint32_t reference(const uint8_t *ptr, uint32_t len)
+{
+    uint32_t crc = 0xFFFFFFFF;
+
+    while(len--)
+    {
+        crc ^= *ptr++;
+        for(int bit=0; bit < 8; bit++)
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+    return ~crc;
+}
+
+typedef struct {
+    const char  *name;
+    uint32_t    (*init)(void);
+    uint32_t    (*update)(uint32_t, const void *, uint32_t);
+    uint32_t    (*addword)(uint32_t, uint32_t);
+    uint32_t    tableBytes;
+} t_variant;
+
+static const t_variant variants[] = {
+    { "legacy addword", legacy_init,      legacy_update,      legacy_addword,      1024 },
+    { "small",          crc32_init_small, crc32_update_small, crc32_addword_small, 1024 },
+    { "slicing-by-8",   crc32_init_s8,    crc32_update_s8,    crc32_addword_s8,    8192 },
+    { "slicing-by-8 be",crc32_init_s8be,  crc32_update_s8be,  crc32_addword_s8be,  8192 },
+};
+#define NUM_VARIANTS  (sizeof(variants) / sizeof(variants[0]))
+
+static uint64_t nowNs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return((uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+
+// Check every variant against the reference over all lengths up to 64 bytes at each alignment, a long buffer
+// split into random chunks and the addword interface.
+//
+static int verify(const uint8_t *buf)
+{
+    int errors = 0;
+
+    for(uint32_t v=0; v < NUM_VARIANTS; v++)
+    {
+        const t_variant *var = &variants[v];
+        uint32_t        crc;
+
+        for(uint32_t align=0; align < 8; align++)
+        {
+            for(uint32_t len=0; len <= 64; len++)
+            {
+                crc = ~var->update(var->init(), buf + align, len);
+                if(crc != reference(buf + align, len))
+                {
+                    printf("%s: mismatch at alignment %u length %u\n", var->name, align, len);
+                    errors++;
+                }
+            }
+        }
+
+        crc = var->init();
+        for(uint32_t pos=0, chunk; pos < MAX_BUF; pos += chunk)
+        {
+            chunk = (rand() % 300) + 1;
+            if(pos + chunk > MAX_BUF)
+                chunk = MAX_BUF - pos;
+            crc = var->update(crc, buf + pos, chunk);
+        }
+        if(~crc != reference(buf, MAX_BUF))
+        {
+            printf("%s: mismatch over chunked buffer\n", var->name);
+            errors++;
+        }
+
+        crc = var->init();
+        for(uint32_t pos=0; pos < 1024; pos += 4)
+            crc = var->addword(crc, ((uint32_t)buf[pos] << 24) | ((uint32_t)buf[pos+1] << 16) | ((uint32_t)buf[pos+2] << 8) | buf[pos+3]);
+        if(~crc != reference(buf, 1024))
+        {
+            printf("%s: addword mismatch\n", var->name);
+            errors++;
+        }
+
+        if(~var->update(var->init(), "123456789", 9) != 0xCBF43926)
+        {
+            printf("%s: check value mismatch\n", var->name);
+            errors++;
+        }
+    }
+    return(errors);
+}
+
+int main(int argc, char *argv[])
+{
+    static const uint32_t sizes[] = { 16, 64, 512, 4096, MAX_BUF };
+    uint8_t               *buf;
+    uint32_t              mbytes  = 64;
+    uint32_t              crc;
+    uint32_t              check   = 0;
+    uint64_t              startNs;
+    double                secs;
+    double                base[sizeof(sizes) / sizeof(sizes[0])];
+    int                   errors;
+    int                   opt;
+
+    while((opt = getopt(argc, argv, "m:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'm': mbytes = atoi(optarg); break;
+            default:
+                printf("Usage: %s [-m <MBytes per test>]\n", argv[0]);
+                return(1);
+        }
+    }
+
+    buf = (uint8_t *)malloc(MAX_BUF + 8);
+    srand(1);
+    for(uint32_t idx=0; idx < MAX_BUF + 8; idx++)
+        buf[idx] = rand();
+
+    errors = verify(buf);
+    printf("Verification against bitwise reference: %s\n\n", errors ? "FAILED" : "ok");
+
+    printf("%-16s %6s", "variant", "table");
+    for(uint32_t s=0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+        printf("  %7u B (MB/s)", sizes[s]);
+    printf("\n");
+
+    for(uint32_t v=0; v < NUM_VARIANTS; v++)
+    {
+        const t_variant *var = &variants[v];
+
+        printf("%-16s %5uB", var->name, var->tableBytes);
+        for(uint32_t s=0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+        {
+            uint32_t loops = (uint32_t)(((uint64_t)mbytes * 1024 * 1024) / sizes[s]);
+            uint32_t start = var->init();
+
+            startNs = nowNs();
+            for(uint32_t loop=0; loop < loops; loop++)
+            {
+                crc    = var->update(start, buf, sizes[s]);
+                check += crc;
+            }
+            secs = (nowNs() - startNs) / 1e9;
+            if(v == 0)
+                base[s] = secs;
+            printf("  %7.1f (x%4.1f)", (double)mbytes / secs, base[s] / secs);
+        }
+        printf("\n");
+    }
+    printf("\n(checksum of results %08X)\n", check);
+
+    free(buf);
+    return(errors ? 1 : 0);
+}
@@ -0,0 +1,308 @@
+// dirbench.c
+//
+// Host program to measure the tranZPUter SD directory cache, common/dircache.c, against a synthetic FAT volume.
+//
+// A RAM disk is formatted with the zOS FatFS configuration and a directory of MZF files is created. The cache is
+// then built under several conditions, remounting the volume before each so FatFS starts with no state:
+//
+//   scan        - the original method, every MZF file opened to read its header, no index.
+//   cold        - dircache with no index file present, as scan plus writing the index.
+//   warm        - dircache with a current index, no MZF files opened.
+//   incremental - a few files changed, added and removed, only those opened and the index rewritten.
+//
+// Host time is reported along with the number of sector reads and writes, the sector counts are what matter
+// on the K64F where each SD sector read costs far more than the host processing. A modelled card time is
+// given using the per sector cost set with -r/-w (microseconds). After each build the cache is checked
+// against the scan to ensure the index never returns a stale header.
+//
+// Usage: dirbench [-n <files>] [-r <read us>] [-w <write us>]
+//
+// Build (from the repository root):
+//   gcc -O2 -Iinclude -Icommon/FatFS -o tools/dirbench tools/src/dirbench.c common/dircache.c common/FatFS/ff.c common/FatFS/ffunicode.c
+//
+//   Created by: Philip Smart, Oct 2026.
+//
+// This software is free to use by anyone for any purpose.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include "ff.h"
+#include "diskio.h"
+#include "tranzputer.h"
+#include "dircache.h"
+
+#define DISK_SECTORS  (64 * 2048)                                  // 64MB RAM disk.
+#define SECTOR_SIZE   512
+#define BENCH_DIR     "MZF"
+#define MZF_DATA_SIZE 2048                                         // Program bytes following each MZF header.
+
+// FatFS partition table as used on the tranZPUter, volume 0 is the first partition.
+//
+PARTITION VolToPart[FF_VOLUMES] = {
+    {0, 1},
+    {0, 2},
+    {0, 3},
+    {0, 4},
+};
+
+static uint8_t  *disk;
+static uint32_t sectorReads;
+static uint32_t sectorWrites;
+static FATFS    fatFs;
+static t_dirMap dirMap;
+
+// RAM disk driver.
+//
+DSTATUS disk_initialize(BYTE pdrv, BYTE cardtype) { return(pdrv == 0 ? 0 : STA_NOINIT); }
+DSTATUS disk_status(BYTE pdrv)                    { return(pdrv == 0 ? 0 : STA_NOINIT); }
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
+{
+    if(pdrv != 0 || sector + count > DISK_SECTORS) return(RES_PARERR);
+    memcpy(buff, disk + (size_t)sector * SECTOR_SIZE, (size_t)count * SECTOR_SIZE);
+    sectorReads += count;
+    return(RES_OK);
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
+{
+    if(pdrv != 0 || sector + count > DISK_SECTORS) return(RES_PARERR);
+    memcpy(disk + (size_t)sector * SECTOR_SIZE, buff, (size_t)count * SECTOR_SIZE);
+    sectorWrites += count;
+    return(RES_OK);
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
+{
+    switch(cmd)
+    {
+        case CTRL_SYNC:        return(RES_OK);
+        case GET_SECTOR_COUNT: *(DWORD *)buff = DISK_SECTORS; return(RES_OK);
+        case GET_SECTOR_SIZE:  *(WORD *)buff  = SECTOR_SIZE;  return(RES_OK);
+        case GET_BLOCK_SIZE:   *(DWORD *)buff = 1;            return(RES_OK);
+    }
+    return(RES_PARERR);
+}
+
+// FF_FS_NORTC is set, the timestamp comes from FF_NORTC_*, this is only used if it is changed.
+DWORD get_fattime(void) { return(0); }
+
+static double elapsedMs(struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return((now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_nsec - start->tv_nsec) / 1000000.0);
+}
+
+static void remount(void)
+{
+    f_mount(NULL, "0:", 0);
+    if(f_mount(&fatFs, "0:", 1) != FR_OK)
+    {
+        printf("Mount failed.\n");
+        exit(1);
+    }
+}
+
+// Write an MZF file, the Sharp name embeds the sequence number and generation so a changed file has a different header.
+//
+static void writeMzf(int fileNo, int generation)
+{
+    char     fqfn[64];
+    uint8_t  buf[128 + MZF_DATA_SIZE];
+    FIL      File;
+    UINT     writeSize;
+
+    memset(buf, 0x00, sizeof(buf));
+    buf[0] = 0x01;
+    snprintf((char *)&buf[1], MZF_FILENAME_LEN, "GAME %03d G%d", fileNo, generation);
+    buf[1 + strlen((char *)&buf[1])] = 0x0D;
+    buf[18] = MZF_DATA_SIZE & 0xFF; buf[19] = MZF_DATA_SIZE >> 8;
+    buf[20] = 0x00;                 buf[21] = 0x12;
+    buf[22] = 0x00;                 buf[23] = 0x12;
+    for(int idx=128; idx < (int)sizeof(buf); idx++)
+        buf[idx] = (uint8_t)(idx * fileNo + generation);
+
+    snprintf(fqfn, sizeof(fqfn), "0:\\%s\\Sharp Game Number %03d.mzf", BENCH_DIR, fileNo);
+    if(f_open(&File, fqfn, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK || f_write(&File, buf, sizeof(buf) - (generation & 1), &writeSize) != FR_OK || f_close(&File) != FR_OK)
+    {
+        printf("Failed to write %s\n", fqfn);
+        exit(1);
+    }
+}
+
+// The original cache method, open every file and read its header. Returns the headers in readdir order.
+//
+static int scanDir(t_svcCmpDirEnt *hdr, char names[][FF_LFN_BUF + 1])
+{
+    char     fqfn[FF_LFN_BUF + 13];
+    DIR      dirFp;
+    FILINFO  fno;
+    FIL      File;
+    UINT     readSize;
+    int      fileNo = 0;
+
+    if(f_opendir(&dirFp, BENCH_DIR) != FR_OK) return(-1);
+    while(fileNo < TZSVC_MAX_DIR_ENTRIES && f_readdir(&dirFp, &fno) == FR_OK && fno.fname[0] != 0)
+    {
+        const char *ext = strrchr(fno.fname, '.');
+        if(!ext || strcasecmp(ext+1, TZSVC_DEFAULT_MZF_EXT) != 0)
+            continue;
+
+        sprintf(fqfn, "0:\\%s\\%s", BENCH_DIR, fno.fname);
+        if(f_open(&File, fqfn, FA_OPEN_EXISTING | FA_READ) != FR_OK) return(-1);
+        f_read(&File, &hdr[fileNo], TZSVC_CMPHDR_SIZE, &readSize);
+        f_close(&File);
+        if(readSize == TZSVC_CMPHDR_SIZE)
+        {
+            strcpy(names[fileNo], fno.fname);
+            fileNo++;
+        }
+    }
+    f_closedir(&dirFp);
+    return(fileNo);
+}
+
+// Build the cache, report and verify it against a fresh scan.
+//
+static int runBuild(const char *label, int useScan, double readUs, double writeUs)
+{
+    static t_svcCmpDirEnt hdr[TZSVC_MAX_DIR_ENTRIES];
+    static char           names[TZSVC_MAX_DIR_ENTRIES][FF_LFN_BUF + 1];
+    struct timespec       start;
+    t_dirCacheStats       stats;
+    FRESULT               result;
+    double                ms;
+    int                   entries;
+    int                   errors = 0;
+
+    remount();
+    sectorReads = sectorWrites = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if(useScan)
+    {
+        entries = scanDir(hdr, names);
+        result  = entries < 0 ? FR_DISK_ERR : FR_OK;
+    } else
+    {
+        result  = dirCacheBuild(&dirMap, BENCH_DIR, MZF);
+    }
+    ms = elapsedMs(&start);
+    if(result != FR_OK)
+    {
+        printf("%-12s failed, result=%d\n", label, result);
+        return(1);
+    }
+
+    printf("%-12s %8.3f ms  reads %6u  writes %5u  card %8.1f ms", label, ms, sectorReads, sectorWrites, (sectorReads * readUs + sectorWrites * writeUs) / 1000.0);
+    if(!useScan)
+    {
+        dirCacheGetStats(&stats);
+        printf("  entries %3u reused %3u opened %3u index %s%s arena %u", stats.entries, stats.reused, stats.scanned,
+               stats.indexLoaded ? "loaded" : "none", stats.indexWritten ? "+written" : "", stats.arenaSize);
+
+        // Verify against the direct method.
+        remount();
+        entries = scanDir(hdr, names);
+        if(entries != dirMap.entries)
+            errors++;
+        for(int idx=0; idx < entries && idx < dirMap.entries; idx++)
+        {
+            if(strcmp(names[idx], (char *)dirMap.mzfFile[idx]->sdFileName) != 0 || memcmp(&hdr[idx], &dirMap.mzfFile[idx]->mzfHeader, TZSVC_CMPHDR_SIZE) != 0)
+                errors++;
+        }
+        printf("  %s", errors ? "MISMATCH" : "ok");
+    }
+    printf("\n");
+    return(errors);
+}
+
+int main(int argc, char *argv[])
+{
+    static uint8_t work[FF_MAX_SS * 4];
+    DWORD          plist[] = {100, 0, 0, 0};
+    double         readUs  = 250.0;
+    double         writeUs = 1000.0;
+    int            files   = 500;
+    int            errors  = 0;
+    int            opt;
+    char           fqfn[64];
+
+    while((opt = getopt(argc, argv, "n:r:w:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n': files   = atoi(optarg); break;
+            case 'r': readUs  = atof(optarg); break;
+            case 'w': writeUs = atof(optarg); break;
+            default:
+                printf("Usage: %s [-n <files>] [-r <read us>] [-w <write us>]\n", argv[0]);
+                return(1);
+        }
+    }
+
+    // Create the volume, the directory and the files. Additional files beyond the cache limit are created so
+    // the directory is as large as requested even though only the first TZSVC_MAX_DIR_ENTRIES are cached.
+    //
+    disk = (uint8_t *)calloc(DISK_SECTORS, SECTOR_SIZE);
+    if(disk == NULL || f_fdisk(0, plist, work) != FR_OK || f_mkfs("0:", FM_FAT32, 0, work, sizeof(work)) != FR_OK)
+    {
+        printf("Failed to create the FAT volume.\n");
+        return(1);
+    }
+    remount();
+    f_mkdir(BENCH_DIR);
+    for(int idx=0; idx < files; idx++)
+        writeMzf(idx, 0);
+    for(int idx=0; idx < 8; idx++)
+    {
+        FIL File;
+        snprintf(fqfn, sizeof(fqfn), "0:\\%s\\LISTING%d.BAS", BENCH_DIR, idx);
+        f_open(&File, fqfn, FA_CREATE_ALWAYS | FA_WRITE);
+        f_close(&File);
+    }
+    printf("Volume with %d MZF files in 0:\\%s, read %.0fus/sector write %.0fus/sector.\n\n", files, BENCH_DIR, readUs, writeUs);
+
+    errors += runBuild("scan",        1, readUs, writeUs);
+    errors += runBuild("cold",        0, readUs, writeUs);
+    errors += runBuild("warm",        0, readUs, writeUs);
+
+    // Change a few files, their size changes with the generation so the index entries are stale, remove one and
+    // replace another with a file of a different name.
+    remount();
+    for(int idx=10; idx < 15; idx++)
+        writeMzf(idx, 1);
+    snprintf(fqfn, sizeof(fqfn), "0:\\%s\\Sharp Game Number %03d.mzf", BENCH_DIR, 20);
+    f_unlink(fqfn);
+    snprintf(fqfn, sizeof(fqfn), "0:\\%s\\Sharp Game Number %03d.mzf", BENCH_DIR, 30);
+    f_unlink(fqfn);
+    writeMzf(files, 1);
+    errors += runBuild("incremental", 0, readUs, writeUs);
+    errors += runBuild("warm",        0, readUs, writeUs);
+
+    // A corrupt index must be ignored and replaced.
+    remount();
+    {
+        FIL File;
+        UINT writeSize;
+        snprintf(fqfn, sizeof(fqfn), "0:\\%s\\%s", BENCH_DIR, DIRCACHE_INDEX_NAME);
+        f_open(&File, fqfn, FA_OPEN_EXISTING | FA_WRITE);
+        f_lseek(&File, 100);
+        f_write(&File, "XX", 2, &writeSize);
+        f_truncate(&File);
+        f_close(&File);
+    }
+    errors += runBuild("corrupt",     0, readUs, writeUs);
+    errors += runBuild("warm",        0, readUs, writeUs);
+
+    dirCacheFree(&dirMap);
+    free(disk);
+    printf("\n%s\n", errors ? "FAILED" : "All builds verified.");
+    return(errors ? 1 : 0);
+}
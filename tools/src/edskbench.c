@@ -0,0 +1,493 @@
+// edskbench.c
+//
+// Host program to compare the location of sectors in EDSK floppy images as EMZProcessFDDRequest() did it, walking
+// the track size table a byte per f_read() on every track or side change then the Sector Information List eight
+// bytes per f_read(), against the index built once at mount time by common/edsk.c.
+//
+// The SD card is a disk image file on the host, formatted with the zOS FatFS configuration, holding a set of
+// sample EDSK images:
+//
+//   MZ800DD  - 80 tracks, 2 sides, 16 x 256 byte sectors numbered 1-16, the MZ-800 double density format.
+//   CPC9X512 - 40 tracks, 1 side, 9 x 512 byte sectors C1-C9 in an interleaved order.
+//   MIXED    - 42 tracks, 2 sides, alternating 5 x 1024 and 10 x 512 byte tracks, the TIB sector count under
+//              reported on some tracks and the last two tracks missing from the image.
+//
+// A sector access trace is generated for each image from a fixed seed, as the FDC issues them: runs of sectors on
+// a track, steps to the next track, seeks, side changes, and requests for sectors and tracks which do not exist.
+// The trace is replayed through both methods, each followed by the seek and read of the sector data itself. The
+// two must return the same result, offset and size for every request and the data read must be that written for
+// the track, side and sector.
+//
+// Per request cost is reported as the FatFS calls made, card reads and host time, with a modelled K64F time from
+// a cost per FatFS call and per card read set on the command line in microseconds.
+//
+// Usage: edskbench [-n <requests>] [-f <fatfs call us>] [-c <card read us>]
+//
+// Build (from the repository root):
+//   gcc -O2 -Iinclude -Icommon/FatFS -o tools/edskbench tools/src/edskbench.c common/edsk.c common/FatFS/ff.c common/FatFS/ffunicode.c
+//
+//   Created by: Philip Smart, Oct 2026.
+//
+// This software is free to use by anyone for any purpose.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "ff.h"
+#include "diskio.h"
+#include "edsk.h"
+
+#define DISK_SECTORS  (64 * 2048)                                  // 64MB disk image.
+#define SECTOR_SIZE   512
+#define MAX_IMAGE     (1024 * 1024)                                // Largest sample EDSK image.
+
+PARTITION VolToPart[FF_VOLUMES] = {
+    {0, 1},
+    {0, 2},
+    {0, 3},
+    {0, 4},
+};
+
+// Sample image geometry. A track is either of the A or B format, chosen by the track number when alternate is set.
+//
+typedef struct {
+    const char        *file;
+    uint8_t           tracks;
+    uint8_t           sides;
+    uint8_t           alternate;                                   // Odd tracks use the B format.
+    uint8_t           sectorsA, sizeCodeA;
+    uint8_t           sectorsB, sizeCodeB;
+    uint8_t           firstId;
+    uint8_t           interleave;                                  // Sector IDs listed in interleaved order.
+    uint8_t           missing;                                     // Number of tracks at the end absent from the image.
+    uint8_t           tibUnder;                                    // TIB sector count under reported on every fourth track.
+} t_image;
+
+static const t_image images[] = {
+    { "0:\\FDD\\MZ800DD.DSK",  80, 2, 0, 16, 1, 16, 1, 0x01, 0, 0, 0 },
+    { "0:\\FDD\\CPC9X512.DSK", 40, 1, 0,  9, 2,  9, 2, 0xC1, 1, 0, 0 },
+    { "0:\\FDD\\MIXED.DSK",    42, 2, 1, 10, 2,  5, 3, 0x01, 0, 2, 1 },
+};
+#define NIMAGES       (sizeof(images) / sizeof(t_image))
+
+// Model parameters and trace length.
+static uint32_t    callUs     = 25;
+static uint32_t    cardUs     = 165;
+static uint32_t    requests   = 20000;
+
+// Disk image and work counters.
+static int         diskFd     = -1;
+static uint32_t    cardReads;
+static uint32_t    fatCalls;
+static FATFS       fatFs;
+
+static uint64_t nowNs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return((uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+
+static uint32_t rngState;
+static uint32_t rng(void) { rngState = rngState * 1103515245 + 12345; return((rngState >> 8) & 0xFFFFFF); }
+
+// Disk image driver, each call is one card transaction whatever its sector count.
+//
+DSTATUS disk_initialize(BYTE pdrv, BYTE cardtype) { return(pdrv == 0 ? 0 : STA_NOINIT); }
+DSTATUS disk_status(BYTE pdrv)                    { return(pdrv == 0 ? 0 : STA_NOINIT); }
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
+{
+    if(pdrv != 0 || sector + count > DISK_SECTORS) return(RES_PARERR);
+    if(pread(diskFd, buff, (size_t)count * SECTOR_SIZE, (off_t)sector * SECTOR_SIZE) != (ssize_t)count * SECTOR_SIZE) return(RES_ERROR);
+    cardReads++;
+    return(RES_OK);
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
+{
+    if(pdrv != 0 || sector + count > DISK_SECTORS) return(RES_PARERR);
+    if(pwrite(diskFd, buff, (size_t)count * SECTOR_SIZE, (off_t)sector * SECTOR_SIZE) != (ssize_t)count * SECTOR_SIZE) return(RES_ERROR);
+    return(RES_OK);
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
+{
+    switch(cmd)
+    {
+        case CTRL_SYNC:        return(RES_OK);
+        case GET_SECTOR_COUNT: *(DWORD *)buff = DISK_SECTORS; return(RES_OK);
+        case GET_SECTOR_SIZE:  *(WORD *)buff  = SECTOR_SIZE;  return(RES_OK);
+        case GET_BLOCK_SIZE:   *(DWORD *)buff = 1;            return(RES_OK);
+    }
+    return(RES_PARERR);
+}
+
+DWORD get_fattime(void) { return(0); }
+
+// FatFS calls made by the sector location, counted as each costs the K64F far more than the host.
+static FRESULT benchLseek(FIL *fp, FSIZE_t ofs)                     { fatCalls++; return(f_lseek(fp, ofs)); }
+static FRESULT benchRead(FIL *fp, void *buff, UINT btr, UINT *br)   { fatCalls++; return(f_read(fp, buff, btr, br)); }
+
+// Sector data, unique to the track, side and sector so a read from the wrong place is detected.
+static uint8_t sectorByte(uint16_t trackIdx, uint8_t sectorId, uint32_t pos) { return((uint8_t)((trackIdx * 7) ^ (sectorId * 13) ^ (pos * 3) ^ (pos >> 8))); }
+
+// Build an EDSK image in memory as described by the geometry.
+//
+static uint32_t makeImage(const t_image *img, uint8_t *buf)
+{
+    uint16_t noTracks = img->tracks * img->sides;
+    uint32_t offset   = EDSK_DIB_SIZE;
+
+    memset(buf, 0, EDSK_DIB_SIZE);
+    memcpy(buf, "EXTENDED CPC DSK File\r\nDisk-Info\r\n", 34);
+    memcpy(buf + 0x22, "edskbench     ", 14);
+    buf[EDSK_DIB_TRACKS] = img->tracks;
+    buf[EDSK_DIB_SIDES]  = img->sides;
+
+    for(uint16_t trackIdx = 0; trackIdx < noTracks; trackIdx++)
+    {
+        uint8_t  track    = trackIdx / img->sides;
+        uint8_t  formatB  = img->alternate && (track & 1);
+        uint8_t  sectors  = formatB ? img->sectorsB : img->sectorsA;
+        uint8_t  sizeCode = formatB ? img->sizeCodeB : img->sizeCodeA;
+        uint32_t size     = 128 << sizeCode;
+        uint32_t length   = (EDSK_TIB_SIZE + sectors * size + 0xFF) & ~0xFF;
+        uint8_t  *tib     = buf + offset;
+
+        if(track >= img->tracks - img->missing)
+        {
+            buf[EDSK_DIB_TRACK_SIZES + trackIdx] = 0;
+            continue;
+        }
+        buf[EDSK_DIB_TRACK_SIZES + trackIdx] = length >> 8;
+        memset(tib, 0, length);
+        memcpy(tib, "Track-Info\r\n", 12);
+        tib[0x10] = track;
+        tib[0x11] = trackIdx % img->sides;
+        tib[0x14] = sizeCode;
+        tib[EDSK_TIB_SECTORS] = (img->tibUnder && (track % 4) == 1) ? sectors - 1 : sectors;
+        tib[0x16] = 0x4E;
+        tib[0x17] = 0xE5;
+        for(uint8_t sdx = 0; sdx < sectors; sdx++)
+        {
+            uint8_t *sil = tib + EDSK_TIB_SIL + (sdx * EDSK_SIL_ENTRY_SIZE);
+            uint8_t id   = img->firstId + (img->interleave ? ((sdx / 2) + (sdx & 1 ? (sectors + 1) / 2 : 0)) : sdx);
+
+            sil[0] = track;
+            sil[1] = trackIdx % img->sides;
+            sil[EDSK_SIL_SECTOR_ID]   = id;
+            sil[EDSK_SIL_SECTOR_SIZE] = sizeCode;
+            sil[6] = size & 0xFF;
+            sil[7] = size >> 8;
+            for(uint32_t pos = 0; pos < size; pos++)
+                tib[EDSK_TIB_SIZE + (sdx * size) + pos] = sectorByte(trackIdx, id, pos);
+        }
+        offset += length;
+    }
+    return(offset);
+}
+
+// Per drive state of the original method, the track located by the last request.
+//
+typedef struct {
+    uint8_t           lastTrack;
+    uint8_t           lastSide;
+    uint32_t          trackOffset;
+    uint32_t          trackLen;
+    uint8_t           sectorCount;
+} t_legacy;
+
+// The sector location EMZProcessFDDRequest() used, the track size table walked on a track or side change then the SIL read
+// an entry at a time. Diagnostic output removed, otherwise as it was.
+//
+static uint8_t legacyLocate(FIL *fp, t_legacy *st, uint8_t noSides, uint8_t trackNo, uint8_t side, uint8_t sectorNo, uint32_t *offset, uint32_t *size)
+{
+    uint8_t   sectorBuffer[8];
+    uint32_t  sectorOffset;
+    uint32_t  thisSectorSize = 0;
+    UINT      actualReadSize;
+    uint16_t  idx;
+    FRESULT   result;
+
+    if(trackNo != st->lastTrack || side != st->lastSide)
+    {
+        result = benchLseek(fp, 0x34);
+        if(result)
+            return(EDSK_TRACK_NOT_FOUND);
+
+        st->trackLen    = 0x0100;
+        st->trackOffset = 0x00000000;
+        for(idx = 0; idx == 0 || idx <= (trackNo * noSides)+side; idx++)
+        {
+            result = benchRead(fp, &sectorBuffer, 1, &actualReadSize);
+            if(actualReadSize != 1)
+                return(EDSK_TRACK_NOT_FOUND);
+
+            // Bug on HD images, track reports 0x25 sectors but this is only applicable for the first track.
+            if(idx > 0 && sectorBuffer[0] == 0x25) sectorBuffer[0] = 0x11;
+
+            st->trackOffset += st->trackLen;
+            st->trackLen = (uint32_t)sectorBuffer[0] * 0x100;
+        }
+        if(sectorBuffer[0] == 0x00)
+        {
+            // The original returned here with the track offset overwritten but the last track unchanged, so a following request on that
+            // track used the wrong offset. Forget the track so the comparison is of the location method alone.
+            st->lastTrack = 0xff;
+            return(EDSK_TRACK_NOT_FOUND);
+        }
+        uint8_t sectorCountFromTIB = sectorBuffer[0];
+
+        result = benchLseek(fp, st->trackOffset + 0x14);
+        if(!result)
+            result = benchRead(fp, &sectorBuffer, 2, &actualReadSize);
+        if(result)
+            return(EDSK_TRACK_NOT_FOUND);
+        st->sectorCount = (uint8_t)sectorCountFromTIB > (uint8_t)sectorBuffer[1] ? (uint8_t)sectorCountFromTIB : (uint8_t)sectorBuffer[1];
+
+        st->lastTrack = trackNo;
+        st->lastSide  = side;
+    }
+
+    sectorOffset = st->trackOffset;
+    uint32_t offsetLimit = sectorOffset + st->trackLen;
+
+    result = benchLseek(fp, sectorOffset + 0x18);
+    for(idx = 1; idx <= st->sectorCount && sectorOffset < offsetLimit; idx++)
+    {
+        if(!result) result = benchRead(fp, &sectorBuffer, 8, &actualReadSize);
+        if(result)
+            return(EDSK_SECTOR_NOT_FOUND);
+
+        thisSectorSize = sectorBuffer[3] == 0x00 ? 128 : sectorBuffer[3] == 0x01 ? 256 : sectorBuffer[3] == 0x02 ? 512 : 1024;
+        if(sectorBuffer[2] == sectorNo)
+            break;
+        sectorOffset += thisSectorSize;
+    }
+    sectorOffset += 0x100;
+    if(idx == st->sectorCount+1 || sectorOffset >= offsetLimit)
+        return(EDSK_SECTOR_NOT_FOUND);
+
+    *offset = sectorOffset;
+    *size   = thisSectorSize;
+    return(EDSK_OK);
+}
+
+// A request of the trace.
+typedef struct {
+    uint8_t           track;
+    uint8_t           side;
+    uint8_t           sectorNo;
+} t_request;
+
+// Generate the trace for an image, runs of sectors with steps and seeks as a disk operating system reads a disk.
+//
+static void makeTrace(const t_image *img, t_request *trace)
+{
+    uint8_t  track = 0;
+    uint8_t  side  = 0;
+    uint8_t  run   = 0;
+    uint8_t  next  = 0;
+    uint8_t  sectors;
+
+    rngState = 0xED5C;
+    for(uint32_t req = 0; req < requests; req++)
+    {
+        sectors = img->alternate && (track & 1) ? img->sectorsB : img->sectorsA;
+        if(run == 0)
+        {
+            uint32_t act = rng() % 100;
+
+            if(act < 50)      { if(img->sides > 1 && side == 0) side = 1; else { side = 0; track = (track + 1) % img->tracks; } }
+            else if(act < 80) { track = rng() % img->tracks; side = rng() % img->sides; }
+            else if(act < 90) { side = rng() % img->sides; }
+            else if(act < 95) { track = img->tracks + (rng() % 4); }
+            sectors = img->alternate && (track & 1) ? img->sectorsB : img->sectorsA;
+            run  = 1 + rng() % sectors;
+            next = rng() % sectors;
+        }
+        trace[req].track    = track;
+        trace[req].side     = side;
+        trace[req].sectorNo = (rng() % 50) == 0 ? 0xEE : img->firstId + (next % sectors);
+        next++;
+        run--;
+    }
+}
+
+// Totals for a replay.
+typedef struct {
+    uint32_t          found;
+    uint32_t          notFound;
+    uint32_t          calls;
+    uint32_t          cardReads;
+    double            hostUs;
+} t_totals;
+
+int main(int argc, char *argv[])
+{
+    static uint8_t work[FF_MAX_SS * 4];
+    static uint8_t image[MAX_IMAGE];
+    DWORD          plist[] = {100, 0, 0, 0};
+    char           diskName[] = "/tmp/edskbenchXXXXXX";
+    uint8_t        buf[1024];
+    FIL            File;
+    UINT           size;
+    t_request      *trace;
+    t_edskIndex    *index;
+    t_legacy       legacy;
+    t_totals       old, idx, allOld = {0}, allIdx = {0};
+    uint32_t       imageSize;
+    uint32_t       offsetOld = 0, sizeOld = 0, offsetIdx = 0, sizeIdx = 0;
+    uint8_t        resOld, resIdx;
+    uint64_t       startNs;
+    int            errors = 0;
+    int            opt;
+
+    while((opt = getopt(argc, argv, "n:f:c:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n': requests = atoi(optarg); break;
+            case 'f': callUs   = atoi(optarg); break;
+            case 'c': cardUs   = atoi(optarg); break;
+            default:
+                printf("Usage: %s [-n <requests>] [-f <fatfs call us>] [-c <card read us>]\n", argv[0]);
+                return(1);
+        }
+    }
+    trace = (t_request *)malloc(requests * sizeof(t_request));
+
+    // Create the disk image, the volume and the sample EDSK files.
+    //
+    diskFd = mkstemp(diskName);
+    if(trace == NULL || diskFd < 0 || ftruncate(diskFd, (off_t)DISK_SECTORS * SECTOR_SIZE) != 0 || f_fdisk(0, plist, work) != FR_OK ||
+       f_mkfs("0:", FM_ANY, 0, work, sizeof(work)) != FR_OK || f_mount(&fatFs, "0:", 1) != FR_OK)
+    {
+        printf("Failed to create the FAT volume.\n");
+        return(1);
+    }
+    unlink(diskName);
+    f_mkdir("FDD");
+    for(uint32_t img = 0; img < NIMAGES; img++)
+    {
+        imageSize = makeImage(&images[img], image);
+        if(f_open(&File, images[img].file, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK || f_write(&File, image, imageSize, &size) != FR_OK || size != imageSize)
+            return(1);
+        f_close(&File);
+    }
+
+    printf("%u requests per image, %uus/FatFS call, %uus/card read.\n\n", requests, callUs, cardUs);
+    printf("%-12s %-7s %8s %8s %10s %10s %11s %12s\n", "Image", "Method", "Found", "Missing", "Calls/req", "Reads/req", "Host us/req", "Model us/req");
+    for(uint32_t img = 0; img < NIMAGES; img++)
+    {
+        const t_image *im = &images[img];
+
+        makeTrace(im, trace);
+        memset(&old, 0, sizeof(t_totals));
+        memset(&idx, 0, sizeof(t_totals));
+        memset(&legacy, 0xff, sizeof(t_legacy));
+        if(f_open(&File, im->file, FA_OPEN_EXISTING | FA_READ) != FR_OK)
+            return(1);
+
+        // Index at mount, its cost is reported separately as it is paid once.
+        fatCalls = cardReads = 0;
+        startNs  = nowNs();
+        index    = edskBuildIndex(&File);
+        printf("%-12s index   %u tracks, %u sectors, %u bytes, %u card reads, %.1f us\n", im->file + 7, index ? index->noTracks : 0, index ? index->noSectors : 0,
+               index ? (unsigned)(sizeof(t_edskIndex) + index->noTracks * sizeof(t_edskTrack) + index->noSectors * sizeof(t_edskSector)) : 0, cardReads, (nowNs() - startNs) / 1000.0);
+        if(index == NULL)
+        {
+            errors++;
+            f_close(&File);
+            continue;
+        }
+
+        for(uint32_t req = 0; req < requests; req++)
+        {
+            t_request *rq = &trace[req];
+            uint16_t  trackIdx = (rq->track * im->sides) + rq->side;
+
+            // Original method, then the sector read.
+            fatCalls = cardReads = 0;
+            startNs  = nowNs();
+            resOld   = legacyLocate(&File, &legacy, im->sides, rq->track, rq->side, rq->sectorNo, &offsetOld, &sizeOld);
+            if(resOld == EDSK_OK && (benchLseek(&File, offsetOld) != FR_OK || benchRead(&File, buf, sizeOld, &size) != FR_OK || size != sizeOld))
+                resOld = EDSK_SECTOR_NOT_FOUND;
+            old.hostUs    += (nowNs() - startNs) / 1000.0;
+            old.calls     += fatCalls;
+            old.cardReads += cardReads;
+            if(resOld == EDSK_OK) old.found++; else old.notFound++;
+            for(uint32_t pos = 0; resOld == EDSK_OK && pos < sizeOld; pos++)
+            {
+                if(buf[pos] != sectorByte(trackIdx, rq->sectorNo, pos))
+                {
+                    printf("  %s track %u side %u sector %02x, original method read the wrong data.\n", im->file, rq->track, rq->side, rq->sectorNo);
+                    errors++;
+                    break;
+                }
+            }
+
+            // Indexed, then the sector read.
+            fatCalls = cardReads = 0;
+            startNs  = nowNs();
+            resIdx   = edskLocateSector(index, trackIdx, rq->sectorNo, &offsetIdx, &sizeIdx);
+            if(resIdx == EDSK_OK && (benchLseek(&File, offsetIdx) != FR_OK || benchRead(&File, buf, sizeIdx, &size) != FR_OK || size != sizeIdx))
+                resIdx = EDSK_SECTOR_NOT_FOUND;
+            idx.hostUs    += (nowNs() - startNs) / 1000.0;
+            idx.calls     += fatCalls;
+            idx.cardReads += cardReads;
+            if(resIdx == EDSK_OK) idx.found++; else idx.notFound++;
+            for(uint32_t pos = 0; resIdx == EDSK_OK && pos < sizeIdx; pos++)
+            {
+                if(buf[pos] != sectorByte(trackIdx, rq->sectorNo, pos))
+                {
+                    printf("  %s track %u side %u sector %02x, index read the wrong data.\n", im->file, rq->track, rq->side, rq->sectorNo);
+                    errors++;
+                    break;
+                }
+            }
+
+            // Both must agree on the result and, when found, the offset and size.
+            if(resOld != resIdx || (resOld == EDSK_OK && (offsetOld != offsetIdx || sizeOld != sizeIdx)))
+            {
+                printf("  %s track %u side %u sector %02x, original %u @%06x/%u, index %u @%06x/%u.\n", im->file, rq->track, rq->side, rq->sectorNo,
+                       resOld, offsetOld, sizeOld, resIdx, offsetIdx, sizeIdx);
+                errors++;
+            }
+        }
+        free(index);
+        f_close(&File);
+
+        for(int method = 0; method < 2; method++)
+        {
+            t_totals *tot = method == 0 ? &old : &idx;
+            t_totals *all = method == 0 ? &allOld : &allIdx;
+
+            printf("%-12s %-7s %8u %8u %10.2f %10.2f %11.3f %12.1f\n", "", method == 0 ? "walk" : "index", tot->found, tot->notFound,
+                   (double)tot->calls / requests, (double)tot->cardReads / requests, tot->hostUs / requests,
+                   (tot->calls * (double)callUs + tot->cardReads * (double)cardUs) / requests);
+            all->found     += tot->found;
+            all->notFound  += tot->notFound;
+            all->calls     += tot->calls;
+            all->cardReads += tot->cardReads;
+            all->hostUs    += tot->hostUs;
+        }
+    }
+
+    double modelOld = allOld.calls * (double)callUs + allOld.cardReads * (double)cardUs;
+    double modelIdx = allIdx.calls * (double)callUs + allIdx.cardReads * (double)cardUs;
+    printf("\nAll images: FatFS calls %u -> %u, card reads %u -> %u, host %.1f ms -> %.1f ms (%.1fx), model %.1f ms -> %.1f ms (%.1fx).\n",
+           allOld.calls, allIdx.calls, allOld.cardReads, allIdx.cardReads, allOld.hostUs / 1000.0, allIdx.hostUs / 1000.0, allOld.hostUs / allIdx.hostUs,
+           modelOld / 1000.0, modelIdx / 1000.0, modelOld / modelIdx);
+    printf("Verification: %s\n", errors ? "FAILED" : "ok");
+
+    free(trace);
+    close(diskFd);
+    return(errors ? 1 : 0);
+}
@@ -0,0 +1,410 @@
+// evqbench.c
+//
+// Host program to compare the tranZPUter service loop as it was, polling flags and taking one event per pass
+// with long operations running to completion, against the event queue of common/evq.c.
+//
+// common/evq.c is included directly with its clock replaced by a modelled microsecond clock. Events arrive as
+// Poisson streams at the rates given on the command line and the handlers, the background tranZPUter service and
+// the long operations within them (ROM load on RESET, directory cache build and file load on a service request)
+// are modelled by the time they take and the resources they use. Both loops see the same arrivals. A service request
+// is closed loop, the Z80 polls for the result of its request before it makes another, so the next request follows
+// the completion of the last by a random interval with the given mean. A save or erase refreshes the directory cache
+// once its result is with the Z80, in the polled loop within the request, in the event queue as a background job
+// which holds only the cache between entries. A reset restarts the Z80, a request it had made is dropped and it
+// makes no other until the ROMs are reloaded.
+//
+// By default an emulation is running, the background service has work and a service request uses the emulation
+// state. With -n the host runs TZFS or CP/M, there is no background service and a request leaves the emulation free.
+//
+// Reported per event are the number handled, those served at a yield point within a long operation, the worst
+// latency from post to handler start and the latency histogram. Every handler and job checks on entry that no
+// resource it uses is held by another, that it is not being re-entered, and at the end every posted event must
+// have been handled or still be pending.
+//
+// Usage: evqbench [-t <seconds>] [-s <svc ms>] [-r <reset ms>] [-y <sysreq ms>] [-i <io ms>] [-x <seed>] [-n]
+//
+// Build (from the repository root):
+//   gcc -O2 -Iinclude -o tools/evqbench tools/src/evqbench.c -lm
+//
+//   Created by: Philip Smart, Oct 2026.
+//
+// This software is free to use by anyone for any purpose.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+// Modelled time in microseconds, the queue reads it as its cycle counter.
+static uint32_t modelUs = 0;
+#define EVQ_CLOCK                  modelUs
+#define EVQ_CLOCKS_PER_US          1
+
+#include "../../common/evq.c"
+
+// Model parameters, mean interval between arrivals of each event.
+static uint32_t meanMs[EVQ_EVENTS] = { 5000, 30, 50, 40 };
+
+// Modelled costs, microseconds, of the work done by the handlers on the K64F.
+#define SECTOR_US                  700                                 // Read a sector and write it over the Z80 bus.
+#define DIRENT_US                  1200                                // Directory cache build, per entry.
+#define DIR_ENTRIES                120                                 // Entries in a cached directory.
+#define DIR_BLOCK                  16                                  // Entries in a directory block read without the cache.
+#define SERVICE_US                 150                                 // Background service slice, no OSD activity.
+#define SERVICE_LONG_US            8000                                // Background service slice redrawing the OSD.
+
+// Modes.
+enum { MODE_LEGACY = 0, MODE_EVQ = 1 };
+
+static int          mode;
+static uint32_t     nextArrival[EVQ_EVENTS];
+static uint32_t     postedCount[EVQ_EVENTS];
+static uint32_t     handledCount[EVQ_EVENTS];
+static uint8_t      busy;                                              // Resources in use by modelled handlers.
+static uint8_t      inHandler[EVQ_EVENTS];
+static uint32_t     failures;
+static uint64_t     rng;                                               // Handler work, differs between the loops.
+static uint64_t     arrivalRng;                                        // Arrivals, the same for both loops.
+static uint64_t     svcRng;                                            // Service request intervals, the same for both loops.
+static uint8_t      svcOutstanding;                                    // Z80 waiting for the result of a service request.
+static uint8_t      emulation = 1;                                     // Emulation running.
+static uint8_t      refreshPending;                                    // Directory cache refresh requested.
+static uint8_t      refreshBusy;                                       // Directory cache refresh in progress.
+static uint32_t     dropped;                                           // Service requests dropped by a reset.
+static t_evqStats   legacyStats[EVQ_EVENTS];
+
+static uint32_t nextRandom(uint64_t *state)
+{
+    *state ^= *state << 13; *state ^= *state >> 7; *state ^= *state << 17;
+    return((uint32_t)(*state >> 32));
+}
+
+static uint32_t expInterval(uint64_t *state, uint32_t meanUs)
+{
+    double u = ((double)nextRandom(state) + 1.0) / 4294967297.0;
+    return((uint32_t)(-log(u) * meanUs) + 1);
+}
+
+// Advance the modelled clock, posting the events which arrive on the way at their arrival time.
+static void advance(uint32_t us)
+{
+    uint32_t target = modelUs + us;
+    int      first;
+
+    for(;;)
+    {
+        first = -1;
+        for(int event=0; event < EVQ_EVENTS; event++)
+            if(meanMs[event] && !(event == EVQ_SVCREQ && svcOutstanding) && (int32_t)(nextArrival[event] - target) <= 0 && (first < 0 || (int32_t)(nextArrival[event] - nextArrival[first]) < 0))
+                first = event;
+        if(first < 0)
+            break;
+        if((int32_t)(nextArrival[first] - modelUs) > 0)
+            modelUs = nextArrival[first];
+        if(!evqControl.posted[first])
+            postedCount[first]++;
+        evqPost((enum EVQ_EVENT)first);
+        if(first == EVQ_SVCREQ)
+            svcOutstanding = 1;
+        else
+            nextArrival[first] += expInterval(&arrivalRng, meanMs[first] * 1000);
+    }
+    modelUs = target;
+}
+
+// Claim and release resources, any overlap is a failure.
+static void claim(int event, uint8_t uses)
+{
+    if(busy & uses)
+    {
+        printf("  resource clash, %s wants %02x with %02x in use\n", event >= 0 ? evqName((enum EVQ_EVENT)event) : "job", uses, busy);
+        failures++;
+    }
+    if(event >= 0)
+    {
+        if(inHandler[event]) { printf("  %s handler re-entered\n", evqName((enum EVQ_EVENT)event)); failures++; }
+        inHandler[event] = 1;
+    }
+    busy |= uses;
+}
+static void release(int event, uint8_t uses)
+{
+    busy &= ~uses;
+    if(event >= 0)
+        inHandler[event] = 0;
+}
+
+// A long operation, chunks of work with a yield point after each in the event queue model.
+static void longOperation(uint32_t chunks, uint32_t chunkUs, uint8_t holding)
+{
+    for(uint32_t idx=0; idx < chunks; idx++)
+    {
+        advance(chunkUs);
+        if(mode == MODE_EVQ)
+            evqYield(holding);
+    }
+}
+
+// A directory cache build, only the cache is held at a yield point. Outside a request the SD card is claimed for each entry.
+static void dirBuild(uint8_t claimSd)
+{
+    for(uint32_t idx=0; idx < DIR_ENTRIES; idx++)
+    {
+        if(mode == MODE_EVQ)
+            evqYield(EVQ_USES_DIRCACHE);
+        if(claimSd)
+            claim(-1, EVQ_USES_SDCARD);
+        advance(DIRENT_US);
+        if(claimSd)
+            release(-1, EVQ_USES_SDCARD);
+    }
+}
+
+// Background directory cache refresh, a refresh requested during the build builds again.
+static uint8_t refreshJob(void *ctx)
+{
+    if(refreshPending)
+    {
+        refreshPending = 0;
+        refreshBusy    = 1;
+        claim(-1, EVQ_USES_DIRCACHE);
+        dirBuild(mode == MODE_EVQ);
+        release(-1, EVQ_USES_DIRCACHE);
+        refreshBusy    = 0;
+    }
+    return(refreshPending ? EVQ_JOB_MORE : EVQ_JOB_DONE);
+}
+
+// Modelled handlers.
+static void resetHandler(void)
+{
+    uint8_t uses = EVQ_USES_Z80BUS | EVQ_USES_SDCARD;
+    claim(EVQ_RESET, uses);
+    handledCount[EVQ_RESET]++;
+
+    // The Z80 restarts, a request made before the reset is abandoned and no other is made whilst the ROMs are reloaded.
+    if(evqClearBefore(EVQ_SVCREQ, evqControl.postedAt[EVQ_RESET]))
+        dropped++;
+    svcOutstanding = 1;
+    longOperation(24, SECTOR_US, uses);                                // Monitor and CGROM reload.
+    evqClear(EVQ_RESET);
+    svcOutstanding = 0;
+    nextArrival[EVQ_SVCREQ] = modelUs + expInterval(&svcRng, meanMs[EVQ_SVCREQ] * 1000);
+    release(EVQ_RESET, uses);
+}
+static void svcHandler(void)
+{
+    uint8_t  uses = EVQ_USES_Z80BUS | EVQ_USES_SDCARD | (emulation ? EVQ_USES_EMU : 0);
+    uint32_t kind = nextRandom(&rng) % 100;
+
+    claim(EVQ_SVCREQ, uses);
+    handledCount[EVQ_SVCREQ]++;
+    if(kind < 80)
+    {
+        advance(SECTOR_US + 100);                                      // Sector read or write.
+    } else if(kind < 85)
+    {
+        advance(SECTOR_US + 100);                                      // Save or erase, the directory has changed.
+        refreshPending = 1;
+    } else if(kind < 95)
+    {
+        if(refreshBusy)
+        {
+            longOperation(DIR_BLOCK, DIRENT_US, uses);                 // Read a block of the directory, the cache is being refreshed.
+        } else
+        {
+            claim(-1, EVQ_USES_DIRCACHE);                              // Directory not cached, cache it.
+            dirBuild(0);
+            release(-1, EVQ_USES_DIRCACHE);
+        }
+    } else
+    {
+        longOperation(64, SECTOR_US, uses);                            // File load.
+    }
+
+    // The result is back with the Z80, which makes its next request in due course.
+    svcOutstanding = 0;
+    nextArrival[EVQ_SVCREQ] = modelUs + expInterval(&svcRng, meanMs[EVQ_SVCREQ] * 1000);
+
+    // The directory cache is refreshed after the result, within the request in the polled loop, in the background with the queue.
+    if(refreshPending)
+    {
+        if(mode == MODE_EVQ)
+            evqDefer(refreshJob, NULL, EVQ_USES_DIRCACHE);
+        else
+            refreshJob(NULL);
+    }
+    release(EVQ_SVCREQ, uses);
+}
+static void sysHandler(void)
+{
+    claim(EVQ_SYSREQ, 0);
+    handledCount[EVQ_SYSREQ]++;
+    advance(20);
+    release(EVQ_SYSREQ, 0);
+}
+static void ioHandler(void)
+{
+    claim(EVQ_IOEVENT, 0);
+    handledCount[EVQ_IOEVENT]++;
+    advance(50);
+    release(EVQ_IOEVENT, 0);
+}
+static uint8_t serviceJob(void *ctx)
+{
+    uint8_t uses = EVQ_USES_Z80BUS | EVQ_USES_SDCARD | EVQ_USES_EMU;
+    claim(-1, uses);
+    advance(nextRandom(&rng) % 100 == 0 ? SERVICE_LONG_US : SERVICE_US);
+    release(-1, uses);
+    return(EVQ_JOB_MORE);
+}
+
+static t_evqHandler handlers[EVQ_EVENTS] = { resetHandler, svcHandler, sysHandler, ioHandler };
+
+// The original loop, reset first then one event in the order svc, sys, io, else the service.
+static void legacyRun(int event)
+{
+    t_evqStats *stats = &legacyStats[event];
+    uint32_t   latency = modelUs - evqControl.postedAt[event];
+    uint8_t    bucket;
+    uint32_t   limit;
+
+    evqControl.posted[event] = 0;
+    for(bucket=0, limit=4; bucket < EVQ_HIST_BUCKETS-1 && latency >= limit; bucket++, limit <<= 2);
+    stats->hist[bucket]++;
+    stats->count++;
+    if(latency > stats->maxLatencyUs)
+        stats->maxLatencyUs = latency;
+    handlers[event]();
+}
+static void legacyPass(void)
+{
+    if(evqControl.posted[EVQ_RESET])
+        legacyRun(EVQ_RESET);
+    if(evqControl.posted[EVQ_SVCREQ])
+        legacyRun(EVQ_SVCREQ);
+    else if(evqControl.posted[EVQ_SYSREQ])
+        legacyRun(EVQ_SYSREQ);
+    else if(evqControl.posted[EVQ_IOEVENT])
+        legacyRun(EVQ_IOEVENT);
+    else if(emulation)
+        serviceJob(NULL);
+}
+
+static void report(const char *title, t_evqStats *stats)
+{
+    printf("%s\n", title);
+    printf("  %-8s %7s %7s %9s   %5s %5s %5s %5s %5s %5s %5s %5s %5s %5s %5s\n", "Event", "Count", "Nested", "Max us",
+           "<4u", "<16u", "<64u", "<256u", "<1m", "<4m", "<16m", "<66m", "<262m", "<1s", ">=1s");
+    for(int event=0; event < EVQ_EVENTS; event++)
+    {
+        printf("  %-8s %7u %7u %9u  ", evqName((enum EVQ_EVENT)event), stats[event].count, stats[event].nested, stats[event].maxLatencyUs);
+        for(int bucket=0; bucket < EVQ_HIST_BUCKETS; bucket++)
+            printf(" %5u", stats[event].hist[bucket]);
+        printf("\n");
+    }
+}
+
+static void runMode(int m, uint32_t seconds, uint64_t seed)
+{
+    uint32_t end;
+
+    mode    = m;
+    rng        = seed;
+    arrivalRng = seed ^ 0x9E3779B97F4A7C15ULL;
+    svcRng     = seed ^ 0xD1B54A32D192ED03ULL;
+    svcOutstanding = 0;
+    refreshPending = 0;
+    refreshBusy    = 0;
+    dropped        = 0;
+    modelUs = 0;
+    busy    = 0;
+    memset(postedCount, 0, sizeof(postedCount));
+    memset(handledCount, 0, sizeof(handledCount));
+    memset(legacyStats, 0, sizeof(legacyStats));
+    evqInit();
+    if(mode == MODE_EVQ)
+    {
+        evqRegister(EVQ_RESET,   resetHandler, EVQ_USES_Z80BUS | EVQ_USES_SDCARD);
+        evqRegister(EVQ_SVCREQ,  svcHandler,   EVQ_USES_Z80BUS | EVQ_USES_SDCARD | (emulation ? EVQ_USES_EMU : 0));
+        evqRegister(EVQ_SYSREQ,  sysHandler,   0);
+        evqRegister(EVQ_IOEVENT, ioHandler,    0);
+        if(emulation)
+            evqDefer(serviceJob, NULL, EVQ_USES_Z80BUS | EVQ_USES_SDCARD | EVQ_USES_EMU);
+    }
+    for(int event=0; event < EVQ_EVENTS; event++)
+        nextArrival[event] = meanMs[event] ? expInterval(event == EVQ_SVCREQ ? &svcRng : &arrivalRng, meanMs[event] * 1000) : 0;
+
+    // Each pass of the loop also costs the readline idle poll.
+    end = seconds * 1000000;
+    while(modelUs < end)
+    {
+        if(mode == MODE_EVQ)
+            evqDispatch();
+        else
+            legacyPass();
+        advance(5);
+    }
+
+    // Every posted event handled, still pending or, a service request, dropped by a reset. A RESET may also be cleared by the reload it caused.
+    for(int event=0; event < EVQ_EVENTS; event++)
+    {
+        uint32_t handled = mode == MODE_EVQ ? evqControl.stats[event].count : legacyStats[event].count;
+        if(handled != handledCount[event] || (postedCount[event] - handled - evqControl.posted[event] - (event == EVQ_SVCREQ ? dropped : 0) != 0 && event != EVQ_RESET))
+        {
+            printf("  %s posted %u, handled %u, pending %u\n", evqName((enum EVQ_EVENT)event), postedCount[event], handled, evqControl.posted[event]);
+            failures++;
+        }
+    }
+    if(mode == MODE_EVQ)
+    {
+        report("Event queue:", evqControl.stats);
+        printf("  %u background job slices, %u yield points, %u service requests dropped by a reset.\n\n", evqControl.jobSlices, evqControl.yields, dropped);
+    } else
+    {
+        report("Polled loop:", legacyStats);
+        printf("  %u service requests dropped by a reset.\n\n", dropped);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int      opt;
+    uint32_t seconds = 60;
+    uint64_t seed    = 0x2545F4914F6CDD1DULL;
+    uint32_t legacyMax[EVQ_EVENTS];
+
+    while((opt = getopt(argc, argv, "t:s:r:y:i:x:n")) != -1)
+    {
+        switch(opt)
+        {
+            case 't': seconds            = atoi(optarg); break;
+            case 's': meanMs[EVQ_SVCREQ] = atoi(optarg); break;
+            case 'r': meanMs[EVQ_RESET]  = atoi(optarg); break;
+            case 'y': meanMs[EVQ_SYSREQ] = atoi(optarg); break;
+            case 'i': meanMs[EVQ_IOEVENT]= atoi(optarg); break;
+            case 'x': seed               = strtoull(optarg, NULL, 0) | 1; break;
+            case 'n': emulation          = 0; break;
+            default:
+                fprintf(stderr, "Usage: %s [-t <seconds>] [-s <svc ms>] [-r <reset ms>] [-y <sysreq ms>] [-i <io ms>] [-x <seed>] [-n]\n", argv[0]);
+                return(1);
+        }
+    }
+    printf("%u s modelled, %s, mean arrival reset %u ms, svcreq %u ms after the last, sysreq %u ms, ioevent %u ms.\n\n", seconds,
+           emulation ? "emulation running" : "no emulation", meanMs[EVQ_RESET], meanMs[EVQ_SVCREQ], meanMs[EVQ_SYSREQ], meanMs[EVQ_IOEVENT]);
+
+    runMode(MODE_LEGACY, seconds, seed);
+    for(int event=0; event < EVQ_EVENTS; event++)
+        legacyMax[event] = legacyStats[event].maxLatencyUs;
+    runMode(MODE_EVQ, seconds, seed);
+
+    printf("Worst case latency, polled loop to event queue:\n");
+    for(int event=0; event < EVQ_EVENTS; event++)
+        printf("  %-8s %9u us -> %9u us\n", evqName((enum EVQ_EVENT)event), legacyMax[event], evqControl.stats[event].maxLatencyUs);
+
+    printf("Verification: %s\n", failures ? "FAILED" : "ok");
+    return(failures ? 1 : 0);
+}
@@ -0,0 +1,355 @@
+// iocpboard.c
+//
+// Host stand-in for a ZPU board waiting in the IOCP upload, so the uploader (tools/iocpupload) can be run
+// end to end without hardware. A pseudo terminal takes the place of the serial line, the block receiver in
+// common/blkupload.c and the console driver in common/uart.c are included directly with the UART registers
+// and millisecond timer routed to a model, and the stream receive loop of iocp/iocp.c is embedded below. As
+// the IOCP does, the start sequence selects the protocol, the result is reported and the prompt output.
+//
+// The model delivers bytes from the pseudo terminal no faster than the given baud rate and can corrupt or
+// drop bytes at random, so throughput and recovery can be compared between the two protocols. After each
+// upload the memory is compared with the image given by -f.
+//
+// With a command after --, the command is run with "-d <pseudo terminal>" appended and the stand-in exits
+// when it does, otherwise the pseudo terminal name is printed and uploads are served until interrupted.
+//
+// Usage: iocpboard [-b <baud>] [-c <corrupt 1 in n bytes>] [-x <drop 1 in n bytes>] [-f <image>] [-- <uploader>]
+//
+//   Example, a 256KB image with one byte in 20000 corrupted:
+//     head -c 262144 /dev/urandom > /tmp/app.bin
+//     tools/iocpboard -c 20000 -f /tmp/app.bin -- tools/iocpupload -f /tmp/app.bin
+//     tools/iocpboard -c 20000 -f /tmp/app.bin -- tools/iocpupload -f /tmp/app.bin -L
+//
+// Build (from the repository root):
+//   gcc -O2 -fgnu89-inline -D__ZPU__ -DCRC32_SMALL_TABLE -DUSELOADB -Iinclude -Icommon -o tools/iocpboard tools/src/iocpboard.c
+//
+//   Created by: Philip Smart, Oct 2026.
+//
+// This software is free to use by anyone for any purpose.
+//
+
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+// The SoC header names its register pointer type as the host does.
+#define register_t       soc_register_t
+#include "zpu_soc.h"
+
+// Route the console UART and timer to the model.
+uint32_t modelStatus(void);
+uint8_t  modelGet(void);
+void     modelPut(uint8_t);
+uint32_t modelMillis(void);
+#undef  UART_STATUS
+#define UART_STATUS(x)   modelStatus()
+#define UART_GET(x)      modelGet()
+#define UART_PUT(x, c)   modelPut(c)
+#undef  TIMER_MILLISECONDS_UP
+#define TIMER_MILLISECONDS_UP modelMillis()
+
+#include "uart.c"
+#include "crc32.c"
+#include "blkupload.c"
+
+#define MEM_ADDR         0x10000000          // Upload memory, at a fixed address as the receivers take a 32bit address.
+#define MEM_SIZE         0x400000
+#define FIFO_DEPTH       16
+
+static int      master;
+static pid_t    child      = 0;
+static uint64_t byteNs;
+static uint64_t nextByteAt = 0;
+static int      rxByte     = -1;
+static uint32_t corruptRate = 0;
+static uint32_t dropRate    = 0;
+static uint32_t corrupted   = 0;
+static uint32_t dropped     = 0;
+static uint8_t  *expect     = NULL;
+static uint32_t expectSize  = 0;
+static int      failures    = 0;
+static int      uploads     = 0;
+static uint8_t  inBlock     = 0;
+static uint8_t  spawned     = 0;
+static int      childStatus = 0;
+
+static uint64_t nowNs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return((uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+
+static void finish(void)
+{
+    if(child)
+        waitpid(child, &childStatus, 0);
+    if(spawned && (!WIFEXITED(childStatus) || WEXITSTATUS(childStatus) != 0))
+        failures++;
+    printf("Board: %d upload(s), %u byte(s) corrupted, %u dropped on the line.\n", uploads, corrupted, dropped);
+    printf("Verification: %s\n", failures || !uploads ? "FAILED" : "ok");
+    exit(failures || !uploads ? 1 : 0);
+}
+
+// Fetch the next byte from the line once the previous one has had its time on the wire, applying the
+// configured errors.
+//
+static void lineFetch(void)
+{
+    static uint32_t polls = 0;
+    uint64_t        now;
+    uint8_t         c;
+
+    // The uploader has gone, a block upload runs on to its own timeout so its result is counted.
+    if(child && !inBlock && (++polls & 0xFFFF) == 0 && waitpid(child, &childStatus, WNOHANG) == child)
+    {
+        child = 0;
+        finish();
+    }
+    if(rxByte >= 0 || (now = nowNs()) < nextByteAt)
+        return;
+    if(read(master, &c, 1) != 1)
+    {
+        // Nothing sent, give the uploader the processor.
+        usleep(20);
+        return;
+    }
+    // Bytes held up whilst the stand-in was not running are caught up as a UART FIFO would hold them.
+    nextByteAt = (now - nextByteAt > FIFO_DEPTH * byteNs ? now : nextByteAt) + byteNs;
+    if(dropRate && (uint32_t)rand() % dropRate == 0)
+    {
+        dropped++;
+        return;
+    }
+    if(corruptRate && (uint32_t)rand() % corruptRate == 0)
+    {
+        corrupted++;
+        c ^= 1 << (rand() % 8);
+    }
+    rxByte = c;
+}
+
+uint32_t modelStatus(void)
+{
+    uint32_t status = UART_TX_FIFO_ENABLED | UART_TX_ENABLED | UART_TX_FIFO_EMPTY | UART_RX_FIFO_ENABLED | UART_RX_ENABLED;
+
+    lineFetch();
+    status |= rxByte >= 0 ? UART_RX_DATA_READY : UART_RX_FIFO_EMPTY;
+    return(status);
+}
+
+uint8_t modelGet(void)
+{
+    uint8_t c = (uint8_t)rxByte;
+
+    rxByte = -1;
+    return(c);
+}
+
+void modelPut(uint8_t c)
+{
+    if(write(master, &c, 1) != 1)
+        finish();
+}
+
+uint32_t modelMillis(void)
+{
+    return((uint32_t)(nowNs() / 1000000));
+}
+
+// The original IOCP stream receive, embedded from iocp.c after the start sequence, and the word read from
+// simple_utils.c. char is signed on the host so the byte is masked.
+//
+unsigned int get_dword(void)
+{
+    unsigned int temp = 0;
+    int idx;
+
+    for(idx=0; idx < 4; idx++)
+    {
+        temp = (temp << 8) | (uint8_t)getserial();
+    }
+
+    return(temp);
+}
+
+static int streamUpload(uint32_t memAddr, uint32_t memSize, uint32_t *size)
+{
+    // Locals.
+    uint8_t   resultCode = 1;
+    uint32_t  crcDst = crc32_init();
+
+    // Get size of image and validate.
+    //
+    uint32_t image_size = get_dword();
+    *size = image_size;
+    if (image_size >  memSize-8)
+    {
+        uart_puts(" ERROR! Upload too big!\n\n");
+    } else
+    {
+        // Get CRC of image.
+        //
+        uint32_t crcSrc = get_dword();
+
+        uint32_t data_pointer = memAddr;
+        uint32_t count = image_size;
+        while(count > 0)
+        {
+            // The host is little endian, store the word in the byte order it was sent as the ZPU does.
+            *(uint32_t *)(uintptr_t)data_pointer = __builtin_bswap32(get_dword());
+            data_pointer = data_pointer + 4;
+            count-=4;
+        }
+        crcDst = ~crc32_update(crcDst, (uint8_t *)(uintptr_t)memAddr, image_size);
+
+        // If CRCs dont match then indicate failure.
+        if(crcSrc != crcDst)
+        {
+            uart_puts("CRC mismatch.\r\n");
+        } else
+            resultCode = 0;
+    }
+
+    // Return success (0) or fail (1).
+    return(resultCode);
+}
+
+// Compare the memory with the expected image.
+//
+static const char *verify(uint32_t size)
+{
+    if(expect == NULL)
+        return("not checked");
+    if(size != ((expectSize + 3) & ~3) || memcmp((void *)MEM_ADDR, expect, expectSize) != 0)
+        return("differs from the image");
+    return("matches the image");
+}
+
+int main(int argc, char *argv[])
+{
+    static const char *reason[] = { "ok", "image CRC mismatch", "header CRC mismatch", "image too big", "timed out" };
+    const char        *ptyName;
+    uint32_t          baud      = 115200;
+    struct termios    tio;
+    t_blkStats        stats;
+    FILE              *fp;
+    uint32_t          size;
+    int               slave;
+    int               result;
+    int               opt;
+    char              protocol;
+
+    while((opt = getopt(argc, argv, "b:c:x:f:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'b': baud        = atoi(optarg); break;
+            case 'c': corruptRate = atoi(optarg); break;
+            case 'x': dropRate    = atoi(optarg); break;
+            case 'f':
+                if((fp = fopen(optarg, "rb")) == NULL)
+                {
+                    perror(optarg);
+                    return(1);
+                }
+                fseek(fp, 0, SEEK_END);
+                expectSize = ftell(fp);
+                rewind(fp);
+                expect = malloc(expectSize + 1);
+                if(fread(expect, 1, expectSize, fp) != expectSize)
+                {
+                    perror(optarg);
+                    return(1);
+                }
+                fclose(fp);
+                break;
+            default:
+                printf("Usage: %s [-b <baud>] [-c <corrupt 1 in n bytes>] [-x <drop 1 in n bytes>] [-f <image>] [-- <uploader>]\n", argv[0]);
+                return(1);
+        }
+    }
+    byteNs = 10ULL * 1000000000ULL / baud;
+    srand(1);
+
+    if(mmap((void *)MEM_ADDR, MEM_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED)
+    {
+        perror("mmap upload memory");
+        return(1);
+    }
+
+    // The line, the slave is held open so the line stays up between uploader runs.
+    if((master = posix_openpt(O_RDWR | O_NOCTTY)) < 0 || grantpt(master) || unlockpt(master) || (ptyName = ptsname(master)) == NULL)
+    {
+        perror("pseudo terminal");
+        return(1);
+    }
+    slave = open(ptyName, O_RDWR | O_NOCTTY);
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+    fcntl(master, F_SETFL, O_NONBLOCK);
+
+    if(optind < argc)
+    {
+        spawned = 1;
+        if((child = fork()) == 0)
+        {
+            char **args = calloc(argc - optind + 3, sizeof(char *));
+            int    cnt  = 0;
+
+            for(int idx=optind; idx < argc; idx++)
+                args[cnt++] = argv[idx];
+            args[cnt++] = "-d";
+            args[cnt++] = (char *)ptyName;
+            execvp(args[0], args);
+            perror(args[0]);
+            exit(1);
+        }
+    } else
+    {
+        printf("Board on %s at %u baud.\n", ptyName, baud);
+        fflush(stdout);
+    }
+
+    // Serve uploads as the IOCP does, the start sequence selects the protocol.
+    while(1)
+    {
+        if(getserial() != 'I' || getserial() != 'O' || getserial() != 'C')
+            continue;
+        protocol = getserial();
+        if(protocol == 'B')
+        {
+            inBlock = 1;
+            result  = blkUpload(MEM_ADDR, MEM_SIZE - 8, &stats);
+            inBlock = 0;
+            uploads++;
+            size   = (expectSize + 3) & ~3;
+            printf("Board: block upload %s, %u blocks stored, %u refused, %u repeated, %u cut short, %u bytes skipped, memory %s.\n",
+                   result <= BLK_ERR_TIMEOUT ? reason[result] : "failed", stats.blocks, stats.naks, stats.duplicates, stats.timeouts, stats.resyncs, verify(size));
+            if(result != BLK_OK || (expect && strcmp(verify(size), "matches the image") != 0))
+                failures++;
+        } else if(protocol == 'P')
+        {
+            result = streamUpload(MEM_ADDR, MEM_SIZE, &size);
+            uploads++;
+            printf("Board: stream upload %s, memory %s.\n", result ? "CRC mismatch" : "ok", verify(size));
+            if(!result && expect && strcmp(verify(size), "matches the image") != 0)
+                failures++;
+        } else
+        {
+            continue;
+        }
+        fflush(stdout);
+        uart_puts("* ");
+    }
+}
@@ -0,0 +1,398 @@
+// iocpupload.c
+//
+// Host uploader for the IOCP serial upload, sending an application image to a ZPU board waiting in the IOCP
+// upload (keys 2 or 3 on the IOCP console). By default the block protocol of include/blkupload.h is used,
+// the image is sent in CRC checked blocks with a window of blocks in flight, blocks refused by the target or
+// not acknowledged in time are sent again. With -L the original stream protocol is used, the image is sent
+// in one piece and, if the target reports a CRC mismatch, the whole image is sent again.
+//
+// The device may be a serial port or the pseudo terminal of tools/iocpboard, the board stand-in.
+//
+// Usage: iocpupload -d <device> -f <image> [-b <baud>] [-k <key>] [-w <window>] [-r <retries>] [-L]
+//          -k  send the given IOCP menu key before each upload, ie. 3 to upload to RAM.
+//          -w  limit the block window, the target sets the maximum.
+//          -r  attempts for the stream protocol, attempts at the header for the block protocol.
+//
+// Build (from the repository root):
+//   gcc -O2 -Iinclude -Icommon -o tools/iocpupload tools/src/iocpupload.c
+//
+//   Created by: Philip Smart, Oct 2026.
+//
+// This software is free to use by anyone for any purpose.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "crc32.c"
+#include "blkupload.h"
+
+#define BLK_PENDING      0                   // Block to be sent.
+#define BLK_SENT         1                   // Block sent, awaiting acknowledgement.
+#define BLK_ACKED        2                   // Block acknowledged.
+#define BLK_ACK_TIMEOUT  250                 // ms after a block has left the line before it is sent again.
+
+static int      fd;
+static uint32_t baud    = 115200;
+static uint8_t  rxBuf[256];
+static int      rxLen   = 0;
+static int      rxPos   = 0;
+static uint64_t lineFreeUs = 0;            // Time the bytes written so far will have left the line.
+
+static uint64_t nowMs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return((uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000);
+}
+
+static uint64_t nowUs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return((uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000);
+}
+
+// Read a byte from the device, waiting at most the given time. Returns the byte or -1 on timeout.
+//
+static int getByte(int timeout)
+{
+    struct pollfd pfd = { fd, POLLIN, 0 };
+
+    if(rxPos == rxLen)
+    {
+        if(poll(&pfd, 1, timeout) <= 0)
+            return(-1);
+        if((rxLen = read(fd, rxBuf, sizeof(rxBuf))) <= 0)
+        {
+            rxLen = 0;
+            return(-1);
+        }
+        rxPos = 0;
+    }
+    return(rxBuf[rxPos++]);
+}
+
+static void putBytes(const void *buf, int len)
+{
+    const uint8_t *ptr = buf;
+    uint64_t       now = nowUs();
+    int            sent;
+
+    // The kernel takes the bytes at once, keep track of when they will actually have been sent.
+    lineFreeUs = (lineFreeUs > now ? lineFreeUs : now) + (uint64_t)len * 10 * 1000000 / baud;
+
+    while(len > 0)
+    {
+        if((sent = write(fd, ptr, len)) < 0)
+        {
+            perror("write");
+            exit(1);
+        }
+        ptr += sent;
+        len -= sent;
+    }
+}
+
+static void putWord(uint8_t *buf, uint32_t word)
+{
+    buf[0] = word >> 24;
+    buf[1] = word >> 16;
+    buf[2] = word >> 8;
+    buf[3] = word;
+}
+
+static uint32_t crc32(const uint8_t *buf, uint32_t len)
+{
+    return(~crc32_update(crc32_init(), buf, len));
+}
+
+// Time, in ms, at which everything written so far will have left the line.
+//
+static uint64_t lineDoneMs(void)
+{
+    return(lineFreeUs / 1000);
+}
+
+static speed_t baudCode(uint32_t rate)
+{
+    switch(rate)
+    {
+        case 9600:    return(B9600);
+        case 19200:   return(B19200);
+        case 38400:   return(B38400);
+        case 57600:   return(B57600);
+        case 115200:  return(B115200);
+        case 230400:  return(B230400);
+        case 460800:  return(B460800);
+        case 921600:  return(B921600);
+        case 1000000: return(B1000000);
+        case 2000000: return(B2000000);
+        default:      return(B0);
+    }
+}
+
+// Send the image with the original stream protocol, the target reports a CRC mismatch in text and then
+// returns to its prompt. Returns the number of attempts made, 0 if none succeeded.
+//
+static int streamUpload(uint8_t *image, uint32_t size, int key, int retries)
+{
+    uint8_t hdr[12];
+    char    reply[256];
+    int     len;
+    int     c;
+
+    memcpy(hdr, "IOCP", 4);
+    putWord(hdr + 4, size);
+    putWord(hdr + 8, crc32(image, size));
+    for(int attempt=1; attempt <= retries; attempt++)
+    {
+        if(key >= 0)
+        {
+            putBytes(&(uint8_t){ key }, 1);
+            usleep(100000);
+        }
+        putBytes(hdr, 12);
+        putBytes(image, size);
+
+        // Collect the reply up to the prompt once the image has left the line.
+        if(lineDoneMs() > nowMs())
+            usleep((lineDoneMs() - nowMs()) * 1000);
+        len = 0;
+        while((c = getByte(2000)) >= 0 && len < (int)sizeof(reply) - 1)
+        {
+            reply[len++] = c;
+            if(len >= 2 && reply[len-2] == '*' && reply[len-1] == ' ')
+                break;
+        }
+        reply[len] = 0;
+        if(c < 0)
+        {
+            printf("Attempt %d: no response from the target.\n", attempt);
+            return(0);
+        }
+        if(strstr(reply, "CRC mismatch") == NULL)
+            return(attempt);
+        printf("Attempt %d: CRC mismatch, sending the image again.\n", attempt);
+    }
+    return(0);
+}
+
+// Send the image with the block protocol. Returns BLK_OK or the failure reason.
+//
+static int blockUpload(uint8_t *image, uint32_t size, int key, int window, int retries, uint32_t *resent, uint32_t *naks, uint32_t *timeouts)
+{
+    uint32_t  blocks    = (size + BLK_SIZE - 1) / BLK_SIZE;
+    uint8_t   *state    = calloc(blocks, 1);
+    uint64_t  *dueAt    = calloc(blocks, sizeof(uint64_t));
+    uint8_t   frame[BLK_SIZE + 7];
+    uint8_t   hdr[16];
+    uint32_t  base      = 0;
+    uint32_t  blockNo;
+    uint32_t  len;
+    uint64_t  now;
+    int       code      = -1;
+    int       value;
+    int       c;
+
+    // Header, repeated until the target answers.
+    memcpy(hdr, BLK_START_SEQ, 4);
+    putWord(hdr + 4, size);
+    putWord(hdr + 8, crc32(image, size));
+    putWord(hdr + 12, crc32(hdr + 4, 8));
+    for(int attempt=0; attempt < retries && code < 0; attempt++)
+    {
+        uint64_t until = nowMs() + 2000;
+
+        if(key >= 0)
+        {
+            putBytes(&(uint8_t){ key }, 1);
+            usleep(100000);
+        }
+        putBytes(hdr, 16);
+        while(code < 0 && (c = getByte(until - nowMs())) >= 0)
+        {
+            if(c == BLK_READY || c == BLK_CAN)
+                code = c;
+        }
+    }
+    if(code < 0)
+        return(BLK_ERR_TIMEOUT);
+    if((value = getByte(1000)) < 0)
+        return(BLK_ERR_TIMEOUT);
+    if(code == BLK_CAN)
+        return(value);
+    if(value < window)
+        window = value;
+
+    while(base < blocks)
+    {
+        // Send anything in the window which is new, refused or overdue.
+        now = nowMs();
+        for(blockNo=base; blockNo < blocks && blockNo < base + window; blockNo++)
+        {
+            if(state[blockNo] == BLK_ACKED || (state[blockNo] == BLK_SENT && now < dueAt[blockNo]))
+                continue;
+            if(state[blockNo] == BLK_SENT)
+                (*timeouts)++;
+            if(dueAt[blockNo])
+                (*resent)++;
+
+            len = blockNo == blocks - 1 ? size - (blockNo * BLK_SIZE) : BLK_SIZE;
+            frame[0] = BLK_SOH;
+            frame[1] = (uint8_t)blockNo;
+            frame[2] = ~(uint8_t)blockNo;
+            memcpy(frame + 3, image + (blockNo * BLK_SIZE), len);
+            putWord(frame + 3 + len, crc32(frame + 3, len));
+            // The block is overdue if not acknowledged shortly after it has left the line.
+            putBytes(frame, len + 7);
+            state[blockNo]  = BLK_SENT;
+            dueAt[blockNo]  = lineDoneMs() + BLK_ACK_TIMEOUT;
+        }
+
+        // Take the responses, an ACK or NAK carries the block number modulo 256 within the window.
+        if((c = getByte(10)) < 0)
+            continue;
+        if(c != BLK_ACK && c != BLK_NAK)
+            continue;
+        if((value = getByte(1000)) < 0)
+            continue;
+        blockNo = base + (int8_t)(uint8_t)(value - base);
+        if(blockNo < base || blockNo >= blocks || blockNo >= base + window || state[blockNo] == BLK_ACKED)
+            continue;
+        if(c == BLK_ACK)
+        {
+            state[blockNo] = BLK_ACKED;
+            while(base < blocks && state[base] == BLK_ACKED)
+                base++;
+        } else
+        {
+            (*naks)++;
+            state[blockNo] = BLK_PENDING;
+        }
+    }
+    free(state);
+    free(dueAt);
+
+    // Every block acknowledged, ask the target to check the image.
+    for(int attempt=0; attempt < 5; attempt++)
+    {
+        putBytes(&(uint8_t){ BLK_EOT }, 1);
+        while((c = getByte(400)) >= 0)
+        {
+            if(c == BLK_DONE)
+                return((value = getByte(1000)) < 0 ? BLK_ERR_TIMEOUT : value);
+        }
+    }
+    return(BLK_ERR_TIMEOUT);
+}
+
+int main(int argc, char *argv[])
+{
+    static const char *reason[] = { "ok", "image CRC mismatch", "header CRC mismatch", "image too big", "no response" };
+    const char        *device   = NULL;
+    const char        *file     = NULL;
+    struct termios    tio;
+    FILE              *fp;
+    uint8_t           *image;
+    uint32_t          size;
+    uint32_t          fileSize;
+    uint32_t          lineMs;
+    uint32_t          resent    = 0;
+    uint32_t          naks      = 0;
+    uint32_t          timeouts  = 0;
+    uint64_t          startMs;
+    double            secs;
+    int               key       = -1;
+    int               window    = BLK_WINDOW;
+    int               retries   = 5;
+    int               legacy    = 0;
+    int               result;
+    int               opt;
+
+    while((opt = getopt(argc, argv, "d:f:b:k:w:r:L")) != -1)
+    {
+        switch(opt)
+        {
+            case 'd': device  = optarg; break;
+            case 'f': file    = optarg; break;
+            case 'b': baud    = atoi(optarg); break;
+            case 'k': key     = optarg[0]; break;
+            case 'w': window  = atoi(optarg); break;
+            case 'r': retries = atoi(optarg); break;
+            case 'L': legacy  = 1; break;
+            default:
+                device = NULL;
+                break;
+        }
+    }
+    if(device == NULL || file == NULL || baudCode(baud) == B0 || window < 1 || window > 32)
+    {
+        printf("Usage: %s -d <device> -f <image> [-b <baud>] [-k <key>] [-w <window>] [-r <retries>] [-L]\n", argv[0]);
+        return(1);
+    }
+
+    // Read the image, padded to a word multiple as the target stores whole words.
+    if((fp = fopen(file, "rb")) == NULL)
+    {
+        perror(file);
+        return(1);
+    }
+    fseek(fp, 0, SEEK_END);
+    fileSize = ftell(fp);
+    rewind(fp);
+    size  = (fileSize + 3) & ~3;
+    image = calloc(size ? size : 4, 1);
+    if(fread(image, 1, fileSize, fp) != fileSize)
+    {
+        perror(file);
+        return(1);
+    }
+    fclose(fp);
+
+    if((fd = open(device, O_RDWR | O_NOCTTY)) < 0)
+    {
+        perror(device);
+        return(1);
+    }
+    if(tcgetattr(fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        cfsetispeed(&tio, baudCode(baud));
+        cfsetospeed(&tio, baudCode(baud));
+        tio.c_cflag |= CLOCAL | CREAD;
+        tcsetattr(fd, TCSANOW, &tio);
+        tcflush(fd, TCIOFLUSH);
+    }
+
+    lineMs  = (uint32_t)((uint64_t)size * 10 * 1000 / baud);
+    startMs = nowMs();
+    if(legacy)
+    {
+        result = streamUpload(image, size, key, retries);
+        secs   = (nowMs() - startMs) / 1000.0;
+        if(result)
+            printf("Stream upload of %u bytes in %.3f s, %.1f KB/s, %d attempt(s), %.0f%% of the line rate.\n",
+                   size, secs, size / secs / 1024, result, 100.0 * lineMs / 1000 / secs);
+        else
+            printf("Stream upload of %u bytes failed after %.3f s.\n", size, secs);
+        result = result ? 0 : 1;
+    } else
+    {
+        result = blockUpload(image, size, key, window, retries, &resent, &naks, &timeouts);
+        secs   = (nowMs() - startMs) / 1000.0;
+        printf("Block upload of %u bytes in %.3f s, %.1f KB/s, %.0f%% of the line rate: %s.\n",
+               size, secs, size / secs / 1024, 100.0 * lineMs / 1000 / secs, result <= BLK_ERR_TIMEOUT ? reason[result] : "refused");
+        printf("    %u blocks, %u sent again, %u refused, %u timed out.\n", (size + BLK_SIZE - 1) / BLK_SIZE, resent, naks, timeouts);
+    }
+
+    close(fd);
+    free(image);
+    return(result == BLK_OK ? 0 : 1);
+}
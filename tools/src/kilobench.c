@@ -0,0 +1,520 @@
+// kilobench.c
+//
+// Host program to measure the terminal output of the kilo editor refresh, apps/kilo/kilo.c, comparing the
+// original whole screen redraw with the screen shadow which only sends the changed spans of each row.
+//
+// kilo.c is compiled into this program with the system calls stubbed, a C source is loaded into the editor
+// and a scripted editing session (cursor movement, typing, new lines, deletes, paging and scrolling) is fed in
+// through getKey(). After every keystroke the refresh output is captured, counted and played into a VT100
+// model of the terminal. For the shadow refresh the modelled screen is checked after every keystroke against
+// the screen produced by a full redraw of the same editor state, text, attributes and cursor position.
+//
+// The byte counts are converted to the time the console link would take at the baud rate given with -b.
+//
+// Usage: kilobench [-r <rows>] [-c <cols>] [-b <baud>]
+//
+// Build (from the repository root):
+//   gcc -O2 -D__K64F__ -D__ZOS__ -D__APP__ -Iinclude -Icommon -Icommon/FatFS -Iapps/include -IzOS/src -Iapps/kilo -o tools/kilobench tools/src/kilobench.c common/textbuf.c
+//
+//   Created by: Philip Smart, Oct 2026.
+//
+// This software is free to use by anyone for any purpose.
+//
+
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "kilo.c"
+
+#define MAX_ROWS      100
+#define MAX_COLS      256
+#define SRC_LINES     300
+
+// Stubs for the zOS calls kilo makes, the file system is not used.
+//
+static uint32_t volatile virtualMillis;
+static GLOBALS           globals;
+static const char        *keyQueue;
+
+void     *sys_malloc(size_t size)               { return(malloc(size)); }
+void     *sys_realloc(void *ptr, size_t size)   { return(realloc(ptr, size)); }
+void     sys_free(void *ptr)                    { free(ptr); }
+char     *getStrParam(char **ptr)               { return(*ptr); }
+int      uxatoi(char **ptr, uint32_t *result)   { return(0); }
+FRESULT  f_open(FIL *fp, const TCHAR *path, BYTE mode)              { return(FR_NO_FILE); }
+FRESULT  f_close(FIL *fp)                                           { return(FR_OK); }
+FRESULT  f_lseek(FIL *fp, FSIZE_t ofs)                              { return(FR_OK); }
+FRESULT  f_truncate(FIL *fp)                                        { return(FR_OK); }
+FRESULT  f_write(FIL *fp, const void *buff, UINT btw, UINT *bw)     { *bw = btw; return(FR_OK); }
+FRESULT  f_read(FIL *fp, void *buff, UINT btr, UINT *br)            { *br = 0; return(FR_OK); }
+FRESULT  f_unlink(const TCHAR *path)                                { return(FR_OK); }
+FRESULT  f_rename(const TCHAR *path_old, const TCHAR *path_new)     { return(FR_OK); }
+TCHAR    *f_gets(TCHAR *buff, int len, FIL *fp)                     { return(NULL); }
+int      f_putc(TCHAR c, FIL *fp)                                   { return(1); }
+
+// Keys are fed from the script, time moves on whilst the editor polls for input.
+int8_t getKey(uint8_t mode)
+{
+    if(keyQueue == NULL || *keyQueue == '\0')
+    {
+        virtualMillis++;
+        return(-1);
+    }
+    return(*keyQueue++);
+}
+
+// The original refresh, a whole screen redraw on every keystroke.
+//
+int legacyRefreshScreen(void)
+{
+    int    y;
+    int    lastLine = -1;
+    erow   *r;
+    char   buf[32];
+
+    abAppend("\x1b[?25l",6, 0); /* Hide cursor. */
+    abAppend("\x1b[H",3, 0);    /* Go home. */
+    for (y = 0; y < E.screenrows; y++)
+    {
+        int filerow = E.rowoff+y;
+
+        if (filerow >= E.numrows) {
+            if (E.numrows == 0 && y == E.screenrows/3)
+            {
+                char welcome[80];
+                sprintf(welcome, "Kilo editor -- version %s\x1b[0K\r\n", KILO_VERSION);
+                int welcomelen = strlen(welcome);
+                int padding = (E.screencols-welcomelen)/2;
+                if (padding)
+                {
+                    abAppend("~",1, 0);
+                    padding--;
+                }
+                while(padding--) abAppend(" ",1, 0);
+                abAppend(welcome,welcomelen, 0);
+            } else {
+                if(lastLine == -1) lastLine = y;
+                abAppend("~\x1b[0K\r\n",7, 0);
+            }
+            continue;
+        }
+
+        r = editorRow(filerow);
+
+        int len = r ? r->rsize - E.coloff : 0;
+        int current_color = -1;
+        if (len > 0) {
+            if (len > E.screencols) len = E.screencols;
+            char *c = r->render+E.coloff;
+            unsigned char *hl = r->hl+E.coloff;
+            int j;
+            for (j = 0; j < len; j++)
+            {
+                if (hl[j] == HL_NONPRINT)
+                {
+                    char sym;
+                    abAppend("\x1b[7m",4, 0);
+                    if (c[j] <= 26)
+                        sym = '@'+c[j];
+                    else
+                        sym = '?';
+                    abAppend(&sym,1, 0);
+                    abAppend("\x1b[0m",4, 0);
+                } else if (hl[j] == HL_NORMAL)
+                {
+                    if (current_color != -1)
+                    {
+                        abAppend("\x1b[39m",5, 0);
+                        current_color = -1;
+                    }
+                    abAppend(c+j,1, 0);
+                } else {
+                    int color = editorSyntaxToColor(hl[j]);
+                    if (color != current_color)
+                    {
+                        char buf[16];
+                        sprintf(buf,"\x1b[%dm",color);
+                        int clen = strlen(buf);
+                        current_color = color;
+                        abAppend(buf,clen, 0);
+                    }
+                    abAppend(c+j,1, 0);
+                }
+            }
+        }
+        abAppend("\x1b[39m",5, 0);
+        abAppend("\x1b[0K",4, 0);
+        abAppend("\r\n",2, 0);
+    }
+
+    /* Create a two rows status. First row: */
+    abAppend("\x1b[0K",4, 0);
+    abAppend("\x1b[7m",4, 0);
+    char status[80], rstatus[80];
+    sprintf(status, "%-20s - %d lines %s", E.filename, E.numrows, E.dirty > 0  ? "(modified)" : "");
+    int len = strlen(status);
+    sprintf(rstatus, "%d/%d",E.rowoff+E.cy+1,E.numrows);
+    int rlen = strlen(rstatus);
+    if (len > E.screencols) len = E.screencols;
+    abAppend(status,len, 0);
+    while(len < E.screencols) {
+        if (E.screencols - len == rlen) {
+            abAppend(rstatus,rlen, 0);
+            break;
+        } else {
+            abAppend(" ",1, 0);
+            len++;
+        }
+    }
+    abAppend("\x1b[0m\r\n",6, 0);
+
+    /* Second row depends on E.statusmsg and the status message update time. */
+    abAppend("\x1b[0K",4, 0);
+    int msglen = strlen(E.statusmsg);
+    if (msglen && sysmillis() - E.statusmsg_time < 5000)
+        abAppend(E.statusmsg,msglen <= E.screencols ? msglen : E.screencols, 0);
+
+    int j;
+    int cx = 1;
+    int filerow = E.rowoff+E.cy;
+    erow *row = editorRow(filerow);
+    if (row) {
+        for (j = E.coloff; j < (E.cx+E.coloff); j++) {
+            if (j < row->size && row->chars[j] == TAB) cx += (KILO_TAB_SIZE-1)-((cx)%KILO_TAB_SIZE);
+            cx++;
+        }
+    }
+    sprintf(buf,"\x1b[%d;%dH",E.cy+1,cx);
+    abAppend(buf,strlen(buf), 0);
+    abAppend("\x1b[?25h",6, 1);
+
+    return(lastLine);
+}
+
+// VT100 model, enough of the terminal to play back the refresh output.
+//
+typedef struct {
+    char          chr[MAX_ROWS][MAX_COLS];
+    unsigned char fg[MAX_ROWS][MAX_COLS];
+    unsigned char inv[MAX_ROWS][MAX_COLS];
+    int           row, col;
+    int           curFg, curInv;
+    int           state;                                           // 0 text, 1 after ESC, 2 in CSI.
+    char          param[32];
+    int           paramLen;
+} t_term;
+
+static int     termRows = 25;
+static int     termCols = 80;
+static t_term  term;
+static t_term  refTerm;
+static t_term  *sinkTerm;
+static size_t  sinkBytes;
+static FILE    *report;
+
+static void termErase(t_term *t, int row, int from, int to)
+{
+    for(int col=from; col < to; col++)
+    {
+        t->chr[row][col] = ' ';
+        t->fg[row][col]  = 0;
+        t->inv[row][col] = 0;
+    }
+}
+
+static void termReset(t_term *t)
+{
+    memset(t, 0, sizeof(t_term));
+    for(int row=0; row < termRows; row++)
+        termErase(t, row, 0, termCols);
+}
+
+static void termLineFeed(t_term *t)
+{
+    if(++t->row >= termRows)
+    {
+        memmove(&t->chr[0], &t->chr[1], sizeof(t->chr[0]) * (termRows - 1));
+        memmove(&t->fg[0],  &t->fg[1],  sizeof(t->fg[0])  * (termRows - 1));
+        memmove(&t->inv[0], &t->inv[1], sizeof(t->inv[0]) * (termRows - 1));
+        termErase(t, termRows - 1, 0, termCols);
+        t->row = termRows - 1;
+    }
+}
+
+static void termCsi(t_term *t, char final)
+{
+    int  args[4] = { 0, 0, 0, 0 };
+    int  nargs   = 0;
+    char *ptr    = t->param;
+
+    if(*ptr == '?')
+        return;                                                    // Cursor visibility, no effect on the screen.
+    while(*ptr && nargs < 4)
+    {
+        args[nargs++] = strtol(ptr, &ptr, 10);
+        if(*ptr == ';') ptr++;
+    }
+    int n = args[0] ? args[0] : 1;
+    switch(final)
+    {
+        case 'H':
+            t->row = (args[0] ? args[0] : 1) - 1; t->col = (args[1] ? args[1] : 1) - 1;
+            if(t->row >= termRows) t->row = termRows - 1;
+            if(t->col >= termCols) t->col = termCols - 1;
+            break;
+        case 'A': t->row = t->row - n < 0 ? 0 : t->row - n; break;
+        case 'B': t->row = t->row + n >= termRows ? termRows - 1 : t->row + n; break;
+        case 'C': t->col = t->col + n >= termCols ? termCols - 1 : t->col + n; break;
+        case 'D': t->col = (t->col >= termCols ? termCols - 1 : t->col) - n; if(t->col < 0) t->col = 0; break;
+        case 'K': termErase(t, t->row, t->col >= termCols ? termCols - 1 : t->col, termCols); break;
+        case 'J':
+            if(args[0] == 2)
+                for(int row=0; row < termRows; row++) termErase(t, row, 0, termCols);
+            else
+            {
+                termErase(t, t->row, t->col >= termCols ? termCols - 1 : t->col, termCols);
+                for(int row=t->row+1; row < termRows; row++) termErase(t, row, 0, termCols);
+            }
+            break;
+        case 'm':
+            for(int idx=0; idx < (nargs ? nargs : 1); idx++)
+            {
+                if(args[idx] == 0)                          { t->curFg = 0; t->curInv = 0; }
+                else if(args[idx] == 7)                     t->curInv = 1;
+                else if(args[idx] == 39)                    t->curFg = 0;
+                else if(args[idx] >= 30 && args[idx] <= 37) t->curFg = args[idx];
+            }
+            break;
+    }
+}
+
+static void termPut(t_term *t, char c)
+{
+    if(t->state == 1)
+    {
+        t->state    = (c == '[') ? 2 : 0;
+        t->paramLen = 0;
+        return;
+    }
+    if(t->state == 2)
+    {
+        if((c >= '0' && c <= '9') || c == ';' || c == '?')
+        {
+            if(t->paramLen < (int)sizeof(t->param) - 1)
+                t->param[t->paramLen++] = c;
+            return;
+        }
+        t->param[t->paramLen] = '\0';
+        termCsi(t, c);
+        t->state = 0;
+        return;
+    }
+    switch(c)
+    {
+        case 0x1b: t->state = 1; break;
+        case '\r': t->col = 0; break;
+        case '\n': termLineFeed(t); break;
+        default:
+            // Writing past the last column wraps first, the pending wrap of a VT100.
+            if(t->col >= termCols)
+            {
+                t->col = 0;
+                termLineFeed(t);
+            }
+            t->chr[t->row][t->col] = c;
+            t->fg[t->row][t->col]  = t->curFg;
+            t->inv[t->row][t->col] = t->curInv;
+            t->col++;
+            break;
+    }
+}
+
+static int termCompare(const t_term *a, const t_term *b)
+{
+    for(int row=0; row < termRows; row++)
+    {
+        if(memcmp(a->chr[row], b->chr[row], termCols) || memcmp(a->fg[row], b->fg[row], termCols) || memcmp(a->inv[row], b->inv[row], termCols))
+            return(row + 1);
+    }
+    return(a->row != b->row || a->col != b->col ? -1 : 0);
+}
+
+// Console stream, everything written is counted and played into the current terminal model.
+//
+static ssize_t sinkWrite(void *cookie, const char *buf, size_t size)
+{
+    for(size_t idx=0; idx < size; idx++)
+        termPut(sinkTerm, buf[idx]);
+    sinkBytes += size;
+    return(size);
+}
+
+// The editing session, one string per step, each step repeated the given number of times.
+//
+typedef struct {
+    const char *label;
+    const char *keys;
+    int        repeat;
+} t_step;
+
+static const t_step script[] = {
+    { "cursor down",        "\x1b[B",                                  12 },
+    { "cursor right",       "\x1b[C",                                  10 },
+    { "type text",          "int added = 42; /* typed */",              1 },
+    { "new line",           "\r",                                       3 },
+    { "type text",          "x = y + 1;",                               1 },
+    { "backspace",          "\x7f",                                     6 },
+    { "cursor up",          "\x1b[A",                                   8 },
+    { "end, home",          "\x1b[F\x1b[H",                             4 },
+    { "page down",          "\x1b[6~",                                  2 },
+    { "page up",            "\x1b[5~",                                  1 },
+    { "scroll down",        "\x1b[B",                                  40 },
+    { "type text",          "while(i--) { sum += table[i]; }",          1 },
+    { "delete",             "\x1b[3~",                                  8 },
+};
+#define SCRIPT_STEPS  (sizeof(script) / sizeof(script[0]))
+
+static void loadSource(void)
+{
+    static const char *lines[] = {
+        "/* Table driven checksum, sample source for the refresh benchmark. */",
+        "#include <stdint.h>",
+        "",
+        "static uint32_t table[256];",
+        "",
+        "int build(int seed)",
+        "{",
+        "\tint i, j;",
+        "\tfor(i = 0; i < 256; i++) {",
+        "\t\tuint32_t crc = i;",
+        "\t\tfor(j = 0; j < 8; j++)",
+        "\t\t\tcrc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));",
+        "\t\ttable[i] = crc ^ seed; // seeded",
+        "\t}",
+        "\treturn \"done\"[0] == 'd' ? 0 : -1;",
+        "}",
+        "",
+    };
+    char line[128];
+
+    for(int idx=0; idx < SRC_LINES; idx++)
+    {
+        snprintf(line, sizeof(line), "%s", lines[idx % (sizeof(lines) / sizeof(lines[0]))]);
+        editorInsertRow(E.numrows, line, strlen(line));
+    }
+    E.dirty = 0;
+}
+
+// Run the session with the given refresh, returns the number of screens which differ from a full redraw.
+//
+static int run(const char *label, int (*refresh)(void), int verify, uint32_t baud)
+{
+    static char name[] = "bench.c";
+    size_t      total  = 0;
+    size_t      worst  = 0;
+    size_t      bytes;
+    int         keys   = 0;
+    int         errors = 0;
+    int         diff;
+
+    E.cx = E.cy = E.rowoff = E.coloff = E.numrows = E.dirty = 0;
+    E.row          = NULL;
+    E.filename     = name;
+    E.screenrows   = termRows - 2;
+    E.screencols   = termCols;
+    virtualMillis  = 0;
+    editorSelectSyntaxHighlight(name);
+    tbInit(&E.text);
+    editorInitRows();
+    loadSource();
+    sprintf(E.statusmsg, "HELP: Ctrl-S = save | Ctrl-Q = quit | Ctrl-F = find");
+    E.statusmsg_time = 0;
+    termReset(&term);
+
+    // Initial screen, not counted.
+    sinkTerm = &term;
+    refresh();
+
+    for(uint32_t step=0; step < SCRIPT_STEPS; step++)
+    {
+        for(int rep=0; rep < script[step].repeat; rep++)
+        {
+            for(keyQueue = script[step].keys; *keyQueue; keys++)
+            {
+                editorProcessKeypress();
+                virtualMillis += 150;
+
+                sinkBytes = 0;
+                sinkTerm  = &term;
+                refresh();
+                bytes     = sinkBytes;
+                total    += bytes;
+                worst     = bytes > worst ? bytes : worst;
+
+                // Full redraw of the same state into a fresh terminal, the screens must match.
+                if(verify)
+                {
+                    termReset(&refTerm);
+                    sinkTerm = &refTerm;
+                    scrInvalidate();
+                    refresh();
+                    if((diff = termCompare(&term, &refTerm)) != 0)
+                    {
+                        if(errors++ == 0)
+                            fprintf(report, "  %s, key %d: screen differs at %s %d\n", script[step].label, keys, diff < 0 ? "cursor" : "row", diff < 0 ? 0 : diff - 1);
+                    }
+                }
+            }
+        }
+    }
+    fprintf(report, "%-22s keys %4d  bytes %8lu  avg %6lu  worst %6lu  avg %7.1f ms/key at %u baud  %s\n", label, keys, (unsigned long)total,
+           (unsigned long)(total / keys), (unsigned long)worst, (total / (double)keys) * 10000.0 / baud, baud,
+           verify ? (errors ? "SCREEN ERROR" : "ok") : "");
+    editorCleanup();
+    return(errors);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t baud   = 115200;
+    int      errors = 0;
+    int      opt;
+    cookie_io_functions_t sinkFuncs = { NULL, sinkWrite, NULL, NULL };
+
+    while((opt = getopt(argc, argv, "r:c:b:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'r': termRows = atoi(optarg); break;
+            case 'c': termCols = atoi(optarg); break;
+            case 'b': baud     = atoi(optarg); break;
+            default:
+                fprintf(stderr, "Usage: %s [-r <rows>] [-c <cols>] [-b <baud>]\n", argv[0]);
+                return(1);
+        }
+    }
+    if(termRows < 4 || termRows > MAX_ROWS || termCols < 20 || termCols > MAX_COLS)
+    {
+        fprintf(stderr, "Rows 4..%d, columns 20..%d.\n", MAX_ROWS, MAX_COLS);
+        return(1);
+    }
+
+    globals.millis = &virtualMillis;
+    G              = &globals;
+
+    // Report on the host stdout, the editor writes to the console model.
+    report = fdopen(dup(1), "w");
+    setvbuf(report, NULL, _IOLBF, 0);
+    stdout = fopencookie(NULL, "w", sinkFuncs);
+    setvbuf(stdout, NULL, _IOFBF, 4096);
+
+    fprintf(report, "Terminal %dx%d, %d line C source.\n\n", termCols, termRows, SRC_LINES);
+    errors += run("whole screen redraw", legacyRefreshScreen, 0, baud);
+    errors += run("screen shadow",       editorRefreshScreen, 1, baud);
+
+    return(errors ? 1 : 0);
+}
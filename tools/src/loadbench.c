@@ -0,0 +1,339 @@
+// loadbench.c
+//
+// Host program to compare the loading of files from the SD card into Z80 memory as loadZ80Memory() did it, a
+// sector at a time through the FatFS file window with every byte written to the bus singly, against the
+// streamed load through common/readahead.c, sector aligned multi-sector reads with block bus writes.
+//
+// The SD card is a disk image file on the host, formatted with the zOS FatFS configuration, and Z80 memory is
+// an array standing in for the bus. Both loaders run the same sequence of files: the default ROM set loaded by
+// hardResetTranZPUter() (monitor ROM and the four TZFS slices), an MZF program loaded past its header as
+// loadMZFZ80Memory() does, and a zOS image. After each load the memory is compared with the file contents.
+//
+// The K64F times are modelled from the work each loader does: a command time for each card read transaction
+// plus a time per sector transferred, a time per byte written to the bus singly or by the block transfer engine
+// and a time per full DRAM refresh. The parameters are set on the command line, all in microseconds except the
+// byte times which are in nanoseconds. The host time of the FatFS processing is shown alongside.
+//
+// Usage: loadbench [-c <cmd us>] [-s <sector us>] [-b <byte ns>] [-B <block byte ns>] [-r <refresh us>]
+//
+// Build (from the repository root):
+//   gcc -O2 -Iinclude -Icommon/FatFS -o tools/loadbench tools/src/loadbench.c common/readahead.c common/FatFS/ff.c common/FatFS/ffunicode.c
+//
+//   Created by: Philip Smart, Oct 2026.
+//
+// This software is free to use by anyone for any purpose.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "ff.h"
+#include "diskio.h"
+#include "tranzputer.h"
+#include "readahead.h"
+
+#define DISK_SECTORS  (64 * 2048)                                  // 64MB disk image.
+#define SECTOR_SIZE   512
+#define Z80_MEM_SIZE  0x100000
+
+PARTITION VolToPart[FF_VOLUMES] = {
+    {0, 1},
+    {0, 2},
+    {0, 3},
+    {0, 4},
+};
+
+// A load as made by the zOS loaders, file offset and size as passed to loadZ80Memory().
+//
+typedef struct {
+    const char        *file;
+    uint32_t          fileSize;
+    uint32_t          offset;
+    uint32_t          addr;
+    uint32_t          size;                                        // 0 = to the end of the file.
+    int               boot;                                        // Part of the hardResetTranZPUter() ROM set.
+} t_load;
+
+static const t_load loads[] = {
+    { "0:\\TZFS\\SA1510.ROM",   0x1000,  0,      0x000000, 0,      1 },
+    { "0:\\TZFS\\TZFS.ROM",     0x4800,  0,      0x00E800, 0x1800, 1 },
+    { "0:\\TZFS\\TZFS.ROM",     0x4800,  0x1800, 0x01F000, 0x1000, 1 },
+    { "0:\\TZFS\\TZFS.ROM",     0x4800,  0x2800, 0x02F000, 0x1000, 1 },
+    { "0:\\TZFS\\TZFS.ROM",     0x4800,  0x3800, 0x03F000, 0x1000, 1 },
+    { "0:\\MZF\\PROGRAM.MZF",   0xC080,  0x80,   0x041200, 0,      0 },
+    { "0:\\ZOS\\ZOS.ROM",       0x20000, 0,      0x080000, 0,      0 },
+};
+#define NLOADS        (sizeof(loads) / sizeof(t_load))
+
+// Model parameters.
+static uint32_t    cmdUs      = 120;
+static uint32_t    sectorUs   = 45;
+static uint32_t    byteNs     = 1100;
+static uint32_t    blockNs    = 300;
+static uint32_t    refreshUs  = 60;
+
+// Disk image and work counters.
+static int         diskFd     = -1;
+static uint32_t    readCmds;
+static uint32_t    readSectors;
+static uint32_t    busBytes;
+static uint32_t    busBlockBytes;
+static uint32_t    refreshes;
+static FATFS       fatFs;
+static uint8_t     z80Mem[Z80_MEM_SIZE];
+
+static uint64_t nowNs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return((uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+
+// Disk image driver, each call is one card transaction whatever its sector count.
+//
+DSTATUS disk_initialize(BYTE pdrv, BYTE cardtype) { return(pdrv == 0 ? 0 : STA_NOINIT); }
+DSTATUS disk_status(BYTE pdrv)                    { return(pdrv == 0 ? 0 : STA_NOINIT); }
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
+{
+    if(pdrv != 0 || sector + count > DISK_SECTORS) return(RES_PARERR);
+    if(pread(diskFd, buff, (size_t)count * SECTOR_SIZE, (off_t)sector * SECTOR_SIZE) != (ssize_t)count * SECTOR_SIZE) return(RES_ERROR);
+    readCmds++;
+    readSectors += count;
+    return(RES_OK);
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
+{
+    if(pdrv != 0 || sector + count > DISK_SECTORS) return(RES_PARERR);
+    if(pwrite(diskFd, buff, (size_t)count * SECTOR_SIZE, (off_t)sector * SECTOR_SIZE) != (ssize_t)count * SECTOR_SIZE) return(RES_ERROR);
+    return(RES_OK);
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
+{
+    switch(cmd)
+    {
+        case CTRL_SYNC:        return(RES_OK);
+        case GET_SECTOR_COUNT: *(DWORD *)buff = DISK_SECTORS; return(RES_OK);
+        case GET_SECTOR_SIZE:  *(WORD *)buff  = SECTOR_SIZE;  return(RES_OK);
+        case GET_BLOCK_SIZE:   *(DWORD *)buff = 1;            return(RES_OK);
+    }
+    return(RES_PARERR);
+}
+
+DWORD get_fattime(void) { return(0); }
+
+static uint8_t fileByte(const char *file, uint32_t pos) { return((uint8_t)((pos * 13) ^ (pos >> 7) ^ file[strlen(file) - 5])); }
+
+// Bus model.
+static void busRefresh(void) { refreshes++; }
+static void busWriteByte(uint32_t addr, uint8_t data) { z80Mem[addr] = data; busBytes++; }
+static void busWriteBlock(uint32_t addr, uint8_t *data, uint32_t size) { memcpy(&z80Mem[addr], data, size); busBlockBytes += size; }
+
+// The loop loadZ80Memory() used, a sector read into a stack buffer then written a byte at a time.
+//
+static FRESULT legacyLoad(FIL *file, uint32_t addr, uint32_t size, uint32_t *loaded)
+{
+    uint32_t      loadSize = 0;
+    uint32_t      memPtr   = addr;
+    uint32_t      sizeToRead;
+    unsigned int  readSize;
+    unsigned char buf[SECTOR_SIZE];
+    FRESULT       fr0;
+
+    do {
+        busRefresh();
+        sizeToRead = (size-loadSize) > SECTOR_SIZE ? SECTOR_SIZE : size - loadSize;
+        fr0 = f_read(file, buf, sizeToRead, &readSize);
+        busRefresh();
+        if (fr0 || readSize == 0) break;
+
+        for(unsigned int idx=0; idx < readSize; idx++)
+        {
+            if(idx == (SECTOR_SIZE/2))
+                busRefresh();
+            busWriteByte(memPtr, buf[idx]);
+            memPtr++;
+        }
+        loadSize += readSize;
+    } while(loadSize < size);
+    *loaded = loadSize;
+    return(fr0);
+}
+
+// The streamed load, the sink as loadZ80Sink() in tranzputer.c.
+//
+static uint8_t     loadBuf[TZ_LOAD_BUF_SIZE] __attribute__((aligned(4)));
+
+static void loadSink(void *ctx, uint8_t *data, UINT size)
+{
+    uint32_t *addr = (uint32_t *)ctx;
+
+    for(UINT idx=0, blockSize; idx < size; idx += blockSize)
+    {
+        blockSize = (size - idx) > RFSH_BYTE_CNT ? RFSH_BYTE_CNT : (size - idx);
+        busRefresh();
+        busWriteBlock(*addr + idx, data + idx, blockSize);
+    }
+    busRefresh();
+    *addr += size;
+}
+
+static FRESULT streamLoad(FIL *file, uint32_t addr, uint32_t size, uint32_t *loaded)
+{
+    return(readAheadStream(file, size, loadBuf, TZ_LOAD_BUF_SIZE, loadSink, &addr, loaded));
+}
+
+// Totals for a set of loads.
+typedef struct {
+    uint32_t          bytes;
+    uint32_t          cmds;
+    uint32_t          sectors;
+    double            modelUs;
+    double            hostUs;
+} t_totals;
+
+static int run(const char *label, FRESULT (*loader)(FIL *, uint32_t, uint32_t, uint32_t *), t_totals *boot, t_totals *all)
+{
+    FIL       File;
+    uint32_t  size;
+    uint32_t  loaded;
+    uint64_t  startNs;
+    double    modelUs;
+    double    hostUs;
+    int       errors = 0;
+    FRESULT   fr;
+
+    memset(boot, 0, sizeof(t_totals));
+    memset(all,  0, sizeof(t_totals));
+    memset(z80Mem, 0, sizeof(z80Mem));
+    printf("%s\n", label);
+    printf("  %-22s %7s %7s %6s %8s %10s %9s\n", "File", "Offset", "Bytes", "Reads", "Sectors", "Model ms", "Host ms");
+    for(uint32_t idx=0; idx < NLOADS; idx++)
+    {
+        const t_load *ld = &loads[idx];
+
+        readCmds = readSectors = busBytes = busBlockBytes = refreshes = 0;
+        startNs = nowNs();
+
+        // Open, size and seek as loadZ80Memory() does, then load.
+        fr = f_open(&File, ld->file, FA_OPEN_EXISTING | FA_READ);
+        size = ld->size;
+        if(!fr && size == 0)
+        {
+            fr = f_lseek(&File, f_size(&File));
+            if(!fr)
+                size = (uint32_t)f_tell(&File);
+        }
+        if(!fr)
+            fr = f_lseek(&File, ld->offset);
+        if(!fr)
+            fr = loader(&File, ld->addr, size, &loaded);
+        f_close(&File);
+
+        hostUs  = (nowNs() - startNs) / 1000.0;
+        modelUs = readCmds * (double)cmdUs + readSectors * (double)sectorUs + busBytes * byteNs / 1000.0 + busBlockBytes * blockNs / 1000.0 + refreshes * (double)refreshUs;
+
+        // Loaded bytes, as far as the end of the file, must match the file.
+        if(fr != FR_OK || loaded != (size < ld->fileSize - ld->offset ? size : ld->fileSize - ld->offset))
+        {
+            printf("  %s load failed, result %d, loaded %u\n", ld->file, fr, loaded);
+            errors++;
+        }
+        for(uint32_t pos=0; pos < loaded; pos++)
+        {
+            if(z80Mem[ld->addr + pos] != fileByte(ld->file, ld->offset + pos))
+            {
+                printf("  %s differs at %06x\n", ld->file, ld->addr + pos);
+                errors++;
+                break;
+            }
+        }
+        printf("  %-22s %7x %7u %6u %8u %10.2f %9.3f\n", ld->file + 3, ld->offset, loaded, readCmds, readSectors, modelUs / 1000.0, hostUs / 1000.0);
+
+        for(t_totals *tot = all; tot != NULL; tot = (tot == all && ld->boot) ? boot : NULL)
+        {
+            tot->bytes   += loaded;
+            tot->cmds    += readCmds;
+            tot->sectors += readSectors;
+            tot->modelUs += modelUs;
+            tot->hostUs  += hostUs;
+        }
+    }
+    printf("  %-30s %7u %6u %8u %10.2f %9.3f\n", "Boot ROM set", boot->bytes, boot->cmds, boot->sectors, boot->modelUs / 1000.0, boot->hostUs / 1000.0);
+    printf("  %-30s %7u %6u %8u %10.2f %9.3f\n\n", "All", all->bytes, all->cmds, all->sectors, all->modelUs / 1000.0, all->hostUs / 1000.0);
+    return(errors);
+}
+
+int main(int argc, char *argv[])
+{
+    static uint8_t work[FF_MAX_SS * 4];
+    DWORD          plist[] = {100, 0, 0, 0};
+    char           diskName[] = "/tmp/loadbenchXXXXXX";
+    uint8_t        buf[SECTOR_SIZE];
+    FIL            File;
+    UINT           writeSize;
+    t_totals       legacyBoot, legacyAll, streamBoot, streamAll;
+    int            errors = 0;
+    int            opt;
+
+    while((opt = getopt(argc, argv, "c:s:b:B:r:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'c': cmdUs     = atoi(optarg); break;
+            case 's': sectorUs  = atoi(optarg); break;
+            case 'b': byteNs    = atoi(optarg); break;
+            case 'B': blockNs   = atoi(optarg); break;
+            case 'r': refreshUs = atoi(optarg); break;
+            default:
+                printf("Usage: %s [-c <cmd us>] [-s <sector us>] [-b <byte ns>] [-B <block byte ns>] [-r <refresh us>]\n", argv[0]);
+                return(1);
+        }
+    }
+
+    // Create the disk image, the volume and the files.
+    //
+    diskFd = mkstemp(diskName);
+    if(diskFd < 0 || ftruncate(diskFd, (off_t)DISK_SECTORS * SECTOR_SIZE) != 0 || f_fdisk(0, plist, work) != FR_OK ||
+       f_mkfs("0:", FM_ANY, 0, work, sizeof(work)) != FR_OK || f_mount(&fatFs, "0:", 1) != FR_OK)
+    {
+        printf("Failed to create the FAT volume.\n");
+        return(1);
+    }
+    unlink(diskName);
+    f_mkdir("TZFS");
+    f_mkdir("MZF");
+    f_mkdir("ZOS");
+    for(uint32_t idx=0; idx < NLOADS; idx++)
+    {
+        if(idx > 0 && strcmp(loads[idx].file, loads[idx-1].file) == 0)
+            continue;
+        if(f_open(&File, loads[idx].file, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+            return(1);
+        for(uint32_t pos=0; pos < loads[idx].fileSize; pos += SECTOR_SIZE)
+        {
+            for(uint32_t byte=0; byte < SECTOR_SIZE; byte++)
+                buf[byte] = fileByte(loads[idx].file, pos + byte);
+            f_write(&File, buf, loads[idx].fileSize - pos < SECTOR_SIZE ? loads[idx].fileSize - pos : SECTOR_SIZE, &writeSize);
+        }
+        f_close(&File);
+    }
+
+    printf("Card %uus/read + %uus/sector, bus %uns/byte single, %uns/byte block, refresh %uus.\n\n", cmdUs, sectorUs, byteNs, blockNs, refreshUs);
+    errors += run("Sector at a time, byte writes:", legacyLoad, &legacyBoot, &legacyAll);
+    errors += run("Streamed, block writes:",        streamLoad, &streamBoot, &streamAll);
+
+    printf("Boot ROM set %.2f ms -> %.2f ms (%.1fx), all loads %.2f ms -> %.2f ms (%.1fx).\n",
+           legacyBoot.modelUs / 1000.0, streamBoot.modelUs / 1000.0, legacyBoot.modelUs / streamBoot.modelUs,
+           legacyAll.modelUs / 1000.0, streamAll.modelUs / 1000.0, legacyAll.modelUs / streamAll.modelUs);
+    printf("Verification: %s\n", errors ? "FAILED" : "ok");
+
+    close(diskFd);
+    return(errors ? 1 : 0);
+}
@@ -0,0 +1,378 @@
+// mallocbench.c
+//
+// Host program to replay an allocation trace against the zOS/ZPUTA heap allocators and compare them.
+//
+//   sfmalloc   - common/sfmalloc.c, segregated fit.
+//   umm        - common/umm/umm_malloc.c, best fit as configured for zOS/ZPUTA.
+//   malloc.c   - common/malloc.c, first fit.
+//
+// Each allocator is given the same fixed size arena. The trace is replayed a number of times, timing the
+// replay and, at the end of each pass before everything is released, probing for the largest block which
+// can still be allocated. Every allocation is filled with a pattern and checked before it is freed so a
+// corrupting allocator shows up as a check failure rather than a plausible looking time.
+//
+// Without a trace file a synthetic trace is generated which mimics the small allocation heavy users of the
+// heap, directory caching, readline history and the emulator menu/directory lists.
+//
+// Trace file format, one operation per line, ids are small integers naming a live allocation:
+//   m <id> <size>        allocate
+//   r <id> <size>        reallocate
+//   f <id>               free
+//
+// Build (from the repository root):
+//   gcc -O2 -Iinclude -Icommon/umm -o tools/mallocbench tools/src/mallocbench.c common/sfmalloc.c
+//
+//   Created by: Philip Smart, Oct 2026.
+//
+// This software is free to use by anyone for any purpose.
+//
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sfmalloc.h"
+
+#define ARENA_SIZE   0x10000
+#define MAX_OPS      200000
+#define MAX_IDS      4096
+
+// The two existing allocators both define malloc()/free() so pull them in under private names.
+//
+static char kl_arena[ARENA_SIZE * 2];
+void *_sbrk(int incr) { return((void *)-1); }
+
+#define malloc       kl_malloc
+#define free         kl_free
+#define malloc_add   kl_malloc_add
+#include "../../common/malloc.c"
+#undef malloc
+#undef free
+#undef malloc_add
+
+static char umm_arena[ARENA_SIZE] __attribute__((aligned(8)));
+#define __M68K__
+#define __HEAPADDR__ umm_arena
+#define __HEAPSIZE__ ARENA_SIZE
+#define UMM_BEST_FIT
+#define UMM_DBG_LOG_LEVEL 0
+#define malloc       umm_h_malloc
+#define free         umm_h_free
+#define realloc      umm_h_realloc
+#define calloc       umm_h_calloc
+#include "../../common/umm/umm_malloc.c"
+#undef malloc
+#undef free
+#undef realloc
+#undef calloc
+
+static char sfm_arena[ARENA_SIZE];
+
+typedef struct {
+    char     op;
+    uint16_t id;
+    uint32_t size;
+} TRACEOP;
+
+typedef struct {
+    const char *name;
+    void      (*init)(void);
+    void     *(*alloc)(size_t);
+    void     *(*resize)(void *, size_t, size_t);
+    void      (*release)(void *);
+} ALLOCATOR;
+
+static TRACEOP  trace[MAX_OPS];
+static int      traceLen;
+static void    *live[MAX_IDS];
+static uint32_t liveSize[MAX_IDS];
+
+// Allocator adapters.
+//
+static void kl_init(void)
+{
+    static int added = 0;
+
+    // malloc.c cannot be reset, the replay releases everything so the arena is a single free block again.
+    if(!added)
+    {
+        char *p = (char *)(((uintptr_t)kl_arena + ARENA_SIZE - 1) & ~(uintptr_t)(ARENA_SIZE - 1));
+        kl_malloc_add(p, ARENA_SIZE);
+        added = 1;
+    }
+}
+static void *kl_resize(void *p, size_t old, size_t size)
+{
+    void *n = kl_malloc(size);
+    if(n != NULL)
+    {
+        memcpy(n, p, old < size ? old : size);
+        kl_free(p);
+    }
+    return(n);
+}
+
+static void  um_init(void)                                { umm_init(); }
+static void *um_alloc(size_t size)                        { return(umm_h_malloc(size)); }
+static void *um_resize(void *p, size_t old, size_t size)  { return(umm_h_realloc(p, size)); }
+static void  um_release(void *p)                          { umm_h_free(p); }
+
+static void  sf_init(void)                                { sfm_init(); sfm_add(sfm_arena, sizeof(sfm_arena)); }
+static void *sf_resize(void *p, size_t old, size_t size)  { return(sfm_realloc(p, size)); }
+
+static ALLOCATOR allocators[] = {
+    { "sfmalloc", sf_init, sfm_malloc,   sf_resize, sfm_free   },
+    { "umm",      um_init, um_alloc,     um_resize, um_release },
+    { "malloc.c", kl_init, kl_malloc,    kl_resize, kl_free    },
+};
+
+// Deterministic generator so runs are comparable.
+//
+static uint32_t seed = 12345;
+static uint32_t rnd(uint32_t range)
+{
+    seed = seed * 1103515245 + 12345;
+    return((seed >> 8) % range);
+}
+
+static void emit(char op, int id, uint32_t size)
+{
+    if(traceLen < MAX_OPS)
+    {
+        trace[traceLen].op   = op;
+        trace[traceLen].id   = id;
+        trace[traceLen].size = size;
+        traceLen++;
+    }
+}
+
+// Synthetic workload: long lived history lines replaced FIFO, directory caches built and torn down with a
+// growing pointer array, and menus rebuilt while a few larger buffers come and go.
+//
+static void generateTrace(void)
+{
+    int pass, i, n, hist = 0;
+    int histBase = 0, dirBase = 64, menuBase = 1024, bufBase = 2048;
+
+    for(i = 0; i < 20; i++)
+        emit('m', histBase + i, 4 + rnd(76));
+
+    for(pass = 0; pass < 200; pass++)
+    {
+        // Directory cache, array of entry pointers grown by realloc, name + entry struct per file.
+        n = 20 + rnd(200);
+        emit('m', dirBase, 16 * sizeof(void *));
+        for(i = 0; i < n && dirBase + 1 + 2 * i + 1 < menuBase; i++)
+        {
+            if((i & 15) == 15)
+                emit('r', dirBase, (i + 17) * sizeof(void *));
+            emit('m', dirBase + 1 + 2 * i, 24);
+            emit('m', dirBase + 2 + 2 * i, 8 + rnd(56));
+        }
+
+        // Readline history, replace the oldest line.
+        emit('f', histBase + hist, 0);
+        emit('m', histBase + hist, 4 + rnd(76));
+        hist = (hist + 1) % 20;
+
+        // Occasional large buffer.
+        if(rnd(4) == 0)
+            emit('m', bufBase + rnd(4), 512 + rnd(3584));
+
+        // Menu rebuilt on every pass.
+        for(i = 0; i < 30; i++)
+        {
+            emit('m', menuBase + 2 * i, 48);
+            emit('m', menuBase + 2 * i + 1, 16 + rnd(24));
+        }
+        for(i = 0; i < 30; i++)
+        {
+            emit('f', menuBase + 2 * i, 0);
+            emit('f', menuBase + 2 * i + 1, 0);
+        }
+
+        // Directory cache released, entries in a different order to their allocation.
+        for(i = n - 1; i >= 0; i -= 2)
+        {
+            emit('f', dirBase + 1 + 2 * i, 0);
+            emit('f', dirBase + 2 + 2 * i, 0);
+        }
+        for(i = n - 2; i >= 0; i -= 2)
+        {
+            emit('f', dirBase + 1 + 2 * i, 0);
+            emit('f', dirBase + 2 + 2 * i, 0);
+        }
+        emit('f', dirBase, 0);
+    }
+}
+
+static int loadTrace(const char *fname)
+{
+    FILE    *fp = fopen(fname, "r");
+    char     line[80];
+    char     op;
+    unsigned id, size;
+
+    if(fp == NULL)
+    {
+        perror(fname);
+        return(1);
+    }
+    while(fgets(line, sizeof(line), fp) != NULL)
+    {
+        size = 0;
+        if(sscanf(line, " %c %u %u", &op, &id, &size) >= 2 && id < MAX_IDS && (op == 'm' || op == 'r' || op == 'f'))
+            emit(op, id, size);
+    }
+    fclose(fp);
+    return(0);
+}
+
+static void fill(void *p, uint32_t size, int id)
+{
+    memset(p, (id * 7 + 1) & 0xFF, size);
+}
+
+static int check(void *p, uint32_t size, int id)
+{
+    unsigned char *b = (unsigned char *)p;
+    uint32_t       i;
+
+    for(i = 0; i < size; i++)
+        if(b[i] != ((id * 7 + 1) & 0xFF))
+            return(1);
+    return(0);
+}
+
+// Largest block the allocator can currently provide.
+//
+static size_t probeLargest(ALLOCATOR *a)
+{
+    size_t lo = 0, hi = ARENA_SIZE, mid;
+    void  *p;
+
+    while(lo < hi)
+    {
+        mid = (lo + hi + 1) / 2;
+        if((p = a->alloc(mid)) != NULL)
+        {
+            a->release(p);
+            lo = mid;
+        } else
+            hi = mid - 1;
+    }
+    return(lo);
+}
+
+static void replay(ALLOCATOR *a, int reps)
+{
+    struct timespec t0, t1;
+    double          ns = 0;
+    int             rep, i, id;
+    unsigned        failures = 0, errors = 0, ops = 0, liveCount;
+    size_t          largest = 0;
+    uint32_t        liveBytes = 0;
+    void           *p;
+
+    for(rep = 0; rep < reps; rep++)
+    {
+        a->init();
+        memset(live, 0, sizeof(live));
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for(i = 0; i < traceLen; i++)
+        {
+            id = trace[i].id;
+            switch(trace[i].op)
+            {
+                case 'm':
+                    if(live[id] != NULL)
+                        break;
+                    live[id] = a->alloc(trace[i].size);
+                    if(live[id] == NULL) { failures++; break; }
+                    liveSize[id] = trace[i].size;
+                    fill(live[id], liveSize[id], id);
+                    break;
+                case 'r':
+                    if(live[id] == NULL)
+                        break;
+                    p = a->resize(live[id], liveSize[id], trace[i].size);
+                    if(p == NULL) { failures++; break; }
+                    errors += check(p, liveSize[id] < trace[i].size ? liveSize[id] : trace[i].size, id);
+                    live[id] = p;
+                    liveSize[id] = trace[i].size;
+                    fill(live[id], liveSize[id], id);
+                    break;
+                case 'f':
+                    if(live[id] == NULL)
+                        break;
+                    errors += check(live[id], liveSize[id], id);
+                    a->release(live[id]);
+                    live[id] = NULL;
+                    break;
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        ns  += (t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec);
+        ops += traceLen;
+
+        // End of trace state, then release everything so the next pass starts clean.
+        largest = probeLargest(a);
+        for(liveCount = 0, liveBytes = 0, id = 0; id < MAX_IDS; id++)
+        {
+            if(live[id] != NULL)
+            {
+                liveCount++;
+                liveBytes += liveSize[id];
+                errors += check(live[id], liveSize[id], id);
+                a->release(live[id]);
+                live[id] = NULL;
+            }
+        }
+    }
+    printf("%-10s %8.1f %10u %10u %12zu %8u\n", a->name, ns / ops, failures / reps, liveBytes, largest, errors);
+}
+
+int main(int argc, char **argv)
+{
+    int       reps = 20;
+    unsigned  idx;
+    SFM_STATS stats;
+
+    if(argc > 1 && loadTrace(argv[1]) != 0)
+        return(1);
+    if(argc > 2)
+        reps = atoi(argv[2]);
+    if(traceLen == 0)
+        generateTrace();
+
+    printf("%d operations, %d passes, %u byte arena\n\n", traceLen, reps, ARENA_SIZE);
+    printf("%-10s %8s %10s %10s %12s %8s\n", "allocator", "ns/op", "failures", "live", "largest", "errors");
+    for(idx = 0; idx < sizeof(allocators) / sizeof(allocators[0]); idx++)
+        replay(&allocators[idx], reps);
+
+    // Replay once more on sfmalloc stopping before the release to show its own view of the heap.
+    sf_init();
+    for(idx = 0; idx < (unsigned)traceLen; idx++)
+    {
+        if(trace[idx].op == 'm' && live[trace[idx].id] == NULL)
+            live[trace[idx].id] = sfm_malloc(trace[idx].size);
+        else if(trace[idx].op == 'r' && live[trace[idx].id] != NULL)
+            live[trace[idx].id] = sfm_realloc(live[trace[idx].id], trace[idx].size);
+        else if(trace[idx].op == 'f')
+        {
+            sfm_free(live[trace[idx].id]);
+            live[trace[idx].id] = NULL;
+        }
+    }
+    sfm_stats(&stats);
+    printf("\nsfmalloc end of trace: total=%zu used=%zu (%u blocks) free=%zu (%u blocks) largest=%zu fragmentation=%u%%\n",
+           stats.totalBytes, stats.usedBytes, stats.usedBlocks, stats.freeBytes, stats.freeBlocks, stats.largestFree, stats.fragmentation);
+    printf("allocation histogram:");
+    for(idx = 0; idx < SFM_HIST_BUCKETS; idx++)
+        printf(" %s%u:%u", idx == SFM_HIST_BUCKETS - 1 ? ">" : "<=", idx == SFM_HIST_BUCKETS - 1 ? 2048 : 8 << idx, stats.histogram[idx]);
+    printf("\n");
+    return(0);
+}
@@ -0,0 +1,325 @@
+// mzscrollbench.c
+//
+// Host program to measure the Sharp MZ ANSI terminal, common/sharpmz.c, scrolling a large text through a
+// simulated video RAM, comparing the ring buffer display store against the original which copied the whole
+// backing store and rewrote the whole screen on every new line.
+//
+// sharpmz.c is included directly so the terminal state is visible, the video controller window is mapped at
+// its fixed address so the VRAM, ARAM and scroll registers are plain memory. The original scroll is embedded
+// below verbatim and a new line is routed to it in the legacy run, with the ring head never advancing the
+// rest of the terminal behaves exactly as before.
+//
+// The text is generated, lines of varying length including lines longer than the screen, tabs and SGR colour
+// changes. After each run the visible screen is compared with the other run and against a model of the last
+// screenful of text. Built with VC_HW_SCROLL the visible screen is read from the video RAM at the hardware
+// scroll offset.
+//
+// Usage: mzscrollbench [-l <lines>]
+//
+// Build (from the repository root):
+//   gcc -O2 -D__M68K__ -D__ZOS__ -Iinclude -Icommon -Icommon/FatFS -IzOS/src -idirafter libraries/include -o tools/mzscrollbench tools/src/mzscrollbench.c
+//   gcc -O2 -D__M68K__ -D__ZOS__ -DVC_HW_SCROLL -Iinclude -Icommon -Icommon/FatFS -IzOS/src -idirafter libraries/include -o tools/mzscrollbench_hw tools/src/mzscrollbench.c
+//
+//   Created by: Philip Smart, Oct 2026.
+//
+// This software is free to use by anyone for any purpose.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+// The SoC header names its register pointer type as the host does.
+#define register_t       soc_register_t
+#include "sharpmz.c"
+
+#define VC_WINDOW_BASE   0xD00000
+#define VC_WINDOW_SIZE   0x20000
+
+static uint8_t legacyMode = 0;
+
+// The parameter parser from the target library.
+//
+int xatoi(char **str, long *res)
+{
+    char *end;
+
+    *res = strtol(*str, &end, 10);
+    if(end == *str)
+        return(0);
+    *str = end;
+    return(1);
+}
+
+// The original refresh and scroll, a flat backing store with the window written to VRAM in full.
+//
+static void legacyRefreshScreen(void)
+{
+    // Refresh the screen with buffer window contents
+    uint32_t startIdx = (display.screenRow < display.maxDisplayRow ? 0 : (display.screenRow - display.maxDisplayRow)+1) * display.maxScreenCol;
+    for(uint32_t srcIdx = startIdx, dstVRAMAddr = VIDEO_VRAM_BASE_ADDR, dstARAMAddr = VIDEO_ARAM_BASE_ADDR; srcIdx < startIdx+(display.maxDisplayRow*display.maxScreenCol); srcIdx++)
+    {
+        *(uint8_t *)(uintptr_t)(dstVRAMAddr++) = dispCodeMap[display.screenCharBuf[srcIdx]].dispCode;
+        *(uint8_t *)(uintptr_t)(dstARAMAddr++) = display.screenAttrBuf[srcIdx];
+    }
+}
+
+static uint8_t legacyScrollUp(uint8_t lines, uint8_t clear)
+{
+    // Sanity check.
+    if(lines > display.maxDisplayRow)
+        return(1);
+
+    // Restore cursor character before scrolling.
+    mzFlashCursor(CURSOR_RESTORE);
+
+    // Add the lines to the current row address. If the row exceeds the maximum then scroll the screen up.
+    display.screenRow += lines;
+    display.displayRow += lines;
+    if(display.displayRow >= display.maxDisplayRow)
+    {
+        display.displayRow = display.maxDisplayRow - 1;
+    }
+
+    // At end of buffer? Shift up.
+    if(display.screenRow >= display.maxScreenRow)
+    {
+        uint32_t srcAddr = (lines * display.maxScreenCol);
+        uint32_t dstAddr = 0;
+        for(; srcAddr < VC_DISPLAY_BUFFER_SIZE; srcAddr++, dstAddr++)
+        {
+            display.screenCharBuf[dstAddr] = display.screenCharBuf[srcAddr];
+            display.screenAttrBuf[dstAddr] = display.screenAttrBuf[srcAddr];
+        }
+        for(; dstAddr < VC_DISPLAY_BUFFER_SIZE; dstAddr++)
+        {
+            display.screenCharBuf[dstAddr] = 0x20;
+            display.screenAttrBuf[dstAddr] = display.screenAttr;
+        }
+        display.screenRow = display.maxScreenRow-1;
+    }
+    // If we havent scrolled at the end of the buffer then clear the lines scrolled if requested.
+    else if(clear && display.displayRow == display.maxDisplayRow - 1)
+    {
+        uint32_t startIdx = (display.screenRow - lines + 1) * display.maxScreenCol;
+        uint32_t endIdx   = startIdx + (lines * display.maxScreenCol);
+
+        // Clear the shadow display scrollback RAM.
+        for(uint32_t dstAddr = startIdx; dstAddr < endIdx; dstAddr++)
+        {
+            display.screenCharBuf[dstAddr] = 0x20;
+            display.screenAttrBuf[dstAddr] = display.screenAttr;
+        }
+    }
+
+    // Refresh the screen with buffer window contents
+    legacyRefreshScreen();
+    return(0);
+}
+
+// Feed a character to the terminal, in the legacy run a new line takes the original scroll.
+//
+static void termChar(char c)
+{
+    if(legacyMode && c == LF && ansiterm.state == ANSITERM_ESC)
+    {
+        legacyScrollUp(1, 1);
+        display.displayCol = 0;
+    } else
+    {
+        mzAnsiTerm(c);
+    }
+}
+
+// Generate the text, returning its length.
+//
+static uint32_t genText(char *buf, uint32_t lines)
+{
+    static const char *words[] = { "alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf", "hotel", "india", "juliet" };
+    uint32_t          len = 0;
+
+    srand(1);
+    for(uint32_t line=0; line < lines; line++)
+    {
+        uint32_t cnt = rand() % 22;
+        len += sprintf(buf + len, "%06u", line);
+        for(uint32_t w=0; w < cnt; w++)
+        {
+            switch(rand() % 8)
+            {
+                case 0:  buf[len++] = TAB; break;
+                case 1:  len += sprintf(buf + len, "\x1b[%um", 30 + (rand() % 8)); break;
+                case 2:  len += sprintf(buf + len, "\x1b[0m"); break;
+                default: break;
+            }
+            len += sprintf(buf + len, " %s", words[rand() % 10]);
+        }
+        buf[len++] = LF;
+    }
+    return(len);
+}
+
+// Model the characters on the screen once the text has been output, the last screenful of lines each
+// truncated at the last column.
+//
+static void modelScreen(const char *buf, uint32_t len, uint8_t *screen)
+{
+    uint32_t  rows = display.maxDisplayRow;
+    uint32_t  cols = display.maxScreenCol;
+    uint32_t  row  = 0;
+    uint32_t  col  = 0;
+    uint8_t  *ring = malloc(rows * cols);
+
+    memset(ring, ' ', rows * cols);
+    for(uint32_t idx=0; idx < len; idx++)
+    {
+        char c = buf[idx];
+
+        if(c == ESC)
+        {
+            while(buf[idx] != 'm') idx++;
+        } else if(c == LF)
+        {
+            row++;
+            col = 0;
+            memset(ring + (row % rows) * cols, ' ', cols);
+        } else
+        {
+            for(uint32_t cnt = (c == TAB ? 4 : 1); cnt > 0; cnt--)
+            {
+                ring[(row % rows) * cols + col] = c == TAB ? ' ' : c;
+                if(++col >= cols) col = cols - 1;
+            }
+        }
+    }
+    for(uint32_t r=0; r < rows; r++)
+    {
+        uint32_t src = row < rows ? r : (row + 1 + r) % rows;
+        for(uint32_t c=0; c < cols; c++)
+            screen[r * cols + c] = dispCodeMap[ring[src * cols + c]].dispCode;
+    }
+    free(ring);
+}
+
+// Take the visible characters and attributes from the video RAM.
+//
+static void snapScreen(uint8_t *chars, uint8_t *attrs)
+{
+    for(uint32_t pos=0; pos < display.maxDisplayRow * display.maxScreenCol; pos++)
+    {
+        chars[pos] = *(uint8_t *)(uintptr_t)(VIDEO_VRAM_BASE_ADDR + VC_VRAM_OFFSET(0, pos));
+        attrs[pos] = *(uint8_t *)(uintptr_t)(VIDEO_ARAM_BASE_ADDR + VC_VRAM_OFFSET(0, pos));
+    }
+}
+
+static uint64_t nowNs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return((uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+
+// Output the text in the given mode, returning the time taken.
+//
+static double run(uint8_t legacy, const char *buf, uint32_t len, uint8_t *chars, uint8_t *attrs)
+{
+    uint64_t startNs;
+
+    legacyMode        = legacy;
+    display.hwScroll  = 0;
+    display.screenAttr= 0x71;
+    mzClearScreen(3, 1);
+
+    startNs = nowNs();
+    for(uint32_t idx=0; idx < len; idx++)
+        termChar(buf[idx]);
+    snapScreen(chars, attrs);
+    return((nowNs() - startNs) / 1e9);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t  lines = 100000;
+    uint32_t  len;
+    uint32_t  size;
+    char     *buf;
+    uint8_t   model[VC_MAX_ROWS * VC_MAX_COLUMNS];
+    uint8_t   legacyChars[VC_MAX_ROWS * VC_MAX_COLUMNS], legacyAttrs[VC_MAX_ROWS * VC_MAX_COLUMNS];
+    uint8_t   ringChars[VC_MAX_ROWS * VC_MAX_COLUMNS],   ringAttrs[VC_MAX_ROWS * VC_MAX_COLUMNS];
+    double    legacySecs;
+    double    ringSecs;
+    double    secs[2];
+    int       errors = 0;
+    int       opt;
+
+    while((opt = getopt(argc, argv, "l:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'l': lines = atoi(optarg); break;
+            default:
+                printf("Usage: %s [-l <lines>]\n", argv[0]);
+                return(1);
+        }
+    }
+
+    if(mmap((void *)VC_WINDOW_BASE, VC_WINDOW_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED)
+    {
+        perror("mmap video window");
+        return(1);
+    }
+
+    buf  = malloc(lines * 256);
+    len  = genText(buf, lines);
+    size = display.maxDisplayRow * display.maxScreenCol;
+
+    // A short text checks the screen before it first scrolls and before the backing store fills.
+    for(uint32_t pass=0; pass < 3; pass++)
+    {
+        uint32_t passLen = pass == 0 ? len : 0;
+        if(pass > 0)
+        {
+            // Count off the first 10 or 40 lines.
+            for(uint32_t nl = 0; passLen < len && nl < (pass == 1 ? 10 : 40); passLen++)
+                if(buf[passLen] == LF) nl++;
+        }
+
+        secs[0] = run(1, buf, passLen, legacyChars, legacyAttrs);
+        secs[1] = run(0, buf, passLen, ringChars, ringAttrs);
+        if(pass == 0)
+        {
+            legacySecs = secs[0];
+            ringSecs   = secs[1];
+        }
+        modelScreen(buf, passLen, model);
+
+        if(memcmp(legacyChars, ringChars, size) != 0 || memcmp(legacyAttrs, ringAttrs, size) != 0)
+        {
+            printf("Pass %u: ring screen differs from legacy screen\n", pass);
+            errors++;
+        }
+        if(memcmp(model, ringChars, size) != 0)
+        {
+            printf("Pass %u: ring screen differs from the text model\n", pass);
+            errors++;
+        }
+    }
+    printf("Verification against legacy terminal and text model: %s\n\n", errors ? "FAILED" : "ok");
+
+  #if defined(VC_HW_SCROLL)
+    printf("Display moved with the hardware scroll register.\n");
+  #else
+    printf("Display moved by copying the video RAM.\n");
+  #endif
+    printf("%u lines, %u bytes through mzAnsiTerm()\n", lines, len);
+    printf("%-8s %10s %12s\n", "store", "secs", "lines/sec");
+    printf("%-8s %10.3f %12.0f\n", "legacy", legacySecs, lines / legacySecs);
+    printf("%-8s %10.3f %12.0f   (x%.1f)\n", "ring", ringSecs, lines / ringSecs, legacySecs / ringSecs);
+
+    free(buf);
+    return(errors ? 1 : 0);
+}
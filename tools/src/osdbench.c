@@ -0,0 +1,382 @@
+// osdbench.c
+//
+// Host program to measure OSD text rendering, common/osd.c, comparing the glyph cache and span blitter
+// behind OSDWriteString against the original string loop which drew every character pixel by pixel through
+// _OSDwrite.
+//
+// osd.c is included directly with the FPGA transfers stubbed, the framebuffer is the one OSDInit allocates on
+// the heap. The original string loop is embedded below verbatim. A menu page laid out as EMZSetupMenu and
+// EMZDrawMenu lay it out, rotated side title, title, rows with hot key highlights and an active row, is drawn
+// repeatedly by both paths and the text timed. The pages are then compared byte for byte in all colour planes, as are
+// the results of a sweep over every font, orientation, padding, offset and attribute in both windows,
+// including strings which wrap and characters which fall outside the window.
+//
+// Usage: osdbench [-n <pages>]
+//
+// Build (from the repository root):
+//   gcc -O2 -D__ZPU__ -Iinclude -Icommon -Icommon/FatFS -idirafter libraries/include -o tools/osdbench tools/src/osdbench.c
+//
+//   Created by: Philip Smart, Oct 2026.
+//
+// This software is free to use by anyone for any purpose.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// The SoC header names its register pointer type as the host does.
+#define register_t       soc_register_t
+#include "zpu_soc.h"
+
+// Types and the millisecond counter the OSD takes from the K64F environment.
+#include <stdbool.h>
+typedef uint8_t byte;
+uint32_t volatile systick_millis_count = 0;
+
+#include "osd.c"
+
+// The fonts and bitmaps are separate modules on the target, each defines the same geometry macros.
+#include "fonts/font11x16.c"
+#undef  FONT_CHAR_FIRST
+#undef  FONT_CHAR_LAST
+#undef  FONT_CHARS
+#undef  FONT_WIDTH
+#undef  FONT_HEIGHT
+#undef  FONT_SPACING
+#include "fonts/font3x6.c"
+#undef  FONT_CHAR_FIRST
+#undef  FONT_CHAR_LAST
+#undef  FONT_CHARS
+#undef  FONT_WIDTH
+#undef  FONT_HEIGHT
+#undef  FONT_SPACING
+#include "fonts/font3x6limited.c"
+#undef  FONT_CHAR_FIRST
+#undef  FONT_CHAR_LAST
+#undef  FONT_CHARS
+#undef  FONT_WIDTH
+#undef  FONT_HEIGHT
+#undef  FONT_SPACING
+#include "fonts/font5x7.c"
+#undef  FONT_CHAR_FIRST
+#undef  FONT_CHAR_LAST
+#undef  FONT_CHARS
+#undef  FONT_WIDTH
+#undef  FONT_HEIGHT
+#undef  FONT_SPACING
+#include "fonts/font5x7extended.c"
+#undef  FONT_CHAR_FIRST
+#undef  FONT_CHAR_LAST
+#undef  FONT_CHARS
+#undef  FONT_WIDTH
+#undef  FONT_HEIGHT
+#undef  FONT_SPACING
+#include "fonts/font7x8.c"
+#undef  FONT_CHAR_FIRST
+#undef  FONT_CHAR_LAST
+#undef  FONT_CHARS
+#undef  FONT_WIDTH
+#undef  FONT_HEIGHT
+#undef  FONT_SPACING
+#include "fonts/font7x8extended.c"
+#undef  FONT_CHAR_FIRST
+#undef  FONT_CHAR_LAST
+#undef  FONT_CHARS
+#undef  FONT_WIDTH
+#undef  FONT_HEIGHT
+#undef  FONT_SPACING
+#include "fonts/font9x16.c"
+#undef  FONT_CHAR_FIRST
+#undef  FONT_CHAR_LAST
+#undef  FONT_CHARS
+#undef  FONT_WIDTH
+#undef  FONT_HEIGHT
+#undef  FONT_SPACING
+#include "bitmaps/argo128x64.c"
+#undef  BITMAP_WIDTH
+#undef  BITMAP_HEIGHT
+#include "bitmaps/argo256x128.c"
+#undef  BITMAP_WIDTH
+#undef  BITMAP_HEIGHT
+#include "bitmaps/argo64x32.c"
+#undef  BITMAP_WIDTH
+#undef  BITMAP_HEIGHT
+
+static uint32_t   transferBytes        = 0;
+
+// The FPGA transfers, only the volume is of interest.
+//
+uint8_t readZ80Array(uint32_t addr, uint8_t *data, uint32_t size, enum TARGETS target)
+{
+    memset(data, 0, size);
+    return(1);
+}
+uint8_t writeZ80Array(uint32_t addr, uint8_t *data, uint32_t size, enum TARGETS target)
+{
+    transferBytes += size;
+    return(0);
+}
+
+#define PLANES           (VC_MENU_RGB_BITS > VC_STATUS_RGB_BITS ? VC_MENU_RGB_BITS : VC_STATUS_RGB_BITS)
+#define FB_SIZE          (VC_MENU_BUFFER_SIZE > VC_STATUS_BUFFER_SIZE ? VC_MENU_BUFFER_SIZE : VC_STATUS_BUFFER_SIZE)
+
+typedef void (*t_writeString)(uint8_t, uint8_t, int8_t, int8_t, uint8_t, uint8_t, enum FONTS, enum ORIENTATION, char *, uint16_t *, enum COLOUR, enum COLOUR);
+
+static uint8_t  reference[PLANES][FB_SIZE];
+static uint32_t checks   = 0;
+static uint32_t failures = 0;
+
+// The original OSDWriteString, every character through _OSDwrite.
+//
+void legacyWriteString(uint8_t x, uint8_t y, int8_t xoff, int8_t yoff, uint8_t xpad, uint8_t ypad, enum FONTS font, enum ORIENTATION orientation, char *str, uint16_t *attr, enum COLOUR fg, enum COLOUR bg)
+{
+    // Locals.
+    //
+    fontStruct    *fontptr;
+    uint8_t       startX;
+    uint8_t       startY;
+    uint8_t       maxX;
+    uint8_t       maxY;
+    uint8_t       xpos = x;
+    uint8_t       ypos = y;
+    uint8_t       *ptr;
+    uint16_t      *aptr;
+
+    // Obtain the font structure based on the provided type.
+    fontptr = OSDGetFont(font);
+
+    // Use the orientation to set the physical start and maxim coordinates for the given font.
+    switch(orientation)
+    {
+        case DEG90:
+            startX=osdWindow.params[osdWindow.mode].maxX/(fontptr->height + fontptr->spacing);
+            startY=0;
+            maxX=osdWindow.params[osdWindow.mode].maxX/(fontptr->height + fontptr->spacing);
+            maxY=osdWindow.params[osdWindow.mode].maxY/(fontptr->width + fontptr->spacing);
+            break;
+
+        case DEG180:
+            startX=osdWindow.params[osdWindow.mode].maxX/(fontptr->width + fontptr->spacing);
+            startY=osdWindow.params[osdWindow.mode].maxY/(fontptr->height + fontptr->spacing);
+            maxX=osdWindow.params[osdWindow.mode].maxX/(fontptr->width + fontptr->spacing);
+            maxY=osdWindow.params[osdWindow.mode].maxY/(fontptr->height + fontptr->spacing);
+            break;
+
+        case DEG270:
+            startX=0;
+            startY=osdWindow.params[osdWindow.mode].maxY/(fontptr->width + fontptr->spacing);
+            maxX=osdWindow.params[osdWindow.mode].maxX/(fontptr->height + fontptr->spacing);
+            maxY=osdWindow.params[osdWindow.mode].maxY/(fontptr->width + fontptr->spacing);
+            break;
+
+        case NORMAL:
+        default:
+            startX=0;
+            startY=0;
+            maxX=osdWindow.params[osdWindow.mode].maxX/(fontptr->width + fontptr->spacing);
+            maxY=osdWindow.params[osdWindow.mode].maxY/(fontptr->height + fontptr->spacing);
+            break;
+    }
+
+    // Output the string.
+    for(ptr=str,aptr=attr; *ptr != 0x00; ptr++, aptr++)
+    {
+        _OSDwrite(xpos++, ypos, xoff, yoff, xpad, ypad, orientation, (*ptr), (attr != NULL ? (*aptr) : NOATTR), fg, bg, fontptr);
+
+        if(xpos > maxX)
+        {
+            if(!osdWindow.params[osdWindow.mode].lineWrap)
+                xpos--;
+            else if(ypos < maxY)
+            {
+                ypos++;
+                xpos=0;
+            }
+        }
+    }
+
+    return;
+}
+
+static uint64_t nowNs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return((uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+
+// The text of a menu page as EMZSetupMenu and EMZDrawMenu draw it, rows with a pixel of padding above and below.
+//
+static void drawMenuText(t_writeString writeString, enum FONTS rowFont)
+{
+    static const char *rows[]  = { "Tape Storage", "Floppy Storage", "Machine", "Display", "Audio", "System", "Rom Management",
+                                   "Load Config", "Save Config", "Reset Config", "About", "Exit", "Debug Options", "Core Version" };
+    static const char  hotKey[] = "TFMDASRLSRAEDC";
+    fontStruct        *fontptr  = OSDGetFont(rowFont);
+    uint16_t          fontWidth = fontptr->width + fontptr->spacing;
+    uint8_t           maxRow    = (OSDGet(ACTIVE_MAX_Y) - 15) / (fontptr->height + fontptr->spacing + 2 + 2);
+    uint8_t           textChrX  = 40 / fontWidth;
+    char              activeBuf[80];
+    uint16_t          attrBuf[80];
+
+    writeString(0, 0, 2, 8, 0, 0, FONT_9X16, DEG270, "Main Menu", NULL, BLACK, WHITE);
+    writeString(((OSDGet(ACTIVE_MAX_X) / fontWidth) - (30 / fontWidth)) / 2 - 4, 0, 0, 0, 0, 0, rowFont, NORMAL, "Main Menu", NULL, WHITE, BLACK);
+
+    for(uint8_t row=0; row < maxRow && row < sizeof(rows)/sizeof(rows[0]); row++)
+    {
+        memset(attrBuf, NOATTR, sizeof(attrBuf));
+        sprintf(activeBuf, " %-30s%-15s%c", rows[row], row % 3 == 0 ? "On" : "Off", row % 4 == 1 ? 0x10 : ' ');
+        for(uint8_t idx=0; activeBuf[idx]; idx++)
+        {
+            if(activeBuf[idx] == hotKey[row])
+            {
+                attrBuf[idx] = HILIGHT_FG_CYAN;
+                break;
+            }
+        }
+        if(row == 3)
+            writeString(textChrX, row, 0, 15, 0, 1, rowFont, NORMAL, activeBuf, attrBuf, BLUE, WHITE);
+        else if(row == 9)
+            writeString(textChrX, row, 0, 15, 0, 1, rowFont, NORMAL, activeBuf, attrBuf, PURPLE, BLACK);
+        else
+            writeString(textChrX, row, 0, 15, 0, 1, rowFont, NORMAL, activeBuf, attrBuf, WHITE, BLACK);
+    }
+    writeString(textChrX+1, 0, 0, 4, 0, 0, FONT_5X7, NORMAL, "\x1b back", NULL, CYAN, BLACK);
+    writeString(textChrX+38, 0, 0, 4, 0, 0, FONT_5X7, NORMAL, "scroll \x19", NULL, CYAN, BLACK);
+}
+
+// A menu page, the background then the text.
+//
+static void drawMenuPage(t_writeString writeString, enum FONTS rowFont)
+{
+    OSDClearScreen(WHITE);
+    OSDClearArea(30, -1, -1, -1, BLACK);
+    drawMenuText(writeString, rowFont);
+}
+
+// Compare the framebuffer with the reference, reporting the first difference.
+//
+static void compare(const char *what)
+{
+    checks++;
+    for(uint8_t c=0; c < PLANES; c++)
+    {
+        for(uint32_t idx=0; idx < FB_SIZE; idx++)
+        {
+            if(osdWindow.display[c][idx] != reference[c][idx])
+            {
+                printf("Difference: %s, plane %d byte %u, %02x expected %02x.\n", what, c, idx, osdWindow.display[c][idx], reference[c][idx]);
+                failures++;
+                return;
+            }
+        }
+    }
+}
+
+// Draw a string by both paths from the same starting framebuffer and compare.
+//
+static void sweepString(uint8_t x, uint8_t y, int8_t xoff, int8_t yoff, uint8_t xpad, uint8_t ypad, enum FONTS font, enum ORIENTATION orientation, char *str, uint16_t *attr, enum COLOUR fg, enum COLOUR bg)
+{
+    uint8_t  start[PLANES][FB_SIZE];
+    char     what[128];
+
+    memcpy(start, osdWindow.display, sizeof(start));
+    legacyWriteString(x, y, xoff, yoff, xpad, ypad, font, orientation, str, attr, fg, bg);
+    memcpy(reference, osdWindow.display, sizeof(reference));
+    memcpy(osdWindow.display, start, sizeof(start));
+    OSDWriteString(x, y, xoff, yoff, xpad, ypad, font, orientation, str, attr, fg, bg);
+    sprintf(what, "font %d orientation %d at %d,%d offset %d,%d pad %d,%d colour %d/%d", font, orientation, x, y, xoff, yoff, xpad, ypad, fg, bg);
+    compare(what);
+}
+
+int main(int argc, char *argv[])
+{
+    static const enum FONTS fonts[] = { FONT_3X6, FONT_5X7, FONT_7X8, FONT_9X16, FONT_11X16 };
+    uint32_t                pages   = 2000;
+    uint64_t                legacyNs;
+    uint64_t                blitNs;
+    uint64_t                start;
+    uint16_t                attr[64];
+    char                    text[64];
+    int                     opt;
+
+    while((opt = getopt(argc, argv, "n:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n': pages = atoi(optarg); break;
+            default:
+                printf("Usage: %s [-n <pages>]\n", argv[0]);
+                return(1);
+        }
+    }
+    if(OSDInit(MENU))
+        return(1);
+
+    // Menu page, the text timed on its own as the background is drawn the same way by both.
+    drawMenuPage(legacyWriteString, FONT_5X7);
+    start = nowNs();
+    for(uint32_t idx=0; idx < pages; idx++)
+        drawMenuText(legacyWriteString, FONT_5X7);
+    legacyNs = nowNs() - start;
+    memcpy(reference, osdWindow.display, sizeof(reference));
+
+    drawMenuPage(OSDWriteString, FONT_5X7);
+    start = nowNs();
+    for(uint32_t idx=0; idx < pages; idx++)
+        drawMenuText(OSDWriteString, FONT_5X7);
+    blitNs = nowNs() - start;
+    compare("menu page");
+
+    printf("Menu page text, 512x128, %u pages:\n", pages);
+    printf("  Per pixel, _OSDwrite:     %8.1f us/page\n", (double)legacyNs / pages / 1000.0);
+    printf("  Glyph cache and blitter:  %8.1f us/page  (%.1fx)\n", (double)blitNs / pages / 1000.0, (double)legacyNs / (blitNs ? blitNs : 1));
+    printf("  Fonts rotated into the cache: %u\n", OSDGet(GLYPH_CACHE_BUILDS));
+
+    // Menu page in the 7x8 font.
+    drawMenuPage(legacyWriteString, FONT_7X8);
+    memcpy(reference, osdWindow.display, sizeof(reference));
+    drawMenuPage(OSDWriteString, FONT_7X8);
+    compare("menu page, 7x8 font");
+
+    // Sweep, both windows, every font and orientation, padding, offsets and highlights over a coloured background.
+    for(uint8_t window=STATUS; window <= MENU; window++)
+    {
+        OSDSetActiveWindow(window);
+        for(uint8_t f=0; f < sizeof(fonts)/sizeof(fonts[0]); f++)
+        {
+            for(uint8_t orientation=NORMAL; orientation <= DEG270; orientation++)
+            {
+                for(uint8_t pad=0; pad < 4; pad++)
+                {
+                    OSDClearScreen(pad % 2 ? PURPLE : BLACK);
+                    OSDDrawLine(0, 0, -1, -1, GREEN);
+                    for(uint8_t idx=0; idx < 40; idx++)
+                    {
+                        text[idx] = 0x20 + ((idx * 7 + f * 13 + pad) % 0x5f);
+                        attr[idx] = idx % 5 == 0 ? HILIGHT_FG_YELLOW : idx % 7 == 0 ? HILIGHT_BG_RED : idx % 11 == 0 ? HILIGHT_FG_BLUE|HILIGHT_BG_GREEN : NOATTR;
+                    }
+                    text[40] = 0x00;
+                    sweepString(0, 0, 0, 0, pad, pad / 2, fonts[f], orientation, text, NULL, WHITE, BLACK);
+                    sweepString(3, 1, pad, 2, pad / 2, pad, fonts[f], orientation, text, attr, YELLOW, BLUE);
+                    sweepString(1, 2, -1, 3, 0, 1, fonts[f], orientation, &text[20], attr, CYAN, RED);
+                    sweepString(5, 0, 7, 1, pad, 0, fonts[f], orientation, "\x01\x7f\x80\xff", NULL, GREEN, WHITE);
+
+                    // Lines which wrap, then with wrap off.
+                    osdWindow.params[osdWindow.mode].lineWrap = 1;
+                    sweepString(60, 1, 0, 0, 0, 0, fonts[f], orientation, text, attr, WHITE, BLUE);
+                    osdWindow.params[osdWindow.mode].lineWrap = 0;
+                    sweepString(60, 2, 0, 0, 0, 0, fonts[f], orientation, text, attr, RED, BLACK);
+                    osdWindow.params[osdWindow.mode].lineWrap = 1;
+                }
+            }
+        }
+    }
+    printf("Compared %u renderings byte for byte, %u differ.\n", checks, failures);
+    printf("Verification: %s\n", failures ? "FAILED" : "ok");
+    return(failures ? 1 : 0);
+}
@@ -0,0 +1,663 @@
+// sdhcbench.cpp
+//
+// Host program to exercise the polled K64F SD card driver, teensy3/NXP_SDHC.cpp, against a model of the SDHC
+// controller and an SD card, comparing sector at a time transfers (CMD17/CMD24) with the multiple block
+// transfers (CMD18/CMD25 with Auto CMD12, writes preceded by ACMD23) and driving the data error paths.
+//
+// The driver source is compiled as is, the controller registers it uses are routed to the model which runs on
+// a virtual clock. Every register access costs the CPU a fixed time. Commands take a fixed time on the bus and
+// data moves at 4 bits per 25MHz SD clock through a controller buffer of one block, the card stopping the clock
+// when the buffer is full on a read and waiting for data when it is empty on a write. A read starts after the
+// card access time and each further block after a short gap, a single block write keeps the card busy for the
+// programming time whilst a multiple block write has a shorter busy time per block, plus an erase time for each
+// block not announced by ACMD23, and the programming time once Auto CMD12 has stopped the transfer. Status bits
+// are write one to clear as on the controller.
+//
+// Two sets of runs are made:
+//   throughput - sequential reads and writes of 1 to 128 blocks a call, each done a block at a time and as one
+//                multiple block transfer, giving KB/s on the virtual clock. The data is checked on every call.
+//   errors     - a data timeout, data CRC error, Auto CMD12 failure or silent stall of the card is injected into
+//                a transfer. The call must return an error, must not hang (5 seconds of virtual time is taken
+//                as a hang, well past the driver's own poll limits), must leave the card out of its data state
+//                and the same transfer must then succeed.
+//
+// Usage: sdhcbench [-a <access ns>] [-r <read access us>] [-p <program us>] [-b <multi block busy us>]
+//                  [-e <erase us/block>] [-k <KB per size>]
+//
+// Build (from the repository root):
+//   g++ -O2 -D__MK64FX512__ -DF_CPU=120000000 -DTEENSYDUINO=144 -Iteensy3 -o tools/sdhcbench tools/src/sdhcbench.cpp
+//
+//   Created by: Philip Smart, Oct 2026.
+//
+// This software is free to use by anyone for any purpose.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <unistd.h>
+#include "core_pins.h"
+
+// Controller registers used by the polled transfer paths.
+enum { REG_IRQSTAT, REG_PRSSTAT, REG_XFERTYP, REG_CMDARG, REG_CMDRSP0, REG_CMDRSP1, REG_CMDRSP2, REG_CMDRSP3, REG_BLKATTR, REG_DATPORT, REG_COUNT };
+
+static uint32_t modelRead(int);
+static void     modelWrite(int, uint32_t);
+
+// A register of the model, reads and writes go through the model so status and buffer accesses act as on the controller.
+//
+struct ModelReg {
+    int id;
+    operator uint32_t() const                { return(modelRead(id)); }
+    ModelReg &operator=(uint32_t value)      { modelWrite(id, value); return(*this); }
+    ModelReg &operator=(const ModelReg &reg) { return(*this = (uint32_t)reg); }
+    ModelReg &operator|=(uint32_t value)     { return(*this = (uint32_t)*this | value); }
+    ModelReg &operator&=(uint32_t value)     { return(*this = (uint32_t)*this & value); }
+};
+static ModelReg modelReg[REG_COUNT] = { {REG_IRQSTAT}, {REG_PRSSTAT}, {REG_XFERTYP}, {REG_CMDARG}, {REG_CMDRSP0},
+                                        {REG_CMDRSP1}, {REG_CMDRSP2}, {REG_CMDRSP3}, {REG_BLKATTR}, {REG_DATPORT} };
+
+#undef  SDHC_IRQSTAT
+#define SDHC_IRQSTAT     modelReg[REG_IRQSTAT]
+#undef  SDHC_PRSSTAT
+#define SDHC_PRSSTAT     modelReg[REG_PRSSTAT]
+#undef  SDHC_XFERTYP
+#define SDHC_XFERTYP     modelReg[REG_XFERTYP]
+#undef  SDHC_CMDARG
+#define SDHC_CMDARG      modelReg[REG_CMDARG]
+#undef  SDHC_CMDRSP0
+#define SDHC_CMDRSP0     modelReg[REG_CMDRSP0]
+#undef  SDHC_CMDRSP1
+#define SDHC_CMDRSP1     modelReg[REG_CMDRSP1]
+#undef  SDHC_CMDRSP2
+#define SDHC_CMDRSP2     modelReg[REG_CMDRSP2]
+#undef  SDHC_CMDRSP3
+#define SDHC_CMDRSP3     modelReg[REG_CMDRSP3]
+#undef  SDHC_BLKATTR
+#define SDHC_BLKATTR     modelReg[REG_BLKATTR]
+#undef  SDHC_DATPORT
+#define SDHC_DATPORT     modelReg[REG_DATPORT]
+
+#include "NXP_SDHC.cpp"
+
+#define SECTORS          4096                // 2MB card.
+#define BLOCK_WORDS      (SDHC_BLOCK_SIZE / 4)
+#define BUF_WORDS        BLOCK_WORDS         // Controller buffer.
+#define WML_WORDS        SDHC_FIFO_BUFFER_SIZE
+#define WORD_NS          320                 // 8 SD clocks at 25MHz on a 4 bit bus.
+#define CMD_NS           4500                // Command, card response time and response.
+#define BLOCK_GAP_NS     2000                // CRC, end bit and access time between the blocks of a read.
+#define NWR_NS           80                  // Clocks before a write block.
+#define BWR_NS           200                 // Time for the controller to raise buffer write ready again.
+#define BWR_START_NS     1000                // Time after a write command completes to the first buffer write ready.
+#define HANG_NS          5000000000ULL       // Virtual time in one call taken as a hang.
+#define MAX_BLOCKS       128
+
+enum INJECT { INJ_NONE, INJ_DTOE, INJ_DCE, INJ_AC12, INJ_STALL };
+
+// Controller and card model.
+//
+static struct {
+    uint64_t  now;                           // Virtual time, ns.
+    uint64_t  callStart;
+    uint32_t  irqstat;
+    uint32_t  cmdarg;
+    uint32_t  blkattr;
+    uint32_t  xfertyp;
+    uint32_t  rsp[4];
+    uint64_t  cmdDoneAt;                     // Time the command in progress completes, 0 when none.
+    uint8_t   appCmd;                        // CMD55 received, the next command is an application command.
+    int32_t   eraseCount;                    // Blocks given by ACMD23 for the next write, -1 when none.
+    uint8_t   cardData;                      // Card is sending or receiving, a stop command is needed.
+    // Data transfer.
+    uint8_t   active;
+    uint8_t   write;
+    uint8_t   autoStop;
+    uint32_t  sector;
+    uint32_t  total;                         // Words in the transfer.
+    uint32_t  moved;                         // Words moved between the card and the buffer.
+    uint32_t  host;                          // Words moved between the buffer and the CPU.
+    uint32_t  preErased;                     // Blocks announced by ACMD23.
+    uint64_t  nextWordAt;
+    uint64_t  doneAt;                        // Time the transfer completes once all blocks have moved, 0 before.
+    uint8_t   bwrRaised;
+    uint64_t  bwrAt;
+    // Injected fault.
+    enum INJECT inject;
+    uint32_t  injectBlock;
+    // Card contents, the data written by the CPU is staged until the card takes the block.
+    uint32_t  image[SECTORS * BLOCK_WORDS];
+    uint32_t  stage[SECTORS * BLOCK_WORDS];
+    // Counts.
+    uint32_t  cmds;
+    uint32_t  acmd23;
+    uint32_t  stops;
+    uint32_t  protoErrors;
+} m;
+
+static jmp_buf    hangJmp;
+static uint32_t   accessNs  = 50;
+static uint32_t   readNs    = 100000;
+static uint32_t   progNs    = 250000;
+static uint32_t   busyNs    = 20000;
+static uint32_t   eraseNs   = 10000;
+
+// Method to record a use of the controller which the card or controller would not accept.
+//
+static void protoError(const char *what)
+{
+    if(m.protoErrors++ < 10)
+        printf("  protocol error: %s\n", what);
+}
+
+// End the data phase of the controller, the card stays in its data state unless the transfer completed.
+//
+static void endData(uint32_t irqBits, uint8_t complete)
+{
+    m.irqstat |= irqBits;
+    m.active   = 0;
+    if(complete)
+        m.cardData = 0;
+}
+
+// Command completion, starting the data phase of a data command.
+//
+static void commandDone(uint64_t at)
+{
+    uint32_t  index = (m.xfertyp >> 24) & 0x3F;
+    uint8_t   app   = m.appCmd;
+    uint32_t  blocks;
+    int32_t   eraseCount = m.eraseCount;
+
+    m.irqstat   |= SDHC_IRQSTAT_CC;
+    m.rsp[0]     = 0x00000900;               // Ready for data, transfer state.
+    m.appCmd     = 0;
+    m.eraseCount = -1;
+
+    if(index == SDHC_CMD55)
+    {
+        m.appCmd     = 1;
+        m.eraseCount = eraseCount;
+        return;
+    }
+    if(app && index == (SDHC_ACMD23 & 0x3F))
+    {
+        m.eraseCount = m.cmdarg & 0x007FFFFF;
+        m.acmd23++;
+        return;
+    }
+    if(index == SDHC_CMD12)
+    {
+        m.active   = 0;
+        m.cardData = 0;
+        m.stops++;
+        return;
+    }
+    if(!(m.xfertyp & SDHC_XFERTYP_DPSEL))
+        return;
+
+    if(m.cardData)
+        protoError("data command whilst the card is in a data state");
+    if((m.blkattr & 0x1FFF) != SDHC_BLOCK_SIZE)
+        protoError("block size");
+    blocks = (m.xfertyp & SDHC_XFERTYP_MSBSEL) ? (m.blkattr >> 16) : 1;
+    if(!(m.xfertyp & SDHC_XFERTYP_MSBSEL) != (index == SDHC_CMD17 || index == SDHC_CMD24))
+        protoError("single block command with the multiple block select or the reverse");
+    if((m.xfertyp & SDHC_XFERTYP_MSBSEL) && (m.xfertyp & (SDHC_XFERTYP_BCEN | SDHC_XFERTYP_AC12EN)) != (SDHC_XFERTYP_BCEN | SDHC_XFERTYP_AC12EN))
+        protoError("multiple block transfer without block count and Auto CMD12");
+    if(!(m.xfertyp & SDHC_XFERTYP_DTDSEL) != (index == SDHC_CMD24 || index == SDHC_CMD25))
+        protoError("transfer direction");
+    if(index == SDHC_CMD25 && eraseCount != (int32_t)blocks)
+        protoError("ACMD23 block count does not match the write");
+    if(blocks == 0 || blocks > MAX_BLOCKS || m.cmdarg + blocks > SECTORS)
+    {
+        protoError("transfer outside the card");
+        return;
+    }
+
+    m.active     = 1;
+    m.cardData   = 1;
+    m.write      = !(m.xfertyp & SDHC_XFERTYP_DTDSEL);
+    m.autoStop   = (m.xfertyp & SDHC_XFERTYP_AC12EN) ? 1 : 0;
+    m.sector     = m.cmdarg;
+    m.total      = blocks * BLOCK_WORDS;
+    m.moved      = 0;
+    m.host       = 0;
+    m.preErased  = (index == SDHC_CMD25 && eraseCount > 0) ? eraseCount : 0;
+    m.doneAt     = 0;
+    m.nextWordAt = at + (m.write ? NWR_NS : readNs);
+    m.bwrRaised  = 0;
+    m.bwrAt      = at + BWR_START_NS;
+}
+
+// Move the controller and card on to the current time.
+//
+static void modelUpdate(void)
+{
+    uint64_t  at;
+    uint32_t  block;
+    uint32_t  busy;
+
+    if(m.cmdDoneAt && m.now >= m.cmdDoneAt)
+    {
+        at          = m.cmdDoneAt;
+        m.cmdDoneAt = 0;
+        commandDone(at);
+    }
+    if(!m.active)
+        return;
+
+    if(!m.write)
+    {
+        while(m.moved < m.total && m.nextWordAt <= m.now && m.moved - m.host < BUF_WORDS)
+        {
+            block = m.moved / BLOCK_WORDS;
+            // No data from the card, the controller times out or the card has silently stopped.
+            if(m.inject == INJ_DTOE && block == m.injectBlock)
+            {
+                m.inject = INJ_NONE;
+                endData(SDHC_IRQSTAT_DTOE, 0);
+                return;
+            }
+            if(m.inject == INJ_STALL && block == m.injectBlock)
+                return;
+            at = m.nextWordAt;
+            m.moved++;
+            m.nextWordAt += WORD_NS;
+            if(m.moved % BLOCK_WORDS == 0)
+            {
+                if(m.inject == INJ_DCE && block == m.injectBlock)
+                {
+                    m.inject = INJ_NONE;
+                    endData(SDHC_IRQSTAT_DCE, 0);
+                    return;
+                }
+                m.nextWordAt += BLOCK_GAP_NS;
+            }
+            if(m.moved == m.total)
+                m.doneAt = at + WORD_NS + (m.autoStop ? CMD_NS : 0);
+        }
+        if(m.moved - m.host >= WML_WORDS)
+            m.irqstat |= SDHC_IRQSTAT_BRR;
+        if(m.doneAt && m.now >= m.doneAt && m.host == m.total)
+        {
+            if(m.autoStop && m.inject == INJ_AC12)
+            {
+                m.inject = INJ_NONE;
+                endData(SDHC_IRQSTAT_AC12E, 0);
+            } else
+                endData(SDHC_IRQSTAT_TC, 1);
+        }
+        return;
+    }
+
+    while(m.moved < m.total && m.nextWordAt <= m.now && m.host > m.moved)
+    {
+        block = m.moved / BLOCK_WORDS;
+        at    = m.nextWordAt;
+        if(m.inject == INJ_STALL && block == m.injectBlock)
+            return;
+        m.moved++;
+        m.nextWordAt += WORD_NS;
+        if(m.moved % BLOCK_WORDS == 0)
+        {
+            // Card CRC status for the block, then busy whilst it is programmed.
+            if((m.inject == INJ_DCE || m.inject == INJ_DTOE) && block == m.injectBlock)
+            {
+                endData(m.inject == INJ_DCE ? SDHC_IRQSTAT_DCE : SDHC_IRQSTAT_DTOE, 0);
+                m.inject = INJ_NONE;
+                return;
+            }
+            memcpy(&m.image[(m.sector + block) * BLOCK_WORDS], &m.stage[(m.sector + block) * BLOCK_WORDS], SDHC_BLOCK_SIZE);
+            busy = m.autoStop ? busyNs + (block < m.preErased ? 0 : eraseNs) : progNs;
+            m.nextWordAt = at + WORD_NS + busy + NWR_NS;
+            if(m.moved == m.total)
+                m.doneAt = at + WORD_NS + busy + (m.autoStop ? CMD_NS + progNs : 0);
+        }
+    }
+    if(m.host < m.total && BUF_WORDS - (m.host - m.moved) >= WML_WORDS && !m.bwrRaised && m.now >= m.bwrAt)
+    {
+        m.irqstat  |= SDHC_IRQSTAT_BWR;
+        m.bwrRaised = 1;
+    }
+    if(m.doneAt && m.now >= m.doneAt)
+    {
+        if(m.autoStop && m.inject == INJ_AC12)
+        {
+            m.inject = INJ_NONE;
+            endData(SDHC_IRQSTAT_AC12E, 0);
+        } else
+            endData(SDHC_IRQSTAT_TC, 1);
+    }
+}
+
+// Method to advance the clock by a register access and bring the model up to date.
+//
+static void modelAccess(void)
+{
+    m.now += accessNs;
+    if(m.now - m.callStart > HANG_NS)
+        longjmp(hangJmp, 1);
+    modelUpdate();
+}
+
+static uint32_t modelRead(int id)
+{
+    uint32_t  value = 0;
+
+    modelAccess();
+    switch(id)
+    {
+        case REG_IRQSTAT:
+            value = m.irqstat;
+            break;
+        case REG_PRSSTAT:
+            if(m.cmdDoneAt)
+                value |= SDHC_PRSSTAT_CIHB;
+            if(m.active)
+                value |= SDHC_PRSSTAT_CDIHB | SDHC_PRSSTAT_DLA;
+            if(m.active && !m.write && m.moved - m.host >= WML_WORDS)
+                value |= SDHC_PRSSTAT_BREN;
+            break;
+        case REG_CMDRSP0:
+        case REG_CMDRSP1:
+        case REG_CMDRSP2:
+        case REG_CMDRSP3:
+            value = m.rsp[id - REG_CMDRSP0];
+            break;
+        case REG_DATPORT:
+            if(!m.active || m.write || m.host >= m.moved)
+            {
+                protoError("read of an empty buffer");
+                break;
+            }
+            // A full buffer had stopped the card clock, it restarts now.
+            if(m.moved - m.host == BUF_WORDS && m.nextWordAt < m.now)
+                m.nextWordAt = m.now;
+            value = m.image[m.sector * BLOCK_WORDS + m.host++];
+            break;
+        default:
+            break;
+    }
+    return(value);
+}
+
+static void modelWrite(int id, uint32_t value)
+{
+    modelAccess();
+    switch(id)
+    {
+        case REG_IRQSTAT:
+            m.irqstat &= ~value;
+            break;
+        case REG_CMDARG:
+            m.cmdarg = value;
+            break;
+        case REG_BLKATTR:
+            m.blkattr = value;
+            break;
+        case REG_XFERTYP:
+            if(m.cmdDoneAt)
+                protoError("command issued whilst the command line is busy");
+            if((value & SDHC_XFERTYP_DPSEL) && m.active)
+                protoError("data command issued whilst the data line is busy");
+            m.xfertyp   = value;
+            m.cmdDoneAt = m.now + CMD_NS;
+            m.cmds++;
+            break;
+        case REG_DATPORT:
+            if(!m.active || !m.write || m.host >= m.total || m.host - m.moved >= BUF_WORDS)
+            {
+                protoError("write to a full buffer");
+                break;
+            }
+            // An empty buffer had the card waiting for data.
+            if(m.host == m.moved && m.nextWordAt < m.now)
+                m.nextWordAt = m.now;
+            m.stage[m.sector * BLOCK_WORDS + m.host++] = value;
+            if(m.host % WML_WORDS == 0)
+            {
+                m.bwrRaised = 0;
+                m.bwrAt     = m.now + BWR_NS;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// Return the model to idle after a hang.
+//
+static void modelReset(void)
+{
+    m.irqstat    = 0;
+    m.cmdDoneAt  = 0;
+    m.appCmd     = 0;
+    m.eraseCount = -1;
+    m.cardData   = 0;
+    m.active     = 0;
+    m.inject     = INJ_NONE;
+}
+
+// Method to make a driver call on the virtual clock, returning the driver result or -1 on a hang along with the time taken.
+//
+static int runCall(uint8_t write, uint8_t multi, uint32_t *buf, uint32_t sector, uint32_t count, uint64_t *ns)
+{
+    // Locals.
+    volatile int       result = SDHC_RESULT_OK;
+    volatile uint32_t  idx;
+
+    m.callStart = m.now;
+    if(setjmp(hangJmp))
+    {
+        modelReset();
+        *ns = m.now - m.callStart;
+        return(-1);
+    }
+    if(multi)
+        result = write ? SDHC_CardWriteBlocks(buf, sector, count) : SDHC_CardReadBlocks(buf, sector, count);
+    else
+    {
+        for(idx=0; idx < count && result == SDHC_RESULT_OK; idx++)
+            result = write ? SDHC_CardWriteBlock(buf + idx * BLOCK_WORDS, sector + idx) : SDHC_CardReadBlock(buf + idx * BLOCK_WORDS, sector + idx);
+    }
+    *ns = m.now - m.callStart;
+    return(result);
+}
+
+// Method to fill a buffer with data unique to the sector, word and pass.
+//
+static void fillPattern(uint32_t *buf, uint32_t sector, uint32_t count, uint32_t pass)
+{
+    for(uint32_t idx=0; idx < count * BLOCK_WORDS; idx++)
+        buf[idx] = ((sector * BLOCK_WORDS + idx) * 2654435761u) ^ (pass * 0x9E3779B9u);
+}
+
+// Throughput of sequential transfers a block at a time against multiple block transfers for each size.
+//
+static int runThroughput(uint32_t totalKB)
+{
+    // Locals.
+    static uint32_t   buf[MAX_BLOCKS * BLOCK_WORDS];
+    static uint32_t   expect[MAX_BLOCKS * BLOCK_WORDS];
+    static const uint32_t sizes[] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+    uint32_t          totalBlocks = totalKB * 2;
+    uint32_t          pass = 1;
+    uint32_t          cmds[2];
+    double            kbs[2][2];
+    uint64_t          ns;
+    uint64_t          sum;
+    int               errors = 0;
+    int               result;
+
+    printf("Throughput, %u KB sequential per run, KB/s on the virtual clock:\n", totalKB);
+    printf("  %6s %10s %10s %7s %10s %10s %7s %10s %10s\n", "Blocks", "Rd block", "Rd multi", "Gain", "Wr block", "Wr multi", "Gain", "Cmds blk", "Cmds mul");
+    for(uint32_t sz=0; sz < sizeof(sizes)/sizeof(sizes[0]); sz++)
+    {
+        uint32_t count = sizes[sz];
+
+        cmds[0] = cmds[1] = 0;
+        for(uint8_t multi=0; multi < 2; multi++)
+        {
+            for(uint8_t write=0; write < 2; write++)
+            {
+                uint32_t startCmds = m.cmds;
+
+                sum = 0;
+                for(uint32_t sector=0; sector + count <= totalBlocks; sector += count)
+                {
+                    if(write)
+                    {
+                        fillPattern(buf, sector, count, pass);
+                        result = runCall(1, multi, buf, sector, count, &ns);
+                        if(result != SDHC_RESULT_OK || memcmp(&m.image[sector * BLOCK_WORDS], buf, count * SDHC_BLOCK_SIZE))
+                        {
+                            printf("  write of %u blocks at %u failed, result %d\n", count, sector, result);
+                            errors++;
+                        }
+                    } else
+                    {
+                        memcpy(expect, &m.image[sector * BLOCK_WORDS], count * SDHC_BLOCK_SIZE);
+                        memset(buf, 0, count * SDHC_BLOCK_SIZE);
+                        result = runCall(0, multi, buf, sector, count, &ns);
+                        if(result != SDHC_RESULT_OK || memcmp(expect, buf, count * SDHC_BLOCK_SIZE))
+                        {
+                            printf("  read of %u blocks at %u failed, result %d\n", count, sector, result);
+                            errors++;
+                        }
+                    }
+                    sum += ns;
+                }
+                kbs[multi][write] = (totalBlocks / count) * count / 2.0 / (sum / 1e9);
+                cmds[multi]      += m.cmds - startCmds;
+                pass++;
+            }
+        }
+        printf("  %6u %10.0f %10.0f %6.2fx %10.0f %10.0f %6.2fx %10u %10u\n", count, kbs[0][0], kbs[1][0], kbs[1][0] / kbs[0][0],
+               kbs[0][1], kbs[1][1], kbs[1][1] / kbs[0][1], cmds[0], cmds[1]);
+    }
+    printf("\n");
+    return(errors);
+}
+
+// Inject each fault into a transfer and check the driver returns an error without hanging and the card recovers.
+//
+static int runErrors(void)
+{
+    // Locals.
+    static uint32_t   buf[MAX_BLOCKS * BLOCK_WORDS];
+    static const struct {
+        uint8_t      write;
+        uint32_t     count;
+        enum INJECT  inject;
+        uint32_t     block;
+    } cases[] = {
+        { 0, 1, INJ_DTOE,  0 }, { 0, 1, INJ_DCE,   0 }, { 0, 1, INJ_STALL, 0 },
+        { 0, 8, INJ_DTOE,  3 }, { 0, 8, INJ_DCE,   3 }, { 0, 8, INJ_DCE,   7 }, { 0, 8, INJ_STALL, 3 }, { 0, 8, INJ_AC12, 0 },
+        { 1, 1, INJ_DTOE,  0 }, { 1, 1, INJ_DCE,   0 }, { 1, 1, INJ_STALL, 0 },
+        { 1, 8, INJ_DTOE,  3 }, { 1, 8, INJ_DCE,   3 }, { 1, 8, INJ_DCE,   7 }, { 1, 8, INJ_STALL, 3 }, { 1, 8, INJ_AC12, 0 },
+    };
+    static const char *injectName[] = { "none", "data timeout", "data CRC error", "Auto CMD12 error", "stall" };
+    const uint32_t    sector = 64;
+    uint64_t          ns;
+    uint64_t          retryNs;
+    int               errors = 0;
+    int               result;
+    int               retry;
+    uint8_t           ok;
+
+    printf("Error paths:\n");
+    for(uint32_t idx=0; idx < sizeof(cases)/sizeof(cases[0]); idx++)
+    {
+        char          where[32];
+
+        if(cases[idx].inject == INJ_AC12)
+            sprintf(where, "at the stop");
+        else
+            sprintf(where, "at block %u", cases[idx].block);
+
+        fillPattern(buf, sector, cases[idx].count, 1000 + idx);
+        m.inject      = cases[idx].inject;
+        m.injectBlock = cases[idx].block;
+        result = runCall(cases[idx].write, 1, buf, sector, cases[idx].count, &ns);
+        m.inject      = INJ_NONE;
+
+        // Retry the same transfer, it must go through and a write must then read back.
+        ok = 0;
+        if(result > 0 && !m.cardData && !m.active)
+        {
+            if(cases[idx].write)
+            {
+                retry = runCall(1, 1, buf, sector, cases[idx].count, &retryNs);
+                ok    = retry == SDHC_RESULT_OK && !memcmp(&m.image[sector * BLOCK_WORDS], buf, cases[idx].count * SDHC_BLOCK_SIZE);
+            } else
+            {
+                memset(buf, 0, cases[idx].count * SDHC_BLOCK_SIZE);
+                retry = runCall(0, 1, buf, sector, cases[idx].count, &retryNs);
+                ok    = retry == SDHC_RESULT_OK && !memcmp(&m.image[sector * BLOCK_WORDS], buf, cases[idx].count * SDHC_BLOCK_SIZE);
+            }
+        }
+        printf("  %-5s %u block%s, %-16s %-12s ", cases[idx].write ? "write" : "read", cases[idx].count, cases[idx].count == 1 ? " " : "s",
+               injectName[cases[idx].inject], where);
+        if(result < 0)
+            printf("hang\n");
+        else
+            printf("result %d after %9.1f us, %s\n", result, ns / 1000.0, ok ? "recovered" : "NOT recovered");
+        if(result <= 0 || !ok)
+            errors++;
+    }
+    printf("\n");
+    return(errors);
+}
+
+int main(int argc, char *argv[])
+{
+    // Locals.
+    int               opt;
+    int               errors = 0;
+    uint32_t          totalKB = 256;
+
+    while((opt = getopt(argc, argv, "a:r:p:b:e:k:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'a': accessNs = atoi(optarg);          break;
+            case 'r': readNs   = atoi(optarg) * 1000;   break;
+            case 'p': progNs   = atoi(optarg) * 1000;   break;
+            case 'b': busyNs   = atoi(optarg) * 1000;   break;
+            case 'e': eraseNs  = atoi(optarg) * 1000;   break;
+            case 'k': totalKB  = atoi(optarg);          break;
+            default:
+                printf("Usage: %s [-a <access ns>] [-r <read access us>] [-p <program us>] [-b <multi block busy us>] [-e <erase us/block>] [-k <KB per size>]\n", argv[0]);
+                return(1);
+        }
+    }
+    if(totalKB < 64 || totalKB > SECTORS / 2)
+    {
+        printf("KB per size must be 64 to %u.\n", SECTORS / 2);
+        return(1);
+    }
+
+    // A high capacity card, initialised and selected.
+    modelReset();
+    fillPattern(m.image, 0, SECTORS, 0);
+    sdCardDesc.status       = 0;
+    sdCardDesc.highCapacity = 1;
+    sdCardDesc.version2     = 1;
+    sdCardDesc.address      = 0x12340000;
+    sdCardDesc.numBlocks    = SECTORS;
+
+    printf("Register access %uns, read access %uus, program %uus, multi block busy %uus, erase %uus/block.\n\n",
+           accessNs, readNs / 1000, progNs / 1000, busyNs / 1000, eraseNs / 1000);
+
+    errors += runThroughput(totalKB);
+    errors += runErrors();
+    if(m.protoErrors)
+        errors++;
+
+    printf("Commands %u, ACMD23 %u, CMD12 %u, protocol errors %u.\n", m.cmds, m.acmd23, m.stops, m.protoErrors);
+    printf("Verification: %s\n", errors ? "FAILED" : "ok");
+    return(errors ? 1 : 0);
+}
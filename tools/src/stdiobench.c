@@ -0,0 +1,185 @@
+// stdiobench.c
+//
+// Host program to measure the umlibc stdio output path with the stream buffering and block write callback
+// added to libraries/umlibc/stdio.
+//
+// A printf heavy workload, a directory listing followed by a memory dump, is written to a sink device
+// through the umlibc stdio sources compiled for the host. The device counts the calls made to it and the
+// characters sent, the time spent is the host time plus a modelled cost per device call and per character
+// given in nanoseconds with -c and -b, standing in for the call overhead and UART register access on the
+// ZPU. Each configuration must produce exactly the same output as the original per character path.
+//
+// Usage: stdiobench [-n <repeats>] [-c <ns/call>] [-b <ns/char>]
+//
+// Build (from the repository root):
+//   gcc -O2 -fno-builtin -Ilibraries/umlibc/include -o tools/stdiobench tools/src/stdiobench.c libraries/umlibc/stdio/{vfprintf,fprintf,printf,snprintf,sprintf,fputc,fputs,puts,fwrite,fputblk,fflush,setvbuf,iob}.c
+//
+//   Created by: Philip Smart, Oct 2026.
+//
+// This software is free to use by anyone for any purpose.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// The umlibc stdint.h clashes with the host unistd.h, declare the few host calls needed.
+extern long  write(int, const void *, size_t);
+extern int   getopt(int, char * const [], const char *);
+extern char *optarg;
+
+#define SINK_SIZE     (4 * 1024 * 1024)
+
+// Sink device, captures the output and counts the work done.
+//
+static char     *sink;
+static char     *reference;
+static size_t   sinkLen;
+static size_t   referenceLen;
+static uint32_t putCalls;
+static uint32_t writeCalls;
+static uint32_t callNs       = 2000;
+static uint32_t charNs       = 100;
+static int      repeats      = 20;
+
+static int sinkPut(char c, FILE *stream)
+{
+    putCalls++;
+    if(sinkLen < SINK_SIZE)
+        sink[sinkLen++] = c;
+    return(0);
+}
+
+static int sinkWrite(const char *buf, int len, FILE *stream)
+{
+    writeCalls++;
+    if(sinkLen + len <= SINK_SIZE)
+    {
+        memcpy(sink + sinkLen, buf, len);
+        sinkLen += len;
+    }
+    return(0);
+}
+
+static uint64_t nowNs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return((uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+
+// Report through the host write() as the host stdio is replaced by the umlibc functions.
+//
+#define report(...) do { \
+                        char line[160]; \
+                        int  len = snprintf(line, sizeof(line), __VA_ARGS__); \
+                        write(1, line, len < (int)sizeof(line) ? len : (int)sizeof(line) - 1); \
+                    } while(0)
+
+// The workload, typical console output of the dir and dump commands.
+//
+static void workload(FILE *out)
+{
+    static const char *names[] = { "AUTOEXEC.BAT", "MZ80A_BASIC.MZF", "TZFS.ROM", "ZOS.BIN", "KILO.ZPU", "ED.ZPU", "README.TXT", "HELLO.C" };
+
+    for(int rep=0; rep < repeats; rep++)
+    {
+        fputs("Directory of 0:\\\n", out);
+        for(uint32_t idx=0; idx < 64; idx++)
+        {
+            fprintf(out, "%-16s %8lu  %02u/%02u/%04u %02u:%02u %s\n", names[idx % 8], (unsigned long)(idx * 1237 + 512),
+                    (unsigned)(idx % 28) + 1, (unsigned)(idx % 12) + 1, 2026u, (unsigned)idx % 24, (unsigned)idx % 60, idx & 1 ? "R" : "-");
+        }
+        fprintf(out, "%u files, %lu bytes free.\n", 64u, 123456789UL);
+
+        for(uint32_t addr=0; addr < 1024; addr += 16)
+        {
+            fprintf(out, "%08lX: ", (unsigned long)addr);
+            for(uint32_t idx=0; idx < 16; idx++)
+                fprintf(out, "%02X ", (unsigned)((addr + idx) * 13) & 0xff);
+            fputs(" |", out);
+            for(uint32_t idx=0; idx < 16; idx++)
+                fputc(' ' + (((addr + idx) * 7) % 95), out);
+            puts("|");
+        }
+    }
+}
+
+// Run the workload through a stream configured with the given buffering and block write handler.
+//
+static int run(const char *label, int useWrite, int mode, size_t bufSize)
+{
+    static FILE stream;
+    uint64_t    startNs;
+    double      hostUs;
+    double      modelUs;
+    uint32_t    calls;
+    int         ok;
+
+    fdev_setup_stream(&stream, sinkPut, NULL, _FDEV_SETUP_WRITE);
+    if(useWrite)
+        fdev_set_block(&stream, sinkWrite, NULL);
+    if(mode != _IONBF)
+        setvbuf(&stream, NULL, mode, bufSize);
+    stdout   = &stream;
+
+    sinkLen    = 0;
+    putCalls   = 0;
+    writeCalls = 0;
+    startNs    = nowNs();
+    workload(&stream);
+    fflush(&stream);
+    hostUs     = (nowNs() - startNs) / 1000.0;
+    setvbuf(&stream, NULL, _IONBF, 0);
+    stdout     = NULL;
+
+    calls   = putCalls + writeCalls;
+    modelUs = hostUs + (calls * (double)callNs + sinkLen * (double)charNs) / 1000.0;
+
+    if(reference == NULL)
+    {
+        reference    = (char *)malloc(sinkLen);
+        referenceLen = sinkLen;
+        memcpy(reference, sink, sinkLen);
+    }
+    ok = (sinkLen == referenceLen && memcmp(sink, reference, sinkLen) == 0);
+
+    report("%-26s chars %7lu  put %7lu  write %6lu  host %8lu us  model %8lu us  %8lu chars/s  %s\n", label,
+           (unsigned long)sinkLen, (unsigned long)putCalls, (unsigned long)writeCalls, (unsigned long)hostUs, (unsigned long)modelUs,
+           (unsigned long)(sinkLen * 1000000.0 / modelUs), ok ? "ok" : "OUTPUT DIFFERS");
+    return(ok ? 0 : 1);
+}
+
+int main(int argc, char *argv[])
+{
+    int errors = 0;
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:c:b:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n': repeats = atoi(optarg); break;
+            case 'c': callNs  = atoi(optarg); break;
+            case 'b': charNs  = atoi(optarg); break;
+            default:
+                report("Usage: %s [-n <repeats>] [-c <ns/call>] [-b <ns/char>]\n", argv[0]);
+                return(1);
+        }
+    }
+    if((sink = (char *)malloc(SINK_SIZE)) == NULL)
+        return(1);
+
+    report("Workload repeated %d times, device call %uns, character %uns.\n\n", repeats, callNs, charNs);
+    errors += run("per char put",             0, _IONBF, 0);
+    errors += run("block write, unbuffered",  1, _IONBF, 0);
+    errors += run("block write, line buffer", 1, _IOLBF, BUFSIZ);
+    errors += run("block write, full buffer", 1, _IOFBF, BUFSIZ);
+    errors += run("put only, full buffer",    0, _IOFBF, BUFSIZ);
+
+    free(sink);
+    free(reference);
+    return(errors ? 1 : 0);
+}
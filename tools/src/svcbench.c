@@ -0,0 +1,286 @@
+// svcbench.c
+//
+// Host program to measure the turnaround of the tranZPUter file read service with and without read-ahead,
+// common/readahead.c.
+//
+// The Z80 side posts TZSVC_CMD_READFILE/NEXTREADFILE requests into a mailbox laid out like the service record
+// and the service side answers each as svcReadFile() does. With read-ahead enabled the service then fetches the
+// next sector, exactly where processServiceRequest() calls svcReadFile(TZSVC_PREFETCH) after releasing the Z80.
+//
+// The two processors run concurrently on the real hardware so the timing is simulated on a virtual clock
+// rather than with threads, which keeps the results independent of the host core count. The file lives on
+// a RAM disk FAT volume, each sector read from the disk costs the card latency given with -r and the Z80
+// spends the time given with -z consuming each sector, both in microseconds. The service side host
+// processing time is added to the card time. A request posted whilst the service side is still busy
+// prefetching waits for it, as the K64F only checks for a new request once the prefetch returns.
+//
+// Each run is repeated for a sequential read of the file and for a read which jumps every few sectors, the
+// data received by the Z80 is checked against the file contents in both cases.
+//
+// Usage: svcbench [-s <file KB>] [-r <card us/sector>] [-z <Z80 us/sector>]
+//
+// Build (from the repository root):
+//   gcc -O2 -Iinclude -Icommon/FatFS -o tools/svcbench tools/src/svcbench.c common/readahead.c common/FatFS/ff.c common/FatFS/ffunicode.c
+//
+//   Created by: Philip Smart, Oct 2026.
+//
+// This software is free to use by anyone for any purpose.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "ff.h"
+#include "diskio.h"
+#include "tranzputer.h"
+#include "readahead.h"
+
+#define DISK_SECTORS  (16 * 2048)                                  // 16MB RAM disk.
+#define SECTOR_SIZE   512
+#define TEST_FILE     "0:\\MZF\\BIGFILE.MZF"
+#define JUMP_EVERY    8                                            // Random pattern, jump after this many sequential requests.
+
+PARTITION VolToPart[FF_VOLUMES] = {
+    {0, 1},
+    {0, 2},
+    {0, 3},
+    {0, 4},
+};
+
+// Service mailbox, the fields of the service record used by the file read service.
+//
+typedef struct {
+    uint8_t           cmd;
+    uint8_t           result;
+    uint8_t           fileSector;
+    uint16_t          loadSize;
+    uint8_t           sector[TZSVC_SECTOR_SIZE];
+} t_mailbox;
+
+static uint8_t     *disk;
+static uint32_t    cardUs      = 200;
+static uint32_t    z80Us       = 1500;
+static uint32_t    sectorReads;
+static FATFS       fatFs;
+static t_mailbox   mailbox;
+static FIL         File;
+static t_readAhead readAhead;
+static uint8_t     fileOpen;
+
+static uint64_t nowNs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return((uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+
+// RAM disk driver, reads are counted to be charged at the card latency.
+//
+DSTATUS disk_initialize(BYTE pdrv, BYTE cardtype) { return(pdrv == 0 ? 0 : STA_NOINIT); }
+DSTATUS disk_status(BYTE pdrv)                    { return(pdrv == 0 ? 0 : STA_NOINIT); }
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
+{
+    if(pdrv != 0 || sector + count > DISK_SECTORS) return(RES_PARERR);
+    memcpy(buff, disk + (size_t)sector * SECTOR_SIZE, (size_t)count * SECTOR_SIZE);
+    sectorReads += count;
+    return(RES_OK);
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
+{
+    if(pdrv != 0 || sector + count > DISK_SECTORS) return(RES_PARERR);
+    memcpy(disk + (size_t)sector * SECTOR_SIZE, buff, (size_t)count * SECTOR_SIZE);
+    return(RES_OK);
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
+{
+    switch(cmd)
+    {
+        case CTRL_SYNC:        return(RES_OK);
+        case GET_SECTOR_COUNT: *(DWORD *)buff = DISK_SECTORS; return(RES_OK);
+        case GET_SECTOR_SIZE:  *(WORD *)buff  = SECTOR_SIZE;  return(RES_OK);
+        case GET_BLOCK_SIZE:   *(DWORD *)buff = 1;            return(RES_OK);
+    }
+    return(RES_PARERR);
+}
+
+DWORD get_fattime(void) { return(0); }
+
+static uint8_t fileByte(uint32_t pos) { return((uint8_t)(pos * 7 + (pos >> 9))); }
+
+// Time charged to the service side for work started at a host time, the host processing plus the card latency.
+//
+static double serviceUs(uint64_t startNs, uint32_t startReads)
+{
+    return((nowNs() - startNs) / 1000.0 + (sectorReads - startReads) * (double)cardUs);
+}
+
+// Service side, the equivalent of processServiceRequest() and svcReadFile() for the read commands. Returns
+// non zero if a prefetch should follow.
+//
+static int serviceRequest(t_mailbox *mb)
+{
+    FRESULT        result    = FR_OK;
+    UINT           readSize;
+
+    if(mb->cmd == TZSVC_CMD_READFILE)
+    {
+        if(fileOpen)
+            f_close(&File);
+        result   = f_open(&File, TEST_FILE, FA_OPEN_EXISTING | FA_READ);
+        fileOpen = (result == FR_OK);
+        if(fileOpen)
+            readAheadInit(&readAhead, &File);
+    }
+    if(result == FR_OK && fileOpen && (mb->cmd == TZSVC_CMD_READFILE || mb->cmd == TZSVC_CMD_NEXTREADFILE))
+    {
+        result = readAheadRead(&readAhead, mb->fileSector, mb->sector, &readSize);
+        if(!result)
+            mb->loadSize = readSize;
+    } else
+    if(mb->cmd == TZSVC_CMD_CLOSE)
+    {
+        if(fileOpen)
+            f_close(&File);
+        fileOpen = 0;
+    }
+    mb->result = (result == FR_OK ? TZSVC_STATUS_OK : TZSVC_STATUS_FILE_ERROR);
+    return(result == FR_OK && mb->cmd != TZSVC_CMD_CLOSE);
+}
+
+// Read the file through the mailbox, sequentially or jumping every JUMP_EVERY sectors.
+//
+static int run(const char *label, uint32_t fileSize, int jump, int readAheadOn)
+{
+    uint32_t sectors     = (fileSize + TZSVC_SECTOR_SIZE - 1) / TZSVC_SECTOR_SIZE;
+    uint32_t sector      = 0;
+    double   z80Time     = 0.0;                                    // Virtual time on the Z80 side.
+    double   serviceFree = 0.0;                                    // Virtual time the service side finishes its current work.
+    double   turnaround;
+    double   total       = 0.0;
+    double   worst       = 0.0;
+    double   start;
+    uint64_t startNs;
+    uint32_t startReads;
+    int      doReadAhead;
+    int      errors      = 0;
+
+    for(uint32_t idx=0; idx < sectors && !errors; idx++)
+    {
+        // Z80 posts the request, the service side picks it up once any prefetch has finished.
+        mailbox.cmd        = (idx == 0 ? TZSVC_CMD_READFILE : TZSVC_CMD_NEXTREADFILE);
+        mailbox.fileSector = (uint8_t)sector;
+        mailbox.result     = TZSVC_STATUS_REQUEST;
+        start              = z80Time > serviceFree ? z80Time : serviceFree;
+
+        startNs     = nowNs();
+        startReads  = sectorReads;
+        doReadAhead = serviceRequest(&mailbox);
+        serviceFree = start + serviceUs(startNs, startReads);
+        turnaround  = serviceFree - z80Time;
+        z80Time     = serviceFree;
+
+        // Z80 released, the service side prefetches whilst the Z80 consumes.
+        if(readAheadOn && doReadAhead)
+        {
+            startNs     = nowNs();
+            startReads  = sectorReads;
+            readAheadFetch(&readAhead);
+            serviceFree += serviceUs(startNs, startReads);
+        }
+
+        if(mailbox.result != TZSVC_STATUS_OK)
+        {
+            errors++;
+            break;
+        }
+        total += turnaround;
+        worst  = turnaround > worst ? turnaround : worst;
+
+        // Consume the sector and check it.
+        for(uint32_t pos=0; pos < mailbox.loadSize; pos++)
+        {
+            if(mailbox.sector[pos] != fileByte(sector * TZSVC_SECTOR_SIZE + pos))
+            {
+                errors++;
+                break;
+            }
+        }
+        z80Time += z80Us;
+
+        // Next sector, optionally jumping forward to exercise seeks and dropped prefetches.
+        if(jump && (idx % JUMP_EVERY) == JUMP_EVERY - 1)
+            sector = (sector + JUMP_EVERY * 3) % sectors;
+        else
+            sector = (sector + 1) % sectors;
+    }
+    printf("%-24s avg %7.1f us  worst %7.1f us  total %8.1f ms  hits %4u misses %4u drops %3u  %s\n", label, total / sectors, worst, z80Time / 1000.0,
+           readAhead.hits, readAhead.misses, readAhead.drops, errors ? "DATA ERROR" : "ok");
+
+    mailbox.cmd = TZSVC_CMD_CLOSE;
+    serviceRequest(&mailbox);
+    return(errors);
+}
+
+int main(int argc, char *argv[])
+{
+    static uint8_t work[FF_MAX_SS * 4];
+    DWORD          plist[] = {100, 0, 0, 0};
+    uint32_t       fileSize = 64 * 1024;
+    uint8_t        buf[TZSVC_SECTOR_SIZE];
+    FIL            File;
+    UINT           writeSize;
+    int            errors   = 0;
+    int            opt;
+
+    while((opt = getopt(argc, argv, "s:r:z:")) != -1)
+    {
+        switch(opt)
+        {
+            case 's': fileSize = atoi(optarg) * 1024; break;
+            case 'r': cardUs   = atoi(optarg); break;
+            case 'z': z80Us    = atoi(optarg); break;
+            default:
+                printf("Usage: %s [-s <file KB>] [-r <card us/sector>] [-z <Z80 us/sector>]\n", argv[0]);
+                return(1);
+        }
+    }
+    if(fileSize == 0 || fileSize > 255 * TZSVC_SECTOR_SIZE)
+    {
+        printf("File size must be 1..127KB, the service record sector number is 8 bit.\n");
+        return(1);
+    }
+
+    // Create the volume and the test file.
+    //
+    disk = (uint8_t *)calloc(DISK_SECTORS, SECTOR_SIZE);
+    if(disk == NULL || f_fdisk(0, plist, work) != FR_OK || f_mkfs("0:", FM_ANY, 0, work, sizeof(work)) != FR_OK || f_mount(&fatFs, "0:", 1) != FR_OK)
+    {
+        printf("Failed to create the FAT volume.\n");
+        return(1);
+    }
+    f_mkdir("MZF");
+    if(f_open(&File, TEST_FILE, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+        return(1);
+    for(uint32_t pos=0; pos < fileSize; pos += TZSVC_SECTOR_SIZE)
+    {
+        for(uint32_t idx=0; idx < TZSVC_SECTOR_SIZE; idx++)
+            buf[idx] = fileByte(pos + idx);
+        f_write(&File, buf, fileSize - pos < TZSVC_SECTOR_SIZE ? fileSize - pos : TZSVC_SECTOR_SIZE, &writeSize);
+    }
+    f_close(&File);
+
+    printf("File %u bytes, card %uus/sector, Z80 consume %uus/sector.\n\n", fileSize, cardUs, z80Us);
+    errors += run("on demand, sequential",  fileSize, 0, 0);
+    errors += run("on demand, jumping",     fileSize, 1, 0);
+    errors += run("read-ahead, sequential", fileSize, 0, 1);
+    errors += run("read-ahead, jumping",    fileSize, 1, 1);
+
+    free(disk);
+    return(errors ? 1 : 0);
+}
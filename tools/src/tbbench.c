@@ -0,0 +1,483 @@
+// tbbench.c
+//
+// Host program to compare the memory used by the kilo and ed editors to hold a file, the original array of
+// rows read in full against the piece table in common/textbuf.c, and to check the piece table edits.
+//
+// The original editors allocated, per line, a row record and a copy of the line, kilo adding a rendered copy
+// with tabs expanded and a highlight byte per rendered character. With the piece table the file stays on the
+// disk, the heap holds the piece table, the add buffer of inserted text and a cache of the rows on screen.
+// Heap use is counted through the sys_malloc family with a per allocation overhead given by -o.
+//
+// The file lives on a RAM disk FAT volume, disk sectors read are counted and charged at the card latency given
+// with -r to give the time to open the file and to display the first screen.
+//
+// The edits, inserting and deleting characters, splitting and joining lines and inserting rows at random
+// positions, are mirrored on a reference array of lines and the text compared after each, the file is then
+// saved over itself and the saved bytes compared with the reference, CR/LF line endings included, before it is
+// reopened and compared again.
+//
+// Usage: tbbench [-l <lines>] [-e <edits>] [-r <card us/sector>] [-o <malloc overhead bytes>]
+//
+// Build (from the repository root):
+//   gcc -O2 -D__APP__ -Iinclude -Icommon/FatFS -o tools/tbbench tools/src/tbbench.c common/textbuf.c common/FatFS/ff.c common/FatFS/ffunicode.c
+//
+//   Created by: Philip Smart, Oct 2026.
+//
+// This software is free to use by anyone for any purpose.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ff.h"
+#include "diskio.h"
+#include "textbuf.h"
+
+#define DISK_SECTORS  (16 * 2048)                                  // 16MB RAM disk.
+#define SECTOR_SIZE   512
+#define TEST_FILE     "0:\\EDIT.C"
+#define SCREEN_ROWS   23                                           // 25 line terminal less the status rows.
+#define ROW_ALLOC     80                                           // KILO_ROW_ALLOC / ED_ROW_ALLOC.
+#define TAB_SIZE      4
+#define MAX_LINE      200
+
+PARTITION VolToPart[FF_VOLUMES] = {
+    {0, 1},
+    {0, 2},
+    {0, 3},
+    {0, 4},
+};
+
+// Reference copy of the text.
+//
+typedef struct {
+    char              *text;
+    int               len;
+    int               crlf;
+} t_line;
+
+static uint8_t     *disk;
+static uint32_t    cardUs      = 200;
+static uint32_t    overhead    = 8;
+static uint32_t    sectorReads;
+static FATFS       fatFs;
+static t_line      *ref;
+static int         refLines;
+static int         refMax;
+
+// RAM disk driver, reads are counted to be charged at the card latency.
+//
+DSTATUS disk_initialize(BYTE pdrv, BYTE cardtype) { return(pdrv == 0 ? 0 : STA_NOINIT); }
+DSTATUS disk_status(BYTE pdrv)                    { return(pdrv == 0 ? 0 : STA_NOINIT); }
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
+{
+    if(pdrv != 0 || sector + count > DISK_SECTORS) return(RES_PARERR);
+    memcpy(buff, disk + (size_t)sector * SECTOR_SIZE, (size_t)count * SECTOR_SIZE);
+    sectorReads += count;
+    return(RES_OK);
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
+{
+    if(pdrv != 0 || sector + count > DISK_SECTORS) return(RES_PARERR);
+    memcpy(disk + (size_t)sector * SECTOR_SIZE, buff, (size_t)count * SECTOR_SIZE);
+    return(RES_OK);
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
+{
+    switch(cmd)
+    {
+        case CTRL_SYNC:        return(RES_OK);
+        case GET_SECTOR_COUNT: *(DWORD *)buff = DISK_SECTORS; return(RES_OK);
+        case GET_SECTOR_SIZE:  *(WORD *)buff  = SECTOR_SIZE;  return(RES_OK);
+        case GET_BLOCK_SIZE:   *(DWORD *)buff = 1;            return(RES_OK);
+    }
+    return(RES_PARERR);
+}
+
+DWORD get_fattime(void) { return(0); }
+
+// Counting heap as seen by the app, each block is charged its size plus the allocator overhead.
+//
+static size_t heapUsed;
+static size_t heapPeak;
+
+void *sys_malloc(size_t size)
+{
+    size_t *blk = malloc(size + sizeof(size_t));
+
+    if(blk == NULL) return(NULL);
+    *blk      = size;
+    heapUsed += size + overhead;
+    if(heapUsed > heapPeak) heapPeak = heapUsed;
+    return(blk + 1);
+}
+
+void sys_free(void *ptr)
+{
+    size_t *blk = (size_t *)ptr - 1;
+
+    if(ptr == NULL) return;
+    heapUsed -= *blk + overhead;
+    free(blk);
+}
+
+void *sys_realloc(void *ptr, size_t size)
+{
+    void   *blk;
+
+    if(ptr == NULL) return(sys_malloc(size));
+    if((blk = sys_malloc(size)) == NULL) return(NULL);
+    memcpy(blk, ptr, ((size_t *)ptr)[-1] < size ? ((size_t *)ptr)[-1] : size);
+    sys_free(ptr);
+    return(blk);
+}
+
+static void resetHeap(void)
+{
+    heapUsed = heapPeak = 0;
+}
+
+// Rendered length of a line, tabs expanded as editorUpdateRow() does.
+//
+static int renderLen(const char *line, int len)
+{
+    int rlen = 0;
+
+    for(int idx=0; idx < len; idx++)
+    {
+        if(line[idx] == '\t') { rlen++; while((rlen+1) % TAB_SIZE != 0) rlen++; }
+        else rlen++;
+    }
+    return(rlen);
+}
+
+// The original editors, every line read into a row record and a copy of the line, kilo adding the rendered
+// line and its highlight. The row array grows a row at a time through realloc as in editorInsertRow().
+//
+static void legacyOpen(int kilo, size_t *peak, uint32_t *reads)
+{
+    FIL     fp;
+    char    buf[MAX_LINE+2];
+    void    **rows = NULL;
+    size_t  rowSize = kilo ? 40 : 12;
+    char    *row = NULL;
+    int     numrows = 0;
+    int     len;
+
+    resetHeap();
+    sectorReads = 0;
+    f_open(&fp, TEST_FILE, FA_OPEN_EXISTING | FA_READ);
+    while(f_gets(buf, sizeof(buf), &fp) != NULL)
+    {
+        len = strlen(buf);
+        while(len && (buf[len-1] == '\n' || buf[len-1] == '\r')) len--;
+        row = sys_realloc(row, rowSize * (numrows+1));
+        rows = realloc(rows, sizeof(void *) * (numrows+1) * 3);
+        rows[numrows*3]   = sys_malloc(len+1);
+        rows[numrows*3+1] = kilo ? sys_malloc(renderLen(buf, len)+1) : NULL;
+        rows[numrows*3+2] = kilo && renderLen(buf, len) ? sys_malloc(renderLen(buf, len)) : NULL;
+        numrows++;
+    }
+    f_close(&fp);
+    *peak  = heapPeak;
+    *reads = sectorReads;
+    for(int idx=0; idx < numrows*3; idx++) sys_free(rows[idx]);
+    sys_free(row);
+    free(rows);
+}
+
+// Heap for the row cache once the first screen is displayed, as editorRow() fills it.
+//
+static size_t cacheHeap(t_textBuf *tb, int kilo)
+{
+    char   buf[4096];
+    int    cache = kilo ? SCREEN_ROWS+2 : SCREEN_ROWS+1;
+    size_t total = cache * ((kilo ? 40 : 16) ) + overhead;
+
+    for(int idx=0; idx < SCREEN_ROWS && idx < (int)tb->lines; idx++)
+    {
+        int len  = tbGetLine(tb, idx, buf, sizeof(buf));
+        int rlen = renderLen(buf, len);
+
+        total += (len >= ROW_ALLOC ? len+1 : ROW_ALLOC) + overhead;
+        if(kilo)
+            total += rlen+1 + overhead + (rlen ? rlen + overhead : 0);
+    }
+    return(total);
+}
+
+// Reference edits.
+//
+static void refInsertLine(int at, const char *text, int len, int crlf)
+{
+    if(refLines == refMax)
+    {
+        refMax = refMax ? refMax * 2 : 256;
+        ref    = realloc(ref, refMax * sizeof(t_line));
+    }
+    memmove(&ref[at+1], &ref[at], (refLines - at) * sizeof(t_line));
+    ref[at].text = malloc(len+1);
+    memcpy(ref[at].text, text, len);
+    ref[at].text[len] = '\0';
+    ref[at].len  = len;
+    ref[at].crlf = crlf;
+    refLines++;
+}
+
+static void refDeleteLine(int at)
+{
+    free(ref[at].text);
+    memmove(&ref[at], &ref[at+1], (refLines - at - 1) * sizeof(t_line));
+    refLines--;
+}
+
+static int checkLine(t_textBuf *tb, int line)
+{
+    char buf[4096];
+    int  len = tbGetLine(tb, line, buf, sizeof(buf));
+
+    if(len != ref[line].len || memcmp(buf, ref[line].text, len) != 0)
+    {
+        printf("line %d differs: \"%.40s\" expected \"%.40s\"\n", line, len < 0 ? "" : buf, ref[line].text);
+        return(1);
+    }
+    return(0);
+}
+
+static int checkAll(t_textBuf *tb)
+{
+    int errors = 0;
+
+    if((int)tb->lines != refLines)
+    {
+        printf("line count %u, expected %d\n", tb->lines, refLines);
+        return(1);
+    }
+    for(int line=0; line < refLines && errors < 5; line++)
+        errors += checkLine(tb, line);
+    return(errors);
+}
+
+// Random edits applied to both the piece table and the reference, edits cluster around a cursor which
+// wanders through the file as it would in the editor.
+//
+static int edit(t_textBuf *tb, int edits)
+{
+    char    text[16];
+    int     cursor = 0;
+    int     errors = 0;
+    int     line;
+    int     col;
+    int     op;
+    int     len;
+
+    for(int cnt=0; cnt < edits && errors == 0; cnt++)
+    {
+        if(rand() % 20 == 0) cursor = rand() % refLines;
+        cursor += (rand() % 5) - 2;
+        if(cursor < 0) cursor = 0;
+        if(cursor >= refLines) cursor = refLines - 1;
+        line = cursor;
+        col  = ref[line].len ? rand() % (ref[line].len + 1) : 0;
+        op   = rand() % 100;
+
+        if(op < 50)
+        {
+            // Type a character.
+            text[0] = 'a' + rand() % 26;
+            if(tbInsert(tb, line, col, text, 1) != TB_OK) { printf("insert failed\n"); return(1); }
+            ref[line].text = realloc(ref[line].text, ref[line].len + 2);
+            memmove(ref[line].text + col + 1, ref[line].text + col, ref[line].len - col + 1);
+            ref[line].text[col] = text[0];
+            ref[line].len++;
+        } else
+        if(op < 75)
+        {
+            // Delete a character.
+            if(col == ref[line].len) continue;
+            if(tbDelete(tb, line, col, 1) != TB_OK) { printf("delete failed\n"); return(1); }
+            memmove(ref[line].text + col, ref[line].text + col + 1, ref[line].len - col);
+            ref[line].len--;
+        } else
+        if(op < 85)
+        {
+            // Split the line, the first part gets a plain newline.
+            if(tbInsert(tb, line, col, "\n", 1) != TB_OK) { printf("split failed\n"); return(1); }
+            refInsertLine(line+1, ref[line].text + col, ref[line].len - col, ref[line].crlf);
+            ref[line].len          = col;
+            ref[line].text[col]    = '\0';
+            ref[line].crlf         = 0;
+        } else
+        if(op < 95)
+        {
+            // Join with the next line.
+            if(line+1 >= refLines) continue;
+            if(tbJoinLines(tb, line) != TB_OK) { printf("join failed\n"); return(1); }
+            len = ref[line].len + ref[line+1].len;
+            ref[line].text = realloc(ref[line].text, len + 1);
+            memcpy(ref[line].text + ref[line].len, ref[line+1].text, ref[line+1].len + 1);
+            ref[line].len  = len;
+            ref[line].crlf = ref[line+1].crlf;
+            refDeleteLine(line+1);
+        } else
+        {
+            // Insert a row as editorInsertRow() does.
+            len = sprintf(text, "row %d", cnt);
+            if(tbInsert(tb, line, 0, "\n", 1) != TB_OK || tbInsert(tb, line, 0, text, len) != TB_OK) { printf("row insert failed\n"); return(1); }
+            refInsertLine(line, text, len, 0);
+        }
+
+        for(int near=cursor-2; near <= cursor+2; near++)
+            if(near >= 0 && near < refLines) errors += checkLine(tb, near);
+        if(refLines != (int)tb->lines) { printf("line count %u, expected %d after edit %d\n", tb->lines, refLines, cnt); errors++; }
+    }
+    return(errors + checkAll(tb));
+}
+
+// Compare the file on disk with the reference.
+//
+static int checkFile(void)
+{
+    FIL     fp;
+    char    *data;
+    char    *ptr;
+    UINT    readSize;
+    int     errors = 0;
+
+    if(f_open(&fp, TEST_FILE, FA_OPEN_EXISTING | FA_READ) != FR_OK) { printf("saved file missing\n"); return(1); }
+    data = malloc(f_size(&fp) + 1);
+    f_read(&fp, data, f_size(&fp), &readSize);
+    ptr = data;
+    for(int line=0; line < refLines && errors == 0; line++)
+    {
+        if((uint32_t)(ptr - data) + ref[line].len + ref[line].crlf + 1 > readSize || memcmp(ptr, ref[line].text, ref[line].len) != 0 ||
+           (ref[line].crlf && ptr[ref[line].len] != '\r') || ptr[ref[line].len + ref[line].crlf] != '\n')
+        {
+            printf("saved line %d differs\n", line);
+            errors++;
+        }
+        ptr += ref[line].len + ref[line].crlf + 1;
+    }
+    if(errors == 0 && (uint32_t)(ptr - data) != readSize) { printf("saved file size %u, expected %u\n", readSize, (uint32_t)(ptr - data)); errors++; }
+    free(data);
+    f_close(&fp);
+    if(f_stat("0:\\" TB_TEMP_NAME, NULL) != FR_NO_FILE) { printf("temporary file left behind\n"); errors++; }
+    return(errors);
+}
+
+int main(int argc, char *argv[])
+{
+    static BYTE      work[FF_MAX_SS];
+    static DWORD     plist[] = {100, 0, 0, 0};
+    static t_textBuf tb;
+    FIL              fp;
+    char             line[MAX_LINE+2];
+    int              lines     = 20000;
+    int              edits     = 20000;
+    int              errors    = 0;
+    int              opt;
+    int              len;
+    UINT             writeSize;
+    uint32_t         fileSize  = 0;
+    uint32_t         written;
+    uint32_t         reads;
+    size_t           peak;
+    size_t           tbHeap;
+
+    while((opt = getopt(argc, argv, "l:e:r:o:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'l': lines    = atoi(optarg); break;
+            case 'e': edits    = atoi(optarg); break;
+            case 'r': cardUs   = atoi(optarg); break;
+            case 'o': overhead = atoi(optarg); break;
+            default:
+                printf("Usage: %s [-l <lines>] [-e <edits>] [-r <card us/sector>] [-o <malloc overhead bytes>]\n", argv[0]);
+                return(1);
+        }
+    }
+    if(lines < 2) lines = 2;
+
+    // Create the volume and a source like test file, every 7th line with a CR/LF ending.
+    //
+    disk = (uint8_t *)calloc(DISK_SECTORS, SECTOR_SIZE);
+    if(disk == NULL || f_fdisk(0, plist, work) != FR_OK || f_mkfs("0:", FM_ANY, 0, work, sizeof(work)) != FR_OK || f_mount(&fatFs, "0:", 1) != FR_OK)
+    {
+        printf("Failed to create the FAT volume.\n");
+        return(1);
+    }
+    srand(1);
+    if(f_open(&fp, TEST_FILE, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+        return(1);
+    for(int idx=0; idx < lines; idx++)
+    {
+        int indent = rand() % 4;
+        int words  = rand() % 9;
+
+        len = 0;
+        for(int tab=0; tab < indent; tab++) line[len++] = '\t';
+        for(int word=0; word < words; word++)
+            len += sprintf(line + len, "%s%.*s", word ? " " : "", 1 + rand() % 7, "abcdefghijklmnop" + rand() % 8);
+        refInsertLine(refLines, line, len, idx % 7 == 6);
+        if(idx % 7 == 6) line[len++] = '\r';
+        line[len++] = '\n';
+        f_write(&fp, line, len, &writeSize);
+        fileSize += len;
+    }
+    f_close(&fp);
+
+    printf("File %u lines, %u bytes, card %uus/sector, malloc overhead %u bytes.\n\n", lines, fileSize, cardUs, overhead);
+    printf("%-26s %12s %14s %14s\n", "", "peak heap", "open (ms)", "1st screen(ms)");
+
+    legacyOpen(1, &peak, &reads);
+    printf("%-26s %12zu %14.1f %14s\n", "kilo, rows in memory", peak, reads * cardUs / 1000.0, "-");
+    legacyOpen(0, &peak, &reads);
+    printf("%-26s %12zu %14.1f %14s\n", "ed, rows in memory", peak, reads * cardUs / 1000.0, "-");
+
+    // Piece table, the open indexes the file and the first screen reads the lines from the disk.
+    //
+    resetHeap();
+    sectorReads = 0;
+    if(tbOpen(&tb, TEST_FILE) != TB_OK) { printf("tbOpen failed\n"); return(1); }
+    tbHeap = heapPeak;
+    reads  = sectorReads;
+    sectorReads = 0;
+    for(int idx=0; idx < SCREEN_ROWS; idx++)
+        tbGetLine(&tb, idx, line, sizeof(line));
+    printf("%-26s %12zu %14.1f %14.1f\n", "kilo, piece table", tbHeap + cacheHeap(&tb, 1), reads * cardUs / 1000.0, sectorReads * cardUs / 1000.0);
+    printf("%-26s %12zu %14.1f %14.1f\n", "ed, piece table", tbHeap + cacheHeap(&tb, 0), reads * cardUs / 1000.0, sectorReads * cardUs / 1000.0);
+    printf("(%u pieces)\n\n", tb.pieces);
+
+    errors += checkAll(&tb);
+
+    // Edits, then save over the original and reopen.
+    //
+    heapPeak = heapUsed;
+    errors += edit(&tb, edits);
+    printf("After %d edits: %u pieces, add buffer %u bytes, peak heap %zu.\n", edits, tb.pieces, tb.addLen, heapPeak);
+    if(tbSave(&tb, TEST_FILE, &written) != TB_OK) { printf("tbSave failed\n"); errors++; }
+    errors += checkFile();
+    errors += checkAll(&tb);
+    printf("Saved %u bytes: %u pieces, heap %zu.\n", written, tb.pieces, heapUsed);
+
+    // More edits on the rebased pieces, saved again, then the saved file opened afresh.
+    errors += edit(&tb, edits / 10);
+    if(tbSave(&tb, TEST_FILE, &written) != TB_OK) { printf("tbSave failed\n"); errors++; }
+    errors += checkFile();
+    tbFree(&tb);
+    if(tbOpen(&tb, TEST_FILE) != TB_OK) { printf("tbOpen failed\n"); errors++; }
+    errors += checkAll(&tb);
+    tbFree(&tb);
+    for(int idx=0; idx < refLines; idx++) free(ref[idx].text);
+    printf("Heap after release %zu.\n", heapUsed);
+    if(heapUsed != 0) errors++;
+
+    printf("\nVerification of edits and save: %s\n", errors ? "FAILED" : "ok");
+    return(errors ? 1 : 0);
+}
@@ -0,0 +1,375 @@
+// uartbench.c
+//
+// Host program to exercise the console UART driver, common/uart.c, against a model of the SoC UART and
+// interrupt controller, measuring how long the CPU is held by console output and whether input survives
+// whilst the CPU is busy. Built once polled and once with UART_RINGS, the two results are compared.
+//
+// The model runs on a virtual clock. The UART sends and receives a byte every 10 bit times at the given baud
+// rate through FIFOs of the given depth, a received byte arriving at a full FIFO is lost. A status read or
+// data access costs the CPU a fixed time, as does entering the interrupt handler. The interrupt controller
+// latches a receive interrupt as each byte arrives and a transmit interrupt as each byte leaves the FIFO, the
+// handler is dispatched between CPU steps when a latched interrupt is enabled and, as the zOS handler does,
+// disables interrupts, services the rings and enables interrupts again.
+//
+// Two loads are run:
+//   dump   - lines of 64 characters are printed through the stdio block write, each line preceded by some
+//            formatting work, as a hex dump command does. The time the CPU spends inside the driver is
+//            reported along with the total time, the output is checked byte for byte.
+//   upload - a block of data arrives continuously at line rate whilst the CPU reads it in 512 byte sectors,
+//            writing each to the card before reading the next. Lost bytes are counted and the data checked.
+//
+// Usage: uartbench [-b <baud>] [-f <fifo depth>] [-l <dump lines>] [-w <format us/line>] [-k <upload KB>]
+//                  [-s <sector write us>]
+//
+// Build (from the repository root):
+//   gcc -O2 -fgnu89-inline -D__ZPU__ -Iinclude -Icommon -o tools/uartbench_polled tools/src/uartbench.c
+//   gcc -O2 -fgnu89-inline -D__ZPU__ -DUART_RINGS -Iinclude -Icommon -o tools/uartbench_rings tools/src/uartbench.c
+//
+//   Created by: Philip Smart, Oct 2026.
+//
+// This software is free to use by anyone for any purpose.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// The SoC header names its register pointer type as the host does.
+#define register_t       soc_register_t
+#include "zpu_soc.h"
+
+// Route the UART and interrupt controller registers to the model.
+uint32_t modelStatus(uint32_t);
+void     modelPut(uint32_t, uint8_t);
+uint8_t  modelGet(uint32_t);
+static uint32_t intrCtrl = 0;
+#undef  UART_STATUS
+#define UART_STATUS(x)   modelStatus(x)
+#define UART_PUT(x, c)   modelPut(x, c)
+#define UART_GET(x)      modelGet(x)
+#undef  INTERRUPT_CTRL
+#define INTERRUPT_CTRL(x) intrCtrl
+
+void (*_inthandler_fptr)();
+#include "interrupts.c"
+#include "uart.c"
+
+#define MAX_FIFO         64
+#define ACCESS_NS        150                 // CPU time for a UART register access.
+#define ISR_NS           2000                // CPU time to enter and leave the interrupt handler.
+#define SECTOR_SIZE      512
+
+// UART and interrupt controller model.
+//
+static struct {
+    uint64_t  now;                           // Virtual time, ns.
+    uint64_t  byteNs;                        // Time on the line for one byte.
+    uint32_t  fifoDepth;
+    uint8_t   txFifo[MAX_FIFO];
+    uint32_t  txCount;
+    uint8_t   txShift;                       // Byte in the transmitter.
+    uint64_t  txShiftEnd;                    // Time the byte in the transmitter finishes, 0 when idle.
+    uint8_t   rxFifo[MAX_FIFO];
+    uint32_t  rxCount;
+    uint8_t   rxOverrun;
+    uint32_t  pending;                       // Latched interrupts.
+    uint8_t   inIsr;
+    // Captured output.
+    uint8_t   *out;
+    uint32_t  outLen;
+    uint32_t  outMax;
+    // Incoming stream.
+    const uint8_t *in;
+    uint32_t  inLen;
+    uint32_t  inPos;
+    uint64_t  inStart;
+    uint32_t  lost;
+} m;
+
+static void advance(uint64_t);
+
+// Interrupt handler, as the zOS handler.
+//
+static void isr(void)
+{
+    uint32_t intr = m.pending & intrCtrl;
+
+    m.pending &= ~intr;
+    m.inIsr    = 1;
+    advance(ISR_NS);
+    DisableInterrupts();
+  #if defined(UART_RINGS)
+    if(intr & (INTR_UART0_RX | INTR_UART0_TX))
+        uart_service();
+  #endif
+    EnableInterrupts();
+    m.inIsr    = 0;
+}
+
+// Move the line on to the given time.
+//
+static void lineTo(uint64_t until)
+{
+    uint64_t txNext;
+    uint64_t arrival;
+
+    for(;;)
+    {
+        // An idle transmitter takes the next byte from the FIFO straight away.
+        if(!m.txShiftEnd && m.txCount)
+        {
+            m.txShift = m.txFifo[0];
+            memmove(m.txFifo, m.txFifo + 1, --m.txCount);
+            m.txShiftEnd = m.now + m.byteNs;
+            m.pending |= INTR_UART0_TX;
+        }
+
+        txNext  = m.txShiftEnd ? m.txShiftEnd : UINT64_MAX;
+        arrival = m.inPos < m.inLen ? m.inStart + (uint64_t)(m.inPos + 1) * m.byteNs : UINT64_MAX;
+        if(txNext > until && arrival > until)
+            break;
+
+        if(txNext <= arrival)
+        {
+            // Byte sent.
+            m.now = txNext;
+            if(m.outLen < m.outMax)
+                m.out[m.outLen++] = m.txShift;
+            m.txShiftEnd = 0;
+        } else
+        {
+            // Byte received, lost if the FIFO is full.
+            m.now = arrival;
+            if(m.rxCount < m.fifoDepth)
+            {
+                m.rxFifo[m.rxCount++] = m.in[m.inPos];
+            } else
+            {
+                m.rxOverrun = 1;
+                m.lost++;
+            }
+            m.inPos++;
+            m.pending |= INTR_UART0_RX;
+        }
+    }
+    m.now = until;
+}
+
+// CPU time passes, the interrupt handler is entered if an enabled interrupt is latched.
+//
+static void advance(uint64_t ns)
+{
+    lineTo(m.now + ns);
+    if(!m.inIsr && (m.pending & intrCtrl))
+        isr();
+}
+
+uint32_t modelStatus(uint32_t uart)
+{
+    uint32_t status = UART_TX_FIFO_ENABLED | UART_TX_ENABLED | UART_RX_FIFO_ENABLED | UART_RX_ENABLED;
+
+    advance(ACCESS_NS);
+    if(m.txCount == 0)              status |= UART_TX_FIFO_EMPTY;
+    if(m.txCount >= m.fifoDepth)    status |= UART_TX_FIFO_FULL;
+    if(m.txShiftEnd)                status |= UART_TX_BUSY;
+    if(m.rxCount == 0)              status |= UART_RX_FIFO_EMPTY;
+    if(m.rxCount >= m.fifoDepth)    status |= UART_RX_FIFO_FULL;
+    if(m.rxCount)                   status |= UART_RX_DATA_READY;
+    if(m.rxOverrun)                 status |= UART_RX_OVERRUN;
+    m.rxOverrun = 0;
+    return(status);
+}
+
+void modelPut(uint32_t uart, uint8_t c)
+{
+    advance(ACCESS_NS);
+    if(m.txCount < m.fifoDepth)
+        m.txFifo[m.txCount++] = c;
+}
+
+uint8_t modelGet(uint32_t uart)
+{
+    uint8_t c = 0;
+
+    advance(ACCESS_NS);
+    if(m.rxCount)
+    {
+        c = m.rxFifo[0];
+        memmove(m.rxFifo, m.rxFifo + 1, --m.rxCount);
+    }
+    return(c);
+}
+
+// CPU work outside the driver, in small steps so interrupts are taken as they would be.
+//
+static void work(uint64_t ns)
+{
+    while(ns > 0)
+    {
+        uint64_t step = ns < 1000 ? ns : 1000;
+        advance(step);
+        ns -= step;
+    }
+}
+
+static void reset(uint32_t baud, uint32_t fifo)
+{
+    free(m.out);
+    memset(&m, 0, sizeof(m));
+    m.byteNs    = 10ULL * 1000000000ULL / baud;
+    m.fifoDepth = fifo;
+    m.outMax    = 1 << 22;
+    m.out       = malloc(m.outMax);
+    intrSetting = 0;
+    intrCtrl    = 0;
+  #if defined(UART_RINGS)
+    txHead = txTail = rxHead = rxTail = 0;
+    txLock = txActive = 0;
+    memset(&uartStats, 0, sizeof(uartStats));
+    EnableInterrupt(INTR_UART0_RX);
+  #endif
+}
+
+// Wait for the output to leave the line.
+//
+static void drain(void)
+{
+    uart_flush();
+    while(m.txShiftEnd || m.txCount)
+        work(1000);
+}
+
+static void printStats(void)
+{
+  #if defined(UART_RINGS)
+    t_uartStats stats;
+
+    uart_get_stats(&stats, 0);
+    printf("    rings: TX peak %u/%u, RX peak %u/%u, TX overrun %u, TX underrun %u, RX overrun %u\n",
+           stats.txPeak, UART_TX_RING_SIZE, stats.rxPeak, UART_RX_RING_SIZE, stats.txOverrun, stats.txUnderrun, stats.rxOverrun);
+  #endif
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t  baud      = 115200;
+    uint32_t  fifo      = 16;
+    uint32_t  lines     = 2000;
+    uint32_t  formatUs  = 8000;
+    uint32_t  uploadKB  = 64;
+    uint32_t  sectorUs  = 3000;
+    uint8_t   *expect;
+    uint32_t  expectLen = 0;
+    uint64_t  start;
+    uint64_t  cpuNs;
+    uint64_t  workEnd;
+    int       errors    = 0;
+    int       opt;
+
+    while((opt = getopt(argc, argv, "b:f:l:w:k:s:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'b': baud     = atoi(optarg); break;
+            case 'f': fifo     = atoi(optarg); break;
+            case 'l': lines    = atoi(optarg); break;
+            case 'w': formatUs = atoi(optarg); break;
+            case 'k': uploadKB = atoi(optarg); break;
+            case 's': sectorUs = atoi(optarg); break;
+            default:
+                printf("Usage: %s [-b <baud>] [-f <fifo depth>] [-l <dump lines>] [-w <format us/line>] [-k <upload KB>] [-s <sector write us>]\n", argv[0]);
+                return(1);
+        }
+    }
+    if(fifo < 1 || fifo > MAX_FIFO)
+        fifo = 16;
+
+  #if defined(UART_RINGS)
+    printf("Console UART0 with interrupt serviced rings, TX %u bytes, RX %u bytes.\n", UART_TX_RING_SIZE, UART_RX_RING_SIZE);
+  #else
+    printf("Console UART0 polled.\n");
+  #endif
+    printf("%u baud, %u byte FIFOs.\n\n", baud, fifo);
+
+    // Dump load.
+    //
+    reset(baud, fifo);
+    expect = malloc(lines * 65);
+    start  = m.now;
+    cpuNs  = 0;
+    for(uint32_t line=0; line < lines; line++)
+    {
+        char     buf[80];
+        uint64_t mark;
+
+        work((uint64_t)formatUs * 1000);
+        snprintf(buf, sizeof(buf), "%08X: %-53.53s\n", line * 16, "0123456789ABCDEF 0123456789ABCDEF 0123456789ABCDEF 0123");
+        mark = m.now;
+        uart_write(buf, 64, stdout);
+        cpuNs += m.now - mark;
+        memcpy(expect + expectLen, buf, 63);
+        expectLen += 63;
+        expect[expectLen++] = '\r';
+        expect[expectLen++] = '\n';
+    }
+    workEnd = m.now;
+    drain();
+    if(m.outLen != expectLen || memcmp(m.out, expect, expectLen) != 0)
+    {
+        printf("dump: output differs from the lines written\n");
+        errors++;
+    }
+    printf("dump:   %u lines, %u bytes, line time %.3f s\n", lines, expectLen, expectLen * m.byteNs / 1e9);
+    printf("    CPU in output calls %.3f s, work done after %.3f s (%.1f%% of the CPU left for work), line idle after %.3f s\n",
+           cpuNs / 1e9, (workEnd - start) / 1e9, 100.0 * ((double)lines * formatUs * 1000) / (double)(workEnd - start), (m.now - start) / 1e9);
+    printStats();
+    free(expect);
+
+    // Upload load.
+    //
+    {
+        uint32_t  len   = uploadKB * 1024;
+        uint8_t   *data = malloc(len);
+        uint8_t   *recv = malloc(len);
+        uint32_t  got   = 0;
+        uint32_t  ok;
+
+        reset(baud, fifo);
+        srand(1);
+        for(uint32_t idx=0; idx < len; idx++)
+            data[idx] = rand();
+        m.in      = data;
+        m.inLen   = len;
+        m.inStart = m.now;
+
+        // Read sectors until the sender has finished and nothing more is waiting.
+        while(got < len && (m.inPos < m.inLen || uart_rx_avail()))
+        {
+            uint32_t sect = 0;
+            while(sect < SECTOR_SIZE && got + sect < len && (m.inPos < m.inLen || uart_rx_avail()))
+            {
+                if(uart_rx_avail())
+                    recv[got + sect++] = (uint8_t)getserial();
+                else
+                    work(200);
+            }
+            got += sect;
+            work((uint64_t)sectorUs * 1000);
+        }
+        for(ok = 0; ok < got && recv[ok] == data[ok]; ok++);
+        printf("upload: %u bytes sent, %u received, %u lost, %s\n", len, got, m.lost, (got == len && ok == len) ? "data intact" : "data corrupted");
+        printStats();
+      #if defined(UART_RINGS)
+        if(got != len || ok != len)
+            errors++;
+      #endif
+        free(data);
+        free(recv);
+    }
+
+    printf("\nVerification: %s\n", errors ? "FAILED" : "ok");
+    free(m.out);
+    return(errors ? 1 : 0);
+}
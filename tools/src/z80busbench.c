@@ -0,0 +1,466 @@
+// z80busbench.c
+//
+// Host program to check the block transfer engine of common/tranzputer.c, writeZ80Block() and readZ80Block(), against the byte
+// at a time bus cycles of writeZ80Memory() and readZ80Memory() for each target, MAINBOARD, TRANZPUTER and FPGA, and to compare
+// their throughput.
+//
+// tranzputer.c is compiled as is with the GPIO and pin macros of tranzputer.h routed to a model of the Z80 bus. The model
+// tracks the address, data, direction, MREQ, RD and WR lines, performs a memory write on the rising edge of WR and supplies
+// the memory contents when the data bus is read during a read cycle. Each completed cycle is logged with its address, data and
+// timing: the address/data setup time before MREQ, MREQ to WR and the WR pulse or RD to data taken. The mainboard asserts WAIT
+// for a time after MREQ at 0xD000 and above, memory mapped I/O and video RAM, and 0xE008 reports the blanking period which the
+// byte read method synchronises to before reading video RAM. A signal change in the middle of a cycle, a cycle ended inside a
+// WAIT or a cycle on the data bus in the wrong direction is a protocol error.
+//
+// The K64F time is modelled: every GPIO access costs a fixed time, as does every bus delay loop iteration. The remaining
+// instruction time is charged per cycle, a call time for the byte methods (call, time read and mode tests) and a smaller loop
+// time for the block engine.
+//
+// writeZ80Array()/readZ80Array() are run with the bus held, once with the block engine disabled and once enabled, over ranges
+// which start and end part way through a 256 byte page, the mainboard read also crossing into video RAM. The two runs must
+// produce the same cycles, address and data in the same order, leave the same memory contents and read the same data, and no
+// block cycle may be shorter in any phase than the shortest byte cycle. A larger transfer per target gives the KB/s of each.
+//
+// Usage: z80busbench [-a <GPIO access ns>] [-l <delay loop ns>] [-c <byte call ns>] [-u <block loop ns>] [-w <WAIT ns>]
+//
+// Build (from the repository root):
+//   gcc -O2 -ffunction-sections -fdata-sections -Wl,--gc-sections -D__K64F__ -D__ZOS__ -D__SD_CARD__ -D__TRANZPUTER__ -D__MK64FX512__ -DF_CPU=120000000 -DTEENSYDUINO=144 -DOS_BASEADDR=0 -DOS_APPADDR=0 -IzOS/src -Iteensy3 -Icommon -Icommon/FatFS -Iinclude -o tools/z80busbench tools/src/z80busbench.c
+//
+//   Created by: Philip Smart, Oct 2026.
+//
+// This software is free to use by anyone for any purpose.
+//
+
+#include <stdio.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdarg.h>
+#include <core_pins.h>
+#include <usb_serial.h>
+#include <Arduino.h>
+#include "k64f_soc.h"
+#include <../../libraries/include/stdmisc.h>
+#include "ff.h"
+#include "diskio.h"
+#include "utils.h"
+#include <fonts.h>
+#include <bitmaps.h>
+#include <tranzputer.h>
+
+// Route the bus signals to the model.
+void     modelPin(uint8_t, uint8_t);
+uint8_t  modelPinGet(uint8_t);
+void     modelSetAddr(uint32_t, uint8_t);
+void     modelSetData(uint8_t);
+uint8_t  modelReadData(void);
+void     modelDataDir(uint8_t);
+void     modelDelay(uint32_t);
+#undef  pinLow
+#define pinLow(a)                    modelPin(a, 0)
+#undef  pinHigh
+#define pinHigh(a)                   modelPin(a, 1)
+#undef  pinSet
+#define pinSet(a, b)                 modelPin(a, (b) ? 1 : 0)
+#undef  pinGet
+#define pinGet(a)                    modelPinGet(a)
+#undef  setZ80Addr
+#define setZ80Addr(a)                modelSetAddr(a, 0)
+#undef  setZ80AddrLower
+#define setZ80AddrLower(a)           modelSetAddr(a, 1)
+#undef  setZ80Data
+#define setZ80Data(a)                modelSetData(a)
+#undef  readZ80DataBus
+#define readZ80DataBus()             modelReadData()
+#undef  setZ80DataAsOutput
+#define setZ80DataAsOutput()         modelDataDir(1)
+#undef  setZ80DataAsInput
+#define setZ80DataAsInput()          modelDataDir(0)
+#undef  z80BusDelay
+#define z80BusDelay(a)               modelDelay(a)
+
+// The interrupt handlers are ARM assembler and never run here, the interrupt mask is a no-op. tranzputer.c is written for the 32
+// bit K64F, its pointer casts and the emuMZ calls it makes without a prototype are not of interest on the host.
+#undef  __disable_irq
+#define __disable_irq()
+#undef  __enable_irq
+#define __enable_irq()
+#define asm                          if(0) __asm__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpointer-to-int-cast"
+#pragma GCC diagnostic ignored "-Wincompatible-pointer-types"
+#pragma GCC diagnostic ignored "-Wimplicit-function-declaration"
+#include "tranzputer.c"
+#pragma GCC diagnostic pop
+
+// Pin configuration used by the bus request and release methods, which are not reached with the bus held.
+const struct digital_pin_bitband_and_config_table_struct digital_pin_to_info_PGM[CORE_NUM_DIGITAL];
+
+#define MEM_SIZE         0x1000000           // 24 bit address space of each target.
+#define MAX_CYCLES       0x40000
+#define BLANK_PERIOD_NS  1000000             // Model blanking period, shortened from a 60Hz frame to keep the run short.
+#define BLANK_NS         200000
+
+// One bus cycle as seen on the bus.
+typedef struct {
+    uint8_t           write;
+    uint32_t          addr;
+    uint8_t           data;
+    uint32_t          setupNs;               // Address and data stable before MREQ.
+    uint32_t          strobeNs;              // MREQ to WR, 0 on a read.
+    uint32_t          widthNs;               // WR pulse, or RD to the data being taken.
+} t_busCycle;
+
+// Bus model.
+//
+static struct {
+    uint64_t          now;                   // Virtual time, ns.
+    uint32_t          msTick;                // Millisecond counter presented through ms.
+    enum TARGETS      target;
+    uint8_t           *mem[3];               // Memory of each target.
+    uint32_t          addr;
+    uint8_t           dataOut;
+    uint8_t           dataDir;               // 1 = K64F drives the data bus.
+    uint8_t           mreq, rd, wr;          // Line levels, 0 = asserted.
+    uint8_t           taken;                 // Data taken in the current read cycle.
+    uint64_t          changedAt;             // Last address or data change.
+    uint64_t          mreqAt;
+    uint64_t          strobeAt;              // WR or RD asserted.
+    uint64_t          waitUntil;
+    t_busCycle        *log;
+    uint32_t          logCount;
+    uint32_t          protoErrors;
+} bus;
+
+static uint32_t accessNs   = 50;
+static uint32_t loopNs     = 100;
+static uint32_t callNs     = 200;
+static uint32_t blockNs    = 25;
+static uint32_t waitNs     = 500;
+static uint32_t cycleNs;                     // Instruction time charged per cycle for the method in use.
+
+// Method to record a use of the bus which the hardware would not accept.
+//
+static void protoError(const char *what)
+{
+    if(bus.protoErrors++ < 10)
+        printf("  protocol error at %06x: %s\n", bus.addr, what);
+}
+
+// Method to advance the clock by a GPIO access.
+//
+static void busAccess(uint32_t ns)
+{
+    bus.now   += ns;
+    bus.msTick = (uint32_t)(bus.now / 1000000);
+}
+
+// Method to log a completed cycle and charge the instruction time of the method around it.
+//
+static void busLog(uint8_t write, uint8_t data)
+{
+    t_busCycle *cycle;
+
+    // The blanking status polls of the video RAM synchronisation depend on timing, not on the method, so are not logged.
+    if(!(bus.target == MAINBOARD && !write && bus.addr == 0xE008) && bus.logCount < MAX_CYCLES)
+    {
+        cycle = &bus.log[bus.logCount++];
+        cycle->write    = write;
+        cycle->addr     = bus.addr;
+        cycle->data     = data;
+        cycle->setupNs  = (uint32_t)(bus.mreqAt - bus.changedAt);
+        cycle->strobeNs = write ? (uint32_t)(bus.strobeAt - bus.mreqAt) : 0;
+        cycle->widthNs  = (uint32_t)(bus.now - bus.strobeAt);
+    }
+    busAccess(cycleNs);
+}
+
+void modelPin(uint8_t pin, uint8_t level)
+{
+    busAccess(accessNs);
+    switch(pin)
+    {
+        case Z80_MREQ:
+            if(!level && bus.mreq)
+            {
+                bus.mreqAt    = bus.now;
+                bus.taken     = 0;
+                bus.waitUntil = (bus.target == MAINBOARD && (bus.addr & 0xFFFF) >= 0xD000) ? bus.now + waitNs : 0;
+            }
+            if(level && !bus.mreq && (!bus.rd || !bus.wr))
+                protoError("MREQ released before RD or WR");
+            bus.mreq = level;
+            break;
+
+        case Z80_WR:
+            if(!level && bus.wr)
+            {
+                if(bus.mreq || !bus.rd || !bus.dataDir)
+                    protoError("WR asserted without MREQ, with RD or with the data bus as input");
+                bus.strobeAt = bus.now;
+            }
+            if(level && !bus.wr)
+            {
+                if(bus.now < bus.waitUntil)
+                    protoError("write completed inside WAIT");
+                bus.mem[bus.target][bus.addr & (MEM_SIZE - 1)] = bus.dataOut;
+                busLog(1, bus.dataOut);
+            }
+            bus.wr = level;
+            break;
+
+        case Z80_RD:
+            if(!level && bus.rd)
+            {
+                if(bus.mreq || !bus.wr || bus.dataDir)
+                    protoError("RD asserted without MREQ, with WR or with the data bus as output");
+                bus.strobeAt = bus.now;
+            }
+            if(level && !bus.rd && !bus.taken)
+                protoError("read cycle without the data being taken");
+            bus.rd = level;
+            break;
+
+        default:
+            break;
+    }
+}
+
+uint8_t modelPinGet(uint8_t pin)
+{
+    busAccess(accessNs);
+    if(pin == Z80_WAIT)
+        return(bus.now >= bus.waitUntil);
+    return(1);
+}
+
+void modelSetAddr(uint32_t addr, uint8_t lower)
+{
+    // A full address is a read-modify-write of two ports, the lower byte one port.
+    busAccess(accessNs * (lower ? 2 : 4));
+    if(!bus.mreq)
+        protoError("address changed during a cycle");
+    bus.addr      = lower ? (bus.addr & 0xFFFFFF00) | (addr & 0xFF) : addr & 0x00FFFFFF;
+    bus.changedAt = bus.now;
+}
+
+void modelSetData(uint8_t data)
+{
+    busAccess(accessNs * 2);
+    if(!bus.mreq)
+        protoError("data changed during a cycle");
+    bus.dataOut   = data;
+    bus.changedAt = bus.now;
+}
+
+uint8_t modelReadData(void)
+{
+    uint8_t data;
+
+    busAccess(accessNs);
+    if(bus.mreq || bus.rd)
+    {
+        protoError("data bus read outside a read cycle");
+        return(0xFF);
+    }
+    if(bus.now < bus.waitUntil)
+        protoError("data taken inside WAIT");
+    if(bus.target == MAINBOARD && bus.addr == 0xE008)
+        data = (bus.now % BLANK_PERIOD_NS) < BLANK_NS ? 0x80 : 0x00;
+    else
+        data = bus.mem[bus.target][bus.addr & (MEM_SIZE - 1)];
+    bus.taken = 1;
+    busLog(0, data);
+    return(data);
+}
+
+void modelDataDir(uint8_t output)
+{
+    busAccess(accessNs * 2);
+    bus.dataDir = output;
+}
+
+void modelDelay(uint32_t count)
+{
+    busAccess(loopNs * count);
+}
+
+// Method to run one array transfer through the byte or block path, logging its cycles, returning the virtual time taken.
+//
+static uint64_t runArray(uint8_t write, enum TARGETS target, uint32_t addr, uint8_t *data, uint32_t size, uint8_t block, t_busCycle *log)
+{
+    uint64_t startTime = bus.now;
+
+    bus.target           = target;
+    bus.log              = log;
+    bus.logCount         = 0;
+    cycleNs              = block ? blockNs : callNs;
+    z80Control.burstMode = block;
+    z80Control.ctrlMode  = target == MAINBOARD ? MAINBOARD_ACCESS : TRANZPUTER_ACCESS;
+    z80Control.holdZ80   = 1;
+    if(write)
+        writeZ80Array(addr, data, size, target);
+    else
+        readZ80Array(addr, data, size, target);
+    return(bus.now - startTime);
+}
+
+// Shortest setup, strobe and pulse of the cycles logged.
+//
+static void minTiming(t_busCycle *log, uint32_t count, uint32_t *min)
+{
+    min[0] = min[1] = min[2] = UINT32_MAX;
+    for(uint32_t idx=0; idx < count; idx++)
+    {
+        if(log[idx].setupNs  < min[0]) min[0] = log[idx].setupNs;
+        if(log[idx].write && log[idx].strobeNs < min[1]) min[1] = log[idx].strobeNs;
+        if(log[idx].widthNs  < min[2]) min[2] = log[idx].widthNs;
+    }
+    if(min[1] == UINT32_MAX)
+        min[1] = 0;
+}
+
+// Method to run a range through both paths from the same memory contents and compare the cycles, memory and data.
+//
+static int compareRange(const char *name, uint8_t write, enum TARGETS target, uint32_t addr, uint32_t size)
+{
+    // Locals.
+    static t_busCycle logByte[MAX_CYCLES];
+    static t_busCycle logBlock[MAX_CYCLES];
+    static uint8_t    *saved  = NULL;
+    static uint8_t    *after  = NULL;
+    static uint8_t    dataByte[MAX_CYCLES];
+    static uint8_t    dataBlock[MAX_CYCLES];
+    uint32_t          countByte;
+    uint32_t          minByte[3];
+    uint32_t          minBlock[3];
+    uint64_t          nsByte;
+    uint64_t          nsBlock;
+    int               errors = 0;
+    uint32_t          idx;
+
+    if(saved == NULL)
+    {
+        saved = malloc(MEM_SIZE);
+        after = malloc(MEM_SIZE);
+    }
+    memcpy(saved, bus.mem[target], MEM_SIZE);
+    for(idx=0; idx < size; idx++)
+        dataByte[idx] = dataBlock[idx] = (uint8_t)((addr + idx) * 131 + 17);
+
+    nsByte    = runArray(write, target, addr, dataByte, size, 0, logByte);
+    countByte = bus.logCount;
+    memcpy(after, bus.mem[target], MEM_SIZE);
+    memcpy(bus.mem[target], saved, MEM_SIZE);
+    nsBlock   = runArray(write, target, addr, dataBlock, size, 1, logBlock);
+
+    if(countByte != bus.logCount)
+    {
+        printf("  %s: %u byte cycles, %u block cycles\n", name, countByte, bus.logCount);
+        errors++;
+    }
+    for(idx=0; idx < countByte && idx < bus.logCount; idx++)
+    {
+        if(logByte[idx].write != logBlock[idx].write || logByte[idx].addr != logBlock[idx].addr || logByte[idx].data != logBlock[idx].data)
+        {
+            printf("  %s: cycle %u differs, byte %c %06x=%02x, block %c %06x=%02x\n", name, idx,
+                   logByte[idx].write ? 'W' : 'R', logByte[idx].addr, logByte[idx].data, logBlock[idx].write ? 'W' : 'R', logBlock[idx].addr, logBlock[idx].data);
+            errors++;
+            break;
+        }
+    }
+    if(memcmp(after, bus.mem[target], MEM_SIZE) || memcmp(dataByte, dataBlock, size))
+    {
+        printf("  %s: memory or data read differs\n", name);
+        errors++;
+    }
+    minTiming(logByte, countByte, minByte);
+    minTiming(logBlock, bus.logCount, minBlock);
+    if(minBlock[0] < minByte[0] || minBlock[1] < minByte[1] || minBlock[2] < minByte[2])
+    {
+        printf("  %s: block cycle shorter than a byte cycle\n", name);
+        errors++;
+    }
+    printf("  %-24s %06x %6u %6u %5u/%-5u %5u/%-5u %5u/%-5u %8.2f %8.2f  %s\n", name, addr, size, countByte,
+           minByte[0], minBlock[0], minByte[1], minBlock[1], minByte[2], minBlock[2], nsByte / 1000.0, nsBlock / 1000.0, errors ? "FAILED" : "same");
+    return(errors);
+}
+
+// Throughput of the byte and block paths for a transfer, KB/s on the virtual clock.
+//
+static void throughput(const char *name, uint8_t write, enum TARGETS target, uint32_t addr, uint32_t size)
+{
+    // Locals.
+    static t_busCycle log[MAX_CYCLES];
+    static uint8_t    data[MAX_CYCLES];
+    double            kbsByte;
+    double            kbsBlock;
+
+    memset(data, 0x5A, size);
+    kbsByte  = size / 1024.0 / (runArray(write, target, addr, data, size, 0, log) / 1e9);
+    kbsBlock = size / 1024.0 / (runArray(write, target, addr, data, size, 1, log) / 1e9);
+    printf("  %-24s %6u %10.0f %10.0f %6.2fx\n", name, size, kbsByte, kbsBlock, kbsBlock / kbsByte);
+}
+
+int main(int argc, char *argv[])
+{
+    // Locals.
+    int               opt;
+    int               errors = 0;
+
+    while((opt = getopt(argc, argv, "a:l:c:u:w:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'a': accessNs = atoi(optarg);  break;
+            case 'l': loopNs   = atoi(optarg);  break;
+            case 'c': callNs   = atoi(optarg);  break;
+            case 'u': blockNs  = atoi(optarg);  break;
+            case 'w': waitNs   = atoi(optarg);  break;
+            default:
+                printf("Usage: %s [-a <GPIO access ns>] [-l <delay loop ns>] [-c <byte call ns>] [-u <block loop ns>] [-w <WAIT ns>]\n", argv[0]);
+                return(1);
+        }
+    }
+
+    // Idle bus, each target filled with a pattern.
+    ms          = &bus.msTick;
+    bus.mreq    = bus.rd = bus.wr = 1;
+    for(int target=0; target < 3; target++)
+    {
+        bus.mem[target] = malloc(MEM_SIZE);
+        for(uint32_t idx=0; idx < MEM_SIZE; idx++)
+            bus.mem[target][idx] = (uint8_t)((idx >> 8) ^ idx ^ (target * 0x55));
+    }
+
+    printf("GPIO access %uns, delay loop %uns, byte call %uns, block loop %uns, mainboard WAIT %uns.\n\n", accessNs, loopNs, callNs, blockNs, waitNs);
+    printf("Byte path against block engine, minimum times in ns byte/block:\n");
+    printf("  %-24s %6s %6s %6s %11s %11s %11s %8s %8s\n", "Transfer", "Addr", "Bytes", "Cycles", "Setup", "MREQ-WR", "WR/RD", "Byte us", "Block us");
+    errors += compareRange("MAINBOARD write",          1, MAINBOARD,  0x0010F1, 0x0523);
+    errors += compareRange("MAINBOARD write I/O+VRAM", 1, MAINBOARD,  0x00CFE0, 0x0040);
+    errors += compareRange("MAINBOARD read",           0, MAINBOARD,  0x0010F1, 0x0523);
+    errors += compareRange("MAINBOARD read VRAM",      0, MAINBOARD,  0x00CFF0, 0x0020);
+    errors += compareRange("TRANZPUTER write",         1, TRANZPUTER, 0x0100F3, 0x0A1D);
+    errors += compareRange("TRANZPUTER read",          0, TRANZPUTER, 0x0100F3, 0x0A1D);
+    errors += compareRange("FPGA write",               1, FPGA,       0x3000FD, 0x0613);
+    errors += compareRange("FPGA read",                0, FPGA,       0x3000FD, 0x0613);
+    printf("\n");
+
+    printf("Throughput, KB/s on the virtual clock:\n");
+    printf("  %-24s %6s %10s %10s %7s\n", "Transfer", "Bytes", "Byte", "Block", "Gain");
+    throughput("MAINBOARD write",  1, MAINBOARD,  0x001200, 0xB000);
+    throughput("MAINBOARD read",   0, MAINBOARD,  0x001200, 0xB000);
+    throughput("TRANZPUTER write", 1, TRANZPUTER, 0x010000, 0x10000);
+    throughput("TRANZPUTER read",  0, TRANZPUTER, 0x010000, 0x10000);
+    throughput("FPGA write",       1, FPGA,       0x300000, 0x10000);
+    throughput("FPGA read",        0, FPGA,       0x300000, 0x10000);
+    printf("\n");
+
+    if(bus.protoErrors)
+        errors++;
+    printf("Protocol errors %u.\n", bus.protoErrors);
+    printf("Verification: %s\n", errors ? "FAILED" : "ok");
+    return(errors ? 1 : 0);
+}
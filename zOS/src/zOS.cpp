@@ -37,6 +37,14 @@
 //                                   wasnt really needed as this could be based on a readline idle call.
 //                  Oct 2021       - Extensions to support the MZ-2000 host and the Sharp MZ Series FPGA
 //                                   Emulation.
+//                  Oct 2026       - ZPU console stream given a block write handler for buffered stdio.
+//                                 - Interrupt driven console UART rings (UART_RINGS) and the hus command.
+//                                 - Applications resolved through a registry of the bin directory built
+//                                   at boot, optional RAM cache of their images (APP_CACHE) and the apps
+//                                   command reporting launch times.
+//                                 - tranZPUter service loop driven by the evq event queue, the events
+//                                   command reports the per event latency.
+//                                 - info command shows the sfmalloc heap statistics (__SFMALLOC__).
 //
 // Notes:           See Makefile to enable/disable conditional components
 //                  USELOADB              - The Byte write command is implemented in hw/sw so use it.
@@ -45,6 +53,8 @@
 //                  __ZPU__               - Target CPU is the ZPU
 //                  __K64F__              - Target CPU is the K64F
 //                  __SD_CARD__           - Add the SDCard logic.
+//                  UART_RINGS            - ZPU console UART0 buffered in rings serviced under interrupt.
+//                  APP_CACHE             - Keep the images of recently run applications in RAM.
 //
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 // This source file is free software: you can redistribute it and#or modify
@@ -113,9 +123,11 @@
 #include "readline.h"
 #include "zOS_app.h"     /* Header for definitions specific to apps run from zOS */
 #include "zOS.h"
+#include "appreg.h"
 
 #if defined __TRANZPUTER__
   #include <tranzputer.h>
+  #include <evq.h>
 #endif
 
 #if defined __SHARPMZ__
@@ -130,8 +142,8 @@
 #endif
 
 // Version info.
-#define VERSION      "v1.41"
-#define VERSION_DATE "28/10/2021"
+#define VERSION      "v1.43"
+#define VERSION_DATE "16/10/2026"
 #define PROGRAM_NAME "zOS"
 
 // Utility functions.
@@ -151,6 +163,20 @@ void interrupt_handler()
     // Prevent additional interrupts.
     DisableInterrupts();
 
+  #if defined(UART_RINGS)
+    // The console rings are serviced on every UART0 interrupt, too often to trace.
+    if(INTR_IS_UART0_RX(intr) || INTR_IS_UART0_TX(intr))
+    {
+        uart_service();
+        intr &= ~(INTR_UART0_RX | INTR_UART0_TX);
+    }
+    if(intr == 0)
+    {
+        EnableInterrupts();
+        return;
+    }
+  #endif
+
     dbg_puts("ZPU Interrupt Handler");
 
     if(INTR_IS_TIMER(intr))
@@ -281,48 +307,13 @@ uint8_t getCommandLine(char *buf, uint8_t bufSize)
 
 #if defined __TRANZPUTER__
 // Method to monitor and control the tranZPUter board provided services as requested.
+// The interrupt handlers post RESET and service request events which are dispatched here, all pending events
+// per call in priority order. When none are pending the tranZPUter service routine, handling non-event driven
+// tasks, is run as a background job.
 //
 void tranZPUterControl(void)
 {
-    // Locals.
-    uint8_t        ioAddr;
-
-    // If a user reset event occurred, reload the default ROM set.
-    //
-    if(isZ80Reset())
-    {
-        // Reset tranZPUter board, set memory map and ROMS as necessary.
-        //
-        hardResetTranZPUter();
-
-        // Clear reset event which caused this reload.
-        clearZ80Reset();
-    }
-
-    // Has there been an IO instruction for a service request?
-    //
-    if(getZ80IO(&ioAddr) == 1)
-    {
-//printf("Activity on IO:%02x\n", ioAddr);
-        switch(ioAddr)
-        {
-            // Service request. Actual data about the request is stored in the Z80 memory, so read the request and process.
-            //
-            case IO_TZ_SVCREQ:
-                // Handle the service request.
-                //
-                processServiceRequest();
-                break;
-
-            default:
-                break;
-        }
-    } else
-    {
-        // Idle time call the tranzputer service routine to handle non-event driven tasks.
-        //
-        TZPUservice();
-    }
+    evqDispatch();
 }
 #endif
 
@@ -741,6 +732,9 @@ int cmdProcessor(void)
             case CMD_MISC_REBOOT:
             {
                 printf("Cold rebooting...\n");
+              #if defined(UART_RINGS)
+                uart_flush();
+              #endif
                 void *rbtptr = (void *)0x00000000;
                 goto *rbtptr;
             }
@@ -763,7 +757,34 @@ int cmdProcessor(void)
             // Configuration information
             case CMD_MISC_INFO:
                 showSoCConfig();
+              #if defined(__SFMALLOC__)
+                printHeapInfo();
+              #endif
+                break;
+
+          #if defined(BUILTIN_MISC_APPS) && BUILTIN_MISC_APPS == 1 && defined(__SD_CARD__)
+            // CMD_MISC_APPS [r] - Application registry and launch times, r reads the bin directory again.
+            case CMD_MISC_APPS:
+                src1FileName = getStrParam(&ptr);
+                printAppRegistry(src1FileName != NULL && *src1FileName == 'r');
+                break;
+          #endif
+
+          #if defined(BUILTIN_MISC_EVENTS) && BUILTIN_MISC_EVENTS == 1
+            // CMD_MISC_EVENTS [r] - tranZPUter event latency histograms, r clears them after display.
+            case CMD_MISC_EVENTS:
+                src1FileName = getStrParam(&ptr);
+                printEventStats(src1FileName != NULL && *src1FileName == 'r');
                 break;
+          #endif
+
+          #if defined(BUILTIN_HW_UART_STATS) && BUILTIN_HW_UART_STATS == 1
+            // CMD_HW_UART_STATS [<kb>] - Console UART statistics and throughput.
+            case CMD_HW_UART_STATS:
+                if(!xatoi(&ptr, &p1)) p1 = 0;
+                uartDiagnostics((uint32_t)p1);
+                break;
+          #endif
 
            #if defined __ZPU__ || defined __K64F__
             // Test point - add code here when a test is needed on a kernel element then invoke after boot.
@@ -811,9 +832,19 @@ int cmdProcessor(void)
 
                         if(diskInitialised && fsInitialised && strlen(src1FileName) < 16)
                         {
+                            // A command found in the application registry is loaded, from the image cache if held, and run directly.
+                            //
+                            if(appRegLoad(src1FileName, APP_CMD_LOAD_ADDR) == FR_OK)
+                            {
+                                retCode = memExec(APP_CMD_EXEC_ADDR, EXEC_MODE_CALL, (uint32_t)ptr,  (uint32_t)cmdline,   (uint32_t)&G,   (uint32_t)&cfgSoC);
+                                trying  = 0;
+                            } else
+                            {
+                                trying  = 1;
+                            }
+
                             // The user normally just types the command, but it is possible to type the drive and or path and or extension, so cater
                             // for these possibilities by trial. An alternate way is to disect the entered command but I think this would take more code space.
-                            trying = 1;
                             while(trying)
                             {
                                 switch(trying)
@@ -935,6 +966,7 @@ int main(int argc, char **argv)
 
   #elif defined __ZPU__
     fdev_setup_stream(&osIO, uart_putchar, uart_getchar, _FDEV_SETUP_RW);
+    fdev_set_block(&osIO, uart_write, NULL);
     stdout = stdin = stderr = &osIO;
 
   #elif defined __M68K__
@@ -963,10 +995,20 @@ int main(int argc, char **argv)
   #if defined __ZPU__
     //EnableInterrupt(INTR_TIMER | INTR_PS2 | INTR_IOCTL_RD | INTR_IOCTL_WR | INTR_UART0_RX | INTR_UART0_TX | INTR_UART1_RX | INTR_UART1_TX);
     //EnableInterrupt(INTR_UART0_RX | INTR_UART1_RX); // | INTR_TIMER);
+   #if defined(UART_RINGS)
+    // Console input is collected under interrupt, the transmit interrupt is enabled whilst output is waiting.
+    EnableInterrupt(INTR_UART0_RX);
+   #endif
   #endif
 
   #if defined(__SD_CARD__)
     setupSDCard();
+
+    // Index the applications so a command is resolved without searching the SD card.
+    if(diskInitialised && fsInitialised)
+    {
+        appRegBuild(APP_CMD_BIN_DRIVE, APP_CMD_BIN_DIR, APP_CMD_EXTENSION);
+    }
   #endif
 
   #if defined __TRANZPUTER__
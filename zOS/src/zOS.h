@@ -16,6 +16,7 @@
 //                                   enhanced to work with both the ZPU and K64F for the original purpose
 //                                   of testing but also now for end application programming using the 
 //                                   features of zOS where applicable.
+//                  Oct 2026       - Application registry and image cache, apps command.
 //
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 // This source file is free software: you can redistribute it and/or modify
@@ -57,9 +58,18 @@ extern "C" {
 #define BUILTIN_MEM_EDIT_WORD       1
 #define BUILTIN_MEM_SRCH            0
 
+// Hardware components to be embedded in the program.
+#if defined __ZPU__
+#define BUILTIN_HW_UART_STATS       1
+#endif
+
 // Miscellaneous components to be embedded in this program.
 #define BUILTIN_MISC_SETTIME        0
 #define BUILTIN_MISC_TEST           1
+#define BUILTIN_MISC_APPS           1
+#if defined __TRANZPUTER__
+#define BUILTIN_MISC_EVENTS         1
+#endif
 #if defined __SHARPMZ__
 #define BUILTIN_MISC_CLS            1
 #define BUILTIN_MISC_Z80            1
@@ -17,6 +17,8 @@
 //                  December 2019  - Tweaks to the SoC config and additional commands (ie. mtest).
 //                  April 2020     - With the advent of the tranZPUter SW, enhanced to work with both
 //                                   the ZPU and K64F for the original purpose of testing on both platforms.
+//                  Oct 2026       - ZPU console stream given a block write handler for buffered stdio.
+//                                 - info command shows the sfmalloc heap statistics (__SFMALLOC__).
 //
 // Notes:           See Makefile to enable/disable conditional components
 //                  USELOADB              - The Byte write command is implemented in hw/sw so use it.
@@ -1204,6 +1206,9 @@ int cmdProcessor(void)
             // Configuration information
             case CMD_MISC_INFO:
                 showSoCConfig();
+              #if defined(__SFMALLOC__)
+                printHeapInfo();
+              #endif
                 break;
             
             // Unrecognised command, if SD card enabled, see if the command exists as an app. If it is an app, load and execute
@@ -1326,6 +1331,7 @@ int main(int argc, char **argv)
     setbuf(stdout, NULL);
   #else
     fdev_setup_stream(&osIO, uart_putchar, uart_getchar, _FDEV_SETUP_RW);
+    fdev_set_block(&osIO, uart_write, NULL);
     stdout = stdin = stderr = &osIO;
   #endif
 
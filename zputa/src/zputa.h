@@ -62,12 +62,14 @@ extern "C" {
 #define BUILTIN_MEM_EDIT_HWORD      1
 #define BUILTIN_MEM_EDIT_WORD       1
 #define BUILTIN_MEM_PERF            0
+#define BUILTIN_MEM_BENCH           0
 #define BUILTIN_MEM_SRCH            0
 #define BUILTIN_MEM_TEST            0
 // Hardware components to be embedded in the program.
 #define BUILTIN_HW_SHOW_REGISTER    0
 #define BUILTIN_HW_TEST_TIMERS      0
 #define BUILTIN_HW_TCPU             0
+#define BUILTIN_HW_UART_STATS       0
 // Filesystem components to be embedded in the program.
 #define BUILTIN_FS_STATUS           0
 #define BUILTIN_FS_DIRLIST          0
@@ -95,14 +97,18 @@ extern "C" {
 #define BUILTIN_FS_DUMP             0
 #define BUILTIN_FS_CONCAT           0
 #define BUILTIN_FS_XTRACT           0
+#define BUILTIN_FS_CRC              0
 #define BUILTIN_FS_SAVE             0
 #define BUILTIN_FS_EXEC             1
 // Test components to be embedded in the program.
 #define BUILTIN_TST_DHRYSTONE       0
 #define BUILTIN_TST_COREMARK        0
+#define BUILTIN_TST_BENCH           0
 // Miscellaneous components to be embedded in this program.
 #define BUILTIN_MISC_HELP           0
 #define BUILTIN_MISC_SETTIME        0
+#define BUILTIN_MISC_APPS           0
+#define BUILTIN_MISC_EVENTS         0
 
 // Application execution constants.
 //